@@ -50,6 +50,8 @@
 #if defined(__ICCARM__) || defined(__CC_ARM) || defined(__ARMCC_VERSION) || defined(__GNUC__)
 #include <stdint.h>
 extern uint32_t SystemCoreClock;
+void configureTimerForRunTimeStats(void);
+unsigned long getRunTimeCounterValue(void);
 #endif
 #ifndef CMSIS_device_header
 #define CMSIS_device_header "stm32h7rsxx.h"
@@ -173,6 +175,11 @@ standard names. */
 
 /* USER CODE BEGIN Defines */
 /* Section where parameter definitions can be added (for instance, to override default ones in FreeRTOS.h) */
+// タスク毎の CPU 時間 (ulTaskGetRunTimeCounter) を 1us 単位で数える (tick と SysTick の途中の値から作る、freertos.c)
+// 32bit で一周は約71分なので、差分を取る間隔はそれより短くすること
+#define configGENERATE_RUN_TIME_STATS            1
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS   configureTimerForRunTimeStats
+#define portGET_RUN_TIME_COUNTER_VALUE           getRunTimeCounterValue
 /* USER CODE END Defines */
 
 #endif /* __FREERTOS_CONFIG_H */
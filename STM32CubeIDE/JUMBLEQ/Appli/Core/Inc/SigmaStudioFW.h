@@ -20,7 +20,9 @@
 #ifndef __SIGMASTUDIOFW_H__
 #define __SIGMASTUDIOFW_H__
 
+#include <stdbool.h>
 #include <stdint.h>
+#include "main.h"
 
 /*
  * TODO: Update for your system's data type
@@ -64,6 +66,14 @@ extern volatile uint32_t sigma_spi_it_mutex_timeouts;
 void SIGMA_SPI_Init(void);
 
 void SIGMA_SAFELOAD_WRITE_DATA(uint8_t devAddress, uint16_t dataAddress, uint16_t length, uint8_t* pData);
+// SafeLoad sequence (caller holds SIGMA_SPI_Lock)
+bool SIGMA_SPI_Lock(uint32_t timeout_ms);
+void SIGMA_SPI_Unlock(void);
+HAL_StatusTypeDef SIGMA_SAFELOAD_WRITE_DATA_LOCKED(uint8_t devAddress, uint16_t dataAddress, uint16_t length, uint8_t* pData);
+
+// Program library streaming (caller holds spiMutex)
+HAL_StatusTypeDef SIGMA_WRITE_FRAME_DMA(const uint8_t* frame, uint16_t length);
+uint32_t SIGMA_SPI_SetPrescaler(uint32_t prescaler);
 
 /*
  * TODO: CUSTOM MACRO IMPLEMENTATION
@@ -9,6 +9,7 @@
 #define INC_ADAU1466_H_
 
 #include "main.h"
+#include "biquad_design.h"
 #include <stdbool.h>
 
 enum
@@ -49,6 +50,29 @@ enum
     CH2_DVS_ENABLE = 19,
 };
 
+// MIDI CC (CH1: 20-23, CH2: 24-27)
+enum
+{
+    PHONO_EQ_CC_CH1_CURVE = 20,
+    PHONO_EQ_CC_CH1_RUMBLE = 21,
+    PHONO_EQ_CC_CH1_TREBLE_GAIN = 22,
+    PHONO_EQ_CC_CH1_TREBLE_FREQ = 23,
+    PHONO_EQ_CC_CH2_CURVE = 24,
+    PHONO_EQ_CC_CH2_RUMBLE = 25,
+    PHONO_EQ_CC_CH2_TREBLE_GAIN = 26,
+    PHONO_EQ_CC_CH2_TREBLE_FREQ = 27,
+};
+
+// MIDI CC (クロスフェーダーカーブ: 28-31, ユーザーカーブの制御点: 48-63)
+enum
+{
+    XFADE_CC_A_CURVE = 28,
+    XFADE_CC_A_CUT = 29,
+    XFADE_CC_B_CURVE = 30,
+    XFADE_CC_B_CUT = 31,
+    XFADE_CC_USER_POINT0 = 48,
+};
+
 double convert_pot2dB(uint16_t adc_val);
 int16_t convert_pot2dB_int(uint16_t adc_val);
 
@@ -70,6 +94,7 @@ void control_dryB_out_gain(const uint16_t adc_val);
 
 void control_wet_out_gain(const uint16_t adc_val);
 void control_master_out_gain(const uint16_t adc_val);
+void mute_master_out(void);
 
 void select_input_type(uint8_t ch, uint8_t type);
 void enable_dvs(uint8_t ch, bool enable);
@@ -78,4 +103,10 @@ void select_xf_assignA_source(uint8_t ch);
 void select_xf_assignB_source(uint8_t ch);
 void select_xf_assignPost_source(uint8_t ch);
 
+void safeload_write_q8_24_words(uint16_t addr, const int32_t* words, uint8_t count);
+
+bool set_phono_eq(uint8_t ch, const phono_eq_config_t* cfg);
+bool get_phono_eq(uint8_t ch, phono_eq_config_t* cfg);
+void refresh_phono_eq(uint32_t hz);
+
 #endif /* INC_ADAU1466_H_ */
@@ -20,22 +20,24 @@
 // TXリングの目標水位（word単位）。まずは低リスクに half-buffer へ下げて遅延を短縮。
 #define SAI_TX_TARGET_LEVEL_WORDS (SAI_TX_BUF_SIZE / 2)
 
-#define POT_CH_SEL_WAIT           1
-#define ADC_NUM                   8
-#define POT_MA_SIZE               4  // 移動平均のサンプル数
+#define ADC_NUM                   2  // ADC1 スキャンのランク数 (磁気クロスフェーダーは ADC2)
+#define POT_ADC_RANK              0  // ADC1 スキャン内のポット MUX 出力のランク
 #define POT_NUM                   8
 #define MAG_SW_NUM                6
-#define MAG_CALIBRATION_COUNT_MAX 100
-#define MAG_XFADE_CUTOFF          16
+#define MAG_CALIBRATION_COUNT_MAX 400  // ADC2 ブロック (500us) 単位 = 200ms
+#define MAG_XFADE_CUTOFF          16  // カットインの初期値 (フェーダー毎に MIDI で変更可)
+#define MAG_XFADE_CUT_MAX         127 // MIDI CC の値をそのまま LSB で使う
 #define MAG_XFADE_RANGE           1408
 
 // Runtime DSP parameter update switch for A/B diagnosis.
-// 0: disable ui_control_task() DSP writes (noise root-cause test mode)
+// 0: disable ui_control_wake() DSP writes (noise root-cause test mode)
 // 1: enable normal runtime control updates
 #define ENABLE_DSP_RUNTIME_CONTROL 1
 
 uint32_t get_tx_blink_interval_ms(void);
 uint32_t get_rx_blink_interval_ms(void);
+uint32_t get_current_sample_rate(void);
+uint32_t audio_copy_rx_mono(int32_t* dst, uint32_t frames);
 void reset_audio_buffer(void);
 void AUDIO_LoadAndApplyRoutingFromEEPROM(void);
 
@@ -45,6 +47,7 @@ void AUDIO_Init_ADAU1466(uint32_t hz);
 void start_sai(void);
 
 void AUDIO_SAI_Reset_ForNewRate(void);
+void AUDIO_Swap_DSP_Program(uint8_t slot);
 void audio_control_register_task(void);
 void audio_task(void);
 
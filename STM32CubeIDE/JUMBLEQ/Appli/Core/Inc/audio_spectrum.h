@@ -0,0 +1,32 @@
+/*
+ * audio_spectrum.h
+ *
+ *  Created on: Mar 20, 2026
+ */
+
+#ifndef INC_AUDIO_SPECTRUM_H_
+#define INC_AUDIO_SPECTRUM_H_
+
+#include <stdint.h>
+
+// 表示用のスペクトラム: N 点の Hann 窓 + 基数 2 FFT を対数間隔のバンドにまとめる
+// HAL に依存しないのでホストでもそのままビルドできる
+#define AUDIO_SPECTRUM_N        512U
+#define AUDIO_SPECTRUM_BAND_MAX 32U
+
+typedef struct
+{
+    float window[AUDIO_SPECTRUM_N];
+    float tw_re[AUDIO_SPECTRUM_N / 2U];
+    float tw_im[AUDIO_SPECTRUM_N / 2U];
+    float re[AUDIO_SPECTRUM_N];
+    float im[AUDIO_SPECTRUM_N];
+    uint16_t edge[AUDIO_SPECTRUM_BAND_MAX + 1U];  // バンド b は bin edge[b]..edge[b+1]-1
+    uint8_t bands;
+    uint32_t sample_rate;
+} audio_spectrum_t;
+
+void audio_spectrum_init(audio_spectrum_t* a, uint8_t bands, uint32_t sample_rate, float f_lo, float f_hi);
+void audio_spectrum_process(audio_spectrum_t* a, const int32_t* samples, float* band_db);
+
+#endif /* INC_AUDIO_SPECTRUM_H_ */
@@ -0,0 +1,81 @@
+/*
+ * biquad_design.h
+ *
+ *  Created on: Mar 2, 2026
+ */
+
+#ifndef INC_BIQUAD_DESIGN_H_
+#define INC_BIQUAD_DESIGN_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// HALに依存しない係数設計モジュール（ホストPCでもそのままビルドして倍精度リファレンスと比較できる）
+
+#define PHONO_EQ_STAGE_NUM 3U
+
+#define PHONO_EQ_RUMBLE_HZ_MIN 5U
+#define PHONO_EQ_RUMBLE_HZ_MAX 60U
+
+#define PHONO_EQ_TREBLE_DB_MAX   12.0
+#define PHONO_EQ_TREBLE_HZ_MIN   1000U
+#define PHONO_EQ_TREBLE_HZ_MAX   16000U
+#define PHONO_EQ_TREBLE_HZ_DEF   6000U
+
+enum
+{
+    PHONO_CURVE_RIAA = 0,
+    PHONO_CURVE_RIAA_IEC,  // RIAA + IEC amendment (7950us subsonic pole)
+    PHONO_CURVE_COLUMBIA,  // Columbia LP (1590us / 318us / 100us)
+    PHONO_CURVE_FLAT,      // De-emphasisなし（MM/MCプリアンプ後段などの確認用）
+    PHONO_CURVE_NUM,
+};
+
+// 標準形: y = b0*x0 + b1*x1 + b2*x2 - a1*y1 - a2*y2 (a0 = 1で正規化済み)
+typedef struct
+{
+    double b0;
+    double b1;
+    double b2;
+    double a1;
+    double a2;
+} biquad_coef_t;
+
+// SigmaStudio の係数並び(B2, B1, B0, A2, A1)。A1/A2 は標準形と符号が逆になる
+typedef struct
+{
+    int32_t b2;
+    int32_t b1;
+    int32_t b0;
+    int32_t a2;
+    int32_t a1;
+} biquad_sigma_q8_24_t;
+
+typedef struct
+{
+    uint8_t curve;      // PHONO_CURVE_*
+    uint8_t rumble_hz;  // 0: off, それ以外は2次Butterworth HPのカットオフ
+    int8_t treble_qdb;  // High-shelf gain (0.25dB単位)
+    uint16_t treble_hz; // High-shelf corner
+} phono_eq_config_t;
+
+void biquad_design_identity(biquad_coef_t* out);
+bool biquad_design_lowpass(double fc, double q, double fs, biquad_coef_t* out);
+bool biquad_design_highpass(double fc, double q, double fs, biquad_coef_t* out);
+bool biquad_design_highpass_1st(double fc, double fs, biquad_coef_t* out);
+bool biquad_design_peaking(double fc, double q, double gain_db, double fs, biquad_coef_t* out);
+bool biquad_design_lowshelf(double fc, double slope, double gain_db, double fs, biquad_coef_t* out);
+bool biquad_design_highshelf(double fc, double slope, double gain_db, double fs, biquad_coef_t* out);
+bool biquad_design_phono_curve(uint8_t curve, double fs, biquad_coef_t* out);
+
+double biquad_magnitude_db(const biquad_coef_t* coef, double f, double fs);
+double phono_curve_reference_db(uint8_t curve, double f);
+
+bool biquad_to_sigma_q8_24(const biquad_coef_t* coef, biquad_sigma_q8_24_t* out);
+void biquad_from_sigma_q8_24(const biquad_sigma_q8_24_t* in, biquad_coef_t* out);
+
+void phono_eq_config_set_defaults(phono_eq_config_t* cfg);
+bool phono_eq_config_is_valid(const phono_eq_config_t* cfg);
+bool phono_eq_design_stages(const phono_eq_config_t* cfg, double fs, biquad_coef_t stages[PHONO_EQ_STAGE_NUM]);
+
+#endif /* INC_BIQUAD_DESIGN_H_ */
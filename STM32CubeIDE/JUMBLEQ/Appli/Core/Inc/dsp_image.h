@@ -0,0 +1,87 @@
+/*
+ * dsp_image.h
+ *
+ *  Created on: Mar 23, 2026
+ */
+
+#ifndef INC_DSP_IMAGE_H_
+#define INC_DSP_IMAGE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// DSP プログラムイメージ (JDSP, tools/sigma_image_compiler.go が作る) の形式と検査、圧縮 frame の展開
+// HAL に依存しないのでホストでもそのままビルドできる
+#define DSP_IMAGE_MAGIC   0x5053444AUL  // "JDSP"
+#define DSP_IMAGE_VERSION 2U
+#define DSP_IMAGE_NAME_LEN 16U
+
+// SPI5 は limited instance のため1回の転送は TSIZE < 1023 byte。ヘッダ3byteを含めてこれ以内に分割しておく
+#define DSP_IMAGE_FRAME_MAX      1020U
+#define DSP_IMAGE_FRAME_HDR_SIZE 3U
+
+#define DSP_IMAGE_DELAY_MAX_MS 1000U
+
+enum
+{
+    DSP_IMAGE_OP_WRITE = 0,  // frame = [dev][addr_hi][addr_lo][data...]
+    DSP_IMAGE_OP_DELAY,      // length = 待ち時間[ms]
+    DSP_IMAGE_OP_NUM,
+};
+
+// WRITE op の flags
+#define DSP_IMAGE_OP_FLAG_LZ 0x01U  // frameヘッダ以降が LZ77+RLE 圧縮 (tools/sigma_image_compiler.go)
+
+// 圧縮ストリーム: 0x00-0x7F = リテラル(n+1 byte), 0x80-0xFF = 一致(長さ (n&0x7F)+3, 距離2byte LE)
+#define DSP_IMAGE_LZ_MATCH_FLAG 0x80U
+#define DSP_IMAGE_LZ_MATCH_MIN  3U
+
+// リトルエンディアン。crc32 は header_size 以降 image_size までの範囲 (IEEE 802.3)
+typedef struct
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t header_size;
+    uint32_t image_size;
+    uint32_t crc32;
+    char name[DSP_IMAGE_NAME_LEN];
+    uint16_t op_count;
+    uint16_t param_count;
+    uint32_t op_offset;
+    uint32_t param_offset;
+    uint32_t symbol_offset;
+    uint16_t symbol_count;
+    uint16_t reserved;
+} dsp_image_header_t;
+
+typedef struct
+{
+    uint8_t type;     // DSP_IMAGE_OP_*
+    uint8_t flags;
+    uint16_t addr;    // ログ用 (実際のアドレスは frame 内)
+    uint32_t length;  // WRITE: 展開後のdata長 (frameヘッダを含まない) / DELAY: ms
+    uint32_t offset;  // WRITE: イメージ先頭から frame までのオフセット
+    uint32_t stored;  // WRITE: フラッシュ上の frame 長 (非圧縮なら length + 3)
+} dsp_image_op_t;
+
+typedef struct
+{
+    uint16_t id;    // DSP_PARAM_*
+    uint16_t addr;  // DSP_PARAM_ADDR_NONE: このプログラムには存在しない
+} dsp_image_param_t;
+
+// SigmaStudio PARAM.h の全モジュールアドレス (MOD_/_ADDR を除いた名前)。名前は NUL 終端
+typedef struct
+{
+    uint16_t addr;
+    uint16_t name_len;
+    uint32_t name_offset;
+} dsp_image_symbol_t;
+
+uint32_t dsp_image_crc32(const uint8_t* p, uint32_t len);
+bool dsp_image_check_header(const dsp_image_header_t* img, uint32_t max_size);
+bool dsp_image_check_ops(const dsp_image_header_t* img);
+bool dsp_image_validate(const dsp_image_header_t* img, uint32_t max_size);
+bool dsp_image_lz_decode(const uint8_t* src, uint32_t src_len, uint8_t* dst, uint32_t dst_len);
+
+#endif /* INC_DSP_IMAGE_H_ */
@@ -0,0 +1,82 @@
+/*
+ * dsp_library.h
+ *
+ *  Created on: Mar 6, 2026
+ */
+
+#ifndef INC_DSP_LIBRARY_H_
+#define INC_DSP_LIBRARY_H_
+
+#include "main.h"
+#include "dsp_image.h"
+#include <stdbool.h>
+
+// XSPI Flash(メモリマップ 0x90000000)のアプリ領域より後ろをDSPプログラムライブラリとして使う
+#define DSP_LIBRARY_BASE_ADDR 0x90800000UL
+#define DSP_LIBRARY_SLOT_SIZE 0x00040000UL  // 256KB
+#define DSP_LIBRARY_SLOT_NUM  16U
+
+#define DSP_LIBRARY_SLOT_BUILTIN 0xFFU  // ファームウェア内蔵のSigmaStudioエクスポート
+
+// MIDI Program Change 32..47 でスロット0..15、48で内蔵プログラムに戻す
+#define DSP_LIBRARY_PC_BASE    32U
+#define DSP_LIBRARY_PC_BUILTIN (DSP_LIBRARY_PC_BASE + DSP_LIBRARY_SLOT_NUM)
+
+#define DSP_PARAM_ADDR_NONE 0xFFFFU
+
+// プログラム毎にアドレスが変わるパラメータの論理ID (イメージ間で共通)
+enum
+{
+    DSP_PARAM_INPUT_FROM_USB1_GAIN = 0,
+    DSP_PARAM_INPUT_FROM_USB2_GAIN,
+    DSP_PARAM_INPUT_FROM_USB3_GAIN,
+    DSP_PARAM_INPUT_FROM_USB4_GAIN,
+    DSP_PARAM_INPUT_FROM_CH1_GAIN,
+    DSP_PARAM_INPUT_FROM_CH2_GAIN,
+    DSP_PARAM_SEND1_OUTPUT_GAIN,
+    DSP_PARAM_SEND2_OUTPUT_GAIN,
+    DSP_PARAM_MASTER_OUTPUT_GAIN,
+    DSP_PARAM_DCINPUT_A,
+    DSP_PARAM_DCINPUT_B,
+    DSP_PARAM_DCINPUT_DRYA,
+    DSP_PARAM_DCINPUT_DRYB,
+    DSP_PARAM_DCINPUT_WET,
+    DSP_PARAM_LN_PN_SW_1_CH0,
+    DSP_PARAM_LN_PN_SW_1_CH1,
+    DSP_PARAM_LN_PN_SW_2_CH0,
+    DSP_PARAM_LN_PN_SW_2_CH1,
+    DSP_PARAM_DVS_SW_1_CH0,
+    DSP_PARAM_DVS_SW_1_CH1,
+    DSP_PARAM_DVS_SW_2_CH0,
+    DSP_PARAM_DVS_SW_2_CH1,
+    DSP_PARAM_XF_ASSIGN_SW_A,
+    DSP_PARAM_XF_ASSIGN_SW_B,
+    DSP_PARAM_XF_ASSIGN_SW_POST,
+    DSP_PARAM_PH_EQ_1_STAGE0,
+    DSP_PARAM_PH_EQ_1_STAGE1,
+    DSP_PARAM_PH_EQ_1_STAGE2,
+    DSP_PARAM_PH_EQ_2_STAGE0,
+    DSP_PARAM_PH_EQ_2_STAGE1,
+    DSP_PARAM_PH_EQ_2_STAGE2,
+    DSP_PARAM_READBACK_A,
+    DSP_PARAM_READBACK_B,
+    DSP_PARAM_RUNNINGAVERAGE_A,
+    DSP_PARAM_RUNNINGAVERAGE_B,
+    DSP_PARAM_NUM,
+};
+
+uint16_t dsp_param_addr(uint16_t id);
+
+const dsp_image_header_t* dsp_library_get_image(uint8_t slot);
+bool dsp_library_validate(uint8_t slot);
+uint16_t dsp_library_find_symbol(uint8_t slot, const char* name);
+
+bool dsp_library_request(uint8_t slot);
+bool dsp_library_take_request(uint8_t* slot);
+bool dsp_library_select(uint8_t slot);
+uint8_t dsp_library_active_slot(void);
+bool dsp_library_is_downloading(void);
+
+bool dsp_library_download(void);
+
+#endif /* INC_DSP_LIBRARY_H_ */
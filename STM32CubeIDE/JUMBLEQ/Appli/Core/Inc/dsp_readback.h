@@ -0,0 +1,40 @@
+/*
+ * dsp_readback.h
+ *
+ *  Created on: Mar 4, 2026
+ */
+
+#ifndef INC_DSP_READBACK_H_
+#define INC_DSP_READBACK_H_
+
+#include "main.h"
+#include <stdbool.h>
+
+#define DSP_READBACK_PERIOD_MS          10U
+#define DSP_READBACK_SETTINGS_PERIOD_MS 1000U
+#define DSP_READBACK_FLOOR_DB           -96.0f
+
+enum
+{
+    DSP_READBACK_METER_A = 0,
+    DSP_READBACK_METER_B,
+    DSP_READBACK_METER_NUM,
+};
+
+typedef struct
+{
+    uint32_t raw[DSP_READBACK_METER_NUM];              // DSPREADBACK の生値
+    float dbfs[DSP_READBACK_METER_NUM];                // 20*log10(raw / 2^23)
+    float rms_tc_db_per_s[DSP_READBACK_METER_NUM];     // RUNNINGAVERAGE RMSTCINDBPS
+    float decay[DSP_READBACK_METER_NUM];               // RUNNINGAVERAGE DECAY
+    uint32_t hold[DSP_READBACK_METER_NUM];             // RUNNINGAVERAGE HOLD
+    uint32_t update_count;
+    uint32_t timestamp_ms;
+} dsp_readback_snapshot_t;
+
+void dsp_readback_task(void);
+bool dsp_readback_get_snapshot(dsp_readback_snapshot_t* out);
+float dsp_readback_get_dbfs(uint8_t meter);
+float dsp_readback_raw_to_dbfs(uint32_t raw);
+
+#endif /* INC_DSP_READBACK_H_ */
@@ -6,6 +6,8 @@ extern "C" {
 #endif
 
 #include "main.h"
+#include "xfade_curve.h"
+#include <stdbool.h>
 
 #define EEPROM_I2C_ADDR_7BIT          (0x50U)
 #define EEPROM_I2C_ADDR_8BIT          (EEPROM_I2C_ADDR_7BIT << 1)
@@ -13,6 +15,8 @@ extern "C" {
 #define EEPROM_READY_TIMEOUT_MS       (100U)
 #define EEPROM_XFER_TIMEOUT_MS        (100U)
 #define EEPROM_WRITE_CYCLE_TIMEOUT_MS (20U)
+#define EEPROM_BUS_LOCK_TIMEOUT_MS    (200U) /* i2cMutex 待ち (OLED の DMA 転送は最長 100ms) */
+#define EEPROM_BUS_RETRIES            (3U)   /* ミューテックス待ちのタイムアウトと HAL_BUSY をやり直す回数 */
 #define EEPROM_PAGE_SIZE_BYTES        (128U)
 #define EEPROM_TOTAL_SIZE_BYTES       (65536U)
 
@@ -26,20 +30,62 @@ typedef struct
     uint8_t current_ch1_dvs_enable;
     uint8_t current_ch2_dvs_enable;
     uint8_t reserved[1];
+    /* v3 */
+    uint8_t current_xf_curve[2];  /* A, B */
+    uint8_t current_xf_cut[2];    /* A, B */
+    uint8_t current_xf_user_curve[XFADE_USER_POINT_NUM];
 } EEPROM_DeviceConfig_t;
 
 #define EEPROM_CONFIG_ADDR               (0x0000U)
 #define EEPROM_CONFIG_MAGIC              (0x51424D4AU) /* "JMBQ" */
-#define EEPROM_CONFIG_VERSION            (0x0002U)
+#define EEPROM_CONFIG_VERSION            (0x0003U)
+#define EEPROM_CONFIG_V2_PAYLOAD_SIZE    (8U)
+
+typedef struct
+{
+    uint16_t rest[6];   /* MAG_SW_NUM */
+    uint16_t reserved[2];
+} EEPROM_MagCalib_t;
+
+#define EEPROM_MAG_CALIB_ADDR            (0x0080U) /* 設定レコードの次のページ */
+#define EEPROM_MAG_CALIB_MAGIC           (0x43474D4AU) /* "JMGC" */
+#define EEPROM_MAG_CALIB_VERSION         (0x0001U)
+
+#define EEPROM_MIDI_MAP_ENTRY_NUM        (14U) /* MIDI_MAP_SRC_NUM */
+#define EEPROM_MIDI_MAP_ENTRY_BYTES      (10U) /* sizeof(midi_map_entry_t) */
+
+typedef struct
+{
+    uint8_t entry[EEPROM_MIDI_MAP_ENTRY_NUM * EEPROM_MIDI_MAP_ENTRY_BYTES];
+} EEPROM_MidiMap_t;
+
+#define EEPROM_MIDI_MAP_ADDR             (0x0100U)
+#define EEPROM_MIDI_MAP_MAGIC            (0x504D4D4AU) /* "JMMP" */
+#define EEPROM_MIDI_MAP_VERSION          (0x0001U)
+
+/* プリセット: EEPROM_DeviceConfig_t を設定レコードと同じ形式で 1 スロット 1 ページに置く */
+#define EEPROM_PRESET_NUM                (4U)
+#define EEPROM_PRESET_ADDR               (0x0200U)
+#define EEPROM_PRESET_STRIDE             (EEPROM_PAGE_SIZE_BYTES)
+#define EEPROM_PRESET_MAGIC              (0x53504D4AU) /* "JMPS" */
 
 HAL_StatusTypeDef EEPROM_CheckConnection(I2C_HandleTypeDef *hi2c);
 HAL_StatusTypeDef EEPROM_WaitReady(I2C_HandleTypeDef *hi2c, uint32_t timeout_ms);
 HAL_StatusTypeDef EEPROM_Read(I2C_HandleTypeDef *hi2c, uint16_t mem_addr, uint8_t *buf, uint16_t len);
 HAL_StatusTypeDef EEPROM_Write(I2C_HandleTypeDef *hi2c, uint16_t mem_addr, const uint8_t *buf, uint16_t len);
+bool EEPROM_IsBusy(void); /* 読み書きの途中 (hi2c2 を使う、または待っている) */
 void EEPROM_ConfigSetDefaults(EEPROM_DeviceConfig_t *cfg);
+bool EEPROM_ConfigIsValid(const EEPROM_DeviceConfig_t *cfg);
 void EEPROM_ConfigCaptureCurrent(EEPROM_DeviceConfig_t *cfg);
+bool EEPROM_ConfigApply(const EEPROM_DeviceConfig_t *cfg);
 HAL_StatusTypeDef EEPROM_SaveConfig(I2C_HandleTypeDef *hi2c, const EEPROM_DeviceConfig_t *cfg);
 HAL_StatusTypeDef EEPROM_LoadConfig(I2C_HandleTypeDef *hi2c, EEPROM_DeviceConfig_t *cfg);
+HAL_StatusTypeDef EEPROM_SaveMagCalib(I2C_HandleTypeDef *hi2c, const EEPROM_MagCalib_t *cal);
+HAL_StatusTypeDef EEPROM_LoadMagCalib(I2C_HandleTypeDef *hi2c, EEPROM_MagCalib_t *cal);
+HAL_StatusTypeDef EEPROM_SaveMidiMap(I2C_HandleTypeDef *hi2c, const EEPROM_MidiMap_t *map);
+HAL_StatusTypeDef EEPROM_LoadMidiMap(I2C_HandleTypeDef *hi2c, EEPROM_MidiMap_t *map);
+HAL_StatusTypeDef EEPROM_SavePreset(I2C_HandleTypeDef *hi2c, uint8_t slot, const EEPROM_DeviceConfig_t *cfg);
+HAL_StatusTypeDef EEPROM_LoadPreset(I2C_HandleTypeDef *hi2c, uint8_t slot, EEPROM_DeviceConfig_t *cfg);
 
 #ifdef __cplusplus
 }
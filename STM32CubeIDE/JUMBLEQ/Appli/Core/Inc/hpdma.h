@@ -35,7 +35,7 @@ extern "C" {
 extern DMA_HandleTypeDef handle_HPDMA1_Channel0;
 
 /* USER CODE BEGIN Private defines */
-
+extern DMA_HandleTypeDef handle_HPDMA1_Channel1;  // ADC2 (磁気クロスフェーダー)
 /* USER CODE END Private defines */
 
 void MX_HPDMA1_Init(void);
@@ -0,0 +1,77 @@
+/*
+ * input_event.h
+ *
+ *  Created on: Mar 15, 2026
+ */
+
+#ifndef INC_INPUT_EVENT_H_
+#define INC_INPUT_EVENT_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// ボタン/フェーダーのカット状態をチャタリング除去して、種類付きのイベント (押した、長押し、ダブル、同時押し、カット) にする
+// 入力は「今オンかどうか」のビット列と時刻 (ms) だけ。HAL に依存しないのでホストでもそのままビルドできる
+#define INPUT_EVENT_SRC_MAX 8U
+
+enum
+{
+    INPUT_KIND_BUTTON = 0,  // PRESS/RELEASE/CLICK/LONG/DOUBLE/CHORD
+    INPUT_KIND_FADER,       // CUT/OPEN (フェーダーがカットイン位置より閉じた/開いた)
+};
+
+enum
+{
+    INPUT_EVENT_NONE = 0,
+    INPUT_EVENT_PRESS,    // 押した (チャタリング除去後すぐ)
+    INPUT_EVENT_RELEASE,  // 離した。arg = 押していた時間 [ms]
+    INPUT_EVENT_CLICK,    // 短く押して離し、ダブルの受付時間内に次が来なかった
+    INPUT_EVENT_LONG,     // 押したまま long_ms 経った
+    INPUT_EVENT_DOUBLE,   // 離してから double_ms 以内にもう一度押した
+    INPUT_EVENT_CHORD,    // 2つのボタンを chord_ms 以内に押した。src = 小さい方、arg = ビットマスク
+    INPUT_EVENT_CUT,
+    INPUT_EVENT_OPEN,
+};
+
+typedef struct
+{
+    uint8_t type;  // INPUT_EVENT_*
+    uint8_t src;
+    uint16_t arg;
+} input_event_t;
+
+typedef struct
+{
+    uint16_t debounce_ms;  // ボタンのチャタリング除去
+    uint16_t long_ms;
+    uint16_t double_ms;    // 0 にすると CLICK を待たずに出す (DOUBLE は出ない)
+    uint16_t chord_ms;
+    uint16_t cut_ms;       // フェーダーのカット状態がこれだけ続いたら確定 (スクラッチの速さに合わせて短く)
+} input_event_timing_t;
+
+typedef struct
+{
+    uint8_t kind;
+    bool raw;
+    bool stable;
+    bool long_sent;
+    bool consumed;      // DOUBLE/CHORD の一部になったので、離すまで CLICK/LONG は出さない
+    bool click_pending; // 離した後、DOUBLE の受付中
+    uint32_t raw_tick;  // raw が変わった時刻 (確定した変化の時刻にも使う)
+    uint32_t press_tick;
+    uint32_t release_tick;
+} input_event_src_t;
+
+typedef struct
+{
+    input_event_src_t src[INPUT_EVENT_SRC_MAX];
+    uint8_t num;
+} input_event_engine_t;
+
+void input_event_init(input_event_engine_t* e, const uint8_t* kinds, uint8_t num);
+uint8_t input_event_update(input_event_engine_t* e, uint32_t now, uint32_t levels, input_event_t* out, uint8_t cap);
+uint32_t input_event_next_ms(const input_event_engine_t* e, uint32_t now);
+bool input_event_set_timing(const input_event_timing_t* t);
+void input_event_get_timing(input_event_timing_t* t);
+
+#endif /* INC_INPUT_EVENT_H_ */
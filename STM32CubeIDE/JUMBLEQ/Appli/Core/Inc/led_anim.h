@@ -0,0 +1,97 @@
+/*
+ * led_anim.h
+ *
+ *  Created on: Mar 17, 2026
+ */
+
+#ifndef INC_LED_ANIM_H_
+#define INC_LED_ANIM_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// LED の表示をレイヤーの表で宣言して、時刻 (ms) から 1 フレームを配列に描く
+// レイヤー = 明るさの時間変化 (キーフレーム) × 形 (全体/メーター/1点/チェイス) × 合成方法
+// 番号の小さいレイヤーから順に重ねる (大きい方が優先)。HAL に依存しないのでホストでもそのままビルドできる
+#define LED_ANIM_LAYER_MAX 16U
+#define LED_ANIM_LEVEL_MAX 255U
+
+enum
+{
+    LED_ANIM_SHAPE_FILL = 0,  // 対象の LED を全部点ける
+    LED_ANIM_SHAPE_METER,     // value (0-255) に比例した数だけ先頭から点ける
+    LED_ANIM_SHAPE_POINT,     // value 番目の 1 つだけ点ける
+    LED_ANIM_SHAPE_CHASE,     // 1 周期ごとに次の LED へ移る
+};
+
+enum
+{
+    LED_ANIM_BLEND_REPLACE = 0,  // 対象の LED を上書き (点けない所は消す)
+    LED_ANIM_BLEND_MAX,          // 色ごとに大きい方
+    LED_ANIM_BLEND_ADD,          // 色ごとに足して 255 で頭打ち
+    LED_ANIM_BLEND_MIX,          // 明るさを不透明度として下の色と混ぜる
+};
+
+typedef struct
+{
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+} led_anim_rgb_t;
+
+// phase は 1 周期を 0x10000 とした Q16
+typedef struct
+{
+    uint16_t phase;
+    uint8_t level;
+    uint8_t hold;  // 1: 次のキーまでこの値のまま、0: 次のキーへ直線で補間
+} led_anim_key_t;
+
+typedef struct
+{
+    const led_anim_key_t* keys;  // phase の昇順
+    uint8_t key_num;
+} led_anim_effect_t;
+
+extern const led_anim_effect_t led_anim_fx_blink;  // 前半点灯、後半消灯
+extern const led_anim_effect_t led_anim_fx_pulse;  // 0 → 255 → 0 の三角波
+extern const led_anim_effect_t led_anim_fx_fade;   // 255 → 0
+
+typedef struct
+{
+    const led_anim_effect_t* fx;    // NULL なら常に 255
+    const uint8_t* leds;            // 対象の LED。METER/POINT/CHASE はこの順に並べる
+    const led_anim_rgb_t* palette;  // leds と同じ並びの色。NULL なら color
+    led_anim_rgb_t color;
+    uint16_t period_ms;
+    uint8_t led_num;
+    uint8_t shape;   // LED_ANIM_SHAPE_*
+    uint8_t blend;   // LED_ANIM_BLEND_*
+    uint8_t repeat;  // 0: 止めるまで繰り返す、n: n 周期で止まる
+} led_anim_layer_def_t;
+
+typedef struct
+{
+    const led_anim_layer_def_t* def;
+    uint32_t start;
+    uint16_t period_ms;
+    uint8_t value;
+    bool active;
+} led_anim_layer_t;
+
+typedef struct
+{
+    led_anim_layer_t layer[LED_ANIM_LAYER_MAX];
+    uint8_t num;
+    uint8_t led_num;
+} led_anim_t;
+
+void led_anim_init(led_anim_t* a, const led_anim_layer_def_t* defs, uint8_t num, uint8_t led_num);
+void led_anim_start(led_anim_t* a, uint8_t layer, uint32_t now);
+void led_anim_stop(led_anim_t* a, uint8_t layer);
+bool led_anim_is_active(const led_anim_t* a, uint8_t layer);
+void led_anim_set_value(led_anim_t* a, uint8_t layer, uint8_t value);
+void led_anim_set_period(led_anim_t* a, uint8_t layer, uint16_t period_ms);
+void led_anim_render(led_anim_t* a, uint32_t now, led_anim_rgb_t* frame);
+
+#endif /* INC_LED_ANIM_H_ */
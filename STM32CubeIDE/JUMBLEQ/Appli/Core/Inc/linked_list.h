@@ -34,6 +34,7 @@
 HAL_StatusTypeDef MX_List_GPDMA1_Channel2_Config(void);
 HAL_StatusTypeDef MX_List_GPDMA1_Channel3_Config(void);
 HAL_StatusTypeDef MX_List_HPDMA1_Channel0_Config(void);
+HAL_StatusTypeDef MX_List_HPDMA1_Channel1_Config(void);
 
 #ifdef __cplusplus
 }
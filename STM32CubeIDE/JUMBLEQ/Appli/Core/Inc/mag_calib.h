@@ -0,0 +1,57 @@
+/*
+ * mag_calib.h
+ *
+ *  Created on: Mar 11, 2026
+ */
+
+#ifndef INC_MAG_CALIB_H_
+#define INC_MAG_CALIB_H_
+
+#include "main.h"
+#include "audio_control.h"
+#include <stdbool.h>
+
+// 磁気クロスフェーダーの静止位置 (オフセット) の管理
+// EEPROM に保存した値があればそれを使い、無ければ起動時の MAG_CALIBRATION_COUNT_MAX ブロックの平均を使う
+// 使用中は、静止していると判断したセンサーだけ温度ドリフトをゆっくり追従する
+#define MAG_CALIB_PC_RECAL  126U  // MIDI PC: ガイド付き再キャリブレーション (完了したら EEPROM に保存)
+#define MAG_CALIB_PC_REPORT 125U  // MIDI PC: キャリブレーション値を RTT に出す
+
+enum
+{
+    MAG_CALIB_SRC_NONE = 0,
+    MAG_CALIB_SRC_BOOT,    // 起動時の平均 (保存しない)
+    MAG_CALIB_SRC_EEPROM,
+    MAG_CALIB_SRC_GUIDED,
+};
+
+enum
+{
+    MAG_CALIB_EVENT_NONE = 0,
+    MAG_CALIB_EVENT_READY,         // 初めてオフセットが決まった
+    MAG_CALIB_EVENT_GUIDED_DONE,   // ガイド付きキャリブレーション完了 (保存が必要)
+    MAG_CALIB_EVENT_GUIDED_FAILED, // タイムアウト (以前の値のまま)
+};
+
+typedef struct
+{
+    uint8_t source;  // MAG_CALIB_SRC_*
+    bool guided_active;
+    uint16_t rest[MAG_SW_NUM];   // 保存した (またはキャリブレーションした) 静止位置
+    int16_t drift[MAG_SW_NUM];   // ドリフト追従分 [LSB]
+    uint32_t idle_mask;          // 今ドリフト追従しているセンサー
+} mag_calib_info_t;
+
+void mag_calib_reset(void);
+void mag_calib_set_stored(const uint16_t rest[MAG_SW_NUM]);
+bool mag_calib_load(I2C_HandleTypeDef* hi2c);
+HAL_StatusTypeDef mag_calib_save(I2C_HandleTypeDef* hi2c);
+bool mag_calib_start_guided(void);
+uint8_t mag_calib_update(const uint16_t val[MAG_SW_NUM], uint32_t blocks);
+bool mag_calib_is_ready(void);
+bool mag_calib_is_guided(void);
+uint16_t mag_calib_offset(uint8_t ch);
+void mag_calib_get_info(mag_calib_info_t* info);
+void mag_calib_report(void);
+
+#endif /* INC_MAG_CALIB_H_ */
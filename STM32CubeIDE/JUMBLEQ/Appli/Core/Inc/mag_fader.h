@@ -0,0 +1,50 @@
+/*
+ * mag_fader.h
+ *
+ *  Created on: Mar 8, 2026
+ */
+
+#ifndef INC_MAG_FADER_H_
+#define INC_MAG_FADER_H_
+
+#include "main.h"
+#include "audio_control.h"
+#include <stdbool.h>
+
+// ADC2 で磁気クロスフェーダー (MAG_SW_NUM ch) を TIM3 TRGO (POT_SCAN_TIM_HZ = 8kHz) 毎にスキャンする
+// DMA バッファの半分 (MAG_FADER_BLOCK_SCANS スキャン = 500us) 毎に割り込みで平均 + フィルタし、adcTask を起こす
+// 静止中 (mag_fader_arm_wakeup 後) はブロックの平均をセンサー毎の窓 (mag_idle.h) と比べ、どれかが出たときだけ起こす
+#define MAG_FADER_BLOCK_SCANS 4U
+#define MAG_FADER_THREAD_FLAG 0x0001U  // adcTask のスレッドフラグ
+
+typedef struct
+{
+    uint32_t blocks;   // フィルタ済みブロック数
+    uint32_t dropped;  // adcTask が読む前に次のブロックで上書きされた数
+    uint32_t writes;   // ブロック → DSP 書き込みまで行った回数
+    uint32_t max_us;   // ブロック完了割り込み → DSP 書き込み完了
+    uint64_t sum_us;
+    uint32_t idle_arms;     // 窓待ちに入った回数
+    uint32_t win_wakeups;   // 窓を出て起きた回数
+    uint32_t wake_writes;   // 起床後最初の DSP 書き込み
+    uint32_t wake_max_us;   // 窓を出たブロック → DSP 書き込み完了
+    uint64_t wake_sum_us;
+    uint32_t idle_us;       // 窓待ちだった時間の合計
+} mag_fader_stats_t;
+
+void mag_fader_init(void);
+void mag_fader_start(void);
+void mag_fader_stop(void);
+
+bool mag_fader_read(uint16_t val[MAG_SW_NUM], uint32_t* block_cyc);
+void mag_fader_note_dsp_write(uint32_t block_cyc);
+
+void mag_fader_arm_wakeup(void);
+void mag_fader_wakeup(void);
+bool mag_fader_is_idle(void);
+void mag_fader_sample_idle(uint16_t val[MAG_SW_NUM]);
+
+bool mag_fader_get_stats(mag_fader_stats_t* out);
+void mag_fader_report(void);
+
+#endif /* INC_MAG_FADER_H_ */
@@ -0,0 +1,39 @@
+/*
+ * mag_filter.h
+ *
+ *  Created on: Mar 23, 2026
+ */
+
+#ifndef INC_MAG_FILTER_H_
+#define INC_MAG_FILTER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// 磁気クロスフェーダーのブロック (MAG_FILTER_SCANS スキャン) の平均 + センサー毎のフィルタ
+// 静止時は 1/8 の一次 IIR (約4ms) でノイズを落とし、MAG_FILTER_FAST_DELTA 以上動いたら即追従する
+// (カットの立ち上がりでフィルタの遅れを出さないため)
+// HAL に依存しないのでホストでもそのままビルドできる
+#define MAG_FILTER_CH_NUM     6U  // MAG_SW_NUM (mag_fader.c で確認)
+#define MAG_FILTER_SCANS      4U  // MAG_FADER_BLOCK_SCANS (mag_fader.c で確認)
+#define MAG_FILTER_IIR_SHIFT  3
+#define MAG_FILTER_FAST_DELTA 24  // 12bit LSB
+#define MAG_FILTER_FRAC_BITS  4
+
+typedef struct
+{
+    int32_t y[MAG_FILTER_CH_NUM];  // Q(MAG_FILTER_FRAC_BITS)
+    bool primed;
+} mag_filter_t;
+
+void mag_filter_reset(mag_filter_t* f);
+void mag_filter_average(const uint32_t* scans, int32_t x[MAG_FILTER_CH_NUM]);
+void mag_filter_update(mag_filter_t* f, const int32_t x[MAG_FILTER_CH_NUM], uint16_t out[MAG_FILTER_CH_NUM]);
+
+// ブロックの平均 (Q(MAG_FILTER_FRAC_BITS)) の整数部
+static inline uint16_t mag_filter_raw(int32_t x)
+{
+    return (uint16_t) (x >> MAG_FILTER_FRAC_BITS);
+}
+
+#endif /* INC_MAG_FILTER_H_ */
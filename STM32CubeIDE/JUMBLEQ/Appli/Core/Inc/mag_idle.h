@@ -0,0 +1,41 @@
+/*
+ * mag_idle.h
+ *
+ *  Created on: Mar 23, 2026
+ */
+
+#ifndef INC_MAG_IDLE_H_
+#define INC_MAG_IDLE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// 磁気クロスフェーダーの静止判定と、静止中の起床窓 (センサー毎)
+// 全センサーが基準から MAG_IDLE_BAND 以内に MAG_IDLE_BLOCKS 留まったら静止。静止中はセンサー毎に
+// 待ちに入った時の値 ± MAG_IDLE_WAKE_BAND の窓を持ち、どれか1つでも出たら起こす
+// HAL に依存しないのでホストでもそのままビルドできる
+#define MAG_IDLE_CH_NUM    6U    // MAG_SW_NUM (mag_fader.c で確認)
+#define MAG_IDLE_BAND      8     // 12bit LSB (MAG_IDLE_WAKE_BAND より十分小さく)
+#define MAG_IDLE_BLOCKS    400U  // ADC2 ブロック (500us) 単位 = 200ms
+#define MAG_IDLE_WAKE_BAND 32    // 12bit LSB
+
+typedef struct
+{
+    uint16_t ref[MAG_IDLE_CH_NUM];  // 静止判定の基準 (ここから MAG_IDLE_BAND 以内なら静止)
+    uint32_t still;                 // 静止が続いたブロック数
+} mag_idle_t;
+
+typedef struct
+{
+    uint16_t lo[MAG_IDLE_CH_NUM];
+    uint16_t hi[MAG_IDLE_CH_NUM];
+} mag_idle_window_t;
+
+void mag_idle_reset(mag_idle_t* m);
+bool mag_idle_moved(const mag_idle_t* m, const uint16_t val[MAG_IDLE_CH_NUM]);
+bool mag_idle_update(mag_idle_t* m, const uint16_t val[MAG_IDLE_CH_NUM], uint32_t blocks);
+
+void mag_idle_window_set(mag_idle_window_t* w, const uint16_t val[MAG_IDLE_CH_NUM]);
+bool mag_idle_window_outside(const mag_idle_window_t* w, const uint16_t val[MAG_IDLE_CH_NUM]);
+
+#endif /* INC_MAG_IDLE_H_ */
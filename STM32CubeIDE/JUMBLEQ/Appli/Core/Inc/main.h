@@ -36,8 +36,7 @@ extern "C" {
 #include "tusb.h"
 #include "usb_descriptors.h"
 
-#include "main_oled.h"
-#include "sub_oled.h"
+#include "ssd1306.h"
 #include "ssd1306_fonts.h"
 
 #include "SEGGER_RTT.h"
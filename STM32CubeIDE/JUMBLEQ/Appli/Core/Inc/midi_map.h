@@ -0,0 +1,88 @@
+/*
+ * midi_map.h
+ *
+ *  Created on: Mar 12, 2026
+ */
+
+#ifndef INC_MIDI_MAP_H_
+#define INC_MIDI_MAP_H_
+
+#include "main.h"
+#include "audio_control.h"
+#include <stdbool.h>
+
+// 操作子 (ポット/磁気フェーダー) → 出力先 (MIDI CC/NRPN/ノート、DSP パラメーター) の割り当て表
+// 値は操作子のフルスケールを Q15 にして、カーブ (XFADE_CURVE_*) → 反転 → [min, max] の順に変換する
+// SW1/SW2 は割り当てない (プリセット・MIDI-learn・保存などの操作 (ui_control の s_gestures) に使っていて、
+// MIDI に出すと同じ押し方で両方が起きるため)。フェーダーのカットはカットノート (ui_gesture_cut_note) で送る
+#define MIDI_MAP_PC_LEARN 124U  // MIDI PC: MIDI-learn (操作子を動かしてから、割り当てたい CC/ノートをホストから送る。learn 中にもう一度で取り消し)
+
+enum
+{
+    MIDI_MAP_SRC_POT0 = 0,
+    MIDI_MAP_SRC_MAG0 = MIDI_MAP_SRC_POT0 + POT_NUM,
+    MIDI_MAP_SRC_NUM  = MIDI_MAP_SRC_MAG0 + MAG_SW_NUM,
+};
+
+enum
+{
+    MIDI_MAP_TYPE_NONE = 0,
+    MIDI_MAP_TYPE_CC,
+    MIDI_MAP_TYPE_NRPN,  // 14bit (CC99/98 + CC6/38)
+    MIDI_MAP_TYPE_NOTE,  // 範囲の半分を超えたらノートオン、下回ったらノートオフ (velocity = max)
+    MIDI_MAP_TYPE_DSP,   // number = MIDI_MAP_DSP_*、値は 10bit
+    MIDI_MAP_TYPE_NUM,
+};
+
+enum
+{
+    MIDI_MAP_DSP_CH1_GAIN = 0,
+    MIDI_MAP_DSP_CH2_GAIN,
+    MIDI_MAP_DSP_MASTER_GAIN,
+    MIDI_MAP_DSP_DRY_WET,
+    MIDI_MAP_DSP_NUM,
+};
+
+#define MIDI_MAP_FLAG_INVERT         0x01U
+#define MIDI_MAP_FLAG_TAKEOVER_SHIFT 1U     // ポットのソフトテイクオーバー (POT_TAKEOVER_*)
+#define MIDI_MAP_FLAG_TAKEOVER_MASK  0x06U
+
+typedef struct
+{
+    uint8_t type;     // MIDI_MAP_TYPE_*
+    uint8_t channel;  // 0-15
+    uint8_t curve;    // XFADE_CURVE_*
+    uint8_t flags;    // MIDI_MAP_FLAG_*
+    uint16_t number;  // CC/ノート番号 (0-127)、NRPN 番号 (0-16383)、MIDI_MAP_DSP_*
+    uint16_t min;
+    uint16_t max;
+} midi_map_entry_t;
+
+enum
+{
+    MIDI_MAP_LEARN_NONE = 0,
+    MIDI_MAP_LEARN_DONE,     // 割り当てた (保存が必要)
+    MIDI_MAP_LEARN_TIMEOUT,
+};
+
+void midi_map_set_defaults(void);
+bool midi_map_get_entry(uint8_t src, midi_map_entry_t* entry);
+bool midi_map_set_entry(uint8_t src, const midi_map_entry_t* entry);
+uint32_t midi_map_generation(void);
+uint8_t midi_map_value_bits(uint8_t src);
+uint16_t midi_map_type_max(uint8_t type);
+void midi_map_emit(uint8_t src, uint32_t value, uint32_t full_scale);
+uint8_t midi_map_takeover_mode(uint8_t src);
+bool midi_map_reverse(uint8_t src, uint16_t out, uint32_t full_scale, uint32_t* value);
+void midi_map_invalidate(uint8_t src);
+
+bool midi_map_load(I2C_HandleTypeDef* hi2c);
+HAL_StatusTypeDef midi_map_save(I2C_HandleTypeDef* hi2c);
+
+bool midi_map_learn_start(void);
+bool midi_map_learn_active(void);
+void midi_map_learn_cancel(void);
+uint8_t midi_map_learn_take(uint8_t status, uint8_t number);
+uint8_t midi_map_learn_poll(void);
+
+#endif /* INC_MIDI_MAP_H_ */
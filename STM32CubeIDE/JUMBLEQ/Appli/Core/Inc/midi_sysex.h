@@ -0,0 +1,84 @@
+/*
+ * midi_sysex.h
+ *
+ *  Created on: Mar 12, 2026
+ */
+
+#ifndef INC_MIDI_SYSEX_H_
+#define INC_MIDI_SYSEX_H_
+
+#include "midi_sysex_codec.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// JUMBLEQ の SysEx プロトコル: F0 7D 4A <cmd> <data...> F7
+// 応答の無いコマンドは ACK/NAK <cmd> を返す。tools/jumbleq_sysex.go と一致させること
+// EEPROM に書くコマンド (MAP_SAVE, CFG_SAVE, PRESET_STORE, プリセットへの RESTORE_DATA) は保存待ちにして、
+// midi_sysex_flush_save で書き終わってから ACK/NAK を返す。保存待ちの間に来た次の保存は NAK
+//
+// ユニバーサル Identity Request (F0 7E <id> 06 01 F7) には
+//   F0 7E 7F 06 02 7D 4A 00 01 00 <major> <minor> <patch> 00 F7 を返す
+//
+// 14bit 値は MSB, LSB の順に 7bit ずつ。8bit のバイナリ (ダンプ) は midi_sysex_pack で 7bit に詰める
+#define MIDI_SYSEX_PROTOCOL_VERSION 1U
+#define MIDI_SYSEX_CHUNK_BYTES      64U  // ダンプ 1 メッセージの生データ長 (詰めると 74 byte)
+
+enum
+{
+    MIDI_SYSEX_CMD_VERSION_GET   = 0x01,  // → VERSION_REPLY
+    MIDI_SYSEX_CMD_VERSION_REPLY = 0x02,  // <proto> <fw major> <minor> <patch> <config ver 14bit> <dsp slot (7F: 内蔵)> <dsp name 16>
+    MIDI_SYSEX_CMD_MAP_GET       = 0x10,  // <src> → MAP_REPLY
+    MIDI_SYSEX_CMD_MAP_REPLY     = 0x11,  // <src> <entry 10byte>
+    MIDI_SYSEX_CMD_MAP_SET       = 0x12,  // <src> <entry 10byte> → ACK/NAK
+    MIDI_SYSEX_CMD_MAP_SAVE      = 0x13,  // EEPROM に保存 → ACK/NAK
+    MIDI_SYSEX_CMD_MAP_DEFAULTS  = 0x14,  // 初期割り当てに戻す → ACK
+    MIDI_SYSEX_CMD_CFG_GET       = 0x20,  // <field> → CFG_REPLY
+    MIDI_SYSEX_CMD_CFG_REPLY     = 0x21,  // <field> <value 14bit>
+    MIDI_SYSEX_CMD_CFG_SET       = 0x22,  // <field> <value 14bit> → すぐ反映して ACK/NAK
+    MIDI_SYSEX_CMD_CFG_SAVE      = 0x23,  // 今の設定を EEPROM に保存 (PC 127 と同じ) → ACK/NAK
+    MIDI_SYSEX_CMD_DUMP_GET      = 0x30,  // <section> → DUMP_DATA を必要なだけ
+    MIDI_SYSEX_CMD_DUMP_DATA     = 0x31,  // <section> <index> <count> <packed...> <checksum>
+    MIDI_SYSEX_CMD_RESTORE_DATA  = 0x32,  // DUMP_DATA と同じ形式。index 0 から順に送り、毎回 ACK を待つ (最後の ACK で反映済み)
+    MIDI_SYSEX_CMD_PRESET_STORE  = 0x40,  // <slot> 今の設定をプリセットに保存 → ACK/NAK
+    MIDI_SYSEX_CMD_PRESET_RECALL = 0x41,  // <slot> プリセットを読み込んで反映 → ACK/NAK
+    MIDI_SYSEX_CMD_PARAM_GET     = 0x50,  // <param (MIDI_MAP_DSP_*)> → PARAM_REPLY
+    MIDI_SYSEX_CMD_PARAM_REPLY   = 0x51,  // <param> <value 14bit (0-1023)>
+    MIDI_SYSEX_CMD_PARAM_SET     = 0x52,  // <param> <value 14bit> → DSP に反映して ACK/NAK (同じ先のポットはテイクオーバー)
+    MIDI_SYSEX_CMD_TUNE_GET      = 0x60,  // <tune (MIDI_SYSEX_TUNE_*)> → TUNE_REPLY
+    MIDI_SYSEX_CMD_TUNE_REPLY    = 0x61,  // <tune> <value 14bit>
+    MIDI_SYSEX_CMD_TUNE_SET      = 0x62,  // <tune> <value 14bit> → すぐ反映して ACK/NAK (保存はしない)
+    MIDI_SYSEX_CMD_NAK           = 0x7E,  // <cmd>
+    MIDI_SYSEX_CMD_ACK           = 0x7F,  // <cmd>
+};
+
+// CFG_GET/SET の field は EEPROM_DeviceConfig_t 内のバイトオフセット (reserved は不可)
+//   0: CH1 入力 1: CH2 入力 2-4: XF A/B/POST 割り当て 5-6: DVS 8-9: カーブ A/B 10-11: カットイン A/B 12-27: ユーザーカーブ
+
+// TUNE_GET/SET の対象 (入力処理の調整値。電源を切ると初期値に戻る)
+enum
+{
+    MIDI_SYSEX_TUNE_POT_MIN_CUTOFF = 0x00,  // pot_filter_params_t (pot_filter.h)。単位もそのまま
+    MIDI_SYSEX_TUNE_POT_MAX_CUTOFF = 0x01,
+    MIDI_SYSEX_TUNE_POT_BETA       = 0x02,
+    MIDI_SYSEX_TUNE_POT_D_CUTOFF   = 0x03,
+    MIDI_SYSEX_TUNE_POT_HYST       = 0x04,
+    MIDI_SYSEX_TUNE_INPUT_DEBOUNCE = 0x10,  // input_event_timing_t (input_event.h) [ms]
+    MIDI_SYSEX_TUNE_INPUT_LONG     = 0x11,
+    MIDI_SYSEX_TUNE_INPUT_DOUBLE   = 0x12,
+    MIDI_SYSEX_TUNE_INPUT_CHORD    = 0x13,
+    MIDI_SYSEX_TUNE_INPUT_CUT      = 0x14,
+};
+
+// ダンプ/リストアの section。checksum は section から packed の最後までを足して 0 (mod 128) にする値
+enum
+{
+    MIDI_SYSEX_SECTION_CONFIG   = 0x00,  // 今の EEPROM_DeviceConfig_t
+    MIDI_SYSEX_SECTION_MIDI_MAP = 0x01,  // 今の割り当て表 (midi_map_entry_t x MIDI_MAP_SRC_NUM)
+    MIDI_SYSEX_SECTION_PRESET   = 0x10,  // + slot: EEPROM のプリセット (EEPROM_DeviceConfig_t)
+};
+
+void midi_sysex_handle(const uint8_t* msg, uint16_t len);
+void midi_sysex_flush_save(void);
+
+#endif /* INC_MIDI_SYSEX_H_ */
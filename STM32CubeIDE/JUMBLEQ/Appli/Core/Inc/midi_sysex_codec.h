@@ -0,0 +1,54 @@
+/*
+ * midi_sysex_codec.h
+ *
+ *  Created on: Mar 13, 2026
+ */
+
+#ifndef INC_MIDI_SYSEX_CODEC_H_
+#define INC_MIDI_SYSEX_CODEC_H_
+
+// SysEx の組み立て・分解だけを行う部分。HAL/TinyUSB に依存しないのでホストの cc でもそのままビルドできる
+// (入力はすべて長さで境界を確認し、動的確保はしない)
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// JUMBLEQ の SysEx: F0 7D 4A <cmd> <data...> F7 (7D = 非商用/開発用 ID)
+#define MIDI_SYSEX_MANUFACTURER 0x7DU
+#define MIDI_SYSEX_DEVICE       0x4AU  // 'J'
+#define MIDI_SYSEX_BUF_SIZE     128U   // F0/F7 を除いた最大長。超えたメッセージは捨てる
+#define MIDI_SYSEX_HEADER_LEN   3U     // 7D 4A <cmd>
+
+// 8bit データを 7bit に詰めた長さ (7 byte 毎に MSB をまとめた 1 byte が先頭に付く)
+#define MIDI_SYSEX_PACKED_LEN(n) ((n) + (((n) + 6U) / 7U))
+
+typedef struct
+{
+    uint8_t buf[MIDI_SYSEX_BUF_SIZE];
+    uint16_t len;
+    bool active;
+    bool overflow;
+} midi_sysex_rx_t;
+
+typedef struct
+{
+    uint8_t cmd;
+    const uint8_t* data;
+    uint16_t len;
+} midi_sysex_msg_t;
+
+void midi_sysex_reset(midi_sysex_rx_t* rx);
+bool midi_sysex_feed_byte(midi_sysex_rx_t* rx, uint8_t b);
+bool midi_sysex_feed_packet(midi_sysex_rx_t* rx, const uint8_t packet[4]);
+
+bool midi_sysex_parse(const uint8_t* body, uint16_t len, midi_sysex_msg_t* msg);
+uint16_t midi_sysex_build(uint8_t cmd, const uint8_t* data, uint16_t len, uint8_t* out, uint16_t cap);
+
+bool midi_sysex_pack(const uint8_t* in, uint16_t len, uint8_t* out, uint16_t cap, uint16_t* out_len);
+bool midi_sysex_unpack(const uint8_t* in, uint16_t len, uint8_t* out, uint16_t cap, uint16_t* out_len);
+uint8_t midi_sysex_checksum(const uint8_t* data, uint16_t len);
+
+bool midi_sysex_is_identity_request(const uint8_t* body, uint16_t len);
+uint16_t midi_sysex_build_identity_reply(const uint8_t version[4], uint8_t* out, uint16_t cap);
+
+#endif /* INC_MIDI_SYSEX_CODEC_H_ */
@@ -10,8 +10,19 @@
 
 #include "main.h"
 
+// 2 枚の SSD1306 (描く時は ssd1306_* にこれを渡す)
+extern ssd1306_t oled_main;  // I2C3 128x32
+extern ssd1306_t oled_sub;   // I2C2 128x64
+
 void OLED_Init(void);
-void OLED_UpdateTask(void);
+void OLED_UpdateTask(void);  // パネルを止めている間は OLED_NotifyActivity() で起こされるまで戻らない
+void OLED_NotifyActivity(void);  // 操作/MIDI があった (減光・スリープの時間を戻す)
 void OLED_ShowInitStatus(const char* text);
+void OLED_ToggleSubView(void);  // サブ OLED: ルーティング -> メーター -> メニュー -> ルーティング
+
+// メニュー (サブ OLED)。adcTask から入力を渡し、oledTask で処理する
+void OLED_MenuKey(uint8_t key);                  // OLED_MENU_KEY_*
+void OLED_MenuPot(uint16_t pos, uint16_t full);  // ポットの位置 0..full
+bool OLED_MenuIsOpen(void);
 
 #endif /* INC_OLED_CONTROL_H_ */
@@ -0,0 +1,45 @@
+/*
+ * oled_dirty.h
+ *
+ *  Created on: Mar 19, 2026
+ */
+
+#ifndef INC_OLED_DIRTY_H_
+#define INC_OLED_DIRTY_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// SSD1306 の書き換え範囲をページ (8 行) ごとの列の範囲で持ち、送る時に転送量が少なくなるように矩形にまとめる
+// HAL に依存しないのでホストでもそのままビルドできる
+#define OLED_DIRTY_PAGE_MAX  8U
+#define OLED_DIRTY_XFER_COST 16U  // 1 トランザクションの固定分 [byte]: アドレス 1 + 制御/コマンド 13 + START/STOP を 2 byte 相当
+
+typedef struct
+{
+    uint8_t page_start;
+    uint8_t page_end;
+    uint8_t col_start;
+    uint8_t col_end;
+} oled_dirty_window_t;
+
+// col_min > col_max のページは変更なし
+typedef struct
+{
+    uint8_t col_min[OLED_DIRTY_PAGE_MAX];
+    uint8_t col_max[OLED_DIRTY_PAGE_MAX];
+    uint8_t width;
+    uint8_t pages;
+} oled_dirty_t;
+
+void oled_dirty_init(oled_dirty_t* d, uint8_t width, uint8_t pages);
+void oled_dirty_clear(oled_dirty_t* d);
+bool oled_dirty_any(const oled_dirty_t* d);
+void oled_dirty_mark(oled_dirty_t* d, uint8_t page_start, uint8_t page_end, uint8_t col_start, uint8_t col_end);
+void oled_dirty_mark_rect(oled_dirty_t* d, uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2);
+void oled_dirty_remove(oled_dirty_t* d, const oled_dirty_window_t* w);
+void oled_dirty_narrow(oled_dirty_t* d, const uint8_t* fb, const uint8_t* shadow);
+uint8_t oled_dirty_plan(const oled_dirty_t* d, oled_dirty_window_t* out, uint8_t cap);
+uint32_t oled_dirty_window_cost(const oled_dirty_window_t* w);
+
+#endif /* INC_OLED_DIRTY_H_ */
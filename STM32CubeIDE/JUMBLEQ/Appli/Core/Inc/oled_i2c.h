@@ -0,0 +1,42 @@
+/*
+ * oled_i2c.h
+ *
+ *  Created on: Mar 18, 2026
+ */
+
+#ifndef INC_OLED_I2C_H_
+#define INC_OLED_I2C_H_
+
+#include "ssd1306.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// SSD1306 2 枚への DMA 転送キュー
+// 変わった範囲 (ページ毎の列) を覚えておき、表示中の内容 (shadow) と比べて違うバイトまで縮めてから
+// 転送量が少なくなるように窓にまとめ、1 窓 = アドレス指定コマンド + データを 1 トランザクションで送る
+// i2cMutex は 1 転送 (最長 100ms) の間だけ持ち、転送の間で返すので、同じバスの AK4619/EEPROM はその間に入る
+// submit/run/flush は oledTask からだけ呼ぶ
+// ssd1306_t の port にデバイス番号、bus に I2C ハンドルを入れて ops に oled_i2c_ops を渡す
+#define OLED_I2C_ADDR        (0x3C << 1)
+#define OLED_I2C_MAIN_WIDTH  128U
+#define OLED_I2C_MAIN_HEIGHT 32U
+#define OLED_I2C_SUB_WIDTH   128U
+#define OLED_I2C_SUB_HEIGHT  64U
+
+enum
+{
+    OLED_I2C_MAIN = 0,  // I2C3 128x32
+    OLED_I2C_SUB,       // I2C2 128x64
+    OLED_I2C_DEV_NUM,
+};
+
+extern const ssd1306_ops_t oled_i2c_ops;
+
+void oled_i2c_submit(ssd1306_t* oled, uint8_t page_start, uint8_t page_end, uint8_t col_start, uint8_t col_end);
+void oled_i2c_run(uint32_t budget_ms);
+bool oled_i2c_flush(uint32_t timeout_ms);
+bool oled_i2c_wait_idle(uint32_t timeout_ms);
+void oled_i2c_set_shift(ssd1306_t* oled, uint8_t dx, uint8_t dy);  // 焼き付き防止に表示全体を右/下へずらす
+
+#endif /* INC_OLED_I2C_H_ */
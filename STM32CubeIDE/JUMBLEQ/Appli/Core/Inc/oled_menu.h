@@ -0,0 +1,93 @@
+/*
+ * oled_menu.h
+ *
+ *  Created on: Mar 21, 2026
+ */
+
+#ifndef INC_OLED_MENU_H_
+#define INC_OLED_MENU_H_
+
+#include "ssd1306.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// 項目の表 (ページ) をたどるメニュー。値の項目は設定構造体のバイト (offsetof) に結び付けて直接書き換える
+// 入力は NEXT/PREV/ENTER/BACK のキーとポット (エンコーダーの代わりに、動いた量を段数にする) だけ
+// HAL に依存しないのでホストでもそのままビルドできる
+#define OLED_MENU_DEPTH_MAX   4U
+#define OLED_MENU_POT_DETENTS 24U  // ポットの全域を何段に割るか
+
+enum
+{
+    OLED_MENU_ENUM = 0,  // names[] から選ぶ (values があればその値を書く)
+    OLED_MENU_INT,       // min..max を step ずつ
+    OLED_MENU_ACTION,    // on_action(ctx, action)
+    OLED_MENU_SUBMENU,   // sub のページに入る
+};
+
+enum
+{
+    OLED_MENU_KEY_NEXT = 0,  // 下へ / 値を増やす
+    OLED_MENU_KEY_PREV,      // 上へ / 値を減らす
+    OLED_MENU_KEY_ENTER,     // 入る / 値の編集を始める・決める / 実行
+    OLED_MENU_KEY_BACK,      // 編集を取り消す / 1 つ戻る (一番上なら閉じる)
+};
+
+typedef struct oled_menu_page oled_menu_page_t;
+
+typedef struct
+{
+    const char* label;
+    uint8_t kind;  // OLED_MENU_*
+    uint8_t field; // ENUM/INT: 設定構造体の中の位置
+    uint8_t min;   // INT
+    uint8_t max;   // INT: 上限、ENUM: names の数 - 1
+    uint8_t step;  // INT (0 は 1 と同じ)
+    uint8_t action;
+    const char* const* names;
+    const uint8_t* values;  // ENUM: NULL なら 0..max をそのまま書く
+    const oled_menu_page_t* sub;
+} oled_menu_item_t;
+
+struct oled_menu_page
+{
+    const char* title;
+    const oled_menu_item_t* items;
+    uint8_t num;
+};
+
+typedef struct
+{
+    const oled_menu_page_t* page;
+    uint8_t cursor;
+    uint8_t top;  // 表示している先頭の項目
+} oled_menu_level_t;
+
+typedef struct
+{
+    oled_menu_level_t stack[OLED_MENU_DEPTH_MAX];
+    uint8_t depth;  // 0 = 閉じている
+    bool editing;
+    uint8_t edit_orig;  // 編集を始めた時の値 (BACK で戻す)
+    uint8_t* cfg;
+    uint8_t cfg_len;
+    int32_t pot_ref;  // 最後に段を数えた位置
+    bool pot_valid;
+    bool redraw;
+    bool changed;  // 開いてから値を書き換えた
+    void (*on_change)(void* ctx, const oled_menu_item_t* item);
+    bool (*on_action)(void* ctx, uint8_t action);
+    void* ctx;
+} oled_menu_t;
+
+void oled_menu_open(oled_menu_t* m, const oled_menu_page_t* root, uint8_t* cfg, uint8_t cfg_len);
+void oled_menu_close(oled_menu_t* m);
+bool oled_menu_is_open(const oled_menu_t* m);
+void oled_menu_key(oled_menu_t* m, uint8_t key);
+void oled_menu_pot(oled_menu_t* m, uint16_t pos, uint16_t full);
+const oled_menu_item_t* oled_menu_current(const oled_menu_t* m);
+const char* oled_menu_value_str(const oled_menu_t* m, const oled_menu_item_t* item, char* buf, uint8_t len);
+bool oled_menu_draw(oled_menu_t* m, ssd1306_t* d);
+
+#endif /* INC_OLED_MENU_H_ */
@@ -0,0 +1,74 @@
+/*
+ * oled_sched.h
+ *
+ *  Created on: Mar 22, 2026
+ */
+
+#ifndef INC_OLED_SCHED_H_
+#define INC_OLED_SCHED_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// OLED の領域ごとの描き直しの順番と間隔を決める
+// 値が変わったら post しておき (描く前にまた変わったら最新の値だけ描く)、フレーム毎に
+// 間隔 (最大レート) を過ぎた領域を優先度の高い順、待たされている順に、転送量の見積もりが予算に入るだけ選ぶ
+// 見積もりは領域を含むページ x 列の全部 + 1 トランザクション分なので、実際の転送 (表示中と違うバイトだけ) はこれ以下
+// 予算が足りずに回された領域は、次のフレームで一番長く待っているもの 1 つを優先度に関わらず最初に描く
+// (状態の変化が毎フレーム続いても、大きい領域が止まったままにならない)
+// HAL に依存しないのでホストでもそのままビルドできる
+#define OLED_SCHED_REGION_MAX 24U
+
+enum
+{
+    OLED_SCHED_PRIO_ALERT = 0,  // 状態の変化 (ルーティング、入力、メニューなど)。先に描く
+    OLED_SCHED_PRIO_VALUE,      // 連続して変わる値 (ゲイン、メーターなど)
+    OLED_SCHED_PRIO_NUM,
+};
+
+typedef struct
+{
+    uint8_t x1;  // 描き直す範囲 (両端を含む)
+    uint8_t y1;
+    uint8_t x2;
+    uint8_t y2;
+    uint16_t period_ms;  // 描き直しの最短間隔 (0 なら毎フレーム)
+    uint8_t prio;        // OLED_SCHED_PRIO_*
+} oled_sched_region_def_t;
+
+typedef struct
+{
+    const oled_sched_region_def_t* def;
+    uint32_t last_ms;  // 最後に描いた時刻
+    uint16_t cost;     // 1 回描いた時の転送量の見積もり [byte]
+    bool pending;      // まだ描いていない値がある
+    bool deferred;     // 間隔は過ぎていたが予算が足りずに回された
+} oled_sched_region_t;
+
+typedef struct
+{
+    uint32_t frames;
+    uint32_t drawn;      // 描いた回数
+    uint32_t coalesced;  // 描く前に新しい値で上書きされた回数
+    uint32_t deferred;   // 間隔は過ぎていたが予算が足りずに次のフレームへ回した回数
+    uint32_t bytes;      // 選んだ領域の見積もりの合計
+} oled_sched_stats_t;
+
+typedef struct
+{
+    oled_sched_region_t region[OLED_SCHED_REGION_MAX];
+    uint8_t num;
+    uint16_t budget;  // 1 フレームの転送量 [byte]。これより大きい領域もフレームの最初なら 1 つだけ描く
+    oled_sched_stats_t stats;
+} oled_sched_t;
+
+void oled_sched_init(oled_sched_t* s, uint16_t budget);
+uint8_t oled_sched_add(oled_sched_t* s, const oled_sched_region_def_t* def);  // 領域の番号 (いっぱいなら OLED_SCHED_REGION_MAX)
+void oled_sched_post(oled_sched_t* s, uint8_t region);
+void oled_sched_cancel(oled_sched_t* s, uint8_t region);
+bool oled_sched_pending(const oled_sched_t* s, uint8_t region);
+uint8_t oled_sched_frame(oled_sched_t* s, uint32_t now, uint8_t* out, uint8_t cap);  // このフレームで描く領域を描く順に out へ
+uint16_t oled_sched_cost(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2);
+void oled_sched_take_stats(oled_sched_t* s, oled_sched_stats_t* out);  // 前回から分を返してゼロに戻す
+
+#endif /* INC_OLED_SCHED_H_ */
@@ -0,0 +1,113 @@
+/*
+ * oled_widget.h
+ *
+ *  Created on: Mar 20, 2026
+ */
+
+#ifndef INC_OLED_WIDGET_H_
+#define INC_OLED_WIDGET_H_
+
+#include "oled_dirty.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// SSD1306 のページ形式フレームバッファ (1 byte = 縦 8 ドット) に直接描くメーター類
+// 描く時は列単位でバイトをまとめて書き換え、変わった列だけ dirty に印を付ける
+// HAL に依存しないのでホストでもそのままビルドできる
+#define OLED_WIDGET_HEIGHT_MAX   64U
+#define OLED_GRAPH_WIDTH_MAX     128U
+#define OLED_SPECTRUM_BAND_MAX   32U
+#define OLED_WIDGET_LEVEL_MAX    255U
+
+typedef struct
+{
+    uint8_t* fb;
+    uint8_t width;
+    uint8_t height;
+    oled_dirty_t* dirty;  // NULL なら印を付けない
+} oled_canvas_t;
+
+// ピークホールド: hold_ms だけ止めてから fall_per_s [level/s] で下がる
+typedef struct
+{
+    uint8_t value;
+    uint8_t held;
+    uint32_t tick;
+} oled_peak_t;
+
+typedef struct
+{
+    uint8_t x;
+    uint8_t y;
+    uint8_t w;
+    uint8_t h;
+    uint16_t hold_ms;
+    uint16_t fall_per_s;
+} oled_meter_def_t;
+
+// 横向きのバー + ピークの縦線
+typedef struct
+{
+    const oled_meter_def_t* def;
+    uint8_t level;
+    oled_peak_t peak;
+    uint8_t drawn_len;   // 描いてあるバーの長さ [px]
+    uint8_t drawn_peak;  // 描いてあるピークの位置 [px] (0 = なし)
+    bool drawn;
+} oled_meter_t;
+
+// 右から流れる履歴グラフ (フェーダー位置やゲインリダクション)
+typedef struct
+{
+    uint8_t x;
+    uint8_t y;
+    uint8_t w;
+    uint8_t h;
+    uint8_t hist[OLED_GRAPH_WIDTH_MAX];
+    uint8_t head;  // 次に書く位置
+    bool changed;
+} oled_graph_t;
+
+typedef struct
+{
+    uint8_t x;
+    uint8_t y;
+    uint8_t w;
+    uint8_t h;
+    uint8_t bands;
+    uint8_t band_w;       // バーの幅 [px] (残りの 1px は隙間)
+    uint16_t hold_ms;
+    uint16_t fall_per_s;  // バーとピークの下がる速さ [level/s]
+} oled_spectrum_def_t;
+
+typedef struct
+{
+    const oled_spectrum_def_t* def;
+    uint8_t level[OLED_SPECTRUM_BAND_MAX];
+    oled_peak_t peak[OLED_SPECTRUM_BAND_MAX];
+    uint8_t drawn_len[OLED_SPECTRUM_BAND_MAX];
+    uint8_t drawn_peak[OLED_SPECTRUM_BAND_MAX];
+    uint32_t tick;
+    bool drawn;
+} oled_spectrum_t;
+
+void oled_canvas_column(const oled_canvas_t* c, uint8_t x, uint8_t y, uint8_t h, uint64_t bits);
+void oled_canvas_fill(const oled_canvas_t* c, uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, bool on);
+uint8_t oled_widget_db_to_level(float db, float floor_db);
+
+void oled_peak_update(oled_peak_t* p, uint8_t value, uint32_t now, uint16_t hold_ms, uint16_t fall_per_s);
+
+void oled_meter_init(oled_meter_t* m, const oled_meter_def_t* def);
+void oled_meter_update(oled_meter_t* m, uint8_t value, uint32_t now);
+void oled_meter_draw(oled_meter_t* m, const oled_canvas_t* c);
+
+void oled_graph_init(oled_graph_t* g, uint8_t x, uint8_t y, uint8_t w, uint8_t h);
+void oled_graph_push(oled_graph_t* g, uint8_t value);
+void oled_graph_draw(oled_graph_t* g, const oled_canvas_t* c);
+
+void oled_spectrum_init(oled_spectrum_t* s, const oled_spectrum_def_t* def);
+void oled_spectrum_update(oled_spectrum_t* s, const uint8_t* values, uint32_t now);
+void oled_spectrum_draw(oled_spectrum_t* s, const oled_canvas_t* c);
+
+#endif /* INC_OLED_WIDGET_H_ */
@@ -0,0 +1,48 @@
+/*
+ * pot_filter.h
+ *
+ *  Created on: Mar 10, 2026
+ */
+
+#ifndef INC_POT_FILTER_H_
+#define INC_POT_FILTER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// ポット用の適応ローパス (one-euro filter を固定小数点にしたもの) + ヒステリシス付き量子化
+// 静止時は min_cutoff まで落としてジッタを消し、動かした速さに比例してカットオフを上げて遅れを減らす
+// HAL に依存しないのでホストでもそのままビルドできる
+#define POT_FILTER_IN_BITS  12U   // ADC1 の値 (オーバーサンプリング後)
+#define POT_FILTER_FRAC     4U    // 内部状態の小数ビット
+#define POT_FILTER_RATE_HZ  500U  // ポットが動いている間の更新周期 (2ms)
+
+typedef struct
+{
+    uint16_t min_cutoff_q8;  // 静止時のカットオフ [Hz, Q8]
+    uint16_t max_cutoff_q8;  // カットオフの上限 [Hz, Q8]
+    uint16_t beta_q16;       // 速度 1 LSB/s あたりのカットオフ増分 [Hz, Q16]
+    uint16_t d_cutoff_q8;    // 速度推定のカットオフ [Hz, Q8]
+    uint8_t hyst_q8;         // 出力 1 ステップに対するヒステリシス幅 (256 = 1 ステップ)
+} pot_filter_params_t;
+
+typedef struct
+{
+    int32_t y;    // フィルタ出力 (入力 LSB, Q POT_FILTER_FRAC)
+    int32_t dx;   // 平滑化した速度 [LSB/s]
+    uint16_t out; // 量子化した出力
+    uint8_t out_shift;
+    bool primed;
+} pot_filter_t;
+
+void pot_filter_init(pot_filter_t* f, uint8_t out_bits);
+bool pot_filter_update(pot_filter_t* f, uint32_t raw);
+bool pot_filter_set_params(const pot_filter_params_t* p);
+void pot_filter_get_params(pot_filter_params_t* p);
+
+static inline uint16_t pot_filter_value(const pot_filter_t* f)
+{
+    return f->out;
+}
+
+#endif /* INC_POT_FILTER_H_ */
@@ -0,0 +1,51 @@
+/*
+ * pot_takeover.h
+ *
+ *  Created on: Mar 14, 2026
+ */
+
+#ifndef INC_POT_TAKEOVER_H_
+#define INC_POT_TAKEOVER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// ポットのソフトテイクオーバー
+// ホスト/プリセットがパラメーターを変えると、ポットの位置と今の値がずれる。ずれている間 (未キャッチ) の動き方をモードで選ぶ
+// 位置も値もポットを量子化した単位 (0..full)。HAL に依存しないのでホストでもそのままビルドできる
+enum
+{
+    POT_TAKEOVER_JUMP = 0,  // 動かした瞬間に位置の値へ飛ぶ (従来どおり)
+    POT_TAKEOVER_PICKUP,    // 位置が値をまたぐ (または近づく) までは何もしない
+    POT_TAKEOVER_SCALE,     // 動かした方向の端までの残りを比例配分して、端で位置に合流する
+    POT_TAKEOVER_RELATIVE,  // 動かした量だけ値を動かす。位置と一致したらキャッチ
+    POT_TAKEOVER_MODE_NUM,
+};
+
+#define POT_TAKEOVER_CATCH_DIV 64U  // 位置と値の差が full / これ以内ならキャッチ (最低 1)
+
+typedef struct
+{
+    uint16_t value;  // 今のパラメーター値
+    uint16_t pos;    // 前回のポット位置
+    uint16_t full;
+    bool caught;
+    bool primed;     // pos が有効
+} pot_takeover_t;
+
+void pot_takeover_init(pot_takeover_t* t, uint16_t full);
+void pot_takeover_set_value(pot_takeover_t* t, uint16_t value);
+bool pot_takeover_update(pot_takeover_t* t, uint8_t mode, uint16_t pos);
+int8_t pot_takeover_direction(const pot_takeover_t* t);
+
+static inline uint16_t pot_takeover_value(const pot_takeover_t* t)
+{
+    return t->value;
+}
+
+static inline bool pot_takeover_caught(const pot_takeover_t* t)
+{
+    return t->caught;
+}
+
+#endif /* INC_POT_TAKEOVER_H_ */
@@ -0,0 +1,68 @@
+/*
+ * sigma_prof.h
+ *
+ *  Created on: Mar 7, 2026
+ */
+
+#ifndef INC_SIGMA_PROF_H_
+#define INC_SIGMA_PROF_H_
+
+#include "main.h"
+#include <stdbool.h>
+
+// hspi5 (ADAU1466) の1トランザクションを DWT サイクルで3区間に分けて計測する
+//   mutex: 呼び出し → spiMutex 取得
+//   wire : 転送開始 → 完了割り込み
+//   wake : 完了割り込み → 待ちタスク再開
+// ヒストグラムは log2(us) のバケット: [0] <1us, [k] 2^(k-1)..2^k us, 最後は上限以上すべて
+#define SIGMA_PROF_BUCKET_NUM 16U
+
+enum
+{
+    SIGMA_PROF_CALLER_INIT = 0,  // スケジューラ起動前
+    SIGMA_PROF_CALLER_UI,        // adcTask (ポット/クロスフェーダー)
+    SIGMA_PROF_CALLER_LED,       // ledTask (DSPリードバック)
+    SIGMA_PROF_CALLER_USB,       // usbTask (UAC2 ボリューム等)
+    SIGMA_PROF_CALLER_AUDIO,     // audioTask (サンプルレート変更/プログラム切り替え)
+    SIGMA_PROF_CALLER_OTHER,
+    SIGMA_PROF_CALLER_NUM,
+};
+
+enum
+{
+    SIGMA_PROF_METRIC_MUTEX = 0,
+    SIGMA_PROF_METRIC_WIRE,
+    SIGMA_PROF_METRIC_WAKE,
+    SIGMA_PROF_METRIC_NUM,
+};
+
+typedef struct
+{
+    uint32_t count;
+    uint32_t mutex_timeouts;
+    uint32_t unlocked;  // spiMutex を取らないポーリング転送 (wire のみ記録)
+    uint32_t max_us[SIGMA_PROF_METRIC_NUM];
+    uint64_t sum_us[SIGMA_PROF_METRIC_NUM];
+    uint32_t hist[SIGMA_PROF_METRIC_NUM][SIGMA_PROF_BUCKET_NUM];
+} sigma_prof_stats_t;
+
+// SigmaStudioFW.c から使う計測フック
+uint8_t sigma_prof_caller(void);
+void sigma_prof_begin(uint32_t entry_cyc);
+void sigma_prof_wire_start(void);
+void sigma_prof_wire_done_isr(void);
+void sigma_prof_end(void);
+void sigma_prof_mutex_timeout(void);
+void sigma_prof_blocking(uint32_t start_cyc);
+
+static inline uint32_t sigma_prof_now(void)
+{
+    return DWT->CYCCNT;
+}
+
+bool sigma_prof_get_stats(uint8_t caller, sigma_prof_stats_t* out);
+void sigma_prof_reset(void);
+void sigma_prof_report(void);
+const char* sigma_prof_caller_name(uint8_t caller);
+
+#endif /* INC_SIGMA_PROF_H_ */
@@ -35,7 +35,7 @@ extern "C" {
 extern SPI_HandleTypeDef hspi5;
 
 /* USER CODE BEGIN Private defines */
-
+extern DMA_HandleTypeDef handle_GPDMA1_Channel5;
 /* USER CODE END Private defines */
 
 void MX_SPI5_Init(void);
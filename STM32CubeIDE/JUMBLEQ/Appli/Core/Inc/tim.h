@@ -35,7 +35,9 @@ extern "C" {
 extern TIM_HandleTypeDef htim1;
 
 /* USER CODE BEGIN Private defines */
+extern TIM_HandleTypeDef htim3;
 
+#define POT_SCAN_TIM_HZ 8000U  // ADC1 スキャン周期 (POT_NUM 回で全ポット1周 = 1kHz/ポット)
 /* USER CODE END Private defines */
 
 void MX_TIM1_Init(void);
@@ -43,7 +45,7 @@ void MX_TIM1_Init(void);
 void HAL_TIM_MspPostInit(TIM_HandleTypeDef *htim);
 
 /* USER CODE BEGIN Prototypes */
-
+void MX_TIM3_Init(void);
 /* USER CODE END Prototypes */
 
 #ifdef __cplusplus
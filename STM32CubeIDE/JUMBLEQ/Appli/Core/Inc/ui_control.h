@@ -8,8 +8,35 @@
 #define INC_UI_CONTROL_H_
 
 #include "main.h"
+#include "xfade_curve.h"
 #include <stdbool.h>
 
+// adcTask のスレッドフラグ (MAG_FADER_THREAD_FLAG = 0x0001 は mag_fader.h)
+#define UI_POT_THREAD_FLAG  0x0002U  // ポットが窓を出た / 動いている間は2スキャン (2ms) 毎
+#define UI_MIDI_THREAD_FLAG  0x0004U  // USB MIDI 受信 (tud_midi_rx_cb)
+#define UI_INPUT_THREAD_FLAG 0x0008U  // SW1/SW2 が変わった (ADC スキャン毎に見る)
+#define UI_IDLE_POLL_MS      50U      // 何も起きなくてもこの間隔で起きる (静止中のドリフト追従、MIDI-learn のタイムアウト)
+
+// クロスフェーダー/スルーの割り当て先 (UI_ControlPersistState_t の current_xf*_assign)
+enum
+{
+    INPUT_SRC_CH1_LN = 0,
+    INPUT_SRC_CH1_PN,
+    INPUT_SRC_CH2_LN,
+    INPUT_SRC_CH2_PN,
+    INPUT_SRC_USB12,
+    INPUT_SRC_USB34,
+    INPUT_SRC_NONE,
+};
+
+// 磁気クロスフェーダー (センサー 4,5 = A、0,1 = B)
+enum
+{
+    XFADE_FADER_A = 0,
+    XFADE_FADER_B,
+    XFADE_FADER_NUM,
+};
+
 typedef struct
 {
     uint8_t current_ch1_input_type;
@@ -19,6 +46,9 @@ typedef struct
     uint8_t current_xfpost_assign;
     uint8_t current_ch1_dvs_enable;
     uint8_t current_ch2_dvs_enable;
+    uint8_t current_xf_curve[XFADE_FADER_NUM];  // XFADE_CURVE_*
+    uint8_t current_xf_cut[XFADE_FADER_NUM];    // カットイン (オフセットからの不感帯, ADC LSB)
+    uint8_t current_xf_user_curve[XFADE_USER_POINT_NUM];
 } UI_ControlPersistState_t;
 
 uint8_t get_current_xfA_position(void);
@@ -27,8 +57,8 @@ int16_t get_current_ch1_db(void);
 int16_t get_current_ch2_db(void);
 int16_t get_current_master_db(void);
 int16_t get_current_dry_wet(void);
-uint8_t get_current_xfade2_cc_value(void); // same value as send_control_change for xfade[2]
-uint8_t get_current_xfade3_cc_value(void); // same value as send_control_change for xfade[3]
+uint8_t get_current_xfade2_cc_value(void); // same value as the default CC mapping for xfade[2]
+uint8_t get_current_xfade3_cc_value(void); // same value as the default CC mapping for xfade[3]
 char* get_current_input_typeA_str(void);
 char* get_current_input_typeB_str(void);
 char* get_current_input_srcA_str(void);
@@ -38,12 +68,19 @@ uint8_t get_current_input_srcA_channel(void);  // 0:none, 1:CH1, 2:CH2
 uint8_t get_current_input_srcB_channel(void);  // 0:none, 1:CH1, 2:CH2
 bool get_current_ch1_dvs_enabled(void);
 bool get_current_ch2_dvs_enabled(void);
+uint8_t get_current_xf_curve(uint8_t fader);
+int8_t get_current_dsp_takeover(uint8_t param);  // MIDI_MAP_DSP_*
 
 void start_adc(void);
-void ui_control_task(void);
+void ui_control_wake(uint32_t flags);
+uint32_t ui_control_wake_timeout(void);
+void ui_control_wake_report(void);
 void start_audio_control(void);
 bool is_started_audio_control(void);
 void ui_control_get_persist_state(UI_ControlPersistState_t *state);
 bool ui_control_apply_persist_state(const UI_ControlPersistState_t *state);
+void ui_control_request_persist_state(const UI_ControlPersistState_t *state, bool save);  // 他のタスクから。adcTask で適用 (と保存) する
+bool ui_control_host_set_dsp_param(uint8_t param, uint16_t value);
+bool ui_control_get_dsp_param(uint8_t param, uint16_t* value);
 
 #endif /* INC_UI_CONTROL_H_ */
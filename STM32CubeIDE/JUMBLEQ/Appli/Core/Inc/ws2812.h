@@ -0,0 +1,21 @@
+/*
+ * ws2812.h
+ *
+ *  Created on: Mar 16, 2026
+ */
+
+#ifndef INC_WS2812_H_
+#define INC_WS2812_H_
+
+#include <stdint.h>
+
+// WS2812 の 1 bit を TIM1 PWM の 1 周期 (24 カウント = 1.25us) の比較値 1 byte で表す
+// HAL に依存しないのでホストでもそのままビルドできる (LUT はリトルエンディアン前提)
+#define WS2812_PWM_ONE  16U  // T1H
+#define WS2812_PWM_ZERO 7U   // T0H
+#define WS2812_BYTE_LEN 8U   // 1 色 1 byte → PWM 8 byte
+
+void ws2812_encode(const uint8_t* grb, uint16_t len, uint8_t* out);
+void ws2812_build_gamma(uint8_t lut[256], float gamma, uint8_t brightness);
+
+#endif /* INC_WS2812_H_ */
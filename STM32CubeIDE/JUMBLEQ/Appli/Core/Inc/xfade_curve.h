@@ -0,0 +1,36 @@
+/*
+ * xfade_curve.h
+ *
+ *  Created on: Mar 9, 2026
+ */
+
+#ifndef INC_XFADE_CURVE_H_
+#define INC_XFADE_CURVE_H_
+
+#include <stdint.h>
+
+// クロスフェーダーのカーブ (HAL に依存しないのでホストでもそのままビルドできる)
+// 位置/ゲインとも Q15 で XFADE_Q15_ONE = 1.0。どのカーブも f(0)=0, f(1)=1 で単調非減少
+#define XFADE_Q15_ONE        32768U
+#define XFADE_CURVE_LUT_SIZE 256U
+#define XFADE_USER_POINT_NUM 16U  // ユーザーカーブの制御点 (x = k/15, 値は 0-127)
+
+enum
+{
+    XFADE_CURVE_LINEAR = 0,
+    XFADE_CURVE_CONST_POWER,  // sin(x * pi/2)
+    XFADE_CURVE_SHARP,        // 1 - (1-x)^16 (すぐ全開になるカット用)
+    XFADE_CURVE_SCRATCH,      // x^(1/3) (従来のカーブ)
+    XFADE_CURVE_USER,         // MIDI で描いた16点を線形補間
+    XFADE_CURVE_NUM,
+};
+
+// xfade_curve_lut.c (tools/xfade_curve_gen.go で生成)
+extern const uint16_t xfade_curve_lut[XFADE_CURVE_USER][XFADE_CURVE_LUT_SIZE];
+
+uint16_t xfade_curve_eval(uint8_t curve, uint16_t pos_q15);
+void xfade_curve_set_user_points(const uint8_t points[XFADE_USER_POINT_NUM]);
+void xfade_curve_get_user_points(uint8_t points[XFADE_USER_POINT_NUM]);
+const char* xfade_curve_name(uint8_t curve);
+
+#endif /* INC_XFADE_CURVE_H_ */
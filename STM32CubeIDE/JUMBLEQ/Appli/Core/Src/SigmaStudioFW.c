@@ -8,6 +8,7 @@
 #include "SigmaStudioFW.h"
 
 #include "spi.h"
+#include "sigma_prof.h"
 #include "FreeRTOS.h"
 #include "cmsis_os2.h"
 #include "semphr.h"
@@ -29,6 +30,7 @@ void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef* hspi)
 {
     if (hspi == &hspi5)
     {
+        sigma_prof_wire_done_isr();
         osSemaphoreRelease(spiTxBinarySemHandle);
     }
 }
@@ -37,6 +39,7 @@ void HAL_SPI_TxRxCpltCallback(SPI_HandleTypeDef* hspi)
 {
     if (hspi == &hspi5)
     {
+        sigma_prof_wire_done_isr();
         osSemaphoreRelease(spiTxRxBinarySemHandle);
     }
 }
@@ -62,7 +65,9 @@ void SIGMA_WRITE_REGISTER_BLOCK(uint8_t devAddress, uint16_t address, uint16_t l
     {
         data[i + 3] = pData[i];
     }
+    const uint32_t start_cyc = sigma_prof_now();
     HAL_StatusTypeDef status = HAL_SPI_Transmit(&hspi5, data, 1 + 2 + length, 100);
+    sigma_prof_blocking(start_cyc);
 
     if (status != HAL_OK)
     {
@@ -82,8 +87,10 @@ void SIGMA_WRITE_REGISTER_BLOCK_IT(uint8_t devAddress, uint16_t address, uint16_
     }
 
     // ミューテックスで排他制御（最大200ms待機）
+    const uint32_t entry_cyc = sigma_prof_now();
     if (osMutexAcquire(spiMutexHandle, pdMS_TO_TICKS(200)) == osOK)
     {
+        sigma_prof_begin(entry_cyc);
         spi_tx_buf[0] = devAddress;
         spi_tx_buf[1] = (uint8_t) ((address >> 8) & 0x00FF);
         spi_tx_buf[2] = (uint8_t) (address & 0x00FF);
@@ -94,6 +101,7 @@ void SIGMA_WRITE_REGISTER_BLOCK_IT(uint8_t devAddress, uint16_t address, uint16_
 
         while (osSemaphoreAcquire(spiTxBinarySemHandle, 0) == osOK)
         {}
+        sigma_prof_wire_start();
         HAL_StatusTypeDef status = HAL_SPI_Transmit_IT(&hspi5, spi_tx_buf, 1 + 2 + length);
         if (status == HAL_OK)
         {
@@ -110,65 +118,157 @@ void SIGMA_WRITE_REGISTER_BLOCK_IT(uint8_t devAddress, uint16_t address, uint16_
             sigma_spi_it_write_errors++;
         }
 
+        sigma_prof_end();
         osMutexRelease(spiMutexHandle);
     }
     else
     {
         SEGGER_RTT_printf(0, "[%X] spi mutex timeout\n", address);
         sigma_spi_it_mutex_timeouts++;
+        sigma_prof_mutex_timeout();
     }
 }
 
+// 呼び出し側で spiMutex を保持していること。frame は [dev][addr_hi][addr_lo][data...] の連続領域
+// (メモリマップドFlash上のイメージをコピーせずにそのまま送るため const のまま扱う)
+HAL_StatusTypeDef SIGMA_WRITE_FRAME_DMA(const uint8_t* frame, uint16_t length)
+{
+    HAL_StatusTypeDef status;
+
+    if (hspi5.hdmatx == NULL || spiTxBinarySemHandle == NULL || osKernelGetState() != osKernelRunning)
+    {
+        const uint32_t start_cyc = sigma_prof_now();
+        status                   = HAL_SPI_Transmit(&hspi5, frame, length, 100);
+        sigma_prof_blocking(start_cyc);
+        return status;
+    }
+
+    // mutex は呼び出し側が取得済みなので待ち時間は0として記録
+    sigma_prof_begin(sigma_prof_now());
+    while (osSemaphoreAcquire(spiTxBinarySemHandle, 0) == osOK)
+    {}
+    sigma_prof_wire_start();
+    status = HAL_SPI_Transmit_DMA(&hspi5, frame, length);
+    if (status == HAL_OK)
+    {
+        if (osSemaphoreAcquire(spiTxBinarySemHandle, pdMS_TO_TICKS(100)) != osOK)
+        {
+            (void) HAL_SPI_Abort(&hspi5);
+            status = HAL_TIMEOUT;
+        }
+        else if (hspi5.ErrorCode != HAL_SPI_ERROR_NONE)
+        {
+            status = HAL_ERROR;
+        }
+    }
+    sigma_prof_end();
+
+    return status;
+}
+
+// SPE=0 の間しか CFG1.MBR は書けない。HALは転送完了毎にSPIを無効化するのでアイドル中なら書き換え可能
+uint32_t SIGMA_SPI_SetPrescaler(uint32_t prescaler)
+{
+    const uint32_t prev = hspi5.Instance->CFG1 & SPI_CFG1_MBR;
+
+    __HAL_SPI_DISABLE(&hspi5);
+    MODIFY_REG(hspi5.Instance->CFG1, SPI_CFG1_MBR, prescaler & SPI_CFG1_MBR);
+    hspi5.Init.BaudRatePrescaler = prescaler & SPI_CFG1_MBR;
+
+    return prev;
+}
+
+// SafeLoad の data/address/count は 1 回の取得の中で続けて書く (別タスクのSafeLoadと混ざらないように)
+// スケジューラ起動前は mutex を使わずにポーリングで書く
+bool SIGMA_SPI_Lock(uint32_t timeout_ms)
+{
+    if (osKernelGetState() != osKernelRunning || spiMutexHandle == NULL)
+    {
+        return true;
+    }
+
+    const uint32_t entry_cyc = sigma_prof_now();
+    if (osMutexAcquire(spiMutexHandle, pdMS_TO_TICKS(timeout_ms)) != osOK)
+    {
+        sigma_prof_mutex_timeout();
+        return false;
+    }
+    sigma_prof_begin(entry_cyc);
+    return true;
+}
+
+void SIGMA_SPI_Unlock(void)
+{
+    if (osKernelGetState() != osKernelRunning || spiMutexHandle == NULL)
+    {
+        return;
+    }
+
+    sigma_prof_end();
+    osMutexRelease(spiMutexHandle);
+}
+
 void SIGMA_SAFELOAD_WRITE_DATA(uint8_t devAddress, uint16_t dataAddress, uint16_t length, uint8_t* pData)
+{
+    if (SIGMA_SPI_Lock(200))
+    {
+        (void) SIGMA_SAFELOAD_WRITE_DATA_LOCKED(devAddress, dataAddress, length, pData);
+        SIGMA_SPI_Unlock();
+    }
+}
+
+// 呼び出し側で SIGMA_SPI_Lock() していること
+HAL_StatusTypeDef SIGMA_SAFELOAD_WRITE_DATA_LOCKED(uint8_t devAddress, uint16_t dataAddress, uint16_t length, uint8_t* pData)
 {
     // Use static buffer to avoid stack overflow
     static uint8_t data[64];  // SAFELOAD typically uses small data size
+    HAL_StatusTypeDef status;
+
+    if (length > sizeof(data) - 3U)
+    {
+        SEGGER_RTT_printf(0, "SAFELOAD::[%X] spi write error: length too large\n", dataAddress);
+        return HAL_ERROR;
+    }
+
+    data[0] = devAddress;
+    data[1] = (uint8_t) ((dataAddress >> 8) & 0x00FF);
+    data[2] = (uint8_t) (dataAddress & 0x00FF);
+    for (int i = 0; i < length; i++)
+    {
+        data[i + 3] = pData[i];
+    }
 
     // スケジューラ起動前はポーリングモード、起動後はFreeRTOS同期を使用
     if (osKernelGetState() != osKernelRunning || spiMutexHandle == NULL)
     {
-        // ポーリングモード（初期化時用）
-        data[0] = devAddress;
-        data[1] = (uint8_t) ((dataAddress >> 8) & 0x00FF);
-        data[2] = (uint8_t) (dataAddress & 0x00FF);
-        for (int i = 0; i < length; i++)
-        {
-            data[i + 3] = pData[i];
-        }
-        HAL_StatusTypeDef status = HAL_SPI_Transmit(&hspi5, data, 1 + 2 + length, 100);
+        const uint32_t start_cyc = sigma_prof_now();
+        status                   = HAL_SPI_Transmit(&hspi5, data, 1 + 2 + length, 100);
+        sigma_prof_blocking(start_cyc);
         if (status != HAL_OK)
         {
             SEGGER_RTT_printf(0, "SAFELOAD::[%X] spi write error\n", dataAddress);
         }
-        return;
+        return status;
     }
 
-    // FreeRTOSモード
-    if (osMutexAcquire(spiMutexHandle, pdMS_TO_TICKS(200)) == osOK)
+    while (osSemaphoreAcquire(spiTxBinarySemHandle, 0) == osOK)
+    {}
+    sigma_prof_wire_start();
+    status = HAL_SPI_Transmit_IT(&hspi5, data, 1 + 2 + length);
+    if (status == HAL_OK)
     {
-        data[0] = devAddress;
-        data[1] = (uint8_t) ((dataAddress >> 8) & 0x00FF);
-        data[2] = (uint8_t) (dataAddress & 0x00FF);
-        for (int i = 0; i < length; i++)
-        {
-            data[i + 3] = pData[i];
-        }
-
-        HAL_StatusTypeDef status = HAL_SPI_Transmit_IT(&hspi5, data, 1 + 2 + length);
-        if (status == HAL_OK)
-        {
-            if (osSemaphoreAcquire(spiTxBinarySemHandle, pdMS_TO_TICKS(100)) != osOK)
-            {
-                SEGGER_RTT_printf(0, "SAFELOAD::[%X] spi write timeout\n", dataAddress);
-            }
-        }
-        else
+        if (osSemaphoreAcquire(spiTxBinarySemHandle, pdMS_TO_TICKS(100)) != osOK)
         {
-            SEGGER_RTT_printf(0, "SAFELOAD::[%X] spi write error\n", dataAddress);
+            SEGGER_RTT_printf(0, "SAFELOAD::[%X] spi write timeout\n", dataAddress);
+            status = HAL_TIMEOUT;
         }
-
-        osMutexRelease(spiMutexHandle);
     }
+    else
+    {
+        SEGGER_RTT_printf(0, "SAFELOAD::[%X] spi write error\n", dataAddress);
+    }
+
+    return status;
 }
 
 void SIGMA_WRITE_DELAY(uint8_t devAddress, uint16_t dataAddress, uint16_t length, uint8_t* pData)
@@ -196,8 +296,10 @@ void SIGMA_READ_REGISTER(uint8_t devAddress, uint16_t address, uint16_t length,
     }
 
     // ミューテックスで排他制御（最大200ms待機）
+    const uint32_t entry_cyc = sigma_prof_now();
     if (osMutexAcquire(spiMutexHandle, pdMS_TO_TICKS(200)) == osOK)
     {
+        sigma_prof_begin(entry_cyc);
         // ADAU1466 SPI Read: Chip Address with R/W bit = 1 (read)
         // Format: [Chip Addr | 0x01] [Addr High] [Addr Low] [Dummy bytes for read]
 
@@ -213,6 +315,7 @@ void SIGMA_READ_REGISTER(uint8_t devAddress, uint16_t address, uint16_t length,
 
         while (osSemaphoreAcquire(spiTxRxBinarySemHandle, 0) == osOK)
         {}
+        sigma_prof_wire_start();
         HAL_StatusTypeDef status = HAL_SPI_TransmitReceive_IT(&hspi5, tx_buf, rx_buf, 1 + 2 + length);
 
         if (status == HAL_OK)
@@ -243,10 +346,12 @@ void SIGMA_READ_REGISTER(uint8_t devAddress, uint16_t address, uint16_t length,
             SEGGER_RTT_printf(0, "[%X] spi read error: %d\n", address, status);
         }
 
+        sigma_prof_end();
         osMutexRelease(spiMutexHandle);
     }
     else
     {
         SEGGER_RTT_printf(0, "[%X] spi mutex timeout\n", address);
+        sigma_prof_mutex_timeout();
     }
 }
@@ -8,12 +8,14 @@
 #include "adau1466.h"
 
 #include "SigmaStudioFW.h"
-#include "JUMBLEQ_DSP_ADAU146xSchematic_1.h"
+#include "dsp_library.h"
 #include "JUMBLEQ_DSP_ADAU146xSchematic_1_Defines.h"
 #include "JUMBLEQ_DSP_ADAU146xSchematic_1_PARAM.h"
 
 #include "cmsis_os2.h"
 
+#include <string.h>
+
 #define ADAU1466_REG_PLL_ENABLE 0xF003U
 #define ADAU1466_REG_PLL_LOCK   0xF004U
 #define ADAU1466_REG_MCLK_OUT   0xF005U
@@ -21,12 +23,42 @@
 
 #define ADAU1466_PLL_LOCK_TIMEOUT_MS 200U
 
+#define ADAU1466_SAFELOAD_MAX_WORDS 5U
+#define ADAU1466_SPI_LOCK_WAIT_MS   200U
+#define PHONO_EQ_CH_NUM             2U
+
 typedef struct
 {
     uint8_t clk_gen1_m;
     uint8_t mclk_out;
 } adau1466_sample_rate_cfg_t;
 
+static const uint16_t s_phono_eq_stage_param[PHONO_EQ_CH_NUM][PHONO_EQ_STAGE_NUM] = {
+    {DSP_PARAM_PH_EQ_1_STAGE0, DSP_PARAM_PH_EQ_1_STAGE1, DSP_PARAM_PH_EQ_1_STAGE2},
+    {DSP_PARAM_PH_EQ_2_STAGE0, DSP_PARAM_PH_EQ_2_STAGE1, DSP_PARAM_PH_EQ_2_STAGE2},
+};
+
+// adcTask (set) と audioTask (refresh) の両方から触るので、読み書きは割り込みを止めた短い区間で (spiMutex とは別)
+// 係数の設計は spiMutex の外で、取るのはステージ毎の SafeLoad の間だけ
+typedef struct
+{
+    phono_eq_config_t cfg[PHONO_EQ_CH_NUM];
+    biquad_sigma_q8_24_t written[PHONO_EQ_CH_NUM][PHONO_EQ_STAGE_NUM];
+    bool written_valid[PHONO_EQ_CH_NUM][PHONO_EQ_STAGE_NUM];
+    uint32_t rate_hz;
+    uint32_t gen[PHONO_EQ_CH_NUM];  // cfg か rate_hz を変える度に増やす。設計中に変わったら書くのをやめる
+} adau1466_phono_eq_state_t;
+
+static adau1466_phono_eq_state_t s_phono_eq = {
+    .cfg = {
+        {.curve = PHONO_CURVE_RIAA, .rumble_hz = 0U, .treble_qdb = 0, .treble_hz = PHONO_EQ_TREBLE_HZ_DEF},
+        {.curve = PHONO_CURVE_RIAA, .rumble_hz = 0U, .treble_qdb = 0, .treble_hz = PHONO_EQ_TREBLE_HZ_DEF},
+    },
+    .rate_hz = 48000U,
+};
+
+static volatile uint32_t s_safeload_tick;  // 最後に count を書いた tick (spiMutex の中で書く)
+
 static bool adau1466_get_sample_rate_cfg(uint32_t hz, adau1466_sample_rate_cfg_t* cfg)
 {
     if (cfg == NULL)
@@ -76,6 +108,24 @@ static bool adau1466_wait_pll_lock(uint32_t timeout_ms)
     return false;
 }
 
+static void adau1466_write_param(uint16_t id, ADI_REG_TYPE* data)
+{
+    const uint16_t addr = dsp_param_addr(id);
+    if (addr != DSP_PARAM_ADDR_NONE)
+    {
+        SIGMA_WRITE_REGISTER_BLOCK(DEVICE_ADDR_ADAU146XSCHEMATIC_1, addr, 4, data);
+    }
+}
+
+static void adau1466_write_param_it(uint16_t id, ADI_REG_TYPE* data)
+{
+    const uint16_t addr = dsp_param_addr(id);
+    if (addr != DSP_PARAM_ADDR_NONE)
+    {
+        SIGMA_WRITE_REGISTER_BLOCK_IT(DEVICE_ADDR_ADAU146XSCHEMATIC_1, addr, 4, data);
+    }
+}
+
 double convert_pot2dB(uint16_t adc_val)
 {
     double x  = (double) adc_val / 1023.0;
@@ -124,6 +174,13 @@ double convert_dB2gain(double db)
 void write_q8_24(const uint16_t addr, const double val)
 {
     uint8_t gain_array[4] = {0x00};
+
+    // 選択中のプログラムに存在しないパラメータ
+    if (addr == DSP_PARAM_ADDR_NONE)
+    {
+        return;
+    }
+
     int64_t fixed_q8_24   = (int64_t) llround(val * 16777216.0);  // 2^24
     if (fixed_q8_24 > INT32_MAX)
     {
@@ -167,7 +224,14 @@ bool AUDIO_Update_ADAU1466_SampleRate(uint32_t hz)
     // Re-run SigmaStudio default register/program sequence without HW reset.
     // This keeps runtime update deterministic and aligns with known-good init flow.
 #if RESET_FROM_FW
-    default_download_ADAU146XSCHEMATIC_1();
+    if (!dsp_library_download())
+    {
+        // 選択中イメージが読めない場合は内蔵プログラムで復帰させる
+        (void) dsp_library_select(DSP_LIBRARY_SLOT_BUILTIN);
+        (void) dsp_library_download();
+    }
+    // 新しいプログラムはエクスポート時のゲインで走り出すので、状態を書き戻すまで絞っておく
+    mute_master_out();
     osDelay(5);
 #endif
 
@@ -183,17 +247,23 @@ bool AUDIO_Update_ADAU1466_SampleRate(uint32_t hz)
 
     bool pll_locked = adau1466_wait_pll_lock(ADAU1466_PLL_LOCK_TIMEOUT_MS);
 
+    // Downloadで係数がエクスポート時の値(単一レート前提)に戻るため、現在レートで再計算して戻す
+    if (pll_locked)
+    {
+        refresh_phono_eq(hz);
+    }
+
     return pll_locked;
 }
 
 void set_dc_inputA(float xf_pos)
 {
-    write_q8_24(MOD_DCINPUT_A_DCVALUE_ADDR, xf_pos);
+    write_q8_24(dsp_param_addr(DSP_PARAM_DCINPUT_A), xf_pos);
 }
 
 void set_dc_inputB(float xf_pos)
 {
-    write_q8_24(MOD_DCINPUT_B_DCVALUE_ADDR, xf_pos);
+    write_q8_24(dsp_param_addr(DSP_PARAM_DCINPUT_B), xf_pos);
 }
 
 void control_input_from_usb_gain(uint8_t ch, int16_t db)
@@ -205,16 +275,16 @@ void control_input_from_usb_gain(uint8_t ch, int16_t db)
     switch (ch)
     {
     case 1:
-        write_q8_24(MOD_INPUT_FROM_USB1_GAIN_ADDR, gain);
+        write_q8_24(dsp_param_addr(DSP_PARAM_INPUT_FROM_USB1_GAIN), gain);
         break;
     case 2:
-        write_q8_24(MOD_INPUT_FROM_USB2_GAIN_ADDR, gain);
+        write_q8_24(dsp_param_addr(DSP_PARAM_INPUT_FROM_USB2_GAIN), gain);
         break;
     case 3:
-        write_q8_24(MOD_INPUT_FROM_USB3_GAIN_ADDR, gain);
+        write_q8_24(dsp_param_addr(DSP_PARAM_INPUT_FROM_USB3_GAIN), gain);
         break;
     case 4:
-        write_q8_24(MOD_INPUT_FROM_USB4_GAIN_ADDR, gain);
+        write_q8_24(dsp_param_addr(DSP_PARAM_INPUT_FROM_USB4_GAIN), gain);
         break;
     default:
         break;
@@ -225,53 +295,58 @@ void control_input_from_ch1_gain(const uint16_t adc_val)
 {
     const double db   = (double) convert_pot2dB_int(adc_val);
     const double gain = convert_dB2gain(db);
-    write_q8_24(MOD_INPUT_FROM_CH1_GAIN_ADDR, gain);
+    write_q8_24(dsp_param_addr(DSP_PARAM_INPUT_FROM_CH1_GAIN), gain);
 }
 
 void control_input_from_ch2_gain(const uint16_t adc_val)
 {
     const double db   = (double) convert_pot2dB_int(adc_val);
     const double gain = convert_dB2gain(db);
-    write_q8_24(MOD_INPUT_FROM_CH2_GAIN_ADDR, gain);
+    write_q8_24(dsp_param_addr(DSP_PARAM_INPUT_FROM_CH2_GAIN), gain);
 }
 
 void control_send1_out_gain(const uint16_t adc_val)
 {
     const double db   = (double) convert_pot2dB_int(adc_val);
     const double gain = convert_dB2gain(db);
-    write_q8_24(MOD_SEND1_OUTPUT_GAIN_ADDR, gain);
+    write_q8_24(dsp_param_addr(DSP_PARAM_SEND1_OUTPUT_GAIN), gain);
 }
 
 void control_send2_out_gain(const uint16_t adc_val)
 {
     const double db   = (double) convert_pot2dB_int(adc_val);
     const double gain = convert_dB2gain(db);
-    write_q8_24(MOD_SEND2_OUTPUT_GAIN_ADDR, gain);
+    write_q8_24(dsp_param_addr(DSP_PARAM_SEND2_OUTPUT_GAIN), gain);
 }
 
 void control_dryA_out_gain(const uint16_t adc_val)
 {
     const float rate = cos(pow(adc_val / 1023.0f, 2.0f) * M_PI_2);
-    write_q8_24(MOD_DCINPUT_DRYA_DCVALUE_ADDR, rate);
+    write_q8_24(dsp_param_addr(DSP_PARAM_DCINPUT_DRYA), rate);
 }
 
 void control_dryB_out_gain(const uint16_t adc_val)
 {
     const float rate = cos(pow(adc_val / 1023.0f, 2.0f) * M_PI_2);
-    write_q8_24(MOD_DCINPUT_DRYB_DCVALUE_ADDR, rate);
+    write_q8_24(dsp_param_addr(DSP_PARAM_DCINPUT_DRYB), rate);
 }
 
 void control_wet_out_gain(const uint16_t adc_val)
 {
     const float rate = sin(pow(adc_val / 1023.0f, 2.0f) * M_PI_2);
-    write_q8_24(MOD_DCINPUT_WET_DCVALUE_ADDR, rate);
+    write_q8_24(dsp_param_addr(DSP_PARAM_DCINPUT_WET), rate);
+}
+
+void mute_master_out(void)
+{
+    write_q8_24(dsp_param_addr(DSP_PARAM_MASTER_OUTPUT_GAIN), 0.0);
 }
 
 void control_master_out_gain(const uint16_t adc_val)
 {
     const double db   = (double) convert_pot2dB_int(adc_val);
     const double gain = convert_dB2gain(db);
-    write_q8_24(MOD_MASTER_OUTPUT_GAIN_ADDR, gain);
+    write_q8_24(dsp_param_addr(DSP_PARAM_MASTER_OUTPUT_GAIN), gain);
 }
 
 void set_ch1_line()
@@ -279,8 +354,8 @@ void set_ch1_line()
     ADI_REG_TYPE Mode0_0[4] = {0x01, 0x00, 0x00, 0x00};
     ADI_REG_TYPE Mode0_1[4] = {0x00, 0x00, 0x00, 0x00};
 
-    SIGMA_WRITE_REGISTER_BLOCK_IT(DEVICE_ADDR_ADAU146XSCHEMATIC_1, MOD_LN_PN_SW_1_INDEX_CHANNEL0_ADDR, 4, Mode0_0);
-    SIGMA_WRITE_REGISTER_BLOCK_IT(DEVICE_ADDR_ADAU146XSCHEMATIC_1, MOD_LN_PN_SW_1_INDEX_CHANNEL1_ADDR, 4, Mode0_1);
+    adau1466_write_param_it(DSP_PARAM_LN_PN_SW_1_CH0, Mode0_0);
+    adau1466_write_param_it(DSP_PARAM_LN_PN_SW_1_CH1, Mode0_1);
 }
 
 void set_ch1_phono()
@@ -288,8 +363,8 @@ void set_ch1_phono()
     ADI_REG_TYPE Mode0_0[4] = {0x00, 0x00, 0x00, 0x00};
     ADI_REG_TYPE Mode0_1[4] = {0x01, 0x00, 0x00, 0x00};
 
-    SIGMA_WRITE_REGISTER_BLOCK_IT(DEVICE_ADDR_ADAU146XSCHEMATIC_1, MOD_LN_PN_SW_1_INDEX_CHANNEL0_ADDR, 4, Mode0_0);
-    SIGMA_WRITE_REGISTER_BLOCK_IT(DEVICE_ADDR_ADAU146XSCHEMATIC_1, MOD_LN_PN_SW_1_INDEX_CHANNEL1_ADDR, 4, Mode0_1);
+    adau1466_write_param_it(DSP_PARAM_LN_PN_SW_1_CH0, Mode0_0);
+    adau1466_write_param_it(DSP_PARAM_LN_PN_SW_1_CH1, Mode0_1);
 }
 
 void set_ch2_line()
@@ -297,8 +372,8 @@ void set_ch2_line()
     ADI_REG_TYPE Mode0_0[4] = {0x01, 0x00, 0x00, 0x00};
     ADI_REG_TYPE Mode0_1[4] = {0x00, 0x00, 0x00, 0x00};
 
-    SIGMA_WRITE_REGISTER_BLOCK_IT(DEVICE_ADDR_ADAU146XSCHEMATIC_1, MOD_LN_PN_SW_2_INDEX_CHANNEL0_ADDR, 4, Mode0_0);
-    SIGMA_WRITE_REGISTER_BLOCK_IT(DEVICE_ADDR_ADAU146XSCHEMATIC_1, MOD_LN_PN_SW_2_INDEX_CHANNEL1_ADDR, 4, Mode0_1);
+    adau1466_write_param_it(DSP_PARAM_LN_PN_SW_2_CH0, Mode0_0);
+    adau1466_write_param_it(DSP_PARAM_LN_PN_SW_2_CH1, Mode0_1);
 }
 
 void set_ch2_phono()
@@ -306,8 +381,8 @@ void set_ch2_phono()
     ADI_REG_TYPE Mode0_0[4] = {0x00, 0x00, 0x00, 0x00};
     ADI_REG_TYPE Mode0_1[4] = {0x01, 0x00, 0x00, 0x00};
 
-    SIGMA_WRITE_REGISTER_BLOCK_IT(DEVICE_ADDR_ADAU146XSCHEMATIC_1, MOD_LN_PN_SW_2_INDEX_CHANNEL0_ADDR, 4, Mode0_0);
-    SIGMA_WRITE_REGISTER_BLOCK_IT(DEVICE_ADDR_ADAU146XSCHEMATIC_1, MOD_LN_PN_SW_2_INDEX_CHANNEL1_ADDR, 4, Mode0_1);
+    adau1466_write_param_it(DSP_PARAM_LN_PN_SW_2_CH0, Mode0_0);
+    adau1466_write_param_it(DSP_PARAM_LN_PN_SW_2_CH1, Mode0_1);
 }
 
 void select_input_type(uint8_t ch, uint8_t type)
@@ -347,8 +422,8 @@ void disable_ch1_dvs()
     ADI_REG_TYPE Mode0_0[4] = {0x01, 0x00, 0x00, 0x00};
     ADI_REG_TYPE Mode0_1[4] = {0x00, 0x00, 0x00, 0x00};
 
-    SIGMA_WRITE_REGISTER_BLOCK_IT(DEVICE_ADDR_ADAU146XSCHEMATIC_1, MOD_DVS_SW_1_INDEX_CHANNEL0_ADDR, 4, Mode0_0);
-    SIGMA_WRITE_REGISTER_BLOCK_IT(DEVICE_ADDR_ADAU146XSCHEMATIC_1, MOD_DVS_SW_1_INDEX_CHANNEL1_ADDR, 4, Mode0_1);
+    adau1466_write_param_it(DSP_PARAM_DVS_SW_1_CH0, Mode0_0);
+    adau1466_write_param_it(DSP_PARAM_DVS_SW_1_CH1, Mode0_1);
 }
 
 void enable_ch1_dvs()
@@ -356,8 +431,8 @@ void enable_ch1_dvs()
     ADI_REG_TYPE Mode0_0[4] = {0x00, 0x00, 0x00, 0x00};
     ADI_REG_TYPE Mode0_1[4] = {0x01, 0x00, 0x00, 0x00};
 
-    SIGMA_WRITE_REGISTER_BLOCK_IT(DEVICE_ADDR_ADAU146XSCHEMATIC_1, MOD_DVS_SW_1_INDEX_CHANNEL0_ADDR, 4, Mode0_0);
-    SIGMA_WRITE_REGISTER_BLOCK_IT(DEVICE_ADDR_ADAU146XSCHEMATIC_1, MOD_DVS_SW_1_INDEX_CHANNEL1_ADDR, 4, Mode0_1);
+    adau1466_write_param_it(DSP_PARAM_DVS_SW_1_CH0, Mode0_0);
+    adau1466_write_param_it(DSP_PARAM_DVS_SW_1_CH1, Mode0_1);
 }
 
 void disable_ch2_dvs()
@@ -365,8 +440,8 @@ void disable_ch2_dvs()
     ADI_REG_TYPE Mode0_0[4] = {0x01, 0x00, 0x00, 0x00};
     ADI_REG_TYPE Mode0_1[4] = {0x00, 0x00, 0x00, 0x00};
 
-    SIGMA_WRITE_REGISTER_BLOCK_IT(DEVICE_ADDR_ADAU146XSCHEMATIC_1, MOD_DVS_SW_2_INDEX_CHANNEL0_ADDR, 4, Mode0_0);
-    SIGMA_WRITE_REGISTER_BLOCK_IT(DEVICE_ADDR_ADAU146XSCHEMATIC_1, MOD_DVS_SW_2_INDEX_CHANNEL1_ADDR, 4, Mode0_1);
+    adau1466_write_param_it(DSP_PARAM_DVS_SW_2_CH0, Mode0_0);
+    adau1466_write_param_it(DSP_PARAM_DVS_SW_2_CH1, Mode0_1);
 }
 
 void enable_ch2_dvs()
@@ -374,8 +449,8 @@ void enable_ch2_dvs()
     ADI_REG_TYPE Mode0_0[4] = {0x00, 0x00, 0x00, 0x00};
     ADI_REG_TYPE Mode0_1[4] = {0x01, 0x00, 0x00, 0x00};
 
-    SIGMA_WRITE_REGISTER_BLOCK_IT(DEVICE_ADDR_ADAU146XSCHEMATIC_1, MOD_DVS_SW_2_INDEX_CHANNEL0_ADDR, 4, Mode0_0);
-    SIGMA_WRITE_REGISTER_BLOCK_IT(DEVICE_ADDR_ADAU146XSCHEMATIC_1, MOD_DVS_SW_2_INDEX_CHANNEL1_ADDR, 4, Mode0_1);
+    adau1466_write_param_it(DSP_PARAM_DVS_SW_2_CH0, Mode0_0);
+    adau1466_write_param_it(DSP_PARAM_DVS_SW_2_CH1, Mode0_1);
 }
 
 void enable_dvs(uint8_t ch, bool enable)
@@ -424,7 +499,7 @@ void select_xf_assignA_source(uint8_t ch)
         break;
     }
 
-    SIGMA_WRITE_REGISTER_BLOCK(DEVICE_ADDR_ADAU146XSCHEMATIC_1, MOD_XF_ASSIGN_SW_A_INDEX_ADDR, 4, Mode0);
+    adau1466_write_param(DSP_PARAM_XF_ASSIGN_SW_A, Mode0);
 }
 
 void select_xf_assignB_source(uint8_t ch)
@@ -447,7 +522,7 @@ void select_xf_assignB_source(uint8_t ch)
         break;
     }
 
-    SIGMA_WRITE_REGISTER_BLOCK(DEVICE_ADDR_ADAU146XSCHEMATIC_1, MOD_XF_ASSIGN_SW_B_INDEX_ADDR, 4, Mode0);
+    adau1466_write_param(DSP_PARAM_XF_ASSIGN_SW_B, Mode0);
 }
 
 void select_xf_assignPost_source(uint8_t ch)
@@ -470,5 +545,195 @@ void select_xf_assignPost_source(uint8_t ch)
         break;
     }
 
-    SIGMA_WRITE_REGISTER_BLOCK(DEVICE_ADDR_ADAU146XSCHEMATIC_1, MOD_XF_ASSIGN_SW_POST_INDEX_ADDR, 4, Mode0);
+    adau1466_write_param(DSP_PARAM_XF_ASSIGN_SW_POST, Mode0);
+}
+
+// 呼び出し側で adau1466_safeload_lock() していること
+static void adau1466_safeload_locked(uint16_t addr, const int32_t* words, uint8_t count)
+{
+    uint8_t data[ADAU1466_SAFELOAD_MAX_WORDS * 4U];
+    uint8_t addr_word[4]  = {0x00, 0x00, (uint8_t) ((addr >> 8) & 0xFFU), (uint8_t) (addr & 0xFFU)};
+    uint8_t count_word[4] = {0x00, 0x00, 0x00, count};
+
+    if ((words == NULL) || (count == 0U) || (count > ADAU1466_SAFELOAD_MAX_WORDS) || (addr == DSP_PARAM_ADDR_NONE))
+    {
+        return;
+    }
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+        uint32_t raw      = (uint32_t) words[i];
+        data[i * 4U]      = (uint8_t) ((raw >> 24) & 0xFFU);
+        data[i * 4U + 1U] = (uint8_t) ((raw >> 16) & 0xFFU);
+        data[i * 4U + 2U] = (uint8_t) ((raw >> 8) & 0xFFU);
+        data[i * 4U + 3U] = (uint8_t) (raw & 0xFFU);
+    }
+
+    // data -> target address -> word count の順。count の書き込みで次フレーム境界に一括反映される
+    (void) SIGMA_SAFELOAD_WRITE_DATA_LOCKED(DEVICE_ADDR_ADAU146XSCHEMATIC_1, MOD_SAFELOAD_DATA_SAFELOAD0_ADDR, (uint16_t) (count * 4U), data);
+    (void) SIGMA_SAFELOAD_WRITE_DATA_LOCKED(DEVICE_ADDR_ADAU146XSCHEMATIC_1, MOD_SAFELOAD_ADDR_SAFELOAD_ADDR, 4, addr_word);
+    (void) SIGMA_SAFELOAD_WRITE_DATA_LOCKED(DEVICE_ADDR_ADAU146XSCHEMATIC_1, MOD_SAFELOAD_NUM_SAFELOAD_LOWER_ADDR, 4, count_word);
+
+    s_safeload_tick = osKernelGetTickCount();
+}
+
+// 前のSafeLoadが反映される前にデータレジスタを上書きしないよう、最低1オーディオフレーム空けてから spiMutex を取る
+// 待つのは取る前 (待っている間に他のタスクの SPI を止めない)。取った時にまた同じ tick なら返して待ち直す
+static bool adau1466_safeload_lock(void)
+{
+    for (;;)
+    {
+        const bool running = (osKernelGetState() == osKernelRunning);
+        if (running && (osKernelGetTickCount() == s_safeload_tick))
+        {
+            osDelay(1);
+        }
+        if (!SIGMA_SPI_Lock(ADAU1466_SPI_LOCK_WAIT_MS))
+        {
+            return false;
+        }
+        if (!running || (osKernelGetTickCount() != s_safeload_tick))
+        {
+            return true;
+        }
+        SIGMA_SPI_Unlock();
+    }
+}
+
+void safeload_write_q8_24_words(uint16_t addr, const int32_t* words, uint8_t count)
+{
+    if (!adau1466_safeload_lock())
+    {
+        SEGGER_RTT_printf(0, "[ADAU1466] safeload [%X] spi mutex timeout\n", (unsigned) addr);
+        return;
+    }
+    adau1466_safeload_locked(addr, words, count);
+    SIGMA_SPI_Unlock();
+}
+
+static bool adau1466_phono_eq_stage_written(uint8_t ch, uint8_t i, const biquad_sigma_q8_24_t* q)
+{
+    const uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    const bool same = s_phono_eq.written_valid[ch][i] && (memcmp(&s_phono_eq.written[ch][i], q, sizeof(*q)) == 0);
+    __set_PRIMASK(primask);
+    return same;
+}
+
+// 設定と周波数を写してから、spiMutex を持たずに設計と Q8.24 への変換をする
+// 変わったステージだけ 1 つずつ spiMutex を取って SafeLoad する。途中で新しい設定が来たら (gen が変わったら) そちらに任せる
+static bool adau1466_apply_phono_eq(uint8_t ch)
+{
+    phono_eq_config_t cfg;
+    uint32_t rate_hz;
+    uint32_t gen;
+    biquad_coef_t stages[PHONO_EQ_STAGE_NUM];
+    biquad_sigma_q8_24_t q[PHONO_EQ_STAGE_NUM];
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    cfg     = s_phono_eq.cfg[ch];
+    rate_hz = s_phono_eq.rate_hz;
+    gen     = s_phono_eq.gen[ch];
+    __set_PRIMASK(primask);
+
+    if (!phono_eq_design_stages(&cfg, (double) rate_hz, stages))
+    {
+        SEGGER_RTT_printf(0, "[ADAU1466] phono eq design failed: ch=%u\n", (unsigned) ch);
+        return false;
+    }
+
+    for (uint8_t i = 0; i < PHONO_EQ_STAGE_NUM; i++)
+    {
+        if (!biquad_to_sigma_q8_24(&stages[i], &q[i]))
+        {
+            SEGGER_RTT_printf(0, "[ADAU1466] phono eq stage%u saturated: ch=%u\n", (unsigned) i, (unsigned) ch);
+        }
+    }
+
+    for (uint8_t i = 0; i < PHONO_EQ_STAGE_NUM; i++)
+    {
+        // 変化のないステージはSPIに流さない
+        if (adau1466_phono_eq_stage_written(ch, i, &q[i]))
+        {
+            continue;
+        }
+
+        if (!adau1466_safeload_lock())
+        {
+            SEGGER_RTT_printf(0, "[ADAU1466] phono eq spi mutex timeout: ch=%u\n", (unsigned) ch);
+            return false;
+        }
+        if (s_phono_eq.gen[ch] != gen)
+        {
+            SIGMA_SPI_Unlock();
+            return true;
+        }
+
+        const int32_t words[5] = {q[i].b2, q[i].b1, q[i].b0, q[i].a2, q[i].a1};
+        adau1466_safeload_locked(dsp_param_addr(s_phono_eq_stage_param[ch][i]), words, 5U);
+
+        primask = __get_PRIMASK();
+        __disable_irq();
+        s_phono_eq.written[ch][i]       = q[i];
+        s_phono_eq.written_valid[ch][i] = true;
+        __set_PRIMASK(primask);
+
+        SIGMA_SPI_Unlock();
+    }
+
+    return true;
+}
+
+bool set_phono_eq(uint8_t ch, const phono_eq_config_t* cfg)
+{
+    if ((ch >= PHONO_EQ_CH_NUM) || !phono_eq_config_is_valid(cfg))
+    {
+        return false;
+    }
+
+    const uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    s_phono_eq.cfg[ch] = *cfg;
+    s_phono_eq.gen[ch]++;
+    __set_PRIMASK(primask);
+
+    return adau1466_apply_phono_eq(ch);
+}
+
+bool get_phono_eq(uint8_t ch, phono_eq_config_t* cfg)
+{
+    if ((ch >= PHONO_EQ_CH_NUM) || (cfg == NULL))
+    {
+        return false;
+    }
+
+    const uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    *cfg = s_phono_eq.cfg[ch];
+    __set_PRIMASK(primask);
+
+    return true;
+}
+
+// サンプリング周波数を変えた後 (DSP 側の係数は書き直しが要る) に全ステージを設計し直して送る
+void refresh_phono_eq(uint32_t hz)
+{
+    const uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    s_phono_eq.rate_hz = hz;
+    for (uint8_t ch = 0; ch < PHONO_EQ_CH_NUM; ch++)
+    {
+        for (uint8_t i = 0; i < PHONO_EQ_STAGE_NUM; i++)
+        {
+            s_phono_eq.written_valid[ch][i] = false;
+        }
+        s_phono_eq.gen[ch]++;
+    }
+    __set_PRIMASK(primask);
+
+    for (uint8_t ch = 0; ch < PHONO_EQ_CH_NUM; ch++)
+    {
+        (void) adau1466_apply_phono_eq(ch);
+    }
 }
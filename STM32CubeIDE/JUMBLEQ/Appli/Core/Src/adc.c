@@ -22,6 +22,7 @@
 
 /* USER CODE BEGIN 0 */
 extern DMA_HandleTypeDef handle_HPDMA1_Channel0;
+extern DMA_HandleTypeDef handle_HPDMA1_Channel1;
 /* USER CODE END 0 */
 
 ADC_HandleTypeDef hadc1;
@@ -156,6 +157,32 @@ void MX_ADC1_Init(void)
   }
   /* USER CODE BEGIN ADC1_Init 2 */
   __HAL_LINKDMA(&hadc1, DMA_Handle, handle_HPDMA1_Channel0);
+
+  /* 磁気クロスフェーダー (ch0,3,5,10,12,13) は ADC2 に移したので、ADC1 はポット MUX (ch15) と ch18 の2ランクだけ */
+  hadc1.Init.NbrOfConversion = 2;
+  LL_ADC_REG_SetSequencerLength(ADC1, LL_ADC_REG_SEQ_SCAN_ENABLE_2RANKS);
+  sConfig.SamplingTime = ADC_SAMPLETIME_247CYCLES_5;
+  sConfig.Channel = ADC_CHANNEL_15;
+  sConfig.Rank = ADC_REGULAR_RANK_1;
+  if (HAL_ADC_ConfigChannel(&hadc1, &sConfig) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  sConfig.Channel = ADC_CHANNEL_18;
+  sConfig.Rank = ADC_REGULAR_RANK_2;
+  if (HAL_ADC_ConfigChannel(&hadc1, &sConfig) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  /* TIM3 TRGO で1スキャンずつ変換し、スキャン間に HPDMA がポットの MUX を切り替える
+     (2ランク x 16倍オーバーサンプルで約70us、残りは MUX のセトリング時間) */
+  LL_ADC_REG_SetContinuousMode(ADC1, LL_ADC_REG_CONV_SINGLE);
+  LL_ADC_REG_SetTriggerSource(ADC1, LL_ADC_REG_TRIG_EXT_TIM3_TRGO);
+  LL_ADC_REG_SetTriggerEdge(ADC1, LL_ADC_REG_TRIG_EXT_RISING);
+  hadc1.Init.ContinuousConvMode = DISABLE;
+  hadc1.Init.ExternalTrigConv = ADC_EXTERNALTRIG_T3_TRGO;
+  hadc1.Init.ExternalTrigConvEdge = ADC_EXTERNALTRIGCONVEDGE_RISING;
   /* USER CODE END ADC1_Init 2 */
 
 }
@@ -210,7 +237,46 @@ void MX_ADC2_Init(void)
     Error_Handler();
   }
   /* USER CODE BEGIN ADC2_Init 2 */
+  /* 磁気クロスフェーダー専用 (mag_fader.c): TIM3 TRGO で6chを1スキャン、HPDMA1 Ch1 で循環転送
+     入力は ADC1 と共用の ADC12_INPx。PA5 (INP18) は使わない */
+  hadc2.Init.ScanConvMode = ADC_SCAN_ENABLE;
+  hadc2.Init.ContinuousConvMode = DISABLE;
+  hadc2.Init.NbrOfConversion = 6;
+  hadc2.Init.ExternalTrigConv = ADC_EXTERNALTRIG_T3_TRGO;
+  hadc2.Init.ExternalTrigConvEdge = ADC_EXTERNALTRIGCONVEDGE_RISING;
+  hadc2.Init.ConversionDataManagement = ADC_CONVERSIONDATA_DMA_CIRCULAR;
+  hadc2.Init.OversamplingMode = ENABLE;
+  hadc2.Init.Oversampling.Ratio = ADC_OVERSAMPLING_RATIO_4;
+  hadc2.Init.Oversampling.RightBitShift = ADC_RIGHTBITSHIFT_2;
+  hadc2.Init.Oversampling.TriggeredMode = ADC_TRIGGEREDMODE_SINGLE_TRIGGER;
+  hadc2.Init.Oversampling.OversamplingStopReset = ADC_REGOVERSAMPLING_CONTINUED_MODE;
+  if (HAL_ADC_Init(&hadc2) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  {
+    static const uint32_t mag_channels[6] = {
+      ADC_CHANNEL_0, ADC_CHANNEL_3, ADC_CHANNEL_5, ADC_CHANNEL_10, ADC_CHANNEL_12, ADC_CHANNEL_13,
+    };
+    static const uint32_t mag_ranks[6] = {
+      ADC_REGULAR_RANK_1, ADC_REGULAR_RANK_2, ADC_REGULAR_RANK_3, ADC_REGULAR_RANK_4, ADC_REGULAR_RANK_5, ADC_REGULAR_RANK_6,
+    };
+
+    /* 6ch x (92.5 + 12.5) x 4倍 = 2520 cycle (約21us) で 8kHz に十分収まる */
+    sConfig.SamplingTime = ADC_SAMPLETIME_92CYCLES_5;
+    for (uint32_t i = 0; i < 6U; i++)
+    {
+      sConfig.Channel = mag_channels[i];
+      sConfig.Rank = mag_ranks[i];
+      if (HAL_ADC_ConfigChannel(&hadc2, &sConfig) != HAL_OK)
+      {
+        Error_Handler();
+      }
+    }
+  }
 
+  __HAL_LINKDMA(&hadc2, DMA_Handle, handle_HPDMA1_Channel1);
   /* USER CODE END ADC2_Init 2 */
 
 }
@@ -24,9 +24,15 @@
 #include "ak4619.h"
 #include "adau1466.h"
 #include "SigmaStudioFW.h"
+#include "dsp_library.h"
+#include "sigma_prof.h"
+#include "mag_fader.h"
 
 #define N_SAMPLE_RATES TU_ARRAY_SIZE(sample_rates)
 #define AUDIO_DIAG_LOG 0
+#define SIGMA_PROF_LOG 0  // hspi5 トランザクションの呼び出し元別ヒストグラムを1秒毎に出す
+#define MAG_FADER_LOG  0  // 磁気クロスフェーダーのブロック → DSP 書き込みレイテンシを1秒毎に出す
+#define UI_WAKE_LOG    0  // adcTask の起床回数と CPU 使用率 (run-time stats) を1秒毎に出す
 
 enum
 {
@@ -194,6 +200,9 @@ void AUDIO_LoadAndApplyRoutingFromEEPROM(void)
         ui_state.current_xfpost_assign  = cfg.current_xfpost_assign;
         ui_state.current_ch1_dvs_enable = cfg.current_ch1_dvs_enable;
         ui_state.current_ch2_dvs_enable = cfg.current_ch2_dvs_enable;
+        memcpy(ui_state.current_xf_curve, cfg.current_xf_curve, sizeof(ui_state.current_xf_curve));
+        memcpy(ui_state.current_xf_cut, cfg.current_xf_cut, sizeof(ui_state.current_xf_cut));
+        memcpy(ui_state.current_xf_user_curve, cfg.current_xf_user_curve, sizeof(ui_state.current_xf_user_curve));
 
         if (ui_control_apply_persist_state(&ui_state))
         {
@@ -222,6 +231,9 @@ void AUDIO_LoadAndApplyRoutingFromEEPROM(void)
         ui_state.current_xfpost_assign  = cfg.current_xfpost_assign;
         ui_state.current_ch1_dvs_enable = cfg.current_ch1_dvs_enable;
         ui_state.current_ch2_dvs_enable = cfg.current_ch2_dvs_enable;
+        memcpy(ui_state.current_xf_curve, cfg.current_xf_curve, sizeof(ui_state.current_xf_curve));
+        memcpy(ui_state.current_xf_cut, cfg.current_xf_cut, sizeof(ui_state.current_xf_cut));
+        memcpy(ui_state.current_xf_user_curve, cfg.current_xf_user_curve, sizeof(ui_state.current_xf_user_curve));
         (void)ui_control_apply_persist_state(&ui_state);
 
         if (EEPROM_SaveConfig(&hi2c2, &cfg) == HAL_OK)
@@ -245,6 +257,30 @@ uint32_t get_rx_blink_interval_ms(void)
     return rx_blink_interval_ms;
 }
 
+uint32_t get_current_sample_rate(void)
+{
+    return current_sample_rate;
+}
+
+// SAI RX リングの最新 frames フレーム分を L1/R1 の平均にしてコピーする (表示用なので DMA との競合は気にしない)
+uint32_t audio_copy_rx_mono(int32_t* dst, uint32_t frames)
+{
+    const uint32_t end = sai_rx_rng_buf_index - (sai_rx_rng_buf_index % AUDIO_RING_FRAME_WORDS);
+
+    if (frames > (SAI_RNG_BUF_SIZE / AUDIO_RING_FRAME_WORDS) - 1U)
+    {
+        frames = (SAI_RNG_BUF_SIZE / AUDIO_RING_FRAME_WORDS) - 1U;
+    }
+
+    const uint32_t start = end - frames * AUDIO_RING_FRAME_WORDS;
+    for (uint32_t f = 0; f < frames; f++)
+    {
+        const uint32_t r = (start + f * AUDIO_RING_FRAME_WORDS) & (SAI_RNG_BUF_SIZE - 1);
+        dst[f]           = (sai_rx_rng_buf[r] >> 1) + (sai_rx_rng_buf[r + 1U] >> 1);
+    }
+    return frames;
+}
+
 //--------------------------------------------------------------------+
 // Device callbacks
 //--------------------------------------------------------------------+
@@ -1210,9 +1246,19 @@ void audio_task(void)
         dbg_rx_cplt_rewrite_events = 0u;
         dbg_usb_read_size_min      = DBG_MIN_U16_INIT;
         dbg_usb_read_size_max      = 0u;
+#endif
+#if SIGMA_PROF_LOG
+        sigma_prof_report();
+#endif
+#if MAG_FADER_LOG
+        mag_fader_report();
+#endif
+#if UI_WAKE_LOG
+        ui_control_wake_report();
 #endif
     }
 
+    uint8_t dsp_slot;
     if (is_sr_changed)
     {
 #if RESET_FROM_FW
@@ -1220,6 +1266,12 @@ void audio_task(void)
 #endif
         is_sr_changed = false;
     }
+    else if (dsp_library_take_request(&dsp_slot))
+    {
+#if RESET_FROM_FW
+        AUDIO_Swap_DSP_Program(dsp_slot);
+#endif
+    }
     else
     {
         bool usb_io_slot = (now != s_last_usb_io_tick);
@@ -1317,19 +1369,46 @@ void audio_task(void)
     }
 }
 
+static uint32_t s_sai_rate_hz = 48000;
+
+static void audio_sai_restart(uint32_t new_hz);
+
 void AUDIO_SAI_Reset_ForNewRate(void)
 {
-    static uint32_t prev_hz = 48000;
-    const uint32_t new_hz   = current_sample_rate;
+    if (current_sample_rate == s_sai_rate_hz)
+    {
+        return;
+    }
+
+    audio_sai_restart(current_sample_rate);
+}
+
+void AUDIO_Swap_DSP_Program(uint8_t slot)
+{
+    const uint32_t start_ms = HAL_GetTick();
+
+    // ADAU1466はI2Sのクロックマスタで、ダウンロード中はPLLも止まるためSAIごと作り直す
+    // 停止前にマスターを絞り、旧プログラムの出力が途切れる瞬間のクリックを避ける
+    mute_master_out();
+    osDelay(1);
 
-    if (new_hz == prev_hz)
+    if (!dsp_library_select(slot))
     {
+        ui_control_restore_dsp_state();
         return;
     }
 
+    audio_sai_restart(current_sample_rate);
+
+    SEGGER_RTT_printf(0, "[SAI] DSP program swapped in %lu ms\n", (unsigned long) (HAL_GetTick() - start_ms));
+}
+
+static void audio_sai_restart(uint32_t new_hz)
+{
     /* Stop ADC DMA to prevent parameter changes during ADAU1466 initialization */
     (void) HAL_ADC_Stop(&hadc1);
     (void) HAL_DMA_Abort(&handle_HPDMA1_Channel0);
+    mag_fader_stop();
     ui_control_set_adc_complete(false);
     __DSB();
 
@@ -1407,6 +1486,13 @@ void AUDIO_SAI_Reset_ForNewRate(void)
         AUDIO_Init_ADAU1466(new_hz);
         AUDIO_LoadAndApplyRoutingFromEEPROM();
     }
+
+    // ダウンロードでパラメータが初期値に戻るので、現在のルーティング・ゲインを書き戻す
+    ui_control_restore_dsp_state();
+    for (uint8_t ch = 1; ch <= CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX; ch++)
+    {
+        control_input_from_usb_gain(ch, volume[ch] / 256);
+    }
 #endif
 
     /* Re-init DMA channels (linked-list mode) */
@@ -1494,26 +1580,11 @@ void AUDIO_SAI_Reset_ForNewRate(void)
     hsai_BlockA1.Instance->CR1 |= SAI_xCR1_DMAEN;
     __HAL_SAI_ENABLE(&hsai_BlockA1);
 
-    /* Restart ADC DMA after sample rate change is complete */
-    if (MX_List_HPDMA1_Channel0_Config() != HAL_OK)
-    {
-        Error_Handler();
-    }
-    if (HAL_DMAEx_List_LinkQ(&handle_HPDMA1_Channel0, &List_HPDMA1_Channel0) != HAL_OK)
-    {
-        Error_Handler();
-    }
-    handle_HPDMA1_Channel0.XferCpltCallback = ui_control_dma_adc_cplt;
-    if (HAL_DMAEx_List_Start_IT(&handle_HPDMA1_Channel0) != HAL_OK)
-    {
-        Error_Handler();
-    }
-    if (HAL_ADC_Start(&hadc1) != HAL_OK)
-    {
-        Error_Handler();
-    }
+    /* Restart ADC DMA after sample rate change is complete (TIM3 は動かしたまま) */
+    ui_control_restart_adc_scan();
+    mag_fader_start();
 
-    SEGGER_RTT_printf(0, "[SAI] reset for %lu Hz (prev=%lu)\n", (unsigned long) new_hz, (unsigned long) prev_hz);
+    SEGGER_RTT_printf(0, "[SAI] reset for %lu Hz (prev=%lu)\n", (unsigned long) new_hz, (unsigned long) s_sai_rate_hz);
 
-    prev_hz = new_hz;
+    s_sai_rate_hz = new_hz;
 }
@@ -0,0 +1,129 @@
+/*
+ * audio_spectrum.c
+ *
+ *  Created on: Mar 20, 2026
+ */
+
+#include "audio_spectrum.h"
+
+#include <math.h>
+
+#define AUDIO_SPECTRUM_PI       3.14159265f
+#define AUDIO_SPECTRUM_FLOOR_DB -120.0f
+
+// フルスケールの正弦波が 0dB: Hann 窓のピーク bin の振幅は A * N / 4
+#define AUDIO_SPECTRUM_REF ((float) AUDIO_SPECTRUM_N / 4.0f * 2147483648.0f)
+
+static uint16_t audio_spectrum_bit_reverse(uint16_t i)
+{
+    uint16_t r = 0;
+    for (uint16_t n = AUDIO_SPECTRUM_N >> 1; n != 0U; n >>= 1)
+    {
+        r = (uint16_t) ((r << 1) | (i & 1U));
+        i >>= 1;
+    }
+    return r;
+}
+
+void audio_spectrum_init(audio_spectrum_t* a, uint8_t bands, uint32_t sample_rate, float f_lo, float f_hi)
+{
+    for (uint16_t i = 0; i < AUDIO_SPECTRUM_N; i++)
+    {
+        a->window[i] = 0.5f - 0.5f * cosf(2.0f * AUDIO_SPECTRUM_PI * (float) i / (float) AUDIO_SPECTRUM_N);
+    }
+    for (uint16_t k = 0; k < AUDIO_SPECTRUM_N / 2U; k++)
+    {
+        a->tw_re[k] = cosf(2.0f * AUDIO_SPECTRUM_PI * (float) k / (float) AUDIO_SPECTRUM_N);
+        a->tw_im[k] = -sinf(2.0f * AUDIO_SPECTRUM_PI * (float) k / (float) AUDIO_SPECTRUM_N);
+    }
+
+    a->bands       = (bands < AUDIO_SPECTRUM_BAND_MAX) ? bands : (uint8_t) AUDIO_SPECTRUM_BAND_MAX;
+    a->sample_rate = sample_rate;
+
+    // 対数間隔。低い方で bin が足りない時は 1 bin ずつ進める
+    const float bin_hz = (float) sample_rate / (float) AUDIO_SPECTRUM_N;
+    const float ratio  = (a->bands != 0U) ? powf(f_hi / f_lo, 1.0f / (float) a->bands) : 1.0f;
+    float f            = f_lo;
+    uint16_t prev      = 0;
+    for (uint8_t b = 0; b <= a->bands; b++)
+    {
+        uint16_t bin = (uint16_t) (f / bin_hz + 0.5f);
+        if (bin <= prev)
+        {
+            bin = (uint16_t) (prev + 1U);
+        }
+        if (bin > AUDIO_SPECTRUM_N / 2U)
+        {
+            bin = AUDIO_SPECTRUM_N / 2U;
+        }
+        a->edge[b] = bin;
+        prev       = bin;
+        f *= ratio;
+    }
+}
+
+static void audio_spectrum_fft(audio_spectrum_t* a)
+{
+    for (uint16_t i = 0; i < AUDIO_SPECTRUM_N; i++)
+    {
+        const uint16_t j = audio_spectrum_bit_reverse(i);
+        if (j > i)
+        {
+            const float tr = a->re[i];
+            const float ti = a->im[i];
+            a->re[i]       = a->re[j];
+            a->im[i]       = a->im[j];
+            a->re[j]       = tr;
+            a->im[j]       = ti;
+        }
+    }
+
+    for (uint16_t len = 2; len <= AUDIO_SPECTRUM_N; len <<= 1)
+    {
+        const uint16_t half = len >> 1;
+        const uint16_t step = (uint16_t) (AUDIO_SPECTRUM_N / len);
+        for (uint16_t i = 0; i < AUDIO_SPECTRUM_N; i = (uint16_t) (i + len))
+        {
+            for (uint16_t k = 0; k < half; k++)
+            {
+                const float wr   = a->tw_re[k * step];
+                const float wi   = a->tw_im[k * step];
+                const uint16_t p = (uint16_t) (i + k);
+                const uint16_t q = (uint16_t) (p + half);
+                const float xr   = a->re[q] * wr - a->im[q] * wi;
+                const float xi   = a->re[q] * wi + a->im[q] * wr;
+                a->re[q]         = a->re[p] - xr;
+                a->im[q]         = a->im[p] - xi;
+                a->re[p] += xr;
+                a->im[p] += xi;
+            }
+        }
+    }
+}
+
+// samples (N 点、int32 フルスケール) から各バンドの一番大きい bin を dBFS で返す
+void audio_spectrum_process(audio_spectrum_t* a, const int32_t* samples, float* band_db)
+{
+    for (uint16_t i = 0; i < AUDIO_SPECTRUM_N; i++)
+    {
+        a->re[i] = (float) samples[i] * a->window[i];
+        a->im[i] = 0.0f;
+    }
+    audio_spectrum_fft(a);
+
+    const float ref2 = AUDIO_SPECTRUM_REF * AUDIO_SPECTRUM_REF;
+    for (uint8_t b = 0; b < a->bands; b++)
+    {
+        float max_pow = 0.0f;
+        for (uint16_t k = a->edge[b]; (k < a->edge[b + 1U]) && (k < AUDIO_SPECTRUM_N / 2U); k++)
+        {
+            const float pw = a->re[k] * a->re[k] + a->im[k] * a->im[k];
+            max_pow        = (pw > max_pow) ? pw : max_pow;
+        }
+        band_db[b] = (max_pow > 0.0f) ? 10.0f * log10f(max_pow / ref2) : AUDIO_SPECTRUM_FLOOR_DB;
+        if (band_db[b] < AUDIO_SPECTRUM_FLOOR_DB)
+        {
+            band_db[b] = AUDIO_SPECTRUM_FLOOR_DB;
+        }
+    }
+}
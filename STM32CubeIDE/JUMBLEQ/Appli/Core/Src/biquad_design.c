@@ -0,0 +1,464 @@
+/*
+ * biquad_design.c
+ *
+ *  Created on: Mar 2, 2026
+ */
+
+#include "biquad_design.h"
+
+#include <math.h>
+#include <stddef.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+#ifndef M_SQRT1_2
+#define M_SQRT1_2 0.70710678118654752440
+#endif
+
+#define BIQUAD_Q8_24_SCALE 16777216.0  // 2^24
+
+#define PHONO_REF_HZ           1000.0
+#define PHONO_IEC_T_US         7950.0
+#define PHONO_HF_MATCH_HZ      20000.0
+#define PHONO_HF_MATCH_MAX_FS  0.42
+#define PHONO_HF_ZERO_LIMIT    0.95
+#define PHONO_HF_ZERO_BISECT   48U
+
+typedef struct
+{
+    double t1_us;  // LF pole
+    double t2_us;  // Mid zero
+    double t3_us;  // HF pole
+} phono_curve_tc_t;
+
+static const phono_curve_tc_t s_phono_curve_tc[PHONO_CURVE_NUM] = {
+    [PHONO_CURVE_RIAA]     = {3180.0, 318.0, 75.0 },
+    [PHONO_CURVE_RIAA_IEC] = {3180.0, 318.0, 75.0 },
+    [PHONO_CURVE_COLUMBIA] = {1590.0, 318.0, 100.0},
+    [PHONO_CURVE_FLAT]     = {0.0,    0.0,   0.0  },
+};
+
+static bool biquad_freq_is_valid(double fc, double fs)
+{
+    return (fs > 0.0) && (fc > 0.0) && (fc < (fs * 0.5));
+}
+
+static bool biquad_normalize(double b0, double b1, double b2, double a0, double a1, double a2, biquad_coef_t* out)
+{
+    if ((out == NULL) || (a0 == 0.0))
+    {
+        return false;
+    }
+
+    out->b0 = b0 / a0;
+    out->b1 = b1 / a0;
+    out->b2 = b2 / a0;
+    out->a1 = a1 / a0;
+    out->a2 = a2 / a0;
+    return true;
+}
+
+void biquad_design_identity(biquad_coef_t* out)
+{
+    if (out == NULL)
+    {
+        return;
+    }
+
+    out->b0 = 1.0;
+    out->b1 = 0.0;
+    out->b2 = 0.0;
+    out->a1 = 0.0;
+    out->a2 = 0.0;
+}
+
+bool biquad_design_lowpass(double fc, double q, double fs, biquad_coef_t* out)
+{
+    if (!biquad_freq_is_valid(fc, fs) || (q <= 0.0))
+    {
+        return false;
+    }
+
+    const double w0    = 2.0 * M_PI * fc / fs;
+    const double cosw  = cos(w0);
+    const double alpha = sin(w0) / (2.0 * q);
+
+    return biquad_normalize((1.0 - cosw) * 0.5, 1.0 - cosw, (1.0 - cosw) * 0.5, 1.0 + alpha, -2.0 * cosw, 1.0 - alpha, out);
+}
+
+bool biquad_design_highpass(double fc, double q, double fs, biquad_coef_t* out)
+{
+    if (!biquad_freq_is_valid(fc, fs) || (q <= 0.0))
+    {
+        return false;
+    }
+
+    const double w0    = 2.0 * M_PI * fc / fs;
+    const double cosw  = cos(w0);
+    const double alpha = sin(w0) / (2.0 * q);
+
+    return biquad_normalize((1.0 + cosw) * 0.5, -(1.0 + cosw), (1.0 + cosw) * 0.5, 1.0 + alpha, -2.0 * cosw, 1.0 - alpha, out);
+}
+
+bool biquad_design_highpass_1st(double fc, double fs, biquad_coef_t* out)
+{
+    if (!biquad_freq_is_valid(fc, fs))
+    {
+        return false;
+    }
+
+    // Prewarped bilinear (カットオフ周波数をアナログと一致させる)
+    const double k = tan(M_PI * fc / fs);
+    return biquad_normalize(1.0, -1.0, 0.0, 1.0 + k, k - 1.0, 0.0, out);
+}
+
+bool biquad_design_peaking(double fc, double q, double gain_db, double fs, biquad_coef_t* out)
+{
+    if (!biquad_freq_is_valid(fc, fs) || (q <= 0.0))
+    {
+        return false;
+    }
+
+    const double a     = pow(10.0, gain_db / 40.0);
+    const double w0    = 2.0 * M_PI * fc / fs;
+    const double cosw  = cos(w0);
+    const double alpha = sin(w0) / (2.0 * q);
+
+    return biquad_normalize(1.0 + alpha * a, -2.0 * cosw, 1.0 - alpha * a, 1.0 + alpha / a, -2.0 * cosw, 1.0 - alpha / a, out);
+}
+
+static bool biquad_shelf_params(double fc, double slope, double gain_db, double fs, double* a, double* cosw, double* two_sqrt_a_alpha)
+{
+    if (!biquad_freq_is_valid(fc, fs) || (slope <= 0.0))
+    {
+        return false;
+    }
+
+    const double amp  = pow(10.0, gain_db / 40.0);
+    const double w0   = 2.0 * M_PI * fc / fs;
+    const double term = (amp + 1.0 / amp) * (1.0 / slope - 1.0) + 2.0;
+    if (term < 0.0)
+    {
+        return false;
+    }
+
+    const double alpha = sin(w0) * 0.5 * sqrt(term);
+
+    *a                = amp;
+    *cosw             = cos(w0);
+    *two_sqrt_a_alpha = 2.0 * sqrt(amp) * alpha;
+    return true;
+}
+
+bool biquad_design_lowshelf(double fc, double slope, double gain_db, double fs, biquad_coef_t* out)
+{
+    double a, c, s;
+    if (!biquad_shelf_params(fc, slope, gain_db, fs, &a, &c, &s))
+    {
+        return false;
+    }
+
+    return biquad_normalize(a * ((a + 1.0) - (a - 1.0) * c + s),
+                            2.0 * a * ((a - 1.0) - (a + 1.0) * c),
+                            a * ((a + 1.0) - (a - 1.0) * c - s),
+                            (a + 1.0) + (a - 1.0) * c + s,
+                            -2.0 * ((a - 1.0) + (a + 1.0) * c),
+                            (a + 1.0) + (a - 1.0) * c - s,
+                            out);
+}
+
+bool biquad_design_highshelf(double fc, double slope, double gain_db, double fs, biquad_coef_t* out)
+{
+    double a, c, s;
+    if (!biquad_shelf_params(fc, slope, gain_db, fs, &a, &c, &s))
+    {
+        return false;
+    }
+
+    return biquad_normalize(a * ((a + 1.0) + (a - 1.0) * c + s),
+                            -2.0 * a * ((a - 1.0) + (a + 1.0) * c),
+                            a * ((a + 1.0) + (a - 1.0) * c - s),
+                            (a + 1.0) - (a - 1.0) * c + s,
+                            2.0 * ((a - 1.0) - (a + 1.0) * c),
+                            (a + 1.0) - (a - 1.0) * c - s,
+                            out);
+}
+
+static double biquad_magnitude(const biquad_coef_t* coef, double f, double fs)
+{
+    const double w  = 2.0 * M_PI * f / fs;
+    const double c1 = cos(w);
+    const double s1 = sin(w);
+    const double c2 = cos(2.0 * w);
+    const double s2 = sin(2.0 * w);
+
+    const double nr = coef->b0 + coef->b1 * c1 + coef->b2 * c2;
+    const double ni = -(coef->b1 * s1 + coef->b2 * s2);
+    const double dr = 1.0 + coef->a1 * c1 + coef->a2 * c2;
+    const double di = -(coef->a1 * s1 + coef->a2 * s2);
+
+    const double den = dr * dr + di * di;
+    if (den <= 0.0)
+    {
+        return 0.0;
+    }
+    return sqrt((nr * nr + ni * ni) / den);
+}
+
+double biquad_magnitude_db(const biquad_coef_t* coef, double f, double fs)
+{
+    if ((coef == NULL) || (fs <= 0.0))
+    {
+        return -INFINITY;
+    }
+
+    return 20.0 * log10(biquad_magnitude(coef, f, fs));
+}
+
+static double phono_curve_analog_magnitude(const phono_curve_tc_t* tc, double f)
+{
+    const double w  = 2.0 * M_PI * f;
+    const double t1 = tc->t1_us * 1e-6;
+    const double t2 = tc->t2_us * 1e-6;
+    const double t3 = tc->t3_us * 1e-6;
+
+    return sqrt(1.0 + (w * t2) * (w * t2)) / (sqrt(1.0 + (w * t1) * (w * t1)) * sqrt(1.0 + (w * t3) * (w * t3)));
+}
+
+double phono_curve_reference_db(uint8_t curve, double f)
+{
+    if ((curve >= PHONO_CURVE_NUM) || (f <= 0.0))
+    {
+        return -INFINITY;
+    }
+
+    if (curve == PHONO_CURVE_FLAT)
+    {
+        return 0.0;
+    }
+
+    const phono_curve_tc_t* tc = &s_phono_curve_tc[curve];
+    double mag                 = phono_curve_analog_magnitude(tc, f) / phono_curve_analog_magnitude(tc, PHONO_REF_HZ);
+
+    if (curve == PHONO_CURVE_RIAA_IEC)
+    {
+        // 1次HP: |jwT / (1 + jwT)|
+        const double wt     = 2.0 * M_PI * f * PHONO_IEC_T_US * 1e-6;
+        const double wt_ref = 2.0 * M_PI * PHONO_REF_HZ * PHONO_IEC_T_US * 1e-6;
+        mag *= (wt / sqrt(1.0 + wt * wt)) / (wt_ref / sqrt(1.0 + wt_ref * wt_ref));
+    }
+
+    return 20.0 * log10(mag);
+}
+
+// |1 + r*e^-jw|
+static double phono_hf_zero_magnitude(double r, double w)
+{
+    return sqrt(1.0 + 2.0 * r * cos(w) + r * r);
+}
+
+bool biquad_design_phono_curve(uint8_t curve, double fs, biquad_coef_t* out)
+{
+    if ((out == NULL) || (curve >= PHONO_CURVE_NUM) || (fs <= 0.0))
+    {
+        return false;
+    }
+
+    if (curve == PHONO_CURVE_FLAT)
+    {
+        biquad_design_identity(out);
+        return true;
+    }
+
+    // 極/零点は matched-z で配置し、bilinear のようなナイキスト付近の潰れを避ける。
+    // matched-z 単体では高域の振幅が合わないため、z = -r に補正零点を1つ置き、
+    // 1kHz 基準の HF 振幅がアナログ原型と一致するよう r を二分探索で求める。
+    const phono_curve_tc_t* tc = &s_phono_curve_tc[curve];
+    const double p1            = exp(-1e6 / (tc->t1_us * fs));
+    const double p3            = exp(-1e6 / (tc->t3_us * fs));
+    const double z2            = exp(-1e6 / (tc->t2_us * fs));
+
+    biquad_coef_t base = {
+        .b0 = 1.0,
+        .b1 = -z2,
+        .b2 = 0.0,
+        .a1 = -(p1 + p3),
+        .a2 = p1 * p3,
+    };
+
+    double f_hf = PHONO_HF_MATCH_HZ;
+    if (f_hf > (fs * PHONO_HF_MATCH_MAX_FS))
+    {
+        f_hf = fs * PHONO_HF_MATCH_MAX_FS;
+    }
+
+    const double w_ref  = 2.0 * M_PI * PHONO_REF_HZ / fs;
+    const double w_hf   = 2.0 * M_PI * f_hf / fs;
+    const double analog = phono_curve_analog_magnitude(tc, f_hf) / phono_curve_analog_magnitude(tc, PHONO_REF_HZ);
+    const double digital = biquad_magnitude(&base, f_hf, fs) / biquad_magnitude(&base, PHONO_REF_HZ, fs);
+    const double target  = analog / digital;
+
+    // g(r) = |1 + r e^-jw_hf| / |1 + r e^-jw_ref| は r に対して単調減少
+    double lo = -PHONO_HF_ZERO_LIMIT;
+    double hi = PHONO_HF_ZERO_LIMIT;
+    for (uint32_t i = 0; i < PHONO_HF_ZERO_BISECT; i++)
+    {
+        const double mid = 0.5 * (lo + hi);
+        const double g   = phono_hf_zero_magnitude(mid, w_hf) / phono_hf_zero_magnitude(mid, w_ref);
+        if (g > target)
+        {
+            lo = mid;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    const double r = 0.5 * (lo + hi);
+
+    out->b0 = 1.0;
+    out->b1 = r - z2;
+    out->b2 = -r * z2;
+    out->a1 = base.a1;
+    out->a2 = base.a2;
+
+    // 1kHz = 0dB に正規化（後段の PH_EQ_GAIN で絶対ゲインを決める）
+    const double k = 1.0 / biquad_magnitude(out, PHONO_REF_HZ, fs);
+    out->b0 *= k;
+    out->b1 *= k;
+    out->b2 *= k;
+    return true;
+}
+
+static int32_t biquad_q8_24_saturate(double val, bool* clipped)
+{
+    double scaled = round(val * BIQUAD_Q8_24_SCALE);
+    if (scaled > (double) INT32_MAX)
+    {
+        *clipped = true;
+        return INT32_MAX;
+    }
+    if (scaled < (double) INT32_MIN)
+    {
+        *clipped = true;
+        return INT32_MIN;
+    }
+    return (int32_t) scaled;
+}
+
+bool biquad_to_sigma_q8_24(const biquad_coef_t* coef, biquad_sigma_q8_24_t* out)
+{
+    bool clipped = false;
+
+    if ((coef == NULL) || (out == NULL))
+    {
+        return false;
+    }
+
+    out->b2 = biquad_q8_24_saturate(coef->b2, &clipped);
+    out->b1 = biquad_q8_24_saturate(coef->b1, &clipped);
+    out->b0 = biquad_q8_24_saturate(coef->b0, &clipped);
+    out->a2 = biquad_q8_24_saturate(-coef->a2, &clipped);
+    out->a1 = biquad_q8_24_saturate(-coef->a1, &clipped);
+    return !clipped;
+}
+
+void biquad_from_sigma_q8_24(const biquad_sigma_q8_24_t* in, biquad_coef_t* out)
+{
+    if ((in == NULL) || (out == NULL))
+    {
+        return;
+    }
+
+    out->b0 = (double) in->b0 / BIQUAD_Q8_24_SCALE;
+    out->b1 = (double) in->b1 / BIQUAD_Q8_24_SCALE;
+    out->b2 = (double) in->b2 / BIQUAD_Q8_24_SCALE;
+    out->a1 = -(double) in->a1 / BIQUAD_Q8_24_SCALE;
+    out->a2 = -(double) in->a2 / BIQUAD_Q8_24_SCALE;
+}
+
+void phono_eq_config_set_defaults(phono_eq_config_t* cfg)
+{
+    if (cfg == NULL)
+    {
+        return;
+    }
+
+    cfg->curve      = PHONO_CURVE_RIAA;
+    cfg->rumble_hz  = 0U;
+    cfg->treble_qdb = 0;
+    cfg->treble_hz  = PHONO_EQ_TREBLE_HZ_DEF;
+}
+
+bool phono_eq_config_is_valid(const phono_eq_config_t* cfg)
+{
+    if (cfg == NULL)
+    {
+        return false;
+    }
+
+    if (cfg->curve >= PHONO_CURVE_NUM)
+    {
+        return false;
+    }
+    if ((cfg->rumble_hz != 0U) && ((cfg->rumble_hz < PHONO_EQ_RUMBLE_HZ_MIN) || (cfg->rumble_hz > PHONO_EQ_RUMBLE_HZ_MAX)))
+    {
+        return false;
+    }
+    if (((double) cfg->treble_qdb * 0.25 > PHONO_EQ_TREBLE_DB_MAX) || ((double) cfg->treble_qdb * 0.25 < -PHONO_EQ_TREBLE_DB_MAX))
+    {
+        return false;
+    }
+    if ((cfg->treble_hz < PHONO_EQ_TREBLE_HZ_MIN) || (cfg->treble_hz > PHONO_EQ_TREBLE_HZ_MAX))
+    {
+        return false;
+    }
+    return true;
+}
+
+bool phono_eq_design_stages(const phono_eq_config_t* cfg, double fs, biquad_coef_t stages[PHONO_EQ_STAGE_NUM])
+{
+    if (!phono_eq_config_is_valid(cfg) || (stages == NULL))
+    {
+        return false;
+    }
+
+    // STAGE0: Rumble HP (IEC カーブ時は rumble off でも 7950us の1次HPを入れる)
+    if (cfg->rumble_hz != 0U)
+    {
+        if (!biquad_design_highpass((double) cfg->rumble_hz, M_SQRT1_2, fs, &stages[0]))
+        {
+            return false;
+        }
+    }
+    else if (cfg->curve == PHONO_CURVE_RIAA_IEC)
+    {
+        if (!biquad_design_highpass_1st(1e6 / (2.0 * M_PI * PHONO_IEC_T_US), fs, &stages[0]))
+        {
+            return false;
+        }
+    }
+    else
+    {
+        biquad_design_identity(&stages[0]);
+    }
+
+    // STAGE1: De-emphasis curve
+    if (!biquad_design_phono_curve(cfg->curve, fs, &stages[1]))
+    {
+        return false;
+    }
+
+    // STAGE2: Cartridge HF補正用の High-shelf
+    if (cfg->treble_qdb == 0)
+    {
+        biquad_design_identity(&stages[2]);
+    }
+    else if (!biquad_design_highshelf((double) cfg->treble_hz, 1.0, (double) cfg->treble_qdb * 0.25, fs, &stages[2]))
+    {
+        return false;
+    }
+
+    return true;
+}
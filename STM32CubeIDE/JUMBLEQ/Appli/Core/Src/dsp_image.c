@@ -0,0 +1,146 @@
+/*
+ * dsp_image.c
+ *
+ *  Created on: Mar 23, 2026
+ */
+
+#include "dsp_image.h"
+
+#include <string.h>
+
+// CRC-32 (IEEE 802.3, reflected) 4bitテーブル
+static const uint32_t s_crc32_nibble[16] = {
+    0x00000000UL, 0x1DB71064UL, 0x3B6E20C8UL, 0x26D930ACUL,
+    0x76DC4190UL, 0x6B6B51F4UL, 0x4DB26158UL, 0x5005713CUL,
+    0xEDB88320UL, 0xF00F9344UL, 0xD6D6A3E8UL, 0xCB61B38CUL,
+    0x9B64C2B0UL, 0x86D3D2D4UL, 0xA00AE278UL, 0xBDBDF21CUL,
+};
+
+uint32_t dsp_image_crc32(const uint8_t* p, uint32_t len)
+{
+    uint32_t crc = 0xFFFFFFFFUL;
+
+    for (uint32_t i = 0; i < len; i++)
+    {
+        crc ^= p[i];
+        crc = (crc >> 4) ^ s_crc32_nibble[crc & 0x0FU];
+        crc = (crc >> 4) ^ s_crc32_nibble[crc & 0x0FU];
+    }
+    return ~crc;
+}
+
+bool dsp_image_check_header(const dsp_image_header_t* img, uint32_t max_size)
+{
+    if ((img->magic != DSP_IMAGE_MAGIC) || (img->version != DSP_IMAGE_VERSION))
+    {
+        return false;
+    }
+    if ((img->header_size < sizeof(dsp_image_header_t)) || (img->image_size > max_size) || (img->header_size > img->image_size))
+    {
+        return false;
+    }
+    if ((img->op_count == 0U) || (img->op_offset > img->image_size) || ((img->image_size - img->op_offset) / sizeof(dsp_image_op_t) < img->op_count))
+    {
+        return false;
+    }
+    if ((img->param_offset > img->image_size) || ((img->image_size - img->param_offset) / sizeof(dsp_image_param_t) < img->param_count))
+    {
+        return false;
+    }
+    if ((img->symbol_offset > img->image_size) || ((img->image_size - img->symbol_offset) / sizeof(dsp_image_symbol_t) < img->symbol_count))
+    {
+        return false;
+    }
+    return ((img->op_offset % 4U) == 0U) && ((img->param_offset % 2U) == 0U) && ((img->symbol_offset % 4U) == 0U);
+}
+
+bool dsp_image_check_ops(const dsp_image_header_t* img)
+{
+    const uint8_t* base      = (const uint8_t*) img;
+    const dsp_image_op_t* op = (const dsp_image_op_t*) (base + img->op_offset);
+
+    for (uint16_t i = 0; i < img->op_count; i++, op++)
+    {
+        switch (op->type)
+        {
+        case DSP_IMAGE_OP_WRITE:
+            if ((op->length == 0U) || (op->length > (DSP_IMAGE_FRAME_MAX - DSP_IMAGE_FRAME_HDR_SIZE)) ||
+                (op->stored <= DSP_IMAGE_FRAME_HDR_SIZE) ||
+                (op->offset < img->header_size) || (op->offset > img->image_size) ||
+                ((img->image_size - op->offset) < op->stored))
+            {
+                return false;
+            }
+            // 圧縮ストリームの中身は展開時に検査する
+            if (((op->flags & DSP_IMAGE_OP_FLAG_LZ) == 0U) && (op->stored != (op->length + DSP_IMAGE_FRAME_HDR_SIZE)))
+            {
+                return false;
+            }
+            break;
+        case DSP_IMAGE_OP_DELAY:
+            if (op->length > DSP_IMAGE_DELAY_MAX_MS)
+            {
+                return false;
+            }
+            break;
+        default:
+            return false;
+        }
+    }
+    return true;
+}
+
+// ヘッダ、op 表、CRC の順に見る。max_size はスロットの大きさ
+bool dsp_image_validate(const dsp_image_header_t* img, uint32_t max_size)
+{
+    if (!dsp_image_check_header(img, max_size) || !dsp_image_check_ops(img))
+    {
+        return false;
+    }
+
+    const uint8_t* base = (const uint8_t*) img;
+    return dsp_image_crc32(base + img->header_size, img->image_size - img->header_size) == img->crc32;
+}
+
+// src[0..src_len) を dst に展開する。出力がちょうど dst_len にならなければ失敗
+bool dsp_image_lz_decode(const uint8_t* src, uint32_t src_len, uint8_t* dst, uint32_t dst_len)
+{
+    uint32_t in  = 0;
+    uint32_t out = 0;
+
+    while (in < src_len)
+    {
+        const uint8_t token = src[in++];
+
+        if ((token & DSP_IMAGE_LZ_MATCH_FLAG) == 0U)
+        {
+            const uint32_t n = (uint32_t) token + 1U;
+            if ((n > (src_len - in)) || (n > (dst_len - out)))
+            {
+                return false;
+            }
+            memcpy(&dst[out], &src[in], n);
+            in += n;
+            out += n;
+            continue;
+        }
+
+        if ((src_len - in) < 2U)
+        {
+            return false;
+        }
+        const uint32_t n    = (uint32_t) (token & ~DSP_IMAGE_LZ_MATCH_FLAG) + DSP_IMAGE_LZ_MATCH_MIN;
+        const uint32_t dist = (uint32_t) src[in] | ((uint32_t) src[in + 1U] << 8);
+        in += 2U;
+        if ((dist == 0U) || (dist > out) || (n > (dst_len - out)))
+        {
+            return false;
+        }
+        // 重なりあり (dist < n) で RLE になるので1byteずつコピー
+        for (uint32_t k = 0; k < n; k++, out++)
+        {
+            dst[out] = dst[out - dist];
+        }
+    }
+    return out == dst_len;
+}
@@ -0,0 +1,307 @@
+/*
+ * dsp_library.c
+ *
+ *  Created on: Mar 6, 2026
+ */
+
+#include "dsp_library.h"
+
+#include "SigmaStudioFW.h"
+#include "JUMBLEQ_DSP_ADAU146xSchematic_1.h"
+#include "JUMBLEQ_DSP_ADAU146xSchematic_1_PARAM.h"
+
+#include "FreeRTOS.h"
+#include "cmsis_os2.h"
+
+#include <stddef.h>
+#include <string.h>
+
+// ADAU1466 の SPI 書き込みは最大 22MHz。ダウンロード中だけこの上限以下の最速設定に切り替える
+#define DSP_LIBRARY_SPI_FAST_HZ   20000000UL
+#define DSP_LIBRARY_MUTEX_WAIT_MS 500U
+
+extern osMutexId_t spiMutexHandle;
+
+static const uint16_t s_builtin_param_addr[DSP_PARAM_NUM] = {
+    [DSP_PARAM_INPUT_FROM_USB1_GAIN] = MOD_INPUT_FROM_USB1_GAIN_ADDR,
+    [DSP_PARAM_INPUT_FROM_USB2_GAIN] = MOD_INPUT_FROM_USB2_GAIN_ADDR,
+    [DSP_PARAM_INPUT_FROM_USB3_GAIN] = MOD_INPUT_FROM_USB3_GAIN_ADDR,
+    [DSP_PARAM_INPUT_FROM_USB4_GAIN] = MOD_INPUT_FROM_USB4_GAIN_ADDR,
+    [DSP_PARAM_INPUT_FROM_CH1_GAIN]  = MOD_INPUT_FROM_CH1_GAIN_ADDR,
+    [DSP_PARAM_INPUT_FROM_CH2_GAIN]  = MOD_INPUT_FROM_CH2_GAIN_ADDR,
+    [DSP_PARAM_SEND1_OUTPUT_GAIN]    = MOD_SEND1_OUTPUT_GAIN_ADDR,
+    [DSP_PARAM_SEND2_OUTPUT_GAIN]    = MOD_SEND2_OUTPUT_GAIN_ADDR,
+    [DSP_PARAM_MASTER_OUTPUT_GAIN]   = MOD_MASTER_OUTPUT_GAIN_ADDR,
+    [DSP_PARAM_DCINPUT_A]            = MOD_DCINPUT_A_DCVALUE_ADDR,
+    [DSP_PARAM_DCINPUT_B]            = MOD_DCINPUT_B_DCVALUE_ADDR,
+    [DSP_PARAM_DCINPUT_DRYA]         = MOD_DCINPUT_DRYA_DCVALUE_ADDR,
+    [DSP_PARAM_DCINPUT_DRYB]         = MOD_DCINPUT_DRYB_DCVALUE_ADDR,
+    [DSP_PARAM_DCINPUT_WET]          = MOD_DCINPUT_WET_DCVALUE_ADDR,
+    [DSP_PARAM_LN_PN_SW_1_CH0]       = MOD_LN_PN_SW_1_INDEX_CHANNEL0_ADDR,
+    [DSP_PARAM_LN_PN_SW_1_CH1]       = MOD_LN_PN_SW_1_INDEX_CHANNEL1_ADDR,
+    [DSP_PARAM_LN_PN_SW_2_CH0]       = MOD_LN_PN_SW_2_INDEX_CHANNEL0_ADDR,
+    [DSP_PARAM_LN_PN_SW_2_CH1]       = MOD_LN_PN_SW_2_INDEX_CHANNEL1_ADDR,
+    [DSP_PARAM_DVS_SW_1_CH0]         = MOD_DVS_SW_1_INDEX_CHANNEL0_ADDR,
+    [DSP_PARAM_DVS_SW_1_CH1]         = MOD_DVS_SW_1_INDEX_CHANNEL1_ADDR,
+    [DSP_PARAM_DVS_SW_2_CH0]         = MOD_DVS_SW_2_INDEX_CHANNEL0_ADDR,
+    [DSP_PARAM_DVS_SW_2_CH1]         = MOD_DVS_SW_2_INDEX_CHANNEL1_ADDR,
+    [DSP_PARAM_XF_ASSIGN_SW_A]       = MOD_XF_ASSIGN_SW_A_INDEX_ADDR,
+    [DSP_PARAM_XF_ASSIGN_SW_B]       = MOD_XF_ASSIGN_SW_B_INDEX_ADDR,
+    [DSP_PARAM_XF_ASSIGN_SW_POST]    = MOD_XF_ASSIGN_SW_POST_INDEX_ADDR,
+    [DSP_PARAM_PH_EQ_1_STAGE0]       = MOD_PH_EQ_1_STAGE0_B2_ADDR,
+    [DSP_PARAM_PH_EQ_1_STAGE1]       = MOD_PH_EQ_1_STAGE1_B2_ADDR,
+    [DSP_PARAM_PH_EQ_1_STAGE2]       = MOD_PH_EQ_1_STAGE2_B2_ADDR,
+    [DSP_PARAM_PH_EQ_2_STAGE0]       = MOD_PH_EQ_2_STAGE0_B2_ADDR,
+    [DSP_PARAM_PH_EQ_2_STAGE1]       = MOD_PH_EQ_2_STAGE1_B2_ADDR,
+    [DSP_PARAM_PH_EQ_2_STAGE2]       = MOD_PH_EQ_2_STAGE2_B2_ADDR,
+    [DSP_PARAM_READBACK_A]           = MOD_DSPREADBACK_A_VALUE_ADDR,
+    [DSP_PARAM_READBACK_B]           = MOD_DSPREADBACK_B_VALUE_ADDR,
+    [DSP_PARAM_RUNNINGAVERAGE_A]     = MOD_RUNNINGAVERAGE_A_RMSTCINDBPS_ADDR,
+    [DSP_PARAM_RUNNINGAVERAGE_B]     = MOD_RUNNINGAVERAGE_B_RMSTCINDBPS_ADDR,
+};
+
+// 圧縮 op の展開先。1 op ずつ展開してはDMAで流すので、イメージ全体をRAMに置く必要はない
+__attribute__((section("noncacheable_buffer"), aligned(32))) static uint8_t s_frame_buf[DSP_IMAGE_FRAME_MAX];
+
+static uint16_t s_image_param_addr[DSP_PARAM_NUM];
+static const uint16_t* s_param_addr        = s_builtin_param_addr;
+static uint8_t s_active_slot               = DSP_LIBRARY_SLOT_BUILTIN;
+static volatile uint8_t s_request_slot     = DSP_LIBRARY_SLOT_BUILTIN;
+static volatile bool s_request_pending     = false;
+static volatile bool s_downloading         = false;
+
+static HAL_StatusTypeDef dsp_library_write_op(const uint8_t* base, const dsp_image_op_t* op)
+{
+    const uint8_t* frame = base + op->offset;
+
+    if ((op->flags & DSP_IMAGE_OP_FLAG_LZ) == 0U)
+    {
+        // frame はフラッシュ上で [dev][addr][data] の連続領域になっているので、そのままDMAで流す
+        return SIGMA_WRITE_FRAME_DMA(frame, (uint16_t) op->stored);
+    }
+
+    memcpy(s_frame_buf, frame, DSP_IMAGE_FRAME_HDR_SIZE);
+    if (!dsp_image_lz_decode(frame + DSP_IMAGE_FRAME_HDR_SIZE, op->stored - DSP_IMAGE_FRAME_HDR_SIZE,
+                               s_frame_buf + DSP_IMAGE_FRAME_HDR_SIZE, op->length))
+    {
+        return HAL_ERROR;
+    }
+    return SIGMA_WRITE_FRAME_DMA(s_frame_buf, (uint16_t) (op->length + DSP_IMAGE_FRAME_HDR_SIZE));
+}
+
+static void dsp_library_load_param_map(uint8_t slot)
+{
+    if (slot == DSP_LIBRARY_SLOT_BUILTIN)
+    {
+        s_param_addr = s_builtin_param_addr;
+        return;
+    }
+
+    // イメージに載っていない論理パラメータは「存在しない」扱い（書き込みはスキップされる）
+    for (uint16_t i = 0; i < DSP_PARAM_NUM; i++)
+    {
+        s_image_param_addr[i] = DSP_PARAM_ADDR_NONE;
+    }
+
+    const dsp_image_header_t* img  = dsp_library_get_image(slot);
+    const dsp_image_param_t* param = (const dsp_image_param_t*) ((const uint8_t*) img + img->param_offset);
+    for (uint16_t i = 0; i < img->param_count; i++)
+    {
+        if (param[i].id < DSP_PARAM_NUM)
+        {
+            s_image_param_addr[param[i].id] = param[i].addr;
+        }
+    }
+    s_param_addr = s_image_param_addr;
+}
+
+static uint32_t dsp_library_fast_prescaler(void)
+{
+    const uint32_t kernel_hz = HAL_RCCEx_GetPeriphCLKFreq(RCC_PERIPHCLK_SPI45);
+
+    // MBR: 0 = /2 ... 7 = /256
+    for (uint32_t mbr = 0; mbr < 8U; mbr++)
+    {
+        if ((kernel_hz >> (mbr + 1U)) <= DSP_LIBRARY_SPI_FAST_HZ)
+        {
+            return mbr << SPI_CFG1_MBR_Pos;
+        }
+    }
+    return SPI_BAUDRATEPRESCALER_256;
+}
+
+uint16_t dsp_param_addr(uint16_t id)
+{
+    if (id >= DSP_PARAM_NUM)
+    {
+        return DSP_PARAM_ADDR_NONE;
+    }
+
+    return s_param_addr[id];
+}
+
+const dsp_image_header_t* dsp_library_get_image(uint8_t slot)
+{
+    if (slot >= DSP_LIBRARY_SLOT_NUM)
+    {
+        return NULL;
+    }
+    return (const dsp_image_header_t*) (DSP_LIBRARY_BASE_ADDR + (uint32_t) slot * DSP_LIBRARY_SLOT_SIZE);
+}
+
+bool dsp_library_validate(uint8_t slot)
+{
+    if (slot == DSP_LIBRARY_SLOT_BUILTIN)
+    {
+        return true;
+    }
+
+    const dsp_image_header_t* img = dsp_library_get_image(slot);
+    return (img != NULL) && dsp_image_validate(img, DSP_LIBRARY_SLOT_SIZE);
+}
+
+uint16_t dsp_library_find_symbol(uint8_t slot, const char* name)
+{
+    // 内蔵プログラムはシンボル表を持たない (PARAM.h の定数を直接使う)
+    if ((name == NULL) || (slot == DSP_LIBRARY_SLOT_BUILTIN) || !dsp_library_validate(slot))
+    {
+        return DSP_PARAM_ADDR_NONE;
+    }
+
+    const dsp_image_header_t* img = dsp_library_get_image(slot);
+    const uint8_t* base           = (const uint8_t*) img;
+    const dsp_image_symbol_t* sym = (const dsp_image_symbol_t*) (base + img->symbol_offset);
+    const size_t len              = strlen(name);
+
+    for (uint16_t i = 0; i < img->symbol_count; i++, sym++)
+    {
+        if ((sym->name_len == len) && (sym->name_offset <= img->image_size) && ((img->image_size - sym->name_offset) >= len) &&
+            (memcmp(base + sym->name_offset, name, len) == 0))
+        {
+            return sym->addr;
+        }
+    }
+    return DSP_PARAM_ADDR_NONE;
+}
+
+bool dsp_library_request(uint8_t slot)
+{
+    // 検証はミュート前に済ませ、壊れたイメージでは音を止めない
+    if (!dsp_library_validate(slot))
+    {
+        SEGGER_RTT_printf(0, "[DSPLIB] slot %u invalid\n", (unsigned) slot);
+        return false;
+    }
+
+    s_request_slot = slot;
+    __DMB();
+    s_request_pending = true;
+    return true;
+}
+
+bool dsp_library_take_request(uint8_t* slot)
+{
+    if (!s_request_pending || (slot == NULL))
+    {
+        return false;
+    }
+
+    s_request_pending = false;
+    __DMB();
+    *slot = s_request_slot;
+    return true;
+}
+
+bool dsp_library_select(uint8_t slot)
+{
+    if ((slot != DSP_LIBRARY_SLOT_BUILTIN) && (dsp_library_get_image(slot) == NULL))
+    {
+        return false;
+    }
+
+    s_active_slot = slot;
+    dsp_library_load_param_map(slot);
+
+    if (slot == DSP_LIBRARY_SLOT_BUILTIN)
+    {
+        SEGGER_RTT_printf(0, "[DSPLIB] select builtin\n");
+    }
+    else
+    {
+        const dsp_image_header_t* img = dsp_library_get_image(slot);
+        SEGGER_RTT_printf(0, "[DSPLIB] select slot %u: %.16s\n", (unsigned) slot, img->name);
+    }
+    return true;
+}
+
+uint8_t dsp_library_active_slot(void)
+{
+    return s_active_slot;
+}
+
+bool dsp_library_is_downloading(void)
+{
+    return s_downloading;
+}
+
+bool dsp_library_download(void)
+{
+    if (s_active_slot == DSP_LIBRARY_SLOT_BUILTIN)
+    {
+        default_download_ADAU146XSCHEMATIC_1();
+        return true;
+    }
+
+    const dsp_image_header_t* img = dsp_library_get_image(s_active_slot);
+    if (!dsp_image_check_header(img, DSP_LIBRARY_SLOT_SIZE))
+    {
+        SEGGER_RTT_printf(0, "[DSPLIB] slot %u header broken\n", (unsigned) s_active_slot);
+        return false;
+    }
+
+    const bool use_rtos = (osKernelGetState() == osKernelRunning) && (spiMutexHandle != NULL);
+    if (use_rtos && (osMutexAcquire(spiMutexHandle, pdMS_TO_TICKS(DSP_LIBRARY_MUTEX_WAIT_MS)) != osOK))
+    {
+        SEGGER_RTT_printf(0, "[DSPLIB] spi mutex timeout\n");
+        return false;
+    }
+
+    s_downloading = true;
+    const uint32_t prev_mbr = SIGMA_SPI_SetPrescaler(dsp_library_fast_prescaler());
+
+    const uint8_t* base      = (const uint8_t*) img;
+    const dsp_image_op_t* op = (const dsp_image_op_t*) (base + img->op_offset);
+    const uint32_t start_ms  = HAL_GetTick();
+    bool ok                  = true;
+
+    for (uint16_t i = 0; (i < img->op_count) && ok; i++, op++)
+    {
+        if (op->type == DSP_IMAGE_OP_WRITE)
+        {
+            ok = (dsp_library_write_op(base, op) == HAL_OK);
+            if (!ok)
+            {
+                SEGGER_RTT_printf(0, "[DSPLIB] op%u [%X] write failed\n", (unsigned) i, (unsigned) op->addr);
+            }
+        }
+        else if (use_rtos)
+        {
+            osDelay(op->length);
+        }
+        else
+        {
+            HAL_Delay(op->length);
+        }
+    }
+
+    (void) SIGMA_SPI_SetPrescaler(prev_mbr);
+    s_downloading = false;
+
+    if (use_rtos)
+    {
+        osMutexRelease(spiMutexHandle);
+    }
+
+    SEGGER_RTT_printf(0, "[DSPLIB] slot %u downloaded in %lu ms\n", (unsigned) s_active_slot, (unsigned long) (HAL_GetTick() - start_ms));
+    return ok;
+}
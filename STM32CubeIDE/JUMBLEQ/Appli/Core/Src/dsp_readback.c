@@ -0,0 +1,236 @@
+/*
+ * dsp_readback.c
+ *
+ *  Created on: Mar 4, 2026
+ */
+
+#include "dsp_readback.h"
+
+#include "ui_control.h"
+
+#include "SigmaStudioFW.h"
+#include "dsp_library.h"
+
+// DSPREADBACK_A..B を1回の SPI バーストで読む（SIGMA_READ_REGISTER の上限は61byte）
+// アドレスは選択中のプログラム次第なので、範囲に収まらない場合はメーター毎に読む
+#define DSP_READBACK_BURST_WORDS_MAX 15U
+
+// RUNNINGAVERAGE は RMSTCINDBPS, HOLD, DECAY の3ワードが連続配置
+#define DSP_READBACK_SETTINGS_WORDS 3U
+
+#define DSP_READBACK_REF_LOG2       23.0f
+#define DSP_READBACK_DB_PER_LOG2    6.0205999f  // 20*log10(2)
+#define DSP_READBACK_LOG2_TABLE_BIT 5U
+#define DSP_READBACK_SNAPSHOT_RETRY 4U
+
+// log2(1 + i/32), i = 0..32
+static const float s_log2_table[(1U << DSP_READBACK_LOG2_TABLE_BIT) + 1U] = {
+    0.0000000f, 0.0443941f, 0.0874628f, 0.1292830f,
+    0.1699250f, 0.2094534f, 0.2479275f, 0.2854022f,
+    0.3219281f, 0.3575520f, 0.3923174f, 0.4262648f,
+    0.4594316f, 0.4918531f, 0.5235620f, 0.5545889f,
+    0.5849625f, 0.6147098f, 0.6438562f, 0.6724253f,
+    0.7004397f, 0.7279205f, 0.7548875f, 0.7813597f,
+    0.8073549f, 0.8328900f, 0.8579810f, 0.8826430f,
+    0.9068906f, 0.9307373f, 0.9541963f, 0.9772799f,
+    1.0000000f,
+};
+
+static const uint16_t s_settings_param[DSP_READBACK_METER_NUM] = {
+    DSP_PARAM_RUNNINGAVERAGE_A,
+    DSP_PARAM_RUNNINGAVERAGE_B,
+};
+
+static const uint16_t s_meter_param[DSP_READBACK_METER_NUM] = {
+    DSP_PARAM_READBACK_A,
+    DSP_PARAM_READBACK_B,
+};
+
+// 書き込みは ledTask のみ。seq が奇数の間は更新中
+static volatile uint32_t s_seq = 0U;
+static dsp_readback_snapshot_t s_snapshot = {
+    .dbfs = {DSP_READBACK_FLOOR_DB, DSP_READBACK_FLOOR_DB},
+};
+
+static dsp_readback_snapshot_t s_work;
+static uint32_t s_last_read_ms     = 0U;
+static uint32_t s_last_settings_ms = 0U;
+static bool s_settings_valid       = false;
+
+static uint32_t dsp_readback_be32(const uint8_t* p)
+{
+    return ((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16) | ((uint32_t) p[2] << 8) | (uint32_t) p[3];
+}
+
+static float dsp_readback_log2_u32(uint32_t val)
+{
+    const uint32_t msb = 31U - (uint32_t) __builtin_clz(val);
+
+    // 仮数部を Q16 に揃え、上位5bitでテーブル参照・残りで線形補間
+    uint32_t mant = (msb >= 16U) ? (val >> (msb - 16U)) : (val << (16U - msb));
+    mant -= (1U << 16);
+
+    const uint32_t idx  = mant >> (16U - DSP_READBACK_LOG2_TABLE_BIT);
+    const uint32_t rem  = mant & ((1U << (16U - DSP_READBACK_LOG2_TABLE_BIT)) - 1U);
+    const float frac    = (float) rem * (1.0f / (float) (1U << (16U - DSP_READBACK_LOG2_TABLE_BIT)));
+    const float log2_lo = s_log2_table[idx];
+
+    return (float) msb + log2_lo + (s_log2_table[idx + 1U] - log2_lo) * frac;
+}
+
+float dsp_readback_raw_to_dbfs(uint32_t raw)
+{
+    if (raw == 0U || raw == 0xFFFFFFFFU)
+    {
+        return DSP_READBACK_FLOOR_DB;
+    }
+
+    const float db = (dsp_readback_log2_u32(raw) - DSP_READBACK_REF_LOG2) * DSP_READBACK_DB_PER_LOG2;
+    return (db < DSP_READBACK_FLOOR_DB) ? DSP_READBACK_FLOOR_DB : db;
+}
+
+static void dsp_readback_read_settings(void)
+{
+    for (uint8_t m = 0; m < DSP_READBACK_METER_NUM; m++)
+    {
+        const uint16_t addr = dsp_param_addr(s_settings_param[m]);
+        if (addr == DSP_PARAM_ADDR_NONE)
+        {
+            continue;
+        }
+
+        ADI_REG_TYPE rx_data[DSP_READBACK_SETTINGS_WORDS * 4U] = {0};
+        SIGMA_READ_REGISTER(DEVICE_ADDR_ADAU146XSCHEMATIC_1, addr, sizeof(rx_data), rx_data);
+
+        s_work.rms_tc_db_per_s[m] = (float) (int32_t) dsp_readback_be32(&rx_data[0]) / 16777216.0f;
+        s_work.hold[m]            = dsp_readback_be32(&rx_data[4]);
+        s_work.decay[m]           = (float) (int32_t) dsp_readback_be32(&rx_data[8]) / 16777216.0f;
+    }
+}
+
+static void dsp_readback_read_meters(void)
+{
+    uint16_t addr[DSP_READBACK_METER_NUM];
+    uint16_t base = DSP_PARAM_ADDR_NONE;
+    uint16_t last = 0U;
+
+    for (uint8_t m = 0; m < DSP_READBACK_METER_NUM; m++)
+    {
+        addr[m] = dsp_param_addr(s_meter_param[m]);
+        if (addr[m] == DSP_PARAM_ADDR_NONE)
+        {
+            continue;
+        }
+        base = (addr[m] < base) ? addr[m] : base;
+        last = (addr[m] > last) ? addr[m] : last;
+    }
+
+    if (base == DSP_PARAM_ADDR_NONE)
+    {
+        return;
+    }
+
+    ADI_REG_TYPE rx_data[DSP_READBACK_BURST_WORDS_MAX * 4U] = {0};
+    const bool burst = ((uint32_t) (last - base) < DSP_READBACK_BURST_WORDS_MAX);
+    if (burst)
+    {
+        SIGMA_READ_REGISTER(DEVICE_ADDR_ADAU146XSCHEMATIC_1, base, (uint16_t) ((last - base + 1U) * 4U), rx_data);
+    }
+
+    for (uint8_t m = 0; m < DSP_READBACK_METER_NUM; m++)
+    {
+        if (addr[m] == DSP_PARAM_ADDR_NONE)
+        {
+            s_work.raw[m]  = 0U;
+            s_work.dbfs[m] = DSP_READBACK_FLOOR_DB;
+            continue;
+        }
+
+        const uint8_t* p = &rx_data[(addr[m] - base) * 4U];
+        if (!burst)
+        {
+            SIGMA_READ_REGISTER(DEVICE_ADDR_ADAU146XSCHEMATIC_1, addr[m], 4, rx_data);
+            p = rx_data;
+        }
+
+        const uint32_t raw = dsp_readback_be32(p);
+        s_work.raw[m]      = raw;
+        s_work.dbfs[m]     = dsp_readback_raw_to_dbfs(raw);
+    }
+}
+
+static void dsp_readback_publish(void)
+{
+    s_seq++;
+    __DMB();
+    s_snapshot = s_work;
+    __DMB();
+    s_seq++;
+}
+
+void dsp_readback_task(void)
+{
+    // DSPダウンロード中にSPIを取り合わないよう、オーディオ制御開始後のみ読む
+    if (!is_started_audio_control() || dsp_library_is_downloading())
+    {
+        return;
+    }
+
+    const uint32_t now = HAL_GetTick();
+    if ((now - s_last_read_ms) < DSP_READBACK_PERIOD_MS)
+    {
+        return;
+    }
+    s_last_read_ms = now;
+
+    dsp_readback_read_meters();
+
+    // RUNNINGAVERAGE は設定値なので低頻度で十分
+    if (!s_settings_valid || ((now - s_last_settings_ms) >= DSP_READBACK_SETTINGS_PERIOD_MS))
+    {
+        dsp_readback_read_settings();
+        s_last_settings_ms = now;
+        s_settings_valid   = true;
+    }
+
+    s_work.update_count++;
+    s_work.timestamp_ms = now;
+    dsp_readback_publish();
+}
+
+bool dsp_readback_get_snapshot(dsp_readback_snapshot_t* out)
+{
+    if (out == NULL)
+    {
+        return false;
+    }
+
+    // 書き込み側より高優先度のタスクから呼ばれると更新完了を待てないため、リトライ回数を制限する
+    for (uint32_t i = 0; i < DSP_READBACK_SNAPSHOT_RETRY; i++)
+    {
+        const uint32_t seq_begin = s_seq;
+        if ((seq_begin & 1U) != 0U)
+        {
+            continue;
+        }
+        __DMB();
+        *out = s_snapshot;
+        __DMB();
+        if (s_seq == seq_begin)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+float dsp_readback_get_dbfs(uint8_t meter)
+{
+    if (meter >= DSP_READBACK_METER_NUM)
+    {
+        return DSP_READBACK_FLOOR_DB;
+    }
+
+    // 単一ワードの読み出しはアトミックなので seqlock は不要
+    return ((volatile const float*) s_snapshot.dbfs)[meter];
+}
@@ -3,8 +3,14 @@
 #include <stddef.h>
 #include <string.h>
 
+#include "cmsis_os2.h"
+
+#include "adau1466.h"
+#include "audio_control.h"
 #include "ui_control.h"
 
+extern osMutexId_t i2cMutexHandle;
+
 typedef struct
 {
     uint32_t             magic;
@@ -14,6 +20,24 @@ typedef struct
     uint32_t             crc32;
 } EEPROM_ConfigRecord_t;
 
+typedef struct
+{
+    uint32_t          magic;
+    uint16_t          version;
+    uint16_t          payload_size;
+    EEPROM_MagCalib_t payload;
+    uint32_t          crc32;
+} EEPROM_MagCalibRecord_t;
+
+typedef struct
+{
+    uint32_t         magic;
+    uint16_t         version;
+    uint16_t         payload_size;
+    EEPROM_MidiMap_t payload;
+    uint32_t         crc32;
+} EEPROM_MidiMapRecord_t;
+
 static uint32_t EEPROM_CRC32(const uint8_t *data, uint32_t len)
 {
     uint32_t crc = 0xFFFFFFFFUL;
@@ -47,19 +71,69 @@ static HAL_StatusTypeDef EEPROM_CheckRange(uint16_t mem_addr, uint16_t len)
 
 void EEPROM_ConfigSetDefaults(EEPROM_DeviceConfig_t *cfg)
 {
+    uint32_t i;
+
     if (cfg == NULL)
     {
         return;
     }
 
-    cfg->current_ch1_input_type = 0U; /* INPUT_TYPE_LINE */
-    cfg->current_ch2_input_type = 0U; /* INPUT_TYPE_LINE */
-    cfg->current_xfA_assign     = 2U; /* INPUT_SRC_CH2_LN */
-    cfg->current_xfB_assign     = 0U; /* INPUT_SRC_CH1_LN */
-    cfg->current_xfpost_assign  = 4U; /* INPUT_SRC_USB12 */
+    cfg->current_ch1_input_type = INPUT_TYPE_LINE;
+    cfg->current_ch2_input_type = INPUT_TYPE_LINE;
+    cfg->current_xfA_assign     = INPUT_SRC_CH2_LN;
+    cfg->current_xfB_assign     = INPUT_SRC_CH1_LN;
+    cfg->current_xfpost_assign  = INPUT_SRC_USB12;
     cfg->current_ch1_dvs_enable = 0U; /* disabled */
     cfg->current_ch2_dvs_enable = 0U; /* disabled */
     cfg->reserved[0]            = 0U;
+    cfg->current_xf_curve[0]    = XFADE_CURVE_SCRATCH;
+    cfg->current_xf_curve[1]    = XFADE_CURVE_SCRATCH;
+    cfg->current_xf_cut[0]      = MAG_XFADE_CUTOFF;
+    cfg->current_xf_cut[1]      = MAG_XFADE_CUTOFF;
+    for (i = 0U; i < XFADE_USER_POINT_NUM; i++)
+    {
+        cfg->current_xf_user_curve[i] = (uint8_t)((i * 127U) / (XFADE_USER_POINT_NUM - 1U)); /* linear */
+    }
+}
+
+/* CRC が合っていても範囲外の値 (古いファームや SysEx で書かれたもの) は読み込まない */
+bool EEPROM_ConfigIsValid(const EEPROM_DeviceConfig_t *cfg)
+{
+    uint32_t i;
+
+    if (cfg == NULL)
+    {
+        return false;
+    }
+
+    if ((cfg->current_ch1_input_type > INPUT_TYPE_PHONO) ||
+        (cfg->current_ch2_input_type > INPUT_TYPE_PHONO) ||
+        (cfg->current_xfA_assign >= INPUT_SRC_NONE) ||
+        (cfg->current_xfB_assign >= INPUT_SRC_NONE) ||
+        (cfg->current_xfpost_assign >= INPUT_SRC_NONE) ||
+        (cfg->current_ch1_dvs_enable > 1U) ||
+        (cfg->current_ch2_dvs_enable > 1U))
+    {
+        return false;
+    }
+
+    for (i = 0U; i < XFADE_FADER_NUM; i++)
+    {
+        if ((cfg->current_xf_curve[i] >= XFADE_CURVE_NUM) || (cfg->current_xf_cut[i] > MAG_XFADE_CUT_MAX))
+        {
+            return false;
+        }
+    }
+
+    for (i = 0U; i < XFADE_USER_POINT_NUM; i++)
+    {
+        if (cfg->current_xf_user_curve[i] > 127U)
+        {
+            return false;
+        }
+    }
+
+    return true;
 }
 
 void EEPROM_ConfigCaptureCurrent(EEPROM_DeviceConfig_t *cfg)
@@ -80,30 +154,177 @@ void EEPROM_ConfigCaptureCurrent(EEPROM_DeviceConfig_t *cfg)
     cfg->current_ch1_dvs_enable = state.current_ch1_dvs_enable;
     cfg->current_ch2_dvs_enable = state.current_ch2_dvs_enable;
     cfg->reserved[0]            = 0U;
+    memcpy(cfg->current_xf_curve, state.current_xf_curve, sizeof(cfg->current_xf_curve));
+    memcpy(cfg->current_xf_cut, state.current_xf_cut, sizeof(cfg->current_xf_cut));
+    memcpy(cfg->current_xf_user_curve, state.current_xf_user_curve, sizeof(cfg->current_xf_user_curve));
 }
 
-HAL_StatusTypeDef EEPROM_CheckConnection(I2C_HandleTypeDef *hi2c)
+/* EEPROM_ConfigCaptureCurrent の逆。SysEx で届いた設定もここを通るので範囲を確認してから渡す */
+bool EEPROM_ConfigApply(const EEPROM_DeviceConfig_t *cfg)
 {
-    if (hi2c == NULL)
+    UI_ControlPersistState_t state;
+
+    if (!EEPROM_ConfigIsValid(cfg))
+    {
+        return false;
+    }
+
+    state.current_ch1_input_type = cfg->current_ch1_input_type;
+    state.current_ch2_input_type = cfg->current_ch2_input_type;
+    state.current_xfA_assign     = cfg->current_xfA_assign;
+    state.current_xfB_assign     = cfg->current_xfB_assign;
+    state.current_xfpost_assign  = cfg->current_xfpost_assign;
+    state.current_ch1_dvs_enable = cfg->current_ch1_dvs_enable;
+    state.current_ch2_dvs_enable = cfg->current_ch2_dvs_enable;
+    memcpy(state.current_xf_curve, cfg->current_xf_curve, sizeof(state.current_xf_curve));
+    memcpy(state.current_xf_cut, cfg->current_xf_cut, sizeof(state.current_xf_cut));
+    memcpy(state.current_xf_user_curve, cfg->current_xf_user_curve, sizeof(state.current_xf_user_curve));
+
+    return ui_control_apply_persist_state(&state);
+}
+
+/* v2 のレコードは payload 8 バイトの直後に CRC がある。クロスフェーダーカーブは初期値で補う */
+static HAL_StatusTypeDef EEPROM_LoadConfigV2(const EEPROM_ConfigRecord_t *rec, EEPROM_DeviceConfig_t *cfg)
+{
+    const uint8_t *raw = (const uint8_t *)rec;
+    const uint32_t crc_offset = (uint32_t)offsetof(EEPROM_ConfigRecord_t, payload) + EEPROM_CONFIG_V2_PAYLOAD_SIZE;
+    uint32_t stored_crc;
+
+    memcpy(&stored_crc, &raw[crc_offset], sizeof(stored_crc));
+    if (EEPROM_CRC32(raw, crc_offset) != stored_crc)
     {
         return HAL_ERROR;
     }
 
-    return HAL_I2C_IsDeviceReady(hi2c,
+    EEPROM_ConfigSetDefaults(cfg);
+    memcpy(cfg, &rec->payload, EEPROM_CONFIG_V2_PAYLOAD_SIZE);
+    return EEPROM_ConfigIsValid(cfg) ? HAL_OK : HAL_ERROR;
+}
+
+/*
+ * hi2c2 はサブ OLED と共用で、i2cMutex (hi2c3 の AK4619 とも共通) を持っている間だけ触る
+ * OLED は DMA 転送の間ずっと持っているので、待ちがタイムアウトしてもすぐには諦めない
+ * カーネルが動く前 (起動時の読み込み) は他に使う人がいないので取らない
+ */
+static bool EEPROM_BusLock(bool *locked)
+{
+    uint32_t retry;
+
+    *locked = false;
+    if ((osKernelGetState() != osKernelRunning) || (i2cMutexHandle == NULL))
+    {
+        return true;
+    }
+
+    for (retry = 0U; retry < EEPROM_BUS_RETRIES; retry++)
+    {
+        if (osMutexAcquire(i2cMutexHandle, EEPROM_BUS_LOCK_TIMEOUT_MS) == osOK)
+        {
+            *locked = true;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void EEPROM_BusUnlock(bool locked)
+{
+    if (locked)
+    {
+        osMutexRelease(i2cMutexHandle);
+    }
+}
+
+/*
+ * 読み書きの途中 (ミューテックス待ち、ページの間も含む) かどうか。EEPROM_IsBusy で OLED 側が見る
+ * 呼ぶタスクが 1 つとは限らないので割り込みを止めて数える
+ */
+static volatile uint32_t s_eeprom_busy;
+
+static void EEPROM_OpBegin(void)
+{
+    const uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    s_eeprom_busy++;
+    __set_PRIMASK(primask);
+}
+
+static void EEPROM_OpEnd(void)
+{
+    const uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    s_eeprom_busy--;
+    __set_PRIMASK(primask);
+}
+
+bool EEPROM_IsBusy(void)
+{
+    return s_eeprom_busy != 0U;
+}
+
+static void EEPROM_BackOff(void)
+{
+    if (osKernelGetState() == osKernelRunning)
+    {
+        osDelay(1U);
+    }
+    else
+    {
+        HAL_Delay(1U);
+    }
+}
+
+/* ペリフェラルがまだ前の転送 (中断した OLED の DMA など) から戻っていなければ少し待ってやり直す */
+static HAL_StatusTypeDef EEPROM_MemReadLocked(I2C_HandleTypeDef *hi2c, uint16_t mem_addr, uint8_t *buf, uint16_t len)
+{
+    HAL_StatusTypeDef status = HAL_ERROR;
+    uint32_t retry;
+
+    for (retry = 0U; retry < EEPROM_BUS_RETRIES; retry++)
+    {
+        status = HAL_I2C_Mem_Read(hi2c,
                                   EEPROM_I2C_ADDR_8BIT,
-                                  EEPROM_READY_TRIALS_DEFAULT,
-                                  EEPROM_READY_TIMEOUT_MS);
+                                  mem_addr,
+                                  I2C_MEMADD_SIZE_16BIT,
+                                  buf,
+                                  len,
+                                  EEPROM_XFER_TIMEOUT_MS);
+        if ((status != HAL_BUSY) && (status != HAL_TIMEOUT))
+        {
+            break;
+        }
+        EEPROM_BackOff();
+    }
+    return status;
 }
 
-HAL_StatusTypeDef EEPROM_WaitReady(I2C_HandleTypeDef *hi2c, uint32_t timeout_ms)
+static HAL_StatusTypeDef EEPROM_MemWriteLocked(I2C_HandleTypeDef *hi2c, uint16_t mem_addr, const uint8_t *buf, uint16_t len)
 {
-    uint32_t start_tick;
-    HAL_StatusTypeDef status;
+    HAL_StatusTypeDef status = HAL_ERROR;
+    uint32_t retry;
 
-    if (hi2c == NULL)
+    for (retry = 0U; retry < EEPROM_BUS_RETRIES; retry++)
     {
-        return HAL_ERROR;
+        status = HAL_I2C_Mem_Write(hi2c,
+                                   EEPROM_I2C_ADDR_8BIT,
+                                   mem_addr,
+                                   I2C_MEMADD_SIZE_16BIT,
+                                   (uint8_t *)buf,
+                                   len,
+                                   EEPROM_XFER_TIMEOUT_MS);
+        if ((status != HAL_BUSY) && (status != HAL_TIMEOUT))
+        {
+            break;
+        }
+        EEPROM_BackOff();
     }
+    return status;
+}
+
+static HAL_StatusTypeDef EEPROM_WaitReadyLocked(I2C_HandleTypeDef *hi2c, uint32_t timeout_ms)
+{
+    uint32_t start_tick;
+    HAL_StatusTypeDef status;
 
     start_tick = HAL_GetTick();
     do
@@ -118,38 +339,61 @@ HAL_StatusTypeDef EEPROM_WaitReady(I2C_HandleTypeDef *hi2c, uint32_t timeout_ms)
     return HAL_TIMEOUT;
 }
 
-HAL_StatusTypeDef EEPROM_Read(I2C_HandleTypeDef *hi2c, uint16_t mem_addr, uint8_t *buf, uint16_t len)
+HAL_StatusTypeDef EEPROM_CheckConnection(I2C_HandleTypeDef *hi2c)
 {
-    if ((hi2c == NULL) || (buf == NULL))
+    HAL_StatusTypeDef status;
+    bool locked;
+
+    if (hi2c == NULL)
     {
         return HAL_ERROR;
     }
 
-    if (len == 0U)
+    EEPROM_OpBegin();
+    if (EEPROM_BusLock(&locked))
     {
-        return HAL_OK;
+        status = HAL_I2C_IsDeviceReady(hi2c,
+                                       EEPROM_I2C_ADDR_8BIT,
+                                       EEPROM_READY_TRIALS_DEFAULT,
+                                       EEPROM_READY_TIMEOUT_MS);
+        EEPROM_BusUnlock(locked);
     }
+    else
+    {
+        status = HAL_BUSY;
+    }
+    EEPROM_OpEnd();
+    return status;
+}
 
-    if (EEPROM_CheckRange(mem_addr, len) != HAL_OK)
+HAL_StatusTypeDef EEPROM_WaitReady(I2C_HandleTypeDef *hi2c, uint32_t timeout_ms)
+{
+    HAL_StatusTypeDef status;
+    bool locked;
+
+    if (hi2c == NULL)
     {
         return HAL_ERROR;
     }
 
-    return HAL_I2C_Mem_Read(hi2c,
-                            EEPROM_I2C_ADDR_8BIT,
-                            mem_addr,
-                            I2C_MEMADD_SIZE_16BIT,
-                            buf,
-                            len,
-                            EEPROM_XFER_TIMEOUT_MS);
+    EEPROM_OpBegin();
+    if (EEPROM_BusLock(&locked))
+    {
+        status = EEPROM_WaitReadyLocked(hi2c, timeout_ms);
+        EEPROM_BusUnlock(locked);
+    }
+    else
+    {
+        status = HAL_BUSY;
+    }
+    EEPROM_OpEnd();
+    return status;
 }
 
-HAL_StatusTypeDef EEPROM_Write(I2C_HandleTypeDef *hi2c, uint16_t mem_addr, const uint8_t *buf, uint16_t len)
+HAL_StatusTypeDef EEPROM_Read(I2C_HandleTypeDef *hi2c, uint16_t mem_addr, uint8_t *buf, uint16_t len)
 {
     HAL_StatusTypeDef status;
-    uint16_t current_addr = mem_addr;
-    uint16_t remain = len;
-    const uint8_t *current_buf = buf;
+    bool locked;
 
     if ((hi2c == NULL) || (buf == NULL))
     {
@@ -166,25 +410,45 @@ HAL_StatusTypeDef EEPROM_Write(I2C_HandleTypeDef *hi2c, uint16_t mem_addr, const
         return HAL_ERROR;
     }
 
+    EEPROM_OpBegin();
+    if (EEPROM_BusLock(&locked))
+    {
+        status = EEPROM_MemReadLocked(hi2c, mem_addr, buf, len);
+        EEPROM_BusUnlock(locked);
+    }
+    else
+    {
+        status = HAL_BUSY;
+    }
+    EEPROM_OpEnd();
+    return status;
+}
+
+static HAL_StatusTypeDef EEPROM_WritePages(I2C_HandleTypeDef *hi2c, uint16_t mem_addr, const uint8_t *buf, uint16_t len)
+{
+    HAL_StatusTypeDef status;
+    uint16_t current_addr = mem_addr;
+    uint16_t remain = len;
+    const uint8_t *current_buf = buf;
+    bool locked;
+
     while (remain > 0U)
     {
         uint16_t page_offset = (uint16_t)(current_addr % EEPROM_PAGE_SIZE_BYTES);
         uint16_t page_space = (uint16_t)(EEPROM_PAGE_SIZE_BYTES - page_offset);
         uint16_t chunk = (remain < page_space) ? remain : page_space;
 
-        status = HAL_I2C_Mem_Write(hi2c,
-                                   EEPROM_I2C_ADDR_8BIT,
-                                   current_addr,
-                                   I2C_MEMADD_SIZE_16BIT,
-                                   (uint8_t *)current_buf,
-                                   chunk,
-                                   EEPROM_XFER_TIMEOUT_MS);
-        if (status != HAL_OK)
+        /* 書き込みと書き込み完了の ACK ポーリングは 1 回のミューテックスの中で。ページの間では OLED に譲る */
+        if (!EEPROM_BusLock(&locked))
         {
-            return status;
+            return HAL_BUSY;
         }
-
-        status = EEPROM_WaitReady(hi2c, EEPROM_WRITE_CYCLE_TIMEOUT_MS);
+        status = EEPROM_MemWriteLocked(hi2c, current_addr, current_buf, chunk);
+        if (status == HAL_OK)
+        {
+            status = EEPROM_WaitReadyLocked(hi2c, EEPROM_WRITE_CYCLE_TIMEOUT_MS);
+        }
+        EEPROM_BusUnlock(locked);
         if (status != HAL_OK)
         {
             return status;
@@ -198,7 +462,34 @@ HAL_StatusTypeDef EEPROM_Write(I2C_HandleTypeDef *hi2c, uint16_t mem_addr, const
     return HAL_OK;
 }
 
-HAL_StatusTypeDef EEPROM_SaveConfig(I2C_HandleTypeDef *hi2c, const EEPROM_DeviceConfig_t *cfg)
+HAL_StatusTypeDef EEPROM_Write(I2C_HandleTypeDef *hi2c, uint16_t mem_addr, const uint8_t *buf, uint16_t len)
+{
+    HAL_StatusTypeDef status;
+
+    if ((hi2c == NULL) || (buf == NULL))
+    {
+        return HAL_ERROR;
+    }
+
+    if (len == 0U)
+    {
+        return HAL_OK;
+    }
+
+    if (EEPROM_CheckRange(mem_addr, len) != HAL_OK)
+    {
+        return HAL_ERROR;
+    }
+
+    /* ページの間で OLED に譲っている間も書き込み中として見せる */
+    EEPROM_OpBegin();
+    status = EEPROM_WritePages(hi2c, mem_addr, buf, len);
+    EEPROM_OpEnd();
+    return status;
+}
+
+/* 設定レコードとプリセットは magic と置き場所だけが違う */
+static HAL_StatusTypeDef EEPROM_WriteConfigRecord(I2C_HandleTypeDef *hi2c, uint16_t addr, uint32_t magic, const EEPROM_DeviceConfig_t *cfg)
 {
     EEPROM_ConfigRecord_t rec;
     uint32_t crc_input_len;
@@ -208,7 +499,7 @@ HAL_StatusTypeDef EEPROM_SaveConfig(I2C_HandleTypeDef *hi2c, const EEPROM_Device
         return HAL_ERROR;
     }
 
-    rec.magic        = EEPROM_CONFIG_MAGIC;
+    rec.magic        = magic;
     rec.version      = EEPROM_CONFIG_VERSION;
     rec.payload_size = (uint16_t)sizeof(EEPROM_DeviceConfig_t);
     rec.payload      = *cfg;
@@ -216,13 +507,40 @@ HAL_StatusTypeDef EEPROM_SaveConfig(I2C_HandleTypeDef *hi2c, const EEPROM_Device
     crc_input_len = (uint32_t)offsetof(EEPROM_ConfigRecord_t, crc32);
     rec.crc32 = EEPROM_CRC32((const uint8_t *)&rec, crc_input_len);
 
-    return EEPROM_Write(hi2c, EEPROM_CONFIG_ADDR, (const uint8_t *)&rec, (uint16_t)sizeof(rec));
+    return EEPROM_Write(hi2c, addr, (const uint8_t *)&rec, (uint16_t)sizeof(rec));
+}
+
+static HAL_StatusTypeDef EEPROM_CheckConfigRecord(const EEPROM_ConfigRecord_t *rec, uint32_t magic, EEPROM_DeviceConfig_t *cfg)
+{
+    if ((rec->magic != magic) ||
+        (rec->version != EEPROM_CONFIG_VERSION) ||
+        (rec->payload_size != (uint16_t)sizeof(EEPROM_DeviceConfig_t)))
+    {
+        return HAL_ERROR;
+    }
+
+    if (EEPROM_CRC32((const uint8_t *)rec, (uint32_t)offsetof(EEPROM_ConfigRecord_t, crc32)) != rec->crc32)
+    {
+        return HAL_ERROR;
+    }
+
+    if (!EEPROM_ConfigIsValid(&rec->payload))
+    {
+        return HAL_ERROR;
+    }
+
+    memcpy(cfg, &rec->payload, sizeof(*cfg));
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef EEPROM_SaveConfig(I2C_HandleTypeDef *hi2c, const EEPROM_DeviceConfig_t *cfg)
+{
+    return EEPROM_WriteConfigRecord(hi2c, EEPROM_CONFIG_ADDR, EEPROM_CONFIG_MAGIC, cfg);
 }
 
 HAL_StatusTypeDef EEPROM_LoadConfig(I2C_HandleTypeDef *hi2c, EEPROM_DeviceConfig_t *cfg)
 {
     EEPROM_ConfigRecord_t rec;
-    uint32_t expected_crc;
     HAL_StatusTypeDef status;
 
     if ((hi2c == NULL) || (cfg == NULL))
@@ -236,19 +554,141 @@ HAL_StatusTypeDef EEPROM_LoadConfig(I2C_HandleTypeDef *hi2c, EEPROM_DeviceConfig
         return status;
     }
 
-    if ((rec.magic != EEPROM_CONFIG_MAGIC) ||
-        (rec.version != EEPROM_CONFIG_VERSION) ||
-        (rec.payload_size != (uint16_t)sizeof(EEPROM_DeviceConfig_t)))
+    if ((rec.magic == EEPROM_CONFIG_MAGIC) &&
+        (rec.version == 0x0002U) &&
+        (rec.payload_size == EEPROM_CONFIG_V2_PAYLOAD_SIZE))
+    {
+        return EEPROM_LoadConfigV2(&rec, cfg);
+    }
+
+    return EEPROM_CheckConfigRecord(&rec, EEPROM_CONFIG_MAGIC, cfg);
+}
+
+HAL_StatusTypeDef EEPROM_SavePreset(I2C_HandleTypeDef *hi2c, uint8_t slot, const EEPROM_DeviceConfig_t *cfg)
+{
+    if (slot >= EEPROM_PRESET_NUM)
+    {
+        return HAL_ERROR;
+    }
+
+    return EEPROM_WriteConfigRecord(hi2c, (uint16_t)(EEPROM_PRESET_ADDR + (slot * EEPROM_PRESET_STRIDE)), EEPROM_PRESET_MAGIC, cfg);
+}
+
+HAL_StatusTypeDef EEPROM_LoadPreset(I2C_HandleTypeDef *hi2c, uint8_t slot, EEPROM_DeviceConfig_t *cfg)
+{
+    EEPROM_ConfigRecord_t rec;
+    HAL_StatusTypeDef status;
+
+    if ((hi2c == NULL) || (cfg == NULL) || (slot >= EEPROM_PRESET_NUM))
+    {
+        return HAL_ERROR;
+    }
+
+    status = EEPROM_Read(hi2c, (uint16_t)(EEPROM_PRESET_ADDR + (slot * EEPROM_PRESET_STRIDE)), (uint8_t *)&rec, (uint16_t)sizeof(rec));
+    if (status != HAL_OK)
+    {
+        return status;
+    }
+
+    return EEPROM_CheckConfigRecord(&rec, EEPROM_PRESET_MAGIC, cfg);
+}
+
+HAL_StatusTypeDef EEPROM_SaveMagCalib(I2C_HandleTypeDef *hi2c, const EEPROM_MagCalib_t *cal)
+{
+    EEPROM_MagCalibRecord_t rec;
+
+    if ((hi2c == NULL) || (cal == NULL))
+    {
+        return HAL_ERROR;
+    }
+
+    rec.magic        = EEPROM_MAG_CALIB_MAGIC;
+    rec.version      = EEPROM_MAG_CALIB_VERSION;
+    rec.payload_size = (uint16_t)sizeof(EEPROM_MagCalib_t);
+    rec.payload      = *cal;
+    rec.crc32        = EEPROM_CRC32((const uint8_t *)&rec, (uint32_t)offsetof(EEPROM_MagCalibRecord_t, crc32));
+
+    return EEPROM_Write(hi2c, EEPROM_MAG_CALIB_ADDR, (const uint8_t *)&rec, (uint16_t)sizeof(rec));
+}
+
+HAL_StatusTypeDef EEPROM_LoadMagCalib(I2C_HandleTypeDef *hi2c, EEPROM_MagCalib_t *cal)
+{
+    EEPROM_MagCalibRecord_t rec;
+    HAL_StatusTypeDef status;
+
+    if ((hi2c == NULL) || (cal == NULL))
+    {
+        return HAL_ERROR;
+    }
+
+    status = EEPROM_Read(hi2c, EEPROM_MAG_CALIB_ADDR, (uint8_t *)&rec, (uint16_t)sizeof(rec));
+    if (status != HAL_OK)
+    {
+        return status;
+    }
+
+    if ((rec.magic != EEPROM_MAG_CALIB_MAGIC) ||
+        (rec.version != EEPROM_MAG_CALIB_VERSION) ||
+        (rec.payload_size != (uint16_t)sizeof(EEPROM_MagCalib_t)))
+    {
+        return HAL_ERROR;
+    }
+
+    if (EEPROM_CRC32((const uint8_t *)&rec, (uint32_t)offsetof(EEPROM_MagCalibRecord_t, crc32)) != rec.crc32)
+    {
+        return HAL_ERROR;
+    }
+
+    memcpy(cal, &rec.payload, sizeof(*cal));
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef EEPROM_SaveMidiMap(I2C_HandleTypeDef *hi2c, const EEPROM_MidiMap_t *map)
+{
+    EEPROM_MidiMapRecord_t rec;
+
+    if ((hi2c == NULL) || (map == NULL))
+    {
+        return HAL_ERROR;
+    }
+
+    rec.magic        = EEPROM_MIDI_MAP_MAGIC;
+    rec.version      = EEPROM_MIDI_MAP_VERSION;
+    rec.payload_size = (uint16_t)sizeof(EEPROM_MidiMap_t);
+    rec.payload      = *map;
+    rec.crc32        = EEPROM_CRC32((const uint8_t *)&rec, (uint32_t)offsetof(EEPROM_MidiMapRecord_t, crc32));
+
+    return EEPROM_Write(hi2c, EEPROM_MIDI_MAP_ADDR, (const uint8_t *)&rec, (uint16_t)sizeof(rec));
+}
+
+HAL_StatusTypeDef EEPROM_LoadMidiMap(I2C_HandleTypeDef *hi2c, EEPROM_MidiMap_t *map)
+{
+    EEPROM_MidiMapRecord_t rec;
+    HAL_StatusTypeDef status;
+
+    if ((hi2c == NULL) || (map == NULL))
+    {
+        return HAL_ERROR;
+    }
+
+    status = EEPROM_Read(hi2c, EEPROM_MIDI_MAP_ADDR, (uint8_t *)&rec, (uint16_t)sizeof(rec));
+    if (status != HAL_OK)
+    {
+        return status;
+    }
+
+    if ((rec.magic != EEPROM_MIDI_MAP_MAGIC) ||
+        (rec.version != EEPROM_MIDI_MAP_VERSION) ||
+        (rec.payload_size != (uint16_t)sizeof(EEPROM_MidiMap_t)))
     {
         return HAL_ERROR;
     }
 
-    expected_crc = EEPROM_CRC32((const uint8_t *)&rec, (uint32_t)offsetof(EEPROM_ConfigRecord_t, crc32));
-    if (expected_crc != rec.crc32)
+    if (EEPROM_CRC32((const uint8_t *)&rec, (uint32_t)offsetof(EEPROM_MidiMapRecord_t, crc32)) != rec.crc32)
     {
         return HAL_ERROR;
     }
 
-    memcpy(cfg, &rec.payload, sizeof(*cfg));
+    memcpy(map, &rec.payload, sizeof(*map));
     return HAL_OK;
 }
@@ -30,9 +30,15 @@
 #include "tusb.h"
 #include "audio_control.h"
 #include "led_control.h"
+#include "dsp_readback.h"
 #include "oled_control.h"
+#include "oled_i2c.h"
 #include "adc.h"
 #include "SigmaStudioFW.h"
+#include "mag_fader.h"
+#include "mag_calib.h"
+#include "midi_map.h"
+#include "i2c.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -145,6 +151,41 @@ void MX_FREERTOS_Init(void); /* (MISRA C 2004 rule 8.1) */
 /* Hook prototypes */
 void vApplicationStackOverflowHook(xTaskHandle xTask, char* pcTaskName);
 void vApplicationMallocFailedHook(void);
+void configureTimerForRunTimeStats(void);
+unsigned long getRunTimeCounterValue(void);
+
+/* USER CODE BEGIN 1 */
+// run-time stats 用の 1us カウンタ。SysTick は FreeRTOS の tick なので、tick 数 x 1000 に SysTick の進み分を足す
+// (DWT->CYCCNT は 600MHz だと約7sで一周してしまうので使わない)
+static uint32_t s_systick_per_us = 1U;
+
+void configureTimerForRunTimeStats(void)
+{
+    s_systick_per_us = SystemCoreClock / 1000000U;
+    if (s_systick_per_us == 0U)
+    {
+        s_systick_per_us = 1U;
+    }
+}
+
+unsigned long getRunTimeCounterValue(void)
+{
+    const uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    uint32_t tick = (uint32_t) xTaskGetTickCount();
+    uint32_t val  = SysTick->VAL;
+    if ((SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) != 0U)
+    {
+        // SysTick が一周したのに tick がまだ進んでいない (PendSV 中など)。読み直して 1 tick 先として数える
+        val = SysTick->VAL;
+        tick++;
+    }
+    const uint32_t load = SysTick->LOAD;
+    __set_PRIMASK(primask);
+
+    return (unsigned long) (tick * (1000000U / configTICK_RATE_HZ) + (load - val) / s_systick_per_us);
+}
+/* USER CODE END 1 */
 
 /* USER CODE BEGIN 4 */
 void vApplicationStackOverflowHook(xTaskHandle xTask, char* pcTaskName)
@@ -363,6 +404,8 @@ void StartAudioTask(void* argument)
      */
     AUDIO_Init_ADAU1466(48000);
     AUDIO_LoadAndApplyRoutingFromEEPROM();
+    (void) mag_calib_load(&hi2c2);
+    (void) midi_map_load(&hi2c2);
     osDelay(500);
 
     HAL_GPIO_WritePin(LED0_GPIO_Port, LED0_Pin, 1);
@@ -406,8 +449,7 @@ void StartLEDTask(void* argument)
     /* Infinite loop */
     for (;;)
     {
-        led_tx_blinking_task();
-        led_rx_blinking_task();
+        dsp_readback_task();
         rgb_led_task();
         osDelay(5);
     }
@@ -433,8 +475,11 @@ void StartADCTask(void* argument)
     /* Infinite loop */
     for (;;)
     {
-        ui_control_task();
-        osDelay(2);
+        // 操作子が動いたとき (ADC2 ブロック / フェーダーの窓、ポットの窓、USB MIDI 受信、SW1/SW2) だけ起こされる
+        // 何も起きなければ UI_IDLE_POLL_MS (ボタンの判定待ち中はその期限) で起きて、静止中のドリフト追従と MIDI-learn の期限を見る
+        const uint32_t flags = osThreadFlagsWait(MAG_FADER_THREAD_FLAG | UI_POT_THREAD_FLAG | UI_MIDI_THREAD_FLAG | UI_INPUT_THREAD_FLAG,
+                                                 osFlagsWaitAny, ui_control_wake_timeout());
+        ui_control_wake(((flags & osFlagsError) != 0U) ? 0U : flags);
     }
     /* USER CODE END StartADCTask */
 }
@@ -466,7 +511,7 @@ void StartOLEDTask(void* argument)
     for (;;)
     {
         OLED_UpdateTask();
-        osDelay(20);
+        oled_i2c_run(20);  // 周期待ちの間に OLED の DMA 転送を回す
     }
     /* USER CODE END StartOLEDTask */
 }
@@ -21,7 +21,7 @@
 #include "hpdma.h"
 
 /* USER CODE BEGIN 0 */
-
+DMA_HandleTypeDef handle_HPDMA1_Channel1;
 /* USER CODE END 0 */
 
 DMA_HandleTypeDef handle_HPDMA1_Channel0;
@@ -53,7 +53,24 @@ void MX_HPDMA1_Init(void)
     Error_Handler();
   }
   /* USER CODE BEGIN HPDMA1_Init 2 */
+  /* ADC2 (磁気クロスフェーダー) はスクラッチの応答性を優先して ADC1 より上の優先度にする */
+  HAL_NVIC_SetPriority(HPDMA1_Channel1_IRQn, 7, 0);
+  HAL_NVIC_EnableIRQ(HPDMA1_Channel1_IRQn);
 
+  handle_HPDMA1_Channel1.Instance = HPDMA1_Channel1;
+  handle_HPDMA1_Channel1.InitLinkedList.Priority = DMA_LOW_PRIORITY_HIGH_WEIGHT;
+  handle_HPDMA1_Channel1.InitLinkedList.LinkStepMode = DMA_LSM_FULL_EXECUTION;
+  handle_HPDMA1_Channel1.InitLinkedList.LinkAllocatedPort = DMA_LINK_ALLOCATED_PORT0;
+  handle_HPDMA1_Channel1.InitLinkedList.TransferEventMode = DMA_TCEM_LAST_LL_ITEM_TRANSFER;
+  handle_HPDMA1_Channel1.InitLinkedList.LinkedListMode = DMA_LINKEDLIST_CIRCULAR;
+  if (HAL_DMAEx_List_Init(&handle_HPDMA1_Channel1) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  if (HAL_DMA_ConfigChannelAttributes(&handle_HPDMA1_Channel1, DMA_CHANNEL_NPRIV) != HAL_OK)
+  {
+    Error_Handler();
+  }
   /* USER CODE END HPDMA1_Init 2 */
 
 }
@@ -0,0 +1,226 @@
+/*
+ * input_event.c
+ *
+ *  Created on: Mar 15, 2026
+ */
+
+#include "input_event.h"
+
+#include <stddef.h>
+
+#define INPUT_EVENT_NO_DEADLINE 0xFFFFFFFFUL
+
+static input_event_timing_t s_timing = {
+    .debounce_ms = 20U,
+    .long_ms     = 800U,
+    .double_ms   = 250U,
+    .chord_ms    = 80U,
+    .cut_ms      = 2U,
+};
+
+typedef struct
+{
+    input_event_t* out;
+    uint8_t cap;
+    uint8_t n;
+} input_event_queue_t;
+
+static void input_event_push(input_event_queue_t* q, uint8_t type, uint8_t src, uint16_t arg)
+{
+    if (q->n < q->cap)
+    {
+        q->out[q->n].type = type;
+        q->out[q->n].src  = src;
+        q->out[q->n].arg  = arg;
+        q->n++;
+    }
+}
+
+static bool input_event_elapsed(uint32_t now, uint32_t since, uint32_t ms)
+{
+    return (uint32_t) (now - since) >= ms;
+}
+
+void input_event_init(input_event_engine_t* e, const uint8_t* kinds, uint8_t num)
+{
+    e->num = (num < INPUT_EVENT_SRC_MAX) ? num : (uint8_t) INPUT_EVENT_SRC_MAX;
+    for (uint8_t i = 0; i < INPUT_EVENT_SRC_MAX; i++)
+    {
+        input_event_src_t* s = &e->src[i];
+
+        s->kind          = ((kinds != NULL) && (i < e->num)) ? kinds[i] : INPUT_KIND_BUTTON;
+        s->raw           = false;
+        s->stable        = false;
+        s->long_sent     = false;
+        s->consumed      = false;
+        s->click_pending = false;
+        s->raw_tick      = 0;
+        s->press_tick    = 0;
+        s->release_tick  = 0;
+    }
+}
+
+// 先に押されていて、まだ他のジェスチャーに使われていないボタンと組めたら CHORD
+static bool input_event_try_chord(input_event_engine_t* e, uint8_t i, input_event_queue_t* q)
+{
+    input_event_src_t* s = &e->src[i];
+
+    for (uint8_t j = 0; j < e->num; j++)
+    {
+        input_event_src_t* o = &e->src[j];
+        const int32_t gap = (int32_t) (s->press_tick - o->press_tick);
+
+        if ((j == i) || (o->kind != INPUT_KIND_BUTTON) || !o->stable || o->consumed || o->long_sent ||
+            ((gap < 0) ? -gap : gap) > (int32_t) s_timing.chord_ms)
+        {
+            continue;
+        }
+        s->consumed      = true;
+        o->consumed      = true;
+        s->click_pending = false;
+        o->click_pending = false;
+        input_event_push(q, INPUT_EVENT_CHORD, (j < i) ? j : i, (uint16_t) ((1U << i) | (1U << j)));
+        return true;
+    }
+    return false;
+}
+
+static void input_event_edge(input_event_engine_t* e, uint8_t i, input_event_queue_t* q)
+{
+    input_event_src_t* s = &e->src[i];
+
+    if (s->kind == INPUT_KIND_FADER)
+    {
+        input_event_push(q, s->stable ? INPUT_EVENT_CUT : INPUT_EVENT_OPEN, i, 0);
+        return;
+    }
+
+    if (s->stable)
+    {
+        const bool is_double = s->click_pending && ((uint32_t) (s->raw_tick - s->release_tick) <= s_timing.double_ms);
+
+        s->press_tick    = s->raw_tick;
+        s->long_sent     = false;
+        s->consumed      = false;
+        s->click_pending = false;
+        input_event_push(q, INPUT_EVENT_PRESS, i, 0);
+
+        if (!input_event_try_chord(e, i, q) && is_double)
+        {
+            s->consumed = true;
+            input_event_push(q, INPUT_EVENT_DOUBLE, i, 0);
+        }
+        return;
+    }
+
+    const uint32_t held = s->raw_tick - s->press_tick;
+    s->release_tick     = s->raw_tick;
+    input_event_push(q, INPUT_EVENT_RELEASE, i, (uint16_t) ((held > 0xFFFFU) ? 0xFFFFU : held));
+
+    if (!s->long_sent && !s->consumed)
+    {
+        if (s_timing.double_ms == 0U)
+        {
+            input_event_push(q, INPUT_EVENT_CLICK, i, 0);
+        }
+        else
+        {
+            s->click_pending = true;
+        }
+    }
+    s->consumed = false;
+}
+
+// levels の bit i = ソース i がオン (押している / カット中)。出したイベントの数を返す (cap を超えた分は捨てる)
+uint8_t input_event_update(input_event_engine_t* e, uint32_t now, uint32_t levels, input_event_t* out, uint8_t cap)
+{
+    input_event_queue_t q = {.out = out, .cap = (out != NULL) ? cap : 0U, .n = 0};
+
+    for (uint8_t i = 0; i < e->num; i++)
+    {
+        input_event_src_t* s = &e->src[i];
+        const bool level     = ((levels >> i) & 1U) != 0U;
+
+        if (level != s->raw)
+        {
+            s->raw      = level;
+            s->raw_tick = now;
+        }
+
+        // 受付時間を過ぎた CLICK を先に出す (次の押下がその後なら DOUBLE にしない)
+        if (s->click_pending && input_event_elapsed(now, s->release_tick, (uint32_t) s_timing.double_ms + 1U) &&
+            !(s->raw && ((uint32_t) (s->raw_tick - s->release_tick) <= s_timing.double_ms)))
+        {
+            s->click_pending = false;
+            input_event_push(&q, INPUT_EVENT_CLICK, i, 0);
+        }
+
+        const uint16_t debounce = (s->kind == INPUT_KIND_FADER) ? s_timing.cut_ms : s_timing.debounce_ms;
+        if ((s->raw != s->stable) && input_event_elapsed(now, s->raw_tick, debounce))
+        {
+            s->stable = s->raw;
+            input_event_edge(e, i, &q);
+        }
+
+        if ((s->kind == INPUT_KIND_BUTTON) && s->stable && !s->long_sent && !s->consumed &&
+            input_event_elapsed(now, s->press_tick, s_timing.long_ms))
+        {
+            s->long_sent = true;
+            input_event_push(&q, INPUT_EVENT_LONG, i, 0);
+        }
+    }
+    return q.n;
+}
+
+static void input_event_min_deadline(uint32_t* next, uint32_t now, uint32_t at)
+{
+    const int32_t d   = (int32_t) (at - now);
+    const uint32_t ms = (d > 0) ? (uint32_t) d : 0U;
+    if (ms < *next)
+    {
+        *next = ms;
+    }
+}
+
+// 次に時間で状態が変わる (チャタリング除去の確定、LONG、CLICK) までの ms。何も待っていなければ 0xFFFFFFFF
+uint32_t input_event_next_ms(const input_event_engine_t* e, uint32_t now)
+{
+    uint32_t next = INPUT_EVENT_NO_DEADLINE;
+
+    for (uint8_t i = 0; i < e->num; i++)
+    {
+        const input_event_src_t* s = &e->src[i];
+
+        if (s->raw != s->stable)
+        {
+            input_event_min_deadline(&next, now, s->raw_tick + ((s->kind == INPUT_KIND_FADER) ? s_timing.cut_ms : s_timing.debounce_ms));
+        }
+        if ((s->kind == INPUT_KIND_BUTTON) && s->stable && !s->long_sent && !s->consumed)
+        {
+            input_event_min_deadline(&next, now, s->press_tick + s_timing.long_ms);
+        }
+        if (s->click_pending)
+        {
+            input_event_min_deadline(&next, now, s->release_tick + s_timing.double_ms + 1U);
+        }
+    }
+    return next;
+}
+
+bool input_event_set_timing(const input_event_timing_t* t)
+{
+    if ((t == NULL) || (t->long_ms <= t->chord_ms) || (t->long_ms <= t->debounce_ms))
+    {
+        return false;
+    }
+    s_timing = *t;
+    return true;
+}
+
+void input_event_get_timing(input_event_timing_t* t)
+{
+    if (t != NULL)
+    {
+        *t = s_timing;
+    }
+}
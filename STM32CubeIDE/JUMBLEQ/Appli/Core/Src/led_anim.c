@@ -0,0 +1,200 @@
+/*
+ * led_anim.c
+ *
+ *  Created on: Mar 17, 2026
+ */
+
+#include "led_anim.h"
+
+#include <stddef.h>
+#include <string.h>
+
+static const led_anim_key_t s_blink_keys[] = {
+    {0x0000U, 255U, 1U},
+    {0x8000U, 0U, 1U},
+};
+static const led_anim_key_t s_pulse_keys[] = {
+    {0x0000U, 0U, 0U},
+    {0x8000U, 255U, 0U},
+    {0xFFFFU, 0U, 0U},
+};
+static const led_anim_key_t s_fade_keys[] = {
+    {0x0000U, 255U, 0U},
+    {0xFFFFU, 0U, 0U},
+};
+
+const led_anim_effect_t led_anim_fx_blink = {s_blink_keys, (uint8_t) (sizeof(s_blink_keys) / sizeof(s_blink_keys[0]))};
+const led_anim_effect_t led_anim_fx_pulse = {s_pulse_keys, (uint8_t) (sizeof(s_pulse_keys) / sizeof(s_pulse_keys[0]))};
+const led_anim_effect_t led_anim_fx_fade  = {s_fade_keys, (uint8_t) (sizeof(s_fade_keys) / sizeof(s_fade_keys[0]))};
+
+static uint8_t led_anim_scale(uint8_t c, uint8_t level)
+{
+    return (uint8_t) (((uint32_t) c * level + 127U) / 255U);
+}
+
+static uint8_t led_anim_envelope(const led_anim_effect_t* fx, uint16_t phase)
+{
+    if ((fx == NULL) || (fx->key_num == 0U))
+    {
+        return LED_ANIM_LEVEL_MAX;
+    }
+
+    uint8_t k = 0;
+    while (((uint8_t) (k + 1U) < fx->key_num) && (fx->keys[k + 1U].phase <= phase))
+    {
+        k++;
+    }
+
+    const led_anim_key_t* a = &fx->keys[k];
+    if ((a->hold != 0U) || ((uint8_t) (k + 1U) >= fx->key_num) || (phase < a->phase))
+    {
+        return a->level;
+    }
+
+    // キーの間は Q16 の比率で直線補間
+    const led_anim_key_t* b = &fx->keys[k + 1U];
+    const uint32_t frac     = ((uint32_t) (phase - a->phase) << 16) / (uint32_t) (b->phase - a->phase);
+    return (uint8_t) ((int32_t) a->level + (((int32_t) b->level - (int32_t) a->level) * (int32_t) frac) / 65536);
+}
+
+static uint8_t led_anim_blend_channel(uint8_t d, uint8_t c, uint8_t level, uint8_t blend)
+{
+    const uint8_t v = led_anim_scale(c, level);
+
+    switch (blend)
+    {
+    case LED_ANIM_BLEND_MAX:
+        return (v > d) ? v : d;
+    case LED_ANIM_BLEND_ADD:
+        return (uint8_t) (((uint32_t) d + v > 255U) ? 255U : (d + v));
+    case LED_ANIM_BLEND_MIX:
+        return (uint8_t) (d + (((int32_t) c - (int32_t) d) * level) / 255);
+    default:
+        return v;
+    }
+}
+
+static void led_anim_blend(led_anim_rgb_t* dst, led_anim_rgb_t c, uint8_t level, uint8_t blend)
+{
+    dst->r = led_anim_blend_channel(dst->r, c.r, level, blend);
+    dst->g = led_anim_blend_channel(dst->g, c.g, level, blend);
+    dst->b = led_anim_blend_channel(dst->b, c.b, level, blend);
+}
+
+void led_anim_init(led_anim_t* a, const led_anim_layer_def_t* defs, uint8_t num, uint8_t led_num)
+{
+    memset(a, 0, sizeof(*a));
+    a->num     = (num < LED_ANIM_LAYER_MAX) ? num : (uint8_t) LED_ANIM_LAYER_MAX;
+    a->led_num = led_num;
+    for (uint8_t i = 0; i < a->num; i++)
+    {
+        a->layer[i].def       = &defs[i];
+        a->layer[i].period_ms = defs[i].period_ms;
+    }
+}
+
+void led_anim_start(led_anim_t* a, uint8_t layer, uint32_t now)
+{
+    if (layer < a->num)
+    {
+        a->layer[layer].start  = now;
+        a->layer[layer].active = true;
+    }
+}
+
+void led_anim_stop(led_anim_t* a, uint8_t layer)
+{
+    if (layer < a->num)
+    {
+        a->layer[layer].active = false;
+    }
+}
+
+bool led_anim_is_active(const led_anim_t* a, uint8_t layer)
+{
+    return (layer < a->num) && a->layer[layer].active;
+}
+
+void led_anim_set_value(led_anim_t* a, uint8_t layer, uint8_t value)
+{
+    if (layer < a->num)
+    {
+        a->layer[layer].value = value;
+    }
+}
+
+// 周期を変えても開始時刻はそのまま (繰り返しのエフェクトは位相が飛ぶだけ)
+void led_anim_set_period(led_anim_t* a, uint8_t layer, uint16_t period_ms)
+{
+    if (layer < a->num)
+    {
+        a->layer[layer].period_ms = period_ms;
+    }
+}
+
+// frame (led_num 個) を黒にしてから、動いているレイヤーを順に重ねる。repeat 回終わったレイヤーはここで止める
+void led_anim_render(led_anim_t* a, uint32_t now, led_anim_rgb_t* frame)
+{
+    memset(frame, 0, (size_t) a->led_num * sizeof(frame[0]));
+
+    for (uint8_t n = 0; n < a->num; n++)
+    {
+        led_anim_layer_t* l           = &a->layer[n];
+        const led_anim_layer_def_t* d = l->def;
+
+        if (!l->active || (d->led_num == 0U))
+        {
+            continue;
+        }
+
+        const uint32_t period  = (l->period_ms != 0U) ? l->period_ms : 1U;
+        const uint32_t elapsed = now - l->start;
+        const uint32_t cycles  = elapsed / period;
+        if ((d->repeat != 0U) && (cycles >= d->repeat))
+        {
+            l->active = false;
+            continue;
+        }
+
+        const uint16_t phase = (uint16_t) (((elapsed - cycles * period) << 16) / period);
+        const uint8_t level  = led_anim_envelope(d->fx, phase);
+
+        uint8_t first = 0;
+        uint8_t count = d->led_num;
+        switch (d->shape)
+        {
+        case LED_ANIM_SHAPE_METER:
+            count = (uint8_t) (((uint32_t) l->value * d->led_num + 127U) / 255U);
+            break;
+        case LED_ANIM_SHAPE_POINT:
+            first = (l->value < d->led_num) ? l->value : (uint8_t) (d->led_num - 1U);
+            count = 1U;
+            break;
+        case LED_ANIM_SHAPE_CHASE:
+            first = (uint8_t) (cycles % d->led_num);
+            count = 1U;
+            break;
+        default:
+            break;
+        }
+
+        for (uint8_t i = 0; i < d->led_num; i++)
+        {
+            const uint8_t idx = d->leds[i];
+            const bool lit    = (i >= first) && (i < (uint8_t) (first + count));
+
+            if (idx >= a->led_num)
+            {
+                continue;
+            }
+            if (lit)
+            {
+                led_anim_blend(&frame[idx], (d->palette != NULL) ? d->palette[i] : d->color, level, d->blend);
+            }
+            else if (d->blend == LED_ANIM_BLEND_REPLACE)
+            {
+                frame[idx] = (led_anim_rgb_t) {0, 0, 0};
+            }
+        }
+    }
+}
@@ -10,9 +10,11 @@
 #include "tim.h"
 
 #include "audio_control.h"
+#include "dsp_readback.h"
+#include "led_anim.h"
+#include "ws2812.h"
 
-#include "SigmaStudioFW.h"
-#include "JUMBLEQ_DSP_ADAU146xSchematic_1_PARAM.h"
+#include <string.h>
 
 #define RGB            3
 #define COL_BITS       8
@@ -20,29 +22,52 @@
 #define LED_NUMS       10
 #define LED_BUF_NUMS   WL_LED_BIT_LEN* LED_NUMS
 #define DMA_BUF_SIZE   (LED_NUMS * WL_LED_BIT_LEN + 1)
-#define WL_LED_ONE     16
-#define WL_LED_ZERO    7
 
-#define BLINK_COUNT_MAX 64
-#define SAVE_BLINK_INTERVAL_MS 100U
-#define SAVE_BLINK_TOGGLE_COUNT 6U
+// 色は知覚的に均等な値で持ち、送る直前に LED_GAMMA と明るさの LUT を通す
+#define LED_GAMMA              2.2f
+#define LED_BRIGHTNESS         255U  // LUT にかける明るさ (0-255)
+#define LED_STATS_LOG          0  // 1秒毎に合成したフレーム数、DMA を起動した回数、エンコードのサイクル数を RTT に出す
+
+#define XF_PULSE_PERIOD_MS   320U  // 旧実装の 64 フレーム x 5ms
+#define SAVE_BLINK_PERIOD_MS 200U
+#define SAVE_BLINK_COUNT     3U
+#define MIDI_FLASH_PERIOD_MS 80U
+#define GPIO_LED_ON_LEVEL    128U  // 単色 LED はこれ以上で点灯
 
 __attribute__((section("noncacheable_buffer"), aligned(32))) uint8_t led_buf[DMA_BUF_SIZE] = {0};
 
-uint8_t grb[LED_NUMS][RGB] = {0};
+// grb: 合成中のフレーム、s_grb_sent: 最後に送ったフレーム (LUT 後)。変わった時だけ DMA を起動する
+static uint8_t grb[LED_NUMS][RGB] = {0};
+static uint8_t s_grb_sent[LED_NUMS][RGB];
+static uint8_t s_gamma_lut[256];
+static bool s_gamma_built        = false;
+static bool s_force_send         = true;
+static volatile bool s_dma_busy  = false;
+
+#if LED_STATS_LOG
+static struct
+{
+    uint32_t frames;
+    uint32_t sent;
+    uint32_t encode_cyc;
+    uint32_t last_ms;
+} s_led_stats;
+#endif
 
 volatile bool is_color_update = false;
-static volatile uint8_t s_save_blink_remaining = 0U;
-static uint32_t s_save_blink_last_ms = 0U;
+static volatile bool s_save_pending = false;
+static volatile bool s_midi_pending = false;
 
 uint16_t test = 0;
 
-typedef struct
+// フレームの並び: WS2812 (0..LED_NUMS-1) の後に基板上の単色 LED
+enum
 {
-    uint8_t r;
-    uint8_t g;
-    uint8_t b;
-} led_rgb_t;
+    LED_PIX_GPIO0 = LED_NUMS,  // LED0: 生存確認、MIDI、保存
+    LED_PIX_GPIO1,             // LED1: USB RX
+    LED_PIX_GPIO2,             // LED2: USB TX
+    LED_PIX_NUM,
+};
 
 enum
 {
@@ -51,14 +76,31 @@ enum
     XF_THRESHOLD_NUM = 4,
 };
 
-static const float s_vu_db_thresholds[VU_LEVEL_COUNT] = {-45.0f, -36.0f, -27.0f, -18.0f, -9.0f};
+// 番号の小さい方から重ねる
+enum
+{
+    LED_LAYER_VU_A = 0,
+    LED_LAYER_VU_B,
+    LED_LAYER_XF_A,
+    LED_LAYER_XF_B,
+    LED_LAYER_USB_TX,
+    LED_LAYER_USB_RX,
+    LED_LAYER_ALIVE,
+    LED_LAYER_MIDI,
+    LED_LAYER_SAVE,
+    LED_LAYER_NUM,
+};
+
+// 旧実装(20*ln)の {-45, -36, -27, -18, -9} と同じ点灯位置を 20*log10 に換算した値
+static const float s_vu_db_thresholds[VU_LEVEL_COUNT] = {-19.54f, -15.63f, -11.73f, -7.82f, -3.91f};
 
-static const led_rgb_t s_vu_colors_low_to_high[VU_LEVEL_COUNT] = {
-    {0,   32, 0},
-    {30,  61, 0},
-    {100, 70, 0},
-    {120, 38, 0},
-    {127, 0,  0},
+// LED_GAMMA を通すと従来の PWM 値 {0,32,0} {30,61,0} {100,70,0} {120,38,0} {127,0,0} になる
+static const led_anim_rgb_t s_vu_colors_low_to_high[VU_LEVEL_COUNT] = {
+    {0,   99,  0},
+    {96,  133, 0},
+    {167, 142, 0},
+    {181, 107, 0},
+    {186, 0,   0},
 };
 
 static const uint8_t s_vu_led_index_a[VU_LEVEL_COUNT] = {0, 1, 2, 3, 4};
@@ -68,7 +110,36 @@ static const uint8_t s_xf_thresholds[XF_THRESHOLD_NUM] = {32, 64, 96, 120};
 static const uint8_t s_xf_led_index_a[XF_SLOT_COUNT]   = {0, 1, 2, 3, 4};
 static const uint8_t s_xf_led_index_b[XF_SLOT_COUNT]   = {9, 8, 7, 6, 5};
 
-static const float s_xf_blink_peak_level = 80.0f;
+static const uint8_t s_pix_gpio0[1] = {LED_PIX_GPIO0};
+static const uint8_t s_pix_gpio1[1] = {LED_PIX_GPIO1};
+static const uint8_t s_pix_gpio2[1] = {LED_PIX_GPIO2};
+
+// MIDI を受けたら、点いていても消えていても分かるように 消灯→点灯→消灯
+static const led_anim_key_t s_midi_flash_keys[] = {
+    {0x0000U, 0U, 1U},
+    {0x4000U, 255U, 1U},
+    {0xC000U, 0U, 1U},
+};
+static const led_anim_effect_t s_midi_flash = {s_midi_flash_keys, (uint8_t) (sizeof(s_midi_flash_keys) / sizeof(s_midi_flash_keys[0]))};
+
+#define LED_WHITE(v) {(v), (v), (v)}
+
+static const led_anim_layer_def_t s_layers[LED_LAYER_NUM] = {
+    [LED_LAYER_VU_A]   = {.leds = s_vu_led_index_a, .palette = s_vu_colors_low_to_high, .led_num = VU_LEVEL_COUNT, .shape = LED_ANIM_SHAPE_METER, .blend = LED_ANIM_BLEND_REPLACE},
+    [LED_LAYER_VU_B]   = {.leds = s_vu_led_index_b, .palette = s_vu_colors_low_to_high, .led_num = VU_LEVEL_COUNT, .shape = LED_ANIM_SHAPE_METER, .blend = LED_ANIM_BLEND_REPLACE},
+    // LED_GAMMA 後で 80
+    [LED_LAYER_XF_A]   = {.fx = &led_anim_fx_pulse, .leds = s_xf_led_index_a, .color = LED_WHITE(151U), .period_ms = XF_PULSE_PERIOD_MS, .led_num = XF_SLOT_COUNT, .shape = LED_ANIM_SHAPE_POINT, .blend = LED_ANIM_BLEND_MAX},
+    [LED_LAYER_XF_B]   = {.fx = &led_anim_fx_pulse, .leds = s_xf_led_index_b, .color = LED_WHITE(151U), .period_ms = XF_PULSE_PERIOD_MS, .led_num = XF_SLOT_COUNT, .shape = LED_ANIM_SHAPE_POINT, .blend = LED_ANIM_BLEND_MAX},
+    [LED_LAYER_USB_TX] = {.fx = &led_anim_fx_blink, .leds = s_pix_gpio2, .color = LED_WHITE(255U), .led_num = 1},
+    [LED_LAYER_USB_RX] = {.fx = &led_anim_fx_blink, .leds = s_pix_gpio1, .color = LED_WHITE(255U), .led_num = 1},
+    [LED_LAYER_ALIVE]  = {.leds = s_pix_gpio0, .color = LED_WHITE(255U), .led_num = 1},
+    [LED_LAYER_MIDI]   = {.fx = &s_midi_flash, .leds = s_pix_gpio0, .color = LED_WHITE(255U), .period_ms = MIDI_FLASH_PERIOD_MS, .led_num = 1, .repeat = 1},
+    [LED_LAYER_SAVE]   = {.fx = &led_anim_fx_blink, .leds = s_pix_gpio0, .color = LED_WHITE(255U), .period_ms = SAVE_BLINK_PERIOD_MS, .led_num = 1, .repeat = SAVE_BLINK_COUNT},
+};
+
+static led_anim_t s_anim;
+static led_anim_rgb_t s_frame[LED_PIX_NUM];
+static bool s_anim_ready = false;
 
 void update_color_state(void)
 {
@@ -77,55 +148,20 @@ void update_color_state(void)
 
 void led_notify_save_success(void)
 {
-    s_save_blink_remaining = SAVE_BLINK_TOGGLE_COUNT;
-    s_save_blink_last_ms = 0U;
+    s_save_pending = true;
 }
 
-void reset_led_buffer(void)
+// 他のタスクから呼ばれるので、ここでは印だけ付けて ledTask でアニメーションを始める
+void led_notify_midi_activity(void)
 {
-    for (int i = 0; i < DMA_BUF_SIZE; i++)
-    {
-        led_buf[i] = 0x00;
-    }
-
-    for (int k = 0; k < LED_NUMS; k++)
-    {
-        for (int j = 0; j < RGB; j++)
-        {
-            grb[k][j] = 0x00;
-        }
-    }
+    s_midi_pending = true;
 }
 
-//--------------------------------------------------------------------+
-// BLINKING TASK
-//--------------------------------------------------------------------+
-void led_tx_blinking_task(void)
-{
-    static uint32_t start_ms = 0;
-
-    // Blink every interval ms
-    if (HAL_GetTick() - start_ms < get_tx_blink_interval_ms())
-    {
-        return;
-    }
-    start_ms += get_tx_blink_interval_ms();
-
-    HAL_GPIO_TogglePin(LED2_GPIO_Port, LED2_Pin);
-}
-
-void led_rx_blinking_task(void)
+void reset_led_buffer(void)
 {
-    static uint32_t start_ms = 0;
-
-    // Blink every interval ms
-    if (HAL_GetTick() - start_ms < get_rx_blink_interval_ms())
-    {
-        return;
-    }
-    start_ms += get_rx_blink_interval_ms();
-
-    HAL_GPIO_TogglePin(LED1_GPIO_Port, LED1_Pin);
+    memset(led_buf, 0, sizeof(led_buf));
+    memset(grb, 0, sizeof(grb));
+    s_force_send = true;
 }
 
 void set_led_color(uint8_t index, uint8_t red, uint8_t green, uint8_t blue)
@@ -135,44 +171,71 @@ void set_led_color(uint8_t index, uint8_t red, uint8_t green, uint8_t blue)
     grb[index][2] = blue;
 }
 
-void layer_led_color(uint8_t index, uint8_t red, uint8_t green, uint8_t blue)
-{
-    grb[index][0] |= green;
-    grb[index][1] |= red;
-    grb[index][2] |= blue;
-}
-
+// 合成したフレームに LUT を通し、前回送ったものと違えば PWM 列にして DMA を起動する
+// DMA が送信中なら次の呼び出しに回す
 void renew(void)
 {
+    uint8_t out[LED_NUMS][RGB];
+
+    if (!s_gamma_built)
+    {
+        ws2812_build_gamma(s_gamma_lut, LED_GAMMA, LED_BRIGHTNESS);
+        s_gamma_built = true;
+        s_force_send  = true;
+    }
+
     for (int k = 0; k < LED_NUMS; k++)
     {
         for (int j = 0; j < RGB; j++)
         {
-            for (int i = 0; i < COL_BITS; i++)
-            {
-                const uint8_t val = grb[k][j];
-
-                led_buf[WL_LED_BIT_LEN * k + COL_BITS * j + i] = ((val >> ((COL_BITS - 1) - i)) & 0x01) ? WL_LED_ONE : WL_LED_ZERO;
-            }
+            out[k][j] = s_gamma_lut[grb[k][j]];
         }
     }
-    led_buf[DMA_BUF_SIZE - 1] = 0x00;
 
-    HAL_TIM_PWM_Start_DMA(&htim1, TIM_CHANNEL_3, (uint32_t*) led_buf, DMA_BUF_SIZE);
+#if LED_STATS_LOG
+    s_led_stats.frames++;
+#endif
+    if ((!s_force_send && (memcmp(out, s_grb_sent, sizeof(out)) == 0)) || s_dma_busy)
+    {
+        return;
+    }
+
+#if LED_STATS_LOG
+    const uint32_t start = DWT->CYCCNT;
+#endif
+    ws2812_encode(&out[0][0], (uint16_t) sizeof(out), led_buf);
+    led_buf[DMA_BUF_SIZE - 1] = 0x00;
+#if LED_STATS_LOG
+    s_led_stats.encode_cyc += DWT->CYCCNT - start;
+    s_led_stats.sent++;
+#endif
+
+    memcpy(s_grb_sent, out, sizeof(out));
+    s_force_send = false;
+    s_dma_busy   = true;
+    if (HAL_TIM_PWM_Start_DMA(&htim1, TIM_CHANNEL_3, (uint32_t*) led_buf, DMA_BUF_SIZE) != HAL_OK)
+    {
+        s_dma_busy   = false;
+        s_force_send = true;
+    }
 }
 
-static float read_dbfs_from_sigma(uint16_t addr)
+#if LED_STATS_LOG
+static void led_stats_report(void)
 {
-    ADI_REG_TYPE rx_data[4] = {0};
-    SIGMA_READ_REGISTER(DEVICE_ADDR_ADAU146XSCHEMATIC_1, addr, 4, rx_data);
-    uint32_t val = rx_data[0] << 24 | rx_data[1] << 16 | rx_data[2] << 8 | rx_data[3];
+    const uint32_t now = HAL_GetTick();
 
-    if (val == 0 || val == 0xFFFFFFFF)
+    if ((now - s_led_stats.last_ms) < 1000U)
     {
-        return -96.0f;
+        return;
     }
-    return 20.0f * log((float) val / pow(2, 23));
+    const uint32_t sent = (s_led_stats.sent != 0U) ? s_led_stats.sent : 1U;
+    SEGGER_RTT_printf(0, "[LED] frames=%lu dma=%lu encode=%lu cyc/frame\n", (unsigned long) s_led_stats.frames,
+                      (unsigned long) s_led_stats.sent, (unsigned long) (s_led_stats.encode_cyc / sent));
+    memset(&s_led_stats, 0, sizeof(s_led_stats));
+    s_led_stats.last_ms = now;
 }
+#endif
 
 static uint8_t vu_active_count(float dbfs)
 {
@@ -186,121 +249,111 @@ static uint8_t vu_active_count(float dbfs)
     return VU_LEVEL_COUNT;
 }
 
-static void set_vu_meter_generic(uint16_t sigma_addr, const uint8_t led_index_low_to_high[VU_LEVEL_COUNT])
+// メーターの value は 0-255 で点灯数に比例
+static uint8_t vu_meter_value(uint8_t meter)
 {
-    const float dbfs        = read_dbfs_from_sigma(sigma_addr);
-    const uint8_t active_on = vu_active_count(dbfs);
+    return (uint8_t) ((vu_active_count(dsp_readback_get_dbfs(meter)) * LED_ANIM_LEVEL_MAX) / VU_LEVEL_COUNT);
+}
 
-    for (uint8_t i = 0; i < VU_LEVEL_COUNT; i++)
+static uint8_t calc_xf_slot(uint8_t xf_pos)
+{
+    for (uint8_t i = 0; i < XF_THRESHOLD_NUM; i++)
     {
-        if (i < active_on)
-        {
-            set_led_color(led_index_low_to_high[i], s_vu_colors_low_to_high[i].r, s_vu_colors_low_to_high[i].g, s_vu_colors_low_to_high[i].b);
-        }
-        else
+        if (xf_pos < s_xf_thresholds[i])
         {
-            set_led_color(led_index_low_to_high[i], 0, 0, 0);
+            return i;
         }
     }
+    return XF_SLOT_COUNT - 1;
 }
 
-void set_vu_meter_a(void)
+static uint16_t usb_blink_period(uint32_t interval_ms)
 {
-    set_vu_meter_generic(MOD_DSPREADBACK_A_VALUE_ADDR, s_vu_led_index_a);
+    const uint32_t period = interval_ms * 2U;
+    return (uint16_t) ((period > 0xFFFFU) ? 0xFFFFU : period);
 }
 
-void set_vu_meter_b(void)
+static void led_anim_setup(uint32_t now)
 {
-    set_vu_meter_generic(MOD_DSPREADBACK_B_VALUE_ADDR, s_vu_led_index_b);
+    led_anim_init(&s_anim, s_layers, LED_LAYER_NUM, LED_PIX_NUM);
+    led_anim_start(&s_anim, LED_LAYER_VU_A, now);
+    led_anim_start(&s_anim, LED_LAYER_VU_B, now);
+    led_anim_start(&s_anim, LED_LAYER_XF_A, now);
+    led_anim_start(&s_anim, LED_LAYER_XF_B, now);
+    led_anim_start(&s_anim, LED_LAYER_USB_TX, now);
+    led_anim_start(&s_anim, LED_LAYER_USB_RX, now);
+    s_anim_ready = true;
 }
 
-static uint8_t calc_white_level(uint8_t blink_count)
+// 他のタスクからの状態をレイヤーに渡す
+static void led_anim_feed(uint32_t now)
 {
-    if (blink_count < BLINK_COUNT_MAX / 2)
-    {
-        return (uint8_t) (s_xf_blink_peak_level * ((float) blink_count / (float) (BLINK_COUNT_MAX / 2)));
-    }
-    return (uint8_t) (s_xf_blink_peak_level * ((float) ((BLINK_COUNT_MAX - 1) - blink_count) / (float) (BLINK_COUNT_MAX / 2)));
-}
+    led_anim_set_value(&s_anim, LED_LAYER_VU_A, vu_meter_value(DSP_READBACK_METER_A));
+    led_anim_set_value(&s_anim, LED_LAYER_VU_B, vu_meter_value(DSP_READBACK_METER_B));
+    led_anim_set_value(&s_anim, LED_LAYER_XF_A, calc_xf_slot(get_current_xfA_position()));
+    led_anim_set_value(&s_anim, LED_LAYER_XF_B, calc_xf_slot(get_current_xfB_position()));
+    led_anim_set_period(&s_anim, LED_LAYER_USB_TX, usb_blink_period(get_tx_blink_interval_ms()));
+    led_anim_set_period(&s_anim, LED_LAYER_USB_RX, usb_blink_period(get_rx_blink_interval_ms()));
 
-static uint8_t calc_xf_slot(uint8_t xf_pos)
-{
-    for (uint8_t i = 0; i < XF_THRESHOLD_NUM; i++)
+    if (is_color_update)
     {
-        if (xf_pos < s_xf_thresholds[i])
+        is_color_update = false;
+        if (led_anim_is_active(&s_anim, LED_LAYER_ALIVE))
         {
-            return i;
+            led_anim_stop(&s_anim, LED_LAYER_ALIVE);
+        }
+        else
+        {
+            led_anim_start(&s_anim, LED_LAYER_ALIVE, now);
         }
     }
-    return XF_SLOT_COUNT - 1;
-}
-
-static void layer_xf_position(uint8_t led_index, uint8_t white_level)
-{
-    for (uint8_t i = 0; i < LED_NUMS; i++)
+    // 連続して来ている間は、1 回分が終わってから次を始める
+    if (s_midi_pending && !led_anim_is_active(&s_anim, LED_LAYER_MIDI))
     {
-        layer_led_color(i, 0, 0, 0);
+        s_midi_pending = false;
+        led_anim_start(&s_anim, LED_LAYER_MIDI, now);
+    }
+    if (s_save_pending)
+    {
+        s_save_pending = false;
+        led_anim_start(&s_anim, LED_LAYER_SAVE, now);
     }
-    layer_led_color(led_index, white_level, white_level, white_level);
-}
-
-void layer_xfA_position(void)
-{
-    static uint8_t blink_count_a  = 0;
-    const uint8_t xf_pos          = get_current_xfA_position();
-    const uint8_t white_level     = calc_white_level(blink_count_a);
-    const uint8_t slot            = calc_xf_slot(xf_pos);
-    const uint8_t led_index_for_a = s_xf_led_index_a[slot];
-    layer_xf_position(led_index_for_a, white_level);
-
-    blink_count_a = (blink_count_a + 1) % BLINK_COUNT_MAX;
 }
 
-void layer_xfB_position(void)
+static void write_gpio_led(GPIO_TypeDef* port, uint16_t pin, led_anim_rgb_t c)
 {
-    static uint8_t blink_count_b  = 0;
-    const uint8_t xf_pos          = get_current_xfB_position();
-    const uint8_t white_level     = calc_white_level(blink_count_b);
-    const uint8_t slot            = calc_xf_slot(xf_pos);
-    const uint8_t led_index_for_b = s_xf_led_index_b[slot];
-    layer_xf_position(led_index_for_b, white_level);
-
-    blink_count_b = (blink_count_b + 1) % BLINK_COUNT_MAX;
+    const bool on = (c.r >= GPIO_LED_ON_LEVEL) || (c.g >= GPIO_LED_ON_LEVEL) || (c.b >= GPIO_LED_ON_LEVEL);
+    HAL_GPIO_WritePin(port, pin, on ? GPIO_PIN_SET : GPIO_PIN_RESET);
 }
 
 void rgb_led_task(void)
 {
-    set_vu_meter_a();
-    set_vu_meter_b();
-    layer_xfA_position();
-    layer_xfB_position();
-    renew();
+    const uint32_t now = HAL_GetTick();
 
-    if (s_save_blink_remaining > 0U)
+    if (!s_anim_ready)
     {
-        uint32_t now = HAL_GetTick();
-        if ((s_save_blink_last_ms == 0U) || ((now - s_save_blink_last_ms) >= SAVE_BLINK_INTERVAL_MS))
-        {
-            s_save_blink_last_ms = now;
-            HAL_GPIO_TogglePin(LED0_GPIO_Port, LED0_Pin);
-            s_save_blink_remaining--;
-            if (s_save_blink_remaining == 0U)
-            {
-                HAL_GPIO_WritePin(LED0_GPIO_Port, LED0_Pin, GPIO_PIN_SET);
-            }
-        }
+        led_anim_setup(now);
     }
+    led_anim_feed(now);
+    led_anim_render(&s_anim, now, s_frame);
 
-    if (is_color_update)
+    for (uint8_t i = 0; i < LED_NUMS; i++)
     {
-        HAL_GPIO_TogglePin(LED0_GPIO_Port, LED0_Pin);
-
-        is_color_update = false;
+        set_led_color(i, s_frame[i].r, s_frame[i].g, s_frame[i].b);
     }
+    write_gpio_led(LED0_GPIO_Port, LED0_Pin, s_frame[LED_PIX_GPIO0]);
+    write_gpio_led(LED1_GPIO_Port, LED1_Pin, s_frame[LED_PIX_GPIO1]);
+    write_gpio_led(LED2_GPIO_Port, LED2_Pin, s_frame[LED_PIX_GPIO2]);
+
+    renew();
+#if LED_STATS_LOG
+    led_stats_report();
+#endif
 }
 
 void HAL_TIM_PWM_PulseFinishedCallback(TIM_HandleTypeDef* htim)
 {
     HAL_TIM_PWM_Stop_DMA(htim, TIM_CHANNEL_3);
+    s_dma_busy = false;
     __DSB();
 }
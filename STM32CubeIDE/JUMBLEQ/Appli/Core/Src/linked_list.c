@@ -23,14 +23,17 @@
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
 #include "audio_control.h"
+#include "mag_fader.h"
 /* USER CODE END Includes */
 
 DMA_NodeTypeDef Node_GPDMA1_Channel2 __attribute__((section("noncacheable_buffer")));
 DMA_QListTypeDef List_GPDMA1_Channel2;
 DMA_NodeTypeDef Node_GPDMA1_Channel3 __attribute__((section("noncacheable_buffer")));
 DMA_QListTypeDef List_GPDMA1_Channel3;
-DMA_NodeTypeDef Node_HPDMA1_Channel0 __attribute__((section("noncacheable_buffer")));
+DMA_NodeTypeDef Node_HPDMA1_Channel0[POT_NUM * 2U] __attribute__((section("noncacheable_buffer")));
 DMA_QListTypeDef List_HPDMA1_Channel0;
+DMA_NodeTypeDef Node_HPDMA1_Channel1 __attribute__((section("noncacheable_buffer")));
+DMA_QListTypeDef List_HPDMA1_Channel1;
 
 /* Private typedef -----------------------------------------------------------*/
 /* USER CODE BEGIN PTD */
@@ -47,7 +50,9 @@ DMA_QListTypeDef List_HPDMA1_Channel0;
 extern int32_t stereo_out_buf[];  // RX バッファ（main.c）
 extern int32_t stereo_in_buf[];   // TX バッファ（main.c）
 
-extern uint32_t adc_val[];
+extern uint32_t adc_val[POT_NUM][ADC_NUM];
+extern uint32_t pot_mux_bsrr[POT_NUM];
+extern uint32_t mag_fader_dma_buf[MAG_FADER_BLOCK_SCANS * 2U][MAG_SW_NUM];
 /* USER CODE END PM */
 
 /**
@@ -156,9 +161,80 @@ HAL_StatusTypeDef MX_List_HPDMA1_Channel0_Config(void)
   /* Rebuilding the queue is required when sample-rate switch reconfigures DMA multiple times. */
   ret |= HAL_DMAEx_List_ResetQ(&List_HPDMA1_Channel0);
 
-  /* Set node configuration ################################################*/
+  /* ポット MUX 位置 k 毎に2ノード:
+       [2k]   ADC1 の1スキャン (ADC_NUM ランク) -> adc_val[k][]
+       [2k+1] pot_mux_bsrr[k+1] -> GPIOD->BSRR (次のトリガまでに MUX をセトリングさせる)
+     転送完了割り込みは1周 (POT_NUM スキャン) の最後のノードだけで上げる */
+  for (uint32_t k = 0; k < POT_NUM; k++)
+  {
+    const uint32_t tcem = (k == (POT_NUM - 1U)) ? DMA_TCEM_BLOCK_TRANSFER : DMA_TCEM_LAST_LL_ITEM_TRANSFER;
+
+    /* Set node configuration ################################################*/
+    pNodeConfig.NodeType = DMA_HPDMA_LINEAR_NODE;
+    pNodeConfig.Init.Request = HPDMA1_REQUEST_ADC1;
+    pNodeConfig.Init.BlkHWRequest = DMA_BREQ_SINGLE_BURST;
+    pNodeConfig.Init.Direction = DMA_PERIPH_TO_MEMORY;
+    pNodeConfig.Init.SrcInc = DMA_SINC_FIXED;
+    pNodeConfig.Init.DestInc = DMA_DINC_INCREMENTED;
+    pNodeConfig.Init.SrcDataWidth = DMA_SRC_DATAWIDTH_WORD;
+    pNodeConfig.Init.DestDataWidth = DMA_DEST_DATAWIDTH_WORD;
+    pNodeConfig.Init.SrcBurstLength = 1;
+    pNodeConfig.Init.DestBurstLength = 1;
+    pNodeConfig.Init.TransferAllocatedPort = DMA_SRC_ALLOCATED_PORT1|DMA_DEST_ALLOCATED_PORT0;
+    pNodeConfig.Init.TransferEventMode = DMA_TCEM_LAST_LL_ITEM_TRANSFER;
+    pNodeConfig.Init.Mode = DMA_NORMAL;
+    pNodeConfig.TriggerConfig.TriggerPolarity = DMA_TRIG_POLARITY_MASKED;
+    pNodeConfig.DataHandlingConfig.DataExchange = DMA_EXCHANGE_NONE;
+    pNodeConfig.DataHandlingConfig.DataAlignment = DMA_DATA_RIGHTALIGN_ZEROPADDED;
+    pNodeConfig.SrcAddress = (uint32_t) &ADC1->DR;
+    pNodeConfig.DstAddress = (uint32_t) adc_val[k];
+    pNodeConfig.DataSize = ADC_NUM * 4U;
+
+    /* Build Node_HPDMA1_Channel0 ADC Node */
+    ret |= HAL_DMAEx_List_BuildNode(&pNodeConfig, &Node_HPDMA1_Channel0[2U * k]);
+
+    /* Insert Node_HPDMA1_Channel0 ADC Node to Queue */
+    ret |= HAL_DMAEx_List_InsertNode_Tail(&List_HPDMA1_Channel0, &Node_HPDMA1_Channel0[2U * k]);
+
+    /* MUX 切り替えノード (ソフトウェアリクエスト = 即時実行) */
+    pNodeConfig.Init.Request = DMA_REQUEST_SW;
+    pNodeConfig.Init.Direction = DMA_MEMORY_TO_MEMORY;
+    pNodeConfig.Init.SrcInc = DMA_SINC_FIXED;
+    pNodeConfig.Init.DestInc = DMA_DINC_FIXED;
+    pNodeConfig.Init.TransferAllocatedPort = DMA_SRC_ALLOCATED_PORT0|DMA_DEST_ALLOCATED_PORT1;
+    pNodeConfig.Init.TransferEventMode = tcem;
+    pNodeConfig.SrcAddress = (uint32_t) &pot_mux_bsrr[(k + 1U) % POT_NUM];
+    pNodeConfig.DstAddress = (uint32_t) &GPIOD->BSRR;
+    pNodeConfig.DataSize = 4U;
+
+    /* Build Node_HPDMA1_Channel0 MUX Node */
+    ret |= HAL_DMAEx_List_BuildNode(&pNodeConfig, &Node_HPDMA1_Channel0[(2U * k) + 1U]);
+
+    /* Insert Node_HPDMA1_Channel0 MUX Node to Queue */
+    ret |= HAL_DMAEx_List_InsertNode_Tail(&List_HPDMA1_Channel0, &Node_HPDMA1_Channel0[(2U * k) + 1U]);
+  }
+
+  ret |= HAL_DMAEx_List_SetCircularMode(&List_HPDMA1_Channel0);
+
+   return ret;
+}
+
+/**
+  * @brief  DMA Linked-list List_HPDMA1_Channel1 configuration (ADC2 磁気クロスフェーダー)
+  * @param  None
+  * @retval None
+  */
+HAL_StatusTypeDef MX_List_HPDMA1_Channel1_Config(void)
+{
+  HAL_StatusTypeDef ret = HAL_OK;
+  /* DMA node configuration declaration */
+  DMA_NodeConfTypeDef pNodeConfig;
+
+  ret |= HAL_DMAEx_List_ResetQ(&List_HPDMA1_Channel1);
+
+  /* 半分 (MAG_FADER_BLOCK_SCANS スキャン) 毎に HT/TC でブロック処理する */
   pNodeConfig.NodeType = DMA_HPDMA_LINEAR_NODE;
-  pNodeConfig.Init.Request = HPDMA1_REQUEST_ADC1;
+  pNodeConfig.Init.Request = HPDMA1_REQUEST_ADC2;
   pNodeConfig.Init.BlkHWRequest = DMA_BREQ_SINGLE_BURST;
   pNodeConfig.Init.Direction = DMA_PERIPH_TO_MEMORY;
   pNodeConfig.Init.SrcInc = DMA_SINC_FIXED;
@@ -173,17 +249,17 @@ HAL_StatusTypeDef MX_List_HPDMA1_Channel0_Config(void)
   pNodeConfig.TriggerConfig.TriggerPolarity = DMA_TRIG_POLARITY_MASKED;
   pNodeConfig.DataHandlingConfig.DataExchange = DMA_EXCHANGE_NONE;
   pNodeConfig.DataHandlingConfig.DataAlignment = DMA_DATA_RIGHTALIGN_ZEROPADDED;
-  pNodeConfig.SrcAddress = (uint32_t) &ADC1->DR;
-  pNodeConfig.DstAddress = (uint32_t) adc_val;
-  pNodeConfig.DataSize = ADC_NUM * 4U;
+  pNodeConfig.SrcAddress = (uint32_t) &ADC2->DR;
+  pNodeConfig.DstAddress = (uint32_t) mag_fader_dma_buf;
+  pNodeConfig.DataSize = sizeof(mag_fader_dma_buf);
 
-  /* Build Node_HPDMA1_Channel0 Node */
-  ret |= HAL_DMAEx_List_BuildNode(&pNodeConfig, &Node_HPDMA1_Channel0);
+  /* Build Node_HPDMA1_Channel1 Node */
+  ret |= HAL_DMAEx_List_BuildNode(&pNodeConfig, &Node_HPDMA1_Channel1);
 
-  /* Insert Node_HPDMA1_Channel0 to Queue */
-  ret |= HAL_DMAEx_List_InsertNode_Tail(&List_HPDMA1_Channel0, &Node_HPDMA1_Channel0);
+  /* Insert Node_HPDMA1_Channel1 to Queue */
+  ret |= HAL_DMAEx_List_InsertNode_Tail(&List_HPDMA1_Channel1, &Node_HPDMA1_Channel1);
 
-  ret |= HAL_DMAEx_List_SetCircularMode(&List_HPDMA1_Channel0);
+  ret |= HAL_DMAEx_List_SetCircularMode(&List_HPDMA1_Channel1);
 
    return ret;
 }
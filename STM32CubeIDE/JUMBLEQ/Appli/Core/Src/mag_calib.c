@@ -0,0 +1,321 @@
+/*
+ * mag_calib.c
+ *
+ *  Created on: Mar 11, 2026
+ */
+
+#include "mag_calib.h"
+
+#include "eeprom.h"
+#include "mag_fader.h"
+#include "tim.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define MAG_CALIB_BLOCK_HZ       (POT_SCAN_TIM_HZ / MAG_FADER_BLOCK_SCANS)  // 2000
+#define MAG_CALIB_GUIDED_WINDOW  (MAG_CALIB_BLOCK_HZ)        // この間ずっと静止していたら採用 (1s)
+#define MAG_CALIB_GUIDED_TIMEOUT (MAG_CALIB_BLOCK_HZ * 10U)  // 10s
+#define MAG_CALIB_STABLE_BAND    12                          // 窓内の max-min [LSB]
+
+// ドリフト追従: オフセットから MAG_DRIFT_IDLE_BAND 以内に MAG_DRIFT_IDLE_BLOCKS 続いたセンサーだけ
+// 時定数 2^MAG_DRIFT_SHIFT ブロック (約8s) で追従する。保存値から MAG_DRIFT_MAX 以上は動かさない
+#define MAG_DRIFT_IDLE_BAND   (MAG_XFADE_CUTOFF / 2)
+#define MAG_DRIFT_IDLE_BLOCKS (MAG_CALIB_BLOCK_HZ)
+#define MAG_DRIFT_SHIFT       14
+#define MAG_DRIFT_MAX         48
+#define MAG_DRIFT_STEP_BLOCKS 256U  // 窓待ち中のまとめた更新で一度に進めるブロック数の上限
+#define MAG_DRIFT_FRAC        16    // オフセットの小数部 [bit]。1 ブロックの歩幅 (差 / 2^14) が 1LSB 未満の差でも 0 にならないように
+
+static uint8_t s_source = MAG_CALIB_SRC_NONE;
+static uint16_t s_rest[MAG_SW_NUM];
+static int32_t s_offset_q[MAG_SW_NUM];  // rest + drift (Q MAG_DRIFT_FRAC)
+static uint16_t s_idle_count[MAG_SW_NUM];
+
+// 起動時の平均
+static uint32_t s_boot_sum[MAG_SW_NUM];
+static uint16_t s_boot_count;
+
+// ガイド付きキャリブレーション
+static bool s_guided;
+static uint32_t s_guided_blocks;
+static uint32_t s_win_count;
+static uint32_t s_win_sum[MAG_SW_NUM];
+static uint16_t s_win_min[MAG_SW_NUM];
+static uint16_t s_win_max[MAG_SW_NUM];
+
+// EEPROM からの読み込みは defaultTask、適用は adcTask (mag_calib_update) で行う
+static uint16_t s_stored_rest[MAG_SW_NUM];
+static volatile bool s_stored_pending;
+
+static const char* mag_calib_source_name(uint8_t source)
+{
+    switch (source)
+    {
+    case MAG_CALIB_SRC_BOOT:
+        return "boot";
+    case MAG_CALIB_SRC_EEPROM:
+        return "eeprom";
+    case MAG_CALIB_SRC_GUIDED:
+        return "guided";
+    default:
+        return "none";
+    }
+}
+
+static void mag_calib_set_rest(const uint16_t rest[MAG_SW_NUM], uint8_t source)
+{
+    for (uint32_t ch = 0; ch < MAG_SW_NUM; ch++)
+    {
+        s_rest[ch]       = rest[ch];
+        s_offset_q[ch]   = (int32_t) rest[ch] << MAG_DRIFT_FRAC;
+        s_idle_count[ch] = 0;
+    }
+    s_source = source;
+}
+
+static void mag_calib_window_reset(void)
+{
+    s_win_count = 0;
+    for (uint32_t ch = 0; ch < MAG_SW_NUM; ch++)
+    {
+        s_win_sum[ch] = 0;
+        s_win_min[ch] = UINT16_MAX;
+        s_win_max[ch] = 0;
+    }
+}
+
+// DSP のリスタート時など。決まったオフセットはそのまま使い続ける
+void mag_calib_reset(void)
+{
+    s_boot_count = 0;
+    memset(s_boot_sum, 0, sizeof(s_boot_sum));
+    memset(s_idle_count, 0, sizeof(s_idle_count));
+    s_guided = false;
+}
+
+void mag_calib_set_stored(const uint16_t rest[MAG_SW_NUM])
+{
+    memcpy(s_stored_rest, rest, sizeof(s_stored_rest));
+    __DMB();
+    s_stored_pending = true;
+}
+
+// 起動時に defaultTask から呼ぶ。保存値が無ければ起動時の平均のまま
+bool mag_calib_load(I2C_HandleTypeDef* hi2c)
+{
+    EEPROM_MagCalib_t cal;
+
+    if (EEPROM_LoadMagCalib(hi2c, &cal) != HAL_OK)
+    {
+        SEGGER_RTT_printf(0, "[MAGCAL] no stored calibration, using boot average\n");
+        return false;
+    }
+    mag_calib_set_stored(cal.rest);
+    return true;
+}
+
+HAL_StatusTypeDef mag_calib_save(I2C_HandleTypeDef* hi2c)
+{
+    EEPROM_MagCalib_t cal = {0};
+
+    memcpy(cal.rest, s_rest, sizeof(cal.rest));
+    return EEPROM_SaveMagCalib(hi2c, &cal);
+}
+
+bool mag_calib_start_guided(void)
+{
+    if (s_guided)
+    {
+        return false;
+    }
+
+    mag_calib_window_reset();
+    s_guided_blocks = 0;
+    s_guided        = true;
+    // 静止中で 窓待ちならブロック処理に戻す (窓の判定に毎ブロック必要)
+    mag_fader_wakeup();
+    SEGGER_RTT_printf(0, "[MAGCAL] guided: release all faders and keep them still\n");
+    return true;
+}
+
+static uint8_t mag_calib_update_guided(const uint16_t val[MAG_SW_NUM])
+{
+    bool stable = true;
+
+    for (uint32_t ch = 0; ch < MAG_SW_NUM; ch++)
+    {
+        s_win_sum[ch] += val[ch];
+        s_win_min[ch] = (val[ch] < s_win_min[ch]) ? val[ch] : s_win_min[ch];
+        s_win_max[ch] = (val[ch] > s_win_max[ch]) ? val[ch] : s_win_max[ch];
+        if ((s_win_max[ch] - s_win_min[ch]) > MAG_CALIB_STABLE_BAND)
+        {
+            stable = false;
+        }
+    }
+    s_win_count++;
+    s_guided_blocks++;
+
+    if (!stable)
+    {
+        // 動いている間は窓をやり直す
+        mag_calib_window_reset();
+    }
+    else if (s_win_count >= MAG_CALIB_GUIDED_WINDOW)
+    {
+        uint16_t rest[MAG_SW_NUM];
+        for (uint32_t ch = 0; ch < MAG_SW_NUM; ch++)
+        {
+            rest[ch] = (uint16_t) ((s_win_sum[ch] + (s_win_count / 2U)) / s_win_count);
+        }
+        mag_calib_set_rest(rest, MAG_CALIB_SRC_GUIDED);
+        s_guided = false;
+        return MAG_CALIB_EVENT_GUIDED_DONE;
+    }
+
+    if (s_guided_blocks >= MAG_CALIB_GUIDED_TIMEOUT)
+    {
+        s_guided = false;
+        return MAG_CALIB_EVENT_GUIDED_FAILED;
+    }
+    return MAG_CALIB_EVENT_NONE;
+}
+
+static void mag_calib_track_drift(const uint16_t val[MAG_SW_NUM], uint32_t blocks)
+{
+    if (blocks > MAG_DRIFT_STEP_BLOCKS)
+    {
+        blocks = MAG_DRIFT_STEP_BLOCKS;
+    }
+
+    for (uint32_t ch = 0; ch < MAG_SW_NUM; ch++)
+    {
+        const int32_t x = (int32_t) val[ch] << MAG_DRIFT_FRAC;
+
+        if (abs(x - s_offset_q[ch]) > (MAG_DRIFT_IDLE_BAND << MAG_DRIFT_FRAC))
+        {
+            s_idle_count[ch] = 0;
+            continue;
+        }
+        if (s_idle_count[ch] < MAG_DRIFT_IDLE_BLOCKS)
+        {
+            const uint32_t n = s_idle_count[ch] + blocks;
+            s_idle_count[ch] = (uint16_t) ((n < MAG_DRIFT_IDLE_BLOCKS) ? n : MAG_DRIFT_IDLE_BLOCKS);
+            continue;
+        }
+
+        // 差は MAG_DRIFT_IDLE_BAND 以内なので (8 << 16) * 256 でも int32 に入る
+        const int32_t step  = ((x - s_offset_q[ch]) * (int32_t) blocks + (1 << (MAG_DRIFT_SHIFT - 1))) >> MAG_DRIFT_SHIFT;
+        int32_t offset      = s_offset_q[ch] + step;
+        const int32_t rest  = (int32_t) s_rest[ch] << MAG_DRIFT_FRAC;
+        const int32_t limit = MAG_DRIFT_MAX << MAG_DRIFT_FRAC;
+        if (offset > rest + limit)
+        {
+            offset = rest + limit;
+        }
+        else if (offset < rest - limit)
+        {
+            offset = rest - limit;
+        }
+        s_offset_q[ch] = offset;
+    }
+}
+
+// adcTask から ADC2 のブロック毎に呼ぶ。戻り値は MAG_CALIB_EVENT_*
+// blocks は val が代表するブロック数 (通常 1、窓待ち中のタイムアウト読み出しではその間のブロック数)
+// 起動時の平均とガイド付きはブロック処理中 (blocks = 1) しか走らないので、ドリフト追従だけが使う
+uint8_t mag_calib_update(const uint16_t val[MAG_SW_NUM], uint32_t blocks)
+{
+    const bool was_ready = mag_calib_is_ready();
+
+    if (s_stored_pending)
+    {
+        __DMB();
+        if (!s_guided)
+        {
+            mag_calib_set_rest(s_stored_rest, MAG_CALIB_SRC_EEPROM);
+        }
+        s_stored_pending = false;
+    }
+
+    if (s_guided)
+    {
+        return mag_calib_update_guided(val);
+    }
+
+    if (s_source == MAG_CALIB_SRC_NONE)
+    {
+        for (uint32_t ch = 0; ch < MAG_SW_NUM; ch++)
+        {
+            s_boot_sum[ch] += val[ch];
+        }
+        if (++s_boot_count >= MAG_CALIBRATION_COUNT_MAX)
+        {
+            uint16_t rest[MAG_SW_NUM];
+            for (uint32_t ch = 0; ch < MAG_SW_NUM; ch++)
+            {
+                rest[ch] = (uint16_t) (s_boot_sum[ch] / MAG_CALIBRATION_COUNT_MAX);
+            }
+            mag_calib_set_rest(rest, MAG_CALIB_SRC_BOOT);
+        }
+    }
+    else
+    {
+        mag_calib_track_drift(val, blocks);
+    }
+
+    return (!was_ready && mag_calib_is_ready()) ? MAG_CALIB_EVENT_READY : MAG_CALIB_EVENT_NONE;
+}
+
+bool mag_calib_is_ready(void)
+{
+    return s_source != MAG_CALIB_SRC_NONE;
+}
+
+bool mag_calib_is_guided(void)
+{
+    return s_guided;
+}
+
+uint16_t mag_calib_offset(uint8_t ch)
+{
+    if (ch >= MAG_SW_NUM)
+    {
+        return 0;
+    }
+    return (uint16_t) ((s_offset_q[ch] + (1 << (MAG_DRIFT_FRAC - 1))) >> MAG_DRIFT_FRAC);
+}
+
+void mag_calib_get_info(mag_calib_info_t* info)
+{
+    if (info == NULL)
+    {
+        return;
+    }
+
+    info->source        = s_source;
+    info->guided_active = s_guided;
+    info->idle_mask     = 0;
+    for (uint32_t ch = 0; ch < MAG_SW_NUM; ch++)
+    {
+        info->rest[ch]  = s_rest[ch];
+        info->drift[ch] = (int16_t) ((int32_t) mag_calib_offset((uint8_t) ch) - (int32_t) s_rest[ch]);
+        if (s_idle_count[ch] >= MAG_DRIFT_IDLE_BLOCKS)
+        {
+            info->idle_mask |= 1UL << ch;
+        }
+    }
+}
+
+void mag_calib_report(void)
+{
+    mag_calib_info_t info;
+
+    mag_calib_get_info(&info);
+    SEGGER_RTT_printf(0, "[MAGCAL] src=%s guided=%u idle=0x%02lX\n", mag_calib_source_name(info.source),
+                      (unsigned) info.guided_active, (unsigned long) info.idle_mask);
+    for (uint32_t ch = 0; ch < MAG_SW_NUM; ch++)
+    {
+        SEGGER_RTT_printf(0, "[MAGCAL] ch%lu rest=%u drift=%d\n", (unsigned long) ch, (unsigned) info.rest[ch], (int) info.drift[ch]);
+    }
+}
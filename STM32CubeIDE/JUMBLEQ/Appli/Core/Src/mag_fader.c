@@ -0,0 +1,317 @@
+/*
+ * mag_fader.c
+ *
+ *  Created on: Mar 8, 2026
+ */
+
+#include "mag_fader.h"
+
+#include "adc.h"
+#include "hpdma.h"
+#include "linked_list.h"
+#include "mag_filter.h"
+#include "mag_idle.h"
+#include "tim.h"
+
+#include "cmsis_os2.h"
+
+#include <string.h>
+
+extern osThreadId_t adcTaskHandle;
+extern DMA_QListTypeDef List_HPDMA1_Channel1;
+
+__attribute__((section("noncacheable_buffer"), aligned(32))) uint32_t mag_fader_dma_buf[MAG_FADER_BLOCK_SCANS * 2U][MAG_SW_NUM] = {0};
+
+static mag_filter_t s_filt;
+
+// ISR が s_val/s_block_cyc を書いてから s_seq を進める。読む側は s_seq が変わらなかったことで整合を確認する
+static volatile uint16_t s_val[MAG_SW_NUM];
+static volatile uint32_t s_block_cyc;
+static volatile uint32_t s_seq;
+static uint32_t s_read_seq;
+
+_Static_assert(MAG_IDLE_CH_NUM == MAG_SW_NUM, "MAG_IDLE_CH_NUM");
+_Static_assert(MAG_FILTER_CH_NUM == MAG_SW_NUM, "MAG_FILTER_CH_NUM");
+_Static_assert(MAG_FILTER_SCANS == MAG_FADER_BLOCK_SCANS, "MAG_FILTER_SCANS");
+
+// blocks/win_wakeups/idle_us は ISR、それ以外は adcTask だけが更新する
+static mag_fader_stats_t s_stats;
+
+// 窓待ちの間もブロック割り込みは来るが、センサー毎の窓 (s_win) と比べるだけでフィルタも adcTask も動かさない
+// 窓は adcTask が書いてから s_idle を立てる
+static mag_idle_window_t s_win;
+static volatile bool s_idle;
+static volatile bool s_wake_pending;  // 窓を出て起きてからまだ DSP に書いていない
+static volatile uint32_t s_wake_cyc;
+static uint32_t s_idle_tick;
+
+static uint32_t mag_fader_cyc_to_us(uint32_t cyc)
+{
+    const uint32_t cyc_per_us = SystemCoreClock / 1000000UL;
+    return (cyc_per_us != 0U) ? (cyc / cyc_per_us) : 0U;
+}
+
+// 割り込み禁止中 (または ISR) から呼ぶ
+static void mag_fader_leave_idle(void)
+{
+    s_stats.idle_us += (HAL_GetTick() - s_idle_tick) * 1000UL;
+    s_idle = false;
+}
+
+static void mag_fader_process_block(uint32_t first_scan)
+{
+    const uint32_t now = DWT->CYCCNT;
+    int32_t x[MAG_SW_NUM];
+    uint16_t val[MAG_SW_NUM];
+
+    mag_filter_average(&mag_fader_dma_buf[first_scan][0], x);
+
+    if (s_idle)
+    {
+        uint16_t raw[MAG_SW_NUM];
+        for (uint32_t ch = 0; ch < MAG_SW_NUM; ch++)
+        {
+            raw[ch] = mag_filter_raw(x[ch]);
+        }
+        if (!mag_idle_window_outside(&s_win, raw))
+        {
+            return;
+        }
+        s_wake_cyc     = now;
+        s_wake_pending = true;
+        s_stats.win_wakeups++;
+        mag_fader_leave_idle();
+    }
+
+    mag_filter_update(&s_filt, x, val);
+    for (uint32_t ch = 0; ch < MAG_SW_NUM; ch++)
+    {
+        s_val[ch] = val[ch];
+    }
+    s_block_cyc = now;
+    s_stats.blocks++;
+    __DMB();
+    s_seq++;
+
+    if (adcTaskHandle != NULL)
+    {
+        (void) osThreadFlagsSet(adcTaskHandle, MAG_FADER_THREAD_FLAG);
+    }
+}
+
+static void mag_fader_dma_half(DMA_HandleTypeDef* hdma)
+{
+    (void) hdma;
+    mag_fader_process_block(0U);
+}
+
+static void mag_fader_dma_cplt(DMA_HandleTypeDef* hdma)
+{
+    (void) hdma;
+    mag_fader_process_block(MAG_FADER_BLOCK_SCANS);
+}
+
+// start_adc から TIM3 を動かす前に1回だけ呼ぶ
+void mag_fader_init(void)
+{
+    if (HAL_ADCEx_Calibration_Start(&hadc2, ADC_SINGLE_ENDED) != HAL_OK)
+    {
+        Error_Handler();
+    }
+
+    SET_BIT(hadc2.Instance->CFGR, ADC_CFGR_DMAEN);
+    SET_BIT(hadc2.Instance->CFGR, ADC_CFGR_DMACFG);
+}
+
+void mag_fader_start(void)
+{
+    if (MX_List_HPDMA1_Channel1_Config() != HAL_OK)
+    {
+        Error_Handler();
+    }
+    if (HAL_DMAEx_List_LinkQ(&handle_HPDMA1_Channel1, &List_HPDMA1_Channel1) != HAL_OK)
+    {
+        Error_Handler();
+    }
+
+    mag_filter_reset(&s_filt);
+    s_idle         = false;
+    s_wake_pending = false;
+
+    handle_HPDMA1_Channel1.XferHalfCpltCallback = mag_fader_dma_half;
+    handle_HPDMA1_Channel1.XferCpltCallback     = mag_fader_dma_cplt;
+    if (HAL_DMAEx_List_Start_IT(&handle_HPDMA1_Channel1) != HAL_OK)
+    {
+        Error_Handler();
+    }
+    if (HAL_ADC_Start(&hadc2) != HAL_OK)
+    {
+        Error_Handler();
+    }
+}
+
+void mag_fader_stop(void)
+{
+    s_idle = false;
+
+    (void) HAL_ADC_Stop(&hadc2);
+    (void) HAL_DMA_Abort(&handle_HPDMA1_Channel1);
+}
+
+// 前回から新しいブロックがあれば true。block_cyc はそのブロックの完了時刻 (DWT)
+bool mag_fader_read(uint16_t val[MAG_SW_NUM], uint32_t* block_cyc)
+{
+    uint32_t seq;
+
+    do
+    {
+        seq = s_seq;
+        __DMB();
+        for (uint32_t ch = 0; ch < MAG_SW_NUM; ch++)
+        {
+            val[ch] = s_val[ch];
+        }
+        *block_cyc = s_block_cyc;
+        __DMB();
+    } while (seq != s_seq);
+
+    if (seq == s_read_seq)
+    {
+        return false;
+    }
+    if ((seq - s_read_seq) > 1U)
+    {
+        s_stats.dropped += seq - s_read_seq - 1U;
+    }
+    s_read_seq = seq;
+    return true;
+}
+
+void mag_fader_note_dsp_write(uint32_t block_cyc)
+{
+    const uint32_t now = DWT->CYCCNT;
+    const uint32_t us  = mag_fader_cyc_to_us(now - block_cyc);
+
+    s_stats.writes++;
+    s_stats.sum_us += us;
+    if (us > s_stats.max_us)
+    {
+        s_stats.max_us = us;
+    }
+
+    if (s_wake_pending)
+    {
+        const uint32_t wake_us = mag_fader_cyc_to_us(now - s_wake_cyc);
+
+        s_wake_pending = false;
+        s_stats.wake_writes++;
+        s_stats.wake_sum_us += wake_us;
+        if (wake_us > s_stats.wake_max_us)
+        {
+            s_stats.wake_max_us = wake_us;
+        }
+    }
+}
+
+// adcTask が静止と判断したら呼ぶ。最後のフィルタ値からセンサー毎の窓を作り、ブロック毎の処理を窓の判定だけにする
+// (AWD2/AWD3 はセンサー3つで1つの窓しか持てず、止まっているフェーダーの位置で窓が広がってカットを見逃すので使わない)
+void mag_fader_arm_wakeup(void)
+{
+    uint16_t val[MAG_SW_NUM];
+
+    if (s_idle)
+    {
+        return;
+    }
+
+    for (uint32_t ch = 0; ch < MAG_SW_NUM; ch++)
+    {
+        val[ch] = s_val[ch];
+    }
+
+    const uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    mag_idle_window_set(&s_win, val);
+    s_idle         = true;
+    s_wake_pending = false;
+    s_idle_tick    = HAL_GetTick();
+    s_stats.idle_arms++;
+    __set_PRIMASK(primask);
+}
+
+// adcTask 側から窓を出るのを待たずにブロック処理へ戻す (ガイド付きキャリブレーション開始、カーブ変更、タイムアウトで動きを見つけた時など)
+void mag_fader_wakeup(void)
+{
+    const uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (s_idle)
+    {
+        mag_fader_leave_idle();
+    }
+    __set_PRIMASK(primask);
+}
+
+bool mag_fader_is_idle(void)
+{
+    return s_idle;
+}
+
+// 窓待ちの間は s_val が止まっているので、タイムアウトで起きたときは DMA バッファ全体 (2ブロック) の平均を読む
+void mag_fader_sample_idle(uint16_t val[MAG_SW_NUM])
+{
+    const uint32_t n = MAG_FADER_BLOCK_SCANS * 2U;
+
+    for (uint32_t ch = 0; ch < MAG_SW_NUM; ch++)
+    {
+        uint32_t sum = 0;
+        for (uint32_t s = 0; s < n; s++)
+        {
+            sum += mag_fader_dma_buf[s][ch];
+        }
+        val[ch] = (uint16_t) ((sum + (n / 2U)) / n);
+    }
+}
+
+bool mag_fader_get_stats(mag_fader_stats_t* out)
+{
+    if (out == NULL)
+    {
+        return false;
+    }
+
+    const uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    memcpy(out, &s_stats, sizeof(*out));
+    __set_PRIMASK(primask);
+    return true;
+}
+
+// 前回の report 以降の集計を RTT に出してリセットする
+void mag_fader_report(void)
+{
+    mag_fader_stats_t st;
+
+    const uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    memcpy(&st, &s_stats, sizeof(st));
+    memset(&s_stats, 0, sizeof(s_stats));
+    if (s_idle)
+    {
+        // 待機中の分も今回の集計に入れる
+        const uint32_t now = HAL_GetTick();
+        st.idle_us += (now - s_idle_tick) * 1000UL;
+        s_idle_tick = now;
+    }
+    __set_PRIMASK(primask);
+
+    const uint32_t n  = (st.writes != 0U) ? st.writes : 1U;
+    const uint32_t wn = (st.wake_writes != 0U) ? st.wake_writes : 1U;
+    SEGGER_RTT_printf(0, "[MAGXF] blk=%lu drop=%lu wr=%lu lat=%lu/%lu us(avg/max, +%lu us block)\n",
+                      (unsigned long) st.blocks, (unsigned long) st.dropped, (unsigned long) st.writes,
+                      (unsigned long) (st.sum_us / n), (unsigned long) st.max_us,
+                      (unsigned long) (MAG_FADER_BLOCK_SCANS * 1000000UL / POT_SCAN_TIM_HZ));
+    SEGGER_RTT_printf(0, "[MAGXF] idle=%lu ms arm=%lu win=%lu wake->dsp=%lu/%lu us(avg/max, n=%lu)\n",
+                      (unsigned long) (st.idle_us / 1000UL), (unsigned long) st.idle_arms,
+                      (unsigned long) st.win_wakeups, (unsigned long) (st.wake_sum_us / wn),
+                      (unsigned long) st.wake_max_us, (unsigned long) st.wake_writes);
+}
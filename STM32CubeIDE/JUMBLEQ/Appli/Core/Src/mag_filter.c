@@ -0,0 +1,49 @@
+/*
+ * mag_filter.c
+ *
+ *  Created on: Mar 23, 2026
+ */
+
+#include "mag_filter.h"
+
+#include <stdlib.h>
+
+void mag_filter_reset(mag_filter_t* f)
+{
+    f->primed = false;
+}
+
+// scans は [MAG_FILTER_SCANS][MAG_FILTER_CH_NUM] (DMA バッファの半分)。x は Q(MAG_FILTER_FRAC_BITS)
+void mag_filter_average(const uint32_t* scans, int32_t x[MAG_FILTER_CH_NUM])
+{
+    for (uint32_t ch = 0; ch < MAG_FILTER_CH_NUM; ch++)
+    {
+        uint32_t sum = 0;
+        for (uint32_t s = 0; s < MAG_FILTER_SCANS; s++)
+        {
+            sum += scans[(s * MAG_FILTER_CH_NUM) + ch];
+        }
+        x[ch] = (int32_t) ((sum << MAG_FILTER_FRAC_BITS) / MAG_FILTER_SCANS);
+    }
+}
+
+// 最初のブロックはそのまま取る。out は 12bit に丸めた値
+void mag_filter_update(mag_filter_t* f, const int32_t x[MAG_FILTER_CH_NUM], uint16_t out[MAG_FILTER_CH_NUM])
+{
+    for (uint32_t ch = 0; ch < MAG_FILTER_CH_NUM; ch++)
+    {
+        const int32_t d = x[ch] - f->y[ch];
+
+        if (!f->primed || (abs(d) >= (MAG_FILTER_FAST_DELTA << MAG_FILTER_FRAC_BITS)))
+        {
+            f->y[ch] = x[ch];
+        }
+        else
+        {
+            // 切り捨てだと上向きだけ遅れ、目標の 7/16 LSB 下で止まる
+            f->y[ch] += (d + (1 << (MAG_FILTER_IIR_SHIFT - 1))) >> MAG_FILTER_IIR_SHIFT;
+        }
+        out[ch] = (uint16_t) ((f->y[ch] + (1 << (MAG_FILTER_FRAC_BITS - 1))) >> MAG_FILTER_FRAC_BITS);
+    }
+    f->primed = true;
+}
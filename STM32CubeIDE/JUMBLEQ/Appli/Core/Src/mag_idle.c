@@ -0,0 +1,70 @@
+/*
+ * mag_idle.c
+ *
+ *  Created on: Mar 23, 2026
+ */
+
+#include "mag_idle.h"
+
+#include <string.h>
+
+void mag_idle_reset(mag_idle_t* m)
+{
+    memset(m->ref, 0, sizeof(m->ref));
+    m->still = 0;
+}
+
+// 基準から MAG_IDLE_BAND を超えたセンサーがあれば true
+bool mag_idle_moved(const mag_idle_t* m, const uint16_t val[MAG_IDLE_CH_NUM])
+{
+    for (uint32_t ch = 0; ch < MAG_IDLE_CH_NUM; ch++)
+    {
+        const int32_t d = (int32_t) val[ch] - (int32_t) m->ref[ch];
+        if ((d > MAG_IDLE_BAND) || (d < -MAG_IDLE_BAND))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// val が blocks ブロック分続いたとして数える。動いていたら基準を取り直す
+// 静止が MAG_IDLE_BLOCKS 以上続いていれば true (待ちに入ったら呼び出し側が still を 0 に戻す)
+bool mag_idle_update(mag_idle_t* m, const uint16_t val[MAG_IDLE_CH_NUM], uint32_t blocks)
+{
+    if (mag_idle_moved(m, val))
+    {
+        memcpy(m->ref, val, sizeof(m->ref));
+        m->still = 0;
+        return false;
+    }
+
+    m->still += blocks;
+    return m->still >= MAG_IDLE_BLOCKS;
+}
+
+// センサー毎に val ± MAG_IDLE_WAKE_BAND の窓を作る (ほかのセンサーの位置で広がらないように)
+void mag_idle_window_set(mag_idle_window_t* w, const uint16_t val[MAG_IDLE_CH_NUM])
+{
+    for (uint32_t ch = 0; ch < MAG_IDLE_CH_NUM; ch++)
+    {
+        const int32_t v  = val[ch];
+        const int32_t lo = v - MAG_IDLE_WAKE_BAND;
+        const int32_t hi = v + MAG_IDLE_WAKE_BAND;
+        w->lo[ch]        = (uint16_t) ((lo > 0) ? lo : 0);
+        w->hi[ch]        = (uint16_t) ((hi < 4095) ? hi : 4095);
+    }
+}
+
+// どれか1つでも窓を出たら true (ISR から呼ぶ)
+bool mag_idle_window_outside(const mag_idle_window_t* w, const uint16_t val[MAG_IDLE_CH_NUM])
+{
+    for (uint32_t ch = 0; ch < MAG_IDLE_CH_NUM; ch++)
+    {
+        if ((val[ch] < w->lo[ch]) || (val[ch] > w->hi[ch]))
+        {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,396 @@
+/*
+ * midi_map.c
+ *
+ *  Created on: Mar 12, 2026
+ */
+
+#include "midi_map.h"
+
+#include "eeprom.h"
+#include "led_control.h"
+#include "pot_takeover.h"
+#include "xfade_curve.h"
+#include "ui_control_internal.h"
+
+#include "tusb.h"
+
+#include <string.h>
+
+#define MIDI_MAP_LEARN_TIMEOUT_MS 10000U
+#define MIDI_MAP_SRC_NONE         0xFFU
+
+#define MIDI_MAP_CC(num, fl)  {.type = MIDI_MAP_TYPE_CC, .channel = 0, .curve = XFADE_CURVE_LINEAR, .flags = (fl), .number = (num), .min = 0, .max = 127U}
+#define MIDI_MAP_DSP(param)   {.type = MIDI_MAP_TYPE_DSP, .channel = 0, .curve = XFADE_CURVE_LINEAR, .flags = MIDI_MAP_PICKUP, .number = (param), .min = 0, .max = 1023U}
+#define MIDI_MAP_PICKUP       ((uint8_t) (POT_TAKEOVER_PICKUP << MIDI_MAP_FLAG_TAKEOVER_SHIFT))
+
+// 従来の固定割り当て: ポット 0-3 は CC 0-3、4-7 は DSP のゲイン、磁気フェーダー 0-5 は CC 15-10 (反転)
+// ポットはホスト/プリセットで値が変わったらピックアップで拾い直す
+#define MIDI_MAP_DEFAULTS                                                  \
+    {                                                                      \
+        [MIDI_MAP_SRC_POT0 + 0] = MIDI_MAP_CC(0U, MIDI_MAP_PICKUP),        \
+        [MIDI_MAP_SRC_POT0 + 1] = MIDI_MAP_CC(1U, MIDI_MAP_PICKUP),        \
+        [MIDI_MAP_SRC_POT0 + 2] = MIDI_MAP_CC(2U, MIDI_MAP_PICKUP),        \
+        [MIDI_MAP_SRC_POT0 + 3] = MIDI_MAP_CC(3U, MIDI_MAP_PICKUP),        \
+        [MIDI_MAP_SRC_POT0 + 4] = MIDI_MAP_DSP(MIDI_MAP_DSP_CH2_GAIN),     \
+        [MIDI_MAP_SRC_POT0 + 5] = MIDI_MAP_DSP(MIDI_MAP_DSP_MASTER_GAIN),  \
+        [MIDI_MAP_SRC_POT0 + 6] = MIDI_MAP_DSP(MIDI_MAP_DSP_CH1_GAIN),     \
+        [MIDI_MAP_SRC_POT0 + 7] = MIDI_MAP_DSP(MIDI_MAP_DSP_DRY_WET),      \
+        [MIDI_MAP_SRC_MAG0 + 0] = MIDI_MAP_CC(15U, MIDI_MAP_FLAG_INVERT),  \
+        [MIDI_MAP_SRC_MAG0 + 1] = MIDI_MAP_CC(14U, MIDI_MAP_FLAG_INVERT),  \
+        [MIDI_MAP_SRC_MAG0 + 2] = MIDI_MAP_CC(13U, MIDI_MAP_FLAG_INVERT),  \
+        [MIDI_MAP_SRC_MAG0 + 3] = MIDI_MAP_CC(12U, MIDI_MAP_FLAG_INVERT),  \
+        [MIDI_MAP_SRC_MAG0 + 4] = MIDI_MAP_CC(11U, MIDI_MAP_FLAG_INVERT),  \
+        [MIDI_MAP_SRC_MAG0 + 5] = MIDI_MAP_CC(10U, MIDI_MAP_FLAG_INVERT),  \
+    }
+
+_Static_assert(sizeof(midi_map_entry_t) == EEPROM_MIDI_MAP_ENTRY_BYTES, "EEPROM_MIDI_MAP_ENTRY_BYTES");
+_Static_assert(MIDI_MAP_SRC_NUM == EEPROM_MIDI_MAP_ENTRY_NUM, "EEPROM_MIDI_MAP_ENTRY_NUM");
+
+_Static_assert((POT_NUM == 8) && (MAG_SW_NUM == 6), "MIDI_MAP_DEFAULTS");
+
+static const midi_map_entry_t s_default_map[MIDI_MAP_SRC_NUM] = MIDI_MAP_DEFAULTS;
+static midi_map_entry_t s_map[MIDI_MAP_SRC_NUM]               = MIDI_MAP_DEFAULTS;
+static uint16_t s_last[MIDI_MAP_SRC_NUM];  // 最後に送った値 + 1 (0 = 未送信)。同じ値は送らない
+static uint32_t s_gen;
+
+static bool s_learn;
+static uint8_t s_learn_src = MIDI_MAP_SRC_NONE;
+static uint32_t s_learn_tick;
+
+void midi_map_set_defaults(void)
+{
+    memcpy(s_map, s_default_map, sizeof(s_map));
+    memset(s_last, 0, sizeof(s_last));
+    s_gen++;
+}
+
+uint16_t midi_map_type_max(uint8_t type)
+{
+    switch (type)
+    {
+    case MIDI_MAP_TYPE_CC:
+    case MIDI_MAP_TYPE_NOTE:
+        return 127U;
+    case MIDI_MAP_TYPE_NRPN:
+        return 16383U;
+    case MIDI_MAP_TYPE_DSP:
+        return 1023U;
+    default:
+        return 0U;
+    }
+}
+
+static bool midi_map_entry_valid(const midi_map_entry_t* e)
+{
+    const uint16_t vmax = midi_map_type_max(e->type);
+
+    if ((e->type >= MIDI_MAP_TYPE_NUM) || (e->channel > 15U) || (e->curve >= XFADE_CURVE_NUM) ||
+        ((e->flags & (uint8_t) ~(MIDI_MAP_FLAG_INVERT | MIDI_MAP_FLAG_TAKEOVER_MASK)) != 0U) || (e->min > vmax) || (e->max > vmax))
+    {
+        return false;
+    }
+
+    switch (e->type)
+    {
+    case MIDI_MAP_TYPE_CC:
+    case MIDI_MAP_TYPE_NOTE:
+        return e->number <= 127U;
+    case MIDI_MAP_TYPE_NRPN:
+        return e->number <= 16383U;
+    case MIDI_MAP_TYPE_DSP:
+        return e->number < MIDI_MAP_DSP_NUM;
+    default:
+        return true;
+    }
+}
+
+bool midi_map_get_entry(uint8_t src, midi_map_entry_t* entry)
+{
+    if ((src >= MIDI_MAP_SRC_NUM) || (entry == NULL))
+    {
+        return false;
+    }
+    *entry = s_map[src];
+    return true;
+}
+
+bool midi_map_set_entry(uint8_t src, const midi_map_entry_t* entry)
+{
+    if ((src >= MIDI_MAP_SRC_NUM) || (entry == NULL) || !midi_map_entry_valid(entry))
+    {
+        return false;
+    }
+    s_map[src]  = *entry;
+    s_last[src] = 0;
+    s_gen++;
+    return true;
+}
+
+// 割り当てが変わる度に増える (ポットのフィルタの出力ビット数を合わせ直すため)
+uint32_t midi_map_generation(void)
+{
+    return s_gen;
+}
+
+// ポットのフィルタで量子化するビット数 (ADC は 12bit)
+uint8_t midi_map_value_bits(uint8_t src)
+{
+    if (src >= MIDI_MAP_SRC_NUM)
+    {
+        return 7U;
+    }
+
+    switch (s_map[src].type)
+    {
+    case MIDI_MAP_TYPE_NRPN:
+        return 12U;
+    case MIDI_MAP_TYPE_DSP:
+        return 10U;
+    default:
+        return 7U;
+    }
+}
+
+static void midi_map_send_cc(uint8_t channel, uint8_t number, uint8_t value)
+{
+    uint8_t msg[3] = {(uint8_t) (0xB0U | channel), number, value};
+    tud_midi_stream_write(0, msg, 3);
+    led_notify_midi_activity();
+}
+
+static void midi_map_send_nrpn(uint8_t channel, uint16_t number, uint16_t value)
+{
+    midi_map_send_cc(channel, 99U, (uint8_t) (number >> 7));
+    midi_map_send_cc(channel, 98U, (uint8_t) (number & 0x7FU));
+    midi_map_send_cc(channel, 6U, (uint8_t) (value >> 7));
+    midi_map_send_cc(channel, 38U, (uint8_t) (value & 0x7FU));
+}
+
+static void midi_map_send_note(uint8_t channel, uint8_t number, bool on, uint8_t velocity)
+{
+    uint8_t msg[3] = {(uint8_t) ((on ? 0x90U : 0x80U) | channel), number, on ? velocity : 0U};
+    tud_midi_stream_write(0, msg, 3);
+    led_notify_midi_activity();
+}
+
+// 操作子の値 (0..full_scale) → カーブ → 反転 → [min, max]
+static uint16_t midi_map_apply(const midi_map_entry_t* e, uint32_t value, uint32_t full_scale)
+{
+    uint32_t q = (value >= full_scale) ? XFADE_Q15_ONE : (uint32_t) (((uint64_t) value * XFADE_Q15_ONE) / full_scale);
+    q          = xfade_curve_eval(e->curve, (uint16_t) q);
+    if ((e->flags & MIDI_MAP_FLAG_INVERT) != 0U)
+    {
+        q = XFADE_Q15_ONE - q;
+    }
+    const int32_t span = (int32_t) e->max - (int32_t) e->min;
+    return (uint16_t) ((int32_t) e->min + (int32_t) ((span * (int32_t) q + (int32_t) (XFADE_Q15_ONE / 2U)) >> 15));
+}
+
+uint8_t midi_map_takeover_mode(uint8_t src)
+{
+    if (src >= MIDI_MAP_SRC_NUM)
+    {
+        return POT_TAKEOVER_JUMP;
+    }
+    return (uint8_t) ((s_map[src].flags & MIDI_MAP_FLAG_TAKEOVER_MASK) >> MIDI_MAP_FLAG_TAKEOVER_SHIFT);
+}
+
+// 出力 out になる操作子の値 (0..full_scale) を探す。カーブは単調なので二分探索
+bool midi_map_reverse(uint8_t src, uint16_t out, uint32_t full_scale, uint32_t* value)
+{
+    if ((src >= MIDI_MAP_SRC_NUM) || (full_scale == 0U) || (value == NULL))
+    {
+        return false;
+    }
+
+    const midi_map_entry_t* e = &s_map[src];
+    if ((e->type == MIDI_MAP_TYPE_NONE) || (e->type == MIDI_MAP_TYPE_NOTE))
+    {
+        return false;
+    }
+
+    const bool rising = midi_map_apply(e, full_scale, full_scale) >= midi_map_apply(e, 0, full_scale);
+    uint32_t lo       = 0;
+    uint32_t hi       = full_scale;
+    while (lo < hi)
+    {
+        const uint32_t mid = (lo + hi) / 2U;
+        const uint16_t o   = midi_map_apply(e, mid, full_scale);
+        if (rising ? (o < out) : (o > out))
+        {
+            lo = mid + 1U;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    *value = lo;
+    return true;
+}
+
+// 割り当て先の値が外から変わったので、次は同じ値でも送り直す
+void midi_map_invalidate(uint8_t src)
+{
+    if (src < MIDI_MAP_SRC_NUM)
+    {
+        s_last[src] = 0;
+    }
+}
+
+// 操作子の値 (0..full_scale) を割り当て先に送る
+void midi_map_emit(uint8_t src, uint32_t value, uint32_t full_scale)
+{
+    if ((src >= MIDI_MAP_SRC_NUM) || (full_scale == 0U))
+    {
+        return;
+    }
+
+    if (s_learn && (s_learn_src == MIDI_MAP_SRC_NONE))
+    {
+        s_learn_src = src;
+        SEGGER_RTT_printf(0, "[MAP] learn: src=%u selected, send a CC/note from the host\n", (unsigned) src);
+    }
+
+    const midi_map_entry_t* e = &s_map[src];
+    if (e->type == MIDI_MAP_TYPE_NONE)
+    {
+        return;
+    }
+
+    const uint16_t out = midi_map_apply(e, value, full_scale);
+
+    if (e->type == MIDI_MAP_TYPE_NOTE)
+    {
+        const uint16_t on = (out > ((e->min + e->max) / 2U)) ? 2U : 1U;
+        if (on != s_last[src])
+        {
+            midi_map_send_note(e->channel, (uint8_t) e->number, on == 2U, (uint8_t) ((e->max > 0U) ? e->max : 1U));
+            s_last[src] = on;
+        }
+        return;
+    }
+
+    if ((uint16_t) (out + 1U) == s_last[src])
+    {
+        return;
+    }
+    s_last[src] = (uint16_t) (out + 1U);
+
+    switch (e->type)
+    {
+    case MIDI_MAP_TYPE_CC:
+        midi_map_send_cc(e->channel, (uint8_t) e->number, (uint8_t) out);
+        break;
+    case MIDI_MAP_TYPE_NRPN:
+        midi_map_send_nrpn(e->channel, e->number, out);
+        break;
+    case MIDI_MAP_TYPE_DSP:
+        ui_control_set_dsp_param((uint8_t) e->number, out);
+        break;
+    default:
+        break;
+    }
+}
+
+bool midi_map_load(I2C_HandleTypeDef* hi2c)
+{
+    EEPROM_MidiMap_t rec;
+    midi_map_entry_t map[MIDI_MAP_SRC_NUM];
+
+    midi_map_set_defaults();
+    if (EEPROM_LoadMidiMap(hi2c, &rec) != HAL_OK)
+    {
+        SEGGER_RTT_printf(0, "[MAP] no stored mapping, using defaults\n");
+        return false;
+    }
+
+    memcpy(map, rec.entry, sizeof(map));
+    for (uint32_t i = 0; i < MIDI_MAP_SRC_NUM; i++)
+    {
+        if (!midi_map_entry_valid(&map[i]))
+        {
+            SEGGER_RTT_printf(0, "[MAP] stored mapping invalid (src=%lu), using defaults\n", (unsigned long) i);
+            return false;
+        }
+    }
+    memcpy(s_map, map, sizeof(s_map));
+    memset(s_last, 0, sizeof(s_last));
+    s_gen++;
+    return true;
+}
+
+HAL_StatusTypeDef midi_map_save(I2C_HandleTypeDef* hi2c)
+{
+    EEPROM_MidiMap_t rec;
+
+    memcpy(rec.entry, s_map, sizeof(rec.entry));
+    return EEPROM_SaveMidiMap(hi2c, &rec);
+}
+
+// 次に動かした操作子を、次に受信した CC/ノートに割り当てる
+bool midi_map_learn_start(void)
+{
+    s_learn      = true;
+    s_learn_src  = MIDI_MAP_SRC_NONE;
+    s_learn_tick = HAL_GetTick();
+    SEGGER_RTT_printf(0, "[MAP] learn: move a control\n");
+    return true;
+}
+
+bool midi_map_learn_active(void)
+{
+    return s_learn;
+}
+
+void midi_map_learn_cancel(void)
+{
+    if (s_learn)
+    {
+        s_learn = false;
+        SEGGER_RTT_printf(0, "[MAP] learn: cancelled\n");
+    }
+}
+
+// 受信したチャンネルメッセージを learn に使ったら MIDI_MAP_LEARN_DONE
+uint8_t midi_map_learn_take(uint8_t status, uint8_t number)
+{
+    if (!s_learn || (s_learn_src == MIDI_MAP_SRC_NONE))
+    {
+        return MIDI_MAP_LEARN_NONE;
+    }
+
+    midi_map_entry_t e = s_map[s_learn_src];
+    switch (status & 0xF0U)
+    {
+    case 0xB0U:
+        e.type = MIDI_MAP_TYPE_CC;
+        break;
+    case 0x90U:
+        e.type = MIDI_MAP_TYPE_NOTE;
+        break;
+    default:
+        return MIDI_MAP_LEARN_NONE;
+    }
+    e.channel = status & 0x0FU;
+    e.number  = number & 0x7FU;
+    e.min     = 0;
+    e.max     = 127U;
+
+    (void) midi_map_set_entry(s_learn_src, &e);
+    SEGGER_RTT_printf(0, "[MAP] learn: src=%u -> %s ch%u #%u\n", (unsigned) s_learn_src, (e.type == MIDI_MAP_TYPE_CC) ? "CC" : "note",
+                      (unsigned) (e.channel + 1U), (unsigned) e.number);
+    s_learn = false;
+    return MIDI_MAP_LEARN_DONE;
+}
+
+uint8_t midi_map_learn_poll(void)
+{
+    if (s_learn && ((HAL_GetTick() - s_learn_tick) >= MIDI_MAP_LEARN_TIMEOUT_MS))
+    {
+        s_learn = false;
+        SEGGER_RTT_printf(0, "[MAP] learn: timed out\n");
+        return MIDI_MAP_LEARN_TIMEOUT;
+    }
+    return MIDI_MAP_LEARN_NONE;
+}
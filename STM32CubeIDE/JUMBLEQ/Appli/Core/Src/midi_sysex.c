@@ -0,0 +1,676 @@
+/*
+ * midi_sysex.c
+ *
+ *  Created on: Mar 12, 2026
+ */
+
+#include "midi_sysex.h"
+
+#include "app_version.h"
+#include "dsp_library.h"
+#include "eeprom.h"
+#include "i2c.h"
+#include "input_event.h"
+#include "led_control.h"
+#include "midi_map.h"
+#include "pot_filter.h"
+#include "ui_control.h"
+
+#include "tusb.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#define MIDI_SYSEX_ENTRY_LEN   10U
+#define MIDI_SYSEX_DSP_NAME    16U
+#define MIDI_SYSEX_CHUNK_HDR   3U  // <section> <index> <count>
+#define MIDI_SYSEX_CHUNK_MAX   (MIDI_SYSEX_CHUNK_HDR + MIDI_SYSEX_PACKED_LEN(MIDI_SYSEX_CHUNK_BYTES) + 1U)
+
+typedef void (*midi_sysex_handler_t)(const uint8_t* data, uint16_t len);
+
+typedef struct
+{
+    uint8_t cmd;
+    midi_sysex_handler_t handler;
+} midi_sysex_cmd_t;
+
+// ダンプ/リストアの作業領域 (section の中で一番大きいのは割り当て表)
+typedef union
+{
+    EEPROM_DeviceConfig_t cfg;
+    midi_map_entry_t map[MIDI_MAP_SRC_NUM];
+    uint8_t raw[MIDI_MAP_SRC_NUM * MIDI_SYSEX_ENTRY_LEN];
+} midi_sysex_section_t;
+
+_Static_assert(sizeof(midi_map_entry_t) == MIDI_SYSEX_ENTRY_LEN, "midi_map_entry_t layout");
+_Static_assert(sizeof(EEPROM_DeviceConfig_t) <= sizeof(((midi_sysex_section_t*) 0)->raw), "section buffer");
+_Static_assert(sizeof(EEPROM_DeviceConfig_t) <= 127U, "config field must fit in 7 bits");
+_Static_assert(MIDI_SYSEX_CHUNK_MAX <= (MIDI_SYSEX_BUF_SIZE - MIDI_SYSEX_HEADER_LEN), "chunk too large");
+
+// ダンプは 1 メッセージで全部送り切るが、リストアはチャンクの間に他のコマンドが来るので別の領域にする
+static midi_sysex_section_t s_dump;
+
+// リストアの受信状態。index 0 で始め、count 個揃ったら反映する
+static struct
+{
+    bool active;
+    uint8_t section;
+    uint8_t next;
+    uint8_t count;
+    uint16_t len;
+    midi_sysex_section_t buf;
+} s_restore;
+
+// EEPROM への保存は受け取った時には書かず、ui_control がフェーダーの窓待ち中に midi_sysex_flush_save で書く
+// (書いている間は adcTask が止まるので、カットの最中に待たせない)。ACK/NAK は書き終わってから返す
+static struct
+{
+    uint8_t cmd;                // 保存待ちのコマンド (0: なし)
+    uint8_t slot;               // PRESET_STORE / RESTORE_DATA のプリセット
+    EEPROM_DeviceConfig_t cfg;  // 受け取った時の設定
+} s_save;
+
+static void midi_sysex_send(uint8_t cmd, const uint8_t* data, uint16_t len)
+{
+    uint8_t msg[MIDI_SYSEX_BUF_SIZE + 2U];
+    const uint16_t n = midi_sysex_build(cmd, data, len, msg, sizeof(msg));
+
+    if (n != 0U)
+    {
+        tud_midi_stream_write(0, msg, n);
+    }
+}
+
+static void midi_sysex_ack(uint8_t cmd, bool ok)
+{
+    midi_sysex_send(ok ? MIDI_SYSEX_CMD_ACK : MIDI_SYSEX_CMD_NAK, &cmd, 1);
+}
+
+// 前の保存がまだ終わっていなければ false (NAK)
+static bool midi_sysex_queue_save(uint8_t cmd, uint8_t slot, const EEPROM_DeviceConfig_t* cfg)
+{
+    if (s_save.cmd != 0U)
+    {
+        return false;
+    }
+    s_save.cmd  = cmd;
+    s_save.slot = slot;
+    if (cfg != NULL)
+    {
+        s_save.cfg = *cfg;
+    }
+    return true;
+}
+
+static void midi_sysex_identity_reply(void)
+{
+    static const uint8_t version[4] = {APP_VERSION_MAJOR, APP_VERSION_MINOR, APP_VERSION_PATCH, 0};
+    uint8_t msg[16];
+    const uint16_t n = midi_sysex_build_identity_reply(version, msg, sizeof(msg));
+
+    if (n != 0U)
+    {
+        tud_midi_stream_write(0, msg, n);
+    }
+}
+
+// 14bit 値は MSB, LSB の順に 7bit ずつ
+static void midi_sysex_encode_entry(const midi_map_entry_t* e, uint8_t out[MIDI_SYSEX_ENTRY_LEN])
+{
+    out[0] = e->type;
+    out[1] = e->channel;
+    out[2] = e->curve;
+    out[3] = e->flags;
+    out[4] = (uint8_t) ((e->number >> 7) & 0x7FU);
+    out[5] = (uint8_t) (e->number & 0x7FU);
+    out[6] = (uint8_t) ((e->min >> 7) & 0x7FU);
+    out[7] = (uint8_t) (e->min & 0x7FU);
+    out[8] = (uint8_t) ((e->max >> 7) & 0x7FU);
+    out[9] = (uint8_t) (e->max & 0x7FU);
+}
+
+static void midi_sysex_decode_entry(const uint8_t in[MIDI_SYSEX_ENTRY_LEN], midi_map_entry_t* e)
+{
+    e->type    = in[0];
+    e->channel = in[1];
+    e->curve   = in[2];
+    e->flags   = in[3];
+    e->number  = (uint16_t) ((in[4] << 7) | in[5]);
+    e->min     = (uint16_t) ((in[6] << 7) | in[7]);
+    e->max     = (uint16_t) ((in[8] << 7) | in[9]);
+}
+
+static void midi_sysex_version_get(const uint8_t* data, uint16_t len)
+{
+    uint8_t reply[7U + MIDI_SYSEX_DSP_NAME] = {0};
+    const uint8_t slot = dsp_library_active_slot();
+
+    (void) data;
+    (void) len;
+
+    reply[0] = MIDI_SYSEX_PROTOCOL_VERSION;
+    reply[1] = APP_VERSION_MAJOR;
+    reply[2] = APP_VERSION_MINOR;
+    reply[3] = APP_VERSION_PATCH;
+    reply[4] = (uint8_t) ((EEPROM_CONFIG_VERSION >> 7) & 0x7FU);
+    reply[5] = (uint8_t) (EEPROM_CONFIG_VERSION & 0x7FU);
+    reply[6] = (slot == DSP_LIBRARY_SLOT_BUILTIN) ? 0x7FU : slot;
+
+    const dsp_image_header_t* img = dsp_library_get_image(slot);
+    const char* name              = (img != NULL) ? img->name : "builtin";
+    for (uint32_t i = 0; (i < MIDI_SYSEX_DSP_NAME) && (name[i] != '\0'); i++)
+    {
+        reply[7U + i] = (uint8_t) name[i] & 0x7FU;
+    }
+    midi_sysex_send(MIDI_SYSEX_CMD_VERSION_REPLY, reply, sizeof(reply));
+}
+
+static void midi_sysex_map_get(const uint8_t* data, uint16_t len)
+{
+    midi_map_entry_t e;
+    uint8_t reply[1U + MIDI_SYSEX_ENTRY_LEN];
+
+    if ((len != 1U) || !midi_map_get_entry(data[0], &e))
+    {
+        midi_sysex_ack(MIDI_SYSEX_CMD_MAP_GET, false);
+        return;
+    }
+    reply[0] = data[0];
+    midi_sysex_encode_entry(&e, &reply[1]);
+    midi_sysex_send(MIDI_SYSEX_CMD_MAP_REPLY, reply, sizeof(reply));
+}
+
+static void midi_sysex_map_set(const uint8_t* data, uint16_t len)
+{
+    midi_map_entry_t e;
+
+    if (len != (1U + MIDI_SYSEX_ENTRY_LEN))
+    {
+        midi_sysex_ack(MIDI_SYSEX_CMD_MAP_SET, false);
+        return;
+    }
+    midi_sysex_decode_entry(&data[1], &e);
+    midi_sysex_ack(MIDI_SYSEX_CMD_MAP_SET, midi_map_set_entry(data[0], &e));
+}
+
+static void midi_sysex_map_save(const uint8_t* data, uint16_t len)
+{
+    (void) data;
+    (void) len;
+    if (!midi_sysex_queue_save(MIDI_SYSEX_CMD_MAP_SAVE, 0U, NULL))
+    {
+        midi_sysex_ack(MIDI_SYSEX_CMD_MAP_SAVE, false);
+    }
+}
+
+static void midi_sysex_map_defaults(const uint8_t* data, uint16_t len)
+{
+    (void) data;
+    (void) len;
+    midi_map_set_defaults();
+    midi_sysex_ack(MIDI_SYSEX_CMD_MAP_DEFAULTS, true);
+}
+
+static bool midi_sysex_cfg_field_valid(uint8_t field)
+{
+    return (field < sizeof(EEPROM_DeviceConfig_t)) && (field != offsetof(EEPROM_DeviceConfig_t, reserved));
+}
+
+static void midi_sysex_cfg_get(const uint8_t* data, uint16_t len)
+{
+    EEPROM_DeviceConfig_t cfg;
+    uint8_t reply[3];
+
+    if ((len != 1U) || !midi_sysex_cfg_field_valid(data[0]))
+    {
+        midi_sysex_ack(MIDI_SYSEX_CMD_CFG_GET, false);
+        return;
+    }
+    EEPROM_ConfigCaptureCurrent(&cfg);
+    const uint8_t value = ((const uint8_t*) &cfg)[data[0]];
+    reply[0] = data[0];
+    reply[1] = (uint8_t) (value >> 7);
+    reply[2] = (uint8_t) (value & 0x7FU);
+    midi_sysex_send(MIDI_SYSEX_CMD_CFG_REPLY, reply, sizeof(reply));
+}
+
+// 1 フィールドだけ差し替えて全体を反映する (範囲外の値は ui_control_apply_persist_state が弾く)
+static void midi_sysex_cfg_set(const uint8_t* data, uint16_t len)
+{
+    EEPROM_DeviceConfig_t cfg;
+
+    if ((len != 3U) || !midi_sysex_cfg_field_valid(data[0]) || (data[1] > 1U))
+    {
+        midi_sysex_ack(MIDI_SYSEX_CMD_CFG_SET, false);
+        return;
+    }
+    EEPROM_ConfigCaptureCurrent(&cfg);
+    ((uint8_t*) &cfg)[data[0]] = (uint8_t) ((data[1] << 7) | data[2]);
+    midi_sysex_ack(MIDI_SYSEX_CMD_CFG_SET, EEPROM_ConfigApply(&cfg));
+}
+
+static void midi_sysex_cfg_save(const uint8_t* data, uint16_t len)
+{
+    EEPROM_DeviceConfig_t cfg;
+
+    (void) data;
+    (void) len;
+    EEPROM_ConfigCaptureCurrent(&cfg);
+    if (!midi_sysex_queue_save(MIDI_SYSEX_CMD_CFG_SAVE, 0U, &cfg))
+    {
+        midi_sysex_ack(MIDI_SYSEX_CMD_CFG_SAVE, false);
+    }
+}
+
+static uint16_t midi_sysex_section_size(uint8_t section)
+{
+    if (section == MIDI_SYSEX_SECTION_MIDI_MAP)
+    {
+        return (uint16_t) sizeof(((midi_sysex_section_t*) 0)->map);
+    }
+    if ((section == MIDI_SYSEX_SECTION_CONFIG) ||
+        ((section >= MIDI_SYSEX_SECTION_PRESET) && (section < (MIDI_SYSEX_SECTION_PRESET + EEPROM_PRESET_NUM))))
+    {
+        return (uint16_t) sizeof(EEPROM_DeviceConfig_t);
+    }
+    return 0;
+}
+
+static bool midi_sysex_section_read(uint8_t section, midi_sysex_section_t* s)
+{
+    switch (section)
+    {
+    case MIDI_SYSEX_SECTION_CONFIG:
+        EEPROM_ConfigCaptureCurrent(&s->cfg);
+        return true;
+    case MIDI_SYSEX_SECTION_MIDI_MAP:
+        for (uint8_t src = 0; src < MIDI_MAP_SRC_NUM; src++)
+        {
+            (void) midi_map_get_entry(src, &s->map[src]);
+        }
+        return true;
+    default:
+        return EEPROM_LoadPreset(&hi2c2, (uint8_t) (section - MIDI_SYSEX_SECTION_PRESET), &s->cfg) == HAL_OK;
+    }
+}
+
+// 割り当て表は1つでも不正なら元に戻す。プリセットは保存待ちにする
+static bool midi_sysex_section_write(uint8_t section, const midi_sysex_section_t* s)
+{
+    switch (section)
+    {
+    case MIDI_SYSEX_SECTION_CONFIG:
+        return EEPROM_ConfigApply(&s->cfg);
+    case MIDI_SYSEX_SECTION_MIDI_MAP:
+    {
+        midi_map_entry_t old[MIDI_MAP_SRC_NUM];
+
+        for (uint8_t src = 0; src < MIDI_MAP_SRC_NUM; src++)
+        {
+            (void) midi_map_get_entry(src, &old[src]);
+        }
+        for (uint8_t src = 0; src < MIDI_MAP_SRC_NUM; src++)
+        {
+            if (!midi_map_set_entry(src, &s->map[src]))
+            {
+                for (uint8_t k = 0; k < src; k++)
+                {
+                    (void) midi_map_set_entry(k, &old[k]);
+                }
+                return false;
+            }
+        }
+        return true;
+    }
+    default:
+        return midi_sysex_queue_save(MIDI_SYSEX_CMD_RESTORE_DATA, (uint8_t) (section - MIDI_SYSEX_SECTION_PRESET), &s->cfg);
+    }
+}
+
+static void midi_sysex_dump_get(const uint8_t* data, uint16_t len)
+{
+    uint8_t chunk[MIDI_SYSEX_CHUNK_MAX];
+
+    const uint16_t size = (len == 1U) ? midi_sysex_section_size(data[0]) : 0U;
+    if ((size == 0U) || !midi_sysex_section_read(data[0], &s_dump))
+    {
+        midi_sysex_ack(MIDI_SYSEX_CMD_DUMP_GET, false);
+        return;
+    }
+
+    const uint8_t count = (uint8_t) ((size + MIDI_SYSEX_CHUNK_BYTES - 1U) / MIDI_SYSEX_CHUNK_BYTES);
+    for (uint8_t index = 0; index < count; index++)
+    {
+        const uint16_t offset = (uint16_t) (index * MIDI_SYSEX_CHUNK_BYTES);
+        const uint16_t remain = (uint16_t) (size - offset);
+        const uint16_t n      = (remain < MIDI_SYSEX_CHUNK_BYTES) ? remain : (uint16_t) MIDI_SYSEX_CHUNK_BYTES;
+        uint16_t packed;
+
+        chunk[0] = data[0];
+        chunk[1] = index;
+        chunk[2] = count;
+        (void) midi_sysex_pack(&s_dump.raw[offset], n, &chunk[MIDI_SYSEX_CHUNK_HDR], MIDI_SYSEX_PACKED_LEN(MIDI_SYSEX_CHUNK_BYTES), &packed);
+        packed = (uint16_t) (packed + MIDI_SYSEX_CHUNK_HDR);
+        chunk[packed] = midi_sysex_checksum(chunk, packed);
+        midi_sysex_send(MIDI_SYSEX_CMD_DUMP_DATA, chunk, (uint16_t) (packed + 1U));
+    }
+}
+
+static bool midi_sysex_restore_chunk(const uint8_t* data, uint16_t len)
+{
+    if ((len < (MIDI_SYSEX_CHUNK_HDR + 1U)) || (midi_sysex_checksum(data, (uint16_t) (len - 1U)) != data[len - 1U]))
+    {
+        return false;
+    }
+
+    const uint8_t section = data[0];
+    const uint8_t index   = data[1];
+    const uint8_t count   = data[2];
+    const uint16_t size   = midi_sysex_section_size(section);
+
+    if ((size == 0U) || (count != (uint8_t) ((size + MIDI_SYSEX_CHUNK_BYTES - 1U) / MIDI_SYSEX_CHUNK_BYTES)))
+    {
+        return false;
+    }
+    if (index == 0U)
+    {
+        s_restore.active  = true;
+        s_restore.section = section;
+        s_restore.next    = 0;
+        s_restore.count   = count;
+        s_restore.len     = 0;
+    }
+    if (!s_restore.active || (section != s_restore.section) || (index != s_restore.next))
+    {
+        return false;
+    }
+
+    uint16_t n;
+    if (!midi_sysex_unpack(&data[MIDI_SYSEX_CHUNK_HDR], (uint16_t) (len - MIDI_SYSEX_CHUNK_HDR - 1U), &s_restore.buf.raw[s_restore.len],
+                           (uint16_t) (size - s_restore.len), &n))
+    {
+        return false;
+    }
+    // 最後以外は MIDI_SYSEX_CHUNK_BYTES ちょうど
+    if (((index + 1U) < count) ? (n != MIDI_SYSEX_CHUNK_BYTES) : ((s_restore.len + n) != size))
+    {
+        return false;
+    }
+    s_restore.len = (uint16_t) (s_restore.len + n);
+    s_restore.next++;
+
+    if (s_restore.next < count)
+    {
+        return true;
+    }
+    s_restore.active = false;
+    return midi_sysex_section_write(section, &s_restore.buf);
+}
+
+// 最後のチャンクでプリセットへの保存待ちになったら、ACK は書き終わってから
+static void midi_sysex_restore_data(const uint8_t* data, uint16_t len)
+{
+    const bool was_pending = (s_save.cmd != 0U);
+    const bool ok          = midi_sysex_restore_chunk(data, len);
+
+    if (!ok)
+    {
+        s_restore.active = false;
+    }
+    if (ok && !was_pending && (s_save.cmd != 0U))
+    {
+        return;
+    }
+    midi_sysex_ack(MIDI_SYSEX_CMD_RESTORE_DATA, ok);
+}
+
+static void midi_sysex_preset_store(const uint8_t* data, uint16_t len)
+{
+    EEPROM_DeviceConfig_t cfg;
+
+    if ((len != 1U) || (data[0] >= EEPROM_PRESET_NUM))
+    {
+        midi_sysex_ack(MIDI_SYSEX_CMD_PRESET_STORE, false);
+        return;
+    }
+    EEPROM_ConfigCaptureCurrent(&cfg);
+    if (!midi_sysex_queue_save(MIDI_SYSEX_CMD_PRESET_STORE, data[0], &cfg))
+    {
+        midi_sysex_ack(MIDI_SYSEX_CMD_PRESET_STORE, false);
+    }
+}
+
+static void midi_sysex_preset_recall(const uint8_t* data, uint16_t len)
+{
+    EEPROM_DeviceConfig_t cfg;
+
+    if ((len != 1U) || (EEPROM_LoadPreset(&hi2c2, data[0], &cfg) != HAL_OK))
+    {
+        midi_sysex_ack(MIDI_SYSEX_CMD_PRESET_RECALL, false);
+        return;
+    }
+    midi_sysex_ack(MIDI_SYSEX_CMD_PRESET_RECALL, EEPROM_ConfigApply(&cfg));
+}
+
+static void midi_sysex_param_get(const uint8_t* data, uint16_t len)
+{
+    uint16_t value;
+    uint8_t reply[3];
+
+    if ((len != 1U) || !ui_control_get_dsp_param(data[0], &value))
+    {
+        midi_sysex_ack(MIDI_SYSEX_CMD_PARAM_GET, false);
+        return;
+    }
+    reply[0] = data[0];
+    reply[1] = (uint8_t) ((value >> 7) & 0x7FU);
+    reply[2] = (uint8_t) (value & 0x7FU);
+    midi_sysex_send(MIDI_SYSEX_CMD_PARAM_REPLY, reply, sizeof(reply));
+}
+
+static void midi_sysex_param_set(const uint8_t* data, uint16_t len)
+{
+    const bool ok = (len == 3U) && ui_control_host_set_dsp_param(data[0], (uint16_t) ((data[1] << 7) | data[2]));
+    midi_sysex_ack(MIDI_SYSEX_CMD_PARAM_SET, ok);
+}
+
+static bool midi_sysex_tune_read(uint8_t tune, uint16_t* value)
+{
+    pot_filter_params_t pf;
+    input_event_timing_t it;
+
+    pot_filter_get_params(&pf);
+    input_event_get_timing(&it);
+    switch (tune)
+    {
+    case MIDI_SYSEX_TUNE_POT_MIN_CUTOFF:
+        *value = pf.min_cutoff_q8;
+        return true;
+    case MIDI_SYSEX_TUNE_POT_MAX_CUTOFF:
+        *value = pf.max_cutoff_q8;
+        return true;
+    case MIDI_SYSEX_TUNE_POT_BETA:
+        *value = pf.beta_q16;
+        return true;
+    case MIDI_SYSEX_TUNE_POT_D_CUTOFF:
+        *value = pf.d_cutoff_q8;
+        return true;
+    case MIDI_SYSEX_TUNE_POT_HYST:
+        *value = pf.hyst_q8;
+        return true;
+    case MIDI_SYSEX_TUNE_INPUT_DEBOUNCE:
+        *value = it.debounce_ms;
+        return true;
+    case MIDI_SYSEX_TUNE_INPUT_LONG:
+        *value = it.long_ms;
+        return true;
+    case MIDI_SYSEX_TUNE_INPUT_DOUBLE:
+        *value = it.double_ms;
+        return true;
+    case MIDI_SYSEX_TUNE_INPUT_CHORD:
+        *value = it.chord_ms;
+        return true;
+    case MIDI_SYSEX_TUNE_INPUT_CUT:
+        *value = it.cut_ms;
+        return true;
+    default:
+        return false;
+    }
+}
+
+// ボタン/フェーダーの時間も同じく全体を渡す (組み合わせの不正は input_event_set_timing が弾く)
+static bool midi_sysex_tune_write_input(uint8_t tune, uint16_t value)
+{
+    input_event_timing_t it;
+
+    input_event_get_timing(&it);
+    switch (tune)
+    {
+    case MIDI_SYSEX_TUNE_INPUT_DEBOUNCE:
+        it.debounce_ms = value;
+        break;
+    case MIDI_SYSEX_TUNE_INPUT_LONG:
+        it.long_ms = value;
+        break;
+    case MIDI_SYSEX_TUNE_INPUT_DOUBLE:
+        it.double_ms = value;
+        break;
+    case MIDI_SYSEX_TUNE_INPUT_CHORD:
+        it.chord_ms = value;
+        break;
+    case MIDI_SYSEX_TUNE_INPUT_CUT:
+        it.cut_ms = value;
+        break;
+    default:
+        return false;
+    }
+    return input_event_set_timing(&it);
+}
+
+// 1 つだけ差し替えて全体を渡す (範囲外や組み合わせの不正は pot_filter_set_params が弾く)
+static bool midi_sysex_tune_write(uint8_t tune, uint16_t value)
+{
+    pot_filter_params_t pf;
+
+    pot_filter_get_params(&pf);
+    switch (tune)
+    {
+    case MIDI_SYSEX_TUNE_POT_MIN_CUTOFF:
+        pf.min_cutoff_q8 = value;
+        break;
+    case MIDI_SYSEX_TUNE_POT_MAX_CUTOFF:
+        pf.max_cutoff_q8 = value;
+        break;
+    case MIDI_SYSEX_TUNE_POT_BETA:
+        pf.beta_q16 = value;
+        break;
+    case MIDI_SYSEX_TUNE_POT_D_CUTOFF:
+        pf.d_cutoff_q8 = value;
+        break;
+    case MIDI_SYSEX_TUNE_POT_HYST:
+        if (value > UINT8_MAX)
+        {
+            return false;
+        }
+        pf.hyst_q8 = (uint8_t) value;
+        break;
+    default:
+        return midi_sysex_tune_write_input(tune, value);
+    }
+    return pot_filter_set_params(&pf);
+}
+
+static void midi_sysex_tune_get(const uint8_t* data, uint16_t len)
+{
+    uint16_t value;
+    uint8_t reply[3];
+
+    if ((len != 1U) || !midi_sysex_tune_read(data[0], &value))
+    {
+        midi_sysex_ack(MIDI_SYSEX_CMD_TUNE_GET, false);
+        return;
+    }
+    reply[0] = data[0];
+    reply[1] = (uint8_t) ((value >> 7) & 0x7FU);
+    reply[2] = (uint8_t) (value & 0x7FU);
+    midi_sysex_send(MIDI_SYSEX_CMD_TUNE_REPLY, reply, sizeof(reply));
+}
+
+static void midi_sysex_tune_set(const uint8_t* data, uint16_t len)
+{
+    const bool ok = (len == 3U) && midi_sysex_tune_write(data[0], (uint16_t) ((data[1] << 7) | data[2]));
+    midi_sysex_ack(MIDI_SYSEX_CMD_TUNE_SET, ok);
+}
+
+// 保存待ちがあれば EEPROM に書いて ACK/NAK を返す (adcTask から、フェーダーの窓待ち中に呼ぶ)
+void midi_sysex_flush_save(void)
+{
+    const uint8_t cmd = s_save.cmd;
+    HAL_StatusTypeDef st;
+
+    switch (cmd)
+    {
+    case 0U:
+        return;
+    case MIDI_SYSEX_CMD_MAP_SAVE:
+        st = midi_map_save(&hi2c2);
+        break;
+    case MIDI_SYSEX_CMD_CFG_SAVE:
+        st = EEPROM_SaveConfig(&hi2c2, &s_save.cfg);
+        break;
+    default:
+        st = EEPROM_SavePreset(&hi2c2, s_save.slot, &s_save.cfg);
+        break;
+    }
+    s_save.cmd = 0U;
+
+    if ((st == HAL_OK) && (cmd == MIDI_SYSEX_CMD_CFG_SAVE))
+    {
+        led_notify_save_success();
+    }
+    midi_sysex_ack(cmd, st == HAL_OK);
+}
+
+// msg は F0/F7 を除いた中身
+void midi_sysex_handle(const uint8_t* msg, uint16_t len)
+{
+    static const midi_sysex_cmd_t commands[] = {
+        {MIDI_SYSEX_CMD_VERSION_GET,   midi_sysex_version_get  },
+        {MIDI_SYSEX_CMD_MAP_GET,       midi_sysex_map_get      },
+        {MIDI_SYSEX_CMD_MAP_SET,       midi_sysex_map_set      },
+        {MIDI_SYSEX_CMD_MAP_SAVE,      midi_sysex_map_save     },
+        {MIDI_SYSEX_CMD_MAP_DEFAULTS,  midi_sysex_map_defaults },
+        {MIDI_SYSEX_CMD_CFG_GET,       midi_sysex_cfg_get      },
+        {MIDI_SYSEX_CMD_CFG_SET,       midi_sysex_cfg_set      },
+        {MIDI_SYSEX_CMD_CFG_SAVE,      midi_sysex_cfg_save     },
+        {MIDI_SYSEX_CMD_DUMP_GET,      midi_sysex_dump_get     },
+        {MIDI_SYSEX_CMD_RESTORE_DATA,  midi_sysex_restore_data },
+        {MIDI_SYSEX_CMD_PRESET_STORE,  midi_sysex_preset_store },
+        {MIDI_SYSEX_CMD_PRESET_RECALL, midi_sysex_preset_recall},
+        {MIDI_SYSEX_CMD_PARAM_GET,     midi_sysex_param_get    },
+        {MIDI_SYSEX_CMD_PARAM_SET,     midi_sysex_param_set    },
+        {MIDI_SYSEX_CMD_TUNE_GET,      midi_sysex_tune_get     },
+        {MIDI_SYSEX_CMD_TUNE_SET,      midi_sysex_tune_set     },
+    };
+    midi_sysex_msg_t m;
+
+    if (midi_sysex_is_identity_request(msg, len))
+    {
+        midi_sysex_identity_reply();
+        return;
+    }
+    if (!midi_sysex_parse(msg, len, &m))
+    {
+        return;
+    }
+
+    for (uint32_t i = 0; i < TU_ARRAY_SIZE(commands); i++)
+    {
+        if (commands[i].cmd == m.cmd)
+        {
+            commands[i].handler(m.data, m.len);
+            return;
+        }
+    }
+    midi_sysex_ack(m.cmd, false);
+}
@@ -0,0 +1,253 @@
+/*
+ * midi_sysex_codec.c
+ *
+ *  Created on: Mar 13, 2026
+ */
+
+#include "midi_sysex_codec.h"
+
+#include <stddef.h>
+
+// ユニバーサル非リアルタイム (7E) の General Information / Identity
+#define MIDI_SYSEX_UNIVERSAL_NRT   0x7EU
+#define MIDI_SYSEX_ALL_CALL        0x7FU
+#define MIDI_SYSEX_GENERAL_INFO    0x06U
+#define MIDI_SYSEX_IDENTITY_REQ    0x01U
+#define MIDI_SYSEX_IDENTITY_REPLY  0x02U
+#define MIDI_SYSEX_IDENTITY_LEN    15U
+#define MIDI_SYSEX_FAMILY          MIDI_SYSEX_DEVICE  // ファミリーコード (LSB, MSB = 0)
+#define MIDI_SYSEX_MODEL           0x01U
+
+void midi_sysex_reset(midi_sysex_rx_t* rx)
+{
+    rx->len      = 0;
+    rx->active   = false;
+    rx->overflow = false;
+}
+
+// 1 byte ずつ組み立てる。F7 まで揃ったら true (rx->buf/len が F0/F7 を除いた中身)
+bool midi_sysex_feed_byte(midi_sysex_rx_t* rx, uint8_t b)
+{
+    if (b == 0xF0U)
+    {
+        rx->len      = 0;
+        rx->active   = true;
+        rx->overflow = false;
+        return false;
+    }
+    if (!rx->active)
+    {
+        return false;
+    }
+    if (b == 0xF7U)
+    {
+        rx->active = false;
+        return !rx->overflow;
+    }
+    if (b >= 0xF8U)
+    {
+        // リアルタイムメッセージは SysEx の途中に割り込んでよい
+        return false;
+    }
+    if ((b & 0x80U) != 0U)
+    {
+        // SysEx の途中にステータスバイトが来たら破棄
+        midi_sysex_reset(rx);
+        return false;
+    }
+    if (rx->len >= MIDI_SYSEX_BUF_SIZE)
+    {
+        rx->overflow = true;
+        return false;
+    }
+    rx->buf[rx->len++] = b;
+    return false;
+}
+
+// USB-MIDI のイベントパケット (CIN 0x4-0x7) を組み立てる。F7 まで揃ったら true
+bool midi_sysex_feed_packet(midi_sysex_rx_t* rx, const uint8_t packet[4])
+{
+    uint8_t n;
+
+    switch (packet[0] & 0x0FU)
+    {
+    case 0x4:
+    case 0x7:
+        n = 3;
+        break;
+    case 0x6:
+        n = 2;
+        break;
+    case 0x5:
+        n = 1;
+        break;
+    default:
+        return false;
+    }
+
+    bool complete = false;
+    for (uint8_t i = 0; i < n; i++)
+    {
+        if (midi_sysex_feed_byte(rx, packet[1U + i]))
+        {
+            complete = true;
+        }
+    }
+    return complete;
+}
+
+// body は F0/F7 を除いた中身。JUMBLEQ 宛てでなければ false
+bool midi_sysex_parse(const uint8_t* body, uint16_t len, midi_sysex_msg_t* msg)
+{
+    if ((body == NULL) || (msg == NULL) || (len < MIDI_SYSEX_HEADER_LEN) || (len > MIDI_SYSEX_BUF_SIZE))
+    {
+        return false;
+    }
+    if ((body[0] != MIDI_SYSEX_MANUFACTURER) || (body[1] != MIDI_SYSEX_DEVICE) || ((body[2] & 0x80U) != 0U))
+    {
+        return false;
+    }
+
+    msg->cmd  = body[2];
+    msg->data = &body[MIDI_SYSEX_HEADER_LEN];
+    msg->len  = (uint16_t) (len - MIDI_SYSEX_HEADER_LEN);
+    return true;
+}
+
+// F0 7D 4A <cmd> <data> F7 を out に作って長さを返す。入らなければ 0
+uint16_t midi_sysex_build(uint8_t cmd, const uint8_t* data, uint16_t len, uint8_t* out, uint16_t cap)
+{
+    uint16_t n = 0;
+
+    if ((out == NULL) || ((data == NULL) && (len != 0U)) || (len > (MIDI_SYSEX_BUF_SIZE - MIDI_SYSEX_HEADER_LEN)) ||
+        ((uint32_t) cap < ((uint32_t) len + MIDI_SYSEX_HEADER_LEN + 2U)))
+    {
+        return 0;
+    }
+
+    out[n++] = 0xF0U;
+    out[n++] = MIDI_SYSEX_MANUFACTURER;
+    out[n++] = MIDI_SYSEX_DEVICE;
+    out[n++] = cmd & 0x7FU;
+    for (uint16_t i = 0; i < len; i++)
+    {
+        out[n++] = data[i] & 0x7FU;
+    }
+    out[n++] = 0xF7U;
+    return n;
+}
+
+// 7 byte 毎に、各 byte の MSB を集めた 1 byte (bit i = i 番目) を先頭に置き、残りは下位 7bit
+bool midi_sysex_pack(const uint8_t* in, uint16_t len, uint8_t* out, uint16_t cap, uint16_t* out_len)
+{
+    uint16_t n = 0;
+
+    if ((out_len == NULL) || ((in == NULL) && (len != 0U)) || ((out == NULL) && (len != 0U)) ||
+        ((uint32_t) MIDI_SYSEX_PACKED_LEN((uint32_t) len) > cap))
+    {
+        return false;
+    }
+
+    for (uint16_t i = 0; i < len; i += 7U)
+    {
+        const uint16_t group = ((uint16_t) (len - i) < 7U) ? (uint16_t) (len - i) : 7U;
+        uint8_t msb          = 0;
+
+        for (uint16_t k = 0; k < group; k++)
+        {
+            msb |= (uint8_t) ((in[i + k] >> 7) << k);
+        }
+        out[n++] = msb;
+        for (uint16_t k = 0; k < group; k++)
+        {
+            out[n++] = in[i + k] & 0x7FU;
+        }
+    }
+    *out_len = n;
+    return true;
+}
+
+// midi_sysex_pack の逆。7bit を超える byte、中身の無いグループ、使っていない MSB ビットが立っていたら false
+bool midi_sysex_unpack(const uint8_t* in, uint16_t len, uint8_t* out, uint16_t cap, uint16_t* out_len)
+{
+    uint16_t n = 0;
+    uint16_t i = 0;
+
+    if ((out_len == NULL) || ((in == NULL) && (len != 0U)))
+    {
+        return false;
+    }
+
+    while (i < len)
+    {
+        const uint8_t msb    = in[i++];
+        const uint16_t group = ((uint16_t) (len - i) < 7U) ? (uint16_t) (len - i) : 7U;
+
+        if ((group == 0U) || ((msb & 0x80U) != 0U) || ((msb >> group) != 0U))
+        {
+            return false;
+        }
+        if (((uint32_t) n + group) > cap)
+        {
+            return false;
+        }
+        for (uint16_t k = 0; k < group; k++)
+        {
+            const uint8_t b = in[i++];
+            if ((b & 0x80U) != 0U)
+            {
+                return false;
+            }
+            out[n++] = (uint8_t) (b | (((msb >> k) & 1U) << 7));
+        }
+    }
+    *out_len = n;
+    return true;
+}
+
+// data と足して下位 7bit が 0 になる値
+uint8_t midi_sysex_checksum(const uint8_t* data, uint16_t len)
+{
+    uint8_t sum = 0;
+
+    for (uint16_t i = 0; i < len; i++)
+    {
+        sum = (uint8_t) (sum + data[i]);
+    }
+    return (uint8_t) ((0x80U - (sum & 0x7FU)) & 0x7FU);
+}
+
+// F0 7E <id> 06 01 F7 (id は任意、7F = 全体)
+bool midi_sysex_is_identity_request(const uint8_t* body, uint16_t len)
+{
+    return (body != NULL) && (len == 4U) && (body[0] == MIDI_SYSEX_UNIVERSAL_NRT) && (body[2] == MIDI_SYSEX_GENERAL_INFO) &&
+           (body[3] == MIDI_SYSEX_IDENTITY_REQ);
+}
+
+// F0 7E 7F 06 02 <mfr> <family 2> <model 2> <version 4> F7
+uint16_t midi_sysex_build_identity_reply(const uint8_t version[4], uint8_t* out, uint16_t cap)
+{
+    uint16_t n = 0;
+
+    if ((version == NULL) || (out == NULL) || (cap < MIDI_SYSEX_IDENTITY_LEN))
+    {
+        return 0;
+    }
+
+    out[n++] = 0xF0U;
+    out[n++] = MIDI_SYSEX_UNIVERSAL_NRT;
+    out[n++] = MIDI_SYSEX_ALL_CALL;
+    out[n++] = MIDI_SYSEX_GENERAL_INFO;
+    out[n++] = MIDI_SYSEX_IDENTITY_REPLY;
+    out[n++] = MIDI_SYSEX_MANUFACTURER;
+    out[n++] = MIDI_SYSEX_FAMILY;
+    out[n++] = 0x00U;
+    out[n++] = MIDI_SYSEX_MODEL;
+    out[n++] = 0x00U;
+    for (uint8_t i = 0; i < 4U; i++)
+    {
+        out[n++] = version[i] & 0x7FU;
+    }
+    out[n++] = 0xF7U;
+    return n;
+}
@@ -5,116 +5,411 @@
  *      Author: Shnichi Yamamoto
  */
 
-#include "main_oled.h"
-#include "sub_oled.h"
 #include "oled_control.h"
 #include "app_version.h"
 
 #include "audio_control.h"
+#include "audio_spectrum.h"
+#include "dsp_readback.h"
+#include "eeprom.h"
+#include "i2c.h"
+#include "midi_map.h"
+#include "oled_i2c.h"
+#include "oled_menu.h"
+#include "oled_sched.h"
+#include "oled_widget.h"
 #include "ssd1306_fonts.h"
+#include "ui_control.h"
 #include "cmsis_os2.h"
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <string.h>
 
-static void merge_dirty_pages(bool* dirty, uint8_t* dirty_start_page, uint8_t* dirty_end_page, uint8_t page_start, uint8_t page_end)
+// 領域ごとの描き直し (oled_sched)。値は読める速さまで間引き、1 フレームの転送量を予算で抑える
+#define OLED_SCHED_LOG        0     // 1秒毎にフレーム数、描いた/まとめた/先送りした回数、転送量の見積もりを RTT に出す
+#define OLED_SCHED_BUDGET     600U  // 1 フレーム (OLED_UpdateTask 1 回) の転送量の上限 [byte]
+#define OLED_VALUE_PERIOD_MS  100U  // ゲインなどの数値は 10fps まで
+#define OLED_MENU_PERIOD_MS   40U
+#define OLED_TEXT_LEN         32U
+
+// サブ OLED のメーター画面 (SW2 ダブルで切り替え)
+#define OLED_WIDGET_PERIOD_MS   33U  // 30fps
+#define OLED_SPECTRUM_PERIOD_MS 50U  // FFT もこの間隔
+#define OLED_METER_FLOOR_DB     -60.0f
+#define OLED_SPECTRUM_FLOOR_DB  -72.0f
+#define OLED_SPECTRUM_BANDS     32U
+#define OLED_SPECTRUM_F_LO      40.0f
+#define OLED_SPECTRUM_F_HI      20000.0f
+
+#define OLED_MENU_KEY_QUEUE 8U  // 2 の累乗
+
+// 焼き付き防止と省電力 (操作/MIDI が無い時間で段階的に)
+#define OLED_POWER_LOG        0
+#define OLED_WAKE_THREAD_FLAG 0x0002U  // oled_i2c の完了通知 (0x0001) と別のビット
+#define OLED_SHIFT_PERIOD_MS  (60U * 1000U)
+#define OLED_SLEEP_MS         (20U * 60U * 1000U)
+
+enum
 {
-    if (!*dirty)
-    {
-        *dirty            = true;
-        *dirty_start_page = page_start;
-        *dirty_end_page   = page_end;
-        return;
-    }
+    OLED_SUB_VIEW_ROUTING = 0,
+    OLED_SUB_VIEW_METERS,
+    OLED_SUB_VIEW_MENU,
+    OLED_SUB_VIEW_NUM,
+};
+
+enum
+{
+    OLED_MENU_ACTION_SAVE = 0,
+    OLED_MENU_ACTION_REVERT,
+};
+
+typedef struct
+{
+    uint32_t idle_ms;
+    uint8_t contrast;
+} oled_dim_stage_t;
 
-    if (*dirty_start_page > page_start)
+static const oled_dim_stage_t s_dim_stages[] = {
+    {0U, 0xFFU},
+    {2U * 60U * 1000U, 0x60U},
+    {10U * 60U * 1000U, 0x10U},
+};
+
+// 表示全体を 1px の四角に沿って回す (右/下へのずらし量)
+static const uint8_t s_shift_orbit[][2] = {{0, 0}, {1, 0}, {1, 1}, {0, 1}};
+
+// 描き直す単位。文字列の領域は範囲を消して cursor の位置に Font_7x10 で書く
+enum
+{
+    OLED_RGN_CH2 = 0,
+    OLED_RGN_MST,
+    OLED_RGN_C1,
+    OLED_RGN_DW,
+    OLED_RGN_X3,
+    OLED_RGN_X2,
+    OLED_RGN_SRC_A,
+    OLED_RGN_SRC_B,
+    OLED_RGN_TYPE_A,
+    OLED_RGN_TYPE_B,
+    OLED_RGN_SRC_P,
+    OLED_RGN_DVS_A,
+    OLED_RGN_DVS_B,
+    OLED_RGN_TEXT_NUM,  // ここまで文字列
+    OLED_RGN_METERS = OLED_RGN_TEXT_NUM,
+    OLED_RGN_GRAPHS,
+    OLED_RGN_SPECTRUM,
+    OLED_RGN_MENU,
+    OLED_RGN_NUM,
+    OLED_RGN_SUB_FIRST = OLED_RGN_SRC_A,  // ここから後ろはサブ OLED
+};
+
+typedef struct
+{
+    ssd1306_t* oled;
+    oled_sched_region_def_t area;
+    uint8_t cursor_x;
+    uint8_t cursor_y;
+} oled_region_t;
+
+static const oled_region_t s_regions[OLED_RGN_NUM] = {
+    [OLED_RGN_CH2]      = {&oled_main, {0, 0, 63, 10, OLED_VALUE_PERIOD_MS, OLED_SCHED_PRIO_VALUE}, 0, 0},
+    [OLED_RGN_MST]      = {&oled_main, {64, 0, 127, 10, OLED_VALUE_PERIOD_MS, OLED_SCHED_PRIO_VALUE}, 64, 0},
+    [OLED_RGN_C1]       = {&oled_main, {0, 11, 63, 21, OLED_VALUE_PERIOD_MS, OLED_SCHED_PRIO_VALUE}, 0, 11},
+    [OLED_RGN_DW]       = {&oled_main, {64, 11, 127, 21, OLED_VALUE_PERIOD_MS, OLED_SCHED_PRIO_VALUE}, 64, 11},
+    [OLED_RGN_X3]       = {&oled_main, {0, 22, 63, 31, OLED_VALUE_PERIOD_MS, OLED_SCHED_PRIO_VALUE}, 0, 22},
+    [OLED_RGN_X2]       = {&oled_main, {64, 22, 127, 31, OLED_VALUE_PERIOD_MS, OLED_SCHED_PRIO_VALUE}, 71, 22},
+    [OLED_RGN_SRC_A]    = {&oled_sub, {0, 5, 34, 14, 0, OLED_SCHED_PRIO_ALERT}, 1, 5},
+    [OLED_RGN_SRC_B]    = {&oled_sub, {93, 5, 127, 14, 0, OLED_SCHED_PRIO_ALERT}, 93, 5},
+    [OLED_RGN_TYPE_A]   = {&oled_sub, {0, 30, 55, 39, 0, OLED_SCHED_PRIO_ALERT}, 1, 30},
+    [OLED_RGN_TYPE_B]   = {&oled_sub, {73, 30, 127, 39, 0, OLED_SCHED_PRIO_ALERT}, 77, 30},
+    [OLED_RGN_SRC_P]    = {&oled_sub, {0, 50, 127, 59, 0, OLED_SCHED_PRIO_ALERT}, 1, 50},
+    [OLED_RGN_DVS_A]    = {&oled_sub, {35, 5, 55, 14, 0, OLED_SCHED_PRIO_ALERT}, 35, 5},  // "[D]" / "[ ]" は 3 文字分
+    [OLED_RGN_DVS_B]    = {&oled_sub, {72, 5, 92, 14, 0, OLED_SCHED_PRIO_ALERT}, 72, 5},
+    [OLED_RGN_METERS]   = {&oled_sub, {8, 1, 127, 13, OLED_WIDGET_PERIOD_MS, OLED_SCHED_PRIO_VALUE}, 0, 0},
+    [OLED_RGN_GRAPHS]   = {&oled_sub, {0, 17, 127, 30, OLED_WIDGET_PERIOD_MS, OLED_SCHED_PRIO_VALUE}, 0, 0},
+    [OLED_RGN_SPECTRUM] = {&oled_sub, {0, 32, 127, 63, OLED_SPECTRUM_PERIOD_MS, OLED_SCHED_PRIO_VALUE}, 0, 0},
+    [OLED_RGN_MENU]     = {&oled_sub, {0, 0, 127, 63, OLED_MENU_PERIOD_MS, OLED_SCHED_PRIO_ALERT}, 0, 0},
+};
+
+static const oled_meter_def_t s_meter_defs[DSP_READBACK_METER_NUM] = {
+    {.x = 8, .y = 1, .w = 120, .h = 5, .hold_ms = 1000, .fall_per_s = 120},
+    {.x = 8, .y = 9, .w = 120, .h = 5, .hold_ms = 1000, .fall_per_s = 120},
+};
+
+static const oled_spectrum_def_t s_spectrum_def = {
+    .x          = 0,
+    .y          = 32,
+    .w          = OLED_I2C_SUB_WIDTH,
+    .h          = 32,
+    .bands      = OLED_SPECTRUM_BANDS,
+    .band_w     = (OLED_I2C_SUB_WIDTH / OLED_SPECTRUM_BANDS) - 1U,
+    .hold_ms    = 600,
+    .fall_per_s = 400,
+};
+
+static uint8_t s_main_fb[OLED_I2C_MAIN_WIDTH * (OLED_I2C_MAIN_HEIGHT / 8U)];
+static uint8_t s_sub_fb[OLED_I2C_SUB_WIDTH * (OLED_I2C_SUB_HEIGHT / 8U)];
+
+ssd1306_t oled_main = {
+    .ops    = &oled_i2c_ops,
+    .bus    = &hi2c3,
+    .fb     = s_main_fb,
+    .addr   = OLED_I2C_ADDR,
+    .port   = OLED_I2C_MAIN,
+    .width  = OLED_I2C_MAIN_WIDTH,
+    .height = OLED_I2C_MAIN_HEIGHT,
+};
+
+ssd1306_t oled_sub = {
+    .ops    = &oled_i2c_ops,
+    .bus    = &hi2c2,
+    .fb     = s_sub_fb,
+    .addr   = OLED_I2C_ADDR,
+    .port   = OLED_I2C_SUB,
+    .width  = OLED_I2C_SUB_WIDTH,
+    .height = OLED_I2C_SUB_HEIGHT,
+};
+
+// 表示の切り替え要求は adcTask だけが数え、oledTask が追いかける。今の表示は oledTask だけが書く
+static volatile uint32_t s_sub_view_req;
+static volatile uint8_t s_sub_view = OLED_SUB_VIEW_ROUTING;
+
+// メニューの入力 (adcTask -> oledTask)。キーは 1 対 1 のリング、ポットは最新値だけ
+static volatile uint8_t s_menu_keys[OLED_MENU_KEY_QUEUE];
+static volatile uint32_t s_menu_key_head;
+static volatile uint32_t s_menu_key_tail;
+static volatile uint32_t s_menu_pot;  // (full << 16) | pos
+static volatile uint32_t s_menu_pot_seq;
+
+extern osThreadId_t oledTaskHandle;
+
+static volatile uint32_t s_activity_tick;
+static volatile bool s_oled_asleep;
+static uint8_t s_dim_stage;
+static uint8_t s_shift_idx;
+static uint32_t s_shift_tick;
+
+static oled_menu_t s_menu;
+static UI_ControlPersistState_t s_menu_cfg;   // メニューで書き換える設定
+static UI_ControlPersistState_t s_menu_orig;  // 開いた時の設定 (Revert)
+
+static const char* const s_menu_type_names[]  = {"Line", "Phono"};
+static const char* const s_menu_onoff_names[] = {"Off", "On"};
+static const char* const s_menu_src_names[]   = {"CH1", "CH2", "USB1/2", "USB3/4"};
+static const uint8_t s_menu_src_values[]      = {INPUT_SRC_CH1_LN, INPUT_SRC_CH2_LN, INPUT_SRC_USB12, INPUT_SRC_USB34};
+static const char* const s_menu_curve_names[] = {"Linear", "Power", "Sharp", "Scratch", "User"};
+
+#define MENU_FIELD(f) ((uint8_t) offsetof(UI_ControlPersistState_t, f))
+
+static const oled_menu_item_t s_menu_input_items[] = {
+    {.label = "CH1 Type", .kind = OLED_MENU_ENUM, .field = MENU_FIELD(current_ch1_input_type), .max = 1, .names = s_menu_type_names},
+    {.label = "CH2 Type", .kind = OLED_MENU_ENUM, .field = MENU_FIELD(current_ch2_input_type), .max = 1, .names = s_menu_type_names},
+    {.label = "CH1 DVS", .kind = OLED_MENU_ENUM, .field = MENU_FIELD(current_ch1_dvs_enable), .max = 1, .names = s_menu_onoff_names},
+    {.label = "CH2 DVS", .kind = OLED_MENU_ENUM, .field = MENU_FIELD(current_ch2_dvs_enable), .max = 1, .names = s_menu_onoff_names},
+};
+
+static const oled_menu_item_t s_menu_routing_items[] = {
+    {.label = "XF A", .kind = OLED_MENU_ENUM, .field = MENU_FIELD(current_xfA_assign), .max = 3, .names = s_menu_src_names, .values = s_menu_src_values},
+    {.label = "XF B", .kind = OLED_MENU_ENUM, .field = MENU_FIELD(current_xfB_assign), .max = 3, .names = s_menu_src_names, .values = s_menu_src_values},
+    {.label = "Thru", .kind = OLED_MENU_ENUM, .field = MENU_FIELD(current_xfpost_assign), .max = 3, .names = s_menu_src_names, .values = s_menu_src_values},
+};
+
+static const oled_menu_item_t s_menu_xfade_items[] = {
+    {.label = "Curve A", .kind = OLED_MENU_ENUM, .field = MENU_FIELD(current_xf_curve[XFADE_FADER_A]), .max = XFADE_CURVE_NUM - 1U, .names = s_menu_curve_names},
+    {.label = "Curve B", .kind = OLED_MENU_ENUM, .field = MENU_FIELD(current_xf_curve[XFADE_FADER_B]), .max = XFADE_CURVE_NUM - 1U, .names = s_menu_curve_names},
+    {.label = "Cut A", .kind = OLED_MENU_INT, .field = MENU_FIELD(current_xf_cut[XFADE_FADER_A]), .min = 0, .max = MAG_XFADE_CUT_MAX, .step = 1},
+    {.label = "Cut B", .kind = OLED_MENU_INT, .field = MENU_FIELD(current_xf_cut[XFADE_FADER_B]), .min = 0, .max = MAG_XFADE_CUT_MAX, .step = 1},
+};
+
+static const oled_menu_page_t s_menu_input_page   = {"Inputs", s_menu_input_items, (uint8_t) (sizeof(s_menu_input_items) / sizeof(s_menu_input_items[0]))};
+static const oled_menu_page_t s_menu_routing_page = {"Routing", s_menu_routing_items, (uint8_t) (sizeof(s_menu_routing_items) / sizeof(s_menu_routing_items[0]))};
+static const oled_menu_page_t s_menu_xfade_page   = {"Crossfader", s_menu_xfade_items, (uint8_t) (sizeof(s_menu_xfade_items) / sizeof(s_menu_xfade_items[0]))};
+
+static const oled_menu_item_t s_menu_root_items[] = {
+    {.label = "Inputs", .kind = OLED_MENU_SUBMENU, .sub = &s_menu_input_page},
+    {.label = "Routing", .kind = OLED_MENU_SUBMENU, .sub = &s_menu_routing_page},
+    {.label = "Crossfader", .kind = OLED_MENU_SUBMENU, .sub = &s_menu_xfade_page},
+    {.label = "Save", .kind = OLED_MENU_ACTION, .action = OLED_MENU_ACTION_SAVE},
+    {.label = "Revert", .kind = OLED_MENU_ACTION, .action = OLED_MENU_ACTION_REVERT},
+};
+
+static const oled_menu_page_t s_menu_root_page = {"Menu", s_menu_root_items, (uint8_t) (sizeof(s_menu_root_items) / sizeof(s_menu_root_items[0]))};
+
+static oled_meter_t s_meters[DSP_READBACK_METER_NUM];
+static oled_graph_t s_xf_graph[2];
+static oled_spectrum_t s_spectrum;
+static audio_spectrum_t s_analyzer;
+static int32_t s_spectrum_samples[AUDIO_SPECTRUM_N];
+
+static oled_sched_t s_sched;
+static char s_text_want[OLED_RGN_TEXT_NUM][OLED_TEXT_LEN];   // 最新の値 (まだ描いていないかもしれない)
+static char s_text_shown[OLED_RGN_TEXT_NUM][OLED_TEXT_LEN];  // 描いてある値
+
+static uint16_t oled_text_width_px(SSD1306_Font_t const* font, const char* text)
+{
+    if ((font == NULL) || (text == NULL))
     {
-        *dirty_start_page = page_start;
+        return 0U;
     }
-    if (*dirty_end_page < page_end)
+
+    uint16_t width = 0U;
+    for (size_t i = 0; text[i] != '\0'; i++)
     {
-        *dirty_end_page = page_end;
+        char c = text[i];
+        if ((font->char_width != NULL) && (c >= 32) && (c <= 126))
+        {
+            width = (uint16_t) (width + font->char_width[(uint8_t) c - 32U]);
+        }
+        else
+        {
+            width = (uint16_t) (width + font->width);
+        }
     }
+
+    return width;
 }
 
-static void update_main_text_block(char* prev, size_t prev_size, const char* text, uint8_t clear_x1, uint8_t clear_y1, uint8_t clear_x2, uint8_t clear_y2, uint8_t cursor_x, uint8_t cursor_y, uint8_t page_start, uint8_t page_end, bool* dirty, uint8_t* dirty_start_page, uint8_t* dirty_end_page)
+// 描いた範囲はドライバが dirty に印を付ける (実際に送るのは、表示中と違うバイトだけ)
+static void update_text_block(ssd1306_t* oled, char* prev, size_t prev_size, const char* text, uint8_t clear_x1, uint8_t clear_y1, uint8_t clear_x2, uint8_t clear_y2, uint8_t cursor_x, uint8_t cursor_y)
 {
     if (strcmp(prev, text) == 0)
     {
         return;
     }
 
-    main_oled_FillRectangle(clear_x1, clear_y1, clear_x2, clear_y2, Black);
-    main_oled_SetCursor(cursor_x, cursor_y);
-    main_oled_WriteString((char*) text, Font_7x10, White);
+    ssd1306_FillRectangle(oled, clear_x1, clear_y1, clear_x2, clear_y2, Black);
+    ssd1306_SetCursor(oled, cursor_x, cursor_y);
+    ssd1306_WriteString(oled, text, Font_7x10, White);
     snprintf(prev, prev_size, "%s", text);
-
-    merge_dirty_pages(dirty, dirty_start_page, dirty_end_page, page_start, page_end);
 }
 
-static void update_sub_text_block(char* prev, size_t prev_size, const char* text, uint8_t clear_x1, uint8_t clear_y1, uint8_t clear_x2, uint8_t clear_y2, uint8_t cursor_x, uint8_t cursor_y, uint8_t page_start, uint8_t page_end, bool* dirty, uint8_t* dirty_start_page, uint8_t* dirty_end_page)
+// 値を覚えて描き直しを予約する (描く前にまた変わったら最新の値だけ描く)
+static void post_text(uint8_t rgn, const char* text)
 {
-    if (strcmp(prev, text) == 0)
+    char buf[OLED_TEXT_LEN];
+
+    snprintf(buf, sizeof(buf), "%s", (text == NULL) ? "" : text);
+    if (strcmp(buf, s_text_want[rgn]) == 0)
     {
         return;
     }
+    memcpy(s_text_want[rgn], buf, sizeof(buf));
+    oled_sched_post(&s_sched, rgn);
+}
 
-    sub_oled_FillRectangle(clear_x1, clear_y1, clear_x2, clear_y2, Black);
-    sub_oled_SetCursor(cursor_x, cursor_y);
-    sub_oled_WriteString((char*) text, Font_7x10, White);
-    snprintf(prev, prev_size, "%s", text);
+// 流れ続ける領域は、待っていない時だけ予約する (まとめた回数に数えない)
+static void post_stream(uint8_t rgn)
+{
+    if (!oled_sched_pending(&s_sched, rgn))
+    {
+        oled_sched_post(&s_sched, rgn);
+    }
+}
 
-    merge_dirty_pages(dirty, dirty_start_page, dirty_end_page, page_start, page_end);
+// srcX_channel: 0 = なし、1 = CH1、2 = CH2
+static const char* dvs_badge_str(uint8_t channel)
+{
+    if (channel == 0U)
+    {
+        return "";
+    }
+    const bool enabled = (channel == 1U) ? get_current_ch1_dvs_enabled() : ((channel == 2U) ? get_current_ch2_dvs_enabled() : false);
+    return enabled ? "[D]" : "[ ]";
 }
 
-static void update_sub_dvs_badge(bool show, bool enabled, uint8_t x, uint8_t y, bool* prev_show, bool* prev_enabled, bool* dirty, uint8_t* dirty_start_page, uint8_t* dirty_end_page)
+// 画面を切り替えた時、サブ OLED の領域は待っている分を捨て、前の値も忘れる
+static void reset_sub_regions(void)
 {
-    if ((*prev_show == show) && (!show || (*prev_enabled == enabled)))
+    for (uint8_t rgn = OLED_RGN_SUB_FIRST; rgn < OLED_RGN_NUM; rgn++)
     {
-        return;
+        oled_sched_cancel(&s_sched, rgn);
+        if (rgn < OLED_RGN_TEXT_NUM)
+        {
+            s_text_want[rgn][0]  = '\0';
+            s_text_shown[rgn][0] = '\0';
+        }
     }
+}
 
-    // "[D]" / "[ ]" in Font_7x10 requires ~3 chars width.
-    sub_oled_FillRectangle(x, y, (uint8_t) (x + 20U), (uint8_t) (y + 9U), Black);
+// ポットが値を拾っていない (ソフトテイクオーバー中) は ':' の代わりに回す向きを出す
+static char takeover_mark(uint8_t param)
+{
+    const int8_t dir = get_current_dsp_takeover(param);
+    return (dir > 0) ? '>' : ((dir < 0) ? '<' : ':');
+}
+
+static void draw_sub_widgets_frame(void)
+{
+    ssd1306_Fill(&oled_sub, Black);
+    ssd1306_SetCursor(&oled_sub, 0, 0);
+    ssd1306_WriteString(&oled_sub, "A", Font_6x8, White);
+    ssd1306_SetCursor(&oled_sub, 0, 8);
+    ssd1306_WriteString(&oled_sub, "B", Font_6x8, White);
 
-    if (show)
+    for (uint8_t m = 0; m < DSP_READBACK_METER_NUM; m++)
     {
-        sub_oled_SetCursor(x, y);
-        sub_oled_WriteString(enabled ? "[D]" : "[ ]", Font_7x10, White);
+        oled_meter_init(&s_meters[m], &s_meter_defs[m]);
     }
-
-    *prev_show    = show;
-    *prev_enabled = enabled;
-    merge_dirty_pages(dirty, dirty_start_page, dirty_end_page, 0, 1);
+    oled_graph_init(&s_xf_graph[0], 0, 17, 63, 14);
+    oled_graph_init(&s_xf_graph[1], 65, 17, 63, 14);
+    oled_spectrum_init(&s_spectrum, &s_spectrum_def);
 }
 
-static const char* nonnull_str(const char* text)
+static oled_canvas_t sub_canvas(void)
 {
-    return (text == NULL) ? "" : text;
+    const oled_canvas_t canvas = {
+        .fb     = oled_sub.fb,
+        .width  = oled_sub.width,
+        .height = oled_sub.height,
+        .dirty  = &oled_sub.dirty,
+    };
+    return canvas;
 }
 
-static uint16_t oled_text_width_px(SSD1306_Font_t const* font, const char* text)
+// DSP のメーター A/B
+static void update_sub_meters(uint32_t now)
 {
-    if ((font == NULL) || (text == NULL))
+    const oled_canvas_t canvas = sub_canvas();
+
+    for (uint8_t m = 0; m < DSP_READBACK_METER_NUM; m++)
     {
-        return 0U;
+        oled_meter_update(&s_meters[m], oled_widget_db_to_level(dsp_readback_get_dbfs(m), OLED_METER_FLOOR_DB), now);
+        oled_meter_draw(&s_meters[m], &canvas);
     }
+}
 
-    uint16_t width = 0U;
-    for (size_t i = 0; text[i] != '\0'; i++)
+// クロスフェーダー位置の履歴
+static void update_sub_graphs(void)
+{
+    const oled_canvas_t canvas = sub_canvas();
+
+    oled_graph_push(&s_xf_graph[0], get_current_xfA_position());
+    oled_graph_push(&s_xf_graph[1], get_current_xfB_position());
+    oled_graph_draw(&s_xf_graph[0], &canvas);
+    oled_graph_draw(&s_xf_graph[1], &canvas);
+}
+
+// SAI RX (L1/R1) のスペクトラム
+static void update_sub_spectrum(uint32_t now)
+{
+    const oled_canvas_t canvas = sub_canvas();
+    const uint32_t rate = get_current_sample_rate();
+    if (s_analyzer.sample_rate != rate)
     {
-        char c = text[i];
-        if ((font->char_width != NULL) && (c >= 32) && (c <= 126))
-        {
-            width = (uint16_t) (width + font->char_width[(uint8_t) c - 32U]);
-        }
-        else
-        {
-            width = (uint16_t) (width + font->width);
-        }
+        audio_spectrum_init(&s_analyzer, OLED_SPECTRUM_BANDS, rate, OLED_SPECTRUM_F_LO, OLED_SPECTRUM_F_HI);
     }
 
-    return width;
+    float band_db[OLED_SPECTRUM_BANDS];
+    uint8_t band_level[OLED_SPECTRUM_BANDS];
+    (void) audio_copy_rx_mono(s_spectrum_samples, AUDIO_SPECTRUM_N);
+    audio_spectrum_process(&s_analyzer, s_spectrum_samples, band_db);
+    for (uint8_t b = 0; b < OLED_SPECTRUM_BANDS; b++)
+    {
+        band_level[b] = oled_widget_db_to_level(band_db[b], OLED_SPECTRUM_FLOOR_DB);
+    }
+    oled_spectrum_update(&s_spectrum, band_level, now);
+    oled_spectrum_draw(&s_spectrum, &canvas);
 }
 
 static bool wait_main_oled_ready(uint32_t timeout_ms)
@@ -123,7 +418,7 @@ static bool wait_main_oled_ready(uint32_t timeout_ms)
 
     while ((HAL_GetTick() - start) < timeout_ms)
     {
-        if (HAL_I2C_IsDeviceReady(&MAIN_OLED_I2C_PORT, MAIN_OLED_I2C_ADDR, 2, 20) == HAL_OK)
+        if (HAL_I2C_IsDeviceReady((I2C_HandleTypeDef*) oled_main.bus, oled_main.addr, 2, 20) == HAL_OK)
         {
             return true;
         }
@@ -135,138 +430,398 @@ static bool wait_main_oled_ready(uint32_t timeout_ms)
 
 void OLED_Init(void)
 {
+    oled_sched_init(&s_sched, OLED_SCHED_BUDGET);
+    for (uint8_t rgn = 0; rgn < OLED_RGN_NUM; rgn++)
+    {
+        (void) oled_sched_add(&s_sched, &s_regions[rgn].area);
+    }
+
     // Power-up直後はOLED側I2C応答まで時間がかかる場合があるため、初回のみ待機する
     (void) wait_main_oled_ready(500);
-    main_oled_Init();
-    main_oled_Fill(Black);
-    main_oled_UpdateScreen();
+    ssd1306_Init(&oled_main);
+    ssd1306_Fill(&oled_main, Black);
+    ssd1306_UpdateScreen(&oled_main);
 
-    sub_oled_Init();
-    sub_oled_SetCursor(5, 16);
-    sub_oled_WriteString("JUMBLEQ", Font_16x24, White);
+    ssd1306_Init(&oled_sub);
+    ssd1306_SetCursor(&oled_sub, 5, 16);
+    ssd1306_WriteString(&oled_sub, "JUMBLEQ", Font_16x24, White);
     const uint16_t ver_width = oled_text_width_px(&Font_11x18, APP_VERSION_OLED_STR);
-    const uint8_t ver_x      = (ver_width < SUB_OLED_WIDTH) ? (uint8_t) (SUB_OLED_WIDTH - ver_width) : 0U;
-    sub_oled_SetCursor(ver_x, 40);
-    sub_oled_WriteString(APP_VERSION_OLED_STR, Font_11x18, White);
-    sub_oled_UpdateScreen();
+    const uint8_t ver_x      = (ver_width < oled_sub.width) ? (uint8_t) (oled_sub.width - ver_width) : 0U;
+    ssd1306_SetCursor(&oled_sub, ver_x, 40);
+    ssd1306_WriteString(&oled_sub, APP_VERSION_OLED_STR, Font_11x18, White);
+    ssd1306_UpdateScreen(&oled_sub);
 }
 
+// 他のタスクから。寝ていれば oledTask を起こす
+void OLED_NotifyActivity(void)
+{
+    s_activity_tick = osKernelGetTickCount();
+    __DMB();
+    if (s_oled_asleep && (oledTaskHandle != NULL))
+    {
+        (void) osThreadFlagsSet(oledTaskHandle, OLED_WAKE_THREAD_FLAG);
+    }
+}
+
+static void oled_set_contrast(uint8_t contrast)
+{
+    ssd1306_SetContrast(&oled_main, contrast);
+    ssd1306_SetContrast(&oled_sub, contrast);
+}
+
+// パネルを止めて、操作で起こされるまで待つ (GDDRAM は残るので起きたらすぐ前の表示に戻る)
+static void oled_power_sleep(void)
+{
+    (void) osThreadFlagsClear(OLED_WAKE_THREAD_FLAG);
+    s_oled_asleep = true;
+    __DMB();
+    // 寝ると決めてから届いた操作を取りこぼさないように、フラグを立ててからもう一度見る
+    if ((osKernelGetTickCount() - s_activity_tick) < OLED_SLEEP_MS)
+    {
+        s_oled_asleep = false;
+        return;
+    }
+
+    ssd1306_SetDisplayOn(&oled_main, 0);
+    ssd1306_SetDisplayOn(&oled_sub, 0);
+#if OLED_POWER_LOG
+    SEGGER_RTT_printf(0, "[OLED] sleep\n");
+#endif
+
+    (void) osThreadFlagsWait(OLED_WAKE_THREAD_FLAG, osFlagsWaitAny, osWaitForever);
+    s_oled_asleep = false;
+
+    s_dim_stage = 0;
+    oled_set_contrast(s_dim_stages[0].contrast);
+    ssd1306_SetDisplayOn(&oled_main, 1);
+    ssd1306_SetDisplayOn(&oled_sub, 1);
+#if OLED_POWER_LOG
+    SEGGER_RTT_printf(0, "[OLED] wake\n");
+#endif
+}
+
+// 操作が無い時間に応じてコントラストを下げ、一定時間毎に表示をずらす
+static void oled_power_update(void)
+{
+    const uint32_t now  = osKernelGetTickCount();
+    const uint32_t idle = now - s_activity_tick;
+    uint8_t stage       = 0;
+
+    if (idle >= OLED_SLEEP_MS)
+    {
+        oled_power_sleep();
+        return;
+    }
+
+    for (uint8_t i = 1; i < (uint8_t) (sizeof(s_dim_stages) / sizeof(s_dim_stages[0])); i++)
+    {
+        if (idle >= s_dim_stages[i].idle_ms)
+        {
+            stage = i;
+        }
+    }
+    if (stage != s_dim_stage)
+    {
+        s_dim_stage = stage;
+        oled_set_contrast(s_dim_stages[stage].contrast);
+#if OLED_POWER_LOG
+        SEGGER_RTT_printf(0, "[OLED] dim stage=%u\n", (unsigned) stage);
+#endif
+    }
+
+    if ((now - s_shift_tick) >= OLED_SHIFT_PERIOD_MS)
+    {
+        s_shift_tick = now;
+        s_shift_idx  = (uint8_t) ((s_shift_idx + 1U) % (sizeof(s_shift_orbit) / sizeof(s_shift_orbit[0])));
+        oled_i2c_set_shift(&oled_main, s_shift_orbit[s_shift_idx][0], s_shift_orbit[s_shift_idx][1]);
+        oled_i2c_set_shift(&oled_sub, s_shift_orbit[s_shift_idx][0], s_shift_orbit[s_shift_idx][1]);
+    }
+}
+
+void OLED_ToggleSubView(void)
+{
+    s_sub_view_req = s_sub_view_req + 1U;
+}
+
+void OLED_MenuKey(uint8_t key)
+{
+    const uint32_t head = s_menu_key_head;
+
+    if ((head - s_menu_key_tail) >= OLED_MENU_KEY_QUEUE)
+    {
+        return;  // 溢れたら捨てる
+    }
+    s_menu_keys[head & (OLED_MENU_KEY_QUEUE - 1U)] = key;
+    __DMB();
+    s_menu_key_head = head + 1U;
+}
+
+void OLED_MenuPot(uint16_t pos, uint16_t full)
+{
+    s_menu_pot = ((uint32_t) full << 16) | pos;
+    __DMB();
+    s_menu_pot_seq = s_menu_pot_seq + 1U;
+}
+
+bool OLED_MenuIsOpen(void)
+{
+    return s_sub_view == OLED_SUB_VIEW_MENU;
+}
+
+// 値は変えたらすぐ反映し、EEPROM へは Save か、変えたまま閉じた時に書く
+static void menu_on_change(void* ctx, const oled_menu_item_t* item)
+{
+    (void) ctx;
+    (void) item;
+    ui_control_request_persist_state(&s_menu_cfg, false);
+}
+
+static bool menu_on_action(void* ctx, uint8_t action)
+{
+    (void) ctx;
+
+    switch (action)
+    {
+    case OLED_MENU_ACTION_SAVE:
+        ui_control_request_persist_state(&s_menu_cfg, true);
+        s_menu.changed = false;
+        return true;
+    case OLED_MENU_ACTION_REVERT:
+        memcpy(&s_menu_cfg, &s_menu_orig, sizeof(s_menu_cfg));
+        ui_control_request_persist_state(&s_menu_cfg, false);
+        s_menu.changed = false;
+        return true;
+    default:
+        return false;
+    }
+}
+
+// 割り当ての Phono/Line は入力の種類で決まるので、メニューでは Line 側にそろえて見せる
+static uint8_t menu_normalize_src(uint8_t src)
+{
+    return ((src == INPUT_SRC_CH1_PN) || (src == INPUT_SRC_CH2_PN)) ? (uint8_t) (src - 1U) : src;
+}
+
+static void menu_open(void)
+{
+    ui_control_get_persist_state(&s_menu_cfg);
+    s_menu_cfg.current_xfA_assign    = menu_normalize_src(s_menu_cfg.current_xfA_assign);
+    s_menu_cfg.current_xfB_assign    = menu_normalize_src(s_menu_cfg.current_xfB_assign);
+    s_menu_cfg.current_xfpost_assign = menu_normalize_src(s_menu_cfg.current_xfpost_assign);
+    memcpy(&s_menu_orig, &s_menu_cfg, sizeof(s_menu_orig));
+
+    s_menu.on_change = menu_on_change;
+    s_menu.on_action = menu_on_action;
+    s_menu.ctx       = NULL;
+    oled_menu_open(&s_menu, &s_menu_root_page, (uint8_t*) &s_menu_cfg, (uint8_t) sizeof(s_menu_cfg));
+}
+
+static void menu_close(void)
+{
+    if (s_menu.changed)
+    {
+        ui_control_request_persist_state(&s_menu_cfg, true);
+    }
+    oled_menu_close(&s_menu);
+}
+
+// 溜まったキーとポットを処理して、変わっていれば描き直す。一番上で BACK なら閉じて false
+static bool update_sub_menu(void)
+{
+    static uint32_t pot_seq;
+
+    while (s_menu_key_tail != s_menu_key_head)
+    {
+        const uint32_t tail = s_menu_key_tail;
+        __DMB();
+        oled_menu_key(&s_menu, s_menu_keys[tail & (OLED_MENU_KEY_QUEUE - 1U)]);
+        s_menu_key_tail = tail + 1U;
+    }
+
+    if (pot_seq != s_menu_pot_seq)
+    {
+        pot_seq = s_menu_pot_seq;
+        __DMB();
+        const uint32_t pot = s_menu_pot;
+        oled_menu_pot(&s_menu, (uint16_t) (pot & 0xFFFFU), (uint16_t) (pot >> 16));
+    }
+
+    if (!oled_menu_is_open(&s_menu))
+    {
+        menu_close();
+        return false;
+    }
+    if (s_menu.redraw)
+    {
+        oled_sched_post(&s_sched, OLED_RGN_MENU);
+    }
+    return true;
+}
+
+static void draw_region(uint8_t rgn, uint32_t now)
+{
+    const oled_region_t* r = &s_regions[rgn];
+
+    if (rgn < OLED_RGN_TEXT_NUM)
+    {
+        update_text_block(r->oled, s_text_shown[rgn], sizeof(s_text_shown[rgn]), s_text_want[rgn], r->area.x1, r->area.y1, r->area.x2,
+                          r->area.y2, r->cursor_x, r->cursor_y);
+        return;
+    }
+
+    switch (rgn)
+    {
+    case OLED_RGN_METERS:
+        update_sub_meters(now);
+        break;
+    case OLED_RGN_GRAPHS:
+        update_sub_graphs();
+        break;
+    case OLED_RGN_SPECTRUM:
+        update_sub_spectrum(now);
+        break;
+    case OLED_RGN_MENU:
+        (void) oled_menu_draw(&s_menu, &oled_sub);
+        break;
+    default:
+        break;
+    }
+}
+
+#if OLED_SCHED_LOG
+static void oled_sched_report(uint32_t now)
+{
+    static uint32_t last_ms;
+    oled_sched_stats_t st;
+
+    if ((now - last_ms) < 1000U)
+    {
+        return;
+    }
+    last_ms = now;
+    oled_sched_take_stats(&s_sched, &st);
+    SEGGER_RTT_printf(0, "[OLED SCHED] frames=%lu drawn=%lu coalesced=%lu deferred=%lu bytes<=%lu\n", (unsigned long) st.frames,
+                      (unsigned long) st.drawn, (unsigned long) st.coalesced, (unsigned long) st.deferred, (unsigned long) st.bytes);
+}
+#endif
+
 void OLED_ShowInitStatus(const char* text)
 {
     const char* msg = (text == NULL) ? "" : text;
 
-    main_oled_Fill(Black);
-    main_oled_SetCursor(0, 4);
-    main_oled_WriteString("System Init", Font_7x10, White);
-    main_oled_SetCursor(0, 18);
-    main_oled_WriteString((char*)msg, Font_7x10, White);
-    main_oled_UpdateScreen();
+    ssd1306_Fill(&oled_main, Black);
+    ssd1306_SetCursor(&oled_main, 0, 4);
+    ssd1306_WriteString(&oled_main, "System Init", Font_7x10, White);
+    ssd1306_SetCursor(&oled_main, 0, 18);
+    ssd1306_WriteString(&oled_main, msg, Font_7x10, White);
+    ssd1306_UpdateScreen(&oled_main);
 }
 
 void OLED_UpdateTask(void)
 {
-    char line1_ch2[16];
-    char line1_mst[16];
-    char line2_c1[16];
-    char line2_dw[16];
-    char line3_x3[16];
-    char line3_x2[16];
-    static char prev_line1_ch2[16] = {0};
-    static char prev_line1_mst[16] = {0};
-    static char prev_line2_c1[16]  = {0};
-    static char prev_line2_dw[16]  = {0};
-    static char prev_line3_x3[16]  = {0};
-    static char prev_line3_x2[16]  = {0};
-    static char prev_srcA[32]      = {0};
-    static char prev_srcB[32]      = {0};
-    static char prev_typeA[32]     = {0};
-    static char prev_typeB[32]     = {0};
-    static char prev_srcP[32]      = {0};
-    static bool prev_dvsA_show     = false;
-    static bool prev_dvsA_enabled  = false;
-    static bool prev_dvsB_show     = false;
-    static bool prev_dvsB_enabled  = false;
-    static bool sub_initialized    = false;
-    bool dirty                     = false;
-    uint8_t dirty_start_page       = 0xFF;
-    uint8_t dirty_end_page         = 0;
-
-    const uint8_t line1_ch2_x = 0;
-    const uint8_t line1_mst_x = 64;
-    const uint8_t line1_y     = 0;
-
-    snprintf(line1_ch2, sizeof(line1_ch2), "C2:%3ddB", get_current_ch2_db());
-    snprintf(line1_mst, sizeof(line1_mst), "Mst:%3ddB", get_current_master_db());
-    const uint8_t line2_c1_x = 0;
-    const uint8_t line2_dw_x = 64;
-    const uint8_t line2_y    = 11;
-
-    snprintf(line2_c1, sizeof(line2_c1), "C1:%3ddB", get_current_ch1_db());
-    snprintf(line2_dw, sizeof(line2_dw), "D/W:%3d%%", get_current_dry_wet());
-    uint8_t x2 = get_current_xfade2_cc_value();
-    uint8_t x3 = get_current_xfade3_cc_value();
-    snprintf(line3_x3, sizeof(line3_x3), "X3:%3u", x3);
-    snprintf(line3_x2, sizeof(line3_x2), "X2:%3u", x2);
-
-    update_main_text_block(prev_line1_ch2, sizeof(prev_line1_ch2), line1_ch2, 0, 0, 63, 10, line1_ch2_x, line1_y, 0, 1, &dirty, &dirty_start_page, &dirty_end_page);
-    update_main_text_block(prev_line1_mst, sizeof(prev_line1_mst), line1_mst, 64, 0, 127, 10, line1_mst_x, line1_y, 0, 1, &dirty, &dirty_start_page, &dirty_end_page);
-    update_main_text_block(prev_line2_c1, sizeof(prev_line2_c1), line2_c1, 0, 11, 63, 21, line2_c1_x, line2_y, 1, 2, &dirty, &dirty_start_page, &dirty_end_page);
-    update_main_text_block(prev_line2_dw, sizeof(prev_line2_dw), line2_dw, 64, 11, 127, 21, line2_dw_x, line2_y, 1, 2, &dirty, &dirty_start_page, &dirty_end_page);
-    update_main_text_block(prev_line3_x3, sizeof(prev_line3_x3), line3_x3, 0, 22, 63, 31, 0, 22, 2, 3, &dirty, &dirty_start_page, &dirty_end_page);
-    update_main_text_block(prev_line3_x2, sizeof(prev_line3_x2), line3_x2, 64, 22, 127, 31, 71, 22, 2, 3, &dirty, &dirty_start_page, &dirty_end_page);
-
-    if (dirty)
-    {
-        main_oled_UpdateScreenPages(dirty_start_page, dirty_end_page);
-    }
-
-    const char* srcA  = nonnull_str(get_current_input_srcA_str());
-    const char* srcB  = nonnull_str(get_current_input_srcB_str());
-    const char* typeA = nonnull_str(get_current_input_typeA_str());
-    const char* typeB = nonnull_str(get_current_input_typeB_str());
-    const char* srcP  = nonnull_str(get_current_input_srcP_str());
-
-    bool sub_dirty               = false;
-    uint8_t sub_dirty_start_page = 0xFF;
-    uint8_t sub_dirty_end_page   = 0;
-
-    if (!sub_initialized)
-    {
-        sub_oled_Fill(Black);
-
-        // xfader (static drawing)
-        sub_oled_FillRectangle(5, 22, 55, 20, White);
-        sub_oled_FillRectangle(73, 22, 123, 20, White);
-        sub_oled_FillRectangle(60, 27, 68, 15, White);
-        sub_oled_FillCircle(64, 15, 4, White);
-        sub_oled_FillCircle(64, 27, 4, White);
-
-        sub_dirty            = true;
-        sub_dirty_start_page = 0;
-        sub_dirty_end_page   = (uint8_t) ((SUB_OLED_HEIGHT / 8U) - 1U);
-        sub_initialized      = true;
-    }
-
-    update_sub_text_block(prev_srcA, sizeof(prev_srcA), srcA, 0, 5, 34, 14, 1, 5, 0, 1, &sub_dirty, &sub_dirty_start_page, &sub_dirty_end_page);
-    update_sub_text_block(prev_srcB, sizeof(prev_srcB), srcB, 93, 5, 127, 14, 93, 5, 0, 1, &sub_dirty, &sub_dirty_start_page, &sub_dirty_end_page);
-    update_sub_text_block(prev_typeA, sizeof(prev_typeA), typeA, 0, 30, 55, 39, 1, 30, 3, 4, &sub_dirty, &sub_dirty_start_page, &sub_dirty_end_page);
-    update_sub_text_block(prev_typeB, sizeof(prev_typeB), typeB, 73, 30, 127, 39, 77, 30, 3, 4, &sub_dirty, &sub_dirty_start_page, &sub_dirty_end_page);
-    update_sub_text_block(prev_srcP, sizeof(prev_srcP), srcP, 0, 50, 127, 59, 1, 50, 6, 7, &sub_dirty, &sub_dirty_start_page, &sub_dirty_end_page);
-
-    uint8_t srcA_channel = get_current_input_srcA_channel();
-    bool srcA_show_dvs   = (srcA_channel != 0U);
-    bool srcA_dvs_enable = (srcA_channel == 1U) ? get_current_ch1_dvs_enabled()
-                                                : ((srcA_channel == 2U) ? get_current_ch2_dvs_enabled() : false);
-    update_sub_dvs_badge(srcA_show_dvs, srcA_dvs_enable, 35, 5, &prev_dvsA_show, &prev_dvsA_enabled, &sub_dirty, &sub_dirty_start_page, &sub_dirty_end_page);
-
-    uint8_t srcB_channel = get_current_input_srcB_channel();
-    bool srcB_show_dvs   = (srcB_channel != 0U);
-    bool srcB_dvs_enable = (srcB_channel == 1U) ? get_current_ch1_dvs_enabled()
-                                                : ((srcB_channel == 2U) ? get_current_ch2_dvs_enabled() : false);
-    update_sub_dvs_badge(srcB_show_dvs, srcB_dvs_enable, 72, 5, &prev_dvsB_show, &prev_dvsB_enabled, &sub_dirty, &sub_dirty_start_page, &sub_dirty_end_page);
-
-    if (sub_dirty)
-    {
-        sub_oled_UpdateScreenPages(sub_dirty_start_page, sub_dirty_end_page);
+    char text[OLED_TEXT_LEN];
+    uint8_t list[OLED_RGN_NUM];
+    static uint32_t sub_view_req = 0;
+    static bool sub_initialized  = false;
+
+    oled_power_update();
+
+    snprintf(text, sizeof(text), "C2%c%3ddB", takeover_mark(MIDI_MAP_DSP_CH2_GAIN), get_current_ch2_db());
+    post_text(OLED_RGN_CH2, text);
+    snprintf(text, sizeof(text), "Mst%c%3ddB", takeover_mark(MIDI_MAP_DSP_MASTER_GAIN), get_current_master_db());
+    post_text(OLED_RGN_MST, text);
+    snprintf(text, sizeof(text), "C1%c%3ddB", takeover_mark(MIDI_MAP_DSP_CH1_GAIN), get_current_ch1_db());
+    post_text(OLED_RGN_C1, text);
+    snprintf(text, sizeof(text), "D/W%c%3d%%", takeover_mark(MIDI_MAP_DSP_DRY_WET), get_current_dry_wet());
+    post_text(OLED_RGN_DW, text);
+    snprintf(text, sizeof(text), "X3:%3u", get_current_xfade3_cc_value());
+    post_text(OLED_RGN_X3, text);
+    snprintf(text, sizeof(text), "X2:%3u", get_current_xfade2_cc_value());
+    post_text(OLED_RGN_X2, text);
+
+    // 画面を切り替えたら全体を描き直す (文字列も前回値を忘れる)
+    uint8_t view = s_sub_view;
+    while (sub_view_req != s_sub_view_req)
+    {
+        sub_view_req++;
+        if (view == OLED_SUB_VIEW_MENU)
+        {
+            menu_close();
+        }
+        view = (uint8_t) ((view + 1U) % OLED_SUB_VIEW_NUM);
+        if (view == OLED_SUB_VIEW_MENU)
+        {
+            menu_open();
+        }
+    }
+    if ((view == OLED_SUB_VIEW_MENU) && !update_sub_menu())
+    {
+        view = OLED_SUB_VIEW_ROUTING;
+    }
+
+    if ((view != s_sub_view) || !sub_initialized)
+    {
+        s_sub_view      = view;
+        sub_initialized = true;
+        reset_sub_regions();
+        if (view == OLED_SUB_VIEW_METERS)
+        {
+            draw_sub_widgets_frame();
+        }
+        else if (view == OLED_SUB_VIEW_ROUTING)
+        {
+            ssd1306_Fill(&oled_sub, Black);
+
+            // xfader (static drawing)
+            ssd1306_FillRectangle(&oled_sub, 5, 22, 55, 20, White);
+            ssd1306_FillRectangle(&oled_sub, 73, 22, 123, 20, White);
+            ssd1306_FillRectangle(&oled_sub, 60, 27, 68, 15, White);
+            ssd1306_FillCircle(&oled_sub, 64, 15, 4, White);
+            ssd1306_FillCircle(&oled_sub, 64, 27, 4, White);
+        }
+        else
+        {
+            oled_sched_post(&s_sched, OLED_RGN_MENU);
+        }
     }
+
+    if ((view == OLED_SUB_VIEW_METERS) && EEPROM_IsBusy())
+    {
+        // EEPROM の読み書き中はメーター類 (hi2c2 を約 30fps で使う) を描かずに、そのフレームは飛ばす
+        // 待っていた分も捨てて、終わった次のフレームから最新の値で続ける
+        oled_sched_cancel(&s_sched, OLED_RGN_METERS);
+        oled_sched_cancel(&s_sched, OLED_RGN_GRAPHS);
+        oled_sched_cancel(&s_sched, OLED_RGN_SPECTRUM);
+    }
+    else if (view == OLED_SUB_VIEW_METERS)
+    {
+        post_stream(OLED_RGN_METERS);
+        post_stream(OLED_RGN_GRAPHS);
+        post_stream(OLED_RGN_SPECTRUM);
+    }
+    else if (view == OLED_SUB_VIEW_ROUTING)
+    {
+        post_text(OLED_RGN_SRC_A, get_current_input_srcA_str());
+        post_text(OLED_RGN_SRC_B, get_current_input_srcB_str());
+        post_text(OLED_RGN_TYPE_A, get_current_input_typeA_str());
+        post_text(OLED_RGN_TYPE_B, get_current_input_typeB_str());
+        post_text(OLED_RGN_SRC_P, get_current_input_srcP_str());
+        post_text(OLED_RGN_DVS_A, dvs_badge_str(get_current_input_srcA_channel()));
+        post_text(OLED_RGN_DVS_B, dvs_badge_str(get_current_input_srcB_channel()));
+    }
+
+    // 間隔を過ぎた領域を、状態の変化を先に、予算に入るだけ描く
+    const uint32_t now = osKernelGetTickCount();
+    const uint8_t n    = oled_sched_frame(&s_sched, now, list, (uint8_t) sizeof(list));
+    for (uint8_t i = 0; i < n; i++)
+    {
+        draw_region(list[i], now);
+    }
+
+    ssd1306_Commit(&oled_main);
+    ssd1306_Commit(&oled_sub);
+
+#if OLED_SCHED_LOG
+    oled_sched_report(now);
+#endif
 }
@@ -0,0 +1,219 @@
+/*
+ * oled_dirty.c
+ *
+ *  Created on: Mar 19, 2026
+ */
+
+#include "oled_dirty.h"
+
+#include <stddef.h>
+
+#define OLED_DIRTY_CLEAN_MIN 0xFFU
+#define OLED_DIRTY_CLEAN_MAX 0x00U
+
+static bool oled_dirty_page_clean(const oled_dirty_t* d, uint8_t p)
+{
+    return d->col_min[p] > d->col_max[p];
+}
+
+void oled_dirty_init(oled_dirty_t* d, uint8_t width, uint8_t pages)
+{
+    d->width = width;
+    d->pages = (pages < OLED_DIRTY_PAGE_MAX) ? pages : (uint8_t) OLED_DIRTY_PAGE_MAX;
+    oled_dirty_clear(d);
+}
+
+void oled_dirty_clear(oled_dirty_t* d)
+{
+    for (uint8_t p = 0; p < OLED_DIRTY_PAGE_MAX; p++)
+    {
+        d->col_min[p] = OLED_DIRTY_CLEAN_MIN;
+        d->col_max[p] = OLED_DIRTY_CLEAN_MAX;
+    }
+}
+
+bool oled_dirty_any(const oled_dirty_t* d)
+{
+    for (uint8_t p = 0; p < d->pages; p++)
+    {
+        if (!oled_dirty_page_clean(d, p))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void oled_dirty_mark(oled_dirty_t* d, uint8_t page_start, uint8_t page_end, uint8_t col_start, uint8_t col_end)
+{
+    if ((d->pages == 0U) || (d->width == 0U))
+    {
+        return;
+    }
+    if (page_end >= d->pages)
+    {
+        page_end = (uint8_t) (d->pages - 1U);
+    }
+    if (col_end >= d->width)
+    {
+        col_end = (uint8_t) (d->width - 1U);
+    }
+    if ((page_start > page_end) || (col_start > col_end))
+    {
+        return;
+    }
+
+    for (uint8_t p = page_start; p <= page_end; p++)
+    {
+        d->col_min[p] = (col_start < d->col_min[p]) ? col_start : d->col_min[p];
+        d->col_max[p] = (col_end > d->col_max[p]) ? col_end : d->col_max[p];
+    }
+}
+
+// ピクセル座標の矩形 (両端を含む、向きは問わない) が掛かるページと列
+void oled_dirty_mark_rect(oled_dirty_t* d, uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2)
+{
+    const uint8_t x_lo = (x1 < x2) ? x1 : x2;
+    const uint8_t x_hi = (x1 < x2) ? x2 : x1;
+    const uint8_t y_lo = (y1 < y2) ? y1 : y2;
+    const uint8_t y_hi = (y1 < y2) ? y2 : y1;
+
+    oled_dirty_mark(d, (uint8_t) (y_lo / 8U), (uint8_t) (y_hi / 8U), x_lo, x_hi);
+}
+
+// 送った窓に丸ごと入るページの範囲を消す (はみ出す所は残す)
+void oled_dirty_remove(oled_dirty_t* d, const oled_dirty_window_t* w)
+{
+    for (uint8_t p = w->page_start; (p <= w->page_end) && (p < d->pages); p++)
+    {
+        if (oled_dirty_page_clean(d, p))
+        {
+            continue;
+        }
+        if ((d->col_min[p] >= w->col_start) && (d->col_max[p] <= w->col_end))
+        {
+            d->col_min[p] = OLED_DIRTY_CLEAN_MIN;
+            d->col_max[p] = OLED_DIRTY_CLEAN_MAX;
+        }
+        else if ((d->col_min[p] >= w->col_start) && (d->col_min[p] <= w->col_end))
+        {
+            d->col_min[p] = (uint8_t) (w->col_end + 1U);
+        }
+        else if ((d->col_max[p] >= w->col_start) && (d->col_max[p] <= w->col_end))
+        {
+            d->col_max[p] = (uint8_t) (w->col_start - 1U);
+        }
+    }
+}
+
+// 表示中の内容 (shadow) と比べて、各ページの範囲を実際に違うバイトまで縮める
+void oled_dirty_narrow(oled_dirty_t* d, const uint8_t* fb, const uint8_t* shadow)
+{
+    for (uint8_t p = 0; p < d->pages; p++)
+    {
+        if (oled_dirty_page_clean(d, p))
+        {
+            continue;
+        }
+
+        const uint8_t* a = &fb[(uint16_t) p * d->width];
+        const uint8_t* b = &shadow[(uint16_t) p * d->width];
+        uint8_t lo       = d->col_min[p];
+        uint8_t hi       = d->col_max[p];
+
+        while ((lo <= hi) && (a[lo] == b[lo]))
+        {
+            lo++;
+        }
+        if (lo > hi)
+        {
+            d->col_min[p] = OLED_DIRTY_CLEAN_MIN;
+            d->col_max[p] = OLED_DIRTY_CLEAN_MAX;
+            continue;
+        }
+        while ((hi > lo) && (a[hi] == b[hi]))
+        {
+            hi--;
+        }
+        d->col_min[p] = lo;
+        d->col_max[p] = hi;
+    }
+}
+
+uint32_t oled_dirty_window_cost(const oled_dirty_window_t* w)
+{
+    const uint32_t pages = (uint32_t) (w->page_end - w->page_start + 1U);
+    const uint32_t cols  = (uint32_t) (w->col_end - w->col_start + 1U);
+    return OLED_DIRTY_XFER_COST + (pages * cols);
+}
+
+static oled_dirty_window_t oled_dirty_union(const oled_dirty_window_t* a, const oled_dirty_window_t* b)
+{
+    const oled_dirty_window_t u = {
+        .page_start = (a->page_start < b->page_start) ? a->page_start : b->page_start,
+        .page_end   = (a->page_end > b->page_end) ? a->page_end : b->page_end,
+        .col_start  = (a->col_start < b->col_start) ? a->col_start : b->col_start,
+        .col_end    = (a->col_end > b->col_end) ? a->col_end : b->col_end,
+    };
+    return u;
+}
+
+// ページ毎の範囲を 1 窓ずつから始め、隣り合う窓をまとめた方が安い (同じも含む) 間まとめる
+// それでも cap を超える時は、まとめて増える量が一番少ない組から無理にまとめる。窓の数を返す
+uint8_t oled_dirty_plan(const oled_dirty_t* d, oled_dirty_window_t* out, uint8_t cap)
+{
+    oled_dirty_window_t w[OLED_DIRTY_PAGE_MAX];
+    uint8_t n = 0;
+
+    if ((out == NULL) || (cap == 0U))
+    {
+        return 0;
+    }
+
+    for (uint8_t p = 0; p < d->pages; p++)
+    {
+        if (!oled_dirty_page_clean(d, p))
+        {
+            w[n].page_start = p;
+            w[n].page_end   = p;
+            w[n].col_start  = d->col_min[p];
+            w[n].col_end    = d->col_max[p];
+            n++;
+        }
+    }
+
+    while (n > 1U)
+    {
+        uint8_t best      = 0;
+        int32_t best_gain = INT32_MIN;
+
+        for (uint8_t i = 0; (uint8_t) (i + 1U) < n; i++)
+        {
+            const oled_dirty_window_t u = oled_dirty_union(&w[i], &w[i + 1U]);
+            const int32_t gain          = (int32_t) (oled_dirty_window_cost(&w[i]) + oled_dirty_window_cost(&w[i + 1U])) -
+                                 (int32_t) oled_dirty_window_cost(&u);
+            if (gain > best_gain)
+            {
+                best_gain = gain;
+                best      = i;
+            }
+        }
+        if ((best_gain < 0) && (n <= cap))
+        {
+            break;
+        }
+
+        w[best] = oled_dirty_union(&w[best], &w[best + 1U]);
+        for (uint8_t i = (uint8_t) (best + 1U); (uint8_t) (i + 1U) < n; i++)
+        {
+            w[i] = w[i + 1U];
+        }
+        n--;
+    }
+
+    for (uint8_t i = 0; i < n; i++)
+    {
+        out[i] = w[i];
+    }
+    return n;
+}
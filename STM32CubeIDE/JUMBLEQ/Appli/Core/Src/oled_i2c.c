@@ -0,0 +1,495 @@
+/*
+ * oled_i2c.c
+ *
+ *  Created on: Mar 18, 2026
+ */
+
+#include "oled_i2c.h"
+
+#include "i2c.h"
+#include "oled_dirty.h"
+
+#include "FreeRTOS.h"
+#include "cmsis_os2.h"
+
+#include <string.h>
+
+#define OLED_I2C_STATS_LOG       0  // 1秒毎にバスを使っていた時間、転送回数、バイト数を RTT に出す
+#define OLED_I2C_THREAD_FLAG     0x0001U
+#define OLED_I2C_XFER_TIMEOUT_MS 100U   // 旧実装のブロッキング送信と同じ
+#define OLED_I2C_CMD_LEN         13U    // (0x80, コマンド) x 6 + データ開始の 0x40
+#define OLED_I2C_CTRL_CMD        0x80U  // Co=1, D/C#=0: 次の 1 byte はコマンド
+#define OLED_I2C_CTRL_DATA       0x40U  // Co=0, D/C#=1: 以降は全部 GDDRAM へのデータ
+#define OLED_I2C_MAIN_FB_LEN     (OLED_I2C_MAIN_WIDTH * (OLED_I2C_MAIN_HEIGHT / 8U))
+#define OLED_I2C_SUB_FB_LEN      (OLED_I2C_SUB_WIDTH * (OLED_I2C_SUB_HEIGHT / 8U))
+#define OLED_I2C_BUF_SIZE        (OLED_I2C_CMD_LEN + ((OLED_I2C_MAIN_FB_LEN > OLED_I2C_SUB_FB_LEN) ? OLED_I2C_MAIN_FB_LEN : OLED_I2C_SUB_FB_LEN))
+
+extern osMutexId_t i2cMutexHandle;
+
+// まだ送っていない範囲 (ページ毎の列) と、表示中の内容の写し
+// フレームバッファは送り始める時に読むので、それまでの描画は全部載る
+typedef struct
+{
+    ssd1306_t* oled;  // 最初の submit で決まる (バス・アドレス・大きさ・fb はここから読む)
+    uint8_t* shadow;
+    uint16_t shadow_len;
+    oled_dirty_t dirty;
+    bool shadow_valid;  // 全画面を 1 回送るまでは表示の中身が分からないので、差分で縮めない
+    bool ready;
+    uint8_t shift_x;  // 焼き付き防止のずらし量 (パネル上の位置 = fb の位置 + shift)
+    uint8_t shift_y;
+} oled_i2c_dev_state_t;
+
+static uint8_t s_shadow_main[OLED_I2C_MAIN_FB_LEN];
+static uint8_t s_shadow_sub[OLED_I2C_SUB_FB_LEN];
+
+static oled_i2c_dev_state_t s_dev[OLED_I2C_DEV_NUM] = {
+    [OLED_I2C_MAIN] = {.shadow = s_shadow_main, .shadow_len = sizeof(s_shadow_main)},
+    [OLED_I2C_SUB]  = {.shadow = s_shadow_sub, .shadow_len = sizeof(s_shadow_sub)},
+};
+
+// 送信中の転送は 1 つだけ (i2cMutex が 2 本のバスで共通のため)
+static struct
+{
+    osThreadId_t owner;
+    uint32_t start_ms;
+    uint32_t start_cyc;
+    volatile uint32_t end_cyc;
+    oled_dirty_window_t win;
+    uint16_t len;
+    uint8_t dev;
+    bool busy;
+    volatile bool done;
+    volatile bool error;
+} s_xfer;
+
+static uint8_t s_next_dev = 0;
+
+__attribute__((section("noncacheable_buffer"), aligned(32))) static uint8_t s_xfer_buf[OLED_I2C_BUF_SIZE];
+
+#if OLED_I2C_STATS_LOG
+static struct
+{
+    uint32_t busy_cyc;
+    uint32_t xfers;
+    uint32_t bytes;
+    uint32_t errors;
+    uint32_t last_ms;
+} s_stats;
+#endif
+
+static bool oled_i2c_any_pending(void)
+{
+    for (uint8_t i = 0; i < OLED_I2C_DEV_NUM; i++)
+    {
+        if (oled_dirty_any(&s_dev[i].dirty))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static uint8_t oled_i2c_pages(const ssd1306_t* oled)
+{
+    return (uint8_t) (oled->height / 8U);
+}
+
+// 範囲をページ毎に広げて覚えておく (送るのは oled_i2c_run)
+void oled_i2c_submit(ssd1306_t* oled, uint8_t page_start, uint8_t page_end, uint8_t col_start, uint8_t col_end)
+{
+    if ((oled == NULL) || (oled->port >= OLED_I2C_DEV_NUM) || (oled->fb == NULL))
+    {
+        return;
+    }
+
+    oled_i2c_dev_state_t* st = &s_dev[oled->port];
+    if (!st->ready)
+    {
+        if (((uint16_t) oled->width * oled_i2c_pages(oled)) > st->shadow_len)
+        {
+            return;
+        }
+        oled_dirty_init(&st->dirty, oled->width, oled_i2c_pages(oled));
+        st->oled  = oled;
+        st->ready = true;
+    }
+    oled_dirty_mark(&st->dirty, page_start, page_end, col_start, col_end);
+}
+
+// 表示中の内容と同じバイトを除いてから、転送量が一番少なくなる窓の組を作り、最初の 1 つを返す
+static bool oled_i2c_next_window(uint8_t dev, oled_dirty_window_t* win)
+{
+    oled_i2c_dev_state_t* st = &s_dev[dev];
+    oled_dirty_window_t plan[OLED_DIRTY_PAGE_MAX];
+
+    if (!st->ready || !oled_dirty_any(&st->dirty))
+    {
+        return false;
+    }
+    if (st->shadow_valid)
+    {
+        oled_dirty_narrow(&st->dirty, st->oled->fb, st->shadow);
+    }
+    if (oled_dirty_plan(&st->dirty, plan, OLED_DIRTY_PAGE_MAX) == 0U)
+    {
+        return false;
+    }
+    *win = plan[0];
+    return true;
+}
+
+// ずらした時にパネルのページ page、列 x + shift_x に出る 1 byte (fb の外は消灯)
+static uint8_t oled_i2c_shifted_byte(const oled_i2c_dev_state_t* st, uint8_t page, int16_t x)
+{
+    const ssd1306_t* b = st->oled;
+
+    if (x < 0)
+    {
+        return 0U;
+    }
+    const uint8_t* col = &b->fb[x];
+    uint8_t v          = (uint8_t) (col[(uint16_t) page * b->width] << st->shift_y);
+    if ((st->shift_y != 0U) && (page != 0U))
+    {
+        v |= (uint8_t) (col[(uint16_t) (page - 1U) * b->width] >> (8U - st->shift_y));
+    }
+    return v;
+}
+
+// 列/ページのアドレス指定 (水平アドレッシングモード) とデータを 1 トランザクションに詰め、送った内容を shadow に写す
+// ずらしている時は窓をパネル上の位置に直す (右端/下端からはみ出た分は出さない。左端からの窓は空いた列も消す)
+static uint16_t oled_i2c_build(uint8_t dev, const oled_dirty_window_t* w)
+{
+    const oled_i2c_dev_state_t* st = &s_dev[dev];
+    const ssd1306_t* b             = st->oled;
+    const uint8_t last_col         = (uint8_t) (b->width - 1U);
+    const uint8_t last_page        = (uint8_t) (oled_i2c_pages(b) - 1U);
+    const bool shifted             = (st->shift_x != 0U) || (st->shift_y != 0U);
+    const uint16_t col_end         = (uint16_t) (w->col_end + st->shift_x);
+    const uint8_t pcol_end         = (col_end > last_col) ? last_col : (uint8_t) col_end;
+    const uint16_t col_start       = (w->col_start == 0U) ? 0U : (uint16_t) (w->col_start + st->shift_x);
+    const uint8_t pcol_start       = (col_start > pcol_end) ? pcol_end : (uint8_t) col_start;
+    const uint8_t ppage_end        = ((st->shift_y != 0U) && (w->page_end < last_page)) ? (uint8_t) (w->page_end + 1U) : w->page_end;
+    const uint8_t cmds[6]          = {
+        0x21U, (uint8_t) (pcol_start + b->x_offset), (uint8_t) (pcol_end + b->x_offset),
+        0x22U, w->page_start, ppage_end,
+    };
+    const uint16_t cols = (uint16_t) (w->col_end - w->col_start + 1U);
+    uint16_t n          = 0;
+
+    for (uint8_t i = 0; i < sizeof(cmds); i++)
+    {
+        s_xfer_buf[n++] = OLED_I2C_CTRL_CMD;
+        s_xfer_buf[n++] = cmds[i];
+    }
+    s_xfer_buf[n++] = OLED_I2C_CTRL_DATA;
+
+    for (uint8_t p = w->page_start; p <= ppage_end; p++)
+    {
+        const uint16_t offset = (uint16_t) ((uint16_t) p * b->width + w->col_start);
+        if (!shifted)
+        {
+            memcpy(&s_xfer_buf[n], &b->fb[offset], cols);
+            n = (uint16_t) (n + cols);
+        }
+        else
+        {
+            for (uint16_t c = pcol_start; c <= pcol_end; c++)
+            {
+                s_xfer_buf[n++] = oled_i2c_shifted_byte(st, p, (int16_t) c - st->shift_x);
+            }
+        }
+        if (p <= w->page_end)
+        {
+            memcpy(&st->shadow[offset], &b->fb[offset], cols);
+        }
+    }
+    return n;
+}
+
+// 表示の中身が分からなくなったので、次は全画面を送る
+static void oled_i2c_invalidate(uint8_t dev)
+{
+    oled_i2c_dev_state_t* st = &s_dev[dev];
+
+    st->shadow_valid = false;
+    oled_dirty_mark(&st->dirty, 0, 0xFFU, 0, 0xFFU);
+}
+
+// 表示全体をずらす (0 で元の位置)。次の転送で全画面を送り直す
+void oled_i2c_set_shift(ssd1306_t* oled, uint8_t dx, uint8_t dy)
+{
+    if ((oled == NULL) || (oled->port >= OLED_I2C_DEV_NUM))
+    {
+        return;
+    }
+
+    oled_i2c_dev_state_t* st = &s_dev[oled->port];
+    dy                       = (dy > 7U) ? 7U : dy;
+    if ((st->shift_x == dx) && (st->shift_y == dy))
+    {
+        return;
+    }
+    st->shift_x = dx;
+    st->shift_y = dy;
+    if (st->ready)
+    {
+        oled_i2c_invalidate(oled->port);
+    }
+}
+
+static bool oled_i2c_start(uint8_t dev, const oled_dirty_window_t* win)
+{
+    oled_i2c_dev_state_t* st = &s_dev[dev];
+    const ssd1306_t* b       = st->oled;
+
+    if ((i2cMutexHandle == NULL) || (osMutexAcquire(i2cMutexHandle, 0U) != osOK))
+    {
+        return false;
+    }
+
+    s_xfer.len       = oled_i2c_build(dev, win);
+    s_xfer.win       = *win;
+    s_xfer.dev       = dev;
+    s_xfer.owner     = osThreadGetId();
+    s_xfer.done      = false;
+    s_xfer.error     = false;
+    s_xfer.busy      = true;
+    s_xfer.start_ms  = HAL_GetTick();
+    s_xfer.start_cyc = DWT->CYCCNT;
+    oled_dirty_remove(&st->dirty, win);
+    if ((win->page_start == 0U) && (win->page_end == (uint8_t) (oled_i2c_pages(b) - 1U)) && (win->col_start == 0U) &&
+        (win->col_end == (uint8_t) (b->width - 1U)))
+    {
+        st->shadow_valid = true;
+    }
+    (void) osThreadFlagsClear(OLED_I2C_THREAD_FLAG);
+
+    if (HAL_I2C_Master_Transmit_DMA((I2C_HandleTypeDef*) b->bus, b->addr, s_xfer_buf, s_xfer.len) != HAL_OK)
+    {
+        s_xfer.busy = false;
+        oled_i2c_invalidate(dev);
+        osMutexRelease(i2cMutexHandle);
+        return false;
+    }
+    return true;
+}
+
+// 送信中の転送が終わっていれば (またはタイムアウトしたら) ミューテックスを返す。もう送信中でなければ true
+static bool oled_i2c_reap(void)
+{
+    if (!s_xfer.busy)
+    {
+        return true;
+    }
+
+    if (!s_xfer.done)
+    {
+        if ((HAL_GetTick() - s_xfer.start_ms) < OLED_I2C_XFER_TIMEOUT_MS)
+        {
+            return false;
+        }
+        const ssd1306_t* b      = s_dev[s_xfer.dev].oled;
+        I2C_HandleTypeDef* hi2c = (I2C_HandleTypeDef*) b->bus;
+        (void) HAL_DMA_Abort(hi2c->hdmatx);
+        (void) HAL_I2C_Master_Abort_IT(hi2c, b->addr);
+        s_xfer.error   = true;
+        s_xfer.end_cyc = DWT->CYCCNT;
+    }
+
+    if (s_xfer.error)
+    {
+        oled_i2c_invalidate(s_xfer.dev);
+    }
+#if OLED_I2C_STATS_LOG
+    s_stats.busy_cyc += s_xfer.end_cyc - s_xfer.start_cyc;
+    s_stats.xfers++;
+    s_stats.bytes += s_xfer.len;
+    if (s_xfer.error)
+    {
+        s_stats.errors++;
+    }
+#endif
+    s_xfer.busy = false;
+    osMutexRelease(i2cMutexHandle);
+    return true;
+}
+
+static void oled_i2c_poll(void)
+{
+    if (!oled_i2c_reap())
+    {
+        return;
+    }
+
+    // 2 枚が交互に送れるように順番に見る
+    for (uint8_t i = 0; i < OLED_I2C_DEV_NUM; i++)
+    {
+        const uint8_t dev = (uint8_t) ((s_next_dev + i) % OLED_I2C_DEV_NUM);
+        oled_dirty_window_t win;
+
+        if (!oled_i2c_next_window(dev, &win))
+        {
+            continue;
+        }
+        if (oled_i2c_start(dev, &win))
+        {
+            s_next_dev = (uint8_t) ((dev + 1U) % OLED_I2C_DEV_NUM);
+        }
+        return;
+    }
+}
+
+#if OLED_I2C_STATS_LOG
+static void oled_i2c_stats_report(void)
+{
+    const uint32_t now = HAL_GetTick();
+
+    if ((now - s_stats.last_ms) < 1000U)
+    {
+        return;
+    }
+    const uint32_t cyc_per_us = SystemCoreClock / 1000000UL;
+    SEGGER_RTT_printf(0, "[OLED I2C] busy=%lu us/s xfers=%lu bytes=%lu err=%lu\n",
+                      (unsigned long) ((cyc_per_us != 0U) ? (s_stats.busy_cyc / cyc_per_us) : 0U), (unsigned long) s_stats.xfers,
+                      (unsigned long) s_stats.bytes, (unsigned long) s_stats.errors);
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_stats.last_ms = now;
+}
+#endif
+
+// budget_ms の間キューを回す (oledTask の周期待ちの代わり)。転送中は完了の通知を待って CPU を空ける
+void oled_i2c_run(uint32_t budget_ms)
+{
+    const uint32_t start = HAL_GetTick();
+
+    for (;;)
+    {
+        oled_i2c_poll();
+
+        const uint32_t elapsed = HAL_GetTick() - start;
+        if (elapsed >= budget_ms)
+        {
+            break;
+        }
+        const uint32_t left = budget_ms - elapsed;
+
+        if (s_xfer.busy)
+        {
+            (void) osThreadFlagsWait(OLED_I2C_THREAD_FLAG, osFlagsWaitAny, left);
+        }
+        else if (oled_i2c_any_pending())
+        {
+            osDelay(1);  // 他のタスクがバスを使っている
+        }
+        else
+        {
+            osDelay(left);
+            break;
+        }
+    }
+
+#if OLED_I2C_STATS_LOG
+    oled_i2c_stats_report();
+#endif
+}
+
+// 溜まっている範囲を全部送り終わるまで待つ (起動画面など、すぐ表示したい時)
+bool oled_i2c_flush(uint32_t timeout_ms)
+{
+    const uint32_t start = HAL_GetTick();
+
+    while (s_xfer.busy || oled_i2c_any_pending())
+    {
+        const uint32_t elapsed = HAL_GetTick() - start;
+        if (elapsed >= timeout_ms)
+        {
+            return false;
+        }
+        oled_i2c_run(1U);
+    }
+    return true;
+}
+
+// 送信中の転送だけ終わるのを待つ (ドライバのブロッキング送信の前に呼ぶ)
+bool oled_i2c_wait_idle(uint32_t timeout_ms)
+{
+    const uint32_t start = HAL_GetTick();
+
+    while (!oled_i2c_reap())
+    {
+        const uint32_t elapsed = HAL_GetTick() - start;
+        if (elapsed >= timeout_ms)
+        {
+            return false;
+        }
+        (void) osThreadFlagsWait(OLED_I2C_THREAD_FLAG, osFlagsWaitAny, timeout_ms - elapsed);
+    }
+    return true;
+}
+
+// ssd1306_t の転送方法
+// コマンドはブロッキングで送る (DMA 転送キューが送信中ならミューテックスを持っているので、終わるまで待つ)
+static void oled_i2c_command(ssd1306_t* oled, uint8_t byte)
+{
+    static uint8_t cmd_byte;
+
+    if (i2cMutexHandle == NULL)
+    {
+        return;
+    }
+
+    (void) oled_i2c_wait_idle(200);
+
+    if (osMutexAcquire(i2cMutexHandle, pdMS_TO_TICKS(200)) == osOK)
+    {
+        cmd_byte = byte;
+        (void) HAL_I2C_Mem_Write((I2C_HandleTypeDef*) oled->bus, oled->addr, 0x00, 1, &cmd_byte, 1, 100);
+        osMutexRelease(i2cMutexHandle);
+    }
+}
+
+static void oled_i2c_reset(ssd1306_t* oled)
+{
+    (void) oled;
+
+    // I2C はリセット線がないので起動を待つだけ
+    HAL_Delay(100);
+}
+
+static bool oled_i2c_ops_flush(ssd1306_t* oled, uint32_t timeout_ms)
+{
+    (void) oled;
+
+    return oled_i2c_flush(timeout_ms);
+}
+
+const ssd1306_ops_t oled_i2c_ops = {
+    .reset   = oled_i2c_reset,
+    .command = oled_i2c_command,
+    .update  = oled_i2c_submit,
+    .flush   = oled_i2c_ops_flush,
+};
+
+static void oled_i2c_xfer_done(I2C_HandleTypeDef* hi2c, bool error)
+{
+    if (!s_xfer.busy || s_xfer.done || (hi2c != (I2C_HandleTypeDef*) s_dev[s_xfer.dev].oled->bus))
+    {
+        return;
+    }
+    s_xfer.end_cyc = DWT->CYCCNT;
+    s_xfer.error   = error;
+    s_xfer.done    = true;
+    (void) osThreadFlagsSet(s_xfer.owner, OLED_I2C_THREAD_FLAG);
+}
+
+void HAL_I2C_MasterTxCpltCallback(I2C_HandleTypeDef* hi2c)
+{
+    oled_i2c_xfer_done(hi2c, false);
+}
+
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef* hi2c)
+{
+    oled_i2c_xfer_done(hi2c, true);
+}
@@ -0,0 +1,340 @@
+/*
+ * oled_menu.c
+ *
+ *  Created on: Mar 21, 2026
+ */
+
+#include "oled_menu.h"
+
+#include "ssd1306_fonts.h"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#define OLED_MENU_ROW_H  8U  // Font_6x8
+#define OLED_MENU_CHAR_W 6U
+
+static oled_menu_level_t* oled_menu_level(oled_menu_t* m)
+{
+    return &m->stack[m->depth - 1U];
+}
+
+static const oled_menu_level_t* oled_menu_level_const(const oled_menu_t* m)
+{
+    return &m->stack[m->depth - 1U];
+}
+
+static bool oled_menu_has_value(const oled_menu_t* m, const oled_menu_item_t* item)
+{
+    return ((item->kind == OLED_MENU_ENUM) || (item->kind == OLED_MENU_INT)) && (m->cfg != NULL) && (item->field < m->cfg_len);
+}
+
+// ENUM の今の値が names の何番目か (values に無い値は 0 番目として扱う)
+static uint8_t oled_menu_enum_index(const oled_menu_t* m, const oled_menu_item_t* item)
+{
+    const uint8_t v = m->cfg[item->field];
+
+    if (item->values == NULL)
+    {
+        return (v <= item->max) ? v : 0U;
+    }
+    for (uint8_t i = 0; i <= item->max; i++)
+    {
+        if (item->values[i] == v)
+        {
+            return i;
+        }
+    }
+    return 0U;
+}
+
+static void oled_menu_write(oled_menu_t* m, const oled_menu_item_t* item, uint8_t v)
+{
+    if (m->cfg[item->field] == v)
+    {
+        return;
+    }
+    m->cfg[item->field] = v;
+    m->changed          = true;
+    if (m->on_change != NULL)
+    {
+        m->on_change(m->ctx, item);
+    }
+}
+
+// 編集中の値を n 段動かす。wrap = false なら端で止める
+static void oled_menu_step_value(oled_menu_t* m, const oled_menu_item_t* item, int32_t n, bool wrap)
+{
+    if (item->kind == OLED_MENU_ENUM)
+    {
+        const int32_t num = (int32_t) item->max + 1;
+        int32_t idx       = (int32_t) oled_menu_enum_index(m, item) + n;
+
+        if (wrap)
+        {
+            idx = ((idx % num) + num) % num;
+        }
+        else
+        {
+            idx = (idx < 0) ? 0 : ((idx >= num) ? (num - 1) : idx);
+        }
+        oled_menu_write(m, item, (item->values != NULL) ? item->values[idx] : (uint8_t) idx);
+    }
+    else
+    {
+        const int32_t step = (item->step != 0U) ? item->step : 1;
+        int32_t v          = (int32_t) m->cfg[item->field] + (n * step);
+
+        v = (v < item->min) ? item->min : ((v > item->max) ? item->max : v);
+        oled_menu_write(m, item, (uint8_t) v);
+    }
+}
+
+static void oled_menu_move_cursor(oled_menu_t* m, int32_t n, bool wrap)
+{
+    oled_menu_level_t* lv = oled_menu_level(m);
+    const int32_t num     = lv->page->num;
+    int32_t c             = (int32_t) lv->cursor + n;
+
+    if (num == 0)
+    {
+        return;
+    }
+    if (wrap)
+    {
+        c = ((c % num) + num) % num;
+    }
+    else
+    {
+        c = (c < 0) ? 0 : ((c >= num) ? (num - 1) : c);
+    }
+    lv->cursor = (uint8_t) c;
+}
+
+static void oled_menu_push(oled_menu_t* m, const oled_menu_page_t* page)
+{
+    if ((page == NULL) || (m->depth >= OLED_MENU_DEPTH_MAX))
+    {
+        return;
+    }
+    m->stack[m->depth].page   = page;
+    m->stack[m->depth].cursor = 0;
+    m->stack[m->depth].top    = 0;
+    m->depth++;
+    m->pot_valid = false;
+}
+
+void oled_menu_open(oled_menu_t* m, const oled_menu_page_t* root, uint8_t* cfg, uint8_t cfg_len)
+{
+    m->depth   = 0;
+    m->editing = false;
+    m->cfg     = cfg;
+    m->cfg_len = cfg_len;
+    m->changed = false;
+    m->redraw  = true;
+    oled_menu_push(m, root);
+}
+
+void oled_menu_close(oled_menu_t* m)
+{
+    m->depth   = 0;
+    m->editing = false;
+    m->redraw  = true;
+}
+
+bool oled_menu_is_open(const oled_menu_t* m)
+{
+    return m->depth != 0U;
+}
+
+const oled_menu_item_t* oled_menu_current(const oled_menu_t* m)
+{
+    if (!oled_menu_is_open(m))
+    {
+        return NULL;
+    }
+    const oled_menu_level_t* lv = oled_menu_level_const(m);
+    return (lv->cursor < lv->page->num) ? &lv->page->items[lv->cursor] : NULL;
+}
+
+void oled_menu_key(oled_menu_t* m, uint8_t key)
+{
+    const oled_menu_item_t* item = oled_menu_current(m);
+
+    if (!oled_menu_is_open(m))
+    {
+        return;
+    }
+    m->redraw = true;
+
+    switch (key)
+    {
+    case OLED_MENU_KEY_NEXT:
+    case OLED_MENU_KEY_PREV:
+    {
+        const int32_t n = (key == OLED_MENU_KEY_NEXT) ? 1 : -1;
+        if (m->editing && (item != NULL))
+        {
+            oled_menu_step_value(m, item, n, item->kind == OLED_MENU_ENUM);
+        }
+        else
+        {
+            oled_menu_move_cursor(m, n, true);
+        }
+        break;
+    }
+
+    case OLED_MENU_KEY_ENTER:
+        if (item == NULL)
+        {
+            break;
+        }
+        if (m->editing)
+        {
+            m->editing   = false;
+            m->pot_valid = false;
+        }
+        else if (oled_menu_has_value(m, item))
+        {
+            m->editing   = true;
+            m->edit_orig = m->cfg[item->field];
+            m->pot_valid = false;
+        }
+        else if (item->kind == OLED_MENU_SUBMENU)
+        {
+            oled_menu_push(m, item->sub);
+        }
+        else if ((item->kind == OLED_MENU_ACTION) && (m->on_action != NULL))
+        {
+            (void) m->on_action(m->ctx, item->action);
+        }
+        break;
+
+    case OLED_MENU_KEY_BACK:
+        if (m->editing)
+        {
+            m->editing   = false;
+            m->pot_valid = false;
+            if (item != NULL)
+            {
+                oled_menu_write(m, item, m->edit_orig);
+            }
+        }
+        else
+        {
+            m->depth--;
+            m->pot_valid = false;
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+// ポットの位置 (0..full) が 1 段分動く毎に、カーソルか編集中の値を動かす。端では回り込まない
+void oled_menu_pot(oled_menu_t* m, uint16_t pos, uint16_t full)
+{
+    const int32_t detent = ((int32_t) full + 1) / (int32_t) OLED_MENU_POT_DETENTS;
+    const int32_t step   = (detent > 0) ? detent : 1;
+
+    if (!oled_menu_is_open(m))
+    {
+        return;
+    }
+    if (!m->pot_valid)
+    {
+        m->pot_ref   = pos;
+        m->pot_valid = true;
+        return;
+    }
+
+    const int32_t n = ((int32_t) pos - m->pot_ref) / step;
+    if (n == 0)
+    {
+        return;
+    }
+    m->pot_ref += n * step;
+    m->redraw = true;
+
+    const oled_menu_item_t* item = oled_menu_current(m);
+    if (m->editing && (item != NULL))
+    {
+        oled_menu_step_value(m, item, n, false);
+    }
+    else
+    {
+        oled_menu_move_cursor(m, n, false);
+    }
+}
+
+const char* oled_menu_value_str(const oled_menu_t* m, const oled_menu_item_t* item, char* buf, uint8_t len)
+{
+    if (!oled_menu_has_value(m, item))
+    {
+        return (item->kind == OLED_MENU_SUBMENU) ? ">" : "";
+    }
+    if (item->kind == OLED_MENU_ENUM)
+    {
+        return item->names[oled_menu_enum_index(m, item)];
+    }
+    snprintf(buf, len, "%u", (unsigned) m->cfg[item->field]);
+    return buf;
+}
+
+// 1 行目にページ名、残りの行に項目。選んでいる行は反転、編集中は値だけ反転する
+// 変わった時だけ全部描き直す (送るのは表示中と違うバイトだけ)。描いたら true
+bool oled_menu_draw(oled_menu_t* m, ssd1306_t* d)
+{
+    if (!m->redraw)
+    {
+        return false;
+    }
+    m->redraw = false;
+
+    ssd1306_Fill(d, Black);
+    if (!oled_menu_is_open(m))
+    {
+        return true;
+    }
+
+    oled_menu_level_t* lv = oled_menu_level(m);
+    const uint8_t rows    = (uint8_t) ((d->height / OLED_MENU_ROW_H) - 1U);
+
+    if (lv->cursor < lv->top)
+    {
+        lv->top = lv->cursor;
+    }
+    else if (lv->cursor >= (uint8_t) (lv->top + rows))
+    {
+        lv->top = (uint8_t) (lv->cursor - rows + 1U);
+    }
+
+    ssd1306_SetCursor(d, 0, 0);
+    ssd1306_WriteString(d, lv->page->title, Font_6x8, White);
+    ssd1306_InvertRectangle(d, 0, 0, (uint8_t) (d->width - 1U), OLED_MENU_ROW_H - 1U);
+
+    for (uint8_t r = 0; (r < rows) && ((uint8_t) (lv->top + r) < lv->page->num); r++)
+    {
+        const uint8_t idx            = (uint8_t) (lv->top + r);
+        const oled_menu_item_t* item = &lv->page->items[idx];
+        const uint8_t y              = (uint8_t) ((r + 1U) * OLED_MENU_ROW_H);
+        char buf[8];
+        const char* val  = oled_menu_value_str(m, item, buf, sizeof(buf));
+        const size_t vlen = strlen(val);
+        const uint8_t vx  = (vlen * OLED_MENU_CHAR_W < d->width) ? (uint8_t) (d->width - vlen * OLED_MENU_CHAR_W) : 0U;
+
+        ssd1306_SetCursor(d, 0, y);
+        ssd1306_WriteString(d, item->label, Font_6x8, White);
+        ssd1306_SetCursor(d, vx, y);
+        ssd1306_WriteString(d, val, Font_6x8, White);
+
+        if (idx == lv->cursor)
+        {
+            const uint8_t x1 = (m->editing && (vlen != 0U)) ? (uint8_t) ((vx != 0U) ? (vx - 1U) : 0U) : 0U;
+            ssd1306_InvertRectangle(d, x1, y, (uint8_t) (d->width - 1U), (uint8_t) (y + OLED_MENU_ROW_H - 1U));
+        }
+    }
+    return true;
+}
@@ -0,0 +1,159 @@
+/*
+ * oled_sched.c
+ *
+ *  Created on: Mar 22, 2026
+ */
+
+#include "oled_sched.h"
+
+#include "oled_dirty.h"
+
+#include <stddef.h>
+#include <string.h>
+
+void oled_sched_init(oled_sched_t* s, uint16_t budget)
+{
+    memset(s, 0, sizeof(*s));
+    s->budget = budget;
+}
+
+// ページ単位で送るので、縦はページの境目まで広げて数える
+uint16_t oled_sched_cost(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2)
+{
+    if ((x1 > x2) || (y1 > y2))
+    {
+        return 0U;
+    }
+    const uint16_t pages = (uint16_t) ((y2 / 8U) - (y1 / 8U) + 1U);
+    return (uint16_t) (pages * (uint16_t) (x2 - x1 + 1U) + OLED_DIRTY_XFER_COST);
+}
+
+uint8_t oled_sched_add(oled_sched_t* s, const oled_sched_region_def_t* def)
+{
+    if ((def == NULL) || (s->num >= OLED_SCHED_REGION_MAX))
+    {
+        return OLED_SCHED_REGION_MAX;
+    }
+
+    oled_sched_region_t* r = &s->region[s->num];
+    r->def                 = def;
+    r->cost                = oled_sched_cost(def->x1, def->y1, def->x2, def->y2);
+    r->pending             = false;
+    r->deferred            = false;
+    r->last_ms             = 0U - def->period_ms;  // 最初の 1 回はすぐ描けるように
+    return s->num++;
+}
+
+void oled_sched_post(oled_sched_t* s, uint8_t region)
+{
+    if (region >= s->num)
+    {
+        return;
+    }
+    if (s->region[region].pending)
+    {
+        s->stats.coalesced++;
+    }
+    s->region[region].pending = true;
+}
+
+// 画面ごと描き直した時など、待っている値を捨てる
+void oled_sched_cancel(oled_sched_t* s, uint8_t region)
+{
+    if (region < s->num)
+    {
+        s->region[region].pending  = false;
+        s->region[region].deferred = false;
+    }
+}
+
+bool oled_sched_pending(const oled_sched_t* s, uint8_t region)
+{
+    return (region < s->num) && s->region[region].pending;
+}
+
+static bool oled_sched_due(const oled_sched_region_t* r, uint32_t now)
+{
+    return r->pending && ((now - r->last_ms) >= r->def->period_ms);
+}
+
+// due の中で一番長く待っている領域 (deferred_only なら前のフレームで回されたものだけ)
+static uint8_t oled_sched_oldest(const oled_sched_t* s, uint32_t now, const bool* picked, uint8_t prio, bool deferred_only)
+{
+    uint8_t best = OLED_SCHED_REGION_MAX;
+
+    for (uint8_t i = 0; i < s->num; i++)
+    {
+        const oled_sched_region_t* r = &s->region[i];
+        if (picked[i] || !oled_sched_due(r, now) || (deferred_only ? !r->deferred : (r->def->prio != prio)))
+        {
+            continue;
+        }
+        if ((best == OLED_SCHED_REGION_MAX) || ((now - r->last_ms) > (now - s->region[best].last_ms)))
+        {
+            best = i;
+        }
+    }
+    return best;
+}
+
+static void oled_sched_take(oled_sched_region_t* r, uint32_t now)
+{
+    r->pending  = false;
+    r->deferred = false;
+    r->last_ms  = now;
+}
+
+uint8_t oled_sched_frame(oled_sched_t* s, uint32_t now, uint8_t* out, uint8_t cap)
+{
+    bool picked[OLED_SCHED_REGION_MAX] = {false};
+    uint32_t used                      = 0;
+    uint8_t n                          = 0;
+
+    s->stats.frames++;
+
+    // 前のフレームで回された領域を 1 つだけ先に (フレームの最初なので予算を超えても描く)
+    const uint8_t first = oled_sched_oldest(s, now, picked, 0U, true);
+    if ((first != OLED_SCHED_REGION_MAX) && (cap != 0U))
+    {
+        picked[first] = true;
+        used          = s->region[first].cost;
+        oled_sched_take(&s->region[first], now);
+        out[n++] = first;
+    }
+
+    for (uint8_t prio = 0; prio < OLED_SCHED_PRIO_NUM; prio++)
+    {
+        for (;;)
+        {
+            // 同じ優先度の中では一番長く待っている領域から
+            const uint8_t best = oled_sched_oldest(s, now, picked, prio, false);
+            if (best == OLED_SCHED_REGION_MAX)
+            {
+                break;
+            }
+            picked[best] = true;
+
+            oled_sched_region_t* r = &s->region[best];
+            if ((n >= cap) || ((n != 0U) && ((used + r->cost) > s->budget)))
+            {
+                s->stats.deferred++;
+                r->deferred = true;
+                continue;
+            }
+            used += r->cost;
+            oled_sched_take(r, now);
+            out[n++] = best;
+        }
+    }
+
+    s->stats.drawn += n;
+    s->stats.bytes += used;
+    return n;
+}
+
+void oled_sched_take_stats(oled_sched_t* s, oled_sched_stats_t* out)
+{
+    *out = s->stats;
+    memset(&s->stats, 0, sizeof(s->stats));
+}
@@ -0,0 +1,300 @@
+/*
+ * oled_widget.c
+ *
+ *  Created on: Mar 20, 2026
+ */
+
+#include "oled_widget.h"
+
+#include <stddef.h>
+#include <string.h>
+
+// 行 lo..hi (両端を含む) のビット
+static uint64_t oled_widget_bits(uint8_t lo, uint8_t hi)
+{
+    if ((lo > hi) || (lo >= OLED_WIDGET_HEIGHT_MAX))
+    {
+        return 0U;
+    }
+    const uint64_t upto = (hi >= 63U) ? ~(uint64_t) 0U : ((((uint64_t) 1U) << (hi + 1U)) - 1U);
+    return upto & ~((((uint64_t) 1U) << lo) - 1U);
+}
+
+static uint8_t oled_widget_scale(uint8_t value, uint8_t span)
+{
+    return (uint8_t) (((uint32_t) value * span + (OLED_WIDGET_LEVEL_MAX / 2U)) / OLED_WIDGET_LEVEL_MAX);
+}
+
+// 列 x の y から h 行を bits (bit i = y + i 行目) で置き換える。ページ毎に 1 byte ずつ書く
+void oled_canvas_column(const oled_canvas_t* c, uint8_t x, uint8_t y, uint8_t h, uint64_t bits)
+{
+    if ((x >= c->width) || (y >= c->height) || (h == 0U))
+    {
+        return;
+    }
+    if ((uint16_t) (y + h) > c->height)
+    {
+        h = (uint8_t) (c->height - y);
+    }
+    if (h > OLED_WIDGET_HEIGHT_MAX)
+    {
+        h = OLED_WIDGET_HEIGHT_MAX;
+    }
+
+    const uint64_t area  = oled_widget_bits(0, (uint8_t) (h - 1U));
+    const uint8_t last_y = (uint8_t) (y + h - 1U);
+    bits &= area;
+
+    for (uint8_t p = (uint8_t) (y / 8U); p <= (uint8_t) (last_y / 8U); p++)
+    {
+        const uint8_t top = (uint8_t) (p * 8U);
+        uint8_t mask;
+        uint8_t val;
+
+        if (top >= y)
+        {
+            mask = (uint8_t) (area >> (top - y));
+            val  = (uint8_t) (bits >> (top - y));
+        }
+        else
+        {
+            mask = (uint8_t) (area << (y - top));
+            val  = (uint8_t) (bits << (y - top));
+        }
+
+        uint8_t* b        = &c->fb[(uint16_t) p * c->width + x];
+        const uint8_t now = (uint8_t) ((*b & (uint8_t) ~mask) | (val & mask));
+        if (now != *b)
+        {
+            *b = now;
+            if (c->dirty != NULL)
+            {
+                oled_dirty_mark(c->dirty, p, p, x, x);
+            }
+        }
+    }
+}
+
+void oled_canvas_fill(const oled_canvas_t* c, uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, bool on)
+{
+    if ((x1 > x2) || (y1 > y2))
+    {
+        return;
+    }
+
+    const uint8_t h = (uint8_t) (y2 - y1 + 1U);
+    for (uint16_t x = x1; x <= x2; x++)
+    {
+        oled_canvas_column(c, (uint8_t) x, y1, h, on ? ~(uint64_t) 0U : 0U);
+    }
+}
+
+// floor_db..0dBFS を 0..255 に
+uint8_t oled_widget_db_to_level(float db, float floor_db)
+{
+    if ((floor_db >= 0.0f) || (db <= floor_db))
+    {
+        return 0U;
+    }
+    if (db >= 0.0f)
+    {
+        return (uint8_t) OLED_WIDGET_LEVEL_MAX;
+    }
+    return (uint8_t) ((db - floor_db) * (float) OLED_WIDGET_LEVEL_MAX / -floor_db + 0.5f);
+}
+
+void oled_peak_update(oled_peak_t* p, uint8_t value, uint32_t now, uint16_t hold_ms, uint16_t fall_per_s)
+{
+    if (value >= p->value)
+    {
+        p->value = value;
+        p->held  = value;
+        p->tick  = now;
+        return;
+    }
+
+    const uint32_t elapsed = now - p->tick;
+    if (elapsed <= hold_ms)
+    {
+        return;
+    }
+
+    const uint32_t fall = ((elapsed - hold_ms) * fall_per_s) / 1000U;
+    if ((fall >= p->held) || ((uint32_t) (p->held - fall) <= value))
+    {
+        // 入力まで下がったらそこから持ち直す
+        p->value = value;
+        p->held  = value;
+        p->tick  = now;
+    }
+    else
+    {
+        p->value = (uint8_t) (p->held - fall);
+    }
+}
+
+void oled_meter_init(oled_meter_t* m, const oled_meter_def_t* def)
+{
+    memset(m, 0, sizeof(*m));
+    m->def = def;
+}
+
+void oled_meter_update(oled_meter_t* m, uint8_t value, uint32_t now)
+{
+    m->level = value;
+    oled_peak_update(&m->peak, value, now, m->def->hold_ms, m->def->fall_per_s);
+}
+
+static void oled_meter_put(const oled_meter_t* m, const oled_canvas_t* c, uint8_t col, uint8_t len, uint8_t peak)
+{
+    const bool on = (col < len) || ((peak != 0U) && (col == (uint8_t) (peak - 1U)));
+
+    if (col < m->def->w)
+    {
+        oled_canvas_column(c, (uint8_t) (m->def->x + col), m->def->y, m->def->h, on ? ~(uint64_t) 0U : 0U);
+    }
+}
+
+// 前回と違う列 (バーの端の間と、新旧のピーク) だけ描き直す
+void oled_meter_draw(oled_meter_t* m, const oled_canvas_t* c)
+{
+    const oled_meter_def_t* d = m->def;
+    const uint8_t len         = oled_widget_scale(m->level, d->w);
+    const uint8_t peak        = oled_widget_scale(m->peak.value, d->w);
+
+    if (!m->drawn)
+    {
+        for (uint8_t col = 0; col < d->w; col++)
+        {
+            oled_meter_put(m, c, col, len, peak);
+        }
+    }
+    else
+    {
+        const uint8_t lo = (len < m->drawn_len) ? len : m->drawn_len;
+        const uint8_t hi = (len < m->drawn_len) ? m->drawn_len : len;
+        for (uint8_t col = lo; col < hi; col++)
+        {
+            oled_meter_put(m, c, col, len, peak);
+        }
+        if ((m->drawn_peak != peak) && (m->drawn_peak != 0U))
+        {
+            oled_meter_put(m, c, (uint8_t) (m->drawn_peak - 1U), len, peak);
+        }
+        if (peak != 0U)
+        {
+            oled_meter_put(m, c, (uint8_t) (peak - 1U), len, peak);
+        }
+    }
+
+    m->drawn_len  = len;
+    m->drawn_peak = peak;
+    m->drawn      = true;
+}
+
+void oled_graph_init(oled_graph_t* g, uint8_t x, uint8_t y, uint8_t w, uint8_t h)
+{
+    memset(g, 0, sizeof(*g));
+    g->x       = x;
+    g->y       = y;
+    g->w       = (w < OLED_GRAPH_WIDTH_MAX) ? w : (uint8_t) OLED_GRAPH_WIDTH_MAX;
+    g->h       = (h < OLED_WIDGET_HEIGHT_MAX) ? h : (uint8_t) OLED_WIDGET_HEIGHT_MAX;
+    g->changed = true;
+}
+
+void oled_graph_push(oled_graph_t* g, uint8_t value)
+{
+    if (g->w == 0U)
+    {
+        return;
+    }
+    g->hist[g->head] = value;
+    g->head          = (uint8_t) ((g->head + 1U) % g->w);
+    g->changed       = true;
+}
+
+// 流れるので全列を描き直す (変わらないバイトは dirty にならない)。隣の点と縦線でつなぐ
+void oled_graph_draw(oled_graph_t* g, const oled_canvas_t* c)
+{
+    if (!g->changed || (g->h == 0U))
+    {
+        return;
+    }
+
+    const uint8_t bottom = (uint8_t) (g->h - 1U);
+    uint8_t prev         = 0;
+
+    for (uint8_t i = 0; i < g->w; i++)
+    {
+        const uint8_t v   = g->hist[(g->head + i) % g->w];
+        const uint8_t row = (uint8_t) (bottom - oled_widget_scale(v, bottom));
+        if (i == 0U)
+        {
+            prev = row;
+        }
+
+        const uint8_t lo = (row < prev) ? row : prev;
+        const uint8_t hi = (row < prev) ? prev : row;
+        oled_canvas_column(c, (uint8_t) (g->x + i), g->y, g->h, oled_widget_bits(lo, hi));
+        prev = row;
+    }
+    g->changed = false;
+}
+
+void oled_spectrum_init(oled_spectrum_t* s, const oled_spectrum_def_t* def)
+{
+    memset(s, 0, sizeof(*s));
+    s->def = def;
+}
+
+// バーは上がる時はすぐ、下がる時は fall_per_s で
+void oled_spectrum_update(oled_spectrum_t* s, const uint8_t* values, uint32_t now)
+{
+    const oled_spectrum_def_t* d = s->def;
+    const uint32_t fall          = ((now - s->tick) * d->fall_per_s) / 1000U;
+    const uint8_t bands          = (d->bands < OLED_SPECTRUM_BAND_MAX) ? d->bands : (uint8_t) OLED_SPECTRUM_BAND_MAX;
+
+    for (uint8_t b = 0; b < bands; b++)
+    {
+        const uint8_t fallen = (fall >= s->level[b]) ? 0U : (uint8_t) (s->level[b] - fall);
+        s->level[b]          = (values[b] > fallen) ? values[b] : fallen;
+        oled_peak_update(&s->peak[b], values[b], now, d->hold_ms, d->fall_per_s);
+    }
+    s->tick = now;
+}
+
+void oled_spectrum_draw(oled_spectrum_t* s, const oled_canvas_t* c)
+{
+    const oled_spectrum_def_t* d = s->def;
+    const uint8_t bands          = (d->bands < OLED_SPECTRUM_BAND_MAX) ? d->bands : (uint8_t) OLED_SPECTRUM_BAND_MAX;
+
+    if (d->h == 0U)
+    {
+        return;
+    }
+
+    for (uint8_t b = 0; b < bands; b++)
+    {
+        const uint8_t len  = oled_widget_scale(s->level[b], d->h);
+        const uint8_t peak = oled_widget_scale(s->peak[b].value, d->h);
+        if (s->drawn && (len == s->drawn_len[b]) && (peak == s->drawn_peak[b]))
+        {
+            continue;
+        }
+
+        uint64_t bits = (len != 0U) ? oled_widget_bits((uint8_t) (d->h - len), (uint8_t) (d->h - 1U)) : 0U;
+        if (peak != 0U)
+        {
+            bits |= oled_widget_bits((uint8_t) (d->h - peak), (uint8_t) (d->h - peak));
+        }
+
+        const uint8_t x0 = (uint8_t) (d->x + b * (d->band_w + 1U));
+        for (uint8_t k = 0; k < d->band_w; k++)
+        {
+            oled_canvas_column(c, (uint8_t) (x0 + k), d->y, d->h, bits);
+        }
+        s->drawn_len[b]  = len;
+        s->drawn_peak[b] = peak;
+    }
+    s->drawn = true;
+}
@@ -0,0 +1,116 @@
+/*
+ * pot_filter.c
+ *
+ *  Created on: Mar 10, 2026
+ */
+
+#include "pot_filter.h"
+
+#include <stddef.h>
+
+// 1 次 IIR の係数 alpha = w / (1 + w), w = 2*pi*fc/rate
+#define POT_FILTER_TWO_PI_Q16 411775U
+#define POT_FILTER_W_PER_HZ   ((POT_FILTER_TWO_PI_Q16 + (POT_FILTER_RATE_HZ / 2U)) / POT_FILTER_RATE_HZ)  // Q16
+#define POT_FILTER_IN_MAX     ((1 << (POT_FILTER_IN_BITS + POT_FILTER_FRAC)) - 1)
+
+static pot_filter_params_t s_params = {
+    .min_cutoff_q8 = 256U,       // 1Hz
+    .max_cutoff_q8 = 40U * 256U, // 40Hz
+    .beta_q16      = 98U,        // 全域を 200ms で回すと約 30Hz
+    .d_cutoff_q8   = 256U,       // 1Hz
+    .hyst_q8       = 64U,        // 1/4 ステップ
+};
+static uint16_t s_alpha_d_q15;
+
+static uint16_t pot_filter_alpha_q15(uint32_t fc_q8)
+{
+    const uint32_t w = (fc_q8 * POT_FILTER_W_PER_HZ) >> 8;  // Q16
+    return (uint16_t) ((w << 15) / (65536U + w));
+}
+
+void pot_filter_init(pot_filter_t* f, uint8_t out_bits)
+{
+    f->y         = 0;
+    f->dx        = 0;
+    f->out       = 0;
+    f->out_shift = (uint8_t) (POT_FILTER_IN_BITS - out_bits);
+    f->primed    = false;
+
+    if (s_alpha_d_q15 == 0U)
+    {
+        s_alpha_d_q15 = pot_filter_alpha_q15(s_params.d_cutoff_q8);
+    }
+}
+
+// 量子化した出力が変わったら true
+bool pot_filter_update(pot_filter_t* f, uint32_t raw)
+{
+    int32_t x = (int32_t) (raw << POT_FILTER_FRAC);
+    if (x > POT_FILTER_IN_MAX)
+    {
+        x = POT_FILTER_IN_MAX;
+    }
+
+    const uint32_t step_shift = f->out_shift + POT_FILTER_FRAC;
+
+    if (!f->primed)
+    {
+        f->y      = x;
+        f->dx     = 0;
+        f->out    = (uint16_t) (x >> step_shift);
+        f->primed = true;
+        return true;
+    }
+
+    // 速度 (前回の出力との差) を平滑化してカットオフを決める
+    const int32_t dx = ((x - f->y) * (int32_t) POT_FILTER_RATE_HZ) >> POT_FILTER_FRAC;
+    f->dx += (int32_t) (((int64_t) (dx - f->dx) * s_alpha_d_q15) >> 15);
+
+    const uint32_t speed = (uint32_t) ((f->dx < 0) ? -f->dx : f->dx);
+    uint32_t fc_q8       = s_params.min_cutoff_q8 + (uint32_t) (((uint64_t) s_params.beta_q16 * speed) >> 8);
+    if (fc_q8 > s_params.max_cutoff_q8)
+    {
+        fc_q8 = s_params.max_cutoff_q8;
+    }
+    f->y += (int32_t) (((int64_t) (x - f->y) * pot_filter_alpha_q15(fc_q8)) >> 15);
+
+    // 今のステップの外側にヒステリシス幅だけ出たときだけ出力を変える
+    const int32_t step = 1 << step_shift;
+    const int32_t hyst = (step * s_params.hyst_q8) >> 8;
+    const int32_t lo   = ((int32_t) f->out << step_shift) - hyst;
+    const int32_t hi   = (((int32_t) f->out + 1) << step_shift) + hyst;
+
+    if ((f->y >= lo) && (f->y < hi))
+    {
+        return false;
+    }
+
+    const uint16_t out = (uint16_t) (f->y >> step_shift);
+    if (out == f->out)
+    {
+        return false;
+    }
+    f->out = out;
+    return true;
+}
+
+bool pot_filter_set_params(const pot_filter_params_t* p)
+{
+    if ((p == NULL) || (p->min_cutoff_q8 == 0U) || (p->max_cutoff_q8 < p->min_cutoff_q8) ||
+        (p->max_cutoff_q8 > ((POT_FILTER_RATE_HZ / 4U) << 8)) || (p->d_cutoff_q8 == 0U))
+    {
+        return false;
+    }
+
+    s_params      = *p;
+    s_alpha_d_q15 = pot_filter_alpha_q15(s_params.d_cutoff_q8);
+    return true;
+}
+
+void pot_filter_get_params(pot_filter_params_t* p)
+{
+    if (p != NULL)
+    {
+        *p = s_params;
+    }
+}
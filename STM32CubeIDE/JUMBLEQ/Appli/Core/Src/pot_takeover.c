@@ -0,0 +1,127 @@
+/*
+ * pot_takeover.c
+ *
+ *  Created on: Mar 14, 2026
+ */
+
+#include "pot_takeover.h"
+
+static uint16_t pot_takeover_band(const pot_takeover_t* t)
+{
+    const uint16_t band = (uint16_t) (t->full / POT_TAKEOVER_CATCH_DIV);
+    return (band != 0U) ? band : 1U;
+}
+
+static uint16_t pot_takeover_diff(uint16_t a, uint16_t b)
+{
+    return (a > b) ? (uint16_t) (a - b) : (uint16_t) (b - a);
+}
+
+// 最初の更新は位置の値にする (起動直後/割り当て変更直後)
+void pot_takeover_init(pot_takeover_t* t, uint16_t full)
+{
+    t->value  = 0;
+    t->pos    = 0;
+    t->full   = full;
+    t->caught = true;
+    t->primed = false;
+}
+
+// ホスト/プリセットが値を変えた。位置がまだ分からなければ最初の更新で判定する
+void pot_takeover_set_value(pot_takeover_t* t, uint16_t value)
+{
+    t->value  = (value < t->full) ? value : t->full;
+    t->caught = t->primed && (pot_takeover_diff(t->pos, t->value) <= pot_takeover_band(t));
+}
+
+// 値が変わったら true
+bool pot_takeover_update(pot_takeover_t* t, uint8_t mode, uint16_t pos)
+{
+    const uint16_t prev = t->pos;
+    const uint16_t old  = t->value;
+
+    if (pos > t->full)
+    {
+        pos = t->full;
+    }
+    t->pos = pos;
+
+    if (!t->primed)
+    {
+        t->primed = true;
+        if (t->caught)
+        {
+            t->value = pos;
+            return true;
+        }
+        t->caught = (pot_takeover_diff(pos, t->value) <= pot_takeover_band(t));
+        return false;
+    }
+
+    if (t->caught || (mode == POT_TAKEOVER_JUMP) || (mode >= POT_TAKEOVER_MODE_NUM))
+    {
+        t->caught = true;
+        t->value  = pos;
+        return t->value != old;
+    }
+
+    switch (mode)
+    {
+    case POT_TAKEOVER_PICKUP:
+    {
+        const uint16_t lo = (prev < pos) ? prev : pos;
+        const uint16_t hi = (prev < pos) ? pos : prev;
+        if (((t->value >= lo) && (t->value <= hi)) || (pot_takeover_diff(pos, t->value) <= pot_takeover_band(t)))
+        {
+            t->caught = true;
+            t->value  = pos;
+        }
+        break;
+    }
+    case POT_TAKEOVER_SCALE:
+        // 上げる時は値から full まで、下げる時は 0 まで、ポットの残りの行程に合わせて縮める
+        // 1 段が 0 に丸まっても最低 1 にはしない (値が先に端へ着いて、キャッチで逆に戻ってしまう)
+        if ((pos > prev) && (t->value < t->full))
+        {
+            const uint32_t step = ((uint32_t) (pos - prev) * (t->full - t->value) + ((t->full - prev) / 2U)) / (t->full - prev);
+            t->value            = (uint16_t) (t->value + step);
+        }
+        else if ((pos < prev) && (t->value > 0U))
+        {
+            const uint32_t step = ((uint32_t) (prev - pos) * t->value + (prev / 2U)) / prev;
+            t->value            = (uint16_t) (t->value - step);
+        }
+        // 値が動かした向きの先にある間はキャッチしない (端では必ず合流する)
+        if ((pos != prev) && ((pos > prev) ? (t->value <= pos) : (t->value >= pos)) &&
+            (pot_takeover_diff(pos, t->value) <= pot_takeover_band(t)))
+        {
+            t->caught = true;
+            t->value  = pos;
+        }
+        break;
+    case POT_TAKEOVER_RELATIVE:
+    {
+        int32_t v = (int32_t) t->value + (int32_t) pos - (int32_t) prev;
+        v         = (v < 0) ? 0 : ((v > (int32_t) t->full) ? (int32_t) t->full : v);
+        t->value  = (uint16_t) v;
+        if (t->value == pos)
+        {
+            t->caught = true;
+        }
+        break;
+    }
+    default:
+        break;
+    }
+    return t->value != old;
+}
+
+// キャッチするために回す向き (+1: 上げる、-1: 下げる、0: キャッチ済み)
+int8_t pot_takeover_direction(const pot_takeover_t* t)
+{
+    if (t->caught || !t->primed)
+    {
+        return 0;
+    }
+    return (t->pos < t->value) ? 1 : -1;
+}
@@ -0,0 +1,219 @@
+/*
+ * sigma_prof.c
+ *
+ *  Created on: Mar 7, 2026
+ */
+
+#include "sigma_prof.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "cmsis_os2.h"
+
+#include <string.h>
+
+extern osThreadId_t usbTaskHandle;
+extern osThreadId_t audioTaskHandle;
+extern osThreadId_t ledTaskHandle;
+extern osThreadId_t adcTaskHandle;
+
+typedef struct
+{
+    uint8_t caller;
+    uint32_t entry_cyc;
+    uint32_t acquired_cyc;
+    uint32_t wire_start_cyc;
+    volatile uint32_t wire_done_cyc;
+} sigma_prof_txn_t;
+
+static const char* const s_caller_name[SIGMA_PROF_CALLER_NUM] = {
+    [SIGMA_PROF_CALLER_INIT]  = "INIT",
+    [SIGMA_PROF_CALLER_UI]    = "UI",
+    [SIGMA_PROF_CALLER_LED]   = "LED",
+    [SIGMA_PROF_CALLER_USB]   = "USB",
+    [SIGMA_PROF_CALLER_AUDIO] = "AUDIO",
+    [SIGMA_PROF_CALLER_OTHER] = "OTHER",
+};
+
+static const char* const s_metric_name[SIGMA_PROF_METRIC_NUM] = {
+    [SIGMA_PROF_METRIC_MUTEX] = "mtx",
+    [SIGMA_PROF_METRIC_WIRE]  = "wire",
+    [SIGMA_PROF_METRIC_WAKE]  = "wake",
+};
+
+// 更新は基本 spiMutex 保持中（= 常に1トランザクションだけ）に行うので排他は不要
+// (mutex 外の sigma_prof_blocking / mutex_timeout は統計が1件ずれる程度なので許容)
+static sigma_prof_stats_t s_stats[SIGMA_PROF_CALLER_NUM];
+static sigma_prof_txn_t s_txn;
+
+static uint32_t sigma_prof_cyc_to_us(uint32_t cyc)
+{
+    const uint32_t cyc_per_us = SystemCoreClock / 1000000UL;
+    return (cyc_per_us != 0U) ? (cyc / cyc_per_us) : 0U;
+}
+
+static uint8_t sigma_prof_bucket(uint32_t us)
+{
+    uint8_t b = 0;
+
+    while ((us != 0U) && (b < (SIGMA_PROF_BUCKET_NUM - 1U)))
+    {
+        us >>= 1;
+        b++;
+    }
+    return b;
+}
+
+static void sigma_prof_record(sigma_prof_stats_t* st, uint8_t metric, uint32_t cyc)
+{
+    const uint32_t us = sigma_prof_cyc_to_us(cyc);
+
+    st->sum_us[metric] += us;
+    if (us > st->max_us[metric])
+    {
+        st->max_us[metric] = us;
+    }
+    st->hist[metric][sigma_prof_bucket(us)]++;
+}
+
+uint8_t sigma_prof_caller(void)
+{
+    if (osKernelGetState() != osKernelRunning)
+    {
+        return SIGMA_PROF_CALLER_INIT;
+    }
+
+    const osThreadId_t self = osThreadGetId();
+    if (self == adcTaskHandle)
+    {
+        return SIGMA_PROF_CALLER_UI;
+    }
+    if (self == ledTaskHandle)
+    {
+        return SIGMA_PROF_CALLER_LED;
+    }
+    if (self == usbTaskHandle)
+    {
+        return SIGMA_PROF_CALLER_USB;
+    }
+    if (self == audioTaskHandle)
+    {
+        return SIGMA_PROF_CALLER_AUDIO;
+    }
+    return SIGMA_PROF_CALLER_OTHER;
+}
+
+// spiMutex を取得した直後に呼ぶ。entry_cyc は取得前に sigma_prof_now() で取った値
+void sigma_prof_begin(uint32_t entry_cyc)
+{
+    s_txn.caller         = sigma_prof_caller();
+    s_txn.entry_cyc      = entry_cyc;
+    s_txn.acquired_cyc   = sigma_prof_now();
+    s_txn.wire_start_cyc = s_txn.acquired_cyc;
+    s_txn.wire_done_cyc  = 0;
+}
+
+void sigma_prof_wire_start(void)
+{
+    s_txn.wire_done_cyc  = 0;
+    s_txn.wire_start_cyc = sigma_prof_now();
+}
+
+void sigma_prof_wire_done_isr(void)
+{
+    s_txn.wire_done_cyc = sigma_prof_now();
+}
+
+// spiMutex を解放する直前に呼ぶ
+void sigma_prof_end(void)
+{
+    const uint32_t now      = sigma_prof_now();
+    sigma_prof_stats_t* st  = &s_stats[s_txn.caller];
+    const uint32_t done_cyc = s_txn.wire_done_cyc;
+
+    st->count++;
+    sigma_prof_record(st, SIGMA_PROF_METRIC_MUTEX, s_txn.acquired_cyc - s_txn.entry_cyc);
+
+    // 完了割り込みが来なかった(タイムアウト/エラー)場合は wire を最後まで、wake は記録しない
+    if (done_cyc == 0U)
+    {
+        sigma_prof_record(st, SIGMA_PROF_METRIC_WIRE, now - s_txn.wire_start_cyc);
+        return;
+    }
+    sigma_prof_record(st, SIGMA_PROF_METRIC_WIRE, done_cyc - s_txn.wire_start_cyc);
+    sigma_prof_record(st, SIGMA_PROF_METRIC_WAKE, now - done_cyc);
+}
+
+void sigma_prof_mutex_timeout(void)
+{
+    s_stats[sigma_prof_caller()].mutex_timeouts++;
+}
+
+// ポーリング転送 (初期化/XFアサイン)。mutex 外で動くので s_txn には触らない
+void sigma_prof_blocking(uint32_t start_cyc)
+{
+    sigma_prof_stats_t* st = &s_stats[sigma_prof_caller()];
+
+    st->count++;
+    st->unlocked++;
+    sigma_prof_record(st, SIGMA_PROF_METRIC_WIRE, sigma_prof_now() - start_cyc);
+}
+
+bool sigma_prof_get_stats(uint8_t caller, sigma_prof_stats_t* out)
+{
+    if ((caller >= SIGMA_PROF_CALLER_NUM) || (out == NULL))
+    {
+        return false;
+    }
+
+    vTaskSuspendAll();
+    memcpy(out, &s_stats[caller], sizeof(*out));
+    (void) xTaskResumeAll();
+    return true;
+}
+
+void sigma_prof_reset(void)
+{
+    vTaskSuspendAll();
+    memset(s_stats, 0, sizeof(s_stats));
+    (void) xTaskResumeAll();
+}
+
+const char* sigma_prof_caller_name(uint8_t caller)
+{
+    return (caller < SIGMA_PROF_CALLER_NUM) ? s_caller_name[caller] : "?";
+}
+
+// 前回の report 以降の集計を RTT に出してリセットする
+void sigma_prof_report(void)
+{
+    static sigma_prof_stats_t st;
+
+    for (uint8_t c = 0; c < SIGMA_PROF_CALLER_NUM; c++)
+    {
+        (void) sigma_prof_get_stats(c, &st);
+        if ((st.count == 0U) && (st.mutex_timeouts == 0U))
+        {
+            continue;
+        }
+
+        const uint32_t n = (st.count != 0U) ? st.count : 1U;
+        SEGGER_RTT_printf(0, "[SPIPROF] %s n=%lu unl=%lu mto=%lu mtx=%lu/%lu wire=%lu/%lu wake=%lu/%lu us(avg/max)\n",
+                          s_caller_name[c], (unsigned long) st.count, (unsigned long) st.unlocked, (unsigned long) st.mutex_timeouts,
+                          (unsigned long) (st.sum_us[SIGMA_PROF_METRIC_MUTEX] / n), (unsigned long) st.max_us[SIGMA_PROF_METRIC_MUTEX],
+                          (unsigned long) (st.sum_us[SIGMA_PROF_METRIC_WIRE] / n), (unsigned long) st.max_us[SIGMA_PROF_METRIC_WIRE],
+                          (unsigned long) (st.sum_us[SIGMA_PROF_METRIC_WAKE] / n), (unsigned long) st.max_us[SIGMA_PROF_METRIC_WAKE]);
+
+        for (uint8_t m = 0; m < SIGMA_PROF_METRIC_NUM; m++)
+        {
+            SEGGER_RTT_printf(0, "[SPIPROF]   %s", s_metric_name[m]);
+            for (uint8_t b = 0; b < SIGMA_PROF_BUCKET_NUM; b++)
+            {
+                SEGGER_RTT_printf(0, " %lu", (unsigned long) st.hist[m][b]);
+            }
+            SEGGER_RTT_printf(0, "\n");
+        }
+    }
+
+    sigma_prof_reset();
+}
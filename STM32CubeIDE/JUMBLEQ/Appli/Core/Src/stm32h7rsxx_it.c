@@ -99,6 +99,10 @@ extern PCD_HandleTypeDef hpcd_USB_OTG_HS;
 extern TIM_HandleTypeDef htim6;
 
 /* USER CODE BEGIN EV */
+extern DMA_HandleTypeDef handle_GPDMA1_Channel5;
+extern DMA_HandleTypeDef handle_GPDMA1_Channel6;
+extern DMA_HandleTypeDef handle_GPDMA1_Channel7;
+extern DMA_HandleTypeDef handle_HPDMA1_Channel1;
 
 /* USER CODE END EV */
 
@@ -546,4 +550,36 @@ void OTG_HS_IRQHandler(void)
 
 /* USER CODE BEGIN 1 */
 
+/**
+  * @brief This function handles GPDMA1 Channel 5 global interrupt (SPI5 TX).
+  */
+void GPDMA1_Channel5_IRQHandler(void)
+{
+  HAL_DMA_IRQHandler(&handle_GPDMA1_Channel5);
+}
+
+/**
+  * @brief This function handles GPDMA1 Channel 6 global interrupt (I2C3 TX).
+  */
+void GPDMA1_Channel6_IRQHandler(void)
+{
+  HAL_DMA_IRQHandler(&handle_GPDMA1_Channel6);
+}
+
+/**
+  * @brief This function handles GPDMA1 Channel 7 global interrupt (I2C2 TX).
+  */
+void GPDMA1_Channel7_IRQHandler(void)
+{
+  HAL_DMA_IRQHandler(&handle_GPDMA1_Channel7);
+}
+
+/**
+  * @brief This function handles HPDMA1 Channel 1 global interrupt (ADC2).
+  */
+void HPDMA1_Channel1_IRQHandler(void)
+{
+  HAL_DMA_IRQHandler(&handle_HPDMA1_Channel1);
+}
+
 /* USER CODE END 1 */
@@ -5,6 +5,7 @@
  */
 
 #include "ui_control.h"
+#include "ui_control_internal.h"
 
 #include "audio_control.h"
 
@@ -12,26 +13,62 @@
 #include "eeprom.h"
 #include "hpdma.h"
 #include "i2c.h"
+#include "input_event.h"
 #include "led_control.h"
 #include "linked_list.h"
+#include "mag_calib.h"
+#include "mag_fader.h"
+#include "mag_idle.h"
+#include "midi_map.h"
+#include "midi_sysex.h"
+#include "oled_control.h"
+#include "oled_menu.h"
+#include "pot_filter.h"
+#include "pot_takeover.h"
+#include "tim.h"
 
 #include "adau1466.h"
+#include "dsp_library.h"
 #include "SigmaStudioFW.h"
 
-extern DMA_QListTypeDef List_HPDMA1_Channel0;
+#include "FreeRTOS.h"
+#include "cmsis_os2.h"
+#include "task.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// ポットは MUX で1本の ADC チャンネルを共有しているので AWD では見分けられない
+// スキャン完了割り込みで各ポットの生値を窓と比べ、どれかが出たときだけ adcTask を起こす
+#define POT_WAKE_BAND    16U   // 窓の幅 (静止時の生値から ±, 12bit LSB)
+#define POT_IDLE_UPDATES 250U  // 出力が変わらない更新がこれだけ続いたら窓待ちに入る (500ms)
+
+#define MIDI_RX_LOG 0  // 受信したチャンネルメッセージを RTT に出す
 
+// パネルの入力 (input_event のソース番号)。SW1/SW2 は押すと L (外付けプルアップ)
 enum
 {
-    INPUT_SRC_CH1_LN = 0,
-    INPUT_SRC_CH1_PN,
-    INPUT_SRC_CH2_LN,
-    INPUT_SRC_CH2_PN,
-    INPUT_SRC_USB12,
-    INPUT_SRC_USB34,
-    INPUT_SRC_NONE,
+    UI_INPUT_SW1 = 0,
+    UI_INPUT_SW2,
+    UI_INPUT_XF_A_CUT,  // クロスフェーダーがカットイン位置より閉じている
+    UI_INPUT_XF_B_CUT,
+    UI_INPUT_NUM,
 };
 
-__attribute__((section("noncacheable_buffer"), aligned(32))) uint32_t adc_val[ADC_NUM] = {0};
+#define UI_SW_MASK          (SW1_Pin | SW2_Pin)
+#define UI_CUT_NOTE_CHANNEL 15U  // フェーダーのカットは ch16 のノート (A = UI_CUT_NOTE_A、B = +1) で送る
+#define UI_CUT_NOTE_A       0U
+#define UI_INPUT_LOG        0    // ジェスチャーを RTT に出す
+
+#define UI_MENU_POT         0U   // メニューを開いている間はこのポットをエンコーダーの代わりにする (MIDI は送らない)
+
+extern DMA_QListTypeDef List_HPDMA1_Channel0;
+extern osThreadId_t adcTaskHandle;
+
+// adc_val[k][] は MUX をポット k に合わせた状態の ADC1 1スキャン分 (HPDMA が TIM3 トリガで1周 1ms で更新)
+__attribute__((section("noncacheable_buffer"), aligned(32))) uint32_t adc_val[POT_NUM][ADC_NUM] = {0};
+// MUX 位置 k にする GPIOD->BSRR の値。HPDMA がスキャンの合間に書き込む
+__attribute__((section("noncacheable_buffer"), aligned(32))) uint32_t pot_mux_bsrr[POT_NUM] = {0};
 
 typedef struct
 {
@@ -44,20 +81,23 @@ typedef struct
     uint8_t current_ch2_dvs_enable;
     uint8_t current_xfA_position;
     uint8_t current_xfB_position;
-    uint8_t pot_ch;
-    uint8_t pot_ch_counter;
-    uint16_t pot_ma_index[POT_NUM];
-    uint32_t pot_val_ma[POT_NUM][POT_MA_SIZE];
+    pot_filter_t pot_filt[POT_NUM];
     uint16_t pot_val[POT_NUM];
-    uint16_t pot_val_prev[POT_NUM][2];
-    uint16_t mag_calibration_count;
+    pot_takeover_t pot_take[POT_NUM];         // 割り当て先の今の値とポット位置のずれ
+    uint32_t pot_map_gen;                     // pot_filt の出力ビット数を合わせた midi_map_generation()
+    uint16_t dsp_param[MIDI_MAP_DSP_NUM];     // DSP に書いた値 (10bit)
     uint16_t mag_val[MAG_SW_NUM];
-    uint32_t mag_offset_sum[MAG_SW_NUM];
-    uint16_t mag_offset[MAG_SW_NUM];
-    float xfade[MAG_SW_NUM];
-    float xfade_prev[MAG_SW_NUM];
-    float xfade_min[MAG_SW_NUM];
-    float xfade_max[MAG_SW_NUM];
+    mag_idle_t mag_idle;                 // 静止判定 (全センサーが MAG_IDLE_BAND 以内に MAG_IDLE_BLOCKS 留まったら窓待ち)
+    uint32_t mag_idle_tick;              // 窓待ち中に最後にサンプルを読んだ tick
+    uint32_t pot_still;                  // 出力が変わらなかった更新の回数
+    uint16_t xfade[MAG_SW_NUM];  // Q15
+    uint16_t xfade_prev[MAG_SW_NUM];
+    uint16_t xfade_min[MAG_SW_NUM];
+    uint16_t xfade_max[MAG_SW_NUM];
+    uint8_t xf_curve[XFADE_FADER_NUM];
+    uint8_t xf_cut[XFADE_FADER_NUM];
+    bool xf_dirty;  // カーブ/カットインが変わったので次のブロックで DSP に書き直す
+    bool mag_calib_save_pending;  // ガイド付きキャリブレーションの結果。フェーダーが 窓待ちになってから EEPROM に書く
     bool is_start_audio_control;
 } ui_control_state_t;
 
@@ -71,33 +111,56 @@ static ui_control_state_t s_ui = {
     .current_ch2_dvs_enable = 0U,
     .current_xfA_position   = 127,
     .current_xfB_position   = 127,
-    .xfade                  = {1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f},
-    .xfade_prev             = {1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f},
-    .xfade_min              = {1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f},
-    .xfade_max              = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f},
+    .xfade                  = {XFADE_Q15_ONE, XFADE_Q15_ONE, XFADE_Q15_ONE, XFADE_Q15_ONE, XFADE_Q15_ONE, XFADE_Q15_ONE},
+    .xfade_prev             = {XFADE_Q15_ONE, XFADE_Q15_ONE, XFADE_Q15_ONE, XFADE_Q15_ONE, XFADE_Q15_ONE, XFADE_Q15_ONE},
+    .xfade_min              = {XFADE_Q15_ONE, XFADE_Q15_ONE, XFADE_Q15_ONE, XFADE_Q15_ONE, XFADE_Q15_ONE, XFADE_Q15_ONE},
+    .xfade_max              = {0, 0, 0, 0, 0, 0},
+    .xf_curve               = {XFADE_CURVE_SCRATCH, XFADE_CURVE_SCRATCH},
+    .xf_cut                 = {MAG_XFADE_CUTOFF, MAG_XFADE_CUTOFF},
     .is_start_audio_control = false,
 };
 
 static volatile bool is_adc_complete = false;
 
-static void send_control_change(uint8_t number, uint8_t value, uint8_t channel)
-{
-    uint8_t control_change[3] = {0xB0 | channel, number, value};
-    tud_midi_stream_write(0, control_change, 3);
-}
+// ポットの窓待ち。窓は adcTask が書いてから s_pot_idle を立て、ISR が出たのを見つけたら下ろす
+static volatile bool s_pot_idle = false;
+static volatile uint16_t s_pot_win_lo[POT_NUM];
+static volatile uint16_t s_pot_win_hi[POT_NUM];
+static volatile bool s_pot_wake_pending = false;  // 窓を出てからまだ出力が変わっていない
+static volatile uint32_t s_pot_wake_cyc;
+static uint32_t s_pot_scan_div;
 
-static uint8_t xfade_to_cc(float xfade)
+// adcTask の起床回数とポットの起床レイテンシ (pot_exits だけ ISR が更新する)
+typedef struct
 {
-    if (xfade < 0.0f)
-    {
-        xfade = 0.0f;
-    }
-    else if (xfade > 1.0f)
+    uint32_t wakeups;
+    uint32_t mag;
+    uint32_t pot;
+    uint32_t midi;
+    uint32_t timeout;
+    uint32_t mag_timeout;  // タイムアウトの読み出しでフェーダーの動きを見つけた
+    uint32_t pot_arms;
+    uint32_t pot_exits;
+    uint32_t pot_wake_n;
+    uint32_t pot_wake_max_us;
+    uint64_t pot_wake_sum_us;
+} ui_wake_stats_t;
+
+static ui_wake_stats_t s_wake;
+
+// SW1/SW2 は ADC スキャン完了割り込みで読み、変わった時だけ adcTask を起こす
+static volatile uint32_t s_sw_idr = UI_SW_MASK;
+static input_event_engine_t s_input;
+static uint8_t s_preset_slot;
+
+static uint8_t xfade_to_cc(uint16_t xfade)
+{
+    if (xfade > XFADE_Q15_ONE)
     {
-        xfade = 1.0f;
+        xfade = XFADE_Q15_ONE;
     }
 
-    return (uint8_t) (127.0f - xfade * 127.0f);
+    return (uint8_t) (((XFADE_Q15_ONE - xfade) * 127U) >> 15);
 }
 
 uint8_t get_current_xfA_position(void)
@@ -112,22 +175,22 @@ uint8_t get_current_xfB_position(void)
 
 int16_t get_current_ch1_db(void)
 {
-    return convert_pot2dB_int(s_ui.pot_val[6]);
+    return convert_pot2dB_int(s_ui.dsp_param[MIDI_MAP_DSP_CH1_GAIN]);
 }
 
 int16_t get_current_ch2_db(void)
 {
-    return convert_pot2dB_int(s_ui.pot_val[4]);
+    return convert_pot2dB_int(s_ui.dsp_param[MIDI_MAP_DSP_CH2_GAIN]);
 }
 
 int16_t get_current_master_db(void)
 {
-    return convert_pot2dB_int(s_ui.pot_val[5]);
+    return convert_pot2dB_int(s_ui.dsp_param[MIDI_MAP_DSP_MASTER_GAIN]);
 }
 
 int16_t get_current_dry_wet(void)
 {
-    int16_t pct = (int16_t) (((double) s_ui.pot_val[7] / 1023.0 * 100.0) + 0.5);
+    int16_t pct = (int16_t) (((double) s_ui.dsp_param[MIDI_MAP_DSP_DRY_WET] / 1023.0 * 100.0) + 0.5);
     if (pct < 0)
     {
         pct = 0;
@@ -149,6 +212,11 @@ uint8_t get_current_xfade3_cc_value(void)
     return xfade_to_cc(s_ui.xfade[3]);
 }
 
+uint8_t get_current_xf_curve(uint8_t fader)
+{
+    return (fader < XFADE_FADER_NUM) ? s_ui.xf_curve[fader] : XFADE_CURVE_LINEAR;
+}
+
 char* get_current_input_typeA_str(void)
 {
     switch (s_ui.current_xfA_assign)
@@ -293,6 +361,56 @@ void ui_control_dma_adc_cplt(DMA_HandleTypeDef* hdma)
     (void) hdma;
     is_adc_complete = true;
     __DSB();
+
+    // チャタリング除去は input_event がするので、ここでは変化だけ見る (1ms 毎)
+    const uint32_t sw = SW1_GPIO_Port->IDR & UI_SW_MASK;
+    if ((sw != s_sw_idr) && (adcTaskHandle != NULL))
+    {
+        s_sw_idr = sw;
+        (void) osThreadFlagsSet(adcTaskHandle, UI_INPUT_THREAD_FLAG);
+    }
+
+    if (s_pot_idle)
+    {
+        uint8_t ch;
+        for (ch = 0; ch < POT_NUM; ch++)
+        {
+            const uint32_t v = adc_val[ch][POT_ADC_RANK];
+            if ((v < s_pot_win_lo[ch]) || (v > s_pot_win_hi[ch]))
+            {
+                break;
+            }
+        }
+        if (ch == POT_NUM)
+        {
+            return;
+        }
+        s_pot_idle         = false;
+        s_pot_wake_cyc     = DWT->CYCCNT;
+        s_pot_wake_pending = true;
+        s_pot_scan_div     = 0;
+        s_wake.pot_exits++;
+    }
+    else if ((++s_pot_scan_div & 1U) != 0U)
+    {
+        // 動いている間は pot_filter の更新周期 (POT_FILTER_RATE_HZ) に合わせて2スキャン毎
+        return;
+    }
+
+    if (adcTaskHandle != NULL)
+    {
+        (void) osThreadFlagsSet(adcTaskHandle, UI_POT_THREAD_FLAG);
+    }
+}
+
+// TinyUSB が MIDI OUT を受け取ったとき (usbTask) に呼ばれる。読み出しは adcTask で行う
+void tud_midi_rx_cb(uint8_t itf)
+{
+    (void) itf;
+    if (adcTaskHandle != NULL)
+    {
+        (void) osThreadFlagsSet(adcTaskHandle, UI_MIDI_THREAD_FLAG);
+    }
 }
 
 void ui_control_set_adc_complete(bool complete)
@@ -301,7 +419,34 @@ void ui_control_set_adc_complete(bool complete)
     __DMB();
 }
 
-void start_adc(void)
+static void build_pot_mux_bsrr(void)
+{
+    static const uint8_t mux_bits[POT_NUM][3] = {
+        {0, 0, 0},
+        {0, 1, 0},
+        {0, 0, 1},
+        {0, 1, 1},
+        {1, 0, 0},
+        {1, 1, 0},
+        {1, 0, 1},
+        {1, 1, 1},
+    };
+    static const uint16_t mux_pins[3] = {S0_Pin, S1_Pin, S2_Pin};
+
+    for (uint8_t ch = 0; ch < POT_NUM; ch++)
+    {
+        uint32_t bsrr = 0;
+        for (uint8_t b = 0; b < 3; b++)
+        {
+            // 下位16bit = セット, 上位16bit = リセット
+            bsrr |= mux_bits[ch][b] ? (uint32_t) mux_pins[b] : ((uint32_t) mux_pins[b] << 16);
+        }
+        pot_mux_bsrr[ch] = bsrr;
+    }
+}
+
+// HPDMA のリストは MUX 位置0のスキャンから始まるので、MUX を0に戻してから開始する
+void ui_control_restart_adc_scan(void)
 {
     if (MX_List_HPDMA1_Channel0_Config() != HAL_OK)
     {
@@ -312,26 +457,97 @@ void start_adc(void)
         Error_Handler();
     }
 
-    HAL_GPIO_WritePin(S0_GPIO_Port, S0_Pin, 0);
-    HAL_GPIO_WritePin(S1_GPIO_Port, S1_Pin, 0);
-    HAL_GPIO_WritePin(S2_GPIO_Port, S2_Pin, 0);
-    s_ui.pot_ch = 1;
+    GPIOD->BSRR = pot_mux_bsrr[0];
 
-    if (HAL_ADCEx_Calibration_Start(&hadc1, ADC_SINGLE_ENDED) != HAL_OK)
+    handle_HPDMA1_Channel0.XferCpltCallback = ui_control_dma_adc_cplt;
+    if (HAL_DMAEx_List_Start_IT(&handle_HPDMA1_Channel0) != HAL_OK)
+    {
+        Error_Handler();
+    }
+    if (HAL_ADC_Start(&hadc1) != HAL_OK)
     {
         Error_Handler();
     }
+}
 
-    SET_BIT(hadc1.Instance->CFGR, ADC_CFGR_DMAEN);
-    SET_BIT(hadc1.Instance->CFGR, ADC_CFGR_DMACFG);
+static uint32_t pot_full_scale(uint8_t ch)
+{
+    return (1UL << midi_map_value_bits(MIDI_MAP_SRC_POT0 + ch)) - 1UL;
+}
 
-    handle_HPDMA1_Channel0.XferCpltCallback = ui_control_dma_adc_cplt;
-    if (HAL_DMAEx_List_Start_IT(&handle_HPDMA1_Channel0) != HAL_OK)
+// 出力ビット数は割り当て先 (CC: 7bit、DSP: 10bit ...) に合わせる
+static void init_pot_filters(void)
+{
+    s_ui.pot_map_gen = midi_map_generation();
+    for (uint8_t ch = 0; ch < POT_NUM; ch++)
+    {
+        pot_filter_init(&s_ui.pot_filt[ch], midi_map_value_bits(MIDI_MAP_SRC_POT0 + ch));
+        pot_takeover_init(&s_ui.pot_take[ch], (uint16_t) pot_full_scale(ch));
+        s_ui.pot_val[ch] = 0;
+    }
+}
+
+// 割り当て先の値がポット以外 (ホスト/プリセット) から変わった。同じ先のポットは位置と合うまでテイクオーバーに従う
+static void ui_control_pot_takeover_follow(uint8_t type, uint8_t channel, uint16_t number, uint16_t out)
+{
+    for (uint8_t ch = 0; ch < POT_NUM; ch++)
+    {
+        const uint8_t src = MIDI_MAP_SRC_POT0 + ch;
+        midi_map_entry_t e;
+        uint32_t v;
+
+        if (!midi_map_get_entry(src, &e) || (e.type != type) || (e.number != number) ||
+            ((type != MIDI_MAP_TYPE_DSP) && (e.channel != channel)))
+        {
+            continue;
+        }
+        if (midi_map_reverse(src, out, pot_full_scale(ch), &v))
+        {
+            pot_takeover_set_value(&s_ui.pot_take[ch], (uint16_t) v);
+            midi_map_invalidate(src);
+        }
+    }
+}
+
+// 割り当てを変えたら DSP 行きのポットは今の DSP の値から拾い直す (CC の先の値は分からないので位置に飛ぶ)
+static void ui_control_pot_takeover_resync(void)
+{
+    for (uint8_t param = 0; param < MIDI_MAP_DSP_NUM; param++)
+    {
+        ui_control_pot_takeover_follow(MIDI_MAP_TYPE_DSP, 0, param, s_ui.dsp_param[param]);
+    }
+}
+
+void start_adc(void)
+{
+    static const uint8_t input_kinds[UI_INPUT_NUM] = {
+        [UI_INPUT_SW1]      = INPUT_KIND_BUTTON,
+        [UI_INPUT_SW2]      = INPUT_KIND_BUTTON,
+        [UI_INPUT_XF_A_CUT] = INPUT_KIND_FADER,
+        [UI_INPUT_XF_B_CUT] = INPUT_KIND_FADER,
+    };
+
+    build_pot_mux_bsrr();
+    init_pot_filters();
+    input_event_init(&s_input, input_kinds, UI_INPUT_NUM);
+    s_sw_idr = SW1_GPIO_Port->IDR & UI_SW_MASK;
+
+    if (HAL_ADCEx_Calibration_Start(&hadc1, ADC_SINGLE_ENDED) != HAL_OK)
     {
         Error_Handler();
     }
 
-    if (HAL_ADC_Start(&hadc1) != HAL_OK)
+    SET_BIT(hadc1.Instance->CFGR, ADC_CFGR_DMAEN);
+    SET_BIT(hadc1.Instance->CFGR, ADC_CFGR_DMACFG);
+
+    ui_control_restart_adc_scan();
+
+    mag_fader_init();
+    mag_fader_start();
+
+    // ADC1/ADC2 とも TIM3 TRGO でスキャン開始 (POT_SCAN_TIM_HZ)
+    MX_TIM3_Init();
+    if (HAL_TIM_Base_Start(&htim3) != HAL_OK)
     {
         Error_Handler();
     }
@@ -460,49 +676,27 @@ static bool ui_control_assign_to_input_ch(uint8_t assign, uint8_t* input_ch)
     }
 }
 
-static void set_pot_mux_channel(uint8_t channel)
+// midi_map の MIDI_MAP_TYPE_DSP から呼ばれる
+void ui_control_set_dsp_param(uint8_t param, uint16_t value)
 {
-    static const uint8_t mux_bits[POT_NUM][3] = {
-        {0, 0, 0},
-        {0, 1, 0},
-        {0, 0, 1},
-        {0, 1, 1},
-        {1, 0, 0},
-        {1, 1, 0},
-        {1, 0, 1},
-        {1, 1, 1},
-    };
-
-    if (channel >= POT_NUM)
+    if (param >= MIDI_MAP_DSP_NUM)
     {
-        channel = 0;
+        return;
     }
+    s_ui.dsp_param[param] = value;
 
-    HAL_GPIO_WritePin(S0_GPIO_Port, S0_Pin, mux_bits[channel][0]);
-    HAL_GPIO_WritePin(S1_GPIO_Port, S1_Pin, mux_bits[channel][1]);
-    HAL_GPIO_WritePin(S2_GPIO_Port, S2_Pin, mux_bits[channel][2]);
-}
-
-static void apply_pot_value(uint8_t channel, uint16_t value)
-{
-    switch (channel)
+    switch (param)
     {
-    case 0:
-    case 1:
-    case 2:
-    case 3:
-        send_control_change(channel, value, 0);
+    case MIDI_MAP_DSP_CH1_GAIN:
+        control_input_from_ch1_gain(value);
         break;
-    case 4:
+    case MIDI_MAP_DSP_CH2_GAIN:
         control_input_from_ch2_gain(value);
         break;
-    case 5:
+    case MIDI_MAP_DSP_MASTER_GAIN:
         control_master_out_gain(value);
         break;
-    case 6:
-        control_input_from_ch1_gain(value);
-        break;
-    case 7:
+    case MIDI_MAP_DSP_DRY_WET:
         control_dryB_out_gain(value);
         control_wet_out_gain(value);
         break;
@@ -511,90 +705,180 @@ static void apply_pot_value(uint8_t channel, uint16_t value)
     }
 }
 
-static uint32_t read_pot_sample_from_adc(uint8_t channel, uint32_t adc_raw)
+// ホスト (SysEx) から DSP パラメーターを変える
+bool ui_control_host_set_dsp_param(uint8_t param, uint16_t value)
 {
-    switch (channel)
+    if ((param >= MIDI_MAP_DSP_NUM) || (value > midi_map_type_max(MIDI_MAP_TYPE_DSP)))
     {
-    case 0:
-    case 1:
-    case 2:
-    case 3:
-        return adc_raw >> 5;
-    case 4:
-    case 5:
-    case 6:
-    case 7:
-        return adc_raw >> 2;
-    default:
-        return 0;
+        return false;
     }
+    ui_control_set_dsp_param(param, value);
+    ui_control_pot_takeover_follow(MIDI_MAP_TYPE_DSP, 0, param, value);
+    return true;
 }
 
-static void ui_control_process_pot(void)
+bool ui_control_get_dsp_param(uint8_t param, uint16_t* value)
 {
-    if (s_ui.pot_ch_counter < POT_CH_SEL_WAIT)
+    if ((param >= MIDI_MAP_DSP_NUM) || (value == NULL))
     {
-        set_pot_mux_channel(s_ui.pot_ch);
-        s_ui.pot_ch_counter++;
+        return false;
     }
-    else if (s_ui.pot_ch_counter >= POT_CH_SEL_WAIT)
+    *value = s_ui.dsp_param[param];
+    return true;
+}
+
+// DSP パラメーターに割り当てたポットをキャッチするために回す向き (+1: 上げる、-1: 下げる、0: キャッチ済み/割り当て無し)
+int8_t get_current_dsp_takeover(uint8_t param)
+{
+    for (uint8_t ch = 0; ch < POT_NUM; ch++)
     {
-        s_ui.pot_val_ma[s_ui.pot_ch][s_ui.pot_ma_index[s_ui.pot_ch]] = read_pot_sample_from_adc(s_ui.pot_ch, adc_val[6]);
-        s_ui.pot_ma_index[s_ui.pot_ch]                               = (s_ui.pot_ma_index[s_ui.pot_ch] + 1) % POT_MA_SIZE;
+        midi_map_entry_t e;
 
-        float pot_sum = 0.0f;
-        for (int j = 0; j < POT_MA_SIZE; j++)
+        if (midi_map_get_entry(MIDI_MAP_SRC_POT0 + ch, &e) && (e.type == MIDI_MAP_TYPE_DSP) && (e.number == param))
         {
-            pot_sum += (float) s_ui.pot_val_ma[s_ui.pot_ch][j];
+            const int8_t dir = pot_takeover_direction(&s_ui.pot_take[ch]);
+            if (dir != 0)
+            {
+                return dir;
+            }
         }
-        s_ui.pot_val[s_ui.pot_ch] = round(pot_sum / (float) POT_MA_SIZE);
+    }
+    return 0;
+}
 
-        uint8_t stable_count = 0;
-        if (s_ui.pot_val[s_ui.pot_ch] == s_ui.pot_val_prev[s_ui.pot_ch][0])
-        {
-            stable_count++;
-        }
-        if (s_ui.pot_val[s_ui.pot_ch] == s_ui.pot_val_prev[s_ui.pot_ch][1])
+static uint32_t cyc_to_us(uint32_t cyc)
+{
+    const uint32_t cyc_per_us = SystemCoreClock / 1000000UL;
+    return (cyc_per_us != 0U) ? (cyc / cyc_per_us) : 0U;
+}
+
+// 今の生値を囲む窓を作って ISR の判定に渡す
+static void ui_control_arm_pot_wakeup(void)
+{
+    for (uint8_t ch = 0; ch < POT_NUM; ch++)
+    {
+        const uint32_t v = adc_val[ch][POT_ADC_RANK];
+        s_pot_win_lo[ch] = (uint16_t) ((v > POT_WAKE_BAND) ? (v - POT_WAKE_BAND) : 0U);
+        s_pot_win_hi[ch] = (uint16_t) (v + POT_WAKE_BAND);
+    }
+    s_pot_wake_pending = false;
+    __DMB();
+    s_pot_idle     = true;
+    s_ui.pot_still = 0;
+    s_wake.pot_arms++;
+}
+
+// 全ポットのサンプルは HPDMA のスキャンで揃っているので、毎回8ch分まとめて処理する
+// 量子化した値が変わったら、テイクオーバーを通して値が変わったときだけ割り当て先 (midi_map) に送る
+static void ui_control_process_pot(void)
+{
+    bool changed = false;
+
+    if (s_ui.pot_map_gen != midi_map_generation())
+    {
+        init_pot_filters();
+        ui_control_pot_takeover_resync();
+    }
+
+    for (uint8_t ch = 0; ch < POT_NUM; ch++)
+    {
+        const uint8_t src = MIDI_MAP_SRC_POT0 + ch;
+
+        if (pot_filter_update(&s_ui.pot_filt[ch], adc_val[ch][POT_ADC_RANK]))
         {
-            stable_count++;
+            s_ui.pot_val[ch] = pot_filter_value(&s_ui.pot_filt[ch]);
+            if ((ch == UI_MENU_POT) && OLED_MenuIsOpen())
+            {
+                OLED_MenuPot(s_ui.pot_val[ch], (uint16_t) pot_full_scale(ch));
+                changed = true;
+                continue;
+            }
+            // MIDI-learn 中は未キャッチでも操作子を選べるように渡す (値が同じなら midi_map が送らない)
+            if (pot_takeover_update(&s_ui.pot_take[ch], midi_map_takeover_mode(src), s_ui.pot_val[ch]) || midi_map_learn_active())
+            {
+                midi_map_emit(src, pot_takeover_value(&s_ui.pot_take[ch]), pot_full_scale(ch));
+            }
+            changed = true;
         }
-        if (s_ui.pot_val_prev[s_ui.pot_ch][0] == s_ui.pot_val_prev[s_ui.pot_ch][1])
+    }
+
+    if (!changed)
+    {
+        if (++s_ui.pot_still >= POT_IDLE_UPDATES)
         {
-            stable_count++;
+            ui_control_arm_pot_wakeup();
         }
+        return;
+    }
 
-        if (stable_count <= 1)
+    s_ui.pot_still = 0;
+    OLED_NotifyActivity();
+    if (s_pot_wake_pending)
+    {
+        const uint32_t us  = cyc_to_us(DWT->CYCCNT - s_pot_wake_cyc);
+        s_pot_wake_pending = false;
+        s_wake.pot_wake_n++;
+        s_wake.pot_wake_sum_us += us;
+        if (us > s_wake.pot_wake_max_us)
         {
-            apply_pot_value(s_ui.pot_ch, s_ui.pot_val[s_ui.pot_ch]);
+            s_wake.pot_wake_max_us = us;
         }
+    }
+}
 
-        s_ui.pot_val_prev[s_ui.pot_ch][1] = s_ui.pot_val_prev[s_ui.pot_ch][0];
-        s_ui.pot_val_prev[s_ui.pot_ch][0] = s_ui.pot_val[s_ui.pot_ch];
+static void ui_control_update_mag_samples(const uint16_t mag[MAG_SW_NUM], uint32_t blocks)
+{
+    for (int i = 0; i < MAG_SW_NUM; i++)
+    {
+        s_ui.mag_val[i] = mag[i];
+    }
 
-        s_ui.pot_ch         = (s_ui.pot_ch + 1) % POT_NUM;
-        s_ui.pot_ch_counter = 0;
+    switch (mag_calib_update(mag, blocks))
+    {
+    case MAG_CALIB_EVENT_READY:
+        mag_calib_report();
+        break;
+    case MAG_CALIB_EVENT_GUIDED_DONE:
+        // ここはフェーダーのブロック処理の中なので、EEPROM の書き込みは静止してから
+        s_ui.mag_calib_save_pending = true;
+        SEGGER_RTT_printf(0, "[MAGCAL] guided calibration done\n");
+        mag_calib_report();
+        break;
+    case MAG_CALIB_EVENT_GUIDED_FAILED:
+        SEGGER_RTT_printf(0, "[MAGCAL] guided calibration timed out (faders not still)\n");
+        break;
+    default:
+        break;
     }
 }
 
-static void ui_control_update_mag_samples(void)
+// オフセット + cut を 0、そこから MAG_XFADE_RANGE 先を XFADE_Q15_ONE とする
+static uint16_t mag_to_pos_q15(uint16_t mag, uint16_t offset, uint8_t cut)
 {
-    for (int i = 0; i < MAG_SW_NUM; i++)
+    const int32_t d = (int32_t) mag - (int32_t) offset - (int32_t) cut;
+
+    if (d <= 0)
     {
-        s_ui.mag_val[i] = (uint16_t) adc_val[i];
+        return 0;
+    }
+    if (d >= MAG_XFADE_RANGE)
+    {
+        return XFADE_Q15_ONE;
+    }
+    return (uint16_t) (((uint32_t) d * XFADE_Q15_ONE) / MAG_XFADE_RANGE);
+}
 
-        if (s_ui.mag_calibration_count < MAG_CALIBRATION_COUNT_MAX)
-        {
-            s_ui.mag_offset_sum[i] += adc_val[i];
-        }
-        else if (s_ui.mag_calibration_count == MAG_CALIBRATION_COUNT_MAX)
-        {
-            s_ui.mag_offset[i] = s_ui.mag_offset_sum[i] / MAG_CALIBRATION_COUNT_MAX;
-        }
+static uint8_t mag_sensor_cut(int i)
+{
+    if (i == 0 || i == 1)
+    {
+        return s_ui.xf_cut[XFADE_FADER_B];
     }
-    if (s_ui.mag_calibration_count <= MAG_CALIBRATION_COUNT_MAX)
+    if (i == 4 || i == 5)
     {
-        s_ui.mag_calibration_count++;
+        return s_ui.xf_cut[XFADE_FADER_A];
     }
+    return MAG_XFADE_CUTOFF;
 }
 
 static void ui_control_update_xfade_from_mag(void)
@@ -603,20 +887,11 @@ static void ui_control_update_xfade_from_mag(void)
     for (int j = 0; j < MAG_SW_NUM; j++)
     {
         int i = index[j];
+        const uint16_t pos = mag_to_pos_q15(s_ui.mag_val[i], mag_calib_offset((uint8_t) i), mag_sensor_cut(i));
+
         if (i == 0 || i == 5)
         {
-            if (s_ui.mag_val[i] < s_ui.mag_offset[i] + MAG_XFADE_CUTOFF)
-            {
-                s_ui.xfade[i] = 0.0f;
-            }
-            else if (s_ui.mag_val[i] >= s_ui.mag_offset[i] + MAG_XFADE_CUTOFF && s_ui.mag_val[i] <= s_ui.mag_offset[i] + MAG_XFADE_RANGE)
-            {
-                s_ui.xfade[i] = (float) (s_ui.mag_val[i] - s_ui.mag_offset[i] - MAG_XFADE_CUTOFF) / (float) MAG_XFADE_RANGE;
-            }
-            else if (s_ui.mag_val[i] > s_ui.mag_offset[i] + MAG_XFADE_RANGE)
-            {
-                s_ui.xfade[i] = 1.0f;
-            }
+            s_ui.xfade[i] = pos;
 
             if (s_ui.xfade[i] >= s_ui.xfade_max[i])
             {
@@ -634,32 +909,21 @@ static void ui_control_update_xfade_from_mag(void)
         }
         else
         {
-            if (s_ui.mag_val[i] < s_ui.mag_offset[i] + MAG_XFADE_CUTOFF)
-            {
-                s_ui.xfade[i] = 1.0f;
-            }
-            else if (s_ui.mag_val[i] >= s_ui.mag_offset[i] + MAG_XFADE_CUTOFF && s_ui.mag_val[i] <= s_ui.mag_offset[i] + MAG_XFADE_RANGE)
-            {
-                s_ui.xfade[i] = 1.0f - ((float) (s_ui.mag_val[i] - s_ui.mag_offset[i] - MAG_XFADE_CUTOFF) / (float) MAG_XFADE_RANGE);
-            }
-            else if (s_ui.mag_val[i] > s_ui.mag_offset[i] + MAG_XFADE_RANGE)
-            {
-                s_ui.xfade[i] = 0.0f;
-            }
+            s_ui.xfade[i] = XFADE_Q15_ONE - pos;
 
             if (s_ui.xfade[i] <= s_ui.xfade_min[i])
             {
                 s_ui.xfade_min[i] = s_ui.xfade[i];
 
-                if (s_ui.xfade_min[i] < 0.05f)
+                if (s_ui.xfade_min[i] < (XFADE_Q15_ONE / 20U))
                 {
                     if (i == 1)
                     {
-                        s_ui.xfade_max[0] = 0.0f;
+                        s_ui.xfade_max[0] = 0;
                     }
                     else if (i == 4)
                     {
-                        s_ui.xfade_max[5] = 0.0f;
+                        s_ui.xfade_max[5] = 0;
                     }
                 }
             }
@@ -667,15 +931,50 @@ static void ui_control_update_xfade_from_mag(void)
     }
 }
 
-static void ui_control_apply_xfade_updates(void)
+// フェーダー位置 (Q15、0 = カットイン位置より閉じている)
+static uint16_t xfade_pos_q15(uint8_t fader)
+{
+    if (fader == XFADE_FADER_A)
+    {
+        return (uint16_t) (((uint32_t) s_ui.xfade_max[5] * s_ui.xfade_min[4]) >> 15);
+    }
+    return (uint16_t) (((uint32_t) s_ui.xfade_max[0] * s_ui.xfade_min[1]) >> 15);
+}
+
+// フェーダー位置 (Q15) を選択中のカーブに通したゲイン (Q15)
+static uint16_t xfade_gain_q15(uint8_t fader)
+{
+    return xfade_curve_eval(s_ui.xf_curve[fader], xfade_pos_q15(fader));
+}
+
+static void apply_xfade_gain(uint8_t fader)
+{
+    const uint16_t g = xfade_gain_q15(fader);
+
+    if (fader == XFADE_FADER_A)
+    {
+        set_dc_inputA((float) g / (float) XFADE_Q15_ONE);
+        s_ui.current_xfA_position = (uint8_t) (g >> 8);
+    }
+    else
+    {
+        set_dc_inputB((float) g / (float) XFADE_Q15_ONE);
+        s_ui.current_xfB_position = (uint8_t) (g >> 8);
+    }
+}
+
+// DSP (set_dc_input*) に書いたら true
+static bool ui_control_apply_xfade_updates(void)
 {
-    bool xfadeA_changed = false;
-    bool xfadeB_changed = false;
+    bool xfadeA_changed = s_ui.xf_dirty;
+    bool xfadeB_changed = s_ui.xf_dirty;
+    s_ui.xf_dirty       = false;
+
     for (int i = 0; i < MAG_SW_NUM; i++)
     {
-        if (fabs(s_ui.xfade[i] - s_ui.xfade_prev[i]) > 0.01f)
+        if (abs((int32_t) s_ui.xfade[i] - (int32_t) s_ui.xfade_prev[i]) > (int32_t) (XFADE_Q15_ONE / 100U))
         {
-            send_control_change(10 + (5 - i), xfade_to_cc(s_ui.xfade[i]), 0);
+            midi_map_emit((uint8_t) (MIDI_MAP_SRC_MAG0 + i), s_ui.xfade[i], XFADE_Q15_ONE);
 
             if (i == 0 || i == 1)
             {
@@ -692,51 +991,119 @@ static void ui_control_apply_xfade_updates(void)
 
     if (xfadeA_changed)
     {
-        const float xf = pow(s_ui.xfade_max[5] * s_ui.xfade_min[4], 1.0f / 3.0f);
-        set_dc_inputA(xf);
-        s_ui.current_xfA_position = (uint8_t) (xf * 128.0f);
+        apply_xfade_gain(XFADE_FADER_A);
     }
 
     if (xfadeB_changed)
     {
-        const float xf = pow(s_ui.xfade_max[0] * s_ui.xfade_min[1], 1.0f / 3.0f);
-        set_dc_inputB(xf);
-        s_ui.current_xfB_position = (uint8_t) (xf * 128.0f);
+        apply_xfade_gain(XFADE_FADER_B);
     }
+
+    return xfadeA_changed || xfadeB_changed;
 }
 
 static void ui_control_process_mag(void)
 {
-    ui_control_update_mag_samples();
+    uint16_t mag[MAG_SW_NUM];
+    uint32_t block_cyc;
 
-    if (s_ui.mag_calibration_count > MAG_CALIBRATION_COUNT_MAX)
+    if (!mag_fader_read(mag, &block_cyc))
     {
-        ui_control_update_xfade_from_mag();
-        ui_control_apply_xfade_updates();
+        return;
     }
-}
 
-typedef void (*midi_program_handler_t)(uint8_t arg);
+    ui_control_update_mag_samples(mag, 1U);
 
-typedef struct
-{
-    uint8_t command;
-    midi_program_handler_t handler;
-    uint8_t arg;
-} midi_program_cmd_t;
+    if (mag_calib_is_ready())
+    {
+        ui_control_update_xfade_from_mag();
+        if (ui_control_apply_xfade_updates())
+        {
+            mag_fader_note_dsp_write(block_cyc);
+            OLED_NotifyActivity();
+        }
+    }
 
-static void midi_program_set_input_type(uint8_t arg)
-{
-    uint8_t input_ch   = (arg >> 4) & 0x0F;
-    uint8_t input_type = arg & 0x0F;
-    apply_input_type_change(input_ch, input_type);
+    // キャリブレーション中とカーブの書き直し待ちはブロック処理を続ける
+    if (mag_idle_update(&s_ui.mag_idle, mag, 1U) && mag_calib_is_ready() && !mag_calib_is_guided() && !s_ui.xf_dirty)
+    {
+        s_ui.mag_idle.still = 0;
+        s_ui.mag_idle_tick = osKernelGetTickCount();
+        mag_fader_arm_wakeup();
+    }
 }
 
-static void midi_program_apply_xf_a(uint8_t input_ch)
+// 保存待ち (ガイド付きキャリブレーションの結果、SysEx の保存) は、フェーダーが窓待ちの間 (ブロック処理が止まっている) だけ書く
+// 動かしている間は待たせておく
+static void ui_control_process_eeprom_save(void)
 {
-    apply_xf_assign_a(input_ch);
-}
-
+    if (!mag_fader_is_idle())
+    {
+        return;
+    }
+
+    if (s_ui.mag_calib_save_pending)
+    {
+        s_ui.mag_calib_save_pending = false;
+        if (mag_calib_save(&hi2c2) == HAL_OK)
+        {
+            led_notify_save_success();
+            SEGGER_RTT_printf(0, "[MAGCAL] guided calibration saved\n");
+        }
+        else
+        {
+            SEGGER_RTT_printf(0, "[MAGCAL] guided calibration save failed\n");
+        }
+    }
+    midi_sysex_flush_save();
+}
+
+// 窓待ち中はブロックが来ないので、タイムアウトで起きたときにバッファから読んでドリフト追従だけ進める
+// 待ちに入った時の基準から MAG_IDLE_BAND を出ていたら (窓の内側でゆっくり動いた時など) ブロック処理に戻す
+static void ui_control_process_mag_idle(void)
+{
+    uint16_t mag[MAG_SW_NUM];
+
+    if (!mag_fader_is_idle())
+    {
+        return;
+    }
+
+    const uint32_t now    = osKernelGetTickCount();
+    const uint32_t blocks = ((now - s_ui.mag_idle_tick) * (POT_SCAN_TIM_HZ / MAG_FADER_BLOCK_SCANS)) / 1000UL;
+    s_ui.mag_idle_tick    = now;
+
+    mag_fader_sample_idle(mag);
+    if (mag_idle_moved(&s_ui.mag_idle, mag))
+    {
+        s_wake.mag_timeout++;
+        mag_fader_wakeup();
+        return;
+    }
+    ui_control_update_mag_samples(mag, blocks);
+}
+
+typedef void (*midi_program_handler_t)(uint8_t arg);
+
+typedef struct
+{
+    uint8_t command;
+    midi_program_handler_t handler;
+    uint8_t arg;
+} midi_program_cmd_t;
+
+static void midi_program_set_input_type(uint8_t arg)
+{
+    uint8_t input_ch   = (arg >> 4) & 0x0F;
+    uint8_t input_type = arg & 0x0F;
+    apply_input_type_change(input_ch, input_type);
+}
+
+static void midi_program_apply_xf_a(uint8_t input_ch)
+{
+    apply_xf_assign_a(input_ch);
+}
+
 static void midi_program_apply_xf_b(uint8_t input_ch)
 {
     apply_xf_assign_b(input_ch);
@@ -754,25 +1121,127 @@ static void midi_program_enable_dvs(uint8_t arg)
     apply_dvs_state(input_ch, enable);
 }
 
-static bool ui_control_dispatch_midi_program_change(uint8_t program)
+// 実際の入れ替えは audio task 側で行う（SAIの再起動を伴うため）
+static void midi_program_dsp_library(uint8_t slot)
+{
+    (void) dsp_library_request(slot);
+}
+
+static void midi_program_mag_recal(uint8_t arg)
+{
+    (void) arg;
+    (void) mag_calib_start_guided();
+}
+
+static void midi_program_mag_report(uint8_t arg)
+{
+    (void) arg;
+    mag_calib_report();
+}
+
+// learn 中ならやめる
+static void midi_program_map_learn(uint8_t arg)
 {
-    if (program == 127U)
+    (void) arg;
+    if (midi_map_learn_active())
     {
-        EEPROM_DeviceConfig_t cfg;
+        midi_map_learn_cancel();
+        return;
+    }
+    (void) midi_map_learn_start();
+}
 
-        EEPROM_ConfigCaptureCurrent(&cfg);
-        if (EEPROM_SaveConfig(&hi2c2, &cfg) == HAL_OK)
-        {
-            led_notify_save_success();
-            SEGGER_RTT_printf(0, "EEPROM config saved by MIDI PC127: CH1=%u CH2=%u XFA=%u XFB=%u XFP=%u\r\n", (unsigned) cfg.current_ch1_input_type, (unsigned) cfg.current_ch2_input_type, (unsigned) cfg.current_xfA_assign, (unsigned) cfg.current_xfB_assign, (unsigned) cfg.current_xfpost_assign);
-        }
-        else
-        {
-            SEGGER_RTT_printf(0, "EEPROM config save failed by MIDI PC127\r\n");
-        }
-        return true;
+static void ui_control_save_config(const char* by)
+{
+    EEPROM_DeviceConfig_t cfg;
+
+    EEPROM_ConfigCaptureCurrent(&cfg);
+    if (EEPROM_SaveConfig(&hi2c2, &cfg) == HAL_OK)
+    {
+        led_notify_save_success();
+        SEGGER_RTT_printf(0, "EEPROM config saved by %s: CH1=%u CH2=%u XFA=%u XFB=%u XFP=%u\r\n", by, (unsigned) cfg.current_ch1_input_type, (unsigned) cfg.current_ch2_input_type, (unsigned) cfg.current_xfA_assign, (unsigned) cfg.current_xfB_assign, (unsigned) cfg.current_xfpost_assign);
+    }
+    else
+    {
+        SEGGER_RTT_printf(0, "EEPROM config save failed by %s\r\n", by);
+    }
+}
+
+// メニュー (oledTask) で変えた設定。適用と保存は adcTask で行う
+static UI_ControlPersistState_t s_menu_state;
+static volatile bool s_menu_state_pending;
+static volatile bool s_menu_state_save;
+
+void ui_control_request_persist_state(const UI_ControlPersistState_t* state, bool save)
+{
+    if (state == NULL)
+    {
+        return;
     }
 
+    const uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    memcpy(&s_menu_state, state, sizeof(s_menu_state));
+    s_menu_state_save    = s_menu_state_save || save;
+    s_menu_state_pending = true;
+    __set_PRIMASK(primask);
+
+    if (adcTaskHandle != NULL)
+    {
+        (void) osThreadFlagsSet(adcTaskHandle, UI_INPUT_THREAD_FLAG);
+    }
+}
+
+static void ui_control_process_menu_state(void)
+{
+    UI_ControlPersistState_t state;
+    bool save;
+
+    if (!s_menu_state_pending)
+    {
+        return;
+    }
+
+    const uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    memcpy(&state, &s_menu_state, sizeof(state));
+    save                 = s_menu_state_save;
+    s_menu_state_pending = false;
+    s_menu_state_save    = false;
+    __set_PRIMASK(primask);
+
+    if (!ui_control_apply_persist_state(&state))
+    {
+        SEGGER_RTT_printf(0, "[MENU] config rejected\n");
+        return;
+    }
+    if (save)
+    {
+        ui_control_save_config("menu");
+    }
+}
+
+static void midi_program_save_config(uint8_t arg)
+{
+    (void) arg;
+    ui_control_save_config("MIDI PC127");
+}
+
+// 受信 CC の種類 (s_midi_cc_lut)
+enum
+{
+    MIDI_CC_KIND_NONE = 0,
+    MIDI_CC_KIND_PHONO_EQ,
+    MIDI_CC_KIND_XFADE,
+};
+
+// 受信メッセージは番号で直接引く (ステータス毎に 128 エントリ)
+static midi_program_cmd_t s_midi_pc_lut[128];
+static uint8_t s_midi_cc_lut[128];
+static bool s_midi_lut_built = false;
+
+static void ui_control_build_midi_lut(void)
+{
     static const midi_program_cmd_t commands[] = {
         {CH1_LINE,             midi_program_set_input_type, (uint8_t) ((INPUT_CH1 << 4) | INPUT_TYPE_LINE) },
         {CH1_PHONO,            midi_program_set_input_type, (uint8_t) ((INPUT_CH1 << 4) | INPUT_TYPE_PHONO)},
@@ -794,50 +1263,540 @@ static bool ui_control_dispatch_midi_program_change(uint8_t program)
         {CH1_DVS_ENABLE,       midi_program_enable_dvs,     (uint8_t) ((INPUT_CH1 << 4) | 1U)              },
         {CH2_DVS_DISABLE,      midi_program_enable_dvs,     (uint8_t) ((INPUT_CH2 << 4) | 0U)              },
         {CH2_DVS_ENABLE,       midi_program_enable_dvs,     (uint8_t) ((INPUT_CH2 << 4) | 1U)              },
+        {MIDI_MAP_PC_LEARN,    midi_program_map_learn,      0U                                             },
+        {MAG_CALIB_PC_REPORT,  midi_program_mag_report,     0U                                             },
+        {MAG_CALIB_PC_RECAL,   midi_program_mag_recal,      0U                                             },
+        {127U,                 midi_program_save_config,    0U                                             },
     };
 
+    memset(s_midi_pc_lut, 0, sizeof(s_midi_pc_lut));
     for (uint32_t i = 0; i < TU_ARRAY_SIZE(commands); i++)
     {
-        if (commands[i].command == program)
+        s_midi_pc_lut[commands[i].command & 0x7FU] = commands[i];
+    }
+    for (uint32_t slot = 0; slot <= DSP_LIBRARY_SLOT_NUM; slot++)
+    {
+        midi_program_cmd_t* cmd = &s_midi_pc_lut[DSP_LIBRARY_PC_BASE + slot];
+        cmd->command            = (uint8_t) (DSP_LIBRARY_PC_BASE + slot);
+        cmd->handler            = midi_program_dsp_library;
+        cmd->arg                = (slot == DSP_LIBRARY_SLOT_NUM) ? DSP_LIBRARY_SLOT_BUILTIN : (uint8_t) slot;
+    }
+
+    memset(s_midi_cc_lut, MIDI_CC_KIND_NONE, sizeof(s_midi_cc_lut));
+    for (uint32_t n = PHONO_EQ_CC_CH1_CURVE; n <= PHONO_EQ_CC_CH2_TREBLE_FREQ; n++)
+    {
+        s_midi_cc_lut[n] = MIDI_CC_KIND_PHONO_EQ;
+    }
+    for (uint32_t n = XFADE_CC_A_CURVE; n <= XFADE_CC_B_CUT; n++)
+    {
+        s_midi_cc_lut[n] = MIDI_CC_KIND_XFADE;
+    }
+    for (uint32_t n = 0; n < XFADE_USER_POINT_NUM; n++)
+    {
+        s_midi_cc_lut[XFADE_CC_USER_POINT0 + n] = MIDI_CC_KIND_XFADE;
+    }
+    s_midi_lut_built = true;
+}
+
+static bool ui_control_dispatch_midi_program_change(uint8_t program)
+{
+    const midi_program_cmd_t* cmd = &s_midi_pc_lut[program & 0x7FU];
+
+    if (cmd->handler == NULL)
+    {
+        return false;
+    }
+    cmd->handler(cmd->arg);
+    return true;
+}
+
+static bool ui_control_stage_phono_eq_cc(uint8_t number, uint8_t value, phono_eq_config_t pending[2], uint8_t* dirty_mask)
+{
+    if ((number < PHONO_EQ_CC_CH1_CURVE) || (number > PHONO_EQ_CC_CH2_TREBLE_FREQ))
+    {
+        return false;
+    }
+
+    const uint8_t ch       = (number < PHONO_EQ_CC_CH2_CURVE) ? INPUT_CH1 : INPUT_CH2;
+    const uint8_t param    = (uint8_t) ((number - PHONO_EQ_CC_CH1_CURVE) % 4U);
+    phono_eq_config_t* cfg = &pending[ch];
+
+    if (((*dirty_mask & (1U << ch)) == 0U) && !get_phono_eq(ch, cfg))
+    {
+        return true;  // 今の設定が読めないので、この CC は捨てる
+    }
+
+    switch (param)
+    {
+    case 0:
+        if (value >= PHONO_CURVE_NUM)
         {
-            commands[i].handler(commands[i].arg);
             return true;
         }
+        cfg->curve = value;
+        break;
+    case 1:
+        if (value == 0U)
+        {
+            cfg->rumble_hz = 0U;
+        }
+        else
+        {
+            cfg->rumble_hz = (value < PHONO_EQ_RUMBLE_HZ_MIN) ? PHONO_EQ_RUMBLE_HZ_MIN : ((value > PHONO_EQ_RUMBLE_HZ_MAX) ? PHONO_EQ_RUMBLE_HZ_MAX : value);
+        }
+        break;
+    case 2:
+    {
+        // 64 = 0dB, 0.25dB/step
+        int16_t qdb       = (int16_t) value - 64;
+        const int16_t lim = (int16_t) (PHONO_EQ_TREBLE_DB_MAX * 4.0);
+        cfg->treble_qdb   = (int8_t) ((qdb > lim) ? lim : ((qdb < -lim) ? -lim : qdb));
+        break;
+    }
+    case 3:
+    {
+        uint16_t hz    = (uint16_t) value * 125U;
+        cfg->treble_hz = (hz < PHONO_EQ_TREBLE_HZ_MIN) ? PHONO_EQ_TREBLE_HZ_MIN : ((hz > PHONO_EQ_TREBLE_HZ_MAX) ? PHONO_EQ_TREBLE_HZ_MAX : hz);
+        break;
+    }
+    default:
+        break;
+    }
+
+    *dirty_mask |= (uint8_t) (1U << ch);
+    return true;
+}
+
+// ユーザーカーブの制御点は pending に貯めて、ループを抜けてから1回だけ表を作り直す
+static bool ui_control_stage_xfade_cc(uint8_t number, uint8_t value, uint8_t pending_points[XFADE_USER_POINT_NUM], bool* points_dirty)
+{
+    switch (number)
+    {
+    case XFADE_CC_A_CURVE:
+    case XFADE_CC_B_CURVE:
+        if (value < XFADE_CURVE_NUM)
+        {
+            const uint8_t fader  = (number == XFADE_CC_A_CURVE) ? XFADE_FADER_A : XFADE_FADER_B;
+            s_ui.xf_curve[fader] = value;
+            s_ui.xf_dirty        = true;
+            SEGGER_RTT_printf(0, "XF%c curve: %s\n", (fader == XFADE_FADER_A) ? 'A' : 'B', xfade_curve_name(value));
+        }
+        return true;
+    case XFADE_CC_A_CUT:
+    case XFADE_CC_B_CUT:
+        s_ui.xf_cut[(number == XFADE_CC_A_CUT) ? XFADE_FADER_A : XFADE_FADER_B] = (value > MAG_XFADE_CUT_MAX) ? MAG_XFADE_CUT_MAX : value;
+        s_ui.xf_dirty = true;
+        return true;
+    default:
+        break;
+    }
+
+    if ((number < XFADE_CC_USER_POINT0) || (number >= (XFADE_CC_USER_POINT0 + XFADE_USER_POINT_NUM)))
+    {
+        return false;
     }
-    return false;
+
+    if (!*points_dirty)
+    {
+        xfade_curve_get_user_points(pending_points);
+    }
+    pending_points[number - XFADE_CC_USER_POINT0] = value;
+    *points_dirty                                 = true;
+    return true;
 }
 
 static void ui_control_process_midi_rx(void)
 {
+    phono_eq_config_t phono_eq_pending[2];
+    uint8_t phono_eq_dirty = 0U;
+    uint8_t xf_points_pending[XFADE_USER_POINT_NUM];
+    bool xf_points_dirty = false;
+
+    static midi_sysex_rx_t sysex_rx;
+
+    if (!s_midi_lut_built)
+    {
+        ui_control_build_midi_lut();
+    }
+
     while (tud_midi_available())
     {
         uint8_t packet[4];
         tud_midi_packet_read(packet);
+        led_notify_midi_activity();
+        // クロック等のリアルタイムメッセージは流れ続けるので画面を起こさない
+        if (((packet[0] & 0x0FU) != 0xFU) || (packet[1] < 0xF8U))
+        {
+            OLED_NotifyActivity();
+        }
+
+        const uint8_t cin = packet[0] & 0x0FU;
+        if ((cin >= 0x4U) && (cin <= 0x7U))
+        {
+            if (midi_sysex_feed_packet(&sysex_rx, packet))
+            {
+                midi_sysex_handle(sysex_rx.buf, sysex_rx.len);
+            }
+            continue;
+        }
+
+        // MIDI-learn 中は、操作子を選んだ後の最初の CC/ノートを割り当てに使う
+        if (midi_map_learn_take(packet[1], packet[2]) == MIDI_MAP_LEARN_DONE)
+        {
+            if (midi_map_save(&hi2c2) == HAL_OK)
+            {
+                led_notify_save_success();
+            }
+            continue;
+        }
 
         if ((packet[1] & 0xF0) == 0xC0)
         {
             (void) ui_control_dispatch_midi_program_change(packet[2]);
         }
+        else if ((packet[1] & 0xF0) == 0xB0)
+        {
+            // ホストが割り当て先の CC を送り返してきたら、そのポットは今の値から拾い直す
+            ui_control_pot_takeover_follow(MIDI_MAP_TYPE_CC, packet[1] & 0x0FU, packet[2], packet[3]);
+
+            switch (s_midi_cc_lut[packet[2] & 0x7FU])
+            {
+            case MIDI_CC_KIND_PHONO_EQ:
+                (void) ui_control_stage_phono_eq_cc(packet[2], packet[3], phono_eq_pending, &phono_eq_dirty);
+                break;
+            case MIDI_CC_KIND_XFADE:
+                (void) ui_control_stage_xfade_cc(packet[2], packet[3], xf_points_pending, &xf_points_dirty);
+                break;
+            default:
+                break;
+            }
+        }
 
+#if MIDI_RX_LOG
         SEGGER_RTT_printf(0, "MIDI RX: 0x%02X 0x%02X 0x%02X(%d) 0x%02X(%d)\n", packet[0], packet[1], packet[2], packet[2], packet[3], packet[3]);
+#endif
+    }
+
+    // CCが連続で届いても係数の再計算とSafeLoadはチャンネル毎に1回だけ行う
+    for (uint8_t ch = INPUT_CH1; ch <= INPUT_CH2; ch++)
+    {
+        if ((phono_eq_dirty & (1U << ch)) != 0U)
+        {
+            if (!set_phono_eq(ch, &phono_eq_pending[ch]))
+            {
+                SEGGER_RTT_printf(0, "Phono EQ update failed: CH%u\n", (unsigned) (ch + 1U));
+            }
+        }
+    }
+
+    if (xf_points_dirty)
+    {
+        xfade_curve_set_user_points(xf_points_pending);
+        s_ui.xf_dirty = true;
+    }
+
+    (void) midi_map_learn_poll();
+}
+
+// プリセットは SW1 で順に呼び出し、長押しで今のスロットに保存する
+static void ui_gesture_preset_step(int8_t step)
+{
+    EEPROM_DeviceConfig_t cfg;
+
+    for (uint8_t n = 0; n < EEPROM_PRESET_NUM; n++)
+    {
+        s_preset_slot = (uint8_t) ((s_preset_slot + EEPROM_PRESET_NUM + step) % EEPROM_PRESET_NUM);
+        if (EEPROM_LoadPreset(&hi2c2, s_preset_slot, &cfg) == HAL_OK)
+        {
+            (void) EEPROM_ConfigApply(&cfg);
+            SEGGER_RTT_printf(0, "[INPUT] preset %u recalled\n", (unsigned) s_preset_slot);
+            return;
+        }
+    }
+    SEGGER_RTT_printf(0, "[INPUT] no preset stored\n");
+}
+
+static void ui_gesture_preset_next(const input_event_t* ev)
+{
+    (void) ev;
+    ui_gesture_preset_step(1);
+}
+
+static void ui_gesture_preset_prev(const input_event_t* ev)
+{
+    (void) ev;
+    ui_gesture_preset_step(-1);
+}
+
+static void ui_gesture_preset_store(const input_event_t* ev)
+{
+    EEPROM_DeviceConfig_t cfg;
+
+    (void) ev;
+    EEPROM_ConfigCaptureCurrent(&cfg);
+    if (EEPROM_SavePreset(&hi2c2, s_preset_slot, &cfg) == HAL_OK)
+    {
+        led_notify_save_success();
+        SEGGER_RTT_printf(0, "[INPUT] preset %u stored\n", (unsigned) s_preset_slot);
     }
 }
 
-void ui_control_task(void)
+static void ui_gesture_map_learn(const input_event_t* ev)
+{
+    (void) ev;
+    midi_program_map_learn(0U);
+}
+
+static void ui_gesture_mag_recal(const input_event_t* ev)
+{
+    (void) ev;
+    (void) mag_calib_start_guided();
+}
+
+static void ui_gesture_sub_view(const input_event_t* ev)
+{
+    (void) ev;
+    OLED_ToggleSubView();
+}
+
+static void ui_gesture_save_config(const input_event_t* ev)
+{
+    (void) ev;
+    ui_control_save_config("SW1+SW2");
+}
+
+static void ui_gesture_menu_next(const input_event_t* ev)
+{
+    (void) ev;
+    OLED_MenuKey(OLED_MENU_KEY_NEXT);
+}
+
+static void ui_gesture_menu_prev(const input_event_t* ev)
+{
+    (void) ev;
+    OLED_MenuKey(OLED_MENU_KEY_PREV);
+}
+
+static void ui_gesture_menu_enter(const input_event_t* ev)
+{
+    (void) ev;
+    OLED_MenuKey(OLED_MENU_KEY_ENTER);
+}
+
+static void ui_gesture_menu_back(const input_event_t* ev)
+{
+    (void) ev;
+    OLED_MenuKey(OLED_MENU_KEY_BACK);
+}
+
+// カット = ノートオン、開いた = ノートオフ
+static void ui_gesture_cut_note(const input_event_t* ev)
+{
+    const uint8_t on     = (ev->type == INPUT_EVENT_CUT) ? 1U : 0U;
+    const uint8_t msg[3] = {(uint8_t) ((on ? 0x90U : 0x80U) | UI_CUT_NOTE_CHANNEL), (uint8_t) (UI_CUT_NOTE_A + ev->src - UI_INPUT_XF_A_CUT), on ? 127U : 0U};
+    tud_midi_stream_write(0, msg, 3);
+    led_notify_midi_activity();
+}
+
+typedef struct
+{
+    uint8_t src;
+    uint8_t type;
+    void (*handler)(const input_event_t* ev);
+} ui_gesture_t;
+
+static const ui_gesture_t s_gestures[] = {
+    {UI_INPUT_SW1,      INPUT_EVENT_CLICK,  ui_gesture_preset_next },
+    {UI_INPUT_SW1,      INPUT_EVENT_DOUBLE, ui_gesture_preset_prev },
+    {UI_INPUT_SW1,      INPUT_EVENT_LONG,   ui_gesture_preset_store},
+    {UI_INPUT_SW2,      INPUT_EVENT_CLICK,  ui_gesture_map_learn   },
+    {UI_INPUT_SW2,      INPUT_EVENT_LONG,   ui_gesture_mag_recal   },
+    {UI_INPUT_SW2,      INPUT_EVENT_DOUBLE, ui_gesture_sub_view    },
+    {UI_INPUT_SW1,      INPUT_EVENT_CHORD,  ui_gesture_save_config },
+    {UI_INPUT_XF_A_CUT, INPUT_EVENT_CUT,    ui_gesture_cut_note    },
+    {UI_INPUT_XF_A_CUT, INPUT_EVENT_OPEN,   ui_gesture_cut_note    },
+    {UI_INPUT_XF_B_CUT, INPUT_EVENT_CUT,    ui_gesture_cut_note    },
+    {UI_INPUT_XF_B_CUT, INPUT_EVENT_OPEN,   ui_gesture_cut_note    },
+};
+
+// メニューを開いている間の SW1/SW2 (フェーダーのカットは s_gestures のまま)
+static const ui_gesture_t s_menu_gestures[] = {
+    {UI_INPUT_SW1, INPUT_EVENT_CLICK,  ui_gesture_menu_next  },
+    {UI_INPUT_SW1, INPUT_EVENT_DOUBLE, ui_gesture_menu_prev  },
+    {UI_INPUT_SW2, INPUT_EVENT_CLICK,  ui_gesture_menu_enter },
+    {UI_INPUT_SW2, INPUT_EVENT_LONG,   ui_gesture_menu_back  },
+    {UI_INPUT_SW2, INPUT_EVENT_DOUBLE, ui_gesture_sub_view   },
+    {UI_INPUT_SW1, INPUT_EVENT_CHORD,  ui_gesture_save_config},
+};
+
+static uint32_t ui_control_input_levels(void)
+{
+    const uint32_t pressed = ~s_sw_idr;
+    uint32_t levels        = 0;
+
+    if ((pressed & SW1_Pin) != 0U)
+    {
+        levels |= 1UL << UI_INPUT_SW1;
+    }
+    if ((pressed & SW2_Pin) != 0U)
+    {
+        levels |= 1UL << UI_INPUT_SW2;
+    }
+    if (mag_calib_is_ready())
+    {
+        if (xfade_pos_q15(XFADE_FADER_A) == 0U)
+        {
+            levels |= 1UL << UI_INPUT_XF_A_CUT;
+        }
+        if (xfade_pos_q15(XFADE_FADER_B) == 0U)
+        {
+            levels |= 1UL << UI_INPUT_XF_B_CUT;
+        }
+    }
+    return levels;
+}
+
+static void ui_control_process_input(void)
+{
+    input_event_t ev[8];
+    const uint8_t n = input_event_update(&s_input, osKernelGetTickCount(), ui_control_input_levels(), ev, (uint8_t) TU_ARRAY_SIZE(ev));
+
+    if (n != 0U)
+    {
+        OLED_NotifyActivity();
+    }
+
+    for (uint8_t i = 0; i < n; i++)
+    {
+#if UI_INPUT_LOG
+        SEGGER_RTT_printf(0, "[INPUT] src=%u type=%u arg=%u\n", (unsigned) ev[i].src, (unsigned) ev[i].type, (unsigned) ev[i].arg);
+#endif
+        const bool menu               = OLED_MenuIsOpen() && (ev[i].src <= UI_INPUT_SW2);
+        const ui_gesture_t* table     = menu ? s_menu_gestures : s_gestures;
+        const uint32_t num            = menu ? TU_ARRAY_SIZE(s_menu_gestures) : TU_ARRAY_SIZE(s_gestures);
+
+        for (uint32_t k = 0; k < num; k++)
+        {
+            if ((table[k].src == ev[i].src) && (table[k].type == ev[i].type))
+            {
+                table[k].handler(&ev[i]);
+            }
+        }
+    }
+}
+
+// adcTask の次の待ち時間。ボタンの判定待ち (チャタリング除去、長押し、ダブル) がある間はその時刻まで
+uint32_t ui_control_wake_timeout(void)
+{
+    const uint32_t next = input_event_next_ms(&s_input, osKernelGetTickCount());
+
+    if (next >= UI_IDLE_POLL_MS)
+    {
+        return UI_IDLE_POLL_MS;
+    }
+    return (next != 0U) ? next : 1U;
+}
+
+// adcTask がスレッドフラグで起きる度に呼ぶ。flags = 0 は ui_control_wake_timeout のタイムアウト
+// MAG_FADER_THREAD_FLAG: ADC2 のブロック毎 (静止中はセンサーのどれかが窓を出た時だけ)
+// UI_POT_THREAD_FLAG: ポットが動いている間は2ms毎 (静止中は窓を出た時だけ)
+// UI_MIDI_THREAD_FLAG: USB MIDI 受信
+// UI_INPUT_THREAD_FLAG: SW1/SW2 の変化
+void ui_control_wake(uint32_t flags)
 {
 #if !ENABLE_DSP_RUNTIME_CONTROL
     return;
 #endif
 
-    if (!is_started_audio_control() || !is_adc_complete)
+    if (!is_started_audio_control())
     {
         return;
     }
 
-    ui_control_process_pot();
-    ui_control_process_mag();
-    ui_control_process_midi_rx();
-    is_adc_complete = false;
+    s_wake.wakeups++;
+    if (flags == 0U)
+    {
+        s_wake.timeout++;
+        ui_control_process_mag_idle();
+    }
+
+    if ((flags & MAG_FADER_THREAD_FLAG) != 0U)
+    {
+        s_wake.mag++;
+        ui_control_process_mag();
+    }
+
+    // 割り当てが変わったら (SysEx / MIDI-learn) 窓待ちをやめて新しい割り当てに送り直す
+    if (s_pot_idle && (s_ui.pot_map_gen != midi_map_generation()))
+    {
+        s_pot_idle = false;
+    }
+    if (((flags & UI_POT_THREAD_FLAG) != 0U) && is_adc_complete)
+    {
+        s_wake.pot++;
+        is_adc_complete = false;
+        ui_control_process_pot();
+    }
+
+    // MIDI は受信時とタイムアウト (MIDI-learn の期限) に加え、ポットの処理のついでにも読む
+    if ((flags == 0U) || ((flags & (UI_MIDI_THREAD_FLAG | UI_POT_THREAD_FLAG)) != 0U))
+    {
+        if ((flags & UI_MIDI_THREAD_FLAG) != 0U)
+        {
+            s_wake.midi++;
+        }
+        ui_control_process_midi_rx();
+    }
+
+    // カーブ/カットインの変更は次のブロックで DSP に書くので、窓待ちなら戻す
+    if (s_ui.xf_dirty)
+    {
+        mag_fader_wakeup();
+    }
+
+    // SW1/SW2 の変化 (UI_INPUT_THREAD_FLAG) と判定待ちのタイムアウト、フェーダーのカットを見る
+    ui_control_process_input();
+
+    // メニューで変えた設定 (UI_INPUT_THREAD_FLAG で起こされる)
+    ui_control_process_menu_state();
+
+    ui_control_process_eeprom_save();
+}
+
+// 前回の report 以降の起床回数と、run-time stats (1us) から見た adcTask / Idle の CPU 使用率を出す
+void ui_control_wake_report(void)
+{
+    static uint32_t s_prev_total;
+    static uint32_t s_prev_task;
+    static uint32_t s_prev_idle;
+    ui_wake_stats_t st;
+
+    const uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    memcpy(&st, &s_wake, sizeof(st));
+    memset(&s_wake, 0, sizeof(s_wake));
+    __set_PRIMASK(primask);
+
+    const uint32_t total   = portGET_RUN_TIME_COUNTER_VALUE();
+    const uint32_t task    = (adcTaskHandle != NULL) ? ulTaskGetRunTimeCounter((TaskHandle_t) adcTaskHandle) : 0U;
+    const uint32_t idle    = ulTaskGetIdleRunTimeCounter();
+    const uint32_t span    = (total != s_prev_total) ? (total - s_prev_total) : 1U;
+    const uint32_t task_pm = (uint32_t) (((uint64_t) (task - s_prev_task) * 1000U) / span);
+    const uint32_t idle_pm = (uint32_t) (((uint64_t) (idle - s_prev_idle) * 1000U) / span);
+    s_prev_total = total;
+    s_prev_task  = task;
+    s_prev_idle  = idle;
+
+    const uint32_t n = (st.pot_wake_n != 0U) ? st.pot_wake_n : 1U;
+    SEGGER_RTT_printf(0, "[WAKE] up=%lu mag=%lu pot=%lu midi=%lu tmo=%lu(mag %lu) adcTask=%lu.%lu%% idle=%lu.%lu%%\n",
+                      (unsigned long) st.wakeups, (unsigned long) st.mag, (unsigned long) st.pot,
+                      (unsigned long) st.midi, (unsigned long) st.timeout, (unsigned long) st.mag_timeout,
+                      (unsigned long) (task_pm / 10U),
+                      (unsigned long) (task_pm % 10U), (unsigned long) (idle_pm / 10U), (unsigned long) (idle_pm % 10U));
+    SEGGER_RTT_printf(0, "[WAKE] pot arm=%lu exit=%lu wake->out=%lu/%lu us(avg/max, n=%lu)%s\n",
+                      (unsigned long) st.pot_arms, (unsigned long) st.pot_exits,
+                      (unsigned long) (st.pot_wake_sum_us / n), (unsigned long) st.pot_wake_max_us,
+                      (unsigned long) st.pot_wake_n, s_pot_idle ? " idle" : "");
 }
 
 void start_audio_control(void)
@@ -865,6 +1824,12 @@ void ui_control_get_persist_state(UI_ControlPersistState_t* state)
     state->current_xfpost_assign  = s_ui.current_xfpost_assign;
     state->current_ch1_dvs_enable = s_ui.current_ch1_dvs_enable;
     state->current_ch2_dvs_enable = s_ui.current_ch2_dvs_enable;
+    for (uint8_t f = 0; f < XFADE_FADER_NUM; f++)
+    {
+        state->current_xf_curve[f] = s_ui.xf_curve[f];
+        state->current_xf_cut[f]   = s_ui.xf_cut[f];
+    }
+    xfade_curve_get_user_points(state->current_xf_user_curve);
 }
 
 bool ui_control_apply_persist_state(const UI_ControlPersistState_t* state)
@@ -886,6 +1851,14 @@ bool ui_control_apply_persist_state(const UI_ControlPersistState_t* state)
         return false;
     }
 
+    for (uint8_t f = 0; f < XFADE_FADER_NUM; f++)
+    {
+        if ((state->current_xf_curve[f] >= XFADE_CURVE_NUM) || (state->current_xf_cut[f] > MAG_XFADE_CUT_MAX))
+        {
+            return false;
+        }
+    }
+
     if (!ui_control_assign_to_input_ch(state->current_xfA_assign, &input_ch_a) ||
         !ui_control_assign_to_input_ch(state->current_xfB_assign, &input_ch_b) ||
         !ui_control_assign_to_input_ch(state->current_xfpost_assign, &input_ch_post))
@@ -901,35 +1874,49 @@ bool ui_control_apply_persist_state(const UI_ControlPersistState_t* state)
     apply_dvs_state(INPUT_CH1, state->current_ch1_dvs_enable != 0U);
     apply_dvs_state(INPUT_CH2, state->current_ch2_dvs_enable != 0U);
 
+    xfade_curve_set_user_points(state->current_xf_user_curve);
+    for (uint8_t f = 0; f < XFADE_FADER_NUM; f++)
+    {
+        s_ui.xf_curve[f] = state->current_xf_curve[f];
+        s_ui.xf_cut[f]   = state->current_xf_cut[f];
+    }
+    s_ui.xf_dirty = true;
+
     return true;
 }
 
+void ui_control_restore_dsp_state(void)
+{
+    UI_ControlPersistState_t state;
+
+    // DSPプログラムの再ダウンロードで全パラメータが初期値に戻るため、現在のUI状態を書き戻す
+    ui_control_get_persist_state(&state);
+    (void) ui_control_apply_persist_state(&state);
+
+    apply_xfade_gain(XFADE_FADER_A);
+    apply_xfade_gain(XFADE_FADER_B);
+
+    ui_control_set_dsp_param(MIDI_MAP_DSP_CH1_GAIN, s_ui.dsp_param[MIDI_MAP_DSP_CH1_GAIN]);
+    ui_control_set_dsp_param(MIDI_MAP_DSP_CH2_GAIN, s_ui.dsp_param[MIDI_MAP_DSP_CH2_GAIN]);
+    ui_control_set_dsp_param(MIDI_MAP_DSP_DRY_WET, s_ui.dsp_param[MIDI_MAP_DSP_DRY_WET]);
+
+    // ダウンロード直後はミュートしているので、マスターは最後に戻す
+    ui_control_set_dsp_param(MIDI_MAP_DSP_MASTER_GAIN, s_ui.dsp_param[MIDI_MAP_DSP_MASTER_GAIN]);
+}
+
 void ui_control_reset_state(void)
 {
-    for (uint16_t i = 0; i < ADC_NUM; i++)
-    {
-        adc_val[i] = 0;
-    }
+    memset(adc_val, 0, sizeof(adc_val));
 
-    for (uint16_t i = 0; i < POT_NUM; i++)
-    {
-        s_ui.pot_ma_index[i]    = 0;
-        s_ui.pot_val[i]         = 0;
-        s_ui.pot_val_prev[i][0] = 0;
-        s_ui.pot_val_prev[i][1] = 0;
-        for (uint16_t j = 0; j < POT_MA_SIZE; j++)
-        {
-            s_ui.pot_val_ma[i][j] = 0;
-        }
-    }
+    init_pot_filters();
 
-    s_ui.mag_calibration_count = 0;
+    mag_calib_reset();
     for (uint16_t i = 0; i < MAG_SW_NUM; i++)
     {
-        s_ui.mag_val[i]        = 0;
-        s_ui.mag_offset_sum[i] = 0;
-        s_ui.mag_offset[i]     = 0;
+        s_ui.mag_val[i] = 0;
     }
+    mag_idle_reset(&s_ui.mag_idle);
+    s_ui.pot_still = 0;
 
     s_ui.current_ch1_input_type = INPUT_TYPE_LINE;
     s_ui.current_ch2_input_type = INPUT_TYPE_LINE;
@@ -943,13 +1930,19 @@ void ui_control_reset_state(void)
 
     for (uint16_t i = 0; i < MAG_SW_NUM; i++)
     {
-        s_ui.xfade[i]      = 1.0f;
-        s_ui.xfade_prev[i] = 1.0f;
-        s_ui.xfade_min[i]  = 1.0f;
-        s_ui.xfade_max[i]  = 0.0f;
+        s_ui.xfade[i]      = XFADE_Q15_ONE;
+        s_ui.xfade_prev[i] = XFADE_Q15_ONE;
+        s_ui.xfade_min[i]  = XFADE_Q15_ONE;
+        s_ui.xfade_max[i]  = 0;
+    }
+    for (uint8_t f = 0; f < XFADE_FADER_NUM; f++)
+    {
+        s_ui.xf_curve[f] = XFADE_CURVE_SCRATCH;
+        s_ui.xf_cut[f]   = MAG_XFADE_CUTOFF;
     }
+    s_ui.xf_dirty = false;
 
-    s_ui.pot_ch         = 0;
-    s_ui.pot_ch_counter = 0;
-    is_adc_complete     = false;
+    s_pot_idle         = false;
+    s_pot_wake_pending = false;
+    is_adc_complete    = false;
 }
@@ -12,5 +12,8 @@
 void ui_control_reset_state(void);
 void ui_control_set_adc_complete(bool complete);
 void ui_control_dma_adc_cplt(DMA_HandleTypeDef* hdma);
+void ui_control_restart_adc_scan(void);
+void ui_control_restore_dsp_state(void);
+void ui_control_set_dsp_param(uint8_t param, uint16_t value);
 
 #endif /* UI_CONTROL_INTERNAL_H_ */
@@ -0,0 +1,51 @@
+/*
+ * ws2812.c
+ *
+ *  Created on: Mar 16, 2026
+ */
+
+#include "ws2812.h"
+
+#include <math.h>
+#include <string.h>
+
+// 4 bit (MSB が先) → PWM 4 byte を 1 word で。アドレスの小さい方が先に送られる
+#define WS2812_NIB_BYTE(n, k) ((((n) >> (3 - (k))) & 1U) ? WS2812_PWM_ONE : WS2812_PWM_ZERO)
+#define WS2812_NIB(n)                                                                                           \
+    ((uint32_t) WS2812_NIB_BYTE(n, 0) | ((uint32_t) WS2812_NIB_BYTE(n, 1) << 8) |                               \
+     ((uint32_t) WS2812_NIB_BYTE(n, 2) << 16) | ((uint32_t) WS2812_NIB_BYTE(n, 3) << 24))
+
+static const uint32_t s_nibble_lut[16] = {
+    WS2812_NIB(0U),  WS2812_NIB(1U),  WS2812_NIB(2U),  WS2812_NIB(3U),  WS2812_NIB(4U),  WS2812_NIB(5U),
+    WS2812_NIB(6U),  WS2812_NIB(7U),  WS2812_NIB(8U),  WS2812_NIB(9U),  WS2812_NIB(10U), WS2812_NIB(11U),
+    WS2812_NIB(12U), WS2812_NIB(13U), WS2812_NIB(14U), WS2812_NIB(15U),
+};
+
+// grb の len byte を out (len * WS2812_BYTE_LEN byte) に展開する
+void ws2812_encode(const uint8_t* grb, uint16_t len, uint8_t* out)
+{
+    for (uint16_t i = 0; i < len; i++)
+    {
+        const uint32_t hi = s_nibble_lut[grb[i] >> 4];
+        const uint32_t lo = s_nibble_lut[grb[i] & 0x0FU];
+
+        memcpy(&out[i * WS2812_BYTE_LEN], &hi, sizeof(hi));
+        memcpy(&out[i * WS2812_BYTE_LEN + 4U], &lo, sizeof(lo));
+    }
+}
+
+// 知覚的に均等な値 (0-255) → LED の PWM 値。明るさも一緒にかける (0 以外は 0 にしない)
+void ws2812_build_gamma(uint8_t lut[256], float gamma, uint8_t brightness)
+{
+    for (uint32_t v = 0; v < 256U; v++)
+    {
+        const float y = powf((float) v / 255.0f, gamma) * (float) brightness;
+        uint32_t out  = (uint32_t) (y + 0.5f);
+
+        if ((out == 0U) && (v != 0U) && (brightness != 0U))
+        {
+            out = 1U;
+        }
+        lut[v] = (uint8_t) ((out > 255U) ? 255U : out);
+    }
+}
@@ -0,0 +1,112 @@
+/*
+ * xfade_curve.c
+ *
+ *  Created on: Mar 9, 2026
+ */
+
+#include "xfade_curve.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define XFADE_USER_POINT_MAX 127U
+
+static const char* const s_curve_name[XFADE_CURVE_NUM] = {
+    [XFADE_CURVE_LINEAR]      = "Linear",
+    [XFADE_CURVE_CONST_POWER] = "Power",
+    [XFADE_CURVE_SHARP]       = "Sharp",
+    [XFADE_CURVE_SCRATCH]     = "Scratch",
+    [XFADE_CURVE_USER]        = "User",
+};
+
+static uint8_t s_user_points[XFADE_USER_POINT_NUM];
+static uint16_t s_user_lut[XFADE_CURVE_LUT_SIZE];
+static bool s_user_valid = false;
+
+static const uint16_t* xfade_curve_table(uint8_t curve)
+{
+    if (curve < XFADE_CURVE_USER)
+    {
+        return xfade_curve_lut[curve];
+    }
+    if ((curve == XFADE_CURVE_USER) && s_user_valid)
+    {
+        return s_user_lut;
+    }
+    return xfade_curve_lut[XFADE_CURVE_LINEAR];
+}
+
+// 表の隣接点を線形補間する。整数演算のみなので同じ入力には常に同じ値を返す
+uint16_t xfade_curve_eval(uint8_t curve, uint16_t pos_q15)
+{
+    const uint16_t* lut = xfade_curve_table(curve);
+
+    if (pos_q15 >= XFADE_Q15_ONE)
+    {
+        return lut[XFADE_CURVE_LUT_SIZE - 1U];
+    }
+
+    const uint32_t t = (uint32_t) pos_q15 * (XFADE_CURVE_LUT_SIZE - 1U);
+    const uint32_t i = t >> 15;
+    const uint32_t f = t & 0x7FFFU;
+
+    return (uint16_t) (lut[i] + (((uint32_t) (lut[i + 1U] - lut[i]) * f) >> 15));
+}
+
+// 端点は 0/127 に固定し、途中は前の点を下回らないように丸めて単調にする
+void xfade_curve_set_user_points(const uint8_t points[XFADE_USER_POINT_NUM])
+{
+    uint16_t y[XFADE_USER_POINT_NUM];
+    uint8_t prev = 0;
+
+    for (uint32_t k = 0; k < XFADE_USER_POINT_NUM; k++)
+    {
+        uint8_t p = (points[k] > XFADE_USER_POINT_MAX) ? XFADE_USER_POINT_MAX : points[k];
+
+        if (k == 0U)
+        {
+            p = 0;
+        }
+        else if (k == (XFADE_USER_POINT_NUM - 1U))
+        {
+            p = XFADE_USER_POINT_MAX;
+        }
+        else if (p < prev)
+        {
+            p = prev;
+        }
+        s_user_points[k] = p;
+        y[k]             = (uint16_t) (((uint32_t) p * XFADE_Q15_ONE + (XFADE_USER_POINT_MAX / 2U)) / XFADE_USER_POINT_MAX);
+        prev             = p;
+    }
+
+    const uint32_t seg_num = XFADE_USER_POINT_NUM - 1U;
+    for (uint32_t i = 0; i < XFADE_CURVE_LUT_SIZE; i++)
+    {
+        const uint32_t t = i * seg_num;
+        const uint32_t k = t / (XFADE_CURVE_LUT_SIZE - 1U);
+        const uint32_t f = t % (XFADE_CURVE_LUT_SIZE - 1U);
+
+        if (k >= seg_num)
+        {
+            s_user_lut[i] = y[seg_num];
+            continue;
+        }
+        s_user_lut[i] = (uint16_t) (y[k] + ((uint32_t) (y[k + 1U] - y[k]) * f) / (XFADE_CURVE_LUT_SIZE - 1U));
+    }
+    s_user_valid = true;
+}
+
+void xfade_curve_get_user_points(uint8_t points[XFADE_USER_POINT_NUM])
+{
+    for (uint32_t k = 0; k < XFADE_USER_POINT_NUM; k++)
+    {
+        // 未設定なら直線
+        points[k] = s_user_valid ? s_user_points[k] : (uint8_t) ((k * XFADE_USER_POINT_MAX) / (XFADE_USER_POINT_NUM - 1U));
+    }
+}
+
+const char* xfade_curve_name(uint8_t curve)
+{
+    return (curve < XFADE_CURVE_NUM) ? s_curve_name[curve] : "?";
+}
@@ -0,0 +1,146 @@
+/*
+ * xfade_curve_lut.c
+ *
+ *  Generated by tools/xfade_curve_gen.go. Do not edit.
+ */
+
+#include "xfade_curve.h"
+
+const uint16_t xfade_curve_lut[XFADE_CURVE_USER][XFADE_CURVE_LUT_SIZE] = {
+    [XFADE_CURVE_LINEAR] = {
+            0,   129,   257,   386,   514,   643,   771,   900,
+         1028,  1157,  1285,  1414,  1542,  1671,  1799,  1928,
+         2056,  2185,  2313,  2442,  2570,  2699,  2827,  2956,
+         3084,  3213,  3341,  3470,  3598,  3727,  3855,  3984,
+         4112,  4241,  4369,  4498,  4626,  4755,  4883,  5012,
+         5140,  5269,  5397,  5526,  5654,  5783,  5911,  6040,
+         6168,  6297,  6425,  6554,  6682,  6811,  6939,  7068,
+         7196,  7325,  7453,  7582,  7710,  7839,  7967,  8096,
+         8224,  8353,  8481,  8610,  8738,  8867,  8995,  9124,
+         9252,  9381,  9509,  9638,  9766,  9895, 10023, 10152,
+        10280, 10409, 10537, 10666, 10794, 10923, 11051, 11180,
+        11308, 11437, 11565, 11694, 11822, 11951, 12079, 12208,
+        12336, 12465, 12593, 12722, 12850, 12979, 13107, 13236,
+        13364, 13493, 13621, 13750, 13878, 14007, 14135, 14264,
+        14392, 14521, 14649, 14778, 14906, 15035, 15163, 15292,
+        15420, 15549, 15677, 15806, 15934, 16063, 16191, 16320,
+        16448, 16577, 16705, 16834, 16962, 17091, 17219, 17348,
+        17476, 17605, 17733, 17862, 17990, 18119, 18247, 18376,
+        18504, 18633, 18761, 18890, 19018, 19147, 19275, 19404,
+        19532, 19661, 19789, 19918, 20046, 20175, 20303, 20432,
+        20560, 20689, 20817, 20946, 21074, 21203, 21331, 21460,
+        21588, 21717, 21845, 21974, 22102, 22231, 22359, 22488,
+        22616, 22745, 22873, 23002, 23130, 23259, 23387, 23516,
+        23644, 23773, 23901, 24030, 24158, 24287, 24415, 24544,
+        24672, 24801, 24929, 25058, 25186, 25315, 25443, 25572,
+        25700, 25829, 25957, 26086, 26214, 26343, 26471, 26600,
+        26728, 26857, 26985, 27114, 27242, 27371, 27499, 27628,
+        27756, 27885, 28013, 28142, 28270, 28399, 28527, 28656,
+        28784, 28913, 29041, 29170, 29298, 29427, 29555, 29684,
+        29812, 29941, 30069, 30198, 30326, 30455, 30583, 30712,
+        30840, 30969, 31097, 31226, 31354, 31483, 31611, 31740,
+        31868, 31997, 32125, 32254, 32382, 32511, 32639, 32768,
+    },
+    [XFADE_CURVE_CONST_POWER] = {
+            0,   202,   404,   606,   807,  1009,  1211,  1413,
+         1614,  1816,  2017,  2219,  2420,  2621,  2822,  3023,
+         3224,  3425,  3626,  3826,  4027,  4227,  4427,  4627,
+         4827,  5026,  5226,  5425,  5624,  5823,  6021,  6219,
+         6417,  6615,  6813,  7010,  7207,  7404,  7600,  7797,
+         7993,  8188,  8383,  8578,  8773,  8967,  9161,  9355,
+         9548,  9741,  9934, 10126, 10318, 10509, 10700, 10891,
+        11081, 11271, 11460, 11649, 11837, 12025, 12213, 12400,
+        12586, 12773, 12958, 13143, 13328, 13512, 13696, 13879,
+        14061, 14243, 14425, 14606, 14786, 14966, 15145, 15324,
+        15502, 15680, 15857, 16033, 16209, 16384, 16558, 16732,
+        16906, 17078, 17250, 17421, 17592, 17762, 17931, 18100,
+        18268, 18435, 18602, 18767, 18932, 19097, 19261, 19423,
+        19586, 19747, 19908, 20068, 20227, 20385, 20543, 20700,
+        20856, 21011, 21166, 21319, 21472, 21624, 21776, 21926,
+        22076, 22224, 22372, 22519, 22666, 22811, 22955, 23099,
+        23242, 23384, 23525, 23665, 23804, 23942, 24079, 24216,
+        24351, 24486, 24620, 24752, 24884, 25015, 25145, 25274,
+        25402, 25529, 25655, 25780, 25904, 26027, 26149, 26271,
+        26391, 26510, 26628, 26745, 26861, 26976, 27090, 27203,
+        27315, 27426, 27536, 27645, 27753, 27860, 27966, 28070,
+        28174, 28276, 28378, 28478, 28578, 28676, 28773, 28869,
+        28964, 29058, 29151, 29242, 29333, 29422, 29510, 29598,
+        29684, 29769, 29852, 29935, 30017, 30097, 30176, 30254,
+        30331, 30407, 30482, 30555, 30628, 30699, 30769, 30838,
+        30905, 30972, 31037, 31101, 31164, 31226, 31287, 31346,
+        31404, 31461, 31517, 31572, 31625, 31677, 31728, 31778,
+        31827, 31874, 31921, 31966, 32009, 32052, 32093, 32133,
+        32172, 32210, 32247, 32282, 32316, 32349, 32380, 32411,
+        32440, 32468, 32494, 32520, 32544, 32567, 32588, 32609,
+        32628, 32646, 32663, 32679, 32693, 32706, 32718, 32728,
+        32738, 32746, 32752, 32758, 32762, 32766, 32767, 32768,
+    },
+    [XFADE_CURVE_SHARP] = {
+            0,  1997,  3879,  5653,  7324,  8898, 10381, 11777,
+        13091, 14328, 15491, 16586, 17615, 18582, 19492, 20346,
+        21149, 21903, 22611, 23275, 23899, 24484, 25032, 25547,
+        26029, 26481, 26904, 27301, 27672, 28020, 28345, 28649,
+        28934, 29200, 29448, 29681, 29898, 30100, 30290, 30466,
+        30631, 30785, 30928, 31061, 31186, 31301, 31409, 31510,
+        31603, 31690, 31771, 31846, 31915, 31980, 32040, 32096,
+        32148, 32196, 32240, 32282, 32320, 32355, 32388, 32418,
+        32446, 32472, 32496, 32518, 32539, 32558, 32575, 32591,
+        32606, 32619, 32632, 32644, 32654, 32664, 32673, 32681,
+        32689, 32696, 32702, 32708, 32713, 32718, 32723, 32727,
+        32730, 32734, 32737, 32740, 32743, 32745, 32747, 32749,
+        32751, 32753, 32754, 32755, 32757, 32758, 32759, 32760,
+        32761, 32761, 32762, 32763, 32763, 32764, 32764, 32764,
+        32765, 32765, 32765, 32766, 32766, 32766, 32766, 32767,
+        32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+        32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768,
+        32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768,
+        32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768,
+        32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768,
+        32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768,
+        32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768,
+        32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768,
+        32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768,
+        32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768,
+        32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768,
+        32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768,
+        32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768,
+        32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768,
+        32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768,
+        32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768,
+        32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768,
+    },
+    [XFADE_CURVE_SCRATCH] = {
+            0,  5167,  6510,  7453,  8203,  8836,  9390,  9885,
+        10335, 10749, 11133, 11492, 11830, 12150, 12454, 12744,
+        13021, 13287, 13542, 13789, 14026, 14256, 14479, 14695,
+        14905, 15109, 15308, 15502, 15691, 15876, 16056, 16233,
+        16405, 16575, 16740, 16903, 17062, 17219, 17373, 17524,
+        17672, 17818, 17962, 18103, 18243, 18380, 18515, 18648,
+        18779, 18909, 19037, 19163, 19287, 19410, 19531, 19651,
+        19770, 19887, 20002, 20117, 20230, 20341, 20452, 20561,
+        20669, 20777, 20883, 20988, 21091, 21194, 21296, 21397,
+        21497, 21596, 21694, 21792, 21888, 21984, 22078, 22172,
+        22266, 22358, 22450, 22540, 22631, 22720, 22809, 22897,
+        22984, 23071, 23157, 23243, 23327, 23412, 23495, 23578,
+        23661, 23743, 23824, 23905, 23985, 24065, 24144, 24222,
+        24300, 24378, 24455, 24532, 24608, 24684, 24759, 24834,
+        24908, 24982, 25056, 25129, 25201, 25273, 25345, 25417,
+        25488, 25558, 25628, 25698, 25768, 25837, 25906, 25974,
+        26042, 26110, 26177, 26244, 26310, 26377, 26443, 26508,
+        26574, 26639, 26703, 26768, 26832, 26895, 26959, 27022,
+        27085, 27147, 27210, 27271, 27333, 27395, 27456, 27517,
+        27577, 27638, 27698, 27758, 27817, 27876, 27935, 27994,
+        28053, 28111, 28169, 28227, 28285, 28342, 28399, 28456,
+        28513, 28569, 28625, 28682, 28737, 28793, 28848, 28903,
+        28958, 29013, 29068, 29122, 29176, 29230, 29284, 29337,
+        29391, 29444, 29497, 29550, 29602, 29654, 29707, 29759,
+        29811, 29862, 29914, 29965, 30016, 30067, 30118, 30169,
+        30219, 30269, 30319, 30369, 30419, 30469, 30518, 30568,
+        30617, 30666, 30714, 30763, 30812, 30860, 30908, 30956,
+        31004, 31052, 31100, 31147, 31194, 31242, 31289, 31336,
+        31382, 31429, 31476, 31522, 31568, 31614, 31660, 31706,
+        31752, 31797, 31843, 31888, 31933, 31978, 32023, 32068,
+        32112, 32157, 32201, 32246, 32290, 32334, 32378, 32422,
+        32465, 32509, 32552, 32596, 32639, 32682, 32725, 32768,
+    },
+};
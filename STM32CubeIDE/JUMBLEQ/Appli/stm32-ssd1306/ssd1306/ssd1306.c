@@ -0,0 +1,701 @@
+#include "ssd1306.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>  // For memcpy
+
+#include "ssd1306_glyph.h"
+
+static uint16_t ssd1306_BufferSize(const ssd1306_t* d)
+{
+    return (uint16_t) ((uint16_t) d->width * (d->height / 8U));
+}
+
+// 座標の範囲 (はみ出し・逆順も可) を dirty に印を付ける
+static void ssd1306_Mark(ssd1306_t* d, int32_t x1, int32_t y1, int32_t x2, int32_t y2)
+{
+    const int32_t x_lo = (x1 < x2) ? x1 : x2;
+    const int32_t x_hi = (x1 < x2) ? x2 : x1;
+    const int32_t y_lo = (y1 < y2) ? y1 : y2;
+    const int32_t y_hi = (y1 < y2) ? y2 : y1;
+
+    if ((x_hi < 0) || (y_hi < 0) || (x_lo >= d->width) || (y_lo >= d->height))
+    {
+        return;
+    }
+    oled_dirty_mark_rect(&d->dirty, (uint8_t) ((x_lo < 0) ? 0 : x_lo), (uint8_t) ((y_lo < 0) ? 0 : y_lo),
+                         (uint8_t) ((x_hi >= d->width) ? (d->width - 1) : x_hi), (uint8_t) ((y_hi >= d->height) ? (d->height - 1) : y_hi));
+}
+
+void ssd1306_MarkDirty(ssd1306_t* d, uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2)
+{
+    ssd1306_Mark(d, x1, y1, x2, y2);
+}
+
+// Send a byte to the command register
+void ssd1306_WriteCommand(ssd1306_t* d, uint8_t byte)
+{
+    d->ops->command(d, byte);
+}
+
+/* Fills the Screenbuffer with values from a given buffer of a fixed length */
+SSD1306_Error_t ssd1306_FillBuffer(ssd1306_t* d, const uint8_t* buf, uint32_t len)
+{
+    SSD1306_Error_t ret = SSD1306_ERR;
+    if (len <= ssd1306_BufferSize(d))
+    {
+        memcpy(d->fb, buf, len);
+        ssd1306_Mark(d, 0, 0, d->width - 1, d->height - 1);
+        ret = SSD1306_OK;
+    }
+    return ret;
+}
+
+/* Initialize the oled screen */
+void ssd1306_Init(ssd1306_t* d)
+{
+    oled_dirty_init(&d->dirty, d->width, (uint8_t) (d->height / 8U));
+
+    // Reset OLED and wait for the screen to boot
+    if (d->ops->reset != NULL)
+    {
+        d->ops->reset(d);
+    }
+
+    // Init OLED
+    ssd1306_SetDisplayOn(d, 0);  // display off
+
+    ssd1306_WriteCommand(d, 0x20);  // Set Memory Addressing Mode
+    ssd1306_WriteCommand(d, 0x00);  // 00b,Horizontal Addressing Mode; 01b,Vertical Addressing Mode;
+                                    // 10b,Page Addressing Mode (RESET); 11b,Invalid
+
+    ssd1306_WriteCommand(d, 0xB0);  // Set Page Start Address for Page Addressing Mode,0-7
+
+    // Mirror vertically / Set COM Output Scan Direction
+    ssd1306_WriteCommand(d, (d->flags & SSD1306_MIRROR_VERT) ? 0xC0 : 0xC8);
+
+    ssd1306_WriteCommand(d, 0x00);  //---set low column address
+    ssd1306_WriteCommand(d, 0x10);  //---set high column address
+
+    ssd1306_WriteCommand(d, 0x40);  //--set start line address - CHECK
+
+    ssd1306_SetContrast(d, 0xFF);
+
+    // Mirror horizontally / set segment re-map 0 to 127 - CHECK
+    ssd1306_WriteCommand(d, (d->flags & SSD1306_MIRROR_HORIZ) ? 0xA0 : 0xA1);
+
+    // set inverse / normal color
+    ssd1306_WriteCommand(d, (d->flags & SSD1306_INVERSE_COLOR) ? 0xA7 : 0xA6);
+
+    // Set multiplex ratio.
+    if (d->height == 128)
+    {
+        // Found in the Luma Python lib for SH1106.
+        ssd1306_WriteCommand(d, 0xFF);
+    }
+    else
+    {
+        ssd1306_WriteCommand(d, 0xA8);  //--set multiplex ratio(1 to 64) - CHECK
+    }
+
+    // 32 行は 0x1F、64/128 行は 0x3F (128px high displays seem to work with it too)
+    ssd1306_WriteCommand(d, (d->height == 32) ? 0x1F : 0x3F);
+
+    ssd1306_WriteCommand(d, 0xA4);  // 0xa4,Output follows RAM content;0xa5,Output ignores RAM content
+
+    ssd1306_WriteCommand(d, 0xD3);  //-set display offset - CHECK
+    ssd1306_WriteCommand(d, 0x00);  //-not offset
+
+    ssd1306_WriteCommand(d, 0xD5);  //--set display clock divide ratio/oscillator frequency
+    ssd1306_WriteCommand(d, 0xF0);  //--set divide ratio
+
+    ssd1306_WriteCommand(d, 0xD9);  //--set pre-charge period
+    ssd1306_WriteCommand(d, 0x22);  //
+
+    ssd1306_WriteCommand(d, 0xDA);  //--set com pins hardware configuration - CHECK
+    ssd1306_WriteCommand(d, (d->height == 32) ? 0x02 : 0x12);
+
+    ssd1306_WriteCommand(d, 0xDB);  //--set vcomh
+    ssd1306_WriteCommand(d, 0x20);  // 0x20,0.77xVcc
+
+    ssd1306_WriteCommand(d, 0x8D);  //--set DC-DC enable
+    ssd1306_WriteCommand(d, 0x14);  //
+    ssd1306_SetDisplayOn(d, 1);     //--turn on SSD1306 panel
+
+    // Clear screen
+    ssd1306_Fill(d, Black);
+
+    // Flush buffer to screen
+    ssd1306_UpdateScreen(d);
+
+    // Set default values for screen object
+    d->CurrentX = 0;
+    d->CurrentY = 0;
+
+    d->Initialized = 1;
+}
+
+/* Fill the whole screen with the given color */
+void ssd1306_Fill(ssd1306_t* d, SSD1306_COLOR color)
+{
+    memset(d->fb, (color == Black) ? 0x00 : 0xFF, ssd1306_BufferSize(d));
+    ssd1306_Mark(d, 0, 0, d->width - 1, d->height - 1);
+}
+
+/* Write the screenbuffer to the screen and wait until it is shown */
+void ssd1306_UpdateScreen(ssd1306_t* d)
+{
+    d->ops->update(d, 0, (uint8_t) (d->height / 8U - 1U), 0, (uint8_t) (d->width - 1U));
+    if (d->ops->flush != NULL)
+    {
+        (void) d->ops->flush(d, 200);
+    }
+    oled_dirty_clear(&d->dirty);
+}
+
+// ページ start_page..end_page の列 col_start..col_end だけ送る
+void ssd1306_UpdateWindow(ssd1306_t* d, uint8_t start_page, uint8_t end_page, uint8_t col_start, uint8_t col_end)
+{
+    const uint8_t max_page = (uint8_t) (d->height / 8U);
+    if (max_page == 0U)
+    {
+        return;
+    }
+
+    if ((start_page >= max_page) || (col_start >= d->width))
+    {
+        return;
+    }
+    if (end_page >= max_page)
+    {
+        end_page = (uint8_t) (max_page - 1U);
+    }
+    if (col_end >= d->width)
+    {
+        col_end = (uint8_t) (d->width - 1U);
+    }
+    if ((start_page > end_page) || (col_start > col_end))
+    {
+        return;
+    }
+
+    d->ops->update(d, start_page, end_page, col_start, col_end);
+}
+
+// 前回から描いた範囲をページ毎の列のまま渡す (窓へのまとめ方は転送側で決める)
+void ssd1306_Commit(ssd1306_t* d)
+{
+    for (uint8_t p = 0; p < d->dirty.pages; p++)
+    {
+        if (d->dirty.col_min[p] <= d->dirty.col_max[p])
+        {
+            ssd1306_UpdateWindow(d, p, p, d->dirty.col_min[p], d->dirty.col_max[p]);
+        }
+    }
+    oled_dirty_clear(&d->dirty);
+}
+
+static void ssd1306_Pixel(ssd1306_t* d, uint8_t x, uint8_t y, SSD1306_COLOR color)
+{
+    if (x >= d->width || y >= d->height)
+    {
+        // Don't write outside the buffer
+        return;
+    }
+
+    // Draw in the right color
+    if (color == White)
+    {
+        d->fb[x + (y / 8) * d->width] |= 1 << (y % 8);
+    }
+    else
+    {
+        d->fb[x + (y / 8) * d->width] &= ~(1 << (y % 8));
+    }
+}
+
+/*
+ * Draw one pixel in the screenbuffer
+ * X => X Coordinate
+ * Y => Y Coordinate
+ * color => Pixel color
+ */
+void ssd1306_DrawPixel(ssd1306_t* d, uint8_t x, uint8_t y, SSD1306_COLOR color)
+{
+    ssd1306_Pixel(d, x, y, color);
+    ssd1306_Mark(d, x, y, x, y);
+}
+
+/*
+ * Draw 1 char to the screen buffer
+ * ch       => char om weg te schrijven
+ * Font     => Font waarmee we gaan schrijven
+ * color    => Black or White
+ */
+char ssd1306_WriteChar(ssd1306_t* d, char ch, SSD1306_Font_t Font, SSD1306_COLOR color)
+{
+    uint32_t i, b, j;
+
+    // Check if character is valid
+    if (ch < 32 || ch > 126)
+        return 0;
+
+    // Char width is not equal to font width for proportional font
+    const uint8_t char_width = Font.char_width ? Font.char_width[ch - 32] : Font.width;
+    // Check remaining space on current line
+    if (d->width < (d->CurrentX + char_width) ||
+        d->height < (d->CurrentY + Font.height))
+    {
+        // Not enough space on current line
+        return 0;
+    }
+
+    if (Font.cols != NULL)
+    {
+        // 列の表があればページ単位でバイトごと書く
+        ssd1306_glyph_blit(d->fb, d->width, d->height, (uint8_t) d->CurrentX, (uint8_t) d->CurrentY, &Font, char_width, ch, color);
+    }
+    else
+    {
+        // Use the font to write
+        for (i = 0; i < Font.height; i++)
+        {
+            b = Font.data[(ch - 32) * Font.height + i];
+            for (j = 0; j < char_width; j++)
+            {
+                if ((b << j) & 0x8000)
+                {
+                    ssd1306_Pixel(d, d->CurrentX + j, (d->CurrentY + i), (SSD1306_COLOR) color);
+                }
+                else
+                {
+                    ssd1306_Pixel(d, d->CurrentX + j, (d->CurrentY + i), (SSD1306_COLOR) !color);
+                }
+            }
+        }
+    }
+    if (char_width != 0U)
+    {
+        ssd1306_Mark(d, d->CurrentX, d->CurrentY, d->CurrentX + char_width - 1, d->CurrentY + Font.height - 1);
+    }
+
+    // The current space is now taken
+    d->CurrentX += char_width;
+
+    // Return written char for validation
+    return ch;
+}
+
+/* Write full string to screenbuffer */
+char ssd1306_WriteString(ssd1306_t* d, const char* str, SSD1306_Font_t Font, SSD1306_COLOR color)
+{
+    while (*str)
+    {
+        if (ssd1306_WriteChar(d, *str, Font, color) != *str)
+        {
+            // Char could not be written
+            return *str;
+        }
+        str++;
+    }
+
+    // Everything ok
+    return *str;
+}
+
+/* Position the cursor */
+void ssd1306_SetCursor(ssd1306_t* d, uint8_t x, uint8_t y)
+{
+    d->CurrentX = x;
+    d->CurrentY = y;
+}
+
+/* Draw line by Bresenhem's algorithm */
+void ssd1306_Line(ssd1306_t* d, uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, SSD1306_COLOR color)
+{
+    int32_t deltaX = abs(x2 - x1);
+    int32_t deltaY = abs(y2 - y1);
+    int32_t signX  = ((x1 < x2) ? 1 : -1);
+    int32_t signY  = ((y1 < y2) ? 1 : -1);
+    int32_t error  = deltaX - deltaY;
+    int32_t error2;
+
+    ssd1306_Mark(d, x1, y1, x2, y2);
+    ssd1306_Pixel(d, x2, y2, color);
+
+    while ((x1 != x2) || (y1 != y2))
+    {
+        ssd1306_Pixel(d, x1, y1, color);
+        error2 = error * 2;
+        if (error2 > -deltaY)
+        {
+            error -= deltaY;
+            x1 += signX;
+        }
+
+        if (error2 < deltaX)
+        {
+            error += deltaX;
+            y1 += signY;
+        }
+    }
+    return;
+}
+
+/* Draw polyline */
+void ssd1306_Polyline(ssd1306_t* d, const SSD1306_VERTEX* par_vertex, uint16_t par_size, SSD1306_COLOR color)
+{
+    uint16_t i;
+    if (par_vertex == NULL)
+    {
+        return;
+    }
+
+    for (i = 1; i < par_size; i++)
+    {
+        ssd1306_Line(d, par_vertex[i - 1].x, par_vertex[i - 1].y, par_vertex[i].x, par_vertex[i].y, color);
+    }
+
+    return;
+}
+
+/* Convert Degrees to Radians */
+static float ssd1306_DegToRad(float par_deg)
+{
+    return par_deg * (3.14f / 180.0f);
+}
+
+/* Normalize degree to [0;360] */
+static uint16_t ssd1306_NormalizeTo0_360(uint16_t par_deg)
+{
+    uint16_t loc_angle;
+    if (par_deg <= 360)
+    {
+        loc_angle = par_deg;
+    }
+    else
+    {
+        loc_angle = par_deg % 360;
+        loc_angle = (loc_angle ? loc_angle : 360);
+    }
+    return loc_angle;
+}
+
+/*
+ * DrawArc. Draw angle is beginning from 4 quart of trigonometric circle (3pi/2)
+ * start_angle in degree
+ * sweep in degree
+ */
+void ssd1306_DrawArc(ssd1306_t* d, uint8_t x, uint8_t y, uint8_t radius, uint16_t start_angle, uint16_t sweep, SSD1306_COLOR color)
+{
+    static const uint8_t CIRCLE_APPROXIMATION_SEGMENTS = 36;
+    float approx_degree;
+    uint32_t approx_segments;
+    uint8_t xp1, xp2;
+    uint8_t yp1, yp2;
+    uint32_t count;
+    uint32_t loc_sweep;
+    float rad;
+
+    loc_sweep = ssd1306_NormalizeTo0_360(sweep);
+
+    count           = (ssd1306_NormalizeTo0_360(start_angle) * CIRCLE_APPROXIMATION_SEGMENTS) / 360;
+    approx_segments = (loc_sweep * CIRCLE_APPROXIMATION_SEGMENTS) / 360;
+    approx_degree   = loc_sweep / (float) approx_segments;
+    while (count < approx_segments)
+    {
+        rad = ssd1306_DegToRad(count * approx_degree);
+        xp1 = x + (int8_t) (sinf(rad) * radius);
+        yp1 = y + (int8_t) (cosf(rad) * radius);
+        count++;
+        if (count != approx_segments)
+        {
+            rad = ssd1306_DegToRad(count * approx_degree);
+        }
+        else
+        {
+            rad = ssd1306_DegToRad(loc_sweep);
+        }
+        xp2 = x + (int8_t) (sinf(rad) * radius);
+        yp2 = y + (int8_t) (cosf(rad) * radius);
+        ssd1306_Line(d, xp1, yp1, xp2, yp2, color);
+    }
+
+    return;
+}
+
+/*
+ * Draw arc with radius line
+ * Angle is beginning from 4 quart of trigonometric circle (3pi/2)
+ * start_angle: start angle in degree
+ * sweep: finish angle in degree
+ */
+void ssd1306_DrawArcWithRadiusLine(ssd1306_t* d, uint8_t x, uint8_t y, uint8_t radius, uint16_t start_angle, uint16_t sweep, SSD1306_COLOR color)
+{
+    const uint32_t CIRCLE_APPROXIMATION_SEGMENTS = 36;
+    float approx_degree;
+    uint32_t approx_segments;
+    uint8_t xp1;
+    uint8_t xp2 = 0;
+    uint8_t yp1;
+    uint8_t yp2 = 0;
+    uint32_t count;
+    uint32_t loc_sweep;
+    float rad;
+
+    loc_sweep = ssd1306_NormalizeTo0_360(sweep);
+
+    count           = (ssd1306_NormalizeTo0_360(start_angle) * CIRCLE_APPROXIMATION_SEGMENTS) / 360;
+    approx_segments = (loc_sweep * CIRCLE_APPROXIMATION_SEGMENTS) / 360;
+    approx_degree   = loc_sweep / (float) approx_segments;
+
+    rad                   = ssd1306_DegToRad(count * approx_degree);
+    uint8_t first_point_x = x + (int8_t) (sinf(rad) * radius);
+    uint8_t first_point_y = y + (int8_t) (cosf(rad) * radius);
+    while (count < approx_segments)
+    {
+        rad = ssd1306_DegToRad(count * approx_degree);
+        xp1 = x + (int8_t) (sinf(rad) * radius);
+        yp1 = y + (int8_t) (cosf(rad) * radius);
+        count++;
+        if (count != approx_segments)
+        {
+            rad = ssd1306_DegToRad(count * approx_degree);
+        }
+        else
+        {
+            rad = ssd1306_DegToRad(loc_sweep);
+        }
+        xp2 = x + (int8_t) (sinf(rad) * radius);
+        yp2 = y + (int8_t) (cosf(rad) * radius);
+        ssd1306_Line(d, xp1, yp1, xp2, yp2, color);
+    }
+
+    // Radius line
+    ssd1306_Line(d, x, y, first_point_x, first_point_y, color);
+    ssd1306_Line(d, x, y, xp2, yp2, color);
+    return;
+}
+
+/* Draw circle by Bresenhem's algorithm */
+void ssd1306_DrawCircle(ssd1306_t* d, uint8_t par_x, uint8_t par_y, uint8_t par_r, SSD1306_COLOR par_color)
+{
+    int32_t x   = -par_r;
+    int32_t y   = 0;
+    int32_t err = 2 - 2 * par_r;
+    int32_t e2;
+
+    if (par_x >= d->width || par_y >= d->height)
+    {
+        return;
+    }
+    ssd1306_Mark(d, par_x - par_r, par_y - par_r, par_x + par_r, par_y + par_r);
+
+    do
+    {
+        ssd1306_Pixel(d, par_x - x, par_y + y, par_color);
+        ssd1306_Pixel(d, par_x + x, par_y + y, par_color);
+        ssd1306_Pixel(d, par_x + x, par_y - y, par_color);
+        ssd1306_Pixel(d, par_x - x, par_y - y, par_color);
+        e2 = err;
+
+        if (e2 <= y)
+        {
+            y++;
+            err = err + (y * 2 + 1);
+            if (-x == y && e2 <= x)
+            {
+                e2 = 0;
+            }
+        }
+
+        if (e2 > x)
+        {
+            x++;
+            err = err + (x * 2 + 1);
+        }
+    } while (x <= 0);
+
+    return;
+}
+
+/* Draw filled circle. Pixel positions calculated using Bresenham's algorithm */
+void ssd1306_FillCircle(ssd1306_t* d, uint8_t par_x, uint8_t par_y, uint8_t par_r, SSD1306_COLOR par_color)
+{
+    int32_t x   = -par_r;
+    int32_t y   = 0;
+    int32_t err = 2 - 2 * par_r;
+    int32_t e2;
+
+    if (par_x >= d->width || par_y >= d->height)
+    {
+        return;
+    }
+    ssd1306_Mark(d, par_x - par_r, par_y - par_r, par_x + par_r, par_y + par_r);
+
+    do
+    {
+        for (uint8_t _y = (par_y + y); _y >= (par_y - y); _y--)
+        {
+            for (uint8_t _x = (par_x - x); _x >= (par_x + x); _x--)
+            {
+                ssd1306_Pixel(d, _x, _y, par_color);
+            }
+        }
+
+        e2 = err;
+        if (e2 <= y)
+        {
+            y++;
+            err = err + (y * 2 + 1);
+            if (-x == y && e2 <= x)
+            {
+                e2 = 0;
+            }
+        }
+
+        if (e2 > x)
+        {
+            x++;
+            err = err + (x * 2 + 1);
+        }
+    } while (x <= 0);
+
+    return;
+}
+
+/* Draw a rectangle */
+void ssd1306_DrawRectangle(ssd1306_t* d, uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, SSD1306_COLOR color)
+{
+    ssd1306_Line(d, x1, y1, x2, y1, color);
+    ssd1306_Line(d, x2, y1, x2, y2, color);
+    ssd1306_Line(d, x2, y2, x1, y2, color);
+    ssd1306_Line(d, x1, y2, x1, y1, color);
+
+    return;
+}
+
+/* Draw a filled rectangle */
+void ssd1306_FillRectangle(ssd1306_t* d, uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, SSD1306_COLOR color)
+{
+    uint8_t x_start = ((x1 <= x2) ? x1 : x2);
+    uint8_t x_end   = ((x1 <= x2) ? x2 : x1);
+    uint8_t y_start = ((y1 <= y2) ? y1 : y2);
+    uint8_t y_end   = ((y1 <= y2) ? y2 : y1);
+
+    ssd1306_Mark(d, x_start, y_start, x_end, y_end);
+
+    for (uint8_t y = y_start; (y <= y_end) && (y < d->height); y++)
+    {
+        for (uint8_t x = x_start; (x <= x_end) && (x < d->width); x++)
+        {
+            ssd1306_Pixel(d, x, y, color);
+        }
+    }
+    return;
+}
+
+SSD1306_Error_t ssd1306_InvertRectangle(ssd1306_t* d, uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2)
+{
+    if ((x2 >= d->width) || (y2 >= d->height))
+    {
+        return SSD1306_ERR;
+    }
+    if ((x1 > x2) || (y1 > y2))
+    {
+        return SSD1306_ERR;
+    }
+    uint32_t i;
+    ssd1306_Mark(d, x1, y1, x2, y2);
+    if ((y1 / 8) != (y2 / 8))
+    {
+        /* if rectangle doesn't lie on one 8px row */
+        for (uint32_t x = x1; x <= x2; x++)
+        {
+            i = x + (y1 / 8) * d->width;
+            d->fb[i] ^= 0xFF << (y1 % 8);
+            i += d->width;
+            for (; i < x + (y2 / 8) * d->width; i += d->width)
+            {
+                d->fb[i] ^= 0xFF;
+            }
+            d->fb[i] ^= 0xFF >> (7 - (y2 % 8));
+        }
+    }
+    else
+    {
+        /* if rectangle lies on one 8px row */
+        const uint8_t mask = (0xFF << (y1 % 8)) & (0xFF >> (7 - (y2 % 8)));
+        for (i = x1 + (y1 / 8) * d->width;
+             i <= (uint32_t) x2 + (y2 / 8) * d->width; i++)
+        {
+            d->fb[i] ^= mask;
+        }
+    }
+    return SSD1306_OK;
+}
+
+/* Draw a bitmap */
+void ssd1306_DrawBitmap(ssd1306_t* d, uint8_t x, uint8_t y, const unsigned char* bitmap, uint8_t w, uint8_t h, SSD1306_COLOR color)
+{
+    int16_t byteWidth = (w + 7) / 8;  // Bitmap scanline pad = whole byte
+    uint8_t byte      = 0;
+
+    if (x >= d->width || y >= d->height)
+    {
+        return;
+    }
+    if ((w != 0U) && (h != 0U))
+    {
+        ssd1306_Mark(d, x, y, x + w - 1, y + h - 1);
+    }
+
+    for (uint8_t j = 0; j < h; j++, y++)
+    {
+        for (uint8_t i = 0; i < w; i++)
+        {
+            if (i & 7)
+            {
+                byte <<= 1;
+            }
+            else
+            {
+                byte = (*(const unsigned char*) (&bitmap[j * byteWidth + i / 8]));
+            }
+
+            if (byte & 0x80)
+            {
+                ssd1306_Pixel(d, x + i, y, color);
+            }
+        }
+    }
+    return;
+}
+
+void ssd1306_SetContrast(ssd1306_t* d, const uint8_t value)
+{
+    const uint8_t kSetContrastControlRegister = 0x81;
+    ssd1306_WriteCommand(d, kSetContrastControlRegister);
+    ssd1306_WriteCommand(d, value);
+}
+
+void ssd1306_SetDisplayOn(ssd1306_t* d, const uint8_t on)
+{
+    uint8_t value;
+    if (on)
+    {
+        value               = 0xAF;  // Display on
+        d->DisplayOn = 1;
+    }
+    else
+    {
+        value               = 0xAE;  // Display off
+        d->DisplayOn = 0;
+    }
+    ssd1306_WriteCommand(d, value);
+}
+
+uint8_t ssd1306_GetDisplayOn(const ssd1306_t* d)
+{
+    return d->DisplayOn;
+}
@@ -0,0 +1,125 @@
+/**
+ * This Library was originally written by Olivier Van den Eede (4ilo) in 2016.
+ * Some refactoring was done and SPI support was added by Aleksander Alekseev (afiskon) in 2018.
+ *
+ * https://github.com/afiskon/stm32-ssd1306
+ */
+
+#ifndef __SSD1306_H__
+#define __SSD1306_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ssd1306_conf.h"
+#include "ssd1306_params.h"
+#include "oled_dirty.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 1 枚の SSD1306 を表すインスタンス。描画はフレームバッファ (fb) にだけ書き、書いた範囲を dirty に覚える
+// 実際の送信は ops (転送方法) 経由なので、ホストではメモリに描くだけのビルドもできる
+#define SSD1306_MIRROR_VERT   0x01U
+#define SSD1306_MIRROR_HORIZ  0x02U
+#define SSD1306_INVERSE_COLOR 0x04U
+
+typedef struct ssd1306 ssd1306_t;
+
+typedef struct
+{
+    void (*reset)(ssd1306_t* d);                                                                             // リセットして起動を待つ (NULL 可)
+    void (*command)(ssd1306_t* d, uint8_t byte);                                                             // コマンド 1 byte (送り終わるまで待つ)
+    void (*update)(ssd1306_t* d, uint8_t page_start, uint8_t page_end, uint8_t col_start, uint8_t col_end);  // fb の窓を送る (キューに積むだけでもよい)
+    bool (*flush)(ssd1306_t* d, uint32_t timeout_ms);                                                        // update した分が表示されるまで待つ (NULL 可)
+} ssd1306_ops_t;
+
+struct ssd1306
+{
+    const ssd1306_ops_t* ops;
+    void* bus;         // 転送側のハンドル (I2C_HandleTypeDef* など)
+    uint8_t* fb;       // width * height / 8 byte、ページ形式
+    uint16_t addr;     // I2C アドレス (8bit 表記)
+    uint8_t port;      // 転送側のデバイス番号 (OLED_I2C_MAIN など)
+    uint8_t width;
+    uint8_t height;    // 32, 64 or 128
+    uint8_t x_offset;  // 表示の左端が列 0 でないパネル用
+    uint8_t flags;     // SSD1306_MIRROR_* / SSD1306_INVERSE_COLOR
+    uint16_t CurrentX;
+    uint16_t CurrentY;
+    uint8_t Initialized;
+    uint8_t DisplayOn;
+    oled_dirty_t dirty;  // 前回の ssd1306_Commit から描いた範囲
+};
+
+typedef struct
+{
+    uint8_t x;
+    uint8_t y;
+} SSD1306_VERTEX;
+
+// Procedure definitions
+void ssd1306_Init(ssd1306_t* d);
+void ssd1306_Fill(ssd1306_t* d, SSD1306_COLOR color);
+void ssd1306_UpdateScreen(ssd1306_t* d);
+void ssd1306_UpdateWindow(ssd1306_t* d, uint8_t start_page, uint8_t end_page, uint8_t col_start, uint8_t col_end);
+void ssd1306_Commit(ssd1306_t* d);
+void ssd1306_MarkDirty(ssd1306_t* d, uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2);
+void ssd1306_DrawPixel(ssd1306_t* d, uint8_t x, uint8_t y, SSD1306_COLOR color);
+char ssd1306_WriteChar(ssd1306_t* d, char ch, SSD1306_Font_t Font, SSD1306_COLOR color);
+char ssd1306_WriteString(ssd1306_t* d, const char* str, SSD1306_Font_t Font, SSD1306_COLOR color);
+void ssd1306_SetCursor(ssd1306_t* d, uint8_t x, uint8_t y);
+void ssd1306_Line(ssd1306_t* d, uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, SSD1306_COLOR color);
+void ssd1306_DrawArc(ssd1306_t* d, uint8_t x, uint8_t y, uint8_t radius, uint16_t start_angle, uint16_t sweep, SSD1306_COLOR color);
+void ssd1306_DrawArcWithRadiusLine(ssd1306_t* d, uint8_t x, uint8_t y, uint8_t radius, uint16_t start_angle, uint16_t sweep, SSD1306_COLOR color);
+void ssd1306_DrawCircle(ssd1306_t* d, uint8_t par_x, uint8_t par_y, uint8_t par_r, SSD1306_COLOR color);
+void ssd1306_FillCircle(ssd1306_t* d, uint8_t par_x, uint8_t par_y, uint8_t par_r, SSD1306_COLOR par_color);
+void ssd1306_Polyline(ssd1306_t* d, const SSD1306_VERTEX* par_vertex, uint16_t par_size, SSD1306_COLOR color);
+void ssd1306_DrawRectangle(ssd1306_t* d, uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, SSD1306_COLOR color);
+void ssd1306_FillRectangle(ssd1306_t* d, uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, SSD1306_COLOR color);
+
+/**
+ * @brief Invert color of pixels in rectangle (include border)
+ *
+ * @param x1 X Coordinate of top left corner
+ * @param y1 Y Coordinate of top left corner
+ * @param x2 X Coordinate of bottom right corner
+ * @param y2 Y Coordinate of bottom right corner
+ * @return SSD1306_Error_t status
+ */
+SSD1306_Error_t ssd1306_InvertRectangle(ssd1306_t* d, uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2);
+
+void ssd1306_DrawBitmap(ssd1306_t* d, uint8_t x, uint8_t y, const unsigned char* bitmap, uint8_t w, uint8_t h, SSD1306_COLOR color);
+
+/**
+ * @brief Sets the contrast of the display.
+ * @param[in] value contrast to set.
+ * @note Contrast increases as the value increases.
+ * @note RESET = 7Fh.
+ */
+void ssd1306_SetContrast(ssd1306_t* d, const uint8_t value);
+
+/**
+ * @brief Set Display ON/OFF.
+ * @param[in] on 0 for OFF, any for ON.
+ */
+void ssd1306_SetDisplayOn(ssd1306_t* d, const uint8_t on);
+
+/**
+ * @brief Reads DisplayOn state.
+ * @return  0: OFF.
+ *          1: ON.
+ */
+uint8_t ssd1306_GetDisplayOn(const ssd1306_t* d);
+
+// Low-level procedures
+void ssd1306_WriteCommand(ssd1306_t* d, uint8_t byte);
+SSD1306_Error_t ssd1306_FillBuffer(ssd1306_t* d, const uint8_t* buf, uint32_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // __SSD1306_H__
@@ -0,0 +1,19 @@
+/**
+ * Private configuration file for the SSD1306 library.
+ * Geometry, address and transport are per instance (ssd1306_t), only the font selection is global.
+ */
+
+#ifndef __SSD1306_CONF_H__
+#define __SSD1306_CONF_H__
+
+// Include only needed fonts
+#define SSD1306_INCLUDE_FONT_6x8
+#define SSD1306_INCLUDE_FONT_7x10
+#define SSD1306_INCLUDE_FONT_11x18
+#define SSD1306_INCLUDE_FONT_16x26
+
+#define SSD1306_INCLUDE_FONT_16x24
+
+#define SSD1306_INCLUDE_FONT_16x15
+
+#endif /* __SSD1306_CONF_H__ */
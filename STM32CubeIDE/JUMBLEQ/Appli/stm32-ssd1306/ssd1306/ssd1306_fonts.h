@@ -1,23 +1,27 @@
 #ifndef __SSD1306_FONTS_H__
 #define __SSD1306_FONTS_H__
 
-#include "main_oled.h"
-#include "sub_oled.h"
+#include "ssd1306.h"
 
 #ifdef SSD1306_INCLUDE_FONT_6x8
 extern const SSD1306_Font_t Font_6x8;
+extern const uint8_t Font6x8_cols[];
 #endif
 #ifdef SSD1306_INCLUDE_FONT_7x10
 extern const SSD1306_Font_t Font_7x10;
+extern const uint8_t Font7x10_cols[];
 #endif
 #ifdef SSD1306_INCLUDE_FONT_11x18
 extern const SSD1306_Font_t Font_11x18;
+extern const uint8_t Font11x18_cols[];
 #endif
 #ifdef SSD1306_INCLUDE_FONT_16x26
 extern const SSD1306_Font_t Font_16x26;
+extern const uint8_t Font16x26_cols[];
 #endif
 #ifdef SSD1306_INCLUDE_FONT_16x24
 extern const SSD1306_Font_t Font_16x24;
+extern const uint8_t Font16x24_cols[];
 #endif
 #ifdef SSD1306_INCLUDE_FONT_16x15
 /** Generated Roboto Thin 15
@@ -25,6 +29,7 @@ extern const SSD1306_Font_t Font_16x24;
  * @license This font is licensed under the Apache License, Version 2.0.
  */
 extern const SSD1306_Font_t Font_16x15;
+extern const uint8_t Font16x15_cols[];
 #endif
 
 #endif  // __SSD1306_FONTS_H__
@@ -0,0 +1,44 @@
+/*
+ * ssd1306_glyph.c
+ *
+ *  Created on: Mar 21, 2026
+ */
+
+#include "ssd1306_glyph.h"
+
+#include <stddef.h>
+
+void ssd1306_glyph_blit(uint8_t* buf, uint8_t buf_w, uint8_t buf_h, uint8_t x, uint8_t y, const SSD1306_Font_t* font, uint8_t w, char ch, SSD1306_COLOR color)
+{
+    const uint8_t pages     = (uint8_t) ((font->height + 7U) / 8U);
+    const uint8_t shift     = (uint8_t) (y % 8U);
+    const uint8_t buf_pages = (uint8_t) (buf_h / 8U);
+    const uint8_t* glyph    = &font->cols[(uint16_t) ((uint8_t) ch - 32U) * font->width * pages];
+
+    for (uint8_t gp = 0; gp < pages; gp++)
+    {
+        const uint8_t p = (uint8_t) (y / 8U + gp);
+        if (p >= buf_pages)
+        {
+            break;
+        }
+
+        // 文字の中のこのページの行数分のマスク (最後のページは端数)
+        const uint8_t rows  = (uint8_t) (((font->height - gp * 8U) >= 8U) ? 8U : (font->height - gp * 8U));
+        const uint16_t mask = (uint16_t) (((1U << rows) - 1U) << shift);
+        uint8_t* lo         = &buf[(uint16_t) p * buf_w + x];
+        uint8_t* hi         = (((mask >> 8) != 0U) && ((uint8_t) (p + 1U) < buf_pages)) ? &buf[(uint16_t) (p + 1U) * buf_w + x] : NULL;
+
+        for (uint8_t c = 0; c < w; c++)
+        {
+            const uint8_t g  = glyph[(uint16_t) c * pages + gp];
+            const uint16_t v = (uint16_t) ((uint16_t) ((color == White) ? g : (uint8_t) ~g) << shift) & mask;
+
+            lo[c] = (uint8_t) ((lo[c] & (uint8_t) ~mask) | (uint8_t) v);
+            if (hi != NULL)
+            {
+                hi[c] = (uint8_t) ((hi[c] & (uint8_t) ~(mask >> 8)) | (uint8_t) (v >> 8));
+            }
+        }
+    }
+}
@@ -0,0 +1,19 @@
+/*
+ * ssd1306_glyph.h
+ *
+ *  Created on: Mar 21, 2026
+ */
+
+#ifndef INC_SSD1306_GLYPH_H_
+#define INC_SSD1306_GLYPH_H_
+
+#include <stdint.h>
+
+#include "ssd1306_params.h"
+
+// 列の表 (Font.cols) を使ってページ形式のバッファに 1 文字書く。背景も書く (従来の WriteChar と同じ)
+// y が 8 の倍数でない時は、各ページのバイトをずらして上下 2 ページにマスク付きで書く
+// 範囲のチェックは呼ぶ側で済ませておくこと
+void ssd1306_glyph_blit(uint8_t* buf, uint8_t buf_w, uint8_t buf_h, uint8_t x, uint8_t y, const SSD1306_Font_t* font, uint8_t w, char ch, SSD1306_COLOR color);
+
+#endif /* INC_SSD1306_GLYPH_H_ */
@@ -28,6 +28,7 @@ typedef struct
     const uint8_t height;            /**< Font height in pixels */
     const uint16_t* const data;      /**< Pointer to font data array */
     const uint8_t* const char_width; /**< Proportional character width in pixels (NULL for monospaced) */
+    const uint8_t* const cols;       /**< Column-major glyphs for the page blitter (NULL: draw pixel by pixel) */
 } SSD1306_Font_t;
 
 #endif /* INC_SSD1306_PARAMS_H_ */
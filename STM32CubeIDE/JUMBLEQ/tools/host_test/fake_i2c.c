@@ -0,0 +1,227 @@
+/*
+ * fake_i2c.c
+ *
+ *  Created on: Mar 23, 2026
+ */
+
+#include "fake_i2c.h"
+
+#include <string.h>
+
+#include "eeprom.h"
+
+#define FAKE_I2C_WRITE_CYCLE_POLLS 3U
+
+fake_i2c_t fake_i2c;
+
+static uint32_t s_tick;
+static int s_thread;
+DWT_Type fake_dwt;
+static int s_mutex;
+osMutexId_t i2cMutexHandle = &s_mutex;
+
+void fake_i2c_reset(void)
+{
+    memset(fake_i2c.mem, 0xFF, sizeof(fake_i2c.mem));
+    fake_i2c.busy_polls        = 0U;
+    fake_i2c.writes            = 0U;
+    fake_i2c.page_crossings    = 0U;
+    fake_i2c.writes_while_busy = 0U;
+    fake_i2c.kernel_running    = false;
+    fake_i2c.locked            = false;
+    fake_i2c.lock_timeouts     = 0U;
+    fake_i2c.hal_busy          = 0U;
+    fake_i2c.acquires          = 0U;
+    fake_i2c.unlocked_xfers    = 0U;
+    fake_i2c.split_polls       = 0U;
+    fake_i2c.write_acquire     = 0U;
+    fake_i2c.idle_acquires     = 0U;
+    fake_i2c.tx_len            = 0U;
+    fake_i2c.tx_addr           = 0U;
+    fake_i2c.tx_bus            = NULL;
+    fake_i2c.tx_count          = 0U;
+    fake_i2c.tx_aborts         = 0U;
+}
+
+// 呼ばれる度に進めて、タイムアウトのループが必ず終わるようにする
+uint32_t HAL_GetTick(void)
+{
+    return s_tick++;
+}
+
+void HAL_Delay(uint32_t ms)
+{
+    s_tick += ms;
+}
+
+osKernelState_t osKernelGetState(void)
+{
+    return fake_i2c.kernel_running ? osKernelRunning : osKernelReady;
+}
+
+osStatus_t osMutexAcquire(osMutexId_t mutex_id, uint32_t timeout)
+{
+    if (fake_i2c.locked)
+    {
+        return osError;  // 再帰ミューテックスではない
+    }
+    if (!EEPROM_IsBusy())
+    {
+        fake_i2c.idle_acquires++;
+    }
+    if (fake_i2c.lock_timeouts != 0U)
+    {
+        fake_i2c.lock_timeouts--;
+        s_tick += timeout;
+        return osErrorTimeout;
+    }
+    fake_i2c.locked = true;
+    fake_i2c.acquires++;
+    return osOK;
+}
+
+osStatus_t osMutexRelease(osMutexId_t mutex_id)
+{
+    if (!fake_i2c.locked)
+    {
+        return osError;
+    }
+    fake_i2c.locked = false;
+    return osOK;
+}
+
+osStatus_t osDelay(uint32_t ticks)
+{
+    s_tick += ticks;
+    return osOK;
+}
+
+osThreadId_t osThreadGetId(void)
+{
+    return &s_thread;
+}
+
+uint32_t osThreadFlagsSet(osThreadId_t thread_id, uint32_t flags)
+{
+    return flags;
+}
+
+uint32_t osThreadFlagsClear(uint32_t flags)
+{
+    return 0U;
+}
+
+// 待つ代わりに時間だけ進める
+uint32_t osThreadFlagsWait(uint32_t flags, uint32_t options, uint32_t timeout)
+{
+    s_tick += timeout;
+    return flags;
+}
+
+static void fake_i2c_check_lock(void)
+{
+    if (fake_i2c.kernel_running && !fake_i2c.locked)
+    {
+        fake_i2c.unlocked_xfers++;
+    }
+}
+
+int SEGGER_RTT_printf(unsigned buf, const char* fmt, ...)
+{
+    return 0;
+}
+
+HAL_StatusTypeDef HAL_I2C_IsDeviceReady(I2C_HandleTypeDef* hi2c, uint16_t dev, uint32_t trials, uint32_t timeout)
+{
+    fake_i2c_check_lock();
+    if ((fake_i2c.busy_polls != 0U) && (fake_i2c.acquires != fake_i2c.write_acquire))
+    {
+        fake_i2c.split_polls++;
+    }
+    if (fake_i2c.busy_polls > trials)
+    {
+        fake_i2c.busy_polls -= trials;
+        return HAL_ERROR;
+    }
+    fake_i2c.busy_polls = 0U;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Read(I2C_HandleTypeDef* hi2c, uint16_t dev, uint16_t mem, uint16_t mem_size, uint8_t* buf, uint16_t len, uint32_t timeout)
+{
+    fake_i2c_check_lock();
+    if (fake_i2c.hal_busy != 0U)
+    {
+        fake_i2c.hal_busy--;
+        return HAL_BUSY;
+    }
+    if (fake_i2c.busy_polls != 0U)
+    {
+        return HAL_ERROR;
+    }
+    for (uint32_t i = 0; i < len; i++)
+    {
+        buf[i] = fake_i2c.mem[(mem + i) % FAKE_I2C_MEM_SIZE];
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Write(I2C_HandleTypeDef* hi2c, uint16_t dev, uint16_t mem, uint16_t mem_size, uint8_t* buf, uint16_t len, uint32_t timeout)
+{
+    fake_i2c_check_lock();
+    if (fake_i2c.hal_busy != 0U)
+    {
+        fake_i2c.hal_busy--;
+        return HAL_BUSY;
+    }
+    if (fake_i2c.busy_polls != 0U)
+    {
+        fake_i2c.writes_while_busy++;
+        return HAL_ERROR;
+    }
+
+    const uint32_t page = mem - (mem % FAKE_I2C_PAGE_SIZE);
+    if (((mem % FAKE_I2C_PAGE_SIZE) + len) > FAKE_I2C_PAGE_SIZE)
+    {
+        fake_i2c.page_crossings++;
+    }
+    for (uint32_t i = 0; i < len; i++)
+    {
+        fake_i2c.mem[page + ((mem + i) % FAKE_I2C_PAGE_SIZE)] = buf[i];
+    }
+    fake_i2c.writes++;
+    fake_i2c.busy_polls    = FAKE_I2C_WRITE_CYCLE_POLLS;
+    fake_i2c.write_acquire = fake_i2c.acquires;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Transmit_DMA(I2C_HandleTypeDef* hi2c, uint16_t dev, uint8_t* buf, uint16_t len)
+{
+    fake_i2c_check_lock();
+    if (fake_i2c.hal_busy != 0U)
+    {
+        fake_i2c.hal_busy--;
+        return HAL_BUSY;
+    }
+    if (len > FAKE_I2C_TX_MAX)
+    {
+        return HAL_ERROR;
+    }
+    memcpy(fake_i2c.tx, buf, len);
+    fake_i2c.tx_len  = len;
+    fake_i2c.tx_addr = dev;
+    fake_i2c.tx_bus  = hi2c;
+    fake_i2c.tx_count++;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Abort_IT(I2C_HandleTypeDef* hi2c, uint16_t dev)
+{
+    fake_i2c.tx_aborts++;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA_Abort(DMA_HandleTypeDef* hdma)
+{
+    return HAL_OK;
+}
@@ -0,0 +1,50 @@
+/*
+ * fake_i2c.h
+ *
+ *  Created on: Mar 23, 2026
+ */
+
+#ifndef FAKE_I2C_H_
+#define FAKE_I2C_H_
+
+#include "stm32h7rsxx_hal.h"
+#include "cmsis_os2.h"
+
+// hi2c2 の 24xx512 (64KB, 128 バイトページ) の代わり
+// 書き込みはページ内で折り返し (実物と同じ)、書いた後しばらく IsDeviceReady が NACK を返す
+// kernel_running にすると i2cMutex を数えて、持たずにバスを触った回数を残す
+#define FAKE_I2C_MEM_SIZE  65536U
+#define FAKE_I2C_PAGE_SIZE 128U
+#define FAKE_I2C_TX_MAX    2048U
+
+typedef struct
+{
+    uint8_t mem[FAKE_I2C_MEM_SIZE];
+    uint32_t busy_polls;       // 書き込み後に NACK を返す回数
+    uint32_t writes;           // Mem_Write の回数
+    uint32_t page_crossings;   // ページをまたいだ Mem_Write (折り返して壊れる) の回数
+    uint32_t writes_while_busy;
+    // i2cMutex
+    bool kernel_running;
+    bool locked;
+    uint32_t lock_timeouts;    // 次の acquire をこの回数だけタイムアウトさせる (OLED が転送中)
+    uint32_t hal_busy;         // 次の Mem_Read/Mem_Write をこの回数だけ HAL_BUSY にする
+    uint32_t acquires;
+    uint32_t unlocked_xfers;   // カーネルが動いているのにミューテックスを持たずに触った回数
+    uint32_t split_polls;      // 書き込みと別のミューテックスの中で ACK ポーリングした回数
+    uint32_t write_acquire;    // 最後の Mem_Write をした時の acquires
+    uint32_t idle_acquires;    // EEPROM_IsBusy が false のまま取りに来た回数 (OLED から見えていない)
+    // HAL_I2C_Master_Transmit_DMA (OLED) の最後の転送。完了はテストが HAL_I2C_MasterTxCpltCallback を呼んで知らせる
+    uint8_t tx[FAKE_I2C_TX_MAX];
+    uint16_t tx_len;
+    uint16_t tx_addr;
+    I2C_HandleTypeDef* tx_bus;
+    uint32_t tx_count;
+    uint32_t tx_aborts;
+} fake_i2c_t;
+
+extern fake_i2c_t fake_i2c;
+
+void fake_i2c_reset(void);
+
+#endif /* FAKE_I2C_H_ */
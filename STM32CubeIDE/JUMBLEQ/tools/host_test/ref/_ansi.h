@@ -0,0 +1,13 @@
+/*
+ * _ansi.h (host_test/ref)
+ *
+ * newlib の _ansi.h の代わり。前のドライバのヘッダが使う _BEGIN_STD_C/_END_STD_C だけ
+ */
+
+#ifndef HOST_TEST_REF_ANSI_H_
+#define HOST_TEST_REF_ANSI_H_
+
+#define _BEGIN_STD_C
+#define _END_STD_C
+
+#endif /* HOST_TEST_REF_ANSI_H_ */
@@ -6,6 +6,8 @@
 #include "cmsis_os2.h"
 #include "FreeRTOS.h"
 #include "semphr.h"
+#include "oled_i2c.h"
+#include "ssd1306_glyph.h"
 
 // I2C排他制御用ミューテックス
 extern osMutexId_t i2cMutexHandle;
@@ -24,6 +26,9 @@ static HAL_StatusTypeDef main_oled_I2C_Write(uint16_t mem_addr, uint8_t* data, u
         return HAL_ERROR;
     }
 
+    // DMA 転送キューが送信中ならミューテックスを持っているので、終わるまで待つ
+    (void) oled_i2c_wait_idle(200);
+
     // ミューテックスで排他制御（最大200ms待機）
     if (osMutexAcquire(i2cMutexHandle, pdMS_TO_TICKS(200)) == osOK)
     {
@@ -226,6 +231,11 @@ void main_oled_UpdateScreen(void)
     //  * 32px   ==  4 pages
     //  * 64px   ==  8 pages
     //  * 128px  ==  16 pages
+#if defined(MAIN_OLED_USE_I2C)
+    // 全体を 1 トランザクションで送り、表示されるまで待つ
+    oled_i2c_submit(OLED_I2C_MAIN, MAIN_OLED_Buffer, 0, (uint8_t) (MAIN_OLED_HEIGHT / 8 - 1), 0, (uint8_t) (MAIN_OLED_WIDTH - 1));
+    (void) oled_i2c_flush(200);
+#else
     for (uint8_t i = 0; i < MAIN_OLED_HEIGHT / 8; i++)
     {
         main_oled_WriteCommand(0xB0 + i);  // Set the current RAM page address.
@@ -233,9 +243,16 @@ void main_oled_UpdateScreen(void)
         main_oled_WriteCommand(0x10 + MAIN_OLED_X_OFFSET_UPPER);
         main_oled_WriteData(&MAIN_OLED_Buffer[MAIN_OLED_WIDTH * i], MAIN_OLED_WIDTH);
     }
+#endif
 }
 
 void main_oled_UpdateScreenPages(uint8_t start_page, uint8_t end_page)
+{
+    main_oled_UpdateWindow(start_page, end_page, 0, (uint8_t) (MAIN_OLED_WIDTH - 1U));
+}
+
+// ページ start_page..end_page の列 col_start..col_end だけ送る
+void main_oled_UpdateWindow(uint8_t start_page, uint8_t end_page, uint8_t col_start, uint8_t col_end)
 {
     uint8_t max_page = (uint8_t) (MAIN_OLED_HEIGHT / 8U);
     if (max_page == 0U)
@@ -243,7 +260,7 @@ void main_oled_UpdateScreenPages(uint8_t start_page, uint8_t end_page)
         return;
     }
 
-    if (start_page >= max_page)
+    if ((start_page >= max_page) || (col_start >= MAIN_OLED_WIDTH))
     {
         return;
     }
@@ -251,18 +268,28 @@ void main_oled_UpdateScreenPages(uint8_t start_page, uint8_t end_page)
     {
         end_page = (uint8_t) (max_page - 1U);
     }
-    if (start_page > end_page)
+    if (col_end >= MAIN_OLED_WIDTH)
+    {
+        col_end = (uint8_t) (MAIN_OLED_WIDTH - 1U);
+    }
+    if ((start_page > end_page) || (col_start > col_end))
     {
         return;
     }
 
+#if defined(MAIN_OLED_USE_I2C)
+    // キューに積むだけ。oledTask の oled_i2c_run で DMA 転送する (表示中と同じバイトはそこで省く)
+    oled_i2c_submit(OLED_I2C_MAIN, MAIN_OLED_Buffer, start_page, end_page, col_start, col_end);
+#else
+    const uint8_t col = (uint8_t) (col_start + (MAIN_OLED_X_OFFSET_UPPER << 4) + MAIN_OLED_X_OFFSET_LOWER);
     for (uint8_t i = start_page; i <= end_page; i++)
     {
         main_oled_WriteCommand(0xB0 + i);  // Set the current RAM page address.
-        main_oled_WriteCommand(0x00 + MAIN_OLED_X_OFFSET_LOWER);
-        main_oled_WriteCommand(0x10 + MAIN_OLED_X_OFFSET_UPPER);
-        main_oled_WriteData(&MAIN_OLED_Buffer[MAIN_OLED_WIDTH * i], MAIN_OLED_WIDTH);
+        main_oled_WriteCommand(0x00 + (col & 0x0F));
+        main_oled_WriteCommand(0x10 + ((col >> 4) & 0x07));
+        main_oled_WriteData(&MAIN_OLED_Buffer[MAIN_OLED_WIDTH * i + col_start], (size_t) (col_end - col_start + 1U));
     }
+#endif
 }
 
 /*
@@ -314,19 +341,27 @@ char main_oled_WriteChar(char ch, SSD1306_Font_t Font, SSD1306_COLOR color)
         return 0;
     }
 
-    // Use the font to write
-    for (i = 0; i < Font.height; i++)
+    if (Font.cols != NULL)
+    {
+        // 列の表があればページ単位でバイトごと書く
+        ssd1306_glyph_blit(MAIN_OLED_Buffer, MAIN_OLED_WIDTH, MAIN_OLED_HEIGHT, (uint8_t) MAIN_OLED.CurrentX, (uint8_t) MAIN_OLED.CurrentY, &Font, char_width, ch, color);
+    }
+    else
     {
-        b = Font.data[(ch - 32) * Font.height + i];
-        for (j = 0; j < char_width; j++)
+        // Use the font to write
+        for (i = 0; i < Font.height; i++)
         {
-            if ((b << j) & 0x8000)
-            {
-                main_oled_DrawPixel(MAIN_OLED.CurrentX + j, (MAIN_OLED.CurrentY + i), (SSD1306_COLOR) color);
-            }
-            else
+            b = Font.data[(ch - 32) * Font.height + i];
+            for (j = 0; j < char_width; j++)
             {
-                main_oled_DrawPixel(MAIN_OLED.CurrentX + j, (MAIN_OLED.CurrentY + i), (SSD1306_COLOR) !color);
+                if ((b << j) & 0x8000)
+                {
+                    main_oled_DrawPixel(MAIN_OLED.CurrentX + j, (MAIN_OLED.CurrentY + i), (SSD1306_COLOR) color);
+                }
+                else
+                {
+                    main_oled_DrawPixel(MAIN_OLED.CurrentX + j, (MAIN_OLED.CurrentY + i), (SSD1306_COLOR) !color);
+                }
             }
         }
     }
@@ -0,0 +1,30 @@
+/*
+ * oled_i2c.h
+ *
+ *  Created on: Mar 18, 2026
+ */
+
+#ifndef INC_OLED_I2C_H_
+#define INC_OLED_I2C_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// SSD1306 2 枚への DMA 転送キュー
+// 変わった範囲 (ページ毎の列) を覚えておき、表示中の内容 (shadow) と比べて違うバイトまで縮めてから
+// 転送量が少なくなるように窓にまとめ、1 窓 = アドレス指定コマンド + データを 1 トランザクションで送る
+// 転送の間は i2cMutex を返すので、同じバスの AK4619/EEPROM が割り込める
+// submit/run/flush は oledTask からだけ呼ぶ
+enum
+{
+    OLED_I2C_MAIN = 0,  // I2C3 128x32
+    OLED_I2C_SUB,       // I2C2 128x64
+    OLED_I2C_DEV_NUM,
+};
+
+void oled_i2c_submit(uint8_t dev, const uint8_t* fb, uint8_t page_start, uint8_t page_end, uint8_t col_start, uint8_t col_end);
+void oled_i2c_run(uint32_t budget_ms);
+bool oled_i2c_flush(uint32_t timeout_ms);
+bool oled_i2c_wait_idle(uint32_t timeout_ms);
+
+#endif /* INC_OLED_I2C_H_ */
@@ -0,0 +1,28 @@
+/*
+ * ref_oled.h
+ *
+ *  Created on: Mar 23, 2026
+ */
+
+#ifndef HOST_TEST_REF_OLED_H_
+#define HOST_TEST_REF_OLED_H_
+
+// 前のドライバ (3da46a7 の 1 つ前の main_oled.c / sub_oled.c をそのまま置いたもの) をホストで動かすための HAL/RTOS/転送キューの代わり
+// - コマンドは I2C (mem 0x00) の書き込みをバス毎に記録する
+// - フレームバッファは static なので、UpdateScreen が oled_i2c_submit に渡すポインタを覚えておく
+#include "oled_i2c.h"
+
+#include <stdint.h>
+
+#define REF_OLED_CMD_MAX 64U
+
+typedef struct
+{
+    uint8_t cmd[REF_OLED_CMD_MAX];
+    uint32_t cmd_n;
+    const uint8_t* fb;
+} ref_oled_t;
+
+extern ref_oled_t ref_oled[OLED_I2C_DEV_NUM];
+
+#endif /* HOST_TEST_REF_OLED_H_ */
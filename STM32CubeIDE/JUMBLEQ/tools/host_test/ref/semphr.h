@@ -0,0 +1,10 @@
+/*
+ * semphr.h (host_test/ref)
+ *
+ * 前のドライバが include するだけで使っていない
+ */
+
+#ifndef HOST_TEST_REF_SEMPHR_H_
+#define HOST_TEST_REF_SEMPHR_H_
+
+#endif /* HOST_TEST_REF_SEMPHR_H_ */
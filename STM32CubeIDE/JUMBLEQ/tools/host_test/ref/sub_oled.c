@@ -6,6 +6,8 @@
 #include "cmsis_os2.h"
 #include "FreeRTOS.h"
 #include "semphr.h"
+#include "oled_i2c.h"
+#include "ssd1306_glyph.h"
 
 // I2C排他制御用ミューテックス
 extern osMutexId_t i2cMutexHandle;
@@ -24,6 +26,9 @@ static HAL_StatusTypeDef sub_oled_I2C_Write(uint16_t mem_addr, uint8_t* data, ui
         return HAL_ERROR;
     }
 
+    // DMA 転送キューが送信中ならミューテックスを持っているので、終わるまで待つ
+    (void) oled_i2c_wait_idle(200);
+
     // ミューテックスで排他制御（最大200ms待機）
     if (osMutexAcquire(i2cMutexHandle, pdMS_TO_TICKS(200)) == osOK)
     {
@@ -108,6 +113,12 @@ SSD1306_Error_t sub_oled_FillBuffer(uint8_t* buf, uint32_t len)
     return ret;
 }
 
+/* Direct access to the screenbuffer (page format, SUB_OLED_WIDTH bytes per page) */
+uint8_t* sub_oled_GetBuffer(void)
+{
+    return SUB_OLED_Buffer;
+}
+
 /* Initialize the oled screen */
 void sub_oled_Init(void)
 {
@@ -226,6 +237,11 @@ void sub_oled_UpdateScreen(void)
     //  * 32px   ==  4 pages
     //  * 64px   ==  8 pages
     //  * 128px  ==  16 pages
+#if defined(SUB_OLED_USE_I2C)
+    // 全体を 1 トランザクションで送り、表示されるまで待つ
+    oled_i2c_submit(OLED_I2C_SUB, SUB_OLED_Buffer, 0, (uint8_t) (SUB_OLED_HEIGHT / 8 - 1), 0, (uint8_t) (SUB_OLED_WIDTH - 1));
+    (void) oled_i2c_flush(200);
+#else
     for (uint8_t i = 0; i < SUB_OLED_HEIGHT / 8; i++)
     {
         sub_oled_WriteCommand(0xB0 + i);  // Set the current RAM page address.
@@ -233,9 +249,16 @@ void sub_oled_UpdateScreen(void)
         sub_oled_WriteCommand(0x10 + SUB_OLED_X_OFFSET_UPPER);
         sub_oled_WriteData(&SUB_OLED_Buffer[SUB_OLED_WIDTH * i], SUB_OLED_WIDTH);
     }
+#endif
 }
 
 void sub_oled_UpdateScreenPages(uint8_t start_page, uint8_t end_page)
+{
+    sub_oled_UpdateWindow(start_page, end_page, 0, (uint8_t) (SUB_OLED_WIDTH - 1U));
+}
+
+// ページ start_page..end_page の列 col_start..col_end だけ送る
+void sub_oled_UpdateWindow(uint8_t start_page, uint8_t end_page, uint8_t col_start, uint8_t col_end)
 {
     uint8_t max_page = (uint8_t) (SUB_OLED_HEIGHT / 8U);
     if (max_page == 0U)
@@ -243,7 +266,7 @@ void sub_oled_UpdateScreenPages(uint8_t start_page, uint8_t end_page)
         return;
     }
 
-    if (start_page >= max_page)
+    if ((start_page >= max_page) || (col_start >= SUB_OLED_WIDTH))
     {
         return;
     }
@@ -251,18 +274,28 @@ void sub_oled_UpdateScreenPages(uint8_t start_page, uint8_t end_page)
     {
         end_page = (uint8_t) (max_page - 1U);
     }
-    if (start_page > end_page)
+    if (col_end >= SUB_OLED_WIDTH)
+    {
+        col_end = (uint8_t) (SUB_OLED_WIDTH - 1U);
+    }
+    if ((start_page > end_page) || (col_start > col_end))
     {
         return;
     }
 
+#if defined(SUB_OLED_USE_I2C)
+    // キューに積むだけ。oledTask の oled_i2c_run で DMA 転送する (表示中と同じバイトはそこで省く)
+    oled_i2c_submit(OLED_I2C_SUB, SUB_OLED_Buffer, start_page, end_page, col_start, col_end);
+#else
+    const uint8_t col = (uint8_t) (col_start + (SUB_OLED_X_OFFSET_UPPER << 4) + SUB_OLED_X_OFFSET_LOWER);
     for (uint8_t i = start_page; i <= end_page; i++)
     {
         sub_oled_WriteCommand(0xB0 + i);  // Set the current RAM page address.
-        sub_oled_WriteCommand(0x00 + SUB_OLED_X_OFFSET_LOWER);
-        sub_oled_WriteCommand(0x10 + SUB_OLED_X_OFFSET_UPPER);
-        sub_oled_WriteData(&SUB_OLED_Buffer[SUB_OLED_WIDTH * i], SUB_OLED_WIDTH);
+        sub_oled_WriteCommand(0x00 + (col & 0x0F));
+        sub_oled_WriteCommand(0x10 + ((col >> 4) & 0x07));
+        sub_oled_WriteData(&SUB_OLED_Buffer[SUB_OLED_WIDTH * i + col_start], (size_t) (col_end - col_start + 1U));
     }
+#endif
 }
 
 /*
@@ -314,19 +347,27 @@ char sub_oled_WriteChar(char ch, SSD1306_Font_t Font, SSD1306_COLOR color)
         return 0;
     }
 
-    // Use the font to write
-    for (i = 0; i < Font.height; i++)
+    if (Font.cols != NULL)
     {
-        b = Font.data[(ch - 32) * Font.height + i];
-        for (j = 0; j < char_width; j++)
+        // 列の表があればページ単位でバイトごと書く
+        ssd1306_glyph_blit(SUB_OLED_Buffer, SUB_OLED_WIDTH, SUB_OLED_HEIGHT, (uint8_t) SUB_OLED.CurrentX, (uint8_t) SUB_OLED.CurrentY, &Font, char_width, ch, color);
+    }
+    else
+    {
+        // Use the font to write
+        for (i = 0; i < Font.height; i++)
         {
-            if ((b << j) & 0x8000)
-            {
-                sub_oled_DrawPixel(SUB_OLED.CurrentX + j, (SUB_OLED.CurrentY + i), (SSD1306_COLOR) color);
-            }
-            else
+            b = Font.data[(ch - 32) * Font.height + i];
+            for (j = 0; j < char_width; j++)
             {
-                sub_oled_DrawPixel(SUB_OLED.CurrentX + j, (SUB_OLED.CurrentY + i), (SSD1306_COLOR) !color);
+                if ((b << j) & 0x8000)
+                {
+                    sub_oled_DrawPixel(SUB_OLED.CurrentX + j, (SUB_OLED.CurrentY + i), (SSD1306_COLOR) color);
+                }
+                else
+                {
+                    sub_oled_DrawPixel(SUB_OLED.CurrentX + j, (SUB_OLED.CurrentY + i), (SSD1306_COLOR) !color);
+                }
             }
         }
     }
@@ -110,6 +110,7 @@ void sub_oled_Init(void);
 void sub_oled_Fill(SSD1306_COLOR color);
 void sub_oled_UpdateScreen(void);
 void sub_oled_UpdateScreenPages(uint8_t start_page, uint8_t end_page);
+void sub_oled_UpdateWindow(uint8_t start_page, uint8_t end_page, uint8_t col_start, uint8_t col_end);
 void sub_oled_DrawPixel(uint8_t x, uint8_t y, SSD1306_COLOR color);
 char sub_oled_WriteChar(char ch, SSD1306_Font_t Font, SSD1306_COLOR color);
 char sub_oled_WriteString(char* str, SSD1306_Font_t Font, SSD1306_COLOR color);
@@ -162,6 +163,7 @@ void sub_oled_Reset(void);
 void sub_oled_WriteCommand(uint8_t byte);
 void sub_oled_WriteData(uint8_t* buffer, size_t buff_size);
 SSD1306_Error_t sub_oled_FillBuffer(uint8_t* buf, uint32_t len);
+uint8_t* sub_oled_GetBuffer(void);
 
 _END_STD_C
 
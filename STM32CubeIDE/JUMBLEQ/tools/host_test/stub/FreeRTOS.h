@@ -0,0 +1,14 @@
+/*
+ * FreeRTOS.h (host_test)
+ *
+ * ホストビルド用の FreeRTOS の代わり。1 tick = 1ms
+ */
+
+#ifndef HOST_TEST_FREERTOS_H_
+#define HOST_TEST_FREERTOS_H_
+
+#include <stdint.h>
+
+#define pdMS_TO_TICKS(ms) ((uint32_t) (ms))
+
+#endif /* HOST_TEST_FREERTOS_H_ */
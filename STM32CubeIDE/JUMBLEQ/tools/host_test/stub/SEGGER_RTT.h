@@ -0,0 +1,10 @@
+/*
+ * SEGGER_RTT.h (host_test)
+ */
+
+#ifndef HOST_TEST_SEGGER_RTT_H_
+#define HOST_TEST_SEGGER_RTT_H_
+
+int SEGGER_RTT_printf(unsigned buf, const char* fmt, ...);
+
+#endif /* HOST_TEST_SEGGER_RTT_H_ */
@@ -0,0 +1,40 @@
+/*
+ * cmsis_os2.h (host_test)
+ *
+ * ホストビルド用の CMSIS-RTOS2 の代わり。ミューテックスは fake_i2c.c が持つ
+ */
+
+#ifndef HOST_TEST_CMSIS_OS2_H_
+#define HOST_TEST_CMSIS_OS2_H_
+
+#include <stdint.h>
+
+typedef void* osMutexId_t;
+typedef void* osThreadId_t;
+
+#define osFlagsWaitAny 0x00000000U
+
+typedef enum
+{
+    osOK           = 0,
+    osError        = -1,
+    osErrorTimeout = -2,
+} osStatus_t;
+
+typedef enum
+{
+    osKernelInactive = 0,
+    osKernelReady    = 1,
+    osKernelRunning  = 2,
+} osKernelState_t;
+
+osKernelState_t osKernelGetState(void);
+osStatus_t osMutexAcquire(osMutexId_t mutex_id, uint32_t timeout);
+osStatus_t osMutexRelease(osMutexId_t mutex_id);
+osStatus_t osDelay(uint32_t ticks);
+osThreadId_t osThreadGetId(void);
+uint32_t osThreadFlagsSet(osThreadId_t thread_id, uint32_t flags);
+uint32_t osThreadFlagsClear(uint32_t flags);
+uint32_t osThreadFlagsWait(uint32_t flags, uint32_t options, uint32_t timeout);
+
+#endif /* HOST_TEST_CMSIS_OS2_H_ */
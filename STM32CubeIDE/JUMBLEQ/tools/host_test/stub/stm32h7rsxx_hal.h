@@ -0,0 +1,81 @@
+/*
+ * stm32h7rsxx_hal.h (host_test)
+ *
+ * ホストビルド用の HAL の代わり。テストが触る型と関数だけを置く (main.h は本物を使う)
+ */
+
+#ifndef HOST_TEST_STM32H7RSXX_HAL_H_
+#define HOST_TEST_STM32H7RSXX_HAL_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum
+{
+    HAL_OK = 0,
+    HAL_ERROR,
+    HAL_BUSY,
+    HAL_TIMEOUT,
+} HAL_StatusTypeDef;
+
+typedef struct
+{
+    int id;
+} DMA_HandleTypeDef;
+
+typedef struct
+{
+    int id;
+    DMA_HandleTypeDef* hdmatx;
+} I2C_HandleTypeDef;
+
+typedef struct
+{
+    int id;
+} TIM_HandleTypeDef;
+
+// サイクルカウンタ (fake_i2c.c が持つ)
+typedef struct
+{
+    volatile uint32_t CYCCNT;
+} DWT_Type;
+
+extern DWT_Type fake_dwt;
+#define DWT (&fake_dwt)
+
+#define I2C_MEMADD_SIZE_16BIT 2U
+
+#define __DSB() \
+    do          \
+    {           \
+    } while (0)
+#define __DMB() \
+    do          \
+    {           \
+    } while (0)
+
+// ホストでは割り込みが無いので止めるだけのふり
+static inline uint32_t __get_PRIMASK(void)
+{
+    return 0U;
+}
+static inline void __set_PRIMASK(uint32_t primask)
+{
+    (void) primask;
+}
+static inline void __disable_irq(void)
+{
+}
+
+uint32_t HAL_GetTick(void);
+void HAL_Delay(uint32_t ms);
+
+HAL_StatusTypeDef HAL_I2C_IsDeviceReady(I2C_HandleTypeDef* hi2c, uint16_t dev, uint32_t trials, uint32_t timeout);
+HAL_StatusTypeDef HAL_I2C_Mem_Read(I2C_HandleTypeDef* hi2c, uint16_t dev, uint16_t mem, uint16_t mem_size, uint8_t* buf, uint16_t len, uint32_t timeout);
+HAL_StatusTypeDef HAL_I2C_Mem_Write(I2C_HandleTypeDef* hi2c, uint16_t dev, uint16_t mem, uint16_t mem_size, uint8_t* buf, uint16_t len, uint32_t timeout);
+HAL_StatusTypeDef HAL_I2C_Master_Transmit_DMA(I2C_HandleTypeDef* hi2c, uint16_t dev, uint8_t* buf, uint16_t len);
+HAL_StatusTypeDef HAL_I2C_Master_Abort_IT(I2C_HandleTypeDef* hi2c, uint16_t dev);
+HAL_StatusTypeDef HAL_DMA_Abort(DMA_HandleTypeDef* hdma);
+
+#endif /* HOST_TEST_STM32H7RSXX_HAL_H_ */
@@ -0,0 +1,14 @@
+/*
+ * tusb.h (host_test)
+ */
+
+#ifndef HOST_TEST_TUSB_H_
+#define HOST_TEST_TUSB_H_
+
+#include <stdint.h>
+
+#define TU_ARRAY_SIZE(a) (sizeof(a) / sizeof((a)[0]))
+
+uint32_t tud_midi_stream_write(uint8_t cable_num, const uint8_t* buffer, uint32_t bufsize);
+
+#endif /* HOST_TEST_TUSB_H_ */
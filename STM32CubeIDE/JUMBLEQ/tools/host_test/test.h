@@ -0,0 +1,46 @@
+/*
+ * test.h
+ *
+ *  Created on: Mar 23, 2026
+ */
+
+#ifndef TEST_H_
+#define TEST_H_
+
+#include <stdio.h>
+#include <string.h>
+
+#define ARRAY_SIZE(a) (sizeof(a) / sizeof((a)[0]))
+
+// 1 テスト = 1 実行ファイル。失敗しても最後まで回して数を返す
+static int test_failures;
+
+#define CHECK(cond)                                                      \
+    do                                                                   \
+    {                                                                    \
+        if (!(cond))                                                     \
+        {                                                                \
+            printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            test_failures++;                                             \
+        }                                                                \
+    } while (0)
+
+#define CHECK_EQ(a, b)                                                                                       \
+    do                                                                                                       \
+    {                                                                                                        \
+        const long long a_ = (long long) (a);                                                                \
+        const long long b_ = (long long) (b);                                                                \
+        if (a_ != b_)                                                                                        \
+        {                                                                                                    \
+            printf("%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", __FILE__, __LINE__, #a, #b, a_, b_); \
+            test_failures++;                                                                                 \
+        }                                                                                                    \
+    } while (0)
+
+static inline int test_done(const char* name)
+{
+    printf("%s: %s\n", name, (test_failures == 0) ? "ok" : "FAILED");
+    return (test_failures == 0) ? 0 : 1;
+}
+
+#endif /* TEST_H_ */
@@ -0,0 +1,168 @@
+/*
+ * test_biquad_design.c
+ *
+ *  Created on: Mar 23, 2026
+ */
+
+// フォノ EQ の係数設計を倍精度のアナログ原型と比べる
+// - de-emphasis ステージ (STAGE1) の 20Hz-20kHz (ナイキスト近くは 0.45fs まで) の誤差が 44.1k/48k/96k で上限以内
+// - Q8.24 への変換 (SigmaStudio の並びと A1/A2 の符号、丸め、飽和)
+// - 範囲外の設定は設計しない
+
+#include "biquad_design.h"
+
+#include "test.h"
+
+#include <math.h>
+
+#define SWEEP_POINTS 400U
+
+typedef struct
+{
+    double fs;
+    double max_err_db;  // 実測 (RIAA): 44.1k 0.36dB、48k 0.34dB、96k 0.015dB
+} rate_case_t;
+
+static const rate_case_t k_rates[] = {
+    {44100.0, 0.40},
+    {48000.0, 0.38},
+    {96000.0, 0.03},
+};
+
+// 20Hz から上端まで対数で掃いた時の最大誤差 [dB]
+static double curve_max_err_db(uint8_t curve, const biquad_coef_t* c, double fs)
+{
+    const double f_lo = 20.0;
+    const double f_hi = (20000.0 < (fs * 0.45)) ? 20000.0 : (fs * 0.45);
+    double worst      = 0.0;
+
+    for (uint32_t i = 0; i < SWEEP_POINTS; i++)
+    {
+        const double f   = f_lo * pow(f_hi / f_lo, (double) i / (SWEEP_POINTS - 1U));
+        const double err = fabs(biquad_magnitude_db(c, f, fs) - phono_curve_reference_db(curve, f));
+        if (err > worst)
+        {
+            worst = err;
+        }
+    }
+    return worst;
+}
+
+static void test_riaa_error(void)
+{
+    for (uint32_t i = 0; i < ARRAY_SIZE(k_rates); i++)
+    {
+        phono_eq_config_t cfg;
+        biquad_coef_t stages[PHONO_EQ_STAGE_NUM];
+
+        phono_eq_config_set_defaults(&cfg);
+        CHECK(phono_eq_design_stages(&cfg, k_rates[i].fs, stages));
+
+        const double err = curve_max_err_db(PHONO_CURVE_RIAA, &stages[1], k_rates[i].fs);
+        printf("  RIAA fs=%.0f: max error %.3f dB (limit %.2f)\n", k_rates[i].fs, err, k_rates[i].max_err_db);
+        CHECK(err <= k_rates[i].max_err_db);
+
+        // 1kHz = 0dB、残りのステージは素通し
+        CHECK(fabs(biquad_magnitude_db(&stages[1], 1000.0, k_rates[i].fs)) < 1e-9);
+        CHECK(fabs(biquad_magnitude_db(&stages[0], 1000.0, k_rates[i].fs)) < 1e-9);
+        CHECK(fabs(biquad_magnitude_db(&stages[2], 1000.0, k_rates[i].fs)) < 1e-9);
+    }
+
+    // 他のカーブも同じ設計なので同じくらいに収まる
+    for (uint8_t curve = PHONO_CURVE_RIAA_IEC; curve < PHONO_CURVE_NUM; curve++)
+    {
+        biquad_coef_t c;
+        CHECK(biquad_design_phono_curve(curve, 48000.0, &c));
+        if (curve == PHONO_CURVE_RIAA_IEC)
+        {
+            continue;  // IEC の 7950us は STAGE0 側なので STAGE1 だけでは比べられない
+        }
+        CHECK(curve_max_err_db(curve, &c, 48000.0) <= 0.38);
+    }
+}
+
+static void test_q8_24(void)
+{
+    const biquad_coef_t c = {.b0 = 1.0, .b1 = -0.5, .b2 = 0.25, .a1 = -1.5, .a2 = 0.5625};
+    biquad_sigma_q8_24_t q;
+    biquad_coef_t back;
+
+    CHECK(biquad_to_sigma_q8_24(&c, &q));
+    CHECK_EQ(q.b0, 1 << 24);
+    CHECK_EQ(q.b1, -(1 << 23));
+    CHECK_EQ(q.b2, 1 << 22);
+    CHECK_EQ(q.a1, 3 << 23);   // SigmaStudio は A1/A2 の符号が逆
+    CHECK_EQ(q.a2, -(9 << 20));
+    biquad_from_sigma_q8_24(&q, &back);
+    CHECK(back.a1 == c.a1);
+    CHECK(back.a2 == c.a2);
+
+    // 丸めは最近接 (1/2 LSB の誤差以内で戻る)
+    const biquad_coef_t r = {.b0 = 0.1234567, .b1 = -0.7654321, .b2 = 1e-9, .a1 = 0.3, .a2 = -0.3};
+    CHECK(biquad_to_sigma_q8_24(&r, &q));
+    biquad_from_sigma_q8_24(&q, &back);
+    CHECK(fabs(back.b0 - r.b0) <= 0.5 / 16777216.0);
+    CHECK(fabs(back.b1 - r.b1) <= 0.5 / 16777216.0);
+    CHECK_EQ(q.b2, 0);
+
+    // Q8.24 の範囲 (-128..128) を超えたら端に張り付けて false
+    const biquad_coef_t big = {.b0 = 200.0, .b1 = -200.0, .b2 = 0.0, .a1 = 0.0, .a2 = 0.0};
+    CHECK(!biquad_to_sigma_q8_24(&big, &q));
+    CHECK_EQ(q.b0, INT32_MAX);
+    CHECK_EQ(q.b1, INT32_MIN);
+    CHECK_EQ(q.b2, 0);
+
+    CHECK(!biquad_to_sigma_q8_24(NULL, &q));
+    CHECK(!biquad_to_sigma_q8_24(&c, NULL));
+}
+
+static void test_reject_invalid(void)
+{
+    phono_eq_config_t cfg;
+    biquad_coef_t stages[PHONO_EQ_STAGE_NUM];
+    biquad_coef_t c;
+
+    phono_eq_config_set_defaults(&cfg);
+    CHECK(phono_eq_config_is_valid(&cfg));
+
+    cfg.curve = PHONO_CURVE_NUM;
+    CHECK(!phono_eq_config_is_valid(&cfg));
+    CHECK(!phono_eq_design_stages(&cfg, 48000.0, stages));
+
+    phono_eq_config_set_defaults(&cfg);
+    cfg.rumble_hz = PHONO_EQ_RUMBLE_HZ_MIN - 1U;
+    CHECK(!phono_eq_design_stages(&cfg, 48000.0, stages));
+    cfg.rumble_hz = PHONO_EQ_RUMBLE_HZ_MAX + 1U;
+    CHECK(!phono_eq_design_stages(&cfg, 48000.0, stages));
+    cfg.rumble_hz = PHONO_EQ_RUMBLE_HZ_MAX;
+    CHECK(phono_eq_design_stages(&cfg, 48000.0, stages));
+
+    phono_eq_config_set_defaults(&cfg);
+    cfg.treble_qdb = (int8_t) (PHONO_EQ_TREBLE_DB_MAX * 4.0 + 1.0);
+    CHECK(!phono_eq_design_stages(&cfg, 48000.0, stages));
+    cfg.treble_qdb = (int8_t) -(PHONO_EQ_TREBLE_DB_MAX * 4.0 + 1.0);
+    CHECK(!phono_eq_design_stages(&cfg, 48000.0, stages));
+
+    phono_eq_config_set_defaults(&cfg);
+    cfg.treble_qdb = 8;
+    cfg.treble_hz  = PHONO_EQ_TREBLE_HZ_MIN - 1U;
+    CHECK(!phono_eq_design_stages(&cfg, 48000.0, stages));
+    cfg.treble_hz = PHONO_EQ_TREBLE_HZ_MAX + 1U;
+    CHECK(!phono_eq_design_stages(&cfg, 48000.0, stages));
+
+    // 44.1kHz では 16kHz のシェルフは作れるが、ナイキストを超える周波数は作らない
+    cfg.treble_hz = PHONO_EQ_TREBLE_HZ_MAX;
+    CHECK(phono_eq_design_stages(&cfg, 44100.0, stages));
+    CHECK(!biquad_design_highshelf(24000.0, 1.0, 3.0, 44100.0, &c));
+    CHECK(!biquad_design_highpass(0.0, 0.7, 48000.0, &c));
+    CHECK(!biquad_design_phono_curve(PHONO_CURVE_RIAA, 0.0, &c));
+    CHECK(!phono_eq_design_stages(NULL, 48000.0, stages));
+}
+
+int main(void)
+{
+    test_riaa_error();
+    test_q8_24();
+    test_reject_invalid();
+    return test_done("biquad_design");
+}
@@ -0,0 +1,376 @@
+/*
+ * test_dsp_image.c
+ *
+ *  Created on: Mar 23, 2026
+ */
+
+// DSP プログラムイメージの検査と圧縮 frame の展開に、壊れた入力を流す
+// - LZ: 途中で切れたストリーム、展開先を超えるストリーム、範囲外の距離はどれも失敗し、dst_len の外には書かない
+// - ヘッダ: magic/version、長さ (スロット超え、header_size との矛盾、表のはみ出し)、CRC のどれが壊れても通さない
+// - op 表: WRITE/DELAY の長さとオフセットが範囲外なら通さない
+
+#include "dsp_image.h"
+
+#include "test.h"
+
+#include <string.h>
+
+#define SLOT_SIZE 0x00040000UL
+#define GUARD     0xA5U
+
+// ---- LZ ----
+
+// 展開先の後ろに番兵を置き、失敗しても dst_len の外に書いていないことを見る
+static bool decode(const uint8_t* src, uint32_t src_len, uint32_t dst_len, uint8_t* out)
+{
+    uint8_t dst[64];
+
+    memset(dst, GUARD, sizeof(dst));
+    const bool ok = dsp_image_lz_decode(src, src_len, dst, dst_len);
+    for (uint32_t i = dst_len; i < sizeof(dst); i++)
+    {
+        CHECK_EQ(dst[i], GUARD);
+    }
+    if (out != NULL)
+    {
+        memcpy(out, dst, dst_len);
+    }
+    return ok;
+}
+
+#define LIT(n)   ((uint8_t) ((n) - 1U))
+#define MATCH(n) ((uint8_t) (DSP_IMAGE_LZ_MATCH_FLAG | ((n) - DSP_IMAGE_LZ_MATCH_MIN)))
+#define DIST(d)  (uint8_t) ((d) & 0xFFU), (uint8_t) ((d) >> 8)
+
+// "ABC" + 一致 (5, 距離3) + RLE (4, 距離1) = "ABCABCAB" "BBBB"
+static const uint8_t k_lz[] = {LIT(3), 'A', 'B', 'C', MATCH(5), DIST(3), MATCH(4), DIST(1)};
+static const char k_lz_out[] = "ABCABCABBBBB";
+#define LZ_OUT_LEN 12U
+
+static void test_lz_valid(void)
+{
+    uint8_t out[64];
+
+    CHECK(decode(k_lz, sizeof(k_lz), LZ_OUT_LEN, out));
+    CHECK(memcmp(out, k_lz_out, LZ_OUT_LEN) == 0);
+
+    // 最長のリテラル (128) と一致 (130)
+    uint8_t src[1 + 128 + 3];
+    uint8_t dst[128 + 130];
+    src[0] = LIT(128U);
+    for (uint32_t i = 0; i < 128U; i++)
+    {
+        src[1 + i] = (uint8_t) i;
+    }
+    src[129] = MATCH(130U);
+    src[130] = 128U;
+    src[131] = 0U;
+    CHECK(dsp_image_lz_decode(src, sizeof(src), dst, sizeof(dst)));
+    for (uint32_t i = 0; i < sizeof(dst); i++)
+    {
+        CHECK_EQ(dst[i], (uint8_t) (i % 128U));
+    }
+
+    // 距離 = 出力済みの長さ (先頭を指す) は範囲内
+    static const uint8_t edge[] = {LIT(2), 'x', 'y', MATCH(3), DIST(2)};
+    CHECK(decode(edge, sizeof(edge), 5U, out));
+    CHECK(memcmp(out, "xyxyx", 5) == 0);
+
+    // 空の frame は作られないが、0 byte → 0 byte は成功
+    CHECK(decode(k_lz, 0U, 0U, NULL));
+}
+
+static void test_lz_truncated(void)
+{
+    // リテラルの途中で切れる
+    static const uint8_t lit[] = {LIT(3), 'A', 'B'};
+    CHECK(!decode(lit, sizeof(lit), 3U, NULL));
+
+    // 一致の距離が無い / 1 byte しかない
+    static const uint8_t no_dist[] = {LIT(1), 'A', MATCH(3)};
+    static const uint8_t half_dist[] = {LIT(1), 'A', MATCH(3), 0x01U};
+    CHECK(!decode(no_dist, sizeof(no_dist), 4U, NULL));
+    CHECK(!decode(half_dist, sizeof(half_dist), 4U, NULL));
+
+    // ストリームのどこで切っても、元の長さには届かない
+    for (uint32_t len = 0; len < sizeof(k_lz); len++)
+    {
+        CHECK(!decode(k_lz, len, LZ_OUT_LEN, NULL));
+    }
+
+    // 全部読んでも出力が足りない
+    CHECK(!decode(k_lz, sizeof(k_lz), LZ_OUT_LEN + 1U, NULL));
+}
+
+static void test_lz_overlong(void)
+{
+    // リテラル / 一致が展開先を超える
+    static const uint8_t lit[] = {LIT(4), 'A', 'B', 'C', 'D'};
+    static const uint8_t match[] = {LIT(1), 'A', MATCH(5), DIST(1)};
+    CHECK(!decode(lit, sizeof(lit), 3U, NULL));
+    CHECK(!decode(match, sizeof(match), 5U, NULL));
+    CHECK(decode(match, sizeof(match), 6U, NULL));
+
+    // 展開先が埋まった後にまだ続く
+    for (uint32_t dst_len = 0; dst_len < LZ_OUT_LEN; dst_len++)
+    {
+        CHECK(!decode(k_lz, sizeof(k_lz), dst_len, NULL));
+    }
+    uint8_t tail[sizeof(k_lz) + 2U];
+    memcpy(tail, k_lz, sizeof(k_lz));
+    tail[sizeof(k_lz)]      = LIT(1);
+    tail[sizeof(k_lz) + 1U] = 'X';
+    CHECK(!decode(tail, sizeof(tail), LZ_OUT_LEN, NULL));
+    CHECK(!decode(tail, sizeof(k_lz) + 1U, LZ_OUT_LEN, NULL));  // トークンだけ余る
+}
+
+static void test_lz_distance(void)
+{
+    // 最初のトークンが一致 (まだ何も出ていない)
+    static const uint8_t first[] = {MATCH(3), DIST(1)};
+    CHECK(!decode(first, sizeof(first), 3U, NULL));
+
+    // 距離 0、出力済みより 1 遠い、最大
+    static const uint8_t zero[] = {LIT(2), 'x', 'y', MATCH(3), DIST(0)};
+    static const uint8_t past[] = {LIT(2), 'x', 'y', MATCH(3), DIST(3)};
+    static const uint8_t far[]  = {LIT(2), 'x', 'y', MATCH(3), DIST(0xFFFFU)};
+    CHECK(!decode(zero, sizeof(zero), 5U, NULL));
+    CHECK(!decode(past, sizeof(past), 5U, NULL));
+    CHECK(!decode(far, sizeof(far), 5U, NULL));
+}
+
+// ---- イメージ ----
+
+// ヘッダ + op 3 つ (非圧縮 WRITE, 圧縮 WRITE, DELAY) + パラメータ 2 つ + frame 2 つ
+static uint32_t s_buf[128];
+#define IMG ((dsp_image_header_t*) s_buf)
+
+static const uint8_t k_raw_data[] = {0x00, 0x00, 0x00, 0x01, 0x00, 0x80, 0x00, 0x00};
+
+static dsp_image_op_t* op_at(uint16_t i)
+{
+    return (dsp_image_op_t*) ((uint8_t*) s_buf + IMG->op_offset) + i;
+}
+
+static void seal(void)
+{
+    const uint8_t* base = (const uint8_t*) s_buf;
+    IMG->crc32          = dsp_image_crc32(base + IMG->header_size, IMG->image_size - IMG->header_size);
+}
+
+static void build(void)
+{
+    uint8_t* base = (uint8_t*) s_buf;
+    uint32_t pos;
+
+    memset(s_buf, 0, sizeof(s_buf));
+    IMG->magic        = DSP_IMAGE_MAGIC;
+    IMG->version      = DSP_IMAGE_VERSION;
+    IMG->header_size  = sizeof(dsp_image_header_t);
+    memcpy(IMG->name, "test", 5);
+    IMG->op_count     = 3U;
+    IMG->op_offset    = sizeof(dsp_image_header_t);
+    IMG->param_count  = 2U;
+    IMG->param_offset = IMG->op_offset + 3U * sizeof(dsp_image_op_t);
+    IMG->symbol_count = 0U;
+    IMG->symbol_offset = IMG->param_offset + 2U * sizeof(dsp_image_param_t);
+    pos                = IMG->symbol_offset;
+
+    dsp_image_param_t* param = (dsp_image_param_t*) (base + IMG->param_offset);
+    param[0]                 = (dsp_image_param_t) {0U, 0x0100U};
+    param[1]                 = (dsp_image_param_t) {1U, 0x0104U};
+
+    dsp_image_op_t* op = op_at(0);
+    op[0]              = (dsp_image_op_t) {DSP_IMAGE_OP_WRITE, 0U, 0x1234U, sizeof(k_raw_data), pos, sizeof(k_raw_data) + 3U};
+    base[pos++]        = 0x01U;
+    base[pos++]        = 0x12U;
+    base[pos++]        = 0x34U;
+    memcpy(&base[pos], k_raw_data, sizeof(k_raw_data));
+    pos += sizeof(k_raw_data);
+
+    op[1]       = (dsp_image_op_t) {DSP_IMAGE_OP_WRITE, DSP_IMAGE_OP_FLAG_LZ, 0x2000U, LZ_OUT_LEN, pos, sizeof(k_lz) + 3U};
+    base[pos++] = 0x01U;
+    base[pos++] = 0x20U;
+    base[pos++] = 0x00U;
+    memcpy(&base[pos], k_lz, sizeof(k_lz));
+    pos += sizeof(k_lz);
+
+    op[2] = (dsp_image_op_t) {DSP_IMAGE_OP_DELAY, 0U, 0U, 10U, 0U, 0U};
+
+    IMG->image_size = pos;
+    seal();
+}
+
+static void test_image_valid(void)
+{
+    static const uint8_t check[] = "123456789";
+    CHECK_EQ(dsp_image_crc32(check, 9U), 0xCBF43926UL);  // CRC-32/ISO-HDLC の検査値
+
+    build();
+    CHECK(dsp_image_validate(IMG, SLOT_SIZE));
+    CHECK(dsp_image_validate(IMG, IMG->image_size));  // ちょうどスロットの大きさ
+
+    // 圧縮 op はイメージの中から展開できる
+    const dsp_image_op_t* op = op_at(1);
+    uint8_t out[LZ_OUT_LEN];
+    CHECK(dsp_image_lz_decode((const uint8_t*) s_buf + op->offset + 3U, op->stored - 3U, out, op->length));
+    CHECK(memcmp(out, k_lz_out, LZ_OUT_LEN) == 0);
+}
+
+static void test_image_magic(void)
+{
+    build();
+    IMG->magic ^= 1U;
+    CHECK(!dsp_image_check_header(IMG, SLOT_SIZE));
+    CHECK(!dsp_image_validate(IMG, SLOT_SIZE));
+
+    build();
+    IMG->magic = 0xFFFFFFFFUL;  // 消去したままのスロット
+    CHECK(!dsp_image_validate(IMG, SLOT_SIZE));
+
+    build();
+    IMG->version = DSP_IMAGE_VERSION - 1U;  // 非圧縮だけの v1
+    CHECK(!dsp_image_validate(IMG, SLOT_SIZE));
+}
+
+static void test_image_crc(void)
+{
+    // CRC 自体、op 表、パラメータ表、frame のどこを 1bit 変えても通さない
+    build();
+    IMG->crc32 ^= 1U;
+    CHECK(dsp_image_check_header(IMG, SLOT_SIZE));
+    CHECK(!dsp_image_validate(IMG, SLOT_SIZE));
+
+    build();
+    for (uint32_t pos = IMG->header_size; pos < IMG->image_size; pos++)
+    {
+        ((uint8_t*) s_buf)[pos] ^= 0x10U;
+        CHECK(!dsp_image_validate(IMG, SLOT_SIZE));
+        ((uint8_t*) s_buf)[pos] ^= 0x10U;
+    }
+    CHECK(dsp_image_validate(IMG, SLOT_SIZE));
+
+    // 最後の 1 byte が書けていない
+    build();
+    IMG->image_size--;
+    CHECK(!dsp_image_validate(IMG, SLOT_SIZE));
+}
+
+static void test_image_length(void)
+{
+    build();
+    CHECK(!dsp_image_validate(IMG, IMG->image_size - 1U));  // スロットより大きい
+
+    build();
+    IMG->header_size = sizeof(dsp_image_header_t) - 4U;
+    seal();
+    CHECK(!dsp_image_validate(IMG, SLOT_SIZE));
+
+    build();
+    IMG->header_size = (uint16_t) (IMG->image_size + 4U);
+    CHECK(!dsp_image_check_header(IMG, SLOT_SIZE));
+
+    // image_size が表の途中で終わる (CRC は合わせる)
+    build();
+    IMG->image_size = IMG->param_offset + sizeof(dsp_image_param_t);
+    seal();
+    CHECK(!dsp_image_validate(IMG, SLOT_SIZE));
+
+    // 表がイメージの外にはみ出す / 数が大きすぎて掛け算が溢れる
+    build();
+    IMG->op_count = 0xFFFFU;
+    seal();
+    CHECK(!dsp_image_validate(IMG, SLOT_SIZE));
+    build();
+    IMG->op_count = 0U;
+    seal();
+    CHECK(!dsp_image_validate(IMG, SLOT_SIZE));
+    build();
+    IMG->op_offset = 0xFFFFFFF0UL;
+    seal();
+    CHECK(!dsp_image_validate(IMG, SLOT_SIZE));
+    build();
+    IMG->param_count = (uint16_t) ((IMG->image_size - IMG->param_offset) / sizeof(dsp_image_param_t) + 1U);
+    seal();
+    CHECK(!dsp_image_validate(IMG, SLOT_SIZE));
+    build();
+    IMG->symbol_count = (uint16_t) ((IMG->image_size - IMG->symbol_offset) / sizeof(dsp_image_symbol_t) + 1U);
+    seal();
+    CHECK(!dsp_image_validate(IMG, SLOT_SIZE));
+
+    // 表の境界がずれている
+    build();
+    IMG->symbol_offset += 2U;
+    seal();
+    CHECK(!dsp_image_validate(IMG, SLOT_SIZE));
+}
+
+// op を 1 つ壊して CRC を合わせ直す。ヘッダは通り、op 表で弾かれる
+static bool sealed_ops_ok(void)
+{
+    seal();
+    CHECK(dsp_image_check_header(IMG, SLOT_SIZE));
+    return dsp_image_check_ops(IMG) || dsp_image_validate(IMG, SLOT_SIZE);
+}
+
+static void test_image_ops(void)
+{
+    build();
+    op_at(0)->length = 0U;
+    CHECK(!sealed_ops_ok());
+
+    build();
+    op_at(1)->length = DSP_IMAGE_FRAME_MAX - DSP_IMAGE_FRAME_HDR_SIZE + 1U;  // SPI の 1 回の転送を超える
+    CHECK(!sealed_ops_ok());
+
+    build();
+    op_at(0)->stored = DSP_IMAGE_FRAME_HDR_SIZE;  // frame ヘッダだけ
+    CHECK(!sealed_ops_ok());
+
+    build();
+    op_at(0)->stored--;  // 非圧縮は length + 3
+    CHECK(!sealed_ops_ok());
+
+    build();
+    op_at(0)->offset = IMG->header_size - 1U;  // ヘッダに重なる
+    CHECK(!sealed_ops_ok());
+
+    build();
+    op_at(1)->offset++;  // 最後の frame が 1 byte はみ出す
+    CHECK(!sealed_ops_ok());
+
+    build();
+    op_at(1)->offset = 0xFFFFFFFFUL;
+    CHECK(!sealed_ops_ok());
+
+    build();
+    op_at(1)->stored = 0xFFFFFFFFUL;  // offset + stored が溢れる
+    CHECK(!sealed_ops_ok());
+
+    build();
+    op_at(2)->length = DSP_IMAGE_DELAY_MAX_MS + 1U;
+    CHECK(!sealed_ops_ok());
+
+    build();
+    op_at(2)->type = DSP_IMAGE_OP_NUM;
+    CHECK(!sealed_ops_ok());
+
+    // 境界ちょうどは通る
+    build();
+    op_at(2)->length = DSP_IMAGE_DELAY_MAX_MS;
+    CHECK(sealed_ops_ok());
+}
+
+int main(void)
+{
+    test_lz_valid();
+    test_lz_truncated();
+    test_lz_overlong();
+    test_lz_distance();
+    test_image_valid();
+    test_image_magic();
+    test_image_crc();
+    test_image_length();
+    test_image_ops();
+    return test_done("dsp_image");
+}
@@ -0,0 +1,344 @@
+/*
+ * test_eeprom.c
+ *
+ *  Created on: Mar 23, 2026
+ */
+
+#include "eeprom.h"
+
+#include "adau1466.h"
+#include "audio_control.h"
+#include "fake_i2c.h"
+#include "test.h"
+
+#include <string.h>
+
+static I2C_HandleTypeDef s_hi2c;
+static UI_ControlPersistState_t s_applied;
+static int s_apply_calls;
+
+// eeprom.c が呼ぶ ui_control 側。apply は受け取った値を覚えておくだけ
+void ui_control_get_persist_state(UI_ControlPersistState_t* state)
+{
+    *state = s_applied;
+}
+
+bool ui_control_apply_persist_state(const UI_ControlPersistState_t* state)
+{
+    s_applied = *state;
+    s_apply_calls++;
+    return true;
+}
+
+static uint32_t crc32(const uint8_t* data, uint32_t len)
+{
+    uint32_t crc = 0xFFFFFFFFUL;
+    for (uint32_t i = 0; i < len; i++)
+    {
+        crc ^= data[i];
+        for (uint32_t j = 0; j < 8U; j++)
+        {
+            crc = (crc >> 1) ^ ((crc & 1U) ? 0xEDB88320UL : 0U);
+        }
+    }
+    return ~crc;
+}
+
+static void put_u16(uint8_t* p, uint16_t v)
+{
+    memcpy(p, &v, sizeof(v));
+}
+
+static void put_u32(uint8_t* p, uint32_t v)
+{
+    memcpy(p, &v, sizeof(v));
+}
+
+static void test_defaults(void)
+{
+    EEPROM_DeviceConfig_t cfg;
+
+    memset(&cfg, 0xAA, sizeof(cfg));
+    EEPROM_ConfigSetDefaults(&cfg);
+
+    CHECK(EEPROM_ConfigIsValid(&cfg));
+    CHECK_EQ(cfg.current_ch1_input_type, INPUT_TYPE_LINE);
+    CHECK_EQ(cfg.current_ch2_input_type, INPUT_TYPE_LINE);
+    CHECK_EQ(cfg.current_xfA_assign, INPUT_SRC_CH2_LN);
+    CHECK_EQ(cfg.current_xfB_assign, INPUT_SRC_CH1_LN);
+    CHECK_EQ(cfg.current_xfpost_assign, INPUT_SRC_USB12);
+    CHECK_EQ(cfg.current_ch1_dvs_enable, 0);
+    CHECK_EQ(cfg.current_ch2_dvs_enable, 0);
+    for (int f = 0; f < XFADE_FADER_NUM; f++)
+    {
+        CHECK_EQ(cfg.current_xf_curve[f], XFADE_CURVE_SCRATCH);
+        CHECK_EQ(cfg.current_xf_cut[f], MAG_XFADE_CUTOFF);
+    }
+    // ユーザーカーブの初期値は直線
+    CHECK_EQ(cfg.current_xf_user_curve[0], 0);
+    CHECK_EQ(cfg.current_xf_user_curve[XFADE_USER_POINT_NUM - 1U], 127);
+    for (uint32_t i = 1; i < XFADE_USER_POINT_NUM; i++)
+    {
+        CHECK(cfg.current_xf_user_curve[i] > cfg.current_xf_user_curve[i - 1U]);
+    }
+}
+
+static void test_validate(void)
+{
+    EEPROM_DeviceConfig_t def;
+    EEPROM_DeviceConfig_t cfg;
+
+    EEPROM_ConfigSetDefaults(&def);
+    CHECK(!EEPROM_ConfigIsValid(NULL));
+
+#define EXPECT_INVALID(field, value) \
+    do                               \
+    {                                \
+        cfg       = def;             \
+        cfg.field = (value);         \
+        CHECK(!EEPROM_ConfigIsValid(&cfg)); \
+    } while (0)
+#define EXPECT_VALID(field, value) \
+    do                             \
+    {                              \
+        cfg       = def;           \
+        cfg.field = (value);       \
+        CHECK(EEPROM_ConfigIsValid(&cfg)); \
+    } while (0)
+
+    EXPECT_VALID(current_ch1_input_type, INPUT_TYPE_PHONO);
+    EXPECT_INVALID(current_ch1_input_type, INPUT_TYPE_PHONO + 1);
+    EXPECT_INVALID(current_ch2_input_type, 0xFF);
+    EXPECT_VALID(current_xfA_assign, INPUT_SRC_USB34);
+    EXPECT_INVALID(current_xfA_assign, INPUT_SRC_NONE);
+    EXPECT_INVALID(current_xfB_assign, INPUT_SRC_NONE);
+    EXPECT_INVALID(current_xfpost_assign, 0x80);
+    EXPECT_VALID(current_ch1_dvs_enable, 1);
+    EXPECT_INVALID(current_ch1_dvs_enable, 2);
+    EXPECT_INVALID(current_ch2_dvs_enable, 2);
+    EXPECT_VALID(current_xf_curve[1], XFADE_CURVE_USER);
+    EXPECT_INVALID(current_xf_curve[0], XFADE_CURVE_NUM);
+    EXPECT_INVALID(current_xf_curve[1], XFADE_CURVE_NUM);
+    EXPECT_VALID(current_xf_cut[0], MAG_XFADE_CUT_MAX);
+    EXPECT_INVALID(current_xf_cut[1], MAG_XFADE_CUT_MAX + 1);
+    EXPECT_VALID(current_xf_user_curve[3], 127);
+    EXPECT_INVALID(current_xf_user_curve[15], 128);
+
+#undef EXPECT_INVALID
+#undef EXPECT_VALID
+
+    // 範囲外は ui_control まで届かない
+    cfg                      = def;
+    cfg.current_xf_curve[0]  = XFADE_CURVE_NUM;
+    s_apply_calls            = 0;
+    CHECK(!EEPROM_ConfigApply(&cfg));
+    CHECK_EQ(s_apply_calls, 0);
+    CHECK(EEPROM_ConfigApply(&def));
+    CHECK_EQ(s_apply_calls, 1);
+    CHECK_EQ(s_applied.current_xf_cut[1], MAG_XFADE_CUTOFF);
+}
+
+static void test_roundtrip(void)
+{
+    EEPROM_DeviceConfig_t cfg;
+    EEPROM_DeviceConfig_t out;
+
+    fake_i2c_reset();
+    EEPROM_ConfigSetDefaults(&cfg);
+    cfg.current_ch2_input_type = INPUT_TYPE_PHONO;
+    cfg.current_xfpost_assign  = INPUT_SRC_USB34;
+    cfg.current_xf_curve[1]    = XFADE_CURVE_USER;
+    cfg.current_xf_cut[0]      = 3U;
+    cfg.current_xf_user_curve[7] = 100U;
+
+    // 何も書かれていない (0xFF) EEPROM は読めない
+    CHECK(EEPROM_LoadConfig(&s_hi2c, &out) != HAL_OK);
+
+    CHECK_EQ(EEPROM_SaveConfig(&s_hi2c, &cfg), HAL_OK);
+    CHECK_EQ(fake_i2c.page_crossings, 0);
+    CHECK_EQ(fake_i2c.writes_while_busy, 0);
+    memset(&out, 0, sizeof(out));
+    CHECK_EQ(EEPROM_LoadConfig(&s_hi2c, &out), HAL_OK);
+    CHECK(memcmp(&cfg, &out, sizeof(cfg)) == 0);
+
+    // CRC 違い
+    fake_i2c.mem[EEPROM_CONFIG_ADDR + 9U] ^= 0x01U;
+    CHECK(EEPROM_LoadConfig(&s_hi2c, &out) != HAL_OK);
+    fake_i2c.mem[EEPROM_CONFIG_ADDR + 9U] ^= 0x01U;
+    CHECK_EQ(EEPROM_LoadConfig(&s_hi2c, &out), HAL_OK);
+
+    // プリセットは magic が違うので設定レコードとしては読めない (逆も)
+    for (uint8_t slot = 0; slot < EEPROM_PRESET_NUM; slot++)
+    {
+        cfg.current_xf_cut[1] = (uint8_t) (10U + slot);
+        CHECK_EQ(EEPROM_SavePreset(&s_hi2c, slot, &cfg), HAL_OK);
+    }
+    CHECK(EEPROM_SavePreset(&s_hi2c, EEPROM_PRESET_NUM, &cfg) != HAL_OK);
+    CHECK(EEPROM_LoadPreset(&s_hi2c, EEPROM_PRESET_NUM, &out) != HAL_OK);
+    for (uint8_t slot = 0; slot < EEPROM_PRESET_NUM; slot++)
+    {
+        CHECK_EQ(EEPROM_LoadPreset(&s_hi2c, slot, &out), HAL_OK);
+        CHECK_EQ(out.current_xf_cut[1], 10U + slot);
+    }
+    CHECK_EQ(fake_i2c.page_crossings, 0);
+}
+
+// CRC は合っているが中身が範囲外 (別のファームが書いたなど) のレコードは読み込まない
+static void test_reject_out_of_range(void)
+{
+    uint8_t rec[sizeof(uint32_t) + 2U * sizeof(uint16_t) + sizeof(EEPROM_DeviceConfig_t) + sizeof(uint32_t)];
+    EEPROM_DeviceConfig_t cfg;
+    const uint32_t crc_at = 8U + sizeof(EEPROM_DeviceConfig_t);
+
+    fake_i2c_reset();
+    EEPROM_ConfigSetDefaults(&cfg);
+    cfg.current_xfA_assign = INPUT_SRC_NONE;
+
+    put_u32(&rec[0], EEPROM_CONFIG_MAGIC);
+    put_u16(&rec[4], EEPROM_CONFIG_VERSION);
+    put_u16(&rec[6], (uint16_t) sizeof(EEPROM_DeviceConfig_t));
+    memcpy(&rec[8], &cfg, sizeof(cfg));
+    put_u32(&rec[crc_at], crc32(rec, crc_at));
+    memcpy(&fake_i2c.mem[EEPROM_CONFIG_ADDR], rec, sizeof(rec));
+
+    CHECK(EEPROM_LoadConfig(&s_hi2c, &cfg) != HAL_OK);
+}
+
+// v2 (payload 8 バイト) のレコードは先頭 8 バイトを使い、v3 で増えた分は初期値で補う
+static void test_migrate_v2(void)
+{
+    const uint8_t v2_payload[EEPROM_CONFIG_V2_PAYLOAD_SIZE] = {
+        INPUT_TYPE_PHONO, INPUT_TYPE_LINE, INPUT_SRC_USB12, INPUT_SRC_CH2_PN, INPUT_SRC_CH1_LN, 1U, 0U, 0U,
+    };
+    uint8_t rec[8U + EEPROM_CONFIG_V2_PAYLOAD_SIZE + 4U];
+    EEPROM_DeviceConfig_t cfg;
+    EEPROM_DeviceConfig_t def;
+
+    fake_i2c_reset();
+    put_u32(&rec[0], EEPROM_CONFIG_MAGIC);
+    put_u16(&rec[4], 0x0002U);
+    put_u16(&rec[6], EEPROM_CONFIG_V2_PAYLOAD_SIZE);
+    memcpy(&rec[8], v2_payload, sizeof(v2_payload));
+    put_u32(&rec[16], crc32(rec, 16U));
+    memcpy(&fake_i2c.mem[EEPROM_CONFIG_ADDR], rec, sizeof(rec));
+
+    memset(&cfg, 0x55, sizeof(cfg));
+    CHECK_EQ(EEPROM_LoadConfig(&s_hi2c, &cfg), HAL_OK);
+    CHECK_EQ(cfg.current_ch1_input_type, INPUT_TYPE_PHONO);
+    CHECK_EQ(cfg.current_xfA_assign, INPUT_SRC_USB12);
+    CHECK_EQ(cfg.current_xfB_assign, INPUT_SRC_CH2_PN);
+    CHECK_EQ(cfg.current_xfpost_assign, INPUT_SRC_CH1_LN);
+    CHECK_EQ(cfg.current_ch1_dvs_enable, 1);
+
+    EEPROM_ConfigSetDefaults(&def);
+    CHECK(memcmp(cfg.current_xf_curve, def.current_xf_curve, sizeof(def.current_xf_curve)) == 0);
+    CHECK(memcmp(cfg.current_xf_cut, def.current_xf_cut, sizeof(def.current_xf_cut)) == 0);
+    CHECK(memcmp(cfg.current_xf_user_curve, def.current_xf_user_curve, sizeof(def.current_xf_user_curve)) == 0);
+
+    // v2 の CRC 違い
+    fake_i2c.mem[EEPROM_CONFIG_ADDR + 10U] ^= 0x80U;
+    CHECK(EEPROM_LoadConfig(&s_hi2c, &cfg) != HAL_OK);
+    fake_i2c.mem[EEPROM_CONFIG_ADDR + 10U] ^= 0x80U;
+
+    // v2 でも範囲外は読まない
+    rec[8] = 7U;
+    put_u32(&rec[16], crc32(rec, 16U));
+    memcpy(&fake_i2c.mem[EEPROM_CONFIG_ADDR], rec, sizeof(rec));
+    CHECK(EEPROM_LoadConfig(&s_hi2c, &cfg) != HAL_OK);
+
+    // 一度保存し直すと v3 として読める
+    EEPROM_ConfigSetDefaults(&cfg);
+    CHECK_EQ(EEPROM_SaveConfig(&s_hi2c, &cfg), HAL_OK);
+    CHECK_EQ(fake_i2c.mem[EEPROM_CONFIG_ADDR + 4U], EEPROM_CONFIG_VERSION & 0xFFU);
+    CHECK_EQ(EEPROM_LoadConfig(&s_hi2c, &cfg), HAL_OK);
+}
+
+// ページ境界をまたぐ書き込みはページ毎に分けて、書き込みサイクルを待ってから次を書く
+static void test_write_pages(void)
+{
+    uint8_t buf[300];
+    uint8_t out[sizeof(buf)];
+
+    fake_i2c_reset();
+    for (uint32_t i = 0; i < sizeof(buf); i++)
+    {
+        buf[i] = (uint8_t) (i * 7U + 1U);
+    }
+    CHECK_EQ(EEPROM_Write(&s_hi2c, 0x1F70U, buf, (uint16_t) sizeof(buf)), HAL_OK);
+    CHECK_EQ(fake_i2c.page_crossings, 0);
+    CHECK_EQ(fake_i2c.writes_while_busy, 0);
+    CHECK_EQ(fake_i2c.writes, 4);  // 0x1F70-0x1F7F, 0x1F80-, 0x2000-, 0x2080-
+    CHECK_EQ(EEPROM_Read(&s_hi2c, 0x1F70U, out, (uint16_t) sizeof(out)), HAL_OK);
+    CHECK(memcmp(buf, out, sizeof(buf)) == 0);
+
+    CHECK(EEPROM_Write(&s_hi2c, 0xFFF0U, buf, 0x20U) != HAL_OK);
+    CHECK(EEPROM_Read(&s_hi2c, 0xFFF0U, out, 0x20U) != HAL_OK);
+}
+
+// カーネルが動いている間は i2cMutex (サブ OLED と共用) を持ってからバスを触る
+// 書き込みと ACK ポーリングは同じ 1 回の中、ページの間では返す。OLED の転送待ちと HAL_BUSY はやり直す
+static void test_bus_lock(void)
+{
+    EEPROM_DeviceConfig_t cfg;
+    EEPROM_DeviceConfig_t out;
+    uint8_t buf[300];
+    uint8_t back[sizeof(buf)];
+
+    fake_i2c_reset();
+    fake_i2c.kernel_running = true;
+    for (uint32_t i = 0; i < sizeof(buf); i++)
+    {
+        buf[i] = (uint8_t) (i * 11U + 3U);
+    }
+    CHECK_EQ(EEPROM_Write(&s_hi2c, 0x1F70U, buf, (uint16_t) sizeof(buf)), HAL_OK);
+    CHECK_EQ(fake_i2c.writes, 4);
+    CHECK_EQ(fake_i2c.acquires, 4);  // ページ毎に 1 回
+    CHECK_EQ(fake_i2c.split_polls, 0);
+    CHECK_EQ(EEPROM_Read(&s_hi2c, 0x1F70U, back, (uint16_t) sizeof(back)), HAL_OK);
+    CHECK(memcmp(buf, back, sizeof(buf)) == 0);
+    CHECK_EQ(EEPROM_CheckConnection(&s_hi2c), HAL_OK);
+    CHECK_EQ(EEPROM_WaitReady(&s_hi2c, EEPROM_WRITE_CYCLE_TIMEOUT_MS), HAL_OK);
+    CHECK_EQ(fake_i2c.unlocked_xfers, 0);
+    CHECK(!fake_i2c.locked);
+
+    // ミューテックスを待っている間も含めて OLED から読み書き中に見え、終われば戻る
+    CHECK_EQ(fake_i2c.idle_acquires, 0);
+    CHECK(!EEPROM_IsBusy());
+
+    // OLED が転送中でミューテックス待ちがタイムアウトしても、やり直して書ける
+    EEPROM_ConfigSetDefaults(&cfg);
+    cfg.current_xf_cut[0]  = 7U;
+    fake_i2c.lock_timeouts = EEPROM_BUS_RETRIES - 1U;
+    CHECK_EQ(EEPROM_SaveConfig(&s_hi2c, &cfg), HAL_OK);
+    fake_i2c.hal_busy = EEPROM_BUS_RETRIES - 1U;
+    CHECK_EQ(EEPROM_LoadConfig(&s_hi2c, &out), HAL_OK);
+    CHECK_EQ(out.current_xf_cut[0], 7);
+    fake_i2c.hal_busy = EEPROM_BUS_RETRIES - 1U;
+    CHECK_EQ(EEPROM_SaveConfig(&s_hi2c, &cfg), HAL_OK);
+    CHECK_EQ(fake_i2c.unlocked_xfers, 0);
+    CHECK_EQ(fake_i2c.split_polls, 0);
+
+    // ずっと取れなければ触らずに失敗する
+    const uint32_t writes  = fake_i2c.writes;
+    fake_i2c.lock_timeouts = EEPROM_BUS_RETRIES;
+    CHECK(EEPROM_SaveConfig(&s_hi2c, &cfg) != HAL_OK);
+    CHECK_EQ(fake_i2c.writes, writes);
+    fake_i2c.lock_timeouts = EEPROM_BUS_RETRIES;
+    CHECK(EEPROM_LoadConfig(&s_hi2c, &out) != HAL_OK);
+    CHECK(!fake_i2c.locked);
+    CHECK_EQ(fake_i2c.unlocked_xfers, 0);
+    CHECK_EQ(fake_i2c.idle_acquires, 0);
+    CHECK(!EEPROM_IsBusy());
+}
+
+int main(void)
+{
+    test_defaults();
+    test_validate();
+    test_roundtrip();
+    test_reject_out_of_range();
+    test_migrate_v2();
+    test_write_pages();
+    test_bus_lock();
+    return test_done("eeprom");
+}
@@ -0,0 +1,251 @@
+/*
+ * test_input_event.c
+ *
+ *  Created on: Mar 23, 2026
+ */
+
+#include "input_event.h"
+
+#include "test.h"
+
+#define LOG_MAX 16U
+
+// ボタン 0, 1 とフェーダー 2
+static const uint8_t s_kinds[] = {INPUT_KIND_BUTTON, INPUT_KIND_BUTTON, INPUT_KIND_FADER};
+
+typedef struct
+{
+    uint32_t at;
+    uint32_t levels;
+} step_t;
+
+typedef struct
+{
+    uint32_t at;
+    uint8_t type;
+    uint8_t src;
+    uint16_t arg;
+} logged_t;
+
+static logged_t s_log[LOG_MAX];
+static uint32_t s_log_num;
+
+static void log_events(uint32_t now, const input_event_t* ev, uint8_t n)
+{
+    for (uint8_t i = 0; (i < n) && (s_log_num < LOG_MAX); i++)
+    {
+        s_log[s_log_num].at   = now;
+        s_log[s_log_num].type = ev[i].type;
+        s_log[s_log_num].src  = ev[i].src;
+        s_log[s_log_num].arg  = ev[i].arg;
+        s_log_num++;
+    }
+}
+
+// 1ms 毎に回す。levels は steps の時刻から次の step まで続く
+static void run(const step_t* steps, uint32_t num, uint32_t end)
+{
+    input_event_engine_t e;
+    uint32_t levels = 0;
+    uint32_t k      = 0;
+
+    input_event_init(&e, s_kinds, ARRAY_SIZE(s_kinds));
+    s_log_num = 0;
+    for (uint32_t now = 0; now <= end; now++)
+    {
+        input_event_t ev[8];
+
+        while ((k < num) && (steps[k].at == now))
+        {
+            levels = steps[k++].levels;
+        }
+        log_events(now, ev, input_event_update(&e, now, levels, ev, ARRAY_SIZE(ev)));
+    }
+}
+
+// adcTask と同じく、入力が変わった時と input_event_next_ms の期限にだけ回す。1ms 毎と同じ結果になること
+static void run_sparse(const step_t* steps, uint32_t num, uint32_t end)
+{
+    input_event_engine_t e;
+    uint32_t levels = 0;
+    uint32_t k      = 0;
+    uint32_t now    = 0;
+
+    input_event_init(&e, s_kinds, ARRAY_SIZE(s_kinds));
+    s_log_num = 0;
+    while (now <= end)
+    {
+        input_event_t ev[8];
+
+        while ((k < num) && (steps[k].at == now))
+        {
+            levels = steps[k++].levels;
+        }
+        log_events(now, ev, input_event_update(&e, now, levels, ev, ARRAY_SIZE(ev)));
+
+        const uint32_t wait = input_event_next_ms(&e, now);
+        uint32_t next       = (wait == 0xFFFFFFFFUL) ? (end + 1U) : (now + ((wait != 0U) ? wait : 1U));
+        if ((k < num) && (steps[k].at < next))
+        {
+            next = steps[k].at;
+        }
+        now = next;
+    }
+}
+
+static void expect(const logged_t* want, uint32_t num)
+{
+    CHECK_EQ(s_log_num, num);
+    for (uint32_t i = 0; (i < num) && (i < s_log_num); i++)
+    {
+        CHECK_EQ(s_log[i].at, want[i].at);
+        CHECK_EQ(s_log[i].type, want[i].type);
+        CHECK_EQ(s_log[i].src, want[i].src);
+        CHECK_EQ(s_log[i].arg, want[i].arg);
+    }
+}
+
+static void check(const step_t* steps, uint32_t num, uint32_t end, const logged_t* want, uint32_t want_num)
+{
+    run(steps, num, end);
+    expect(want, want_num);
+    run_sparse(steps, num, end);
+    expect(want, want_num);
+}
+
+static void test_debounce_click(void)
+{
+    // 100 で押して 3ms 跳ねる。確定は最後の変化から debounce 後、時間は生の変化の時刻で数える
+    static const step_t steps[] = {{100, 1}, {103, 0}, {105, 1}, {150, 0}};
+    static const logged_t want[] = {
+        {125, INPUT_EVENT_PRESS,   0, 0 },
+        {170, INPUT_EVENT_RELEASE, 0, 45},
+        {401, INPUT_EVENT_CLICK,   0, 0 },
+    };
+    check(steps, ARRAY_SIZE(steps), 800, want, ARRAY_SIZE(want));
+
+    // debounce より短いパルスは出さない
+    static const step_t glitch[] = {{100, 1}, {110, 0}};
+    check(glitch, ARRAY_SIZE(glitch), 600, NULL, 0);
+}
+
+static void test_double(void)
+{
+    static const step_t steps[] = {{100, 1}, {150, 0}, {300, 1}, {350, 0}};
+    static const logged_t want[] = {
+        {120, INPUT_EVENT_PRESS,   0, 0 },
+        {170, INPUT_EVENT_RELEASE, 0, 50},
+        {320, INPUT_EVENT_PRESS,   0, 0 },
+        {320, INPUT_EVENT_DOUBLE,  0, 0 },
+        {370, INPUT_EVENT_RELEASE, 0, 50},
+    };
+    check(steps, ARRAY_SIZE(steps), 900, want, ARRAY_SIZE(want));
+
+    // 受付時間 (250ms) を過ぎてからの 2 回目は CLICK が 2 つ
+    static const step_t late[] = {{100, 1}, {150, 0}, {500, 1}, {550, 0}};
+    static const logged_t want_late[] = {
+        {120, INPUT_EVENT_PRESS,   0, 0 },
+        {170, INPUT_EVENT_RELEASE, 0, 50},
+        {401, INPUT_EVENT_CLICK,   0, 0 },
+        {520, INPUT_EVENT_PRESS,   0, 0 },
+        {570, INPUT_EVENT_RELEASE, 0, 50},
+        {801, INPUT_EVENT_CLICK,   0, 0 },
+    };
+    check(late, ARRAY_SIZE(late), 1200, want_late, ARRAY_SIZE(want_late));
+}
+
+static void test_long(void)
+{
+    // LONG の後に離しても CLICK は出さない
+    static const step_t steps[] = {{100, 1}, {1200, 0}};
+    static const logged_t want[] = {
+        {120,  INPUT_EVENT_PRESS,   0, 0   },
+        {900,  INPUT_EVENT_LONG,    0, 0   },
+        {1220, INPUT_EVENT_RELEASE, 0, 1100},
+    };
+    check(steps, ARRAY_SIZE(steps), 1600, want, ARRAY_SIZE(want));
+}
+
+static void test_chord(void)
+{
+    // 1 → 0 の順に 30ms 差で押す。CHORD の後は LONG/CLICK を出さない
+    static const step_t steps[] = {{100, 2}, {130, 3}, {1400, 0}};
+    static const logged_t want[] = {
+        {120,  INPUT_EVENT_PRESS,   1, 0   },
+        {150,  INPUT_EVENT_PRESS,   0, 0   },
+        {150,  INPUT_EVENT_CHORD,   0, 3   },
+        {1420, INPUT_EVENT_RELEASE, 0, 1270},
+        {1420, INPUT_EVENT_RELEASE, 1, 1300},
+    };
+    check(steps, ARRAY_SIZE(steps), 1800, want, ARRAY_SIZE(want));
+
+    // chord_ms (80) より離れていれば別々
+    static const step_t apart[] = {{100, 2}, {200, 3}, {300, 0}};
+    static const logged_t want_apart[] = {
+        {120, INPUT_EVENT_PRESS,   1, 0  },
+        {220, INPUT_EVENT_PRESS,   0, 0  },
+        {320, INPUT_EVENT_RELEASE, 0, 100},
+        {320, INPUT_EVENT_RELEASE, 1, 200},
+        {551, INPUT_EVENT_CLICK,   0, 0  },
+        {551, INPUT_EVENT_CLICK,   1, 0  },
+    };
+    check(apart, ARRAY_SIZE(apart), 900, want_apart, ARRAY_SIZE(want_apart));
+}
+
+static void test_cut(void)
+{
+    // フェーダーは cut_ms (2) で確定。1ms のカットは出さない
+    static const step_t steps[] = {{10, 4}, {11, 0}, {20, 4}, {40, 0}};
+    static const logged_t want[] = {
+        {22, INPUT_EVENT_CUT,  2, 0},
+        {42, INPUT_EVENT_OPEN, 2, 0},
+    };
+    check(steps, ARRAY_SIZE(steps), 100, want, ARRAY_SIZE(want));
+}
+
+static void test_timing(void)
+{
+    input_event_timing_t def;
+    input_event_timing_t t;
+
+    input_event_get_timing(&def);
+
+    // long は chord と debounce より長いこと
+    t         = def;
+    t.long_ms = t.chord_ms;
+    CHECK(!input_event_set_timing(&t));
+    t         = def;
+    t.long_ms = t.debounce_ms;
+    CHECK(!input_event_set_timing(&t));
+    CHECK(!input_event_set_timing(NULL));
+
+    // double_ms = 0 なら離してすぐ CLICK
+    t           = def;
+    t.double_ms = 0;
+    t.cut_ms    = 5;
+    CHECK(input_event_set_timing(&t));
+    input_event_get_timing(&t);
+    CHECK_EQ(t.double_ms, 0);
+
+    static const step_t steps[] = {{100, 1}, {150, 0}, {200, 4}, {203, 0}, {300, 4}};
+    static const logged_t want[] = {
+        {120, INPUT_EVENT_PRESS,   0, 0 },
+        {170, INPUT_EVENT_RELEASE, 0, 50},
+        {170, INPUT_EVENT_CLICK,   0, 0 },
+        {305, INPUT_EVENT_CUT,     2, 0 },
+    };
+    check(steps, ARRAY_SIZE(steps), 600, want, ARRAY_SIZE(want));
+
+    CHECK(input_event_set_timing(&def));
+}
+
+int main(void)
+{
+    test_debounce_click();
+    test_double();
+    test_long();
+    test_chord();
+    test_cut();
+    test_timing();
+    return test_done("input_event");
+}
@@ -0,0 +1,168 @@
+/*
+ * test_led_anim.c
+ *
+ *  Created on: Mar 23, 2026
+ */
+
+#include "led_anim.h"
+
+#include "test.h"
+
+#define LEDS 5U
+
+static const uint8_t s_leds[LEDS]           = {0, 1, 2, 3, 4};
+static const uint8_t s_leds_rev[LEDS]       = {4, 3, 2, 1, 0};
+static const led_anim_rgb_t s_palette[LEDS] = {{10, 0, 0}, {20, 0, 0}, {30, 0, 0}, {40, 0, 0}, {50, 0, 0}};
+
+// led_control.c と同じ組み方: メーターの上に点のパルス、チェイスのフェード、最後に点滅
+static const led_anim_layer_def_t s_defs[] = {
+    {.leds = s_leds, .palette = s_palette, .led_num = LEDS, .shape = LED_ANIM_SHAPE_METER},
+    {.fx = &led_anim_fx_pulse, .leds = s_leds, .color = {151, 151, 151}, .period_ms = 320, .led_num = LEDS, .shape = LED_ANIM_SHAPE_POINT, .blend = LED_ANIM_BLEND_MAX},
+    {.fx = &led_anim_fx_fade, .leds = s_leds_rev, .color = {0, 0, 200}, .period_ms = 100, .led_num = LEDS, .shape = LED_ANIM_SHAPE_CHASE, .blend = LED_ANIM_BLEND_ADD, .repeat = 5},
+    {.fx = &led_anim_fx_blink, .leds = s_leds, .color = {9, 9, 9}, .period_ms = 200, .led_num = 1, .repeat = 2},
+};
+
+static void start_all(led_anim_t* a, uint32_t start)
+{
+    led_anim_init(a, s_defs, ARRAY_SIZE(s_defs), LEDS);
+    for (uint8_t i = 0; i < ARRAY_SIZE(s_defs); i++)
+    {
+        led_anim_start(a, i, start);
+    }
+    led_anim_set_value(a, 0, 153);  // 5 * 153 / 255 = 3 個
+    led_anim_set_value(a, 1, 4);
+}
+
+static bool same(const led_anim_rgb_t* a, const led_anim_rgb_t* b)
+{
+    return memcmp(a, b, LEDS * sizeof(a[0])) == 0;
+}
+
+// 描く間隔に関係なく、同じ時刻なら同じフレーム (フレーム数ではなく ms で進む)
+static void test_rate_independent(uint32_t start)
+{
+    led_anim_t fast;
+    led_anim_t slow;
+    led_anim_rgb_t f[LEDS];
+    led_anim_rgb_t s[LEDS];
+
+    start_all(&fast, start);
+    start_all(&slow, start);
+    for (uint32_t t = 0; t < 1200U; t++)
+    {
+        led_anim_render(&fast, start + t, f);
+        if ((t % 37U) == 0U)
+        {
+            led_anim_render(&slow, start + t, s);
+            CHECK(same(f, s));
+        }
+    }
+    for (uint8_t i = 0; i < ARRAY_SIZE(s_defs); i++)
+    {
+        CHECK_EQ(led_anim_is_active(&fast, i), led_anim_is_active(&slow, i));
+    }
+}
+
+static void test_frames(void)
+{
+    led_anim_t a;
+    led_anim_rgb_t f[LEDS];
+
+    start_all(&a, 1000);
+
+    // t = 0: メーター 3 個、パルスは 0、チェイスは 4 番目 (leds_rev の先頭) が 200、点滅は LED0 を上書き
+    led_anim_render(&a, 1000, f);
+    CHECK_EQ(f[0].r, 9);
+    CHECK_EQ(f[0].b, 9);
+    CHECK_EQ(f[1].r, 20);
+    CHECK_EQ(f[2].r, 30);
+    CHECK_EQ(f[3].r, 0);
+    CHECK_EQ(f[4].b, 200);
+
+    // t = 160: パルスの頂点 (LED4 に 151)。チェイスは 2 周目で LED3、フェードの途中
+    led_anim_render(&a, 1160, f);
+    CHECK_EQ(f[4].r, 151);
+    CHECK_EQ(f[4].b, 151);
+    CHECK_EQ(f[3].b, 81);  // フェードの 60% で 103、200 * 103 / 255
+    CHECK_EQ(f[0].r, 0);   // 点滅は消えている半周期。REPLACE なのでメーターも消す
+    led_anim_render(&a, 1200, f);
+    CHECK_EQ(f[0].r, 9);
+
+    // repeat 回で止まる: チェイスは 500ms、点滅は 400ms
+    led_anim_render(&a, 1399, f);
+    CHECK(led_anim_is_active(&a, 3));
+    led_anim_render(&a, 1400, f);
+    CHECK(!led_anim_is_active(&a, 3));
+    CHECK(led_anim_is_active(&a, 2));
+    CHECK_EQ(f[0].r, 10);
+    led_anim_render(&a, 1500, f);
+    CHECK(!led_anim_is_active(&a, 2));
+    CHECK(led_anim_is_active(&a, 1));  // repeat 0 は止めるまで
+}
+
+static void test_envelope(void)
+{
+    static const led_anim_layer_def_t def = {.fx = &led_anim_fx_pulse, .leds = s_leds, .color = {255, 0, 0}, .period_ms = 1000, .led_num = 1};
+    led_anim_t a;
+    led_anim_rgb_t f[LEDS];
+    uint8_t last = 0;
+
+    led_anim_init(&a, &def, 1, LEDS);
+    led_anim_start(&a, 0, 0);
+    for (uint32_t t = 0; t < 1000U; t++)
+    {
+        led_anim_render(&a, t, f);
+        CHECK((t <= 500U) ? (f[0].r >= last) : (f[0].r <= last));  // 三角波
+        last = f[0].r;
+    }
+    led_anim_render(&a, 500, f);
+    CHECK_EQ(f[0].r, 255);
+    led_anim_render(&a, 250, f);
+    CHECK(f[0].r >= 126 && f[0].r <= 128);
+
+    // 周期を変えても開始時刻はそのまま
+    led_anim_set_period(&a, 0, 2000);
+    led_anim_render(&a, 1000, f);
+    CHECK_EQ(f[0].r, 255);
+}
+
+static void test_blend(void)
+{
+    static const led_anim_rgb_t base = {100, 100, 100};
+    static const led_anim_layer_def_t defs[] = {
+        {.leds = s_leds, .color = base, .led_num = LEDS},
+        {.leds = &s_leds[0], .color = {200, 50, 0}, .led_num = 1, .blend = LED_ANIM_BLEND_MAX},
+        {.leds = &s_leds[1], .color = {200, 50, 0}, .led_num = 1, .blend = LED_ANIM_BLEND_ADD},
+        {.leds = &s_leds[2], .color = {200, 50, 0}, .led_num = 1, .blend = LED_ANIM_BLEND_MIX},
+        {.leds = &s_leds[3], .color = {200, 50, 0}, .led_num = 1, .blend = LED_ANIM_BLEND_REPLACE},
+    };
+    led_anim_t a;
+    led_anim_rgb_t f[LEDS];
+
+    led_anim_init(&a, defs, ARRAY_SIZE(defs), LEDS);
+    for (uint8_t i = 0; i < ARRAY_SIZE(defs); i++)
+    {
+        led_anim_start(&a, i, 0);
+    }
+    led_anim_render(&a, 0, f);
+    CHECK(f[0].r == 200 && f[0].g == 100 && f[0].b == 100);
+    CHECK(f[1].r == 255 && f[1].g == 150 && f[1].b == 100);
+    CHECK(f[2].r == 200 && f[2].g == 50 && f[2].b == 0);  // 明るさ 255 なら上の色そのまま
+    CHECK(f[3].r == 200 && f[3].g == 50 && f[3].b == 0);
+    CHECK(f[4].r == 100 && f[4].g == 100 && f[4].b == 100);
+
+    // 止めたレイヤーは描かない
+    led_anim_stop(&a, 4);
+    led_anim_render(&a, 0, f);
+    CHECK(f[3].r == 100 && f[3].g == 100);
+}
+
+int main(void)
+{
+    test_rate_independent(0);
+    test_rate_independent(0xFFFFFF00UL);  // tick の折り返しをまたぐ
+    test_frames();
+    test_envelope();
+    test_blend();
+    return test_done("led_anim");
+}
@@ -0,0 +1,327 @@
+/*
+ * test_mag_calib.c
+ *
+ *  Created on: Mar 23, 2026
+ */
+
+// 磁気クロスフェーダーのオフセットを adcTask と同じくブロック (500us = 2000/s) 単位で動かす
+// - 起動時の平均 (MAG_CALIBRATION_COUNT_MAX ブロック) と EEPROM の保存値
+// - ドリフト追従: 静止が 1s 続いたセンサーだけ、時定数 2^14 ブロックで追従し、保存値から ±48LSB で止まる
+//   1 ブロックずつでも、窓待ち中のまとめた更新でも同じ速さ
+// - ガイド付き: 1s の窓の間 max-min が 12LSB 以内なら平均を採用、動いたら窓をやり直し、10s でタイムアウト
+
+#include "mag_calib.h"
+
+#include "eeprom.h"
+
+#include "test.h"
+
+#define BLOCK_HZ    2000U
+#define DRIFT_T     16384U  // 2^MAG_DRIFT_SHIFT
+#define DRIFT_BAND  (MAG_XFADE_CUTOFF / 2)
+#define DRIFT_MAX   48
+#define STABLE_BAND 12
+
+static uint32_t s_wakeups;
+static EEPROM_MagCalib_t s_stored;
+static bool s_stored_valid;
+
+void mag_fader_wakeup(void)
+{
+    s_wakeups++;
+}
+
+int SEGGER_RTT_printf(unsigned buf, const char* fmt, ...)
+{
+    return 0;
+}
+
+HAL_StatusTypeDef EEPROM_SaveMagCalib(I2C_HandleTypeDef* hi2c, const EEPROM_MagCalib_t* cal)
+{
+    s_stored       = *cal;
+    s_stored_valid = true;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef EEPROM_LoadMagCalib(I2C_HandleTypeDef* hi2c, EEPROM_MagCalib_t* cal)
+{
+    if (!s_stored_valid)
+    {
+        return HAL_ERROR;
+    }
+    *cal = s_stored;
+    return HAL_OK;
+}
+
+static const uint16_t k_rest[MAG_SW_NUM] = {300, 310, 2048, 3700, 3710, 3720};
+
+static void fill(uint16_t v[MAG_SW_NUM], const uint16_t base[MAG_SW_NUM], int32_t d)
+{
+    for (uint32_t ch = 0; ch < MAG_SW_NUM; ch++)
+    {
+        v[ch] = (uint16_t) (base[ch] + d);
+    }
+}
+
+// n ブロック同じ値。途中でイベントが出たらそのブロック番号 (1 から) を返す
+static uint32_t feed(const uint16_t v[MAG_SW_NUM], uint32_t n, uint8_t* event)
+{
+    for (uint32_t i = 1; i <= n; i++)
+    {
+        const uint8_t e = mag_calib_update(v, 1U);
+        if (e != MAG_CALIB_EVENT_NONE)
+        {
+            *event = e;
+            return i;
+        }
+    }
+    *event = MAG_CALIB_EVENT_NONE;
+    return 0;
+}
+
+static int32_t drift(uint8_t ch)
+{
+    mag_calib_info_t info;
+    mag_calib_get_info(&info);
+    return info.drift[ch];
+}
+
+static void test_boot_and_stored(void)
+{
+    uint16_t v[MAG_SW_NUM];
+    uint8_t e;
+    I2C_HandleTypeDef hi2c = {0};
+
+    CHECK(!mag_calib_is_ready());
+    CHECK(!mag_calib_load(&hi2c));
+
+    // 起動時は MAG_CALIBRATION_COUNT_MAX ブロックの平均 (+-2 の揺れ)
+    for (uint32_t i = 0; i < MAG_CALIBRATION_COUNT_MAX; i++)
+    {
+        fill(v, k_rest, (i & 1U) ? 2 : -2);
+        e = mag_calib_update(v, 1U);
+        CHECK_EQ(e, (i + 1U == MAG_CALIBRATION_COUNT_MAX) ? MAG_CALIB_EVENT_READY : MAG_CALIB_EVENT_NONE);
+    }
+    CHECK(mag_calib_is_ready());
+    for (uint8_t ch = 0; ch < MAG_SW_NUM; ch++)
+    {
+        CHECK_EQ(mag_calib_offset(ch), k_rest[ch]);
+    }
+
+    // 保存値は次のブロックで入れ替わる (READY は最初の 1 回だけ)
+    fill(s_stored.rest, k_rest, 5);
+    s_stored_valid = true;
+    CHECK(mag_calib_load(&hi2c));
+    CHECK_EQ(mag_calib_offset(0), k_rest[0]);
+    CHECK_EQ(feed(v, 1U, &e), 0);
+    CHECK_EQ(mag_calib_offset(0), k_rest[0] + 5);
+
+    mag_calib_info_t info;
+    mag_calib_get_info(&info);
+    CHECK_EQ(info.source, MAG_CALIB_SRC_EEPROM);
+    CHECK_EQ(info.rest[3], k_rest[3] + 5);
+    CHECK_EQ(info.idle_mask, 0);
+    CHECK_EQ(mag_calib_offset(MAG_SW_NUM), 0);
+
+    // 以降は k_rest を保存値として使う
+    mag_calib_set_stored(k_rest);
+    CHECK_EQ(feed(k_rest, 1U, &e), 0);
+}
+
+static void test_drift_time_constant(void)
+{
+    uint16_t v[MAG_SW_NUM];
+    uint8_t e;
+
+    // 静止が 1s (2000 ブロック) 続くまでは追従しない
+    fill(v, k_rest, DRIFT_BAND);
+    CHECK_EQ(feed(v, BLOCK_HZ, &e), 0);
+    CHECK_EQ(drift(0), 0);
+    mag_calib_info_t info;
+    mag_calib_get_info(&info);
+    CHECK_EQ(info.idle_mask, (1U << MAG_SW_NUM) - 1U);
+
+    // 差 8LSB への一次遅れ: T/2 で 8(1-e^-0.5) = 3.1、T で 5.1、2T で 6.9
+    (void) feed(v, DRIFT_T / 2U, &e);
+    CHECK_EQ(drift(0), 3);
+    (void) feed(v, DRIFT_T / 2U, &e);
+    CHECK_EQ(drift(0), 5);
+    (void) feed(v, DRIFT_T, &e);
+    CHECK_EQ(drift(0), 7);
+    for (uint8_t ch = 1; ch < MAG_SW_NUM; ch++)
+    {
+        CHECK_EQ(drift(ch), 7);
+    }
+
+    // 下向きも同じ速さ
+    mag_calib_set_stored(k_rest);
+    fill(v, k_rest, -DRIFT_BAND);
+    (void) feed(v, BLOCK_HZ + DRIFT_T, &e);
+    CHECK_EQ(drift(2), -5);
+
+    // まとめた更新 (256 ブロックずつ) でも同じ: T で 5
+    mag_calib_set_stored(k_rest);
+    fill(v, k_rest, DRIFT_BAND);
+    (void) mag_calib_update(v, BLOCK_HZ);
+    CHECK_EQ(drift(4), 0);
+    for (uint32_t i = 0; i < DRIFT_T / 256U; i++)
+    {
+        (void) mag_calib_update(v, 256U);
+    }
+    CHECK_EQ(drift(4), 5);
+    (void) mag_calib_update(v, 100000U);  // 一度に進めるのは 256 ブロックまで
+    CHECK(drift(4) <= 6);
+
+    // 帯を出たセンサーは追従をやめて数え直す
+    v[1] = (uint16_t) (mag_calib_offset(1) + DRIFT_BAND + 1);
+    (void) mag_calib_update(v, 1U);
+    mag_calib_get_info(&info);
+    CHECK_EQ(info.idle_mask & 0x02U, 0);
+    CHECK_EQ(info.idle_mask & 0x01U, 0x01U);
+    const int32_t before = drift(1);
+    (void) feed(v, 1000U, &e);
+    CHECK_EQ(drift(1), before);
+}
+
+// ゆっくり動き続けても保存値から ±48LSB で止まる
+static void test_drift_clamp(void)
+{
+    uint16_t v[MAG_SW_NUM];
+    uint8_t e;
+
+    for (int32_t dir = -1; dir <= 1; dir += 2)
+    {
+        mag_calib_set_stored(k_rest);
+        fill(v, k_rest, 0);
+        (void) feed(v, BLOCK_HZ + 1U, &e);
+        for (uint32_t i = 0; i < 2000U; i++)
+        {
+            for (uint8_t ch = 0; ch < MAG_SW_NUM; ch++)
+            {
+                v[ch] = (uint16_t) (mag_calib_offset(ch) + dir * (DRIFT_BAND - 1));  // 丸めた分を引いても帯の内側
+            }
+            (void) mag_calib_update(v, 256U);
+        }
+        for (uint8_t ch = 0; ch < MAG_SW_NUM; ch++)
+        {
+            CHECK_EQ(drift(ch), dir * DRIFT_MAX);
+        }
+    }
+    mag_calib_set_stored(k_rest);
+    (void) feed(k_rest, 1U, &e);
+}
+
+static void test_guided(void)
+{
+    uint16_t v[MAG_SW_NUM];
+    uint8_t e;
+    I2C_HandleTypeDef hi2c = {0};
+
+    // 窓待ちから起こして始める。実行中は二重に始めない
+    const uint32_t wakeups = s_wakeups;
+    CHECK(mag_calib_start_guided());
+    CHECK_EQ(s_wakeups, wakeups + 1U);
+    CHECK(!mag_calib_start_guided());
+    CHECK(mag_calib_is_guided());
+
+    // max-min がちょうど 12 の揺れなら 1s (2000 ブロック) 目で採用。平均は四捨五入
+    uint32_t i;
+    for (i = 1; i <= BLOCK_HZ; i++)
+    {
+        fill(v, k_rest, (i % 3U == 0U) ? STABLE_BAND - 5 : -5);
+        e = mag_calib_update(v, 1U);
+        if (e != MAG_CALIB_EVENT_NONE)
+        {
+            break;
+        }
+    }
+    CHECK_EQ(i, BLOCK_HZ);
+    CHECK_EQ(e, MAG_CALIB_EVENT_GUIDED_DONE);
+    CHECK(!mag_calib_is_guided());
+    mag_calib_info_t info;
+    mag_calib_get_info(&info);
+    CHECK_EQ(info.source, MAG_CALIB_SRC_GUIDED);
+    // (666 * 7 + 1334 * -5) / 2000 = -1.003 → -1
+    CHECK_EQ(info.rest[0], k_rest[0] - 1);
+    CHECK_EQ(mag_calib_offset(5), k_rest[5] - 1);
+
+    // 採用した値を保存する
+    CHECK(mag_calib_save(&hi2c) == HAL_OK);
+    CHECK_EQ(s_stored.rest[2], k_rest[2] - 1);
+
+    // 動いている間は窓をやり直す: 500 ブロック動かしてから止めると、止めた最初のブロック
+    // (動いていた窓と一緒に捨てる) の次から 2000 ブロックで採用
+    CHECK(mag_calib_start_guided());
+    mag_calib_set_stored(k_rest);  // 実行中に読んだ保存値は使わない
+    for (i = 0; i < 500U; i++)
+    {
+        fill(v, k_rest, (int32_t) (i % 40U) * 10);
+        CHECK_EQ(mag_calib_update(v, 1U), MAG_CALIB_EVENT_NONE);
+    }
+    fill(v, k_rest, 20);
+    CHECK_EQ(feed(v, BLOCK_HZ + 1U, &e), BLOCK_HZ + 1U);
+    CHECK_EQ(e, MAG_CALIB_EVENT_GUIDED_DONE);
+    CHECK_EQ(mag_calib_offset(0), k_rest[0] + 20);
+    mag_calib_get_info(&info);
+    CHECK_EQ(info.source, MAG_CALIB_SRC_GUIDED);
+}
+
+static void test_guided_reject(void)
+{
+    uint16_t v[MAG_SW_NUM];
+    uint8_t e;
+
+    // 13LSB の揺れは採用しない。10s (20000 ブロック) でタイムアウトして前の値のまま
+    const uint16_t before = mag_calib_offset(3);
+    CHECK(mag_calib_start_guided());
+    uint32_t i;
+    for (i = 1; i <= 30000U; i++)
+    {
+        fill(v, k_rest, (i & 1U) ? STABLE_BAND + 1 : 0);
+        e = mag_calib_update(v, 1U);
+        if (e != MAG_CALIB_EVENT_NONE)
+        {
+            break;
+        }
+    }
+    CHECK_EQ(i, 10U * BLOCK_HZ);
+    CHECK_EQ(e, MAG_CALIB_EVENT_GUIDED_FAILED);
+    CHECK(!mag_calib_is_guided());
+    CHECK_EQ(mag_calib_offset(3), before);
+
+    // 窓が揃う前にタイムアウトが来たら失敗 (18500 ブロック動いて、静止は 1500 ブロックだけ)
+    CHECK(mag_calib_start_guided());
+    for (i = 0; i < 18500U; i++)
+    {
+        fill(v, k_rest, (int32_t) (i % 40U) * 10);
+        CHECK_EQ(mag_calib_update(v, 1U), MAG_CALIB_EVENT_NONE);
+    }
+    fill(v, k_rest, 0);
+    CHECK_EQ(feed(v, BLOCK_HZ, &e), 1500U);
+    CHECK_EQ(e, MAG_CALIB_EVENT_GUIDED_FAILED);
+    CHECK_EQ(mag_calib_offset(3), before);
+
+    // 1 センサーだけ揺れても採用しない
+    CHECK(mag_calib_start_guided());
+    for (i = 1; i <= 10U * BLOCK_HZ; i++)
+    {
+        fill(v, k_rest, 0);
+        v[5] = (uint16_t) (k_rest[5] + ((i % 100U == 0U) ? 13 : 0));
+        e    = mag_calib_update(v, 1U);
+        if (e != MAG_CALIB_EVENT_NONE)
+        {
+            break;
+        }
+    }
+    CHECK_EQ(e, MAG_CALIB_EVENT_GUIDED_FAILED);
+}
+
+int main(void)
+{
+    test_boot_and_stored();
+    test_drift_time_constant();
+    test_drift_clamp();
+    test_guided();
+    test_guided_reject();
+    return test_done("mag_calib");
+}
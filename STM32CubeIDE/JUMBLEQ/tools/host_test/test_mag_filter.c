@@ -0,0 +1,243 @@
+/*
+ * test_mag_filter.c
+ *
+ *  Created on: Mar 23, 2026
+ */
+
+// 磁気クロスフェーダーのブロック平均 + IIR にステップとノイズを流す (1 ブロック = 500us)
+// - MAG_FILTER_FAST_DELTA 未満のステップは 1/8 の IIR: 時定数 (63%) は約 8 ブロック、行き過ぎずに目標で止まる
+//   上下どちらも 16ms 以内に目標に入る
+// - MAG_FILTER_FAST_DELTA 以上のステップは次のブロックでそのまま出る (カットの遅れ無し)
+// - 4 スキャンの平均は 1/16 LSB で持ち、出力は丸める
+// - 静止時のスキャン毎のノイズを落とす
+
+#include "mag_filter.h"
+
+#include "test.h"
+
+#include <stdlib.h>
+
+#define BLOCK_US  500U
+#define NOISE_LSB 6  // スキャン毎の振れ (+-)
+
+static uint32_t s_rng;
+
+static int noise(void)
+{
+    s_rng = s_rng * 1103515245U + 12345U;
+    return (int) ((s_rng >> 16) % (2U * NOISE_LSB + 1U)) - NOISE_LSB;
+}
+
+// 全センサーに同じ値を 4 スキャン分流す (ch 毎に +ch ずらす)
+static void run_block(mag_filter_t* f, const int scan[MAG_FILTER_SCANS], uint16_t out[MAG_FILTER_CH_NUM])
+{
+    uint32_t buf[MAG_FILTER_SCANS][MAG_FILTER_CH_NUM];
+    int32_t x[MAG_FILTER_CH_NUM];
+
+    for (uint32_t s = 0; s < MAG_FILTER_SCANS; s++)
+    {
+        for (uint32_t ch = 0; ch < MAG_FILTER_CH_NUM; ch++)
+        {
+            buf[s][ch] = (uint32_t) (scan[s] + (int) ch);
+        }
+    }
+    mag_filter_average(&buf[0][0], x);
+    mag_filter_update(f, x, out);
+}
+
+static uint16_t run_level(mag_filter_t* f, int level)
+{
+    const int scan[MAG_FILTER_SCANS] = {level, level, level, level};
+    uint16_t out[MAG_FILTER_CH_NUM];
+
+    run_block(f, scan, out);
+    for (uint32_t ch = 1; ch < MAG_FILTER_CH_NUM; ch++)
+    {
+        CHECK_EQ(out[ch], out[0] + ch);  // センサー毎に独立
+    }
+    return out[0];
+}
+
+static void test_average(void)
+{
+    mag_filter_t f;
+    int32_t x[MAG_FILTER_CH_NUM];
+    uint16_t out[MAG_FILTER_CH_NUM];
+    uint32_t buf[MAG_FILTER_SCANS][MAG_FILTER_CH_NUM];
+
+    // 1/16 LSB で持つ: 100, 100, 101, 101 → 100.5 → 出力は 101 に丸める
+    for (uint32_t ch = 0; ch < MAG_FILTER_CH_NUM; ch++)
+    {
+        buf[0][ch] = 100U;
+        buf[1][ch] = 100U;
+        buf[2][ch] = 101U;
+        buf[3][ch] = 101U + ch * 4U;
+    }
+    mag_filter_average(&buf[0][0], x);
+    CHECK_EQ(x[0], 1608);
+    CHECK_EQ(x[5], 1608 + 5 * 16);
+    CHECK_EQ(mag_filter_raw(x[0]), 100);
+    mag_filter_reset(&f);
+    mag_filter_update(&f, x, out);
+    CHECK_EQ(out[0], 101);
+    CHECK_EQ(out[5], 106);
+
+    // 12bit の端
+    for (uint32_t s = 0; s < MAG_FILTER_SCANS; s++)
+    {
+        for (uint32_t ch = 0; ch < MAG_FILTER_CH_NUM; ch++)
+        {
+            buf[s][ch] = 4095U;
+        }
+    }
+    mag_filter_average(&buf[0][0], x);
+    mag_filter_update(&f, x, out);
+    CHECK_EQ(out[0], 4095);
+
+    // 最初のブロックはそのまま取り、reset すると取り直す
+    mag_filter_reset(&f);
+    CHECK_EQ(run_level(&f, 2000), 2000);
+    CHECK_EQ(run_level(&f, 2010), 2001);  // 2 ブロック目からは IIR
+    mag_filter_reset(&f);
+    CHECK_EQ(run_level(&f, 2010), 2010);
+}
+
+// from で落ち着いた後に from + step へ跳ばして、出力の動きを見る
+typedef struct
+{
+    uint32_t tau;     // 63% を超えたブロック
+    uint32_t settle;  // 目標に入ったブロック (その後は出ない)
+    bool overshoot;
+} step_t;
+
+static step_t step_response(int from, int step)
+{
+    mag_filter_t f;
+    step_t r        = {0, 0, false};
+    const int to    = from + step;
+    const int thres = abs(step) * 63;
+
+    mag_filter_reset(&f);
+    CHECK_EQ(run_level(&f, from), from);
+    for (uint32_t i = 1; i <= 200U; i++)
+    {
+        const int y = run_level(&f, to);
+        const int moved = (y - from) * ((step > 0) ? 1 : -1);
+
+        if ((r.tau == 0U) && ((moved * 100) >= thres))
+        {
+            r.tau = i;
+        }
+        if (moved > abs(step))
+        {
+            r.overshoot = true;
+        }
+        if (y != to)
+        {
+            r.settle = 0U;
+        }
+        else if (r.settle == 0U)
+        {
+            r.settle = i;
+        }
+    }
+    return r;
+}
+
+static void test_step(void)
+{
+    static const int steps[] = {1, 2, 4, 8, 16, MAG_FILTER_FAST_DELTA - 1};
+
+    for (uint32_t k = 0; k < ARRAY_SIZE(steps); k++)
+    {
+        const step_t up   = step_response(1000, steps[k]);
+        const step_t down = step_response(1000, -steps[k]);
+
+        printf("  step %2d: tau %u/%u blocks, settle %u/%u blocks (up/down)\n", steps[k], up.tau, down.tau, up.settle, down.settle);
+        CHECK(!up.overshoot);
+        CHECK(!down.overshoot);
+        CHECK(up.settle != 0U);
+        CHECK(down.settle != 0U);
+        // 1/8 の IIR: 誤差は 1 ブロック毎に 7/8、63% まで約 8 ブロック (4ms)
+        if (steps[k] >= 4)
+        {
+            CHECK(up.tau >= 6U && up.tau <= 9U);
+            CHECK(down.tau >= 6U && down.tau <= 9U);
+        }
+        // 誤差が 0.5 LSB を切るまで: ln(2 * step) / ln(8/7) ブロック (23 LSB で 29) + 丸め
+        CHECK(up.settle * BLOCK_US <= 16000U);
+        CHECK(down.settle * BLOCK_US <= 16000U);
+        // 上下で同じ (IIR の 1 ステップを切り捨てると上向きだけ遅れる)
+        CHECK(abs((int) up.settle - (int) down.settle) <= 2);
+    }
+
+    // MAG_FILTER_FAST_DELTA 以上は次のブロックで出る
+    for (int step = MAG_FILTER_FAST_DELTA; step <= 2000; step *= 3)
+    {
+        mag_filter_t f;
+        mag_filter_reset(&f);
+        (void) run_level(&f, 1000);
+        CHECK_EQ(run_level(&f, 1000 + step), 1000 + step);
+        (void) run_level(&f, 1000);
+        CHECK_EQ(run_level(&f, 1000), 1000);  // 戻りも同じ
+    }
+
+    // ゆっくり動かすと 1 ブロックあたりの差は小さいまま: 遅れは IIR の時定数分で頭打ち
+    {
+        mag_filter_t f;
+        int lag_max = 0;
+        mag_filter_reset(&f);
+        (void) run_level(&f, 1000);
+        for (int i = 1; i <= 400; i++)
+        {
+            const int lag = (1000 + i) - run_level(&f, 1000 + i);  // 1 LSB/ブロック = 2 LSB/ms
+            if (lag > lag_max)
+            {
+                lag_max = lag;
+            }
+        }
+        printf("  ramp 1 LSB/block: lag %d LSB\n", lag_max);
+        CHECK(lag_max <= 8);
+    }
+}
+
+// スキャン毎に +-NOISE_LSB 振れる静止入力: 出力の振れ幅
+static void test_noise(void)
+{
+    mag_filter_t f;
+    int lo   = 4096;
+    int hi   = -1;
+    int r_lo = 4096;
+    int r_hi = -1;
+
+    s_rng = 1U;
+    mag_filter_reset(&f);
+    for (uint32_t i = 0; i < 4000U; i++)  // 2 秒
+    {
+        int scan[MAG_FILTER_SCANS];
+        for (uint32_t s = 0; s < MAG_FILTER_SCANS; s++)
+        {
+            scan[s] = 2000 + noise();
+            r_lo    = (scan[s] < r_lo) ? scan[s] : r_lo;
+            r_hi    = (scan[s] > r_hi) ? scan[s] : r_hi;
+        }
+        uint16_t out[MAG_FILTER_CH_NUM];
+        run_block(&f, scan, out);
+        if (i >= 40U)  // 落ち着いてから
+        {
+            lo = (out[0] < lo) ? out[0] : lo;
+            hi = (out[0] > hi) ? out[0] : hi;
+        }
+    }
+    printf("  noise: scan %d LSB p-p -> out %d LSB p-p\n", r_hi - r_lo, hi - lo);
+    CHECK_EQ(r_hi - r_lo, 2 * NOISE_LSB);
+    CHECK(lo >= 2000 - 2 && hi <= 2000 + 2);
+}
+
+int main(void)
+{
+    test_average();
+    test_step();
+    test_noise();
+    return test_done("mag_filter");
+}
@@ -0,0 +1,203 @@
+/*
+ * test_mag_idle.c
+ *
+ *  Created on: Mar 23, 2026
+ */
+
+// 磁気クロスフェーダーの静止判定と起床窓
+// - 窓はセンサー毎 (止まっているフェーダーの位置で広がらない)、端で 0..4095 に丸める
+// - 静止判定は MAG_IDLE_BLOCKS ブロックで成立し、MAG_IDLE_BAND を超えたら基準を取り直す
+// - adcTask と同じ流れ (ブロック → 待ち → 窓 / タイムアウトで起床) を回して、速いカットもゆっくりした動きも拾う
+
+#include "mag_idle.h"
+
+#include "test.h"
+
+// フェーダー B (センサー 0,1) は端に止めて、フェーダー A (3..5) は反対の端
+static const uint16_t k_parked[MAG_IDLE_CH_NUM] = {200, 260, 2048, 3000, 3900, 3950};
+
+static void test_window(void)
+{
+    mag_idle_window_t w;
+    uint16_t v[MAG_IDLE_CH_NUM];
+
+    mag_idle_window_set(&w, k_parked);
+    for (uint32_t ch = 0; ch < MAG_IDLE_CH_NUM; ch++)
+    {
+        CHECK_EQ(w.lo[ch], k_parked[ch] - MAG_IDLE_WAKE_BAND);
+        CHECK_EQ(w.hi[ch], k_parked[ch] + MAG_IDLE_WAKE_BAND);
+    }
+    CHECK(!mag_idle_window_outside(&w, k_parked));
+
+    // どのセンサーも、自分の値から MAG_IDLE_WAKE_BAND を超えたら出る
+    for (uint32_t ch = 0; ch < MAG_IDLE_CH_NUM; ch++)
+    {
+        memcpy(v, k_parked, sizeof(v));
+        v[ch] = (uint16_t) (k_parked[ch] + MAG_IDLE_WAKE_BAND);
+        CHECK(!mag_idle_window_outside(&w, v));
+        v[ch] = (uint16_t) (k_parked[ch] + MAG_IDLE_WAKE_BAND + 1);
+        CHECK(mag_idle_window_outside(&w, v));
+        v[ch] = (uint16_t) (k_parked[ch] - MAG_IDLE_WAKE_BAND - 1);
+        CHECK(mag_idle_window_outside(&w, v));
+    }
+
+    // センサー 0 が 200 → 1500 (前の AWD2 の窓 = センサー 0..2 の min..max ± 32 の内側) でも出る
+    memcpy(v, k_parked, sizeof(v));
+    v[0] = 1500;
+    CHECK(mag_idle_window_outside(&w, v));
+
+    // 端では丸める
+    const uint16_t edge[MAG_IDLE_CH_NUM] = {0, 10, 32, 4063, 4090, 4095};
+    mag_idle_window_set(&w, edge);
+    CHECK_EQ(w.lo[0], 0);
+    CHECK_EQ(w.lo[1], 0);
+    CHECK_EQ(w.lo[2], 0);
+    CHECK_EQ(w.hi[3], 4095);
+    CHECK_EQ(w.hi[4], 4095);
+    CHECK_EQ(w.hi[5], 4095);
+    CHECK_EQ(w.lo[5], 4095 - MAG_IDLE_WAKE_BAND);
+    CHECK(!mag_idle_window_outside(&w, edge));
+}
+
+static void test_still(void)
+{
+    mag_idle_t m;
+    uint16_t v[MAG_IDLE_CH_NUM];
+
+    mag_idle_reset(&m);
+    CHECK(!mag_idle_update(&m, k_parked, 1U));  // 基準 (0) から動いたので取り直す
+    CHECK(memcmp(m.ref, k_parked, sizeof(m.ref)) == 0);
+    CHECK_EQ(m.still, 0);
+
+    for (uint32_t i = 1; i < MAG_IDLE_BLOCKS; i++)
+    {
+        CHECK(!mag_idle_update(&m, k_parked, 1U));
+    }
+    CHECK(mag_idle_update(&m, k_parked, 1U));
+    CHECK(mag_idle_update(&m, k_parked, 1U));  // 待ちに入るまでは成立のまま
+
+    // MAG_IDLE_BAND 以内の揺れは静止のまま。超えたら基準を取り直して数え直す
+    m.still = 0;
+    memcpy(v, k_parked, sizeof(v));
+    v[4] = (uint16_t) (k_parked[4] + MAG_IDLE_BAND);
+    CHECK(!mag_idle_moved(&m, v));
+    CHECK(!mag_idle_update(&m, v, 1U));
+    CHECK_EQ(m.still, 1);
+    v[4] = (uint16_t) (k_parked[4] - MAG_IDLE_BAND - 1);
+    CHECK(mag_idle_moved(&m, v));
+    CHECK(!mag_idle_update(&m, v, 1U));
+    CHECK_EQ(m.still, 0);
+    CHECK_EQ(m.ref[4], v[4]);
+
+    // まとめた更新 (タイムアウトの読み出し) はブロック数で数える
+    CHECK(!mag_idle_update(&m, v, MAG_IDLE_BLOCKS - 1U));
+    CHECK(mag_idle_update(&m, v, 1U));
+}
+
+// ui_control / mag_fader と同じ流れ
+typedef struct
+{
+    mag_idle_t still;
+    mag_idle_window_t win;
+    bool idle;
+    uint32_t arms;
+    uint32_t win_wakes;
+    uint32_t tmo_wakes;
+} sim_t;
+
+// ADC2 のブロック 1 つ (500us)
+static void sim_block(sim_t* s, const uint16_t v[MAG_IDLE_CH_NUM])
+{
+    if (s->idle)
+    {
+        if (!mag_idle_window_outside(&s->win, v))
+        {
+            return;
+        }
+        s->idle = false;
+        s->win_wakes++;
+    }
+    if (mag_idle_update(&s->still, v, 1U))
+    {
+        s->still.still = 0;
+        mag_idle_window_set(&s->win, v);
+        s->idle = true;
+        s->arms++;
+    }
+}
+
+// adcTask のタイムアウト (50ms = 100 ブロック)
+static void sim_timeout(sim_t* s, const uint16_t v[MAG_IDLE_CH_NUM])
+{
+    if (s->idle && mag_idle_moved(&s->still, v))
+    {
+        s->idle = false;
+        s->tmo_wakes++;
+    }
+}
+
+static void test_idle_wake(void)
+{
+    sim_t s = {0};
+    uint16_t v[MAG_IDLE_CH_NUM];
+
+    memcpy(v, k_parked, sizeof(v));
+    mag_idle_reset(&s.still);
+    for (uint32_t i = 0; i <= MAG_IDLE_BLOCKS; i++)
+    {
+        sim_block(&s, v);
+    }
+    CHECK(s.idle);
+    CHECK_EQ(s.arms, 1);
+
+    // 窓の内側のノイズでは起きない
+    for (uint32_t i = 0; i < 1000U; i++)
+    {
+        v[i % MAG_IDLE_CH_NUM] = (uint16_t) (k_parked[i % MAG_IDLE_CH_NUM] + ((i & 1U) ? 5 : -5));
+        sim_block(&s, v);
+        if ((i % 100U) == 99U)
+        {
+            sim_timeout(&s, v);
+        }
+    }
+    CHECK(s.idle);
+    CHECK_EQ(s.win_wakes + s.tmo_wakes, 0);
+
+    // フェーダー B の速いカット: 次のブロックで起きて、待ちに戻るのは止まってから MAG_IDLE_BLOCKS 後
+    memcpy(v, k_parked, sizeof(v));
+    v[0] = 1500;
+    v[1] = 1400;
+    sim_block(&s, v);
+    CHECK(!s.idle);
+    CHECK_EQ(s.win_wakes, 1);
+    for (uint32_t i = 0; i < MAG_IDLE_BLOCKS; i++)
+    {
+        sim_block(&s, v);
+    }
+    CHECK(s.idle);
+    CHECK_EQ(s.arms, 2);
+
+    // 窓の内側をゆっくり動いた (1 LSB / 50ms) のはタイムアウトで見つける
+    uint32_t n = 0;
+    while (s.idle && (n < MAG_IDLE_WAKE_BAND))
+    {
+        v[3]++;
+        n++;
+        for (uint32_t i = 0; i < 100U; i++)
+        {
+            sim_block(&s, v);
+        }
+        sim_timeout(&s, v);
+    }
+    CHECK(!s.idle);
+    CHECK_EQ(s.tmo_wakes, 1);
+    CHECK_EQ(n, MAG_IDLE_BAND + 1);
+}
+
+int main(void)
+{
+    test_window();
+    test_still();
+    test_idle_wake();
+    return test_done("mag_idle");
+}
@@ -0,0 +1,342 @@
+/*
+ * test_midi_map.c
+ *
+ *  Created on: Mar 23, 2026
+ */
+
+// 割り当て表をホストで動かす。USB に書いたバイト列と DSP への書き込みを取って
+// - 変換 (カーブ → 反転 → [min, max]) と CC/NRPN/ノート/DSP の送り方
+// - 同じ値は送らない (invalidate / set_entry の後は送り直す)
+// - 逆引き (二分探索) が全部の出力値で「その値以上になる最小の位置」を返す
+// - MIDI-learn の選択・割り当て・期限切れ・取り消し
+// - EEPROM の保存/読み込みと、不正な記録なら初期値に戻すこと
+// を確かめる
+
+#include "midi_map.h"
+
+#include "eeprom.h"
+#include "xfade_curve.h"
+
+#include "test.h"
+
+#define FULL 4095U
+
+static uint32_t s_now;
+static uint8_t s_out[256];
+static uint32_t s_out_len;
+static int32_t s_dsp[MIDI_MAP_DSP_NUM];
+static EEPROM_MidiMap_t s_rec;
+static bool s_rec_valid;
+
+uint32_t HAL_GetTick(void)
+{
+    return s_now;
+}
+
+int SEGGER_RTT_printf(unsigned buf, const char* fmt, ...)
+{
+    return 0;
+}
+
+uint32_t tud_midi_stream_write(uint8_t cable_num, const uint8_t* buffer, uint32_t bufsize)
+{
+    if ((s_out_len + bufsize) <= sizeof(s_out))
+    {
+        memcpy(&s_out[s_out_len], buffer, bufsize);
+        s_out_len += bufsize;
+    }
+    return bufsize;
+}
+
+void led_notify_midi_activity(void)
+{
+}
+
+void ui_control_set_dsp_param(uint8_t param, uint16_t value)
+{
+    s_dsp[param] = value;
+}
+
+HAL_StatusTypeDef EEPROM_SaveMidiMap(I2C_HandleTypeDef* hi2c, const EEPROM_MidiMap_t* map)
+{
+    s_rec       = *map;
+    s_rec_valid = true;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef EEPROM_LoadMidiMap(I2C_HandleTypeDef* hi2c, EEPROM_MidiMap_t* map)
+{
+    if (!s_rec_valid)
+    {
+        return HAL_ERROR;
+    }
+    *map = s_rec;
+    return HAL_OK;
+}
+
+static void clear_out(void)
+{
+    s_out_len = 0;
+    for (uint32_t i = 0; i < MIDI_MAP_DSP_NUM; i++)
+    {
+        s_dsp[i] = -1;
+    }
+}
+
+static bool out_is(const uint8_t* want, uint32_t len)
+{
+    return (s_out_len == len) && (memcmp(s_out, want, len) == 0);
+}
+
+// 送り直させてから値を出す。CC なら最後のバイト、NRPN なら最後の 2 つの CC (6/38) を繋いだ値
+static uint32_t output_of(uint8_t src, uint32_t value)
+{
+    midi_map_entry_t e;
+
+    (void) midi_map_get_entry(src, &e);
+    midi_map_invalidate(src);
+    clear_out();
+    midi_map_emit(src, value, FULL);
+    if (e.type == MIDI_MAP_TYPE_NRPN)
+    {
+        return ((uint32_t) s_out[8] << 7) | s_out[11];
+    }
+    return s_out[s_out_len - 1U];
+}
+
+static void set(uint8_t src, uint8_t type, uint8_t ch, uint8_t curve, uint8_t flags, uint16_t number, uint16_t min, uint16_t max)
+{
+    const midi_map_entry_t e = {.type = type, .channel = ch, .curve = curve, .flags = flags, .number = number, .min = min, .max = max};
+    CHECK(midi_map_set_entry(src, &e));
+}
+
+static void test_apply(void)
+{
+    midi_map_set_defaults();
+
+    // ポット 0 = CC0、磁気フェーダー 0 = CC15 反転
+    clear_out();
+    midi_map_emit(MIDI_MAP_SRC_POT0, FULL, FULL);
+    CHECK(out_is((const uint8_t[]) {0xB0, 0x00, 0x7F}, 3U));
+    clear_out();
+    midi_map_emit(MIDI_MAP_SRC_POT0, 0, FULL);
+    CHECK(out_is((const uint8_t[]) {0xB0, 0x00, 0x00}, 3U));
+    clear_out();
+    midi_map_emit(MIDI_MAP_SRC_MAG0, 0, 1408U);
+    CHECK(out_is((const uint8_t[]) {0xB0, 0x0F, 0x7F}, 3U));
+
+    // ポット 4 = DSP (CH2 ゲイン、10bit)
+    clear_out();
+    midi_map_emit(MIDI_MAP_SRC_POT0 + 4U, FULL, FULL);
+    CHECK_EQ(s_dsp[MIDI_MAP_DSP_CH2_GAIN], 1023);
+    CHECK_EQ(s_out_len, 0);
+
+    // [min, max] と丸め
+    set(1U, MIDI_MAP_TYPE_CC, 3U, XFADE_CURVE_LINEAR, 0U, 20U, 10U, 20U);
+    CHECK_EQ(output_of(1U, 0), 10);
+    CHECK_EQ(output_of(1U, FULL / 2U), 15);
+    CHECK_EQ(output_of(1U, FULL), 20);
+    CHECK_EQ(s_out[0], 0xB3);
+    CHECK_EQ(output_of(1U, FULL * 2U), 20);  // フルスケールを超えたら端
+
+    // NRPN: CC99/98 で番号、CC6/38 で値
+    set(2U, MIDI_MAP_TYPE_NRPN, 1U, XFADE_CURVE_LINEAR, 0U, 300U, 0U, 16383U);
+    CHECK_EQ(output_of(2U, FULL), 16383);
+    CHECK(out_is((const uint8_t[]) {0xB1, 99, 300U >> 7, 0xB1, 98, 300U & 0x7FU, 0xB1, 6, 0x7F, 0xB1, 38, 0x7F}, 12U));
+
+    // ノートは範囲の半分を超えたらオン (velocity = max)、下回ったらオフ。変わった時だけ送る
+    set(3U, MIDI_MAP_TYPE_NOTE, 2U, XFADE_CURVE_LINEAR, 0U, 60U, 0U, 100U);
+    clear_out();
+    midi_map_emit(3U, FULL, FULL);
+    CHECK(out_is((const uint8_t[]) {0x92, 60, 100}, 3U));
+    clear_out();
+    midi_map_emit(3U, FULL * 3U / 4U, FULL);
+    CHECK_EQ(s_out_len, 0);
+    midi_map_emit(3U, FULL / 4U, FULL);
+    CHECK(out_is((const uint8_t[]) {0x82, 60, 0}, 3U));
+
+    // 不正な割り当ては受けない
+    const midi_map_entry_t bad[] = {
+        {.type = MIDI_MAP_TYPE_NUM, .max = 1U},
+        {.type = MIDI_MAP_TYPE_CC, .channel = 16U, .max = 127U},
+        {.type = MIDI_MAP_TYPE_CC, .number = 128U, .max = 127U},
+        {.type = MIDI_MAP_TYPE_CC, .max = 128U},
+        {.type = MIDI_MAP_TYPE_DSP, .number = MIDI_MAP_DSP_NUM, .max = 1023U},
+        {.type = MIDI_MAP_TYPE_CC, .curve = XFADE_CURVE_NUM, .max = 127U},
+        {.type = MIDI_MAP_TYPE_CC, .flags = 0x08U, .max = 127U},
+    };
+    for (uint32_t i = 0; i < ARRAY_SIZE(bad); i++)
+    {
+        CHECK(!midi_map_set_entry(5U, &bad[i]));
+    }
+    CHECK(!midi_map_set_entry(MIDI_MAP_SRC_NUM, &bad[0]));
+}
+
+// 同じ値は送らない。invalidate と割り当ての変更の後は送り直す。同じ CC に 2 つ割り当てたらどちらも送る
+static void test_duplicates(void)
+{
+    midi_map_set_defaults();
+    const uint32_t gen = midi_map_generation();
+
+    clear_out();
+    midi_map_emit(MIDI_MAP_SRC_POT0, 2000U, FULL);
+    CHECK_EQ(s_out_len, 3);
+    clear_out();
+    midi_map_emit(MIDI_MAP_SRC_POT0, 2000U, FULL);
+    midi_map_emit(MIDI_MAP_SRC_POT0, 2001U, FULL);  // 量子化すると同じ
+    CHECK_EQ(s_out_len, 0);
+
+    midi_map_invalidate(MIDI_MAP_SRC_POT0);
+    midi_map_emit(MIDI_MAP_SRC_POT0, 2000U, FULL);
+    CHECK_EQ(s_out_len, 3);
+
+    set(1U, MIDI_MAP_TYPE_CC, 0U, XFADE_CURVE_LINEAR, 0U, 0U, 0U, 127U);
+    CHECK(midi_map_generation() != gen);
+    clear_out();
+    midi_map_emit(MIDI_MAP_SRC_POT0, 2000U, FULL);
+    CHECK_EQ(s_out_len, 0);
+    midi_map_emit(1U, 2000U, FULL);
+    CHECK(out_is((const uint8_t[]) {0xB0, 0x00, 0x3E}, 3U));
+}
+
+// 全部の出力値 o について、逆引きした位置 v は o 以上 (下がるカーブは o 以下) になる最小の位置
+static uint32_t check_reverse(uint8_t src, uint16_t out_max)
+{
+    uint32_t bad  = 0;
+    const bool up = output_of(src, FULL) >= output_of(src, 0);
+
+    for (uint32_t o = 0; o <= out_max; o++)
+    {
+        uint32_t v;
+        if (!midi_map_reverse(src, (uint16_t) o, FULL, &v) || (v > FULL))
+        {
+            bad++;
+            continue;
+        }
+        const uint32_t at = output_of(src, v);
+        if ((v < FULL) && (up ? (at < o) : (at > o)))
+        {
+            bad++;
+        }
+        if ((v > 0U) && (up ? (output_of(src, v - 1U) >= o) : (output_of(src, v - 1U) <= o)))
+        {
+            bad++;
+        }
+    }
+    return bad;
+}
+
+static void test_reverse(void)
+{
+    uint32_t v;
+
+    midi_map_set_defaults();
+    CHECK_EQ(check_reverse(MIDI_MAP_SRC_POT0, 127U), 0);
+    CHECK(midi_map_reverse(MIDI_MAP_SRC_POT0, 127U, FULL, &v));
+    CHECK_EQ(output_of(MIDI_MAP_SRC_POT0, v), 127);
+    CHECK(midi_map_reverse(MIDI_MAP_SRC_POT0, 0U, FULL, &v));
+    CHECK_EQ(v, 0);
+
+    for (uint8_t curve = 0; curve < XFADE_CURVE_USER; curve++)
+    {
+        set(1U, MIDI_MAP_TYPE_CC, 0U, curve, MIDI_MAP_FLAG_INVERT, 7U, 10U, 110U);
+        CHECK_EQ(check_reverse(1U, 127U), 0);
+        set(1U, MIDI_MAP_TYPE_NRPN, 0U, curve, 0U, 7U, 0U, 16383U);
+        CHECK_EQ(check_reverse(1U, 16383U), 0);
+    }
+
+    // ノートと未割り当ては逆引きしない
+    set(1U, MIDI_MAP_TYPE_NOTE, 0U, XFADE_CURVE_LINEAR, 0U, 60U, 0U, 127U);
+    CHECK(!midi_map_reverse(1U, 64U, FULL, &v));
+    set(1U, MIDI_MAP_TYPE_NONE, 0U, XFADE_CURVE_LINEAR, 0U, 0U, 0U, 0U);
+    CHECK(!midi_map_reverse(1U, 0U, FULL, &v));
+    CHECK(!midi_map_reverse(MIDI_MAP_SRC_NUM, 0U, FULL, &v));
+    CHECK(!midi_map_reverse(MIDI_MAP_SRC_POT0, 0U, 0U, &v));
+}
+
+static void test_learn(void)
+{
+    midi_map_entry_t e;
+
+    midi_map_set_defaults();
+    s_now = 1000U;
+
+    // learn していなければ何もしない
+    CHECK_EQ(midi_map_learn_take(0xB0U, 20U), MIDI_MAP_LEARN_NONE);
+
+    // 操作子を動かす前の CC は使わない。最初に動かした操作子を選ぶ
+    CHECK(midi_map_learn_start());
+    CHECK(midi_map_learn_active());
+    CHECK_EQ(midi_map_learn_take(0xB0U, 20U), MIDI_MAP_LEARN_NONE);
+    midi_map_emit(MIDI_MAP_SRC_POT0 + 2U, 100U, FULL);
+    midi_map_emit(MIDI_MAP_SRC_POT0 + 3U, 100U, FULL);
+    CHECK_EQ(midi_map_learn_take(0xC1U, 5U), MIDI_MAP_LEARN_NONE);  // プログラムチェンジは使わない
+    CHECK(midi_map_learn_active());
+    CHECK_EQ(midi_map_learn_take(0x91U, 0xC0U), MIDI_MAP_LEARN_DONE);
+    CHECK(!midi_map_learn_active());
+    CHECK(midi_map_get_entry(MIDI_MAP_SRC_POT0 + 2U, &e));
+    CHECK_EQ(e.type, MIDI_MAP_TYPE_NOTE);
+    CHECK_EQ(e.channel, 1);
+    CHECK_EQ(e.number, 0x40);
+    CHECK_EQ(e.max, 127);
+    CHECK(midi_map_get_entry(MIDI_MAP_SRC_POT0 + 3U, &e));
+    CHECK_EQ(e.number, 3);
+
+    // 期限は MIDI_MAP_LEARN_TIMEOUT_MS (10s)
+    CHECK(midi_map_learn_start());
+    s_now += 9999U;
+    CHECK_EQ(midi_map_learn_poll(), MIDI_MAP_LEARN_NONE);
+    CHECK(midi_map_learn_active());
+    s_now += 1U;
+    CHECK_EQ(midi_map_learn_poll(), MIDI_MAP_LEARN_TIMEOUT);
+    CHECK(!midi_map_learn_active());
+    CHECK_EQ(midi_map_learn_poll(), MIDI_MAP_LEARN_NONE);
+
+    // 取り消したら選んだ操作子があっても割り当てない
+    CHECK(midi_map_learn_start());
+    midi_map_emit(MIDI_MAP_SRC_MAG0, 100U, 1408U);
+    midi_map_learn_cancel();
+    CHECK(!midi_map_learn_active());
+    CHECK_EQ(midi_map_learn_take(0xB0U, 21U), MIDI_MAP_LEARN_NONE);
+    s_now += 20000U;
+    CHECK_EQ(midi_map_learn_poll(), MIDI_MAP_LEARN_NONE);
+    CHECK(midi_map_get_entry(MIDI_MAP_SRC_MAG0, &e));
+    CHECK_EQ(e.number, 15);
+    midi_map_learn_cancel();
+    CHECK(!midi_map_learn_active());
+}
+
+static void test_load_save(void)
+{
+    I2C_HandleTypeDef hi2c = {0};
+    midi_map_entry_t e;
+
+    s_rec_valid = false;
+    CHECK(!midi_map_load(&hi2c));
+
+    set(6U, MIDI_MAP_TYPE_NRPN, 9U, XFADE_CURVE_SHARP, MIDI_MAP_FLAG_INVERT, 1234U, 5U, 9000U);
+    CHECK(midi_map_save(&hi2c) == HAL_OK);
+    midi_map_set_defaults();
+    const uint32_t gen = midi_map_generation();
+    CHECK(midi_map_load(&hi2c));
+    CHECK(midi_map_generation() != gen);
+    CHECK(midi_map_get_entry(6U, &e));
+    CHECK_EQ(e.number, 1234);
+    CHECK_EQ(e.max, 9000);
+
+    // 1 つでも不正なら全部初期値
+    s_rec.entry[0] = MIDI_MAP_TYPE_NUM;
+    CHECK(!midi_map_load(&hi2c));
+    CHECK(midi_map_get_entry(6U, &e));
+    CHECK_EQ(e.type, MIDI_MAP_TYPE_DSP);
+}
+
+int main(void)
+{
+    test_apply();
+    test_duplicates();
+    test_reverse();
+    test_learn();
+    test_load_save();
+    return test_done("midi_map");
+}
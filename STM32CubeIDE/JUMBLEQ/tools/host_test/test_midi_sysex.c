@@ -0,0 +1,386 @@
+/*
+ * test_midi_sysex.c
+ *
+ *  Created on: Mar 23, 2026
+ */
+
+// midi_sysex_handle をホストで動かす。EEPROM は fake_i2c、割り当て表と DSP は下の代わり
+// EEPROM に書くコマンドは midi_sysex_flush_save (ui_control がフェーダーの窓待ち中に呼ぶ) まで書かず、ACK も返さない
+
+#include "midi_sysex.h"
+
+#include "dsp_library.h"
+#include "eeprom.h"
+#include "fake_i2c.h"
+#include "input_event.h"
+#include "midi_map.h"
+#include "midi_sysex_codec.h"
+#include "test.h"
+#include "ui_control.h"
+
+#include <string.h>
+
+I2C_HandleTypeDef hi2c2;
+
+static midi_map_entry_t s_map[MIDI_MAP_SRC_NUM];
+static UI_ControlPersistState_t s_persist;
+static uint32_t s_map_saves;
+
+// USB に書いた分をためておき、揃ったメッセージ毎に取り出す
+static uint8_t s_out[8192];
+static uint32_t s_out_len;
+
+typedef struct
+{
+    uint8_t cmd;
+    uint8_t data[MIDI_SYSEX_BUF_SIZE];
+    uint16_t len;
+} reply_t;
+
+static reply_t s_reply[16];
+static uint32_t s_reply_num;
+
+uint32_t tud_midi_stream_write(uint8_t cable_num, const uint8_t* buffer, uint32_t bufsize)
+{
+    if ((s_out_len + bufsize) <= sizeof(s_out))
+    {
+        memcpy(&s_out[s_out_len], buffer, bufsize);
+        s_out_len += bufsize;
+    }
+    return bufsize;
+}
+
+void midi_map_set_defaults(void)
+{
+    memset(s_map, 0, sizeof(s_map));
+}
+
+bool midi_map_get_entry(uint8_t src, midi_map_entry_t* entry)
+{
+    if (src >= MIDI_MAP_SRC_NUM)
+    {
+        return false;
+    }
+    *entry = s_map[src];
+    return true;
+}
+
+bool midi_map_set_entry(uint8_t src, const midi_map_entry_t* entry)
+{
+    if ((src >= MIDI_MAP_SRC_NUM) || (entry->channel > 15U))
+    {
+        return false;
+    }
+    s_map[src] = *entry;
+    return true;
+}
+
+HAL_StatusTypeDef midi_map_save(I2C_HandleTypeDef* hi2c)
+{
+    s_map_saves++;
+    return HAL_OK;
+}
+
+uint8_t dsp_library_active_slot(void)
+{
+    return DSP_LIBRARY_SLOT_BUILTIN;
+}
+
+const dsp_image_header_t* dsp_library_get_image(uint8_t slot)
+{
+    return NULL;
+}
+
+bool ui_control_host_set_dsp_param(uint8_t param, uint16_t value)
+{
+    return false;
+}
+
+bool ui_control_get_dsp_param(uint8_t param, uint16_t* value)
+{
+    return false;
+}
+
+void ui_control_get_persist_state(UI_ControlPersistState_t* state)
+{
+    *state = s_persist;
+}
+
+bool ui_control_apply_persist_state(const UI_ControlPersistState_t* state)
+{
+    s_persist = *state;
+    return true;
+}
+
+void led_notify_save_success(void)
+{
+}
+
+// 出力をメッセージに分けて s_reply に入れる
+static void collect(void)
+{
+    midi_sysex_rx_t rx;
+
+    midi_sysex_reset(&rx);
+    for (uint32_t i = 0; i < s_out_len; i++)
+    {
+        midi_sysex_msg_t m;
+        if (midi_sysex_feed_byte(&rx, s_out[i]) && midi_sysex_parse(rx.buf, rx.len, &m) && (s_reply_num < ARRAY_SIZE(s_reply)))
+        {
+            reply_t* r = &s_reply[s_reply_num++];
+            r->cmd     = m.cmd;
+            r->len     = m.len;
+            memcpy(r->data, m.data, m.len);
+        }
+    }
+}
+
+static void send(uint8_t cmd, const uint8_t* data, uint16_t len)
+{
+    uint8_t msg[MIDI_SYSEX_BUF_SIZE + 2U];
+    const uint16_t n = midi_sysex_build(cmd, data, len, msg, sizeof(msg));
+
+    CHECK(n != 0U);
+    s_out_len   = 0;
+    s_reply_num = 0;
+    midi_sysex_handle(&msg[1], (uint16_t) (n - 2U));  // F0 / F7 を除いた中身
+    collect();
+}
+
+static void flush(void)
+{
+    s_out_len   = 0;
+    s_reply_num = 0;
+    midi_sysex_flush_save();
+    collect();
+}
+
+static bool acked(uint8_t cmd)
+{
+    return (s_reply_num == 1U) && (s_reply[0].cmd == MIDI_SYSEX_CMD_ACK) && (s_reply[0].len == 1U) && (s_reply[0].data[0] == cmd);
+}
+
+static void fill_map(uint8_t seed)
+{
+    for (uint8_t src = 0; src < MIDI_MAP_SRC_NUM; src++)
+    {
+        midi_map_entry_t* e = &s_map[src];
+        e->type             = (uint8_t) ((src + seed) % 4U);
+        e->channel          = (uint8_t) ((src + seed) & 0x0FU);
+        e->curve            = 0;
+        e->flags            = 0;
+        e->number           = (uint16_t) (src * 37U + seed);
+        e->min              = seed;
+        e->max              = (uint16_t) (1000U + src);
+    }
+}
+
+// ダンプした割り当て表を、チャンクの間に設定のダンプを挟みながら書き戻す
+static void test_restore_interleaved_with_dump(void)
+{
+    static const uint8_t map_section = MIDI_SYSEX_SECTION_MIDI_MAP;
+    static const uint8_t cfg_section = MIDI_SYSEX_SECTION_CONFIG;
+    midi_map_entry_t want[MIDI_MAP_SRC_NUM];
+    reply_t chunk[4];
+
+    fill_map(3U);
+    memcpy(want, s_map, sizeof(want));
+    send(MIDI_SYSEX_CMD_DUMP_GET, &map_section, 1U);
+    const uint32_t count = s_reply_num;
+    CHECK_EQ(count, (sizeof(want) + MIDI_SYSEX_CHUNK_BYTES - 1U) / MIDI_SYSEX_CHUNK_BYTES);
+    CHECK(count <= ARRAY_SIZE(chunk));
+    memcpy(chunk, s_reply, count * sizeof(chunk[0]));
+
+    fill_map(50U);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        CHECK_EQ(chunk[i].cmd, MIDI_SYSEX_CMD_DUMP_DATA);
+        send(MIDI_SYSEX_CMD_RESTORE_DATA, chunk[i].data, chunk[i].len);
+        CHECK(acked(MIDI_SYSEX_CMD_RESTORE_DATA));
+
+        send(MIDI_SYSEX_CMD_DUMP_GET, &cfg_section, 1U);
+        CHECK(s_reply_num != 0U);
+        CHECK_EQ(s_reply[0].cmd, MIDI_SYSEX_CMD_DUMP_DATA);
+    }
+    CHECK(memcmp(s_map, want, sizeof(want)) == 0);
+
+    // 途中のチャンクからは受けない。最後まで来なければ反映しない
+    fill_map(50U);
+    memcpy(want, s_map, sizeof(want));
+    send(MIDI_SYSEX_CMD_RESTORE_DATA, chunk[1].data, chunk[1].len);
+    CHECK(!acked(MIDI_SYSEX_CMD_RESTORE_DATA));
+    send(MIDI_SYSEX_CMD_RESTORE_DATA, chunk[0].data, chunk[0].len);
+    CHECK(acked(MIDI_SYSEX_CMD_RESTORE_DATA));
+    CHECK(memcmp(s_map, want, sizeof(want)) == 0);
+
+    // チェックサムが違うチャンクで打ち切り、続きも受けない
+    chunk[1].data[chunk[1].len - 1U] ^= 0x01U;
+    send(MIDI_SYSEX_CMD_RESTORE_DATA, chunk[1].data, chunk[1].len);
+    CHECK(!acked(MIDI_SYSEX_CMD_RESTORE_DATA));
+    chunk[1].data[chunk[1].len - 1U] ^= 0x01U;
+    send(MIDI_SYSEX_CMD_RESTORE_DATA, chunk[1].data, chunk[1].len);
+    CHECK(!acked(MIDI_SYSEX_CMD_RESTORE_DATA));
+    CHECK(memcmp(s_map, want, sizeof(want)) == 0);
+}
+
+// 設定のダンプをそのまま書き戻すと同じ値になる
+static void test_config_roundtrip(void)
+{
+    static const uint8_t cfg_section = MIDI_SYSEX_SECTION_CONFIG;
+    EEPROM_DeviceConfig_t cfg;
+    UI_ControlPersistState_t want;
+    reply_t chunk[4];
+
+    EEPROM_ConfigSetDefaults(&cfg);
+    (void) EEPROM_ConfigApply(&cfg);
+    want = s_persist;
+
+    send(MIDI_SYSEX_CMD_DUMP_GET, &cfg_section, 1U);
+    const uint32_t count = s_reply_num;
+    CHECK(count != 0U);
+    CHECK(count <= ARRAY_SIZE(chunk));
+    memcpy(chunk, s_reply, count * sizeof(chunk[0]));
+
+    memset(&s_persist, 0, sizeof(s_persist));
+    for (uint32_t i = 0; i < count; i++)
+    {
+        send(MIDI_SYSEX_CMD_RESTORE_DATA, chunk[i].data, chunk[i].len);
+        CHECK(acked(MIDI_SYSEX_CMD_RESTORE_DATA));
+    }
+    CHECK(memcmp(&s_persist, &want, sizeof(want)) == 0);
+}
+
+// 保存は flush まで書かずに ACK も返さない。保存待ちの間の次の保存は NAK
+static void test_deferred_save(void)
+{
+    static const uint8_t slot     = 2U;
+    static const uint8_t bad_slot = EEPROM_PRESET_NUM;
+    EEPROM_DeviceConfig_t cfg;
+    EEPROM_DeviceConfig_t got;
+
+    EEPROM_ConfigSetDefaults(&cfg);
+    cfg.current_xf_cut[0] = 33U;
+    CHECK(EEPROM_ConfigApply(&cfg));
+
+    uint32_t writes = fake_i2c.writes;
+    send(MIDI_SYSEX_CMD_CFG_SAVE, NULL, 0U);
+    CHECK_EQ(s_reply_num, 0);
+    CHECK_EQ(fake_i2c.writes, writes);
+
+    send(MIDI_SYSEX_CMD_PRESET_STORE, &slot, 1U);
+    CHECK(!acked(MIDI_SYSEX_CMD_PRESET_STORE));
+    CHECK_EQ(s_reply[0].cmd, MIDI_SYSEX_CMD_NAK);
+    send(MIDI_SYSEX_CMD_MAP_SAVE, NULL, 0U);
+    CHECK_EQ(s_reply[0].cmd, MIDI_SYSEX_CMD_NAK);
+
+    // 受け取った後に変えた分は入らない
+    cfg.current_xf_cut[0] = 44U;
+    CHECK(EEPROM_ConfigApply(&cfg));
+    flush();
+    CHECK(acked(MIDI_SYSEX_CMD_CFG_SAVE));
+    CHECK(fake_i2c.writes != writes);
+    CHECK(EEPROM_LoadConfig(&hi2c2, &got) == HAL_OK);
+    CHECK_EQ(got.current_xf_cut[0], 33);
+    flush();
+    CHECK_EQ(s_reply_num, 0);
+
+    send(MIDI_SYSEX_CMD_PRESET_STORE, &bad_slot, 1U);
+    CHECK_EQ(s_reply[0].cmd, MIDI_SYSEX_CMD_NAK);
+    send(MIDI_SYSEX_CMD_PRESET_STORE, &slot, 1U);
+    CHECK_EQ(s_reply_num, 0);
+    flush();
+    CHECK(acked(MIDI_SYSEX_CMD_PRESET_STORE));
+    CHECK(EEPROM_LoadPreset(&hi2c2, slot, &got) == HAL_OK);
+    CHECK_EQ(got.current_xf_cut[0], 44);
+
+    s_map_saves = 0;
+    send(MIDI_SYSEX_CMD_MAP_SAVE, NULL, 0U);
+    CHECK_EQ(s_reply_num, 0);
+    CHECK_EQ(s_map_saves, 0);
+    flush();
+    CHECK(acked(MIDI_SYSEX_CMD_MAP_SAVE));
+    CHECK_EQ(s_map_saves, 1);
+}
+
+// プリセットへのリストアは最後のチャンクの ACK を書き終わってから返す
+static void test_restore_preset_deferred(void)
+{
+    const uint8_t section = MIDI_SYSEX_SECTION_PRESET + 1U;
+    EEPROM_DeviceConfig_t cfg;
+    EEPROM_DeviceConfig_t got;
+    reply_t chunk[4];
+
+    EEPROM_ConfigSetDefaults(&cfg);
+    cfg.current_xf_cut[1] = 55U;
+    CHECK(EEPROM_SavePreset(&hi2c2, 1U, &cfg) == HAL_OK);
+    send(MIDI_SYSEX_CMD_DUMP_GET, &section, 1U);
+    const uint32_t count = s_reply_num;
+    CHECK(count != 0U);
+    CHECK(count <= ARRAY_SIZE(chunk));
+    memcpy(chunk, s_reply, count * sizeof(chunk[0]));
+
+    cfg.current_xf_cut[1] = 66U;
+    CHECK(EEPROM_SavePreset(&hi2c2, 1U, &cfg) == HAL_OK);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        send(MIDI_SYSEX_CMD_RESTORE_DATA, chunk[i].data, chunk[i].len);
+        if ((i + 1U) < count)
+        {
+            CHECK(acked(MIDI_SYSEX_CMD_RESTORE_DATA));
+        }
+    }
+    CHECK_EQ(s_reply_num, 0);
+    CHECK(EEPROM_LoadPreset(&hi2c2, 1U, &got) == HAL_OK);
+    CHECK_EQ(got.current_xf_cut[1], 66);
+    flush();
+    CHECK(acked(MIDI_SYSEX_CMD_RESTORE_DATA));
+    CHECK(EEPROM_LoadPreset(&hi2c2, 1U, &got) == HAL_OK);
+    CHECK_EQ(got.current_xf_cut[1], 55);
+}
+
+// ボタン/フェーダーの時間は TUNE で読み書きできる。組み合わせが不正なら NAK で変えない
+static void test_tune_input_timing(void)
+{
+    const uint8_t set_long[]  = {MIDI_SYSEX_TUNE_INPUT_LONG, 600U >> 7, 600U & 0x7FU};
+    const uint8_t set_short[] = {MIDI_SYSEX_TUNE_INPUT_LONG, 0, 10};
+    const uint8_t get_long[]  = {MIDI_SYSEX_TUNE_INPUT_LONG};
+    const uint8_t get_bad[]   = {0x1FU};
+    input_event_timing_t def;
+    input_event_timing_t t;
+
+    input_event_get_timing(&def);
+
+    send(MIDI_SYSEX_CMD_TUNE_SET, set_long, sizeof(set_long));
+    CHECK(acked(MIDI_SYSEX_CMD_TUNE_SET));
+    input_event_get_timing(&t);
+    CHECK_EQ(t.long_ms, 600);
+    CHECK_EQ(t.chord_ms, def.chord_ms);
+
+    send(MIDI_SYSEX_CMD_TUNE_SET, set_short, sizeof(set_short));
+    CHECK(!acked(MIDI_SYSEX_CMD_TUNE_SET));
+    input_event_get_timing(&t);
+    CHECK_EQ(t.long_ms, 600);
+
+    send(MIDI_SYSEX_CMD_TUNE_GET, get_long, sizeof(get_long));
+    CHECK_EQ(s_reply_num, 1);
+    CHECK_EQ(s_reply[0].cmd, MIDI_SYSEX_CMD_TUNE_REPLY);
+    CHECK_EQ(s_reply[0].len, 3);
+    CHECK_EQ((s_reply[0].data[1] << 7) | s_reply[0].data[2], 600);
+
+    send(MIDI_SYSEX_CMD_TUNE_GET, get_bad, sizeof(get_bad));
+    CHECK_EQ(s_reply_num, 1);
+    CHECK_EQ(s_reply[0].cmd, MIDI_SYSEX_CMD_NAK);
+
+    CHECK(input_event_set_timing(&def));
+}
+
+int main(void)
+{
+    fake_i2c_reset();
+    test_restore_interleaved_with_dump();
+    test_config_roundtrip();
+    test_deferred_save();
+    test_restore_preset_deferred();
+    test_tune_input_timing();
+    return test_done("midi_sysex");
+}
@@ -0,0 +1,268 @@
+/*
+ * test_midi_sysex_codec.c
+ *
+ *  Created on: Mar 23, 2026
+ */
+
+// midi_sysex_codec の fuzz。乱数は固定の種から作るので毎回同じ列になる
+//   build/test_midi_sysex_codec [iterations] [seed]
+
+#include "midi_sysex_codec.h"
+
+#include "test.h"
+
+#include <stdlib.h>
+
+#define GUARD      0xA5U
+#define GUARD_LEN  16U
+#define ITERATIONS 200000UL
+
+static uint32_t s_rng;
+
+static uint32_t rnd(void)
+{
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return s_rng;
+}
+
+static bool guard_ok(const uint8_t* p, uint32_t n)
+{
+    for (uint32_t i = 0; i < n; i++)
+    {
+        if (p[i] != GUARD)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 任意の 8bit 列 → pack → unpack で元に戻り、詰めた側は全部 7bit、長さは MIDI_SYSEX_PACKED_LEN
+static void fuzz_pack_roundtrip(void)
+{
+    uint8_t in[200];
+    uint8_t packed[MIDI_SYSEX_PACKED_LEN(200U) + GUARD_LEN];
+    uint8_t out[200 + GUARD_LEN];
+    const uint16_t len = (uint16_t) (rnd() % sizeof(in));
+    uint16_t plen;
+    uint16_t olen;
+
+    for (uint16_t i = 0; i < len; i++)
+    {
+        in[i] = (uint8_t) rnd();
+    }
+    memset(packed, GUARD, sizeof(packed));
+    memset(out, GUARD, sizeof(out));
+
+    CHECK(midi_sysex_pack(in, len, packed, (uint16_t) MIDI_SYSEX_PACKED_LEN(len), &plen));
+    CHECK_EQ(plen, MIDI_SYSEX_PACKED_LEN(len));
+    CHECK(guard_ok(&packed[plen], GUARD_LEN));
+    for (uint16_t i = 0; i < plen; i++)
+    {
+        if ((packed[i] & 0x80U) != 0U)
+        {
+            CHECK(false);
+            break;
+        }
+    }
+    CHECK(midi_sysex_unpack(packed, plen, out, len, &olen));
+    CHECK_EQ(olen, len);
+    CHECK(memcmp(in, out, len) == 0);
+    CHECK(guard_ok(&out[len], GUARD_LEN));
+
+    // 1 byte 足りない出力先には書かない
+    if (len != 0U)
+    {
+        CHECK(!midi_sysex_pack(in, len, packed, (uint16_t) (MIDI_SYSEX_PACKED_LEN(len) - 1U), &plen));
+        memset(out, GUARD, sizeof(out));
+        CHECK(!midi_sysex_unpack(packed, (uint16_t) MIDI_SYSEX_PACKED_LEN(len), out, (uint16_t) (len - 1U), &olen));
+        CHECK(guard_ok(&out[len - 1U], GUARD_LEN));
+    }
+
+    // checksum を足すと下位 7bit が 0
+    const uint8_t ck = midi_sysex_checksum(packed, plen);
+    uint8_t sum      = ck;
+    for (uint16_t i = 0; i < plen; i++)
+    {
+        sum = (uint8_t) (sum + packed[i]);
+    }
+    CHECK(ck < 0x80U);
+    CHECK_EQ(sum & 0x7FU, 0);
+}
+
+// 壊れた入力でも cap を超えて書かず、成功した時の長さは cap 以内
+static void fuzz_unpack_garbage(void)
+{
+    uint8_t in[160];
+    uint8_t out[140 + GUARD_LEN];
+    const uint16_t len = (uint16_t) (rnd() % sizeof(in));
+    const uint16_t cap = (uint16_t) (rnd() % 141U);
+    const bool high    = (rnd() % 8U) == 0U;  // たまに 8bit の byte を混ぜる
+    uint16_t olen      = 0xFFFFU;
+
+    for (uint16_t i = 0; i < len; i++)
+    {
+        in[i] = (uint8_t) (rnd() & (high ? 0xFFU : 0x7FU));
+    }
+    memset(out, GUARD, sizeof(out));
+    if (midi_sysex_unpack(in, len, out, cap, &olen))
+    {
+        CHECK(olen <= cap);
+    }
+    CHECK(guard_ok(&out[cap], GUARD_LEN));
+}
+
+// 任意のバイト列を流しても buf からはみ出さず、揃った中身は全部 7bit で BUF_SIZE 以内
+static void fuzz_rx_stream(void)
+{
+    midi_sysex_rx_t rx;
+
+    midi_sysex_reset(&rx);
+    for (uint32_t i = 0; i < 400U; i++)
+    {
+        uint8_t b = (uint8_t) rnd();
+        if ((rnd() % 16U) == 0U)
+        {
+            b = ((rnd() & 1U) != 0U) ? 0xF0U : 0xF7U;
+        }
+        else if ((rnd() % 4U) != 0U)
+        {
+            b &= 0x7FU;
+        }
+        if (midi_sysex_feed_byte(&rx, b))
+        {
+            CHECK(rx.len <= MIDI_SYSEX_BUF_SIZE);
+            for (uint16_t k = 0; k < rx.len; k++)
+            {
+                if ((rx.buf[k] & 0x80U) != 0U)
+                {
+                    CHECK(false);
+                    break;
+                }
+            }
+            midi_sysex_msg_t m;
+            if (midi_sysex_parse(rx.buf, rx.len, &m))
+            {
+                CHECK(m.len == (uint16_t) (rx.len - MIDI_SYSEX_HEADER_LEN));
+                CHECK(m.cmd < 0x80U);
+            }
+        }
+        CHECK(rx.len <= MIDI_SYSEX_BUF_SIZE);
+    }
+}
+
+// build → USB-MIDI パケットに分けて feed_packet → parse で同じ cmd/data に戻る (途中にリアルタイムを挟む)
+static void fuzz_build_parse(void)
+{
+    uint8_t data[MIDI_SYSEX_BUF_SIZE];
+    uint8_t msg[MIDI_SYSEX_BUF_SIZE + 2U];
+    const uint16_t len = (uint16_t) (rnd() % (MIDI_SYSEX_BUF_SIZE - MIDI_SYSEX_HEADER_LEN + 1U));
+    const uint8_t cmd  = (uint8_t) (rnd() & 0x7FU);
+    midi_sysex_rx_t rx;
+    midi_sysex_msg_t m;
+    bool complete = false;
+
+    for (uint16_t i = 0; i < len; i++)
+    {
+        data[i] = (uint8_t) (rnd() & 0x7FU);
+    }
+    const uint16_t n = midi_sysex_build(cmd, data, len, msg, sizeof(msg));
+    CHECK_EQ(n, len + MIDI_SYSEX_HEADER_LEN + 2U);
+    CHECK(midi_sysex_build(cmd, data, len, msg, (uint16_t) (n - 1U)) == 0U);
+
+    midi_sysex_reset(&rx);
+    for (uint16_t i = 0; i < n;)
+    {
+        uint8_t packet[4] = {0};
+        const uint16_t left = (uint16_t) (n - i);
+
+        if ((rnd() % 8U) == 0U)
+        {
+            packet[0] = 0x0FU;  // 1 byte のリアルタイム (F8) は SysEx とは別のパケット
+            packet[1] = 0xF8U;
+            CHECK(!midi_sysex_feed_packet(&rx, packet));
+            continue;
+        }
+        if (left > 3U)
+        {
+            packet[0] = 0x04U;
+            memcpy(&packet[1], &msg[i], 3U);
+            i = (uint16_t) (i + 3U);
+        }
+        else
+        {
+            packet[0] = (uint8_t) (0x04U + left);  // 0x5/0x6/0x7: 1-3 byte で終わり
+            memcpy(&packet[1], &msg[i], left);
+            i = n;
+        }
+        if (midi_sysex_feed_packet(&rx, packet))
+        {
+            complete = true;
+        }
+    }
+
+    CHECK(complete);
+    CHECK(midi_sysex_parse(rx.buf, rx.len, &m));
+    CHECK_EQ(m.cmd, cmd);
+    CHECK_EQ(m.len, len);
+    CHECK(memcmp(m.data, data, len) == 0);
+}
+
+static void test_fixed(void)
+{
+    static const uint8_t id_req[] = {0x7EU, 0x7FU, 0x06U, 0x01U};
+    static const uint8_t version[4] = {1U, 2U, 3U, 0U};
+    uint8_t out[16];
+    midi_sysex_rx_t rx;
+    midi_sysex_msg_t m;
+
+    CHECK(midi_sysex_is_identity_request(id_req, sizeof(id_req)));
+    CHECK(!midi_sysex_is_identity_request(id_req, 3U));
+    CHECK_EQ(midi_sysex_build_identity_reply(version, out, sizeof(out)), 15);
+    CHECK_EQ(out[0], 0xF0);
+    CHECK_EQ(out[14], 0xF7);
+    CHECK(midi_sysex_build_identity_reply(version, out, 14U) == 0U);
+
+    // 他社宛て / 短すぎる / cmd が 7bit を超える
+    static const uint8_t other[] = {0x41U, 0x10U, 0x12U};
+    static const uint8_t short_msg[] = {MIDI_SYSEX_MANUFACTURER, MIDI_SYSEX_DEVICE};
+    CHECK(!midi_sysex_parse(other, sizeof(other), &m));
+    CHECK(!midi_sysex_parse(short_msg, sizeof(short_msg), &m));
+
+    // BUF_SIZE を超えたメッセージは F7 が来ても揃わない。次の F0 から普通に受ける
+    midi_sysex_reset(&rx);
+    (void) midi_sysex_feed_byte(&rx, 0xF0U);
+    for (uint32_t i = 0; i < MIDI_SYSEX_BUF_SIZE + 1U; i++)
+    {
+        (void) midi_sysex_feed_byte(&rx, 0x01U);
+    }
+    CHECK(!midi_sysex_feed_byte(&rx, 0xF7U));
+    (void) midi_sysex_feed_byte(&rx, 0xF0U);
+    (void) midi_sysex_feed_byte(&rx, 0x05U);
+    CHECK(midi_sysex_feed_byte(&rx, 0xF7U));
+    CHECK_EQ(rx.len, 1);
+
+    // 途中のステータスバイトで捨てる
+    (void) midi_sysex_feed_byte(&rx, 0xF0U);
+    (void) midi_sysex_feed_byte(&rx, 0x05U);
+    (void) midi_sysex_feed_byte(&rx, 0x90U);
+    CHECK(!midi_sysex_feed_byte(&rx, 0xF7U));
+}
+
+int main(int argc, char** argv)
+{
+    const unsigned long iterations = (argc > 1) ? strtoul(argv[1], NULL, 0) : ITERATIONS;
+    s_rng                          = (argc > 2) ? (uint32_t) strtoul(argv[2], NULL, 0) : 0x4A4D4251U;
+
+    test_fixed();
+    for (unsigned long it = 0; (it < iterations) && (test_failures < 20); it++)
+    {
+        fuzz_pack_roundtrip();
+        fuzz_unpack_garbage();
+        fuzz_rx_stream();
+        fuzz_build_parse();
+    }
+    return test_done("midi_sysex_codec");
+}
@@ -0,0 +1,201 @@
+/*
+ * test_oled_dirty.c
+ *
+ *  Created on: Mar 23, 2026
+ */
+
+#include "oled_dirty.h"
+
+#include "test.h"
+
+#include <stdlib.h>
+
+#define W     128U
+#define PAGES 8U
+
+static uint8_t s_fb[W * PAGES];
+static uint8_t s_shadow[W * PAGES];
+
+static bool page_dirty(const oled_dirty_t* d, uint8_t p, uint8_t lo, uint8_t hi)
+{
+    return (d->col_min[p] == lo) && (d->col_max[p] == hi);
+}
+
+static bool page_clean(const oled_dirty_t* d, uint8_t p)
+{
+    return d->col_min[p] > d->col_max[p];
+}
+
+static void test_mark(void)
+{
+    oled_dirty_t d;
+
+    oled_dirty_init(&d, W, PAGES);
+    CHECK(!oled_dirty_any(&d));
+
+    // y 10-17 はページ 1-2、範囲外は丸める
+    oled_dirty_mark_rect(&d, 40, 17, 20, 10);
+    CHECK(page_dirty(&d, 1, 20, 40));
+    CHECK(page_dirty(&d, 2, 20, 40));
+    CHECK(page_clean(&d, 0));
+    CHECK(page_clean(&d, 3));
+    oled_dirty_mark(&d, 2, 20, 100, 200);
+    CHECK(page_dirty(&d, 2, 20, 127));
+    CHECK(page_dirty(&d, PAGES - 1U, 100, 127));
+    oled_dirty_mark(&d, 1, 0, 0, 10);  // 向きが逆なら何もしない
+    CHECK(page_clean(&d, 0));
+
+    // 送った窓に入る所だけ消える
+    const oled_dirty_window_t w = {.page_start = 1, .page_end = 2, .col_start = 0, .col_end = 30};
+    oled_dirty_remove(&d, &w);
+    CHECK(page_dirty(&d, 1, 31, 40));
+    CHECK(page_dirty(&d, 2, 31, 127));
+    const oled_dirty_window_t tail = {.page_start = 2, .page_end = 2, .col_start = 100, .col_end = 127};
+    oled_dirty_remove(&d, &tail);
+    CHECK(page_dirty(&d, 2, 31, 99));
+
+    oled_dirty_clear(&d);
+    CHECK(!oled_dirty_any(&d));
+}
+
+static void test_narrow(void)
+{
+    oled_dirty_t d;
+
+    memset(s_fb, 0, sizeof(s_fb));
+    memset(s_shadow, 0, sizeof(s_shadow));
+    oled_dirty_init(&d, W, PAGES);
+    oled_dirty_mark(&d, 0, 3, 0, W - 1U);
+
+    s_fb[1U * W + 50U]  = 0x01U;
+    s_fb[1U * W + 60U]  = 0x80U;
+    s_fb[3U * W + 127U] = 0x10U;
+    oled_dirty_narrow(&d, s_fb, s_shadow);
+    CHECK(page_clean(&d, 0));
+    CHECK(page_dirty(&d, 1, 50, 60));
+    CHECK(page_clean(&d, 2));
+    CHECK(page_dirty(&d, 3, 127, 127));
+}
+
+static void test_plan(void)
+{
+    oled_dirty_t d;
+    oled_dirty_window_t w[PAGES];
+
+    // 同じ列の隣り合うページは 1 窓
+    oled_dirty_init(&d, W, PAGES);
+    oled_dirty_mark(&d, 2, 4, 10, 40);
+    CHECK_EQ(oled_dirty_plan(&d, w, PAGES), 1);
+    CHECK(w[0].page_start == 2 && w[0].page_end == 4 && w[0].col_start == 10 && w[0].col_end == 40);
+
+    // 左端と右端の小さな範囲はまとめると 1 ページ分の列を全部送ることになるので別々
+    oled_dirty_init(&d, W, PAGES);
+    oled_dirty_mark(&d, 0, 0, 0, 7);
+    oled_dirty_mark(&d, 7, 7, 120, 127);
+    CHECK_EQ(oled_dirty_plan(&d, w, PAGES), 2);
+    CHECK(w[0].page_end == 0 && w[0].col_end == 7);
+    CHECK(w[1].page_start == 7 && w[1].col_start == 120);
+
+    // 窓が cap を超える時は増える量の少ない組からまとめる
+    CHECK_EQ(oled_dirty_plan(&d, w, 1), 1);
+    CHECK(w[0].page_start == 0 && w[0].page_end == 7 && w[0].col_start == 0 && w[0].col_end == 127);
+
+    // 少しずつずれた列は、トランザクションの固定分より増えなければまとめる
+    oled_dirty_init(&d, W, PAGES);
+    oled_dirty_mark(&d, 3, 3, 20, 30);
+    oled_dirty_mark(&d, 4, 4, 22, 32);
+    CHECK_EQ(oled_dirty_plan(&d, w, PAGES), 1);
+    CHECK(w[0].col_start == 20 && w[0].col_end == 32);
+
+    oled_dirty_init(&d, W, PAGES);
+    CHECK_EQ(oled_dirty_plan(&d, w, PAGES), 0);
+    CHECK_EQ(oled_dirty_plan(&d, NULL, PAGES), 0);
+}
+
+// oled_i2c と同じく、narrow → plan の先頭を送る → remove を空になるまで繰り返す
+static uint32_t send_all(oled_dirty_t* d, uint32_t* windows)
+{
+    oled_dirty_window_t w[PAGES];
+    uint32_t bytes = 0;
+
+    oled_dirty_narrow(d, s_fb, s_shadow);
+    while (oled_dirty_any(d))
+    {
+        const uint8_t n = oled_dirty_plan(d, w, PAGES);
+        if (n == 0U)
+        {
+            CHECK(false);
+            break;
+        }
+        for (uint8_t p = w[0].page_start; p <= w[0].page_end; p++)
+        {
+            memcpy(&s_shadow[p * W + w[0].col_start], &s_fb[p * W + w[0].col_start], (size_t) (w[0].col_end - w[0].col_start + 1U));
+        }
+        bytes += oled_dirty_window_cost(&w[0]);
+        (*windows)++;
+        oled_dirty_remove(d, &w[0]);
+    }
+    return bytes;
+}
+
+// 文字の書き換えくらいの変化をランダムに入れて、送った後に表示と fb が一致し、ページ毎に送るより多くならないこと
+static void test_random_frames(void)
+{
+    uint32_t bytes    = 0;
+    uint32_t per_page = 0;
+    uint32_t windows  = 0;
+
+    srand(1);
+    memset(s_fb, 0, sizeof(s_fb));
+    memset(s_shadow, 0, sizeof(s_shadow));
+    for (uint32_t f = 0; f < 500U; f++)
+    {
+        oled_dirty_t d;
+        const uint32_t blocks = 1U + (uint32_t) (rand() % 3);
+
+        oled_dirty_init(&d, W, PAGES);
+        for (uint32_t b = 0; b < blocks; b++)
+        {
+            const uint8_t x = (uint8_t) (rand() % 100);
+            const uint8_t y = (uint8_t) (rand() % 54);
+            const uint8_t w = (uint8_t) (7 * (1 + rand() % 4));
+
+            for (uint32_t c = x; (c < (uint32_t) (x + w)) && (c < W); c++)
+            {
+                for (uint32_t yy = y; yy < (uint32_t) (y + 10U); yy++)
+                {
+                    if ((rand() % 3) == 0)
+                    {
+                        s_fb[(yy / 8U) * W + c] ^= (uint8_t) (1U << (yy % 8U));
+                    }
+                }
+            }
+            oled_dirty_mark_rect(&d, x, y, (uint8_t) (((x + w - 1U) > (W - 1U)) ? (W - 1U) : (x + w - 1U)), (uint8_t) (y + 9U));
+        }
+
+        oled_dirty_t narrowed = d;
+        oled_dirty_narrow(&narrowed, s_fb, s_shadow);
+        for (uint8_t p = 0; p < PAGES; p++)
+        {
+            if (!page_clean(&narrowed, p))
+            {
+                per_page += OLED_DIRTY_XFER_COST + (uint32_t) (narrowed.col_max[p] - narrowed.col_min[p] + 1U);
+            }
+        }
+
+        bytes += send_all(&d, &windows);
+        CHECK(memcmp(s_fb, s_shadow, sizeof(s_fb)) == 0);
+        CHECK(!oled_dirty_any(&d));
+    }
+    CHECK(bytes <= per_page);
+    CHECK(windows != 0U);
+}
+
+int main(void)
+{
+    test_mark();
+    test_narrow();
+    test_plan();
+    test_random_frames();
+    return test_done("oled_dirty");
+}
@@ -0,0 +1,320 @@
+/*
+ * test_oled_i2c_shift.c
+ *
+ *  Created on: Mar 23, 2026
+ */
+
+// OLED の DMA 転送キューを fake_i2c の上で回して、送ったバイト列をパネル (GDDRAM) の写しに書き込む
+// - 1 転送 = (0x80, コマンド) x 6 + 0x40 + データ。窓の大きさとデータの長さが合っている
+// - 表示中の内容 (shadow) と同じバイトは送らない
+// - 焼き付き防止のずらし (右/下) を掛けても、送り終わったパネルは fb をずらした画面と 1 画素も違わない
+// - 転送エラーの後は全画面を送り直す
+
+#include "oled_i2c.h"
+
+#include "eeprom.h"
+#include "fake_i2c.h"
+
+#include "test.h"
+
+#define W     OLED_I2C_SUB_WIDTH
+#define H     OLED_I2C_SUB_HEIGHT
+#define PAGES (H / 8U)
+
+typedef struct
+{
+    uint8_t c0;
+    uint8_t c1;
+    uint8_t p0;
+    uint8_t p1;
+} window_t;
+
+void HAL_I2C_MasterTxCpltCallback(I2C_HandleTypeDef* hi2c);
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef* hi2c);
+
+static I2C_HandleTypeDef s_bus = {.id = 2};
+static uint8_t s_fb[W * PAGES];
+static ssd1306_t s_oled = {
+    .ops    = &oled_i2c_ops,
+    .bus    = &s_bus,
+    .fb     = s_fb,
+    .addr   = OLED_I2C_ADDR,
+    .port   = OLED_I2C_SUB,
+    .width  = W,
+    .height = H,
+};
+
+static uint8_t s_panel[W * PAGES];  // パネルの GDDRAM
+static window_t s_last;             // 最後に送った窓
+static uint8_t s_dx;
+static uint8_t s_dy;
+static uint32_t s_seed = 49U;
+
+// fake_i2c が i2cMutex を数える時に見る (EEPROM は使わない)
+bool EEPROM_IsBusy(void)
+{
+    return false;
+}
+
+static uint32_t rnd(void)
+{
+    s_seed = s_seed * 1103515245U + 12345U;
+    return s_seed >> 8;
+}
+
+static bool fb_pixel(int32_t x, int32_t y)
+{
+    if ((x < 0) || (y < 0) || (x >= (int32_t) W) || (y >= (int32_t) H))
+    {
+        return false;
+    }
+    return ((s_fb[(y / 8) * W + x] >> (y % 8)) & 1U) != 0U;
+}
+
+static bool panel_pixel(uint32_t x, uint32_t y)
+{
+    return ((s_panel[(y / 8U) * W + x] >> (y % 8U)) & 1U) != 0U;
+}
+
+// パネルと「fb を (dx, dy) ずらした画面」で違う画素の数
+static uint32_t panel_diff(void)
+{
+    uint32_t n = 0;
+    for (uint32_t y = 0; y < H; y++)
+    {
+        for (uint32_t x = 0; x < W; x++)
+        {
+            n += (panel_pixel(x, y) != fb_pixel((int32_t) x - s_dx, (int32_t) y - s_dy)) ? 1U : 0U;
+        }
+    }
+    return n;
+}
+
+// 送られたバイト列を読んで、水平アドレッシングでパネルに書く
+static void apply_tx(void)
+{
+    static const uint8_t k_cmd[] = {0x21, 0, 0, 0x22, 0, 0};  // 0 は値を見ない
+    const uint8_t* t             = fake_i2c.tx;
+
+    CHECK_EQ(fake_i2c.tx_addr, OLED_I2C_ADDR);
+    CHECK(fake_i2c.tx_bus == &s_bus);
+    CHECK(fake_i2c.tx_len >= 13U);
+    for (uint32_t i = 0; i < 6U; i++)
+    {
+        CHECK_EQ(t[i * 2U], 0x80);
+        if (k_cmd[i] != 0U)
+        {
+            CHECK_EQ(t[i * 2U + 1U], k_cmd[i]);
+        }
+    }
+    CHECK_EQ(t[12], 0x40);
+
+    s_last = (window_t) {.c0 = t[3], .c1 = t[5], .p0 = t[9], .p1 = t[11]};
+    CHECK((s_last.c0 <= s_last.c1) && (s_last.c1 < W));
+    CHECK((s_last.p0 <= s_last.p1) && (s_last.p1 < PAGES));
+    CHECK_EQ(fake_i2c.tx_len, 13U + (s_last.c1 - s_last.c0 + 1U) * (s_last.p1 - s_last.p0 + 1U));
+
+    uint32_t n = 13U;
+    for (uint32_t p = s_last.p0; p <= s_last.p1; p++)
+    {
+        for (uint32_t c = s_last.c0; c <= s_last.c1; c++)
+        {
+            if (n < fake_i2c.tx_len)
+            {
+                s_panel[p * W + c] = t[n++];
+            }
+        }
+    }
+}
+
+// 1 転送だけ進める (送信 → パネルに書く → 完了通知)。送るものがなければ false
+static bool pump(void)
+{
+    const uint32_t before = fake_i2c.tx_count;
+
+    oled_i2c_run(0U);
+    if (fake_i2c.tx_count == before)
+    {
+        return false;
+    }
+    CHECK(fake_i2c.locked);  // 転送中は i2cMutex を持っている
+    apply_tx();
+    HAL_I2C_MasterTxCpltCallback(&s_bus);
+    return true;
+}
+
+// 全部送り終わるまで回して転送の数を返す
+static uint32_t drain(void)
+{
+    uint32_t n = 0;
+    while (pump() && (n < 64U))
+    {
+        n++;
+    }
+    CHECK(!fake_i2c.locked);
+    return n;
+}
+
+static bool last_is(uint8_t c0, uint8_t c1, uint8_t p0, uint8_t p1)
+{
+    return (s_last.c0 == c0) && (s_last.c1 == c1) && (s_last.p0 == p0) && (s_last.p1 == p1);
+}
+
+static void set_shift(uint8_t dx, uint8_t dy)
+{
+    oled_i2c_set_shift(&s_oled, dx, dy);
+    s_dx = dx;
+    s_dy = (dy > 7U) ? 7U : dy;
+}
+
+// 矩形を描き換えて、ssd1306_MarkDirty と同じくページ単位で submit する
+static void scribble(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2)
+{
+    for (uint32_t y = y1; y <= y2; y++)
+    {
+        for (uint32_t x = x1; x <= x2; x++)
+        {
+            const uint8_t bit = (uint8_t) (1U << (y % 8U));
+            if ((rnd() & 1U) != 0U)
+            {
+                s_fb[(y / 8U) * W + x] |= bit;
+            }
+            else
+            {
+                s_fb[(y / 8U) * W + x] &= (uint8_t) ~bit;
+            }
+        }
+    }
+    oled_i2c_submit(&s_oled, (uint8_t) (y1 / 8U), (uint8_t) (y2 / 8U), x1, x2);
+}
+
+static void test_unshifted(void)
+{
+    for (uint32_t i = 0; i < sizeof(s_fb); i++)
+    {
+        s_fb[i] = (uint8_t) rnd();
+    }
+    memset(s_panel, 0xA5, sizeof(s_panel));
+
+    // 起動時の ssd1306_UpdateScreen と同じく全画面。データは fb そのまま
+    oled_i2c_submit(&s_oled, 0, PAGES - 1U, 0, W - 1U);
+    CHECK_EQ(drain(), 1);
+    CHECK(last_is(0, W - 1U, 0, PAGES - 1U));
+    CHECK(memcmp(&fake_i2c.tx[13], s_fb, sizeof(s_fb)) == 0);
+    CHECK_EQ(panel_diff(), 0);
+
+    // 全画面を submit しても、変わった 3 byte だけ
+    s_fb[2U * W + 40U] ^= 0x01U;
+    s_fb[2U * W + 41U] ^= 0x80U;
+    s_fb[2U * W + 42U] ^= 0xFFU;
+    oled_i2c_submit(&s_oled, 0, PAGES - 1U, 0, W - 1U);
+    CHECK_EQ(drain(), 1);
+    CHECK(last_is(40, 42, 2, 2));
+    CHECK_EQ(fake_i2c.tx_len, 13U + 3U);
+    CHECK_EQ(panel_diff(), 0);
+
+    // 変わっていなければ送らない
+    oled_i2c_submit(&s_oled, 0, PAGES - 1U, 0, W - 1U);
+    CHECK_EQ(drain(), 0);
+}
+
+static void test_shift(void)
+{
+    // ずらすと全画面を送り直す。空いた左端の列と上端の行は消灯
+    set_shift(1, 1);
+    CHECK_EQ(drain(), 1);
+    CHECK(last_is(0, W - 1U, 0, PAGES - 1U));
+    CHECK_EQ(panel_diff(), 0);
+    for (uint32_t i = 0; i < W; i++)
+    {
+        CHECK(!panel_pixel(0, i % H));
+        CHECK(!panel_pixel(i, 0));
+    }
+
+    // 同じずらし量なら何もしない
+    set_shift(1, 1);
+    CHECK_EQ(drain(), 0);
+
+    // 中ほどの変更: 窓は右に 1 列、下に 1 ページ (はみ出した行の分) 広がる
+    s_fb[3U * W + 10U] ^= 0x81U;
+    s_fb[3U * W + 12U] ^= 0x80U;
+    oled_i2c_submit(&s_oled, 3, 3, 10, 12);
+    CHECK_EQ(drain(), 1);
+    CHECK(last_is(11, 13, 3, 4));
+    CHECK_EQ(fake_i2c.tx_len, 13U + 3U * 2U);
+    CHECK_EQ(panel_diff(), 0);
+
+    // 左端からの窓は空いた列も含めて送る。右端/下端の外に出る分は送らない
+    s_fb[0] ^= 0x0FU;
+    oled_i2c_submit(&s_oled, 0, 0, 0, 0);
+    CHECK_EQ(drain(), 1);
+    CHECK(last_is(0, 1, 0, 1));
+    CHECK_EQ(panel_diff(), 0);
+    s_fb[(PAGES - 1U) * W + (W - 1U)] ^= 0xFFU;
+    oled_i2c_submit(&s_oled, PAGES - 1U, PAGES - 1U, W - 1U, W - 1U);
+    CHECK_EQ(drain(), 1);
+    CHECK(last_is(W - 1U, W - 1U, PAGES - 1U, PAGES - 1U));
+    CHECK_EQ(panel_diff(), 0);
+
+    // oled_control.c の周回と、大きいずらし (dy は 7 まで)
+    static const uint8_t k_shifts[][2] = {{1, 0}, {0, 1}, {0, 0}, {5, 3}, {0, 9}, {127, 7}};
+    for (uint32_t s = 0; s < ARRAY_SIZE(k_shifts); s++)
+    {
+        set_shift(k_shifts[s][0], k_shifts[s][1]);
+        CHECK_EQ(drain(), 1);
+        CHECK(last_is(0, W - 1U, 0, PAGES - 1U));
+        CHECK_EQ(panel_diff(), 0);
+
+        // ずらしたまま描き換えても、送り終われば同じ画面
+        for (uint32_t i = 0; i < 40U; i++)
+        {
+            const uint8_t x1 = (uint8_t) (rnd() % W);
+            const uint8_t y1 = (uint8_t) (rnd() % H);
+            const uint8_t x2 = (uint8_t) (x1 + rnd() % (W - x1));
+            const uint8_t y2 = (uint8_t) (y1 + rnd() % (H - y1));
+            scribble(x1, y1, x2, y2);
+            if ((i % 4U) == 3U)
+            {
+                (void) drain();
+                CHECK_EQ(panel_diff(), 0);
+            }
+        }
+    }
+    set_shift(0, 0);
+    CHECK_EQ(drain(), 1);
+    CHECK_EQ(panel_diff(), 0);
+}
+
+// エラーで終わった転送は表示の中身が分からないので、次は全画面
+static void test_error(void)
+{
+    scribble(20, 20, 30, 30);
+    oled_i2c_run(0U);
+    CHECK_EQ(fake_i2c.tx_len, 13U + 11U * 2U);
+    HAL_I2C_ErrorCallback(&s_bus);
+    CHECK_EQ(drain(), 1);
+    CHECK(last_is(0, W - 1U, 0, PAGES - 1U));
+    CHECK_EQ(panel_diff(), 0);
+
+    // 完了が来なければ OLED_I2C_XFER_TIMEOUT_MS で打ち切って、同じく全画面
+    scribble(50, 0, 60, 7);
+    oled_i2c_run(0U);
+    const uint32_t aborts = fake_i2c.tx_aborts;
+    CHECK(oled_i2c_wait_idle(1000U));
+    CHECK_EQ(fake_i2c.tx_aborts, aborts + 1U);
+    CHECK_EQ(drain(), 1);
+    CHECK(last_is(0, W - 1U, 0, PAGES - 1U));
+    CHECK_EQ(panel_diff(), 0);
+}
+
+int main(void)
+{
+    fake_i2c_reset();
+    fake_i2c.kernel_running = true;
+
+    test_unshifted();
+    test_shift();
+    test_error();
+    CHECK_EQ(fake_i2c.unlocked_xfers, 0);
+    return test_done("oled_i2c_shift");
+}
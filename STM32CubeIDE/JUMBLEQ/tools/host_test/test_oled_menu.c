@@ -0,0 +1,252 @@
+/*
+ * test_oled_menu.c
+ *
+ *  Created on: Mar 23, 2026
+ */
+
+// メニューをキーとポットの操作列で動かして、カーソル・編集・ページの出入りと描いた画面を確かめる
+//   build/test_oled_menu        確かめるだけ
+//   build/test_oled_menu -v     サブメニューを描いた画面も出す
+
+#include "oled_menu.h"
+
+#include "test.h"
+
+#include <stddef.h>
+
+typedef struct
+{
+    uint8_t a;
+    uint8_t b;
+    uint8_t cut[2];
+} cfg_t;
+
+static const char* const k_yn[]  = {"No", "Yes"};
+static const char* const k_abc[] = {"A", "B", "C"};
+static const uint8_t k_abc_val[] = {10, 20, 30};
+
+static const oled_menu_item_t k_sub_items[] = {
+    {.label = "Cut", .kind = OLED_MENU_INT, .field = offsetof(cfg_t, cut[0]), .min = 0, .max = 127, .step = 1},
+    {.label = "Src", .kind = OLED_MENU_ENUM, .field = offsetof(cfg_t, b), .max = 2, .names = k_abc, .values = k_abc_val},
+};
+static const oled_menu_page_t k_sub = {"Sub", k_sub_items, ARRAY_SIZE(k_sub_items)};
+
+// 7 行に入らない数にしてスクロールも見る
+static const oled_menu_item_t k_root_items[] = {
+    {.label = "Flag", .kind = OLED_MENU_ENUM, .field = offsetof(cfg_t, a), .max = 1, .names = k_yn},
+    {.label = "Sub", .kind = OLED_MENU_SUBMENU, .sub = &k_sub},
+    {.label = "Save", .kind = OLED_MENU_ACTION, .action = 7},
+    {.label = "X1", .kind = OLED_MENU_ACTION, .action = 1},
+    {.label = "X2", .kind = OLED_MENU_ACTION, .action = 2},
+    {.label = "X3", .kind = OLED_MENU_ACTION, .action = 3},
+    {.label = "X4", .kind = OLED_MENU_ACTION, .action = 4},
+    {.label = "X5", .kind = OLED_MENU_ACTION, .action = 5},
+    {.label = "X6", .kind = OLED_MENU_ACTION, .action = 6},
+};
+static const oled_menu_page_t k_root = {"Root", k_root_items, ARRAY_SIZE(k_root_items)};
+
+static int s_changes;
+static int s_last_action = -1;
+
+static void on_change(void* ctx, const oled_menu_item_t* item)
+{
+    s_changes++;
+}
+
+static bool on_action(void* ctx, uint8_t action)
+{
+    s_last_action = action;
+    return true;
+}
+
+static void mem_command(ssd1306_t* d, uint8_t byte)
+{
+}
+
+static void mem_update(ssd1306_t* d, uint8_t page_start, uint8_t page_end, uint8_t col_start, uint8_t col_end)
+{
+}
+
+// メモリに描くだけの転送
+static const ssd1306_ops_t s_mem_ops = {.command = mem_command, .update = mem_update};
+
+static uint8_t s_fb[128 * 64 / 8];
+static ssd1306_t s_disp = {.ops = &s_mem_ops, .fb = s_fb, .port = 1, .width = 128, .height = 64};
+
+static cfg_t s_cfg;
+static oled_menu_t s_menu;
+
+static uint8_t fb_byte(uint8_t page, uint8_t x)
+{
+    return s_fb[page * 128U + x];
+}
+
+static void dump(void)
+{
+    for (uint32_t y = 0; y < 64U; y++)
+    {
+        for (uint32_t x = 0; x < 128U; x++)
+        {
+            putchar(((s_fb[(y / 8U) * 128U + x] >> (y % 8U)) & 1U) ? '#' : '.');
+        }
+        putchar('\n');
+    }
+}
+
+static void key(uint8_t k)
+{
+    oled_menu_key(&s_menu, k);
+}
+
+// 開いた画面: 1 行目がタイトル、行全体の反転がカーソル。編集中は値のところだけ反転する
+static void test_open_and_layout(void)
+{
+    s_cfg  = (cfg_t) {.a = 0, .b = 20, .cut = {5, 0}};
+    s_menu = (oled_menu_t) {.on_change = on_change, .on_action = on_action};
+    ssd1306_Init(&s_disp);
+
+    oled_menu_open(&s_menu, &k_root, (uint8_t*) &s_cfg, sizeof(s_cfg));
+    CHECK(oled_menu_is_open(&s_menu));
+    CHECK_EQ(s_menu.depth, 1);
+    CHECK(oled_menu_draw(&s_menu, &s_disp));
+    CHECK(!oled_menu_draw(&s_menu, &s_disp));  // 変わっていなければ描かない
+
+    CHECK_EQ(fb_byte(0, 64), 0xFF);  // タイトル
+    CHECK_EQ(fb_byte(1, 64), 0xFF);  // カーソルの行 (Flag)
+    CHECK_EQ(fb_byte(2, 64), 0x00);  // Sub
+
+    key(OLED_MENU_KEY_ENTER);
+    CHECK(s_menu.editing);
+    CHECK(oled_menu_draw(&s_menu, &s_disp));
+    CHECK_EQ(fb_byte(1, 64), 0x00);   // ラベル側は戻る
+    CHECK_EQ(fb_byte(1, 115), 0xFF);  // "No" の 1 列前から右端まで
+    CHECK_EQ(fb_byte(1, 127), 0xFF);
+    key(OLED_MENU_KEY_BACK);
+}
+
+// ENUM は端で折り返す。BACK で開始時の値に戻し、ENTER で決める
+static void test_enum_edit(void)
+{
+    char buf[8];
+
+    s_changes = 0;
+    key(OLED_MENU_KEY_ENTER);
+    key(OLED_MENU_KEY_NEXT);
+    CHECK_EQ(s_cfg.a, 1);
+    key(OLED_MENU_KEY_NEXT);
+    CHECK_EQ(s_cfg.a, 0);
+    key(OLED_MENU_KEY_PREV);
+    CHECK_EQ(s_cfg.a, 1);
+    key(OLED_MENU_KEY_BACK);
+    CHECK(!s_menu.editing);
+    CHECK_EQ(s_cfg.a, 0);
+    CHECK_EQ(s_menu.depth, 1);
+    CHECK_EQ(s_changes, 4);  // 3 回動かして 1 回戻した
+
+    key(OLED_MENU_KEY_ENTER);
+    key(OLED_MENU_KEY_NEXT);
+    key(OLED_MENU_KEY_ENTER);
+    CHECK(!s_menu.editing);
+    CHECK_EQ(s_cfg.a, 1);
+    CHECK(s_menu.changed);
+    CHECK(strcmp(oled_menu_value_str(&s_menu, &k_root_items[0], buf, sizeof(buf)), "Yes") == 0);
+}
+
+// カーソルは端で折り返し、画面に入るように先頭の項目をずらす
+static void test_cursor_scroll(void)
+{
+    key(OLED_MENU_KEY_PREV);
+    CHECK_EQ(s_menu.stack[0].cursor, 8);
+    oled_menu_draw(&s_menu, &s_disp);
+    CHECK_EQ(s_menu.stack[0].top, 2);
+    key(OLED_MENU_KEY_NEXT);
+    CHECK_EQ(s_menu.stack[0].cursor, 0);
+    oled_menu_draw(&s_menu, &s_disp);
+    CHECK_EQ(s_menu.stack[0].top, 0);
+
+    key(OLED_MENU_KEY_NEXT);
+    key(OLED_MENU_KEY_NEXT);
+    key(OLED_MENU_KEY_ENTER);
+    CHECK_EQ(s_last_action, 7);
+    CHECK(!s_menu.editing);
+}
+
+// サブメニューに入って INT を端で止める。ポットは最初の位置を基準に、全域 / OLED_MENU_POT_DETENTS ごとに 1 段
+static void test_submenu_int_and_pot(void)
+{
+    key(OLED_MENU_KEY_PREV);
+    key(OLED_MENU_KEY_ENTER);
+    CHECK_EQ(s_menu.depth, 2);
+    CHECK(oled_menu_current(&s_menu) == &k_sub_items[0]);
+
+    key(OLED_MENU_KEY_ENTER);
+    for (uint32_t i = 0; i < 10U; i++)
+    {
+        key(OLED_MENU_KEY_PREV);
+    }
+    CHECK_EQ(s_cfg.cut[0], 0);
+
+    const uint16_t detent = 4096U / OLED_MENU_POT_DETENTS;
+    oled_menu_pot(&s_menu, 1000, 4095);
+    CHECK_EQ(s_cfg.cut[0], 0);
+    oled_menu_pot(&s_menu, (uint16_t) (1000U + detent - 1U), 4095);
+    CHECK_EQ(s_cfg.cut[0], 0);
+    oled_menu_pot(&s_menu, (uint16_t) (1000U + detent), 4095);
+    CHECK_EQ(s_cfg.cut[0], 1);
+    oled_menu_pot(&s_menu, 4095, 4095);
+    CHECK_EQ(s_cfg.cut[0], 18);
+    oled_menu_pot(&s_menu, 0, 4095);
+    CHECK_EQ(s_cfg.cut[0], 0);
+    key(OLED_MENU_KEY_ENTER);
+    CHECK(!s_menu.editing);
+
+    // 編集していない時はポットでカーソルが動く (端で止まる)
+    oled_menu_pot(&s_menu, 0, 4095);
+    oled_menu_pot(&s_menu, 200, 4095);
+    CHECK(oled_menu_current(&s_menu) == &k_sub_items[1]);
+    oled_menu_pot(&s_menu, 4000, 4095);
+    CHECK_EQ(s_menu.stack[1].cursor, 1);
+
+    // values のある ENUM は表の値を書く
+    key(OLED_MENU_KEY_ENTER);
+    key(OLED_MENU_KEY_NEXT);
+    CHECK_EQ(s_cfg.b, 30);
+    key(OLED_MENU_KEY_NEXT);
+    CHECK_EQ(s_cfg.b, 10);
+    oled_menu_pot(&s_menu, 4000, 4095);
+    oled_menu_pot(&s_menu, 0, 4095);
+    CHECK_EQ(s_cfg.b, 10);
+    key(OLED_MENU_KEY_ENTER);
+    CHECK(oled_menu_draw(&s_menu, &s_disp));
+}
+
+// BACK で 1 つずつ戻り、一番上で閉じる。閉じた後のキーとポットは何もしない
+static void test_back_and_close(void)
+{
+    key(OLED_MENU_KEY_BACK);
+    CHECK_EQ(s_menu.depth, 1);
+    CHECK_EQ(s_menu.stack[0].cursor, 1);
+    key(OLED_MENU_KEY_BACK);
+    CHECK(!oled_menu_is_open(&s_menu));
+    key(OLED_MENU_KEY_BACK);
+    CHECK_EQ(s_menu.depth, 0);
+    oled_menu_pot(&s_menu, 100, 4095);
+    CHECK_EQ(s_menu.depth, 0);
+
+    CHECK(oled_menu_draw(&s_menu, &s_disp));
+    CHECK_EQ(fb_byte(0, 64), 0x00);  // 閉じたら消す
+}
+
+int main(int argc, char** argv)
+{
+    test_open_and_layout();
+    test_enum_edit();
+    test_cursor_scroll();
+    test_submenu_int_and_pot();
+    if ((argc > 1) && (strcmp(argv[1], "-v") == 0))
+    {
+        dump();
+    }
+    test_back_and_close();
+    return test_done("oled_menu");
+}
@@ -0,0 +1,252 @@
+/*
+ * test_oled_sched.c
+ *
+ *  Created on: Mar 23, 2026
+ */
+
+// 領域の描き直しの順番を oled_control.c と同じ領域・予算 (600 byte/フレーム) で回す
+// - 1 フレームで選ぶ見積もりの合計は予算以内 (予算より大きい領域はフレームの最初に 1 つだけ)
+// - 描く前に何度 post しても 1 回だけ描き、間隔 (period_ms) より早くは描かない
+// - 状態の変化 (ALERT) が先、同じ優先度では長く待っている方が先
+// - ALERT が毎フレーム続いても、予算で回された大きい領域 (スペクトラム) が止まらない
+
+#include "oled_sched.h"
+
+#include "test.h"
+
+#define BUDGET   600U
+#define FRAME_MS 16U
+
+enum
+{
+    RGN_CH2 = 0,
+    RGN_METERS,
+    RGN_GRAPHS,
+    RGN_SPECTRUM,
+    RGN_SRC_P,
+    RGN_MENU,
+    RGN_NUM,
+};
+
+static const oled_sched_region_def_t k_defs[RGN_NUM] = {
+    [RGN_CH2]      = {0, 0, 63, 10, 100, OLED_SCHED_PRIO_VALUE},
+    [RGN_METERS]   = {8, 1, 127, 13, 33, OLED_SCHED_PRIO_VALUE},
+    [RGN_GRAPHS]   = {0, 17, 127, 30, 33, OLED_SCHED_PRIO_VALUE},
+    [RGN_SPECTRUM] = {0, 32, 127, 63, 50, OLED_SCHED_PRIO_VALUE},
+    [RGN_SRC_P]    = {0, 50, 127, 59, 0, OLED_SCHED_PRIO_ALERT},
+    [RGN_MENU]     = {0, 0, 127, 63, 40, OLED_SCHED_PRIO_ALERT},
+};
+
+static oled_sched_t s_sched;
+
+static void setup(void)
+{
+    oled_sched_init(&s_sched, BUDGET);
+    for (uint8_t i = 0; i < RGN_NUM; i++)
+    {
+        CHECK_EQ(oled_sched_add(&s_sched, &k_defs[i]), i);
+    }
+}
+
+static uint32_t frame_cost(const uint8_t* list, uint8_t n)
+{
+    uint32_t sum = 0;
+    for (uint8_t i = 0; i < n; i++)
+    {
+        sum += s_sched.region[list[i]].cost;
+    }
+    return sum;
+}
+
+static bool contains(const uint8_t* list, uint8_t n, uint8_t rgn)
+{
+    for (uint8_t i = 0; i < n; i++)
+    {
+        if (list[i] == rgn)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void test_cost(void)
+{
+    // ページ x 列 + OLED_DIRTY_XFER_COST (16)
+    CHECK_EQ(oled_sched_cost(0, 0, 63, 10), 2U * 64U + 16U);
+    CHECK_EQ(oled_sched_cost(8, 1, 127, 13), 2U * 120U + 16U);
+    CHECK_EQ(oled_sched_cost(0, 32, 127, 63), 4U * 128U + 16U);
+    CHECK_EQ(oled_sched_cost(0, 7, 0, 8), 2U + 16U);  // ページの境目をまたぐ
+    CHECK_EQ(oled_sched_cost(5, 0, 4, 0), 0);
+
+    oled_sched_t full;
+    oled_sched_init(&full, BUDGET);
+    for (uint32_t i = 0; i < OLED_SCHED_REGION_MAX; i++)
+    {
+        CHECK_EQ(oled_sched_add(&full, &k_defs[0]), i);
+    }
+    CHECK_EQ(oled_sched_add(&full, &k_defs[0]), OLED_SCHED_REGION_MAX);
+    CHECK_EQ(oled_sched_add(&full, NULL), OLED_SCHED_REGION_MAX);
+}
+
+// 間隔の間に何度 post しても、間隔が過ぎてから最新の 1 回だけ
+static void test_coalesce(void)
+{
+    uint8_t list[RGN_NUM];
+    oled_sched_stats_t st;
+
+    setup();
+    oled_sched_post(&s_sched, RGN_CH2);
+    CHECK_EQ(oled_sched_frame(&s_sched, 1000U, list, RGN_NUM), 1);  // 最初の 1 回はすぐ
+    CHECK_EQ(list[0], RGN_CH2);
+    CHECK(!oled_sched_pending(&s_sched, RGN_CH2));
+
+    for (uint32_t t = 1010U; t < 1100U; t += 10U)
+    {
+        oled_sched_post(&s_sched, RGN_CH2);
+        CHECK_EQ(oled_sched_frame(&s_sched, t, list, RGN_NUM), 0);
+        CHECK(oled_sched_pending(&s_sched, RGN_CH2));
+    }
+    CHECK_EQ(oled_sched_frame(&s_sched, 1100U, list, RGN_NUM), 1);
+    CHECK_EQ(oled_sched_frame(&s_sched, 1300U, list, RGN_NUM), 0);  // post が無ければ描かない
+
+    oled_sched_take_stats(&s_sched, &st);
+    CHECK_EQ(st.drawn, 2);
+    CHECK_EQ(st.coalesced, 8);  // 9 回 post して描いたのは 1 回
+    CHECK_EQ(st.frames, 12);
+    CHECK_EQ(st.bytes, 2U * s_sched.region[RGN_CH2].cost);
+    oled_sched_take_stats(&s_sched, &st);
+    CHECK_EQ(st.frames, 0);
+
+    // 取り消したら描かない
+    oled_sched_post(&s_sched, RGN_CH2);
+    oled_sched_cancel(&s_sched, RGN_CH2);
+    CHECK_EQ(oled_sched_frame(&s_sched, 2000U, list, RGN_NUM), 0);
+
+    // 範囲外の番号は無視
+    oled_sched_post(&s_sched, RGN_NUM);
+    CHECK(!oled_sched_pending(&s_sched, RGN_NUM));
+}
+
+static void test_budget(void)
+{
+    uint8_t list[RGN_NUM];
+    uint8_t n;
+
+    // 全部 (メニュー以外) 待っている: ALERT が先、残りは予算に入るだけ
+    setup();
+    for (uint8_t i = 0; i < RGN_MENU; i++)
+    {
+        oled_sched_post(&s_sched, i);
+    }
+    n = oled_sched_frame(&s_sched, 0U, list, RGN_NUM);
+    CHECK(n >= 2U);
+    CHECK_EQ(list[0], RGN_SRC_P);
+    CHECK(frame_cost(list, n) <= BUDGET);
+    CHECK_EQ(s_sched.stats.bytes, frame_cost(list, n));
+    CHECK_EQ(s_sched.stats.deferred, RGN_MENU - n);
+
+    // 予算より大きいメニューは、フレームの最初なら 1 つだけ描く
+    setup();
+    oled_sched_post(&s_sched, RGN_MENU);
+    oled_sched_post(&s_sched, RGN_SRC_P);
+    oled_sched_post(&s_sched, RGN_CH2);
+    n = oled_sched_frame(&s_sched, 0U, list, RGN_NUM);
+    CHECK((n == 1U) || (frame_cost(list, n) <= BUDGET));
+    (void) oled_sched_frame(&s_sched, FRAME_MS, list, RGN_NUM);
+    (void) oled_sched_frame(&s_sched, 2U * FRAME_MS, list, RGN_NUM);
+    CHECK(!oled_sched_pending(&s_sched, RGN_MENU));
+    CHECK(!oled_sched_pending(&s_sched, RGN_SRC_P));
+    CHECK(!oled_sched_pending(&s_sched, RGN_CH2));
+
+    // out の大きさでも打ち切る
+    setup();
+    oled_sched_post(&s_sched, RGN_CH2);
+    oled_sched_post(&s_sched, RGN_METERS);
+    CHECK_EQ(oled_sched_frame(&s_sched, 0U, list, 1U), 1);
+    CHECK_EQ(oled_sched_frame(&s_sched, FRAME_MS, list, 1U), 1);
+    CHECK_EQ(oled_sched_frame(&s_sched, 2U * FRAME_MS, list, 1U), 0);
+}
+
+// 同じ優先度では長く待っている方から
+static void test_order(void)
+{
+    uint8_t list[RGN_NUM];
+
+    setup();
+    oled_sched_post(&s_sched, RGN_METERS);
+    oled_sched_post(&s_sched, RGN_GRAPHS);
+    CHECK_EQ(oled_sched_frame(&s_sched, 0U, list, RGN_NUM), 2);
+
+    // メーターを 40ms、グラフを 60ms 待たせると、グラフが先
+    oled_sched_post(&s_sched, RGN_GRAPHS);
+    CHECK_EQ(oled_sched_frame(&s_sched, 20U, list, RGN_NUM), 0);
+    oled_sched_post(&s_sched, RGN_METERS);
+    s_sched.region[RGN_METERS].last_ms = 20U;
+    CHECK_EQ(oled_sched_frame(&s_sched, 60U, list, RGN_NUM), 2);
+    CHECK_EQ(list[0], RGN_GRAPHS);
+    CHECK_EQ(list[1], RGN_METERS);
+
+    // 間隔 (33ms) より早くは描かない
+    oled_sched_post(&s_sched, RGN_METERS);
+    CHECK_EQ(oled_sched_frame(&s_sched, 92U, list, RGN_NUM), 0);
+    CHECK_EQ(oled_sched_frame(&s_sched, 93U, list, RGN_NUM), 1);
+}
+
+// サブ OLED のメーター画面を回しながら、ルーティングの文字 (ALERT) を毎フレーム変える
+// ALERT (272) + スペクトラム (528) は予算を超えるので、回された領域を先に描かないとスペクトラムは一度も描けない
+static void test_no_starvation(void)
+{
+    uint8_t list[RGN_NUM];
+    uint32_t last[RGN_NUM]  = {0};
+    uint32_t worst[RGN_NUM] = {0};
+    uint32_t drawn[RGN_NUM] = {0};
+    uint32_t over           = 0;
+
+    setup();
+    for (uint32_t t = 0; t < 5000U; t += FRAME_MS)
+    {
+        oled_sched_post(&s_sched, RGN_METERS);
+        oled_sched_post(&s_sched, RGN_GRAPHS);
+        oled_sched_post(&s_sched, RGN_SPECTRUM);
+        oled_sched_post(&s_sched, RGN_SRC_P);
+
+        const uint8_t n = oled_sched_frame(&s_sched, t, list, RGN_NUM);
+        if ((n > 1U) && (frame_cost(list, n) > BUDGET))
+        {
+            over++;
+        }
+        for (uint8_t r = 0; r < RGN_NUM; r++)
+        {
+            if (contains(list, n, r))
+            {
+                if ((drawn[r] != 0U) && ((t - last[r]) > worst[r]))
+                {
+                    worst[r] = t - last[r];
+                }
+                last[r] = t;
+                drawn[r]++;
+            }
+        }
+    }
+
+    printf("  worst gap: meters %u ms, graphs %u ms, spectrum %u ms, alert %u ms\n", worst[RGN_METERS], worst[RGN_GRAPHS],
+           worst[RGN_SPECTRUM], worst[RGN_SRC_P]);
+    CHECK_EQ(over, 0);
+    CHECK(drawn[RGN_SPECTRUM] >= 5000U / 200U);
+    // 回されても 3 フレーム以内には描く。ALERT は最大でも 1 フレーム遅れるだけ
+    CHECK(worst[RGN_METERS] <= 33U + 3U * FRAME_MS);
+    CHECK(worst[RGN_GRAPHS] <= 33U + 3U * FRAME_MS);
+    CHECK(worst[RGN_SPECTRUM] <= 50U + 3U * FRAME_MS);
+    CHECK(worst[RGN_SRC_P] <= 2U * FRAME_MS);
+}
+
+int main(void)
+{
+    test_cost();
+    test_coalesce();
+    test_budget();
+    test_order();
+    test_no_starvation();
+    return test_done("oled_sched");
+}
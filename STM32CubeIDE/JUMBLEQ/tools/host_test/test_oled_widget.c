@@ -0,0 +1,449 @@
+/*
+ * test_oled_widget.c
+ *
+ *  Created on: Mar 23, 2026
+ */
+
+// メーター・履歴グラフ・スペクトラムをサブ OLED と同じ 128x64 のフレームバッファに描いて、画素で確かめる
+// - 描いた画面を 1 画素ずつ作り直した期待値と比べる (差分だけ描き直しても、最初から描いた画面と同じになる)
+// - 変わったバイトは必ず dirty に入る
+// - 正弦波を Hann 窓 + 512 点 FFT + 32 バンドに通すと、その周波数のバンドが一番高く、レベルが振幅どおり
+//   build/test_oled_widget        確かめるだけ
+//   build/test_oled_widget -p     描いた画面を build/oled_widget_*.pbm に書き出す
+
+#include "oled_widget.h"
+
+#include "audio_spectrum.h"
+
+#include "test.h"
+
+#include <math.h>
+
+#define W     128U
+#define H     64U
+#define PAGES (H / 8U)
+
+// oled_control.c と同じ配置
+#define SPECTRUM_BANDS    32U
+#define SPECTRUM_FLOOR_DB -72.0f
+#define SPECTRUM_F_LO     40.0f
+#define SPECTRUM_F_HI     20000.0f
+
+static const oled_meter_def_t k_meter_def = {.x = 8, .y = 1, .w = 120, .h = 5, .hold_ms = 1000, .fall_per_s = 120};
+
+static const oled_spectrum_def_t k_spectrum_def = {
+    .x          = 0,
+    .y          = 32,
+    .w          = W,
+    .h          = 32,
+    .bands      = SPECTRUM_BANDS,
+    .band_w     = (W / SPECTRUM_BANDS) - 1U,
+    .hold_ms    = 600,
+    .fall_per_s = 400,
+};
+
+static uint8_t s_fb[W * PAGES];
+static uint8_t s_before[W * PAGES];
+static uint8_t s_want[W * H];  // 期待値 (1 byte = 1 画素)
+static oled_dirty_t s_dirty;
+static const oled_canvas_t s_canvas = {.fb = s_fb, .width = W, .height = H, .dirty = &s_dirty};
+static bool s_pbm;
+
+static bool pixel(uint32_t x, uint32_t y)
+{
+    return ((s_fb[(y / 8U) * W + x] >> (y % 8U)) & 1U) != 0U;
+}
+
+static void want_clear(void)
+{
+    memset(s_want, 0, sizeof(s_want));
+}
+
+static void want_set(uint32_t x, uint32_t y)
+{
+    if ((x < W) && (y < H))
+    {
+        s_want[y * W + x] = 1U;
+    }
+}
+
+// 期待値と違う画素の数
+static uint32_t diff_pixels(void)
+{
+    uint32_t n = 0;
+    for (uint32_t y = 0; y < H; y++)
+    {
+        for (uint32_t x = 0; x < W; x++)
+        {
+            n += (pixel(x, y) != (s_want[y * W + x] != 0U)) ? 1U : 0U;
+        }
+    }
+    return n;
+}
+
+static void begin_draw(void)
+{
+    memcpy(s_before, s_fb, sizeof(s_fb));
+    oled_dirty_clear(&s_dirty);
+}
+
+// 前回から変わったバイトで dirty に入っていないものの数
+static uint32_t unmarked_changes(void)
+{
+    uint32_t n = 0;
+    for (uint32_t p = 0; p < PAGES; p++)
+    {
+        for (uint32_t x = 0; x < W; x++)
+        {
+            const bool changed = s_fb[p * W + x] != s_before[p * W + x];
+            const bool marked  = (x >= s_dirty.col_min[p]) && (x <= s_dirty.col_max[p]);
+            n += (changed && !marked) ? 1U : 0U;
+        }
+    }
+    return n;
+}
+
+static void write_pbm(const char* name)
+{
+    char path[64];
+    if (!s_pbm)
+    {
+        return;
+    }
+    snprintf(path, sizeof(path), "build/oled_widget_%s.pbm", name);
+    FILE* f = fopen(path, "w");
+    if (f == NULL)
+    {
+        return;
+    }
+    fprintf(f, "P1\n%u %u\n", W, H);
+    for (uint32_t y = 0; y < H; y++)
+    {
+        for (uint32_t x = 0; x < W; x++)
+        {
+            fputc(pixel(x, y) ? '1' : '0', f);
+        }
+        fputc('\n', f);
+    }
+    fclose(f);
+}
+
+// 0..255 を 0..span px に (四捨五入)
+static uint32_t px(uint32_t level, uint32_t span)
+{
+    return (level * span + 127U) / 255U;
+}
+
+static void want_meter(uint32_t level, uint32_t peak)
+{
+    const oled_meter_def_t* d = &k_meter_def;
+    const uint32_t len        = px(level, d->w);
+    const uint32_t pk         = px(peak, d->w);
+
+    for (uint32_t col = 0; col < d->w; col++)
+    {
+        if ((col < len) || ((pk != 0U) && (col == pk - 1U)))
+        {
+            for (uint32_t r = 0; r < d->h; r++)
+            {
+                want_set(d->x + col, d->y + r);
+            }
+        }
+    }
+}
+
+static void test_meter(void)
+{
+    oled_meter_t m;
+
+    memset(s_fb, 0, sizeof(s_fb));
+    oled_meter_init(&m, &k_meter_def);
+
+    // 半分 (60px) まで。ピークはバーの端と同じ列
+    begin_draw();
+    oled_meter_update(&m, 128U, 0U);
+    oled_meter_draw(&m, &s_canvas);
+    want_clear();
+    want_meter(128U, 128U);
+    CHECK_EQ(diff_pixels(), 0);
+    CHECK_EQ(unmarked_changes(), 0);
+    CHECK(pixel(8U, 1U) && pixel(8U, 5U) && !pixel(8U, 0U) && !pixel(8U, 6U));
+    CHECK(pixel(8U + 59U, 3U) && !pixel(8U + 60U, 3U));
+    CHECK(!pixel(7U, 3U));
+
+    // 下がるとピークは hold_ms だけ残る
+    begin_draw();
+    oled_meter_update(&m, 64U, 500U);
+    oled_meter_draw(&m, &s_canvas);
+    want_clear();
+    want_meter(64U, 128U);
+    CHECK_EQ(diff_pixels(), 0);
+    CHECK_EQ(unmarked_changes(), 0);
+    CHECK(pixel(8U + 29U, 3U) && !pixel(8U + 30U, 3U) && pixel(8U + 59U, 3U));
+    write_pbm("meter");
+
+    // hold 後 500ms で 60 下がる: 128 → 68
+    begin_draw();
+    oled_meter_update(&m, 0U, 1500U);
+    oled_meter_draw(&m, &s_canvas);
+    CHECK_EQ(m.peak.value, 68);
+    want_clear();
+    want_meter(0U, 68U);
+    CHECK_EQ(diff_pixels(), 0);
+    CHECK_EQ(unmarked_changes(), 0);
+
+    // 変わらなければ何も書かない
+    begin_draw();
+    oled_meter_update(&m, 0U, 1500U);
+    oled_meter_draw(&m, &s_canvas);
+    CHECK(!oled_dirty_any(&s_dirty));
+
+    // フルスケールは右端まで
+    begin_draw();
+    oled_meter_update(&m, 255U, 1600U);
+    oled_meter_draw(&m, &s_canvas);
+    want_clear();
+    want_meter(255U, 255U);
+    CHECK_EQ(diff_pixels(), 0);
+    CHECK(pixel(127U, 5U));
+}
+
+static uint64_t graph_col(const oled_graph_t* g, uint32_t i)
+{
+    uint64_t bits = 0;
+    for (uint32_t r = 0; r < g->h; r++)
+    {
+        bits |= (uint64_t) (pixel(g->x + i, g->y + r) ? 1U : 0U) << r;
+    }
+    return bits;
+}
+
+static uint64_t rows(uint32_t lo, uint32_t hi)
+{
+    return ((((uint64_t) 1U) << (hi + 1U)) - 1U) & ~((((uint64_t) 1U) << lo) - 1U);
+}
+
+static void test_graph(void)
+{
+    oled_graph_t g;
+    static const uint8_t k_vals[] = {0, 0, 255, 255, 128, 128, 0, 0};
+
+    // oled_control.c の左のグラフ (高さ 14 = 2 ページにまたがる) を 8 列で
+    memset(s_fb, 0, sizeof(s_fb));
+    oled_graph_init(&g, 0, 17, ARRAY_SIZE(k_vals), 14);
+    for (uint32_t i = 0; i < ARRAY_SIZE(k_vals); i++)
+    {
+        oled_graph_push(&g, k_vals[i]);
+    }
+    begin_draw();
+    oled_graph_draw(&g, &s_canvas);
+    CHECK_EQ(unmarked_changes(), 0);
+    write_pbm("graph");
+
+    // 0 は一番下 (13 行目)、255 は一番上、128 は 13 - 7 = 6 行目。隣の点とは縦線でつなぐ
+    const uint64_t k_want[] = {rows(13, 13), rows(13, 13), rows(0, 13), rows(0, 0),
+                               rows(0, 6),   rows(6, 6),   rows(6, 13), rows(13, 13)};
+    for (uint32_t i = 0; i < ARRAY_SIZE(k_want); i++)
+    {
+        CHECK_EQ(graph_col(&g, i), k_want[i]);
+    }
+    CHECK(!pixel(0U, 16U) && !pixel(2U, 31U) && !pixel(8U, 30U));
+
+    // 流れる: 1 つ足すと全体が左に 1 列ずれて、右端が新しい値
+    oled_graph_push(&g, 255U);
+    begin_draw();
+    oled_graph_draw(&g, &s_canvas);
+    CHECK_EQ(unmarked_changes(), 0);
+    for (uint32_t i = 0; i + 1U < ARRAY_SIZE(k_want); i++)
+    {
+        CHECK_EQ(graph_col(&g, i), (i == 0U) ? rows(13, 13) : k_want[i + 1U]);
+    }
+    CHECK_EQ(graph_col(&g, 7U), rows(0, 13));
+
+    // push がなければ描かない
+    begin_draw();
+    oled_graph_draw(&g, &s_canvas);
+    CHECK(!oled_dirty_any(&s_dirty));
+}
+
+static void want_spectrum(const uint8_t* level, const uint8_t* peak)
+{
+    const oled_spectrum_def_t* d = &k_spectrum_def;
+
+    for (uint32_t b = 0; b < d->bands; b++)
+    {
+        const uint32_t len = px(level[b], d->h);
+        const uint32_t pk  = px(peak[b], d->h);
+        for (uint32_t k = 0; k < d->band_w; k++)
+        {
+            const uint32_t x = d->x + b * (d->band_w + 1U) + k;
+            for (uint32_t r = d->h - len; r < d->h; r++)
+            {
+                want_set(x, d->y + r);
+            }
+            if (pk != 0U)
+            {
+                want_set(x, d->y + d->h - pk);
+            }
+        }
+    }
+}
+
+static void test_spectrum_draw(void)
+{
+    oled_spectrum_t s;
+    uint8_t in[SPECTRUM_BANDS];
+    uint8_t zero[SPECTRUM_BANDS] = {0};
+
+    for (uint32_t b = 0; b < SPECTRUM_BANDS; b++)
+    {
+        in[b] = (uint8_t) (b * 8U);
+    }
+
+    memset(s_fb, 0, sizeof(s_fb));
+    oled_spectrum_init(&s, &k_spectrum_def);
+    begin_draw();
+    oled_spectrum_update(&s, in, 0U);
+    oled_spectrum_draw(&s, &s_canvas);
+    want_clear();
+    want_spectrum(in, in);
+    CHECK_EQ(diff_pixels(), 0);
+    CHECK_EQ(unmarked_changes(), 0);
+    write_pbm("spectrum");
+
+    // バーは 3px + 隙間 1px。一番右 (248 → 31px) は 33 行目から下
+    CHECK(pixel(124U, 33U) && pixel(126U, 63U) && !pixel(127U, 63U) && !pixel(124U, 32U));
+    CHECK(!pixel(0U, 63U) && !pixel(3U, 63U));
+
+    // 無音にすると hold_ms の間、バーは fall_per_s で下がりピークは残る
+    begin_draw();
+    oled_spectrum_update(&s, zero, 500U);
+    oled_spectrum_draw(&s, &s_canvas);
+    uint8_t level[SPECTRUM_BANDS];
+    for (uint32_t b = 0; b < SPECTRUM_BANDS; b++)
+    {
+        level[b] = (in[b] > 200U) ? (uint8_t) (in[b] - 200U) : 0U;
+        CHECK_EQ(s.level[b], level[b]);
+        CHECK_EQ(s.peak[b].value, in[b]);
+    }
+    want_clear();
+    want_spectrum(level, in);
+    CHECK_EQ(diff_pixels(), 0);
+    CHECK_EQ(unmarked_changes(), 0);
+
+    // 最初から描いても同じ画面
+    oled_spectrum_t fresh = s;
+    fresh.drawn           = false;
+    memcpy(s_before, s_fb, sizeof(s_fb));
+    memset(s_fb, 0, sizeof(s_fb));
+    oled_spectrum_draw(&fresh, &s_canvas);
+    CHECK(memcmp(s_fb, s_before, sizeof(s_fb)) == 0);
+}
+
+typedef struct
+{
+    float hz;
+    float amp;         // フルスケール比
+    float scallop_db;  // bin の間に来た時の Hann のへこみの上限
+    uint8_t band;
+} sine_case_t;
+
+static const sine_case_t k_sines[] = {
+    {3000.0f, 0.5f, 0.05f, 22},    // bin 32 ちょうど
+    {1000.0f, 0.5f, 1.45f, 10},    // bin 10.67
+    {10031.25f, 0.1f, 0.05f, 28},  // bin 107
+    {187.5f, 1.0f, 0.05f, 1},      // bin 2 (低い方は 1 bin ずつのバンド)
+};
+
+static void test_spectrum_sine(void)
+{
+    static audio_spectrum_t a;
+    static int32_t samples[AUDIO_SPECTRUM_N];
+    float db[SPECTRUM_BANDS];
+    const uint32_t rate = 48000U;
+
+    audio_spectrum_init(&a, SPECTRUM_BANDS, rate, SPECTRUM_F_LO, SPECTRUM_F_HI);
+    CHECK_EQ(a.bands, SPECTRUM_BANDS);
+    CHECK_EQ(a.edge[0], 1);  // 40Hz は bin 0 に丸まるが、DC は入れない
+    CHECK_EQ(a.edge[SPECTRUM_BANDS], AUDIO_SPECTRUM_N / 2U - 43U);  // 20kHz = bin 213
+    for (uint32_t b = 0; b < SPECTRUM_BANDS; b++)
+    {
+        CHECK(a.edge[b] < a.edge[b + 1U]);
+    }
+
+    for (uint32_t c = 0; c < ARRAY_SIZE(k_sines); c++)
+    {
+        const sine_case_t* s = &k_sines[c];
+        for (uint32_t i = 0; i < AUDIO_SPECTRUM_N; i++)
+        {
+            const double v = s->amp * 2147483647.0 * sin(2.0 * M_PI * s->hz * i / rate);
+            samples[i]     = (int32_t) lround(v);
+        }
+        audio_spectrum_process(&a, samples, db);
+
+        // 一番近い bin を含むバンド
+        const uint32_t bin = (uint32_t) lroundf(s->hz / ((float) rate / AUDIO_SPECTRUM_N));
+        uint32_t want      = 0;
+        while ((want + 1U < SPECTRUM_BANDS) && (a.edge[want + 1U] <= bin))
+        {
+            want++;
+        }
+
+        uint32_t top = 0;
+        for (uint32_t b = 1; b < SPECTRUM_BANDS; b++)
+        {
+            top = (db[b] > db[top]) ? b : top;
+        }
+        const float amp_db = 20.0f * log10f(s->amp);
+        printf("  %.1fHz: band %u (want %u) %.2f dB (want %.2f)\n", s->hz, top, want, db[top], amp_db);
+        CHECK_EQ(top, want);
+        CHECK_EQ(top, s->band);
+        CHECK(db[top] <= amp_db + 0.05f);
+        CHECK(db[top] >= amp_db - s->scallop_db);
+
+        // 8 bin 以上離れたバンドは -60dB より下 (Hann のサイドローブ)
+        for (uint32_t b = 0; b < SPECTRUM_BANDS; b++)
+        {
+            if ((a.edge[b + 1U] + 7U <= bin) || (a.edge[b] >= bin + 8U))
+            {
+                CHECK(db[b] < amp_db - 60.0f);
+            }
+        }
+
+        // 表示 (-72dB..0dB → 0..255 → 32px) でもそのバンドが一番高い
+        uint8_t level[SPECTRUM_BANDS];
+        oled_spectrum_t sp;
+        for (uint32_t b = 0; b < SPECTRUM_BANDS; b++)
+        {
+            level[b] = oled_widget_db_to_level(db[b], SPECTRUM_FLOOR_DB);
+        }
+        memset(s_fb, 0, sizeof(s_fb));
+        oled_spectrum_init(&sp, &k_spectrum_def);
+        oled_spectrum_update(&sp, level, 0U);
+        oled_spectrum_draw(&sp, &s_canvas);
+        const uint32_t bar = px(oled_widget_db_to_level(amp_db, SPECTRUM_FLOOR_DB), k_spectrum_def.h);
+        const uint32_t x   = top * 4U + 1U;
+        CHECK(pixel(x, 64U - bar + 1U));
+        CHECK(!pixel(x, 64U - bar - 2U));
+    }
+
+    // 無音は床
+    memset(samples, 0, sizeof(samples));
+    audio_spectrum_process(&a, samples, db);
+    for (uint32_t b = 0; b < SPECTRUM_BANDS; b++)
+    {
+        CHECK(db[b] == -120.0f);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    s_pbm = (argc > 1) && (strcmp(argv[1], "-p") == 0);
+    oled_dirty_init(&s_dirty, W, PAGES);
+
+    test_meter();
+    test_graph();
+    test_spectrum_draw();
+    test_spectrum_sine();
+    return test_done("oled_widget");
+}
@@ -0,0 +1,231 @@
+/*
+ * test_pot_filter.c
+ *
+ *  Created on: Mar 23, 2026
+ */
+
+// ポットのフィルターに ADC の列を流して、ノイズで出た更新の数 [回/s] とステップ応答の遅れ [ms] を測る
+//   build/test_pot_filter                     合成した列 (ノイズ + ステップ + ランプ) で確認する
+//   build/test_pot_filter trace.txt [bits]    記録した列 (1 行 1 サンプル、POT_FILTER_RATE_HZ 間隔の 12bit 値) を流す
+// 実機で記録する時は ui_control.c の adc_val[ch][POT_ADC_RANK] (フィルター前) をポットが動いている間 2ms 毎に書き出す
+
+#include "pot_filter.h"
+
+#include "test.h"
+
+#include <stdlib.h>
+
+#define SAMPLE_MS   (1000U / POT_FILTER_RATE_HZ)
+#define NOISE_LSB   6  // 実機の静止時の振れ (+-)
+#define STATIC_SECS 10U
+
+static uint32_t s_rng;
+
+// 測定毎に同じノイズ列から始める
+static void noise_reset(void)
+{
+    s_rng = 1U;
+}
+
+static int noise(void)
+{
+    s_rng = s_rng * 1103515245U + 12345U;
+    return (int) ((s_rng >> 16) % (2U * NOISE_LSB + 1U)) - NOISE_LSB;
+}
+
+static uint32_t clamp12(int v)
+{
+    return (v < 0) ? 0U : ((v > 4095) ? 4095U : (uint32_t) v);
+}
+
+typedef struct
+{
+    uint32_t updates;  // 最初の 1 回を除いた出力の変化
+    uint32_t samples;
+} replay_t;
+
+static void replay(pot_filter_t* f, const uint32_t* trace, uint32_t n, replay_t* r)
+{
+    for (uint32_t i = 0; i < n; i++)
+    {
+        const bool first = !f->primed;
+        if (pot_filter_update(f, trace[i]) && !first)
+        {
+            r->updates++;
+        }
+        r->samples++;
+    }
+}
+
+static double updates_per_sec(const replay_t* r)
+{
+    return (double) r->updates * POT_FILTER_RATE_HZ / (double) r->samples;
+}
+
+// 静止 (ノイズだけ) の間に出た更新
+static double static_jitter(uint8_t bits, int level)
+{
+    static uint32_t trace[STATIC_SECS * POT_FILTER_RATE_HZ];
+    pot_filter_t f;
+    replay_t r = {0};
+
+    noise_reset();
+    for (uint32_t i = 0; i < ARRAY_SIZE(trace); i++)
+    {
+        trace[i] = clamp12(level + noise());
+    }
+    pot_filter_init(&f, bits);
+    replay(&f, trace, ARRAY_SIZE(trace), &r);
+    return updates_per_sec(&r);
+}
+
+// from で落ち着いた後に to へ跳ばして、出力が to の 1 ステップ以内に入るまで [ms]
+static uint32_t step_latency_ms(uint8_t bits, int from, int to)
+{
+    pot_filter_t f;
+    const int target = to >> (POT_FILTER_IN_BITS - bits);
+
+    noise_reset();
+    pot_filter_init(&f, bits);
+    for (uint32_t i = 0; i < POT_FILTER_RATE_HZ; i++)
+    {
+        (void) pot_filter_update(&f, clamp12(from + noise()));
+    }
+    for (uint32_t i = 1; i <= POT_FILTER_RATE_HZ; i++)
+    {
+        (void) pot_filter_update(&f, clamp12(to + noise()));
+        if (abs((int) pot_filter_value(&f) - target) <= 1)
+        {
+            return i * SAMPLE_MS;
+        }
+    }
+    return UINT32_MAX;
+}
+
+// 全域を ramp_ms で回した時の最大の遅れ [出力ステップ]
+static int ramp_max_lag(uint8_t bits, uint32_t ramp_ms)
+{
+    pot_filter_t f;
+    const uint32_t n = ramp_ms / SAMPLE_MS;
+    int lag_max      = 0;
+
+    pot_filter_init(&f, bits);
+    (void) pot_filter_update(&f, 0U);
+    for (uint32_t i = 1; i <= n; i++)
+    {
+        const uint32_t raw = (i * 4095U) / n;
+        (void) pot_filter_update(&f, raw);
+        const int lag = (int) (raw >> (POT_FILTER_IN_BITS - bits)) - (int) pot_filter_value(&f);
+        if (lag > lag_max)
+        {
+            lag_max = lag;
+        }
+    }
+    return lag_max;
+}
+
+static void test_synthetic(void)
+{
+    static const uint8_t bits[] = {7U, 10U};  // CC のポット / ゲインのポット
+
+    for (uint32_t k = 0; k < ARRAY_SIZE(bits); k++)
+    {
+        const double jitter   = static_jitter(bits[k], 2000);
+        const uint32_t step   = step_latency_ms(bits[k], 1000, 3000);
+        const int lag_200ms   = ramp_max_lag(bits[k], 200U);
+        const double jitter_b = static_jitter(bits[k], 2048);  // 出力ステップの境目で止めた時
+
+        printf("  %2u bit: jitter %.2f/s (on edge %.2f/s), step %u ms, 200ms ramp lag %d steps\n", bits[k], jitter, jitter_b, step, lag_200ms);
+        CHECK(jitter <= 0.5);
+        CHECK(jitter_b <= 1.0);
+        CHECK(step <= 50U);
+        CHECK(lag_200ms <= (1 << (bits[k] - 3U)));  // 1/8 レンジ以内
+    }
+}
+
+static void test_params(void)
+{
+    pot_filter_params_t def;
+    pot_filter_params_t p;
+
+    pot_filter_get_params(&def);
+
+    CHECK(!pot_filter_set_params(NULL));
+    p               = def;
+    p.min_cutoff_q8 = 0U;
+    CHECK(!pot_filter_set_params(&p));
+    p               = def;
+    p.max_cutoff_q8 = (uint16_t) (def.min_cutoff_q8 - 1U);
+    CHECK(!pot_filter_set_params(&p));
+    p               = def;
+    p.max_cutoff_q8 = (uint16_t) (((POT_FILTER_RATE_HZ / 4U) << 8) + 1U);
+    CHECK(!pot_filter_set_params(&p));
+    p             = def;
+    p.d_cutoff_q8 = 0U;
+    CHECK(!pot_filter_set_params(&p));
+
+    pot_filter_get_params(&p);
+    CHECK(memcmp(&p, &def, sizeof(p)) == 0);  // 弾かれた時は変わらない
+
+    // ヒステリシスを無くすと境目でのジッタが増え、静止時のカットオフを上げるとステップが速くなる
+    const double edge_def = static_jitter(10U, 2048);
+    const uint32_t step_def = step_latency_ms(10U, 1000, 3000);
+    p         = def;
+    p.hyst_q8 = 0U;
+    CHECK(pot_filter_set_params(&p));
+    CHECK(static_jitter(10U, 2048) > edge_def);
+
+    p               = def;
+    p.min_cutoff_q8 = (uint16_t) (def.min_cutoff_q8 * 8U);
+    p.beta_q16      = 0U;
+    CHECK(pot_filter_set_params(&p));
+    const uint32_t step_fast = step_latency_ms(10U, 1000, 3000);
+    CHECK(step_fast < UINT32_MAX);
+
+    p               = def;
+    p.beta_q16      = 0U;
+    CHECK(pot_filter_set_params(&p));
+    CHECK(step_latency_ms(10U, 1000, 3000) > step_fast);  // 速度に追従しないと遅い
+
+    CHECK(pot_filter_set_params(&def));
+    CHECK_EQ(step_latency_ms(10U, 1000, 3000), step_def);
+}
+
+static int replay_file(const char* path, uint8_t bits)
+{
+    FILE* fp = fopen(path, "r");
+    static uint32_t trace[1U << 20];
+    uint32_t n = 0;
+    unsigned v;
+    pot_filter_t f;
+    replay_t r = {0};
+
+    if (fp == NULL)
+    {
+        perror(path);
+        return 2;
+    }
+    while ((n < ARRAY_SIZE(trace)) && (fscanf(fp, "%u", &v) == 1))
+    {
+        trace[n++] = clamp12((int) v);
+    }
+    fclose(fp);
+
+    pot_filter_init(&f, bits);
+    replay(&f, trace, n, &r);
+    printf("%s: %u samples (%.1f s), %u bit, %u updates, %.2f updates/s\n", path, n, (double) n / POT_FILTER_RATE_HZ, bits, r.updates,
+           updates_per_sec(&r));
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 1)
+    {
+        return replay_file(argv[1], (argc > 2) ? (uint8_t) atoi(argv[2]) : 7U);
+    }
+
+    test_synthetic();
+    test_params();
+    return test_done("pot_filter");
+}
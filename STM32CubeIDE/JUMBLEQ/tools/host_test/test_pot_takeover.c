@@ -0,0 +1,201 @@
+/*
+ * test_pot_takeover.c
+ *
+ *  Created on: Mar 23, 2026
+ */
+
+#include "pot_takeover.h"
+
+#include "test.h"
+
+#define FULL7  127U
+#define FULL10 1023U
+
+// 位置 20 で値がホストから 100 に変えられた状態
+static void setup(pot_takeover_t* t, uint16_t full, uint16_t pos, uint16_t value, uint8_t mode)
+{
+    pot_takeover_init(t, full);
+    (void) pot_takeover_update(t, mode, pos);
+    pot_takeover_set_value(t, value);
+}
+
+static void test_first_update(void)
+{
+    pot_takeover_t t;
+
+    // 起動直後は位置の値にする
+    pot_takeover_init(&t, FULL7);
+    CHECK(pot_takeover_update(&t, POT_TAKEOVER_PICKUP, 40));
+    CHECK_EQ(pot_takeover_value(&t), 40);
+    CHECK(pot_takeover_caught(&t));
+
+    // 位置が分かる前に値が来たら、最初の位置で判定する
+    pot_takeover_init(&t, FULL7);
+    pot_takeover_set_value(&t, 100);
+    CHECK(!pot_takeover_update(&t, POT_TAKEOVER_PICKUP, 40));
+    CHECK_EQ(pot_takeover_value(&t), 100);
+    CHECK(!pot_takeover_caught(&t));
+
+    pot_takeover_init(&t, FULL7);
+    pot_takeover_set_value(&t, 100);
+    (void) pot_takeover_update(&t, POT_TAKEOVER_PICKUP, 100);
+    CHECK(pot_takeover_caught(&t));
+
+    // 範囲外の値と位置は full に丸める
+    pot_takeover_init(&t, FULL7);
+    pot_takeover_set_value(&t, 500);
+    CHECK_EQ(pot_takeover_value(&t), FULL7);
+    (void) pot_takeover_update(&t, POT_TAKEOVER_JUMP, 300);
+    CHECK_EQ(t.pos, FULL7);
+}
+
+static void test_set_value(void)
+{
+    pot_takeover_t t;
+
+    setup(&t, FULL7, 20, 100, POT_TAKEOVER_PICKUP);
+    CHECK(!pot_takeover_caught(&t));
+    CHECK_EQ(pot_takeover_direction(&t), 1);
+
+    pot_takeover_set_value(&t, 5);
+    CHECK_EQ(pot_takeover_direction(&t), -1);
+
+    // キャッチの幅 (full / 64) 以内なら値を変えてもキャッチしたまま
+    pot_takeover_set_value(&t, 21);
+    CHECK(pot_takeover_caught(&t));
+    CHECK_EQ(pot_takeover_direction(&t), 0);
+    pot_takeover_set_value(&t, 22);
+    CHECK(!pot_takeover_caught(&t));
+}
+
+static void test_jump(void)
+{
+    pot_takeover_t t;
+
+    setup(&t, FULL7, 20, 100, POT_TAKEOVER_JUMP);
+    CHECK(pot_takeover_update(&t, POT_TAKEOVER_JUMP, 24));
+    CHECK_EQ(pot_takeover_value(&t), 24);
+    CHECK(pot_takeover_caught(&t));
+
+    // 知らないモードは JUMP と同じ
+    setup(&t, FULL7, 20, 100, POT_TAKEOVER_MODE_NUM);
+    CHECK(pot_takeover_update(&t, POT_TAKEOVER_MODE_NUM, 24));
+    CHECK_EQ(pot_takeover_value(&t), 24);
+}
+
+static void test_pickup(void)
+{
+    pot_takeover_t t;
+
+    // 値をまたぐまでは変えない
+    setup(&t, FULL7, 20, 100, POT_TAKEOVER_PICKUP);
+    for (uint16_t pos = 28; pos < 100; pos = (uint16_t) (pos + 8U))
+    {
+        CHECK(!pot_takeover_update(&t, POT_TAKEOVER_PICKUP, pos));
+        CHECK_EQ(pot_takeover_value(&t), 100);
+    }
+    // 92 → 108 で 100 をまたいだ
+    CHECK(pot_takeover_update(&t, POT_TAKEOVER_PICKUP, 108));
+    CHECK_EQ(pot_takeover_value(&t), 108);
+    CHECK(pot_takeover_caught(&t));
+    CHECK(pot_takeover_update(&t, POT_TAKEOVER_PICKUP, 60));
+    CHECK_EQ(pot_takeover_value(&t), 60);
+
+    // 離れる向きに動かしても変わらない
+    setup(&t, FULL7, 20, 100, POT_TAKEOVER_PICKUP);
+    CHECK(!pot_takeover_update(&t, POT_TAKEOVER_PICKUP, 0));
+    CHECK_EQ(pot_takeover_value(&t), 100);
+    CHECK_EQ(pot_takeover_direction(&t), 1);
+
+    // またがなくても幅以内に来たらキャッチ
+    setup(&t, FULL7, 20, 100, POT_TAKEOVER_PICKUP);
+    (void) pot_takeover_update(&t, POT_TAKEOVER_PICKUP, 99);
+    CHECK(pot_takeover_caught(&t));
+    CHECK_EQ(pot_takeover_value(&t), 99);
+}
+
+// 動かした向きに値が単調に進み、端で位置に合流する
+static void scale_sweep(uint16_t full, uint16_t from, uint16_t to, uint16_t value, uint16_t stride)
+{
+    pot_takeover_t t;
+    const bool up  = to > from;
+    uint16_t last  = value;
+    bool caught_at = false;
+
+    setup(&t, full, from, value, POT_TAKEOVER_SCALE);
+    CHECK(!pot_takeover_caught(&t));
+    for (uint16_t pos = from; pos != to;)
+    {
+        const uint16_t left = up ? (uint16_t) (to - pos) : (uint16_t) (pos - to);
+        const uint16_t step = (left < stride) ? left : stride;
+        pos                 = up ? (uint16_t) (pos + step) : (uint16_t) (pos - step);
+
+        (void) pot_takeover_update(&t, POT_TAKEOVER_SCALE, pos);
+        const uint16_t v = pot_takeover_value(&t);
+        CHECK(up ? (v >= last) : (v <= last));
+        CHECK(v <= full);
+        last = v;
+        if (pot_takeover_caught(&t))
+        {
+            caught_at = true;
+            CHECK_EQ(v, pos);
+            break;
+        }
+    }
+    CHECK(caught_at);
+}
+
+static void test_scale(void)
+{
+    pot_takeover_t t;
+
+    scale_sweep(FULL7, 20, FULL7, 100, 8);
+    scale_sweep(FULL7, 20, 0, 100, 4);
+    scale_sweep(FULL7, 120, 0, 10, 16);
+    scale_sweep(FULL10, 1000, 0, 100, 90);
+    scale_sweep(FULL10, 10, FULL10, 900, 1);
+
+    // 最初の 1 段: 20 → 28 で値 100 は 100 + 8 * 27 / 107 = 102
+    setup(&t, FULL7, 20, 100, POT_TAKEOVER_SCALE);
+    (void) pot_takeover_update(&t, POT_TAKEOVER_SCALE, 28);
+    CHECK_EQ(pot_takeover_value(&t), 102);
+    // 下げる時: 28 → 14 で 102 - 14 * 102 / 28 = 51
+    (void) pot_takeover_update(&t, POT_TAKEOVER_SCALE, 14);
+    CHECK_EQ(pot_takeover_value(&t), 51);
+}
+
+static void test_relative(void)
+{
+    pot_takeover_t t;
+
+    setup(&t, FULL7, 20, 100, POT_TAKEOVER_RELATIVE);
+    CHECK(pot_takeover_update(&t, POT_TAKEOVER_RELATIVE, 30));
+    CHECK_EQ(pot_takeover_value(&t), 110);
+    (void) pot_takeover_update(&t, POT_TAKEOVER_RELATIVE, 50);
+    CHECK_EQ(pot_takeover_value(&t), FULL7);  // 上の端で止まる
+    CHECK(!pot_takeover_caught(&t));
+    (void) pot_takeover_update(&t, POT_TAKEOVER_RELATIVE, 40);
+    CHECK_EQ(pot_takeover_value(&t), 117);
+    // 上まで回すと位置と一致してキャッチ
+    (void) pot_takeover_update(&t, POT_TAKEOVER_RELATIVE, FULL7);
+    CHECK_EQ(pot_takeover_value(&t), FULL7);
+    CHECK(pot_takeover_caught(&t));
+
+    setup(&t, FULL7, 100, 20, POT_TAKEOVER_RELATIVE);
+    (void) pot_takeover_update(&t, POT_TAKEOVER_RELATIVE, 70);
+    CHECK_EQ(pot_takeover_value(&t), 0);
+    (void) pot_takeover_update(&t, POT_TAKEOVER_RELATIVE, 0);
+    CHECK(pot_takeover_caught(&t));
+    CHECK_EQ(pot_takeover_value(&t), 0);
+}
+
+int main(void)
+{
+    test_first_update();
+    test_set_value();
+    test_jump();
+    test_pickup();
+    test_scale();
+    test_relative();
+    return test_done("pot_takeover");
+}
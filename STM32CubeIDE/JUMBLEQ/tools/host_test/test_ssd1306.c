@@ -0,0 +1,289 @@
+/*
+ * test_ssd1306.c
+ *
+ *  Created on: Mar 23, 2026
+ */
+
+// 1 つの ssd1306 ドライバで 128x32 (メイン) と 128x64 (サブ) の 2 つのインスタンスを動かして
+// - Init のコマンド列
+// - でたらめな描画 (全フォントの文字、線、矩形、円、弧、折れ線、反転、ビットマップ、画面の外へのはみ出し) の
+//   1 回毎のフレームバッファと戻り値
+// が、インスタンス化する前の main_oled.c / sub_oled.c と同じかを確かめる
+// 前のドライバは ref/ に 3da46a7 の 1 つ前のものをそのまま置き、同じ引数で並べて動かす (ref/ref_oled.c が HAL の代わり)
+// あわせて、変わったバイトが全部 dirty の範囲に入っていること、片方に描いてももう片方が変わらないことも見る
+
+#include "ssd1306.h"
+#include "ssd1306_fonts.h"
+
+#include "main_oled.h"
+#include "ref_oled.h"
+#include "sub_oled.h"
+
+#include "test.h"
+
+#define OPS     200000U
+#define CMD_MAX 64U
+
+static uint8_t s_cmd[2][CMD_MAX];
+static uint32_t s_cmd_n[2];
+
+static void mem_command(ssd1306_t* d, uint8_t byte)
+{
+    if (s_cmd_n[d->port] < CMD_MAX)
+    {
+        s_cmd[d->port][s_cmd_n[d->port]] = byte;
+    }
+    s_cmd_n[d->port]++;
+}
+
+static void mem_update(ssd1306_t* d, uint8_t page_start, uint8_t page_end, uint8_t col_start, uint8_t col_end)
+{
+}
+
+// メモリに描くだけの転送
+static const ssd1306_ops_t s_mem_ops = {.command = mem_command, .update = mem_update};
+
+static uint8_t s_fb_main[128 * 32 / 8];
+static uint8_t s_fb_sub[128 * 64 / 8];
+static ssd1306_t s_main = {.ops = &s_mem_ops, .fb = s_fb_main, .port = 0, .width = 128, .height = 32};
+static ssd1306_t s_sub  = {.ops = &s_mem_ops, .fb = s_fb_sub, .port = 1, .width = 128, .height = 64};
+
+static const SSD1306_Font_t* const s_fonts[] = {&Font_6x8, &Font_7x10, &Font_11x18, &Font_16x26, &Font_16x24, &Font_16x15};
+static const unsigned char s_bmp[]           = {0xF0, 0x0F, 0xAA, 0x55, 0x81, 0x42, 0x3C, 0xC3, 0xFF, 0x00, 0x18, 0x24};
+
+// 失敗した時に同じ列で追えるよう、libc の rand は使わない
+static uint32_t s_rng = 47U;
+
+static uint32_t rnd(uint32_t n)
+{
+    s_rng = s_rng * 1103515245U + 12345U;
+    return (s_rng >> 16) % n;
+}
+
+static uint32_t s_undirty;
+static uint32_t s_leaked;
+static uint32_t s_fb_diff;
+static uint32_t s_ret_diff;
+static uint32_t s_first_diff = UINT32_MAX;
+
+// 前のドライバの同じ関数を呼ぶ (dev 0: main_oled_*, 1: sub_oled_*)
+#define REF(dev, fn, ...) ((dev) ? sub_oled_##fn(__VA_ARGS__) : main_oled_##fn(__VA_ARGS__))
+
+static void one(uint32_t i, uint32_t dev)
+{
+    ssd1306_t* d         = dev ? &s_sub : &s_main;
+    const ssd1306_t* o   = dev ? &s_main : &s_sub;
+    const uint32_t w     = d->width;
+    const uint32_t h     = d->height;
+    const uint32_t len   = w * h / 8U;
+    const uint32_t o_len = (uint32_t) o->width * o->height / 8U;
+    uint8_t before[sizeof(s_fb_sub)];
+    uint8_t other[sizeof(s_fb_sub)];
+    int32_t ret     = 0;
+    int32_t ref_ret = 0;
+
+    memcpy(before, d->fb, len);
+    memcpy(other, o->fb, o_len);
+    oled_dirty_clear(&d->dirty);
+
+    // 画面の少し外まで含めて座標を振る
+    const uint8_t x1      = (uint8_t) rnd(w + 16U);
+    const uint8_t y1      = (uint8_t) rnd(h + 8U);
+    const uint8_t x2      = (uint8_t) rnd(w + 16U);
+    const uint8_t y2      = (uint8_t) rnd(h + 8U);
+    const SSD1306_COLOR c = (SSD1306_COLOR) rnd(2U);
+    uint8_t r             = (uint8_t) rnd(20U);
+    switch (rnd(13U))
+    {
+    case 0:
+        ssd1306_Fill(d, c);
+        REF(dev, Fill, c);
+        break;
+    case 1:
+        ssd1306_DrawPixel(d, x1, y1, c);
+        REF(dev, DrawPixel, x1, y1, c);
+        break;
+    case 2:
+    {
+        char s[8];
+        const uint32_t k = rnd(7U);
+        for (uint32_t i = 0; i < k; i++)
+        {
+            s[i] = (char) (32U + rnd(95U));
+        }
+        s[k]                    = '\0';
+        const SSD1306_Font_t* f = s_fonts[rnd(ARRAY_SIZE(s_fonts))];
+        ssd1306_SetCursor(d, x1, y1);
+        ret = ssd1306_WriteString(d, s, *f, c);
+        REF(dev, SetCursor, x1, y1);
+        ref_ret = REF(dev, WriteString, s, *f, c);
+        break;
+    }
+    case 3:
+        ssd1306_Line(d, x1, y1, x2, y2, c);
+        REF(dev, Line, x1, y1, x2, y2, c);
+        break;
+    case 4:
+        ssd1306_DrawRectangle(d, x1, y1, x2, y2, c);
+        REF(dev, DrawRectangle, x1, y1, x2, y2, c);
+        break;
+    case 5:
+        ssd1306_FillRectangle(d, x1, y1, x2, y2, c);
+        REF(dev, FillRectangle, x1, y1, x2, y2, c);
+        break;
+    case 6:
+        ssd1306_DrawCircle(d, x1, y1, r, c);
+        REF(dev, DrawCircle, x1, y1, r, c);
+        break;
+    case 7:
+        // 元のライブラリから、円が上端/左端 (0) をまたぐと uint8_t のループが終わらないので避ける
+        if ((x1 == 0U) || (y1 == 0U))
+        {
+            break;
+        }
+        if (r >= x1)
+        {
+            r = (uint8_t) (x1 - 1U);
+        }
+        if (r >= y1)
+        {
+            r = (uint8_t) (y1 - 1U);
+        }
+        ssd1306_FillCircle(d, x1, y1, r, c);
+        REF(dev, FillCircle, x1, y1, r, c);
+        break;
+    case 8:
+    {
+        const uint16_t sa = (uint16_t) rnd(720U);
+        const uint16_t sw = (uint16_t) (1U + rnd(359U));
+        ssd1306_DrawArc(d, (uint8_t) (x1 % w), (uint8_t) (y1 % h), r, sa, sw, c);
+        REF(dev, DrawArc, (uint8_t) (x1 % w), (uint8_t) (y1 % h), r, sa, sw, c);
+        break;
+    }
+    case 9:
+    {
+        const uint16_t sa = (uint16_t) rnd(720U);
+        const uint16_t sw = (uint16_t) (1U + rnd(359U));
+        ssd1306_DrawArcWithRadiusLine(d, (uint8_t) (x1 % w), (uint8_t) (y1 % h), r, sa, sw, c);
+        REF(dev, DrawArcWithRadiusLine, (uint8_t) (x1 % w), (uint8_t) (y1 % h), r, sa, sw, c);
+        break;
+    }
+    case 10:
+    {
+        SSD1306_VERTEX v[4];
+        MAIN_OLED_VERTEX mv[ARRAY_SIZE(v)];
+        SUB_OLED_VERTEX sv[ARRAY_SIZE(v)];
+        for (uint32_t k = 0; k < ARRAY_SIZE(v); k++)
+        {
+            v[k].x = (uint8_t) rnd(w);
+            v[k].y = (uint8_t) rnd(h);
+            mv[k]  = (MAIN_OLED_VERTEX) {v[k].x, v[k].y};
+            sv[k]  = (SUB_OLED_VERTEX) {v[k].x, v[k].y};
+        }
+        ssd1306_Polyline(d, v, (uint16_t) ARRAY_SIZE(v), c);
+        if (dev)
+        {
+            sub_oled_Polyline(sv, (uint16_t) ARRAY_SIZE(v), c);
+        }
+        else
+        {
+            main_oled_Polyline(mv, (uint16_t) ARRAY_SIZE(v), c);
+        }
+        break;
+    }
+    case 11:
+        ret     = ssd1306_InvertRectangle(d, x1, y1, x2, y2);
+        ref_ret = REF(dev, InvertRectangle, x1, y1, x2, y2);
+        break;
+    case 12:
+    {
+        const uint8_t bw = (uint8_t) (1U + rnd(16U));
+        const uint8_t bh = (uint8_t) (1U + rnd(6U));
+        ssd1306_DrawBitmap(d, x1, y1, s_bmp, bw, bh, c);
+        REF(dev, DrawBitmap, x1, y1, s_bmp, bw, bh, c);
+        break;
+    }
+    }
+
+    const bool fb_diff = memcmp(d->fb, ref_oled[dev].fb, len) != 0;
+    if (fb_diff)
+    {
+        s_fb_diff++;
+    }
+    if (ret != ref_ret)
+    {
+        s_ret_diff++;
+    }
+    if ((fb_diff || (ret != ref_ret)) && (s_first_diff == UINT32_MAX))
+    {
+        s_first_diff = i;
+    }
+
+    // 変わったバイトは全部 dirty の範囲に入っていること
+    for (uint32_t k = 0; k < len; k++)
+    {
+        if (before[k] != d->fb[k])
+        {
+            const uint32_t page = k / w;
+            const uint32_t col  = k % w;
+            if ((col < d->dirty.col_min[page]) || (col > d->dirty.col_max[page]))
+            {
+                s_undirty++;
+            }
+        }
+    }
+    if (memcmp(other, o->fb, o_len) != 0)
+    {
+        s_leaked++;
+    }
+}
+
+static void test_init(void)
+{
+    ssd1306_Init(&s_main);
+    ssd1306_Init(&s_sub);
+    main_oled_Init();
+    sub_oled_Init();
+
+    for (uint32_t dev = 0; dev < 2U; dev++)
+    {
+        CHECK(ref_oled[dev].cmd_n <= CMD_MAX);
+        CHECK_EQ(s_cmd_n[dev], ref_oled[dev].cmd_n);
+        CHECK(memcmp(s_cmd[dev], ref_oled[dev].cmd, ref_oled[dev].cmd_n) == 0);
+    }
+    CHECK_EQ(s_cmd[0][13], 0x1F);  // 128x32 / 128x64 の MUX 比が入れ替わっていない
+    CHECK_EQ(s_cmd[1][13], 0x3F);
+
+    // 前のドライバのフレームバッファは UpdateScreen が転送キューに渡すポインタで見る
+    main_oled_UpdateScreen();
+    sub_oled_UpdateScreen();
+    CHECK(ref_oled[OLED_I2C_MAIN].fb != NULL);
+    CHECK(ref_oled[OLED_I2C_SUB].fb != NULL);
+    CHECK(memcmp(s_fb_main, ref_oled[OLED_I2C_MAIN].fb, sizeof(s_fb_main)) == 0);
+    CHECK(memcmp(s_fb_sub, ref_oled[OLED_I2C_SUB].fb, sizeof(s_fb_sub)) == 0);
+    CHECK_EQ(s_main.dirty.pages, 4);
+    CHECK_EQ(s_sub.dirty.pages, 8);
+}
+
+static void test_random_ops(void)
+{
+    for (uint32_t i = 0; i < OPS; i++)
+    {
+        one(i, i & 1U);
+    }
+    if (s_first_diff != UINT32_MAX)
+    {
+        printf("  first mismatch at op %u\n", s_first_diff);
+    }
+    CHECK_EQ(s_fb_diff, 0);
+    CHECK_EQ(s_ret_diff, 0);
+    CHECK_EQ(s_undirty, 0);
+    CHECK_EQ(s_leaked, 0);
+}
+
+int main(void)
+{
+    test_init();
+    test_random_ops();
+    return test_done("ssd1306");
+}
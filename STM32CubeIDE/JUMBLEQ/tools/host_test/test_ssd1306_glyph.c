@@ -0,0 +1,163 @@
+/*
+ * test_ssd1306_glyph.c
+ *
+ *  Created on: Mar 23, 2026
+ */
+
+// ssd1306_glyph_blit (列の表でページごとに書く) が、前の WriteChar (行の表を 1 ドットずつ DrawPixel) と
+// 同じバッファを作るかを、全フォント x 全文字 x 全 y x 両方の色で、でたらめな背景の上に書いて比べる
+// 最後に 1 行分の文字列を書く時間も並べて出す (比べるだけで合否には使わない)
+
+#include <stdint.h>
+
+#include "ssd1306_fonts.h"
+#include "ssd1306_glyph.h"
+
+#include "test.h"
+
+#include <stdlib.h>
+#include <time.h>
+
+#define W          128U
+#define H          64U
+#define BENCH_REPS 20000U
+
+static uint8_t s_ref[W * H / 8U];
+static uint8_t s_out[W * H / 8U];
+
+static void ref_pixel(uint8_t* buf, uint32_t x, uint32_t y, SSD1306_COLOR color)
+{
+    if ((x >= W) || (y >= H))
+    {
+        return;
+    }
+    if (color == White)
+    {
+        buf[x + (y / 8U) * W] |= (uint8_t) (1U << (y % 8U));
+    }
+    else
+    {
+        buf[x + (y / 8U) * W] &= (uint8_t) ~(1U << (y % 8U));
+    }
+}
+
+static uint8_t char_width(const SSD1306_Font_t* font, char ch)
+{
+    return (font->char_width != NULL) ? font->char_width[ch - 32] : font->width;
+}
+
+// 前の WriteChar の描き方そのまま
+static void ref_char(uint8_t* buf, uint8_t x, uint8_t y, const SSD1306_Font_t* font, char ch, SSD1306_COLOR color)
+{
+    const uint8_t w = char_width(font, ch);
+    for (uint32_t i = 0; i < font->height; i++)
+    {
+        const uint32_t b = font->data[(ch - 32) * font->height + i];
+        for (uint32_t j = 0; j < w; j++)
+        {
+            ref_pixel(buf, x + j, y + i, ((b << j) & 0x8000U) ? color : (SSD1306_COLOR) !color);
+        }
+    }
+}
+
+static void fill_random(void)
+{
+    for (uint32_t i = 0; i < sizeof(s_ref); i++)
+    {
+        s_ref[i] = (uint8_t) rand();
+    }
+    memcpy(s_out, s_ref, sizeof(s_out));
+}
+
+static const struct
+{
+    const char* name;
+    const SSD1306_Font_t* font;
+} s_fonts[] = {
+    {"6x8", &Font_6x8},     {"7x10", &Font_7x10},   {"11x18", &Font_11x18},
+    {"16x26", &Font_16x26}, {"16x24", &Font_16x24}, {"16x15", &Font_16x15},
+};
+
+static void test_matches_pixel_path(void)
+{
+    uint32_t placements = 0;
+    uint32_t mismatches = 0;
+
+    srand(3);
+    for (uint32_t f = 0; f < ARRAY_SIZE(s_fonts); f++)
+    {
+        const SSD1306_Font_t* font = s_fonts[f].font;
+        CHECK(font->cols != NULL);
+        for (uint32_t c = 0; c < 2U; c++)
+        {
+            for (uint32_t y = 0; (y + font->height) <= H; y++)
+            {
+                for (char ch = 32; ch <= 126; ch++)
+                {
+                    const uint8_t x = (uint8_t) (rand() % (W - 16U));
+                    fill_random();
+                    ref_char(s_ref, x, (uint8_t) y, font, ch, (SSD1306_COLOR) c);
+                    ssd1306_glyph_blit(s_out, W, H, x, (uint8_t) y, font, char_width(font, ch), ch, (SSD1306_COLOR) c);
+                    if (memcmp(s_ref, s_out, sizeof(s_ref)) != 0)
+                    {
+                        if (mismatches++ == 0U)
+                        {
+                            printf("  first mismatch: Font_%s '%c' x=%u y=%u color=%u\n", s_fonts[f].name, ch, x, y, c);
+                        }
+                    }
+                    placements++;
+                }
+            }
+        }
+    }
+    printf("  %u glyph placements compared\n", placements);
+    CHECK_EQ(mismatches, 0);
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec * 1e9 + (double) ts.tv_nsec;
+}
+
+static void bench_string(const char* name, const SSD1306_Font_t* font, uint8_t y, const char* s)
+{
+    double t_ref  = 0.0;
+    double t_blit = 0.0;
+
+    for (uint32_t r = 0; r < BENCH_REPS; r++)
+    {
+        uint8_t x   = 0;
+        double t0   = now_ns();
+        for (const char* p = s; *p != '\0'; p++)
+        {
+            ref_char(s_ref, x, y, font, *p, White);
+            x = (uint8_t) (x + char_width(font, *p));
+        }
+        t_ref += now_ns() - t0;
+
+        x  = 0;
+        t0 = now_ns();
+        for (const char* p = s; *p != '\0'; p++)
+        {
+            const uint8_t w = char_width(font, *p);
+            ssd1306_glyph_blit(s_out, W, H, x, y, font, w, *p, White);
+            x = (uint8_t) (x + w);
+        }
+        t_blit += now_ns() - t0;
+    }
+    printf("  Font_%-5s y=%u: pixel %7.0f ns, blit %6.0f ns per \"%s\" (x%.1f)\n", name, y, t_ref / BENCH_REPS,
+           t_blit / BENCH_REPS, s, t_ref / t_blit);
+}
+
+int main(void)
+{
+    test_matches_pixel_path();
+    for (uint32_t f = 0; f < 3U; f++)
+    {
+        bench_string(s_fonts[f].name, s_fonts[f].font, 0U, "Mst: -12dB");
+        bench_string(s_fonts[f].name, s_fonts[f].font, 3U, "Mst: -12dB");
+    }
+    return test_done("ssd1306_glyph");
+}
@@ -0,0 +1,80 @@
+/*
+ * test_ws2812.c
+ *
+ *  Created on: Mar 23, 2026
+ */
+
+#include "ws2812.h"
+
+#include "test.h"
+
+#include <math.h>
+
+// 1 bit ずつ MSB から比較値にする素直な実装と突き合わせる
+static void test_encode_bit_exact(void)
+{
+    uint8_t in[256];
+    uint8_t out[256 * WS2812_BYTE_LEN + 1U];
+    uint8_t ref[256 * WS2812_BYTE_LEN];
+
+    for (uint32_t i = 0; i < 256U; i++)
+    {
+        in[i] = (uint8_t) i;
+        for (uint32_t b = 0; b < 8U; b++)
+        {
+            ref[i * WS2812_BYTE_LEN + b] = (((i >> (7U - b)) & 1U) != 0U) ? WS2812_PWM_ONE : WS2812_PWM_ZERO;
+        }
+    }
+    out[sizeof(out) - 1U] = 0xA5U;
+    ws2812_encode(in, 256U, out);
+    CHECK(memcmp(out, ref, sizeof(ref)) == 0);
+    CHECK_EQ(out[sizeof(out) - 1U], 0xA5);  // len * 8 byte より先は書かない
+
+    // LED 1 個分 (G, R, B の順にそのまま並ぶ)
+    static const uint8_t grb[3] = {0x80U, 0x01U, 0x5AU};
+    static const uint8_t want[3 * WS2812_BYTE_LEN] = {
+        16, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 16, 7, 16, 7, 16, 16, 7, 16, 7,
+    };
+    uint8_t one[3 * WS2812_BYTE_LEN];
+    ws2812_encode(grb, 3U, one);
+    CHECK(memcmp(one, want, sizeof(want)) == 0);
+}
+
+static void test_gamma(void)
+{
+    static const uint8_t brightness[] = {255U, 128U, 16U, 1U, 0U};
+    uint8_t lut[256];
+
+    for (uint32_t k = 0; k < ARRAY_SIZE(brightness); k++)
+    {
+        const uint8_t br = brightness[k];
+
+        ws2812_build_gamma(lut, 2.2f, br);
+        CHECK_EQ(lut[0], 0);
+        CHECK_EQ(lut[255], br);
+        for (uint32_t v = 1; v < 256U; v++)
+        {
+            CHECK(lut[v] >= lut[v - 1U]);
+            if (br != 0U)
+            {
+                CHECK(lut[v] != 0U);  // 暗くしても消えない
+            }
+            const float y = powf((float) v / 255.0f, 2.2f) * (float) br;
+            CHECK((fabsf((float) lut[v] - y) <= 0.5f) || (lut[v] == 1U));
+        }
+    }
+
+    // gamma 1 で明るさ 255 ならそのまま
+    ws2812_build_gamma(lut, 1.0f, 255U);
+    for (uint32_t v = 0; v < 256U; v++)
+    {
+        CHECK_EQ(lut[v], v);
+    }
+}
+
+int main(void)
+{
+    test_encode_bit_exact();
+    test_gamma();
+    return test_done("ws2812");
+}
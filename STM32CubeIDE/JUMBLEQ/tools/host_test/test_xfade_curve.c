@@ -0,0 +1,62 @@
+/*
+ * test_xfade_curve.c
+ *
+ *  Created on: Mar 23, 2026
+ */
+
+#include "xfade_curve.h"
+
+#include "test.h"
+
+// どのカーブも f(0)=0, f(1)=1 で単調非減少 (xfade_curve.h)
+static void check_curve(uint8_t curve)
+{
+    uint16_t prev = 0U;
+
+    CHECK_EQ(xfade_curve_eval(curve, 0U), 0);
+    CHECK_EQ(xfade_curve_eval(curve, XFADE_Q15_ONE), XFADE_Q15_ONE);
+    CHECK_EQ(xfade_curve_eval(curve, 0xFFFFU), XFADE_Q15_ONE);  // 1.0 より上は 1.0
+
+    for (uint32_t pos = 0; pos <= XFADE_Q15_ONE; pos++)
+    {
+        const uint16_t y = xfade_curve_eval(curve, (uint16_t) pos);
+        if (y < prev)
+        {
+            printf("%s: decreasing at %u (%u < %u)\n", xfade_curve_name(curve), (unsigned) pos, y, prev);
+            test_failures++;
+            break;
+        }
+        prev = y;
+    }
+}
+
+int main(void)
+{
+    // 途中で下がる点や 127 を超える点を含めても単調に補正される
+    static const uint8_t user[XFADE_USER_POINT_NUM] = {0, 100, 20, 50, 60, 60, 70, 80, 90, 100, 110, 120, 125, 126, 127, 3};
+    uint8_t back[XFADE_USER_POINT_NUM];
+
+    for (uint8_t c = 0; c < XFADE_CURVE_NUM; c++)
+    {
+        check_curve(c);
+    }
+
+    xfade_curve_set_user_points(user);
+    check_curve(XFADE_CURVE_USER);
+    xfade_curve_get_user_points(back);
+    for (uint32_t i = 0; i < XFADE_USER_POINT_NUM; i++)
+    {
+        CHECK(back[i] <= 127U);
+    }
+
+    // 決まった点の値 (カーブの形が変わっていないこと)
+    CHECK_EQ(xfade_curve_eval(XFADE_CURVE_LINEAR, 16384U), 16384);
+    CHECK(xfade_curve_eval(XFADE_CURVE_SCRATCH, 4096U) > 16000U);  // (1/8)^(1/3) = 0.5
+    CHECK(xfade_curve_eval(XFADE_CURVE_SHARP, 4096U) > 28000U);
+    CHECK(xfade_curve_eval(XFADE_CURVE_CONST_POWER, 16384U) > 23000U);  // sin(pi/4) = 0.707
+
+    // 範囲外のカーブ番号
+    CHECK(xfade_curve_eval(XFADE_CURVE_NUM, 16384U) <= XFADE_Q15_ONE);
+
+    return test_done("xfade_curve");
+}
@@ -0,0 +1,328 @@
+package main
+
+import (
+	"flag"
+	"fmt"
+	"os"
+	"strings"
+)
+
+// JUMBLEQ の SysEx (Appli/Core/Inc/midi_sysex.h) を作る・読むスクリプト
+// 割り当て表の編集は midi_map_sysex.go を使う
+// 例: go run jumbleq_sysex.go -version
+//     go run jumbleq_sysex.go -cfg-set 8 -value 2
+//     go run jumbleq_sysex.go -tune-set 4 -value 96
+//     amidi -p hw:1 -S "$(go run jumbleq_sysex.go -dump 0)" -r dump.syx -t 1
+//     go run jumbleq_sysex.go -decode dump.syx
+//     go run jumbleq_sysex.go -restore dump.syx -section 16 -o restore.syx
+//
+// リストアは 1 メッセージ毎に ACK を待つこと (amidi なら 1 行ずつ送る)
+
+const (
+	manufacturer = 0x7D
+	device       = 0x4A
+
+	cmdVersionGet   = 0x01
+	cmdVersionReply = 0x02
+	cmdMapReply     = 0x11
+	cmdCfgGet       = 0x20
+	cmdCfgReply     = 0x21
+	cmdCfgSet       = 0x22
+	cmdCfgSave      = 0x23
+	cmdDumpGet      = 0x30
+	cmdDumpData     = 0x31
+	cmdRestoreData  = 0x32
+	cmdPresetStore  = 0x40
+	cmdPresetRecall = 0x41
+	cmdParamGet     = 0x50
+	cmdParamReply   = 0x51
+	cmdParamSet     = 0x52
+	cmdTuneGet      = 0x60
+	cmdTuneReply    = 0x61
+	cmdTuneSet      = 0x62
+	cmdNak          = 0x7E
+	cmdAck          = 0x7F
+
+	chunkHdr = 3 // <section> <index> <count>
+)
+
+var cfgFields = []string{
+	"ch1_input", "ch2_input", "xfA_assign", "xfB_assign", "xfpost_assign", "ch1_dvs", "ch2_dvs", "reserved",
+	"xf_curve_A", "xf_curve_B", "xf_cut_A", "xf_cut_B",
+}
+
+// TUNE_GET/SET の対象 (MIDI_SYSEX_TUNE_*)
+var tuneNames = map[int]string{
+	0x00: "pot_min_cutoff_q8",
+	0x01: "pot_max_cutoff_q8",
+	0x02: "pot_beta_q16",
+	0x03: "pot_d_cutoff_q8",
+	0x04: "pot_hyst_q8",
+	0x10: "input_debounce_ms",
+	0x11: "input_long_ms",
+	0x12: "input_double_ms",
+	0x13: "input_chord_ms",
+	0x14: "input_cut_ms",
+}
+
+func tuneName(tune int) string {
+	if name, ok := tuneNames[tune]; ok {
+		return name
+	}
+	return "?"
+}
+
+func sysex(cmd byte, data ...byte) []byte {
+	msg := []byte{0xF0, manufacturer, device, cmd}
+	msg = append(msg, data...)
+	return append(msg, 0xF7)
+}
+
+func u14(v int) []byte {
+	return []byte{byte((v >> 7) & 0x7F), byte(v & 0x7F)}
+}
+
+func fail(format string, a ...interface{}) {
+	fmt.Fprintf(os.Stderr, format+"\n", a...)
+	os.Exit(1)
+}
+
+// midi_sysex_unpack と同じ: 7 byte 毎に先頭の 1 byte が MSB をまとめたもの
+func unpack(in []byte) ([]byte, error) {
+	var out []byte
+	for i := 0; i < len(in); {
+		msb := in[i]
+		i++
+		group := min(7, len(in)-i)
+		if group == 0 || msb&0x80 != 0 || msb>>group != 0 {
+			return nil, fmt.Errorf("不正なグループ (offset %d)", i-1)
+		}
+		for k := 0; k < group; k++ {
+			b := in[i]
+			i++
+			if b&0x80 != 0 {
+				return nil, fmt.Errorf("7bit を超える値 (offset %d)", i-1)
+			}
+			out = append(out, b|((msb>>k)&1)<<7)
+		}
+	}
+	return out, nil
+}
+
+// midi_sysex_checksum と同じ: data と足して下位 7bit が 0 になる値
+func checksum(data []byte) byte {
+	var sum byte
+	for _, b := range data {
+		sum += b
+	}
+	return (0x80 - sum&0x7F) & 0x7F
+}
+
+// .syx を F0...F7 毎に分ける
+func split(raw []byte) [][]byte {
+	var msgs [][]byte
+	start := -1
+	for i, b := range raw {
+		switch {
+		case b == 0xF0:
+			start = i
+		case b == 0xF7 && start >= 0:
+			msgs = append(msgs, raw[start:i+1])
+			start = -1
+		}
+	}
+	return msgs
+}
+
+// F0 7D 4A <cmd> <data> F7 なら cmd と data を返す
+func parse(msg []byte) (byte, []byte, bool) {
+	if len(msg) < 5 || msg[1] != manufacturer || msg[2] != device {
+		return 0, nil, false
+	}
+	return msg[3], msg[4 : len(msg)-1], true
+}
+
+func cfgName(field int) string {
+	if field < len(cfgFields) {
+		return cfgFields[field]
+	}
+	return fmt.Sprintf("xf_user_curve[%d]", field-len(cfgFields))
+}
+
+// DUMP_DATA を RESTORE_DATA に書き換える (section を変えたら checksum を付け直す)
+func restore(raw []byte, section int) [][]byte {
+	var out [][]byte
+	for _, msg := range split(raw) {
+		cmd, data, ok := parse(msg)
+		if !ok || cmd != cmdDumpData {
+			continue
+		}
+		if len(data) < chunkHdr+1 || checksum(data[:len(data)-1]) != data[len(data)-1] {
+			fail("checksum が合わないチャンク: % X", msg)
+		}
+		chunk := append([]byte(nil), data[:len(data)-1]...)
+		if section >= 0 {
+			chunk[0] = byte(section)
+		}
+		chunk = append(chunk, checksum(chunk))
+		out = append(out, sysex(cmdRestoreData, chunk...))
+	}
+	if len(out) == 0 {
+		fail("DUMP_DATA が見つからない")
+	}
+	return out
+}
+
+func decode(raw []byte) {
+	sections := map[byte][]byte{}
+	for _, msg := range split(raw) {
+		if len(msg) == 15 && msg[1] == 0x7E && msg[3] == 0x06 && msg[4] == 0x02 {
+			fmt.Printf("IDENTITY mfr=%02X family=%02X%02X model=%02X%02X fw=%d.%d.%d\n",
+				msg[5], msg[7], msg[6], msg[9], msg[8], msg[10], msg[11], msg[12])
+			continue
+		}
+		cmd, data, ok := parse(msg)
+		if !ok {
+			continue
+		}
+		switch {
+		case cmd == cmdVersionReply && len(data) >= 7:
+			name := strings.TrimRight(string(data[7:]), "\x00")
+			slot := fmt.Sprint(data[6])
+			if data[6] == 0x7F {
+				slot = "builtin"
+			}
+			fmt.Printf("VERSION proto=%d fw=%d.%d.%d config=%d dsp=%s (%s)\n",
+				data[0], data[1], data[2], data[3], int(data[4])<<7|int(data[5]), slot, name)
+		case cmd == cmdCfgReply && len(data) == 3:
+			fmt.Printf("CFG %d %s = %d\n", data[0], cfgName(int(data[0])), int(data[1])<<7|int(data[2]))
+		case cmd == cmdParamReply && len(data) == 3:
+			fmt.Printf("PARAM %d = %d\n", data[0], int(data[1])<<7|int(data[2]))
+		case cmd == cmdTuneReply && len(data) == 3:
+			fmt.Printf("TUNE %d %s = %d\n", data[0], tuneName(int(data[0])), int(data[1])<<7|int(data[2]))
+		case cmd == cmdMapReply && len(data) == 11:
+			fmt.Printf("MAP src=%d type=%d ch=%d curve=%d flags=%02X num=%d min=%d max=%d\n", data[0], data[1], data[2]+1,
+				data[3], data[4], int(data[5])<<7|int(data[6]), int(data[7])<<7|int(data[8]), int(data[9])<<7|int(data[10]))
+		case cmd == cmdDumpData && len(data) > chunkHdr:
+			if checksum(data[:len(data)-1]) != data[len(data)-1] {
+				fail("checksum が合わない (section %d, chunk %d)", data[0], data[1])
+			}
+			b, err := unpack(data[chunkHdr : len(data)-1])
+			if err != nil {
+				fail("%v", err)
+			}
+			sections[data[0]] = append(sections[data[0]], b...)
+			fmt.Printf("DUMP section=%02X chunk %d/%d (%d byte)\n", data[0], data[1]+1, data[2], len(b))
+		case (cmd == cmdAck || cmd == cmdNak) && len(data) == 1:
+			res := "ACK"
+			if cmd == cmdNak {
+				res = "NAK"
+			}
+			fmt.Printf("%s %02X\n", res, data[0])
+		default:
+			fmt.Printf("? % X\n", msg)
+		}
+	}
+	for section, b := range sections {
+		fmt.Printf("section %02X: % X\n", section, b)
+		if section != 0x01 {
+			for i, v := range b {
+				if i != 7 {
+					fmt.Printf("  %2d %-18s %d\n", i, cfgName(i), v)
+				}
+			}
+		}
+	}
+}
+
+func main() {
+	version := flag.Bool("version", false, "ファームウェア/DSP のバージョンを問い合わせる")
+	identity := flag.Bool("identity", false, "ユニバーサル Identity Request")
+	cfgGet := flag.Int("cfg-get", -1, "設定フィールドを読む (EEPROM_DeviceConfig_t のオフセット)")
+	cfgSet := flag.Int("cfg-set", -1, "設定フィールドを書く (-value と一緒に)")
+	value := flag.Int("value", 0, "-cfg-set (0-255) / -param-set (0-1023) / -tune-set (0-16383) の値")
+	cfgSave := flag.Bool("cfg-save", false, "今の設定を EEPROM に保存する")
+	dump := flag.Int("dump", -1, "ダンプを要求する section (0: 設定 1: 割り当て表 16+n: プリセット n)")
+	restoreFile := flag.String("restore", "", "DUMP_DATA を含む .syx を RESTORE_DATA にする")
+	section := flag.Int("section", -1, "-restore の書き込み先 section (省略時はダンプ元のまま)")
+	presetStore := flag.Int("preset-store", -1, "今の設定をプリセットに保存する (0-3)")
+	presetRecall := flag.Int("preset-recall", -1, "プリセットを読み込む (0-3)")
+	paramGet := flag.Int("param-get", -1, "DSP パラメーターを読む (0:CH1 1:CH2 2:MASTER 3:DRY/WET)")
+	paramSet := flag.Int("param-set", -1, "DSP パラメーターを書く (-value と一緒に、同じ先のポットはテイクオーバー)")
+	tuneGet := flag.Int("tune-get", -1, "入力処理の調整値を読む (0-4: ポットのフィルター、16-20: ボタン/フェーダーの時間)")
+	tuneSet := flag.Int("tune-set", -1, "入力処理の調整値を書く (-value と一緒に、保存はされない)")
+	decodeFile := flag.String("decode", "", "受信した .syx を読んで表示する")
+	out := flag.String("o", "", "出力する .syx ファイル (省略時は16進文字列を 1 メッセージ 1 行で表示)")
+	flag.Parse()
+
+	var msgs [][]byte
+	switch {
+	case *decodeFile != "":
+		raw, err := os.ReadFile(*decodeFile)
+		if err != nil {
+			fail("%v", err)
+		}
+		decode(raw)
+		return
+	case *version:
+		msgs = append(msgs, sysex(cmdVersionGet))
+	case *identity:
+		msgs = append(msgs, []byte{0xF0, 0x7E, 0x7F, 0x06, 0x01, 0xF7})
+	case *cfgGet >= 0:
+		msgs = append(msgs, sysex(cmdCfgGet, byte(*cfgGet&0x7F)))
+	case *cfgSet >= 0:
+		if *value < 0 || *value > 255 {
+			fail("-value は 0-255")
+		}
+		msgs = append(msgs, sysex(cmdCfgSet, append([]byte{byte(*cfgSet & 0x7F)}, u14(*value)...)...))
+	case *cfgSave:
+		msgs = append(msgs, sysex(cmdCfgSave))
+	case *dump >= 0:
+		msgs = append(msgs, sysex(cmdDumpGet, byte(*dump&0x7F)))
+	case *restoreFile != "":
+		raw, err := os.ReadFile(*restoreFile)
+		if err != nil {
+			fail("%v", err)
+		}
+		msgs = restore(raw, *section)
+	case *paramGet >= 0:
+		msgs = append(msgs, sysex(cmdParamGet, byte(*paramGet&0x7F)))
+	case *paramSet >= 0:
+		if *value < 0 || *value > 1023 {
+			fail("-value は 0-1023")
+		}
+		msgs = append(msgs, sysex(cmdParamSet, append([]byte{byte(*paramSet & 0x7F)}, u14(*value)...)...))
+	case *tuneGet >= 0:
+		msgs = append(msgs, sysex(cmdTuneGet, byte(*tuneGet&0x7F)))
+	case *tuneSet >= 0:
+		if *value < 0 || *value > 0x3FFF {
+			fail("-value は 0-16383")
+		}
+		msgs = append(msgs, sysex(cmdTuneSet, append([]byte{byte(*tuneSet & 0x7F)}, u14(*value)...)...))
+	case *presetStore >= 0:
+		msgs = append(msgs, sysex(cmdPresetStore, byte(*presetStore&0x7F)))
+	case *presetRecall >= 0:
+		msgs = append(msgs, sysex(cmdPresetRecall, byte(*presetRecall&0x7F)))
+	default:
+		flag.Usage()
+		os.Exit(1)
+	}
+
+	if *out != "" {
+		var raw []byte
+		for _, msg := range msgs {
+			raw = append(raw, msg...)
+		}
+		if err := os.WriteFile(*out, raw, 0o644); err != nil {
+			fail("%v", err)
+		}
+		return
+	}
+	for _, msg := range msgs {
+		hex := make([]string, len(msg))
+		for i, b := range msg {
+			hex[i] = fmt.Sprintf("%02X", b)
+		}
+		fmt.Println(strings.Join(hex, " "))
+	}
+}
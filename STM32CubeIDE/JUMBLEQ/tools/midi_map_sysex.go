@@ -0,0 +1,122 @@
+package main
+
+import (
+	"flag"
+	"fmt"
+	"os"
+	"strings"
+)
+
+// MIDI 割り当て表 (Appli/Core/Inc/midi_map.h) を編集する SysEx を作るスクリプト
+// 出力はそのまま amidi などで送れる16進文字列 (-o を付けると .syx バイナリ)
+// 例: go run midi_map_sysex.go -src 0 -type cc -ch 1 -num 74
+//     amidi -p hw:1 -S "$(go run midi_map_sysex.go -src 8 -type note -num 36)"
+//     go run midi_map_sysex.go -save
+//
+// メッセージの形式は Appli/Core/Inc/midi_sysex.h と一致させること
+
+const (
+	manufacturer = 0x7D
+	device       = 0x4A
+
+	cmdMapGet      = 0x10
+	cmdMapSet      = 0x12
+	cmdMapSave     = 0x13
+	cmdMapDefaults = 0x14
+)
+
+var types = map[string]byte{"none": 0, "cc": 1, "nrpn": 2, "note": 3, "dsp": 4}
+var curves = map[string]byte{"linear": 0, "power": 1, "sharp": 2, "scratch": 3, "user": 4}
+var typeMax = map[byte]int{0: 0, 1: 127, 2: 16383, 3: 127, 4: 1023}
+var takeovers = map[string]byte{"jump": 0, "pickup": 1, "scale": 2, "relative": 3}
+
+func sysex(cmd byte, data ...byte) []byte {
+	msg := []byte{0xF0, manufacturer, device, cmd}
+	msg = append(msg, data...)
+	return append(msg, 0xF7)
+}
+
+func u14(v int) []byte {
+	return []byte{byte((v >> 7) & 0x7F), byte(v & 0x7F)}
+}
+
+func fail(format string, a ...interface{}) {
+	fmt.Fprintf(os.Stderr, format+"\n", a...)
+	os.Exit(1)
+}
+
+func main() {
+	src := flag.Int("src", -1, "操作子 (0-7: ポット, 8-13: 磁気フェーダー)")
+	typ := flag.String("type", "cc", "出力先 (none, cc, nrpn, note, dsp)")
+	ch := flag.Int("ch", 1, "MIDI チャンネル (1-16)")
+	num := flag.Int("num", 0, "CC/ノート/NRPN 番号、dsp のときはパラメーター (0:CH1 1:CH2 2:MASTER 3:DRY/WET)")
+	min := flag.Int("min", 0, "範囲の下限")
+	max := flag.Int("max", -1, "範囲の上限 (省略時は出力先の最大値)")
+	curve := flag.String("curve", "linear", "カーブ (linear, power, sharp, scratch, user)")
+	invert := flag.Bool("invert", false, "反転する")
+	takeover := flag.String("takeover", "pickup", "ポットのソフトテイクオーバー (jump, pickup, scale, relative)")
+	get := flag.Bool("get", false, "-src の割り当てを読む")
+	save := flag.Bool("save", false, "EEPROM に保存する")
+	defaults := flag.Bool("defaults", false, "初期割り当てに戻す")
+	out := flag.String("o", "", "出力する .syx ファイル (省略時は16進文字列を表示)")
+	flag.Parse()
+
+	var msg []byte
+	switch {
+	case *save:
+		msg = sysex(cmdMapSave)
+	case *defaults:
+		msg = sysex(cmdMapDefaults)
+	default:
+		if *src < 0 || *src > 13 {
+			fail("-src は 0-13")
+		}
+		if *get {
+			msg = sysex(cmdMapGet, byte(*src))
+			break
+		}
+		t, ok := types[strings.ToLower(*typ)]
+		if !ok {
+			fail("不明な -type: %s", *typ)
+		}
+		c, ok := curves[strings.ToLower(*curve)]
+		if !ok {
+			fail("不明な -curve: %s", *curve)
+		}
+		if *ch < 1 || *ch > 16 {
+			fail("-ch は 1-16")
+		}
+		vmax := typeMax[t]
+		if *max < 0 {
+			*max = vmax
+		}
+		if *min > vmax || *max > vmax || *min < 0 {
+			fail("-min/-max は 0-%d", vmax)
+		}
+		to, ok := takeovers[strings.ToLower(*takeover)]
+		if !ok {
+			fail("不明な -takeover: %s", *takeover)
+		}
+		flags := to << 1
+		if *invert {
+			flags |= 0x01
+		}
+		data := []byte{byte(*src), t, byte(*ch - 1), c, flags}
+		data = append(data, u14(*num)...)
+		data = append(data, u14(*min)...)
+		data = append(data, u14(*max)...)
+		msg = sysex(cmdMapSet, data...)
+	}
+
+	if *out != "" {
+		if err := os.WriteFile(*out, msg, 0o644); err != nil {
+			fail("%v", err)
+		}
+		return
+	}
+	hex := make([]string, len(msg))
+	for i, b := range msg {
+		hex[i] = fmt.Sprintf("%02X", b)
+	}
+	fmt.Println(strings.Join(hex, " "))
+}
@@ -0,0 +1,518 @@
+package main
+
+import (
+	"bufio"
+	"encoding/binary"
+	"flag"
+	"fmt"
+	"hash/crc32"
+	"os"
+	"path/filepath"
+	"regexp"
+	"sort"
+	"strconv"
+	"strings"
+)
+
+// SigmaStudio のエクスポート(*.h / *_PARAM.h)から、ファームウェアの dsp_library が読む
+// JDSP バイナリイメージを生成するスクリプト
+// 例: go run sigma_image_compiler.go -name phono_v2 -o phono_v2.jdsp JUMBLEQ_DSP_ADAU146xSchematic_1.h
+//
+// フォーマットは Appli/Core/Inc/dsp_library.h と一致させること
+
+const (
+	imageMagic     = 0x5053444A // "JDSP"
+	imageVersion   = 2
+	imageNameLen   = 16
+	headerSize     = 52
+	opSize         = 16
+	paramSize      = 4
+	symbolSize     = 8
+	frameMax       = 1020 // SPI5 limited instance (TSIZE < 1023)
+	frameHdrSize   = 3
+	slotSize       = 0x40000
+	opWrite        = 0
+	opDelay        = 1
+	opFlagLZ       = 0x01
+	paramAddrNone  = 0xFFFF
+	lzLiteralMax   = 128
+	lzMatchMin     = 3
+	lzMatchMax     = 130
+	defaultDelayMs = 15 // SIGMA_WRITE_DELAY と同じ固定待ち
+)
+
+// dsp_library.h の DSP_PARAM_* と同じ順番
+var paramNames = []string{
+	"MOD_INPUT_FROM_USB1_GAIN_ADDR",
+	"MOD_INPUT_FROM_USB2_GAIN_ADDR",
+	"MOD_INPUT_FROM_USB3_GAIN_ADDR",
+	"MOD_INPUT_FROM_USB4_GAIN_ADDR",
+	"MOD_INPUT_FROM_CH1_GAIN_ADDR",
+	"MOD_INPUT_FROM_CH2_GAIN_ADDR",
+	"MOD_SEND1_OUTPUT_GAIN_ADDR",
+	"MOD_SEND2_OUTPUT_GAIN_ADDR",
+	"MOD_MASTER_OUTPUT_GAIN_ADDR",
+	"MOD_DCINPUT_A_DCVALUE_ADDR",
+	"MOD_DCINPUT_B_DCVALUE_ADDR",
+	"MOD_DCINPUT_DRYA_DCVALUE_ADDR",
+	"MOD_DCINPUT_DRYB_DCVALUE_ADDR",
+	"MOD_DCINPUT_WET_DCVALUE_ADDR",
+	"MOD_LN_PN_SW_1_INDEX_CHANNEL0_ADDR",
+	"MOD_LN_PN_SW_1_INDEX_CHANNEL1_ADDR",
+	"MOD_LN_PN_SW_2_INDEX_CHANNEL0_ADDR",
+	"MOD_LN_PN_SW_2_INDEX_CHANNEL1_ADDR",
+	"MOD_DVS_SW_1_INDEX_CHANNEL0_ADDR",
+	"MOD_DVS_SW_1_INDEX_CHANNEL1_ADDR",
+	"MOD_DVS_SW_2_INDEX_CHANNEL0_ADDR",
+	"MOD_DVS_SW_2_INDEX_CHANNEL1_ADDR",
+	"MOD_XF_ASSIGN_SW_A_INDEX_ADDR",
+	"MOD_XF_ASSIGN_SW_B_INDEX_ADDR",
+	"MOD_XF_ASSIGN_SW_POST_INDEX_ADDR",
+	"MOD_PH_EQ_1_STAGE0_B2_ADDR",
+	"MOD_PH_EQ_1_STAGE1_B2_ADDR",
+	"MOD_PH_EQ_1_STAGE2_B2_ADDR",
+	"MOD_PH_EQ_2_STAGE0_B2_ADDR",
+	"MOD_PH_EQ_2_STAGE1_B2_ADDR",
+	"MOD_PH_EQ_2_STAGE2_B2_ADDR",
+	"MOD_DSPREADBACK_A_VALUE_ADDR",
+	"MOD_DSPREADBACK_B_VALUE_ADDR",
+	"MOD_RUNNINGAVERAGE_A_RMSTCINDBPS_ADDR",
+	"MOD_RUNNINGAVERAGE_B_RMSTCINDBPS_ADDR",
+}
+
+var (
+	reDefine = regexp.MustCompile(`^#define\s+(\w+)\s+(\d+)\s*$`)
+	reArray  = regexp.MustCompile(`^ADI_REG_TYPE\s+(\w+)\s*\[`)
+	reByte   = regexp.MustCompile(`0x[0-9A-Fa-f]{1,2}`)
+	reCall   = regexp.MustCompile(`^\s*(SIGMA_WRITE_REGISTER_BLOCK|SIGMA_WRITE_DELAY)\s*\(\s*(\w+)\s*,\s*(\w+)\s*,\s*(\w+)\s*,\s*(\w+)\s*\)`)
+)
+
+type op struct {
+	typ    uint8
+	flags  uint8
+	addr   uint16
+	length uint32
+	frame  []byte // [dev][addr_hi][addr_lo][data or LZ stream]
+}
+
+type symbol struct {
+	name string
+	addr uint16
+}
+
+func main() {
+	name := flag.String("name", "", "イメージ名 (最大16文字, 省略時は入力ファイル名)")
+	output := flag.String("o", "output.jdsp", "出力ファイル")
+	paramPath := flag.String("param", "", "*_PARAM.h (省略時は <入力>_PARAM.h)")
+	delayMs := flag.Uint("delay", defaultDelayMs, "SIGMA_WRITE_DELAY の待ち時間[ms]")
+	noCompress := flag.Bool("nocompress", false, "メモリブロックを圧縮しない")
+	flag.Parse()
+
+	if flag.NArg() < 1 {
+		fmt.Println("使用方法: go run sigma_image_compiler.go [-name 名前] [-o 出力] [-param PARAM.h] <SigmaStudioエクスポート.h>")
+		fmt.Println("例: go run sigma_image_compiler.go -name phono_v2 -o phono_v2.jdsp JUMBLEQ_DSP_ADAU146xSchematic_1.h")
+		os.Exit(1)
+	}
+
+	inputFile := flag.Arg(0)
+	if *paramPath == "" {
+		*paramPath = strings.TrimSuffix(inputFile, ".h") + "_PARAM.h"
+	}
+	if *name == "" {
+		*name = strings.TrimSuffix(filepath.Base(inputFile), ".h")
+		if len(*name) > imageNameLen {
+			*name = (*name)[len(*name)-imageNameLen:]
+		}
+	}
+
+	image, summary, err := compileImage(inputFile, *paramPath, *name, uint32(*delayMs), !*noCompress)
+	if err != nil {
+		fmt.Printf("エラー: %v\n", err)
+		os.Exit(1)
+	}
+
+	if err := os.WriteFile(*output, image, 0o644); err != nil {
+		fmt.Printf("エラー: 出力ファイルを作成できません: %v\n", err)
+		os.Exit(1)
+	}
+
+	fmt.Print(summary)
+	fmt.Printf("変換完了: %s -> %s (%d bytes)\n", inputFile, *output, len(image))
+}
+
+func readLines(path string) ([]string, error) {
+	file, err := os.Open(path)
+	if err != nil {
+		return nil, fmt.Errorf("入力ファイルを開けません: %w", err)
+	}
+	defer file.Close()
+
+	var lines []string
+	scanner := bufio.NewScanner(file)
+	// 長い行を処理するためにバッファサイズを増やす
+	buf := make([]byte, 0, 64*1024)
+	scanner.Buffer(buf, 1024*1024)
+
+	for scanner.Scan() {
+		lines = append(lines, scanner.Text())
+	}
+
+	if err := scanner.Err(); err != nil {
+		return nil, fmt.Errorf("ファイル読み込みエラー: %w", err)
+	}
+	return lines, nil
+}
+
+// #define の数値と ADI_REG_TYPE 配列、default_download の呼び出し順を取り出す
+func parseExport(lines []string) (map[string]int, map[string][]byte, [][]string, error) {
+	defines := map[string]int{}
+	arrays := map[string][]byte{}
+	var calls [][]string
+
+	var current string
+	for _, line := range lines {
+		trimmed := strings.TrimSpace(line)
+
+		if current != "" {
+			if strings.HasPrefix(trimmed, "}") {
+				current = ""
+				continue
+			}
+			for _, hex := range reByte.FindAllString(trimmed, -1) {
+				v, _ := strconv.ParseUint(hex[2:], 16, 8)
+				arrays[current] = append(arrays[current], byte(v))
+			}
+			continue
+		}
+
+		if m := reDefine.FindStringSubmatch(trimmed); m != nil {
+			v, _ := strconv.Atoi(m[2])
+			defines[m[1]] = v
+		} else if m := reArray.FindStringSubmatch(trimmed); m != nil {
+			current = m[1]
+			arrays[current] = nil
+		} else if m := reCall.FindStringSubmatch(line); m != nil {
+			calls = append(calls, m[1:])
+		}
+	}
+
+	if len(calls) == 0 {
+		return nil, nil, nil, fmt.Errorf("ダウンロードシーケンスが見つかりません")
+	}
+	return defines, arrays, calls, nil
+}
+
+func parseParams(path string) (map[string]int, error) {
+	lines, err := readLines(path)
+	if err != nil {
+		return nil, err
+	}
+
+	params := map[string]int{}
+	for _, line := range lines {
+		if m := reDefine.FindStringSubmatch(strings.TrimSpace(line)); m != nil && strings.HasSuffix(m[1], "_ADDR") {
+			v, _ := strconv.Atoi(m[2])
+			params[m[1]] = v
+		}
+	}
+	return params, nil
+}
+
+func lookup(defines map[string]int, name string) (int, error) {
+	if v, err := strconv.ParseInt(name, 0, 32); err == nil {
+		return int(v), nil
+	}
+	v, ok := defines[name]
+	if !ok {
+		return 0, fmt.Errorf("未定義のシンボル: %s", name)
+	}
+	return v, nil
+}
+
+// 1回のSPI転送に収まるよう分割する。DM/PMは1アドレス4byte、レジスタは2byte
+func buildOps(defines map[string]int, arrays map[string][]byte, calls [][]string, delayMs uint32) ([]op, error) {
+	var ops []op
+
+	for _, c := range calls {
+		fn, devName, addrName, sizeName, dataName := c[0], c[1], c[2], c[3], c[4]
+
+		if fn == "SIGMA_WRITE_DELAY" {
+			ops = append(ops, op{typ: opDelay, length: delayMs})
+			continue
+		}
+
+		dev, err := lookup(defines, devName)
+		if err != nil {
+			dev = 0 // DEVICE_ADDR は SigmaStudioFW.h 側で定義されている (SPI書き込みは0x00)
+		}
+		addr, err := lookup(defines, addrName)
+		if err != nil {
+			return nil, err
+		}
+		size, err := lookup(defines, sizeName)
+		if err != nil {
+			return nil, err
+		}
+		data, ok := arrays[dataName]
+		if !ok || len(data) != size {
+			return nil, fmt.Errorf("%s: データ長が一致しません (%d != %d)", dataName, len(data), size)
+		}
+
+		word := 4
+		if size <= 2 {
+			word = size
+		}
+		chunk := (frameMax - frameHdrSize) / word * word
+
+		for pos := 0; pos < size; pos += chunk {
+			end := pos + chunk
+			if end > size {
+				end = size
+			}
+			a := addr + pos/word
+			frame := []byte{byte(dev), byte(a >> 8), byte(a)}
+			frame = append(frame, data[pos:end]...)
+			ops = append(ops, op{typ: opWrite, addr: uint16(a), length: uint32(end - pos), frame: frame})
+		}
+	}
+	return ops, nil
+}
+
+// LZ77 + RLE (ファームウェア側 dsp_image_lz_decode と対になる)
+//
+//	0x00-0x7F: リテラル (n+1 byte が続く)
+//	0x80-0xFF: 一致 (長さ (n&0x7F)+3, 続く2byteが距離(LE, 1以上)。距離1はランレングス)
+//
+// 窓は1フレーム内だけなので、デコーダはフレームバッファ以外のメモリを必要としない
+func lzCompress(src []byte) []byte {
+	var out []byte
+	var literals []byte
+
+	flush := func() {
+		for len(literals) > 0 {
+			n := len(literals)
+			if n > lzLiteralMax {
+				n = lzLiteralMax
+			}
+			out = append(out, byte(n-1))
+			out = append(out, literals[:n]...)
+			literals = literals[n:]
+		}
+	}
+
+	for i := 0; i < len(src); {
+		bestLen, bestDist := 0, 0
+		for dist := 1; dist <= i; dist++ {
+			n := 0
+			for i+n < len(src) && n < lzMatchMax && src[i+n] == src[i+n-dist] {
+				n++
+			}
+			if n > bestLen {
+				bestLen, bestDist = n, dist
+			}
+		}
+
+		if bestLen >= lzMatchMin {
+			flush()
+			out = append(out, byte(0x80|(bestLen-lzMatchMin)), byte(bestDist), byte(bestDist>>8))
+			i += bestLen
+		} else {
+			literals = append(literals, src[i])
+			i++
+		}
+	}
+	flush()
+	return out
+}
+
+func lzDecompress(src []byte, size int) ([]byte, error) {
+	out := make([]byte, 0, size)
+	for i := 0; i < len(src); {
+		t := int(src[i])
+		i++
+		if t < 0x80 {
+			n := t + 1
+			if i+n > len(src) {
+				return nil, fmt.Errorf("リテラルが途中で切れています")
+			}
+			out = append(out, src[i:i+n]...)
+			i += n
+			continue
+		}
+		if i+2 > len(src) {
+			return nil, fmt.Errorf("距離が途中で切れています")
+		}
+		n := (t & 0x7F) + lzMatchMin
+		dist := int(src[i]) | int(src[i+1])<<8
+		i += 2
+		if dist == 0 || dist > len(out) {
+			return nil, fmt.Errorf("不正な距離 %d", dist)
+		}
+		for k := 0; k < n; k++ {
+			out = append(out, out[len(out)-dist])
+		}
+	}
+	if len(out) != size {
+		return nil, fmt.Errorf("展開後の長さが一致しません (%d != %d)", len(out), size)
+	}
+	return out, nil
+}
+
+func compressOps(ops []op) error {
+	for i := range ops {
+		o := &ops[i]
+		if o.typ != opWrite || o.length < 16 {
+			continue
+		}
+
+		raw := o.frame[frameHdrSize:]
+		packed := lzCompress(raw)
+		if len(packed) >= len(raw) {
+			continue
+		}
+
+		// 書き出す前に自前で展開して一致を確認しておく
+		check, err := lzDecompress(packed, len(raw))
+		if err != nil || string(check) != string(raw) {
+			return fmt.Errorf("op%d [%X]: 圧縮データの検証に失敗しました", i, o.addr)
+		}
+
+		o.flags |= opFlagLZ
+		o.frame = append(append([]byte{}, o.frame[:frameHdrSize]...), packed...)
+	}
+	return nil
+}
+
+func align(v, a int) int {
+	return (v + a - 1) / a * a
+}
+
+func compileImage(inputPath, paramPath, name string, delayMs uint32, compress bool) ([]byte, string, error) {
+	if len(name) > imageNameLen {
+		return nil, "", fmt.Errorf("イメージ名が長すぎます (最大%d文字): %s", imageNameLen, name)
+	}
+
+	lines, err := readLines(inputPath)
+	if err != nil {
+		return nil, "", err
+	}
+	defines, arrays, calls, err := parseExport(lines)
+	if err != nil {
+		return nil, "", err
+	}
+	params, err := parseParams(paramPath)
+	if err != nil {
+		return nil, "", err
+	}
+
+	ops, err := buildOps(defines, arrays, calls, delayMs)
+	if err != nil {
+		return nil, "", err
+	}
+	rawBytes := 0
+	for _, o := range ops {
+		rawBytes += len(o.frame)
+	}
+	if compress {
+		if err := compressOps(ops); err != nil {
+			return nil, "", err
+		}
+	}
+
+	// シンボル表は PARAM.h の全 *_ADDR (MOD_ と _ADDR は省く)
+	var symbols []symbol
+	for k, v := range params {
+		if v < 0 || v > 0xFFFF {
+			continue
+		}
+		symbols = append(symbols, symbol{name: strings.TrimSuffix(strings.TrimPrefix(k, "MOD_"), "_ADDR"), addr: uint16(v)})
+	}
+	sort.Slice(symbols, func(i, j int) bool { return symbols[i].name < symbols[j].name })
+
+	// レイアウト: header | ops | params | symbols | 文字列 | frames
+	opOffset := align(headerSize, 4)
+	paramOffset := opOffset + len(ops)*opSize
+	symbolOffset := paramOffset + len(paramNames)*paramSize
+	stringOffset := symbolOffset + len(symbols)*symbolSize
+
+	var strs []byte
+	nameOffsets := make([]int, len(symbols))
+	for i, s := range symbols {
+		nameOffsets[i] = stringOffset + len(strs)
+		strs = append(strs, s.name...)
+		strs = append(strs, 0)
+	}
+
+	frameOffset := align(stringOffset+len(strs), 4)
+	frameOffsets := make([]int, len(ops))
+	size := frameOffset
+	for i, o := range ops {
+		if o.typ == opWrite {
+			frameOffsets[i] = size
+			size = align(size+len(o.frame), 4)
+		}
+	}
+	if size > slotSize {
+		return nil, "", fmt.Errorf("イメージがスロットに収まりません (%d > %d bytes)", size, slotSize)
+	}
+
+	img := make([]byte, size)
+	le := binary.LittleEndian
+
+	for i, o := range ops {
+		p := img[opOffset+i*opSize:]
+		p[0] = o.typ
+		p[1] = o.flags
+		le.PutUint16(p[2:], o.addr)
+		le.PutUint32(p[4:], o.length)
+		if o.typ == opWrite {
+			le.PutUint32(p[8:], uint32(frameOffsets[i]))
+			le.PutUint32(p[12:], uint32(len(o.frame)))
+			copy(img[frameOffsets[i]:], o.frame)
+		}
+	}
+
+	var summary strings.Builder
+	missing := 0
+	for id, pn := range paramNames {
+		p := img[paramOffset+id*paramSize:]
+		addr := paramAddrNone
+		if v, ok := params[pn]; ok {
+			addr = v
+		} else {
+			missing++
+			fmt.Fprintf(&summary, "警告: %s がありません (この機能は無効になります)\n", pn)
+		}
+		le.PutUint16(p[0:], uint16(id))
+		le.PutUint16(p[2:], uint16(addr))
+	}
+
+	for i, s := range symbols {
+		p := img[symbolOffset+i*symbolSize:]
+		le.PutUint16(p[0:], s.addr)
+		le.PutUint16(p[2:], uint16(len(s.name)))
+		le.PutUint32(p[4:], uint32(nameOffsets[i]))
+	}
+	copy(img[stringOffset:], strs)
+
+	le.PutUint32(img[0:], imageMagic)
+	le.PutUint16(img[4:], imageVersion)
+	le.PutUint16(img[6:], headerSize)
+	le.PutUint32(img[8:], uint32(size))
+	copy(img[16:16+imageNameLen], name)
+	le.PutUint16(img[32:], uint16(len(ops)))
+	le.PutUint16(img[34:], uint16(len(paramNames)))
+	le.PutUint32(img[36:], uint32(opOffset))
+	le.PutUint32(img[40:], uint32(paramOffset))
+	le.PutUint32(img[44:], uint32(symbolOffset))
+	le.PutUint16(img[48:], uint16(len(symbols)))
+	le.PutUint32(img[12:], crc32.ChecksumIEEE(img[headerSize:]))
+
+	storedBytes := 0
+	for _, o := range ops {
+		storedBytes += len(o.frame)
+	}
+	fmt.Fprintf(&summary, "ops: %d, params: %d (欠落 %d), symbols: %d\n", len(ops), len(paramNames), missing, len(symbols))
+	fmt.Fprintf(&summary, "frames: %d -> %d bytes\n", rawBytes, storedBytes)
+	return img, summary.String(), nil
+}
@@ -0,0 +1,173 @@
+package main
+
+import (
+	"bufio"
+	"flag"
+	"fmt"
+	"os"
+	"regexp"
+	"strconv"
+	"strings"
+)
+
+// ssd1306_fonts.c の行形式フォント (1 行 = uint16_t、MSB が左端) を SSD1306 のページ形式に回した列の表 (ssd1306_fonts_cols.c) を生成するスクリプト
+// 例: go run ssd1306_font_cols.go -i ../Appli/stm32-ssd1306/ssd1306/ssd1306_fonts.c -o ../Appli/stm32-ssd1306/ssd1306/ssd1306_fonts_cols.c
+//
+// 並びは 文字 -> 列 -> ページ (bit0 が上端)。1 文字 = width * ceil(height / 8) byte で、プロポーショナルでも幅は最大幅で揃える
+// 生成後に元の行形式へ戻して一致するかチェックする
+
+const (
+	firstChar = 32
+	charNum   = 95
+)
+
+type font struct {
+	name   string
+	width  int
+	height int
+	rows   []uint16
+}
+
+var (
+	reArray   = regexp.MustCompile(`static const uint16_t (Font(\d+)x(\d+))\s*\[\]\s*=\s*\{`)
+	reHex     = regexp.MustCompile(`0x[0-9A-Fa-f]+`)
+	reLineCmt = regexp.MustCompile(`//[^\n]*`)
+	reBlkCmt  = regexp.MustCompile(`(?s)/\*.*?\*/`)
+)
+
+func parseFonts(src string) ([]font, error) {
+	var fonts []font
+
+	for _, m := range reArray.FindAllStringSubmatchIndex(src, -1) {
+		name := src[m[2]:m[3]]
+		width, _ := strconv.Atoi(src[m[4]:m[5]])
+		height, _ := strconv.Atoi(src[m[6]:m[7]])
+
+		end := strings.Index(src[m[1]:], "};")
+		if end < 0 {
+			return nil, fmt.Errorf("%s: 配列の終わりがありません", name)
+		}
+		body := src[m[1] : m[1]+end]
+		body = reBlkCmt.ReplaceAllString(body, "")
+		body = reLineCmt.ReplaceAllString(body, "")
+
+		var rows []uint16
+		for _, h := range reHex.FindAllString(body, -1) {
+			v, err := strconv.ParseUint(h[2:], 16, 16)
+			if err != nil {
+				return nil, fmt.Errorf("%s: %v", name, err)
+			}
+			rows = append(rows, uint16(v))
+		}
+		if width > 16 || len(rows) != charNum*height {
+			return nil, fmt.Errorf("%s: %d 行 (期待値 %d)", name, len(rows), charNum*height)
+		}
+		fonts = append(fonts, font{name, width, height, rows})
+	}
+	if len(fonts) == 0 {
+		return nil, fmt.Errorf("フォントが見つかりません")
+	}
+	return fonts, nil
+}
+
+func (f font) pages() int {
+	return (f.height + 7) / 8
+}
+
+func (f font) columns() []byte {
+	pages := f.pages()
+	out := make([]byte, charNum*f.width*pages)
+
+	for g := 0; g < charNum; g++ {
+		for y := 0; y < f.height; y++ {
+			row := f.rows[g*f.height+y]
+			for x := 0; x < f.width; x++ {
+				if row&(0x8000>>uint(x)) != 0 {
+					out[(g*f.width+x)*pages+y/8] |= 1 << uint(y%8)
+				}
+			}
+		}
+	}
+	return out
+}
+
+// 列の表から行形式に戻し、幅の外のビットを除いて元と一致するか
+func (f font) verify(cols []byte) error {
+	pages := f.pages()
+	mask := uint16(0xFFFF << uint(16-f.width))
+
+	for g := 0; g < charNum; g++ {
+		for y := 0; y < f.height; y++ {
+			var row uint16
+			for x := 0; x < f.width; x++ {
+				if cols[(g*f.width+x)*pages+y/8]&(1<<uint(y%8)) != 0 {
+					row |= 0x8000 >> uint(x)
+				}
+			}
+			if row != f.rows[g*f.height+y]&mask {
+				return fmt.Errorf("%s: '%c' の %d 行目が一致しません", f.name, rune(firstChar+g), y)
+			}
+		}
+	}
+	return nil
+}
+
+func main() {
+	in := flag.String("i", "ssd1306_fonts.c", "入力ファイル (ssd1306_fonts.c)")
+	out := flag.String("o", "ssd1306_fonts_cols.c", "出力ファイル")
+	flag.Parse()
+
+	src, err := os.ReadFile(*in)
+	if err != nil {
+		fmt.Fprintln(os.Stderr, err)
+		os.Exit(1)
+	}
+	fonts, err := parseFonts(strings.ReplaceAll(string(src), "\r\n", "\n"))
+	if err != nil {
+		fmt.Fprintln(os.Stderr, err)
+		os.Exit(1)
+	}
+
+	f, err := os.Create(*out)
+	if err != nil {
+		fmt.Fprintln(os.Stderr, err)
+		os.Exit(1)
+	}
+	defer f.Close()
+
+	w := bufio.NewWriter(f)
+	fmt.Fprintln(w, "/*")
+	fmt.Fprintln(w, " * ssd1306_fonts_cols.c")
+	fmt.Fprintln(w, " *")
+	fmt.Fprintln(w, " *  Generated by tools/ssd1306_font_cols.go. Do not edit.")
+	fmt.Fprintln(w, " */")
+	fmt.Fprintln(w)
+	fmt.Fprintln(w, "#include \"ssd1306_fonts.h\"")
+
+	for _, ft := range fonts {
+		cols := ft.columns()
+		if err := ft.verify(cols); err != nil {
+			fmt.Fprintln(os.Stderr, err)
+			os.Exit(1)
+		}
+
+		stride := ft.width * ft.pages()
+		fmt.Fprintln(w)
+		fmt.Fprintf(w, "#ifdef SSD1306_INCLUDE_FONT_%dx%d\n", ft.width, ft.height)
+		fmt.Fprintf(w, "const uint8_t %s_cols[] = {\n", ft.name)
+		for g := 0; g < charNum; g++ {
+			fmt.Fprint(w, "   ")
+			for _, b := range cols[g*stride : (g+1)*stride] {
+				fmt.Fprintf(w, " 0x%02X,", b)
+			}
+			fmt.Fprintf(w, "  // %q\n", rune(firstChar+g))
+		}
+		fmt.Fprintln(w, "};")
+		fmt.Fprintln(w, "#endif")
+	}
+
+	if err := w.Flush(); err != nil {
+		fmt.Fprintln(os.Stderr, err)
+		os.Exit(1)
+	}
+}
@@ -0,0 +1,98 @@
+package main
+
+import (
+	"bufio"
+	"flag"
+	"fmt"
+	"math"
+	"os"
+)
+
+// ファームウェアの xfade_curve.c が使う 256 点の Q15 クロスフェーダーカーブ表 (xfade_curve_lut.c) を生成するスクリプト
+// 例: go run xfade_curve_gen.go -o ../Appli/Core/Src/xfade_curve_lut.c
+//
+// カーブの順番は Appli/Core/Inc/xfade_curve.h の XFADE_CURVE_* と一致させること
+// どのカーブも f(0)=0, f(1)=1 で単調非減少にする (生成時にチェックする)
+
+const (
+	lutSize = 256
+	q15One  = 32768
+)
+
+type curve struct {
+	name string
+	f    func(x float64) float64
+}
+
+var curves = []curve{
+	{"XFADE_CURVE_LINEAR", func(x float64) float64 { return x }},
+	{"XFADE_CURVE_CONST_POWER", func(x float64) float64 { return math.Sin(x * math.Pi / 2) }},
+	{"XFADE_CURVE_SHARP", func(x float64) float64 { return 1 - math.Pow(1-x, 16) }},
+	// 従来の pow(x, 1/3)
+	{"XFADE_CURVE_SCRATCH", func(x float64) float64 { return math.Cbrt(x) }},
+}
+
+func quantize(y float64) int {
+	v := int(math.Round(y * q15One))
+	if v < 0 {
+		return 0
+	}
+	if v > q15One {
+		return q15One
+	}
+	return v
+}
+
+func main() {
+	out := flag.String("o", "xfade_curve_lut.c", "出力ファイル")
+	flag.Parse()
+
+	f, err := os.Create(*out)
+	if err != nil {
+		fmt.Fprintln(os.Stderr, err)
+		os.Exit(1)
+	}
+	defer f.Close()
+
+	w := bufio.NewWriter(f)
+	fmt.Fprintln(w, "/*")
+	fmt.Fprintln(w, " * xfade_curve_lut.c")
+	fmt.Fprintln(w, " *")
+	fmt.Fprintln(w, " *  Generated by tools/xfade_curve_gen.go. Do not edit.")
+	fmt.Fprintln(w, " */")
+	fmt.Fprintln(w)
+	fmt.Fprintln(w, "#include \"xfade_curve.h\"")
+	fmt.Fprintln(w)
+	fmt.Fprintln(w, "const uint16_t xfade_curve_lut[XFADE_CURVE_USER][XFADE_CURVE_LUT_SIZE] = {")
+
+	for _, c := range curves {
+		lut := make([]int, lutSize)
+		for i := range lut {
+			lut[i] = quantize(c.f(float64(i) / float64(lutSize-1)))
+			if i > 0 && lut[i] < lut[i-1] {
+				fmt.Fprintf(os.Stderr, "%s: 単調になっていません (i=%d)\n", c.name, i)
+				os.Exit(1)
+			}
+		}
+		if lut[0] != 0 || lut[lutSize-1] != q15One {
+			fmt.Fprintf(os.Stderr, "%s: 端点が 0/1 になっていません\n", c.name)
+			os.Exit(1)
+		}
+
+		fmt.Fprintf(w, "    [%s] = {\n", c.name)
+		for i := 0; i < lutSize; i += 8 {
+			fmt.Fprint(w, "       ")
+			for j := i; j < i+8; j++ {
+				fmt.Fprintf(w, " %5d,", lut[j])
+			}
+			fmt.Fprintln(w)
+		}
+		fmt.Fprintln(w, "    },")
+	}
+	fmt.Fprintln(w, "};")
+
+	if err := w.Flush(); err != nil {
+		fmt.Fprintln(os.Stderr, err)
+		os.Exit(1)
+	}
+}